@@ -13,7 +13,7 @@ for arg in "$@"; do
 done
 
 # re-enable these warnings when they are better supported by g++ or clang: -Wduplicated-cond -Wduplicated-branches -Wrestrict
-compile_all="\"$root_path/core/DataSetByFeature.cpp\" \"$root_path/core/DataSetByFeatureCombination.cpp\" \"$root_path/core/InteractionDetection.cpp\" \"$root_path/core/Logging.cpp\" \"$root_path/core/SamplingWithReplacement.cpp\" \"$root_path/core/Training.cpp\" -I\"$root_path/core\" -I\"$root_path/core/inc\" -Wall -Wextra -Wno-parentheses -Wold-style-cast -Wdouble-promotion -Wshadow -Wformat=2 -std=c++11 -fvisibility=hidden -fvisibility-inlines-hidden -O3 -march=core2 -DEBMCORE_EXPORTS -fpic"
+compile_all="\"$root_path/core/Binning.cpp\" \"$root_path/core/DataSetByFeature.cpp\" \"$root_path/core/DataSetByFeatureCombination.cpp\" \"$root_path/core/EbmTrainingDataSet.cpp\" \"$root_path/core/InteractionDetection.cpp\" \"$root_path/core/Logging.cpp\" \"$root_path/core/MemoryMappedFile.cpp\" \"$root_path/core/Prediction.cpp\" \"$root_path/core/SamplingWithReplacement.cpp\" \"$root_path/core/SamplingWithoutReplacement.cpp\" \"$root_path/core/ThreadPool.cpp\" \"$root_path/core/Training.cpp\" -I\"$root_path/core\" -I\"$root_path/core/inc\" -Wall -Wextra -Wno-parentheses -Wold-style-cast -Wdouble-promotion -Wshadow -Wformat=2 -std=c++11 -fvisibility=hidden -fvisibility-inlines-hidden -O3 -march=core2 -ffp-contract=off -DEBMCORE_EXPORTS -fpic -pthread"
 
 if [ "$os_type" = "Darwin" ]; then
    # reference on rpath & install_name: https://www.mikeash.com/pyblog/friday-qa-2009-11-06-linking-and-install-names.html
@@ -0,0 +1,136 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "Binning.h"
+#include "ThreadPool.h"
+
+// below this many values, creating threads costs more than binning everything on the calling thread
+constexpr size_t k_cValuesParallelMin = size_t { 1 } << 20;
+// each task bins this many instances of one feature, so a few long columns still spread across all our threads
+constexpr size_t k_cInstancesPerBinningTask = size_t { 1 } << 16;
+
+struct BinFeatureValuesContext final {
+   size_t m_cInstances;
+   size_t m_cTasksPerFeature;
+   const size_t * m_acCuts;
+   const size_t * m_aiCutsStart;
+   const FractionalDataType * m_aCuts;
+   const FractionalDataType * m_aValues;
+   IntegerDataType * m_aBinnedData;
+};
+
+static bool BinFeatureValuesTask(void * const pContext, const size_t iThread, const size_t iTask) {
+   UNUSED(iThread);
+   const BinFeatureValuesContext * const pBinFeatureValuesContext = static_cast<const BinFeatureValuesContext *>(pContext);
+   const size_t cInstances = pBinFeatureValuesContext->m_cInstances;
+   const size_t iFeature = iTask / pBinFeatureValuesContext->m_cTasksPerFeature;
+   const size_t iInstanceStart = iTask % pBinFeatureValuesContext->m_cTasksPerFeature * k_cInstancesPerBinningTask;
+   EBM_ASSERT(iInstanceStart < cInstances);
+   const size_t cInstancesRemaining = cInstances - iInstanceStart;
+   const size_t cInstancesTask = cInstancesRemaining < k_cInstancesPerBinningTask ? cInstancesRemaining : k_cInstancesPerBinningTask;
+   // our caller checked that cFeatures * cInstances doesn't overflow
+   const size_t iValueStart = iFeature * cInstances + iInstanceStart;
+   BinFeatureColumn(
+      pBinFeatureValuesContext->m_acCuts[iFeature],
+      &pBinFeatureValuesContext->m_aCuts[pBinFeatureValuesContext->m_aiCutsStart[iFeature]],
+      cInstancesTask,
+      &pBinFeatureValuesContext->m_aValues[iValueStart],
+      &pBinFeatureValuesContext->m_aBinnedData[iValueStart]
+   );
+   return false;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION BinFeatureValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   const FractionalDataType * cuts,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   IntegerDataType * binnedData
+) {
+   LOG_N(TraceLevelInfo, "Entered BinFeatureValues: countFeatures=%" IntegerDataTypePrintf ", features=%p, cuts=%p, countInstances=%" IntegerDataTypePrintf ", values=%p, binnedData=%p", countFeatures, static_cast<const void *>(features), static_cast<const void *>(cuts), countInstances, static_cast<const void *>(values), static_cast<void *>(binnedData));
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING BinFeatureValues !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING BinFeatureValues !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return 1;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   if(0 == cFeatures || 0 == cInstances) {
+      LOG_0(TraceLevelInfo, "INFO BinFeatureValues nothing to bin");
+      return 0;
+   }
+   EBM_ASSERT(nullptr != features);
+   EBM_ASSERT(nullptr != values);
+   EBM_ASSERT(nullptr != binnedData);
+   if(IsMultiplyError(cFeatures, cInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING BinFeatureValues IsMultiplyError(cFeatures, cInstances)");
+      return 1;
+   }
+   if(IsMultiplyError(sizeof(size_t) * 2, cFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING BinFeatureValues IsMultiplyError(sizeof(size_t) * 2, cFeatures)");
+      return 1;
+   }
+   size_t * const acCuts = static_cast<size_t *>(malloc(sizeof(size_t) * 2 * cFeatures));
+   if(UNLIKELY(nullptr == acCuts)) {
+      LOG_0(TraceLevelWarning, "WARNING BinFeatureValues nullptr == acCuts");
+      return 1;
+   }
+   size_t * const aiCutsStart = acCuts + cFeatures;
+   size_t cCutsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntegerDataType countBins = features[iFeature].countBins;
+      if(countBins <= 0 || !IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+         LOG_0(TraceLevelError, "ERROR BinFeatureValues a feature needs at least 1 bin if there are instances");
+         free(acCuts);
+         return 1;
+      }
+      // the cuts are in memory that our caller allocated, so their total can't overflow
+      const size_t cCuts = GetCountCuts(static_cast<size_t>(countBins));
+      acCuts[iFeature] = cCuts;
+      aiCutsStart[iFeature] = cCutsTotal;
+      cCutsTotal += cCuts;
+   }
+   EBM_ASSERT(0 == cCutsTotal || nullptr != cuts);
+
+   const size_t cTasksPerFeature = (cInstances - 1) / k_cInstancesPerBinningTask + 1;
+   const size_t cTasks = cFeatures * cTasksPerFeature;
+   BinFeatureValuesContext binFeatureValuesContext { cInstances, cTasksPerFeature, acCuts, aiCutsStart, cuts, values, binnedData };
+
+   ThreadPool * pThreadPool = nullptr;
+   if(k_cValuesParallelMin <= cFeatures * cInstances) {
+      try {
+         const size_t cThreadsRecommended = ThreadPool::GetCountThreadsRecommended(cTasks);
+         if(1 < cThreadsRecommended) {
+            // if we can't get threads we still bin everything on this thread
+            pThreadPool = ThreadPool::Allocate(cThreadsRecommended - 1);
+         }
+      } catch(...) {
+         // ThreadPool::GetCountThreadsRecommended calls std::thread::hardware_concurrency, which isn't marked noexcept
+         LOG_0(TraceLevelWarning, "WARNING BinFeatureValues exception");
+      }
+   }
+   // our tasks can't fail
+   const bool bError = ThreadPool::Run(pThreadPool, cTasks, &BinFeatureValuesTask, &binFeatureValuesContext);
+   EBM_ASSERT(!bError);
+   UNUSED(bError);
+   delete pThreadPool;
+
+   free(acCuts);
+
+   LOG_0(TraceLevelInfo, "Exited BinFeatureValues");
+   return 0;
+}
@@ -0,0 +1,87 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef BINNING_H
+#define BINNING_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <cmath> // std::isnan
+
+#include "ebmcore.h" // FractionalDataType, IntegerDataType
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// the callers that bin raw values (prediction and the data set builder) do it one block of instances at a time into a buffer of this many instances per
+// feature, so the binned block stays in cache while it's consumed and we never hold a binned copy of the complete matrix
+constexpr size_t k_cInstancesPerBinningBlock = 512;
+
+// with this many cuts or fewer we compare each value against every cut.  The comparisons don't depend on each other, so the compiler vectorizes them,
+// and for a handful of cuts that's cheaper than the dependent loads of a binary search
+constexpr size_t k_cCutsLinearSearchMax = 15;
+
+// a value's bin is the number of cuts that are less than or equal to it, which is what np.digitize returns for every edge after the first, so a feature with
+// cCuts cuts has cCuts + 1 bins.  NaN compares false against every cut, so we put it in the last bin explicitly just like np.digitize does.  Unsorted cuts
+// give the wrong bins, but the bin is always in the range [0, cCuts], so our callers can trust it as a tensor index
+EBM_INLINE size_t BinValueLinear(const FractionalDataType value, const size_t cCuts, const FractionalDataType * const aCuts) {
+   size_t iBin = 0;
+   for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+      iBin += aCuts[iCut] <= value ? size_t { 1 } : size_t { 0 };
+   }
+   return std::isnan(value) ? cCuts : iBin;
+}
+
+EBM_INLINE size_t BinValueBinarySearch(const FractionalDataType value, const size_t cCuts, const FractionalDataType * const aCuts) {
+   EBM_ASSERT(1 <= cCuts);
+   // each step keeps the half of the range that the value falls in with a conditional move instead of a branch, so the number of iterations depends only
+   // on cCuts.  The branch predictor never misses, and the searches of consecutive instances overlap in the pipeline since nothing waits on a comparison
+   const FractionalDataType * pCut = aCuts;
+   size_t cRemaining = cCuts;
+   while(1 < cRemaining) {
+      const size_t cHalf = cRemaining >> 1;
+      pCut = pCut[cHalf] <= value ? pCut + cHalf : pCut;
+      cRemaining -= cHalf;
+   }
+   const size_t iBin = static_cast<size_t>(pCut - aCuts) + (*pCut <= value ? size_t { 1 } : size_t { 0 });
+   return std::isnan(value) ? cCuts : iBin;
+}
+
+#ifndef NDEBUG
+EBM_INLINE bool AreCutsSorted(const size_t cCuts, const FractionalDataType * const aCuts) {
+   for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+      if(std::isnan(aCuts[iCut]) || 0 != iCut && aCuts[iCut] < aCuts[iCut - 1]) {
+         return false;
+      }
+   }
+   return true;
+}
+#endif // NDEBUG
+
+// bins cInstances values of a single feature.  We choose the search once per column so that the loop over the instances has no data dependent branches
+EBM_INLINE void BinFeatureColumn(const size_t cCuts, const FractionalDataType * const aCuts, const size_t cInstances, const FractionalDataType * const aValues, IntegerDataType * const aBinnedData) {
+   EBM_ASSERT(0 == cCuts || nullptr != aCuts);
+   EBM_ASSERT(AreCutsSorted(cCuts, aCuts));
+   EBM_ASSERT(0 == cInstances || nullptr != aValues);
+   EBM_ASSERT(0 == cInstances || nullptr != aBinnedData);
+   if(0 == cCuts) {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         aBinnedData[iInstance] = 0;
+      }
+   } else if(cCuts <= k_cCutsLinearSearchMax) {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         aBinnedData[iInstance] = static_cast<IntegerDataType>(BinValueLinear(aValues[iInstance], cCuts, aCuts));
+      }
+   } else {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         aBinnedData[iInstance] = static_cast<IntegerDataType>(BinValueBinarySearch(aValues[iInstance], cCuts, aCuts));
+      }
+   }
+}
+
+// our exported functions take the cuts of all the features concatenated in feature order, and each feature has one fewer cut than it has bins.  Features
+// with zero bins (only allowed without instances) have no cuts
+EBM_INLINE size_t GetCountCuts(const size_t cBins) {
+   return 0 == cBins ? size_t { 0 } : cBins - 1;
+}
+
+#endif // BINNING_H
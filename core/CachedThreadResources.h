@@ -5,8 +5,6 @@
 #ifndef CACHED_THREAD_RESOURCES_H
 #define CACHED_THREAD_RESOURCES_H
 
-#include <vector>
-#include <queue>
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 
@@ -14,6 +12,7 @@
 #include "Logging.h" // EBM_ASSERT & LOG
 
 #include "TreeNode.h"
+#include "PhaseStatistics.h"
 
 template<bool bClassification>
 class CompareTreeNodeSplittingGain final {
@@ -29,50 +28,46 @@ struct HistogramBucketVectorEntry;
 
 template<bool bClassification>
 class CachedTrainingThreadResources {
-   bool m_bError;
-
    // this allows us to share the memory between underlying data types
    void * m_aThreadByteBuffer1;
    size_t m_cThreadByteBufferCapacity1;
 
+   // holds the TreeNodes of the tree that GrowDecisionTree is building
    void * m_aThreadByteBuffer2;
    size_t m_cThreadByteBufferCapacity2;
 
+   // holds the extra histograms when we bin large data sets in chunks
+   void * m_aThreadByteBuffer3;
+   size_t m_cThreadByteBufferCapacity3;
+
+   // the binary heap of TreeNodes that GrowDecisionTree could split next, ordered by CompareTreeNodeSplittingGain
+   TreeNode<bClassification> ** m_apTreeNodeSplitFrontier;
+   size_t m_cTreeNodeSplitFrontierCapacity;
+
 public:
 
+   // the statistics of the EbmTrainingState that we're training for.  TrainSamplingSet sets this before each use since workspaces don't know their EbmTrainingState
+   PhaseStatistics * m_pStatistics;
+
    HistogramBucketVectorEntry<bClassification> * const m_aSumHistogramBucketVectorEntry;
    HistogramBucketVectorEntry<bClassification> * const m_aSumHistogramBucketVectorEntry1;
    HistogramBucketVectorEntry<bClassification> * const m_aSumHistogramBucketVectorEntryBest;
    FractionalDataType * const m_aSumResidualErrors2;
 
-   // THIS SHOULD ALWAYS BE THE LAST ITEM IN THIS STRUCTURE.  C++ guarantees that constructions initialize data members in the order that they are declared
-   // since this class can potentially throw an exception in the constructor, we leave it last so that we are guaranteed that the rest of our object has been initialized
-   std::priority_queue<TreeNode<bClassification> *, std::vector<TreeNode<bClassification> *>, CompareTreeNodeSplittingGain<bClassification>> m_bestTreeNodeToSplit;
-
-   // in case you were wondering, this odd syntax of putting a try outside the function is called "Function try blocks" and it's the best way of handling exception in initialization
-   CachedTrainingThreadResources(const size_t cVectorLength) try
-      : m_bError(true)
-      , m_aThreadByteBuffer1(nullptr)
+   CachedTrainingThreadResources(const size_t cVectorLength)
+      : m_aThreadByteBuffer1(nullptr)
       , m_cThreadByteBufferCapacity1(0)
       , m_aThreadByteBuffer2(nullptr)
       , m_cThreadByteBufferCapacity2(0)
+      , m_aThreadByteBuffer3(nullptr)
+      , m_cThreadByteBufferCapacity3(0)
+      , m_apTreeNodeSplitFrontier(nullptr)
+      , m_cTreeNodeSplitFrontierCapacity(0)
+      , m_pStatistics(nullptr)
       , m_aSumHistogramBucketVectorEntry(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
       , m_aSumHistogramBucketVectorEntry1(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
       , m_aSumHistogramBucketVectorEntryBest(new (std::nothrow) HistogramBucketVectorEntry<bClassification>[cVectorLength])
-      , m_aSumResidualErrors2(new (std::nothrow) FractionalDataType[cVectorLength])
-      , m_bestTreeNodeToSplit() {
-
-      // an unfortunate thing about function exception handling is that accessing non-static data from the catch block gives undefined behavior
-      // so, we can't set m_bError to true if an error occurs, so instead we set it to true in the static initialization
-      // C++ guarantees that initialization will occur in the order the variables are declared (not in the order of initialization)
-      // but since we put m_bError above m_bestTreeNodeToSplit and since m_bestTreeNodeToSplit is the only thing that can throw an exception
-      // if an exception occurs then our m_bError will be left as true
-      m_bError = false;
-   } catch(...) {
-      // the only reason we should potentially find outselves here is if there was an exception thrown during construction of m_bestTreeNodeToSplit
-      // C++ exceptions are suposed to be thrown by value and caught by reference, so it shouldn't be a pointer, and we shouldn't leak memory
-      // according to the spec, it's undefined to access a non-static variable from a Function-try-block, so we can't access m_bError here  https://en.cppreference.com/w/cpp/language/function-try-block
-      // so instead of setting it to true here, we set it to true by default and flip it to false if our caller gets to the constructor part
+      , m_aSumResidualErrors2(new (std::nothrow) FractionalDataType[cVectorLength]) {
    }
 
    ~CachedTrainingThreadResources() {
@@ -80,6 +75,8 @@ public:
 
       free(m_aThreadByteBuffer1);
       free(m_aThreadByteBuffer2);
+      free(m_aThreadByteBuffer3);
+      free(m_apTreeNodeSplitFrontier);
       delete[] m_aSumHistogramBucketVectorEntry;
       delete[] m_aSumHistogramBucketVectorEntry1;
       delete[] m_aSumHistogramBucketVectorEntryBest;
@@ -92,6 +89,8 @@ public:
       if(UNLIKELY(m_cThreadByteBufferCapacity1 < cBytesRequired)) {
          m_cThreadByteBufferCapacity1 = cBytesRequired << 1;
          LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer1 to %zu", m_cThreadByteBufferCapacity1);
+         EBM_ASSERT(nullptr != m_pStatistics);
+         m_pStatistics->Add(StatisticBytesAllocated, m_cThreadByteBufferCapacity1);
          // TODO : use malloc here instead of realloc.  We don't need to copy the data, and if we free first then we can either slot the new memory in the old slot or it can be moved
          void * const aNewThreadByteBuffer = realloc(m_aThreadByteBuffer1, m_cThreadByteBufferCapacity1);
          if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
@@ -104,35 +103,71 @@ public:
       return m_aThreadByteBuffer1;
    }
 
-   EBM_INLINE bool GrowThreadByteBuffer2(const size_t cByteBoundaries) {
-      // by adding cByteBoundaries and shifting our existing size, we do 2 things:
-      //   1) we ensure that if we have zero size, we'll get some size that we'll get a non-zero size after the shift
-      //   2) we'll always get back an odd number of items, which is good because we always have an odd number of TreeNodeChilden
-      EBM_ASSERT(0 == m_cThreadByteBufferCapacity2 % cByteBoundaries);
-      m_cThreadByteBufferCapacity2 = cByteBoundaries + (m_cThreadByteBufferCapacity2 << 1);
-      LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer2 to %zu", m_cThreadByteBufferCapacity2);
-      // TODO : use malloc here.  our tree objects have internal pointers, so we're going to dispose of our work anyways
-      // There is no way to check if the array was re-allocated or not without invoking undefined behavior, so we don't get a benefit if the array can be resized with realloc
-      void * const aNewThreadByteBuffer = realloc(m_aThreadByteBuffer2, m_cThreadByteBufferCapacity2);
-      if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
-         // according to the realloc spec, if realloc fails to allocate the new memory, it returns nullptr BUT the old memory is valid.
-         // we leave m_aThreadByteBuffer1 alone in this instance and will free that memory later in the destructor
-         return true;
+   // GrowDecisionTree asks for enough room for the largest tree that it could build before it starts, so it never needs to grow this partway through a
+   // tree, and since each tree is built from scratch, releasing the previous tree is free.  Once we've seen the largest tree, we stop allocating
+   EBM_INLINE void * GetThreadByteBuffer2(const size_t cBytesRequired) {
+      if(UNLIKELY(m_cThreadByteBufferCapacity2 < cBytesRequired)) {
+         // our tree objects have internal pointers, so there's nothing worth preserving like realloc would
+         free(m_aThreadByteBuffer2);
+         m_aThreadByteBuffer2 = nullptr;
+         m_cThreadByteBufferCapacity2 = 0;
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer2 to %zu", cBytesRequired);
+         EBM_ASSERT(nullptr != m_pStatistics);
+         m_pStatistics->Add(StatisticBytesAllocated, cBytesRequired);
+         void * const aNewThreadByteBuffer = malloc(cBytesRequired);
+         if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
+            return nullptr;
+         }
+         m_aThreadByteBuffer2 = aNewThreadByteBuffer;
+         m_cThreadByteBufferCapacity2 = cBytesRequired;
       }
-      m_aThreadByteBuffer2 = aNewThreadByteBuffer;
-      return false;
+      return m_aThreadByteBuffer2;
    }
 
-   EBM_INLINE void * GetThreadByteBuffer2() {
-      return m_aThreadByteBuffer2;
+   EBM_INLINE void * GetThreadByteBuffer3(const size_t cBytesRequired) {
+      if(UNLIKELY(m_cThreadByteBufferCapacity3 < cBytesRequired)) {
+         // we overwrite the entire buffer each time, so don't bother preserving the old contents like realloc would
+         free(m_aThreadByteBuffer3);
+         m_aThreadByteBuffer3 = nullptr;
+         m_cThreadByteBufferCapacity3 = 0;
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::ThreadByteBuffer3 to %zu", cBytesRequired);
+         EBM_ASSERT(nullptr != m_pStatistics);
+         m_pStatistics->Add(StatisticBytesAllocated, cBytesRequired);
+         void * const aNewThreadByteBuffer = malloc(cBytesRequired);
+         if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
+            return nullptr;
+         }
+         m_aThreadByteBuffer3 = aNewThreadByteBuffer;
+         m_cThreadByteBufferCapacity3 = cBytesRequired;
+      }
+      return m_aThreadByteBuffer3;
    }
 
-   EBM_INLINE size_t GetThreadByteBuffer2Size() const {
-      return m_cThreadByteBufferCapacity2;
+   // like GetThreadByteBuffer2, GrowDecisionTree asks for the largest frontier that its tree could have, so pushing onto the heap never allocates
+   EBM_INLINE TreeNode<bClassification> ** GetTreeNodeSplitFrontier(const size_t cTreeNodesMax) {
+      if(UNLIKELY(m_cTreeNodeSplitFrontierCapacity < cTreeNodesMax)) {
+         free(m_apTreeNodeSplitFrontier);
+         m_apTreeNodeSplitFrontier = nullptr;
+         m_cTreeNodeSplitFrontierCapacity = 0;
+         if(IsMultiplyError(sizeof(TreeNode<bClassification> *), cTreeNodesMax)) {
+            LOG_0(TraceLevelWarning, "WARNING GetTreeNodeSplitFrontier IsMultiplyError(sizeof(TreeNode<bClassification> *), cTreeNodesMax)");
+            return nullptr;
+         }
+         LOG_N(TraceLevelInfo, "Growing CachedTrainingThreadResources::TreeNodeSplitFrontier to %zu", cTreeNodesMax);
+         EBM_ASSERT(nullptr != m_pStatistics);
+         m_pStatistics->Add(StatisticBytesAllocated, sizeof(TreeNode<bClassification> *) * cTreeNodesMax);
+         TreeNode<bClassification> ** const apNewTreeNodeSplitFrontier = static_cast<TreeNode<bClassification> **>(malloc(sizeof(TreeNode<bClassification> *) * cTreeNodesMax));
+         if(UNLIKELY(nullptr == apNewTreeNodeSplitFrontier)) {
+            return nullptr;
+         }
+         m_apTreeNodeSplitFrontier = apNewTreeNodeSplitFrontier;
+         m_cTreeNodeSplitFrontierCapacity = cTreeNodesMax;
+      }
+      return m_apTreeNodeSplitFrontier;
    }
 
    EBM_INLINE bool IsError() const {
-      return m_bError || nullptr == m_aSumHistogramBucketVectorEntry || nullptr == m_aSumHistogramBucketVectorEntry1 || nullptr == m_aSumHistogramBucketVectorEntryBest || nullptr == m_aSumResidualErrors2;
+      return nullptr == m_aSumHistogramBucketVectorEntry || nullptr == m_aSumHistogramBucketVectorEntry1 || nullptr == m_aSumHistogramBucketVectorEntryBest || nullptr == m_aSumResidualErrors2;
    }
 };
 
@@ -143,9 +178,13 @@ class CachedInteractionThreadResources {
 
 public:
 
+   // the statistics of the EbmInteractionState that owns us.  Set before each use
+   PhaseStatistics * m_pStatistics;
+
    CachedInteractionThreadResources()
       : m_aThreadByteBuffer1(nullptr)
-      , m_cThreadByteBufferCapacity1(0) {
+      , m_cThreadByteBufferCapacity1(0)
+      , m_pStatistics(nullptr) {
    }
 
    ~CachedInteractionThreadResources() {
@@ -160,6 +199,8 @@ public:
       if(UNLIKELY(m_cThreadByteBufferCapacity1 < cBytesRequired)) {
          m_cThreadByteBufferCapacity1 = cBytesRequired << 1;
          LOG_N(TraceLevelInfo, "Growing CachedInteractionThreadResources::ThreadByteBuffer1 to %zu", m_cThreadByteBufferCapacity1);
+         EBM_ASSERT(nullptr != m_pStatistics);
+         m_pStatistics->Add(StatisticBytesAllocated, m_cThreadByteBufferCapacity1);
          // TODO : use malloc here instead of realloc.  We don't need to copy the data, and if we free first then we can either slot the new memory in the old slot or it can be moved
          void * const aNewThreadByteBuffer = realloc(m_aThreadByteBuffer1, m_cThreadByteBufferCapacity1);
          if(UNLIKELY(nullptr == aNewThreadByteBuffer)) {
@@ -6,15 +6,33 @@
 
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <limits> // numeric_limits
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // FeatureTypeCore
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCore.h"
+#include "FeatureCombinationCore.h"
+#include "DataSetByFeatureCombination.h"
 #include "DataSetByFeature.h"
 #include "InitializeResiduals.h"
 
-EBM_INLINE static const FractionalDataType * ConstructResidualErrors(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+// we compute float residuals in FractionalDataType through this many instances at a time, so that we never need the full FractionalDataType buffer
+constexpr size_t k_cInstancesPerFloatResidualChunk = 65536;
+
+EBM_INLINE static void InitializeResidualsAnyType(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, FractionalDataType * const aResidualErrors, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+      InitializeResiduals<k_Regression>(cInstances, aTargetData, aPredictorScores, aResidualErrors, k_Regression);
+   } else {
+      if(ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses) {
+         InitializeResiduals<2>(cInstances, aTargetData, aPredictorScores, aResidualErrors, ptrdiff_t { 2 });
+      } else {
+         InitializeResiduals<k_DynamicClassification>(cInstances, aTargetData, aPredictorScores, aResidualErrors, runtimeLearningTypeOrCountTargetClasses);
+      }
+   }
+}
+
+EBM_INLINE static const void * ConstructResidualErrors(const size_t cInstances, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const bool bFloatResiduals) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeature::ConstructResidualErrors");
 
    EBM_ASSERT(1 <= cInstances);
@@ -30,29 +48,92 @@ EBM_INLINE static const FractionalDataType * ConstructResidualErrors(const size_
 
    const size_t cElements = cInstances * cVectorLength;
 
-   if(IsMultiplyError(sizeof(FractionalDataType), cElements)) {
-      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(FractionalDataType), cElements)");
+   if(!bFloatResiduals) {
+      if(IsMultiplyError(sizeof(FractionalDataType), cElements)) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(FractionalDataType), cElements)");
+         return nullptr;
+      }
+
+      const size_t cBytes = sizeof(FractionalDataType) * cElements;
+      FractionalDataType * aResidualErrors = static_cast<FractionalDataType *>(malloc(cBytes));
+      if(nullptr == aResidualErrors) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors nullptr == aResidualErrors");
+         return nullptr;
+      }
+
+      InitializeResidualsAnyType(cInstances, aTargetData, aPredictorScores, aResidualErrors, runtimeLearningTypeOrCountTargetClasses);
+
+      LOG_0(TraceLevelInfo, "Exited DataSetByFeature::ConstructResidualErrors");
+      return aResidualErrors;
+   }
+
+   if(IsMultiplyError(sizeof(float), cElements)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(float), cElements)");
+      return nullptr;
+   }
+   float * const aResidualErrors = static_cast<float *>(malloc(sizeof(float) * cElements));
+   if(nullptr == aResidualErrors) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors nullptr == aResidualErrors");
       return nullptr;
    }
 
-   const size_t cBytes = sizeof(FractionalDataType) * cElements;
-   FractionalDataType * aResidualErrors = static_cast<FractionalDataType *>(malloc(cBytes));
+   const size_t cInstancesPerChunk = cInstances < k_cInstancesPerFloatResidualChunk ? cInstances : k_cInstancesPerFloatResidualChunk;
+   // cInstancesPerChunk * cVectorLength <= cElements, and we already allocated cElements floats, so this can only overflow as FractionalDataType
+   if(IsMultiplyError(sizeof(FractionalDataType), cInstancesPerChunk * cVectorLength)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors IsMultiplyError(sizeof(FractionalDataType), cInstancesPerChunk * cVectorLength)");
+      free(aResidualErrors);
+      return nullptr;
+   }
+   FractionalDataType * const aResidualErrorsChunk = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cInstancesPerChunk * cVectorLength));
+   if(nullptr == aResidualErrorsChunk) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructResidualErrors nullptr == aResidualErrorsChunk");
+      free(aResidualErrors);
+      return nullptr;
+   }
 
-   if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
-      InitializeResiduals<k_Regression>(cInstances, aTargetData, aPredictorScores, aResidualErrors, k_Regression);
-   } else {
-      if(ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses) {
-         InitializeResiduals<2>(cInstances, aTargetData, aPredictorScores, aResidualErrors, ptrdiff_t { 2 });
-      } else {
-         InitializeResiduals<k_DynamicClassification>(cInstances, aTargetData, aPredictorScores, aResidualErrors, runtimeLearningTypeOrCountTargetClasses);
-      }
+   float * pResidualError = aResidualErrors;
+   for(size_t iInstanceStart = 0; iInstanceStart < cInstances; iInstanceStart += cInstancesPerChunk) {
+      const size_t cInstancesChunk = cInstancesPerChunk < cInstances - iInstanceStart ? cInstancesPerChunk : cInstances - iInstanceStart;
+      const void * const aTargetDataChunk = IsRegression(runtimeLearningTypeOrCountTargetClasses) ?
+         static_cast<const void *>(static_cast<const FractionalDataType *>(aTargetData) + iInstanceStart) :
+         static_cast<const void *>(static_cast<const IntegerDataType *>(aTargetData) + iInstanceStart);
+      const FractionalDataType * const aPredictorScoresChunk = nullptr == aPredictorScores ? nullptr : aPredictorScores + iInstanceStart * cVectorLength;
+
+      InitializeResidualsAnyType(cInstancesChunk, aTargetDataChunk, aPredictorScoresChunk, aResidualErrorsChunk, runtimeLearningTypeOrCountTargetClasses);
+
+      const FractionalDataType * pResidualErrorChunk = aResidualErrorsChunk;
+      const FractionalDataType * const pResidualErrorChunkEnd = aResidualErrorsChunk + cInstancesChunk * cVectorLength;
+      do {
+         *pResidualError = static_cast<float>(*pResidualErrorChunk);
+         ++pResidualError;
+         ++pResidualErrorChunk;
+      } while(pResidualErrorChunkEnd != pResidualErrorChunk);
    }
+   EBM_ASSERT(aResidualErrors + cElements == pResidualError);
+   free(aResidualErrorsChunk);
 
    LOG_0(TraceLevelInfo, "Exited DataSetByFeature::ConstructResidualErrors");
    return aResidualErrors;
 }
 
-EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData) {
+EBM_INLINE static size_t ChooseCountBytesPerBin(const size_t cFeatures, const FeatureCore * const aFeatures) {
+   size_t cBinsMax = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const size_t cBins = aFeatures[iFeature].m_cBins;
+      cBinsMax = cBinsMax < cBins ? cBins : cBinsMax;
+   }
+   // bin indexes go from 0 to cBins - 1, so a type that holds cBins - 1 is sufficient
+   if(cBinsMax <= size_t { 1 } + static_cast<size_t>(std::numeric_limits<unsigned char>::max())) {
+      return sizeof(unsigned char);
+   }
+   if(cBinsMax <= size_t { 1 } + static_cast<size_t>(std::numeric_limits<unsigned short>::max())) {
+      return sizeof(unsigned short);
+   }
+   return sizeof(StorageDataTypeCore);
+}
+
+template<typename TBin>
+EBM_INLINE static const void * const * ConstructInputData(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeature::ConstructInputData");
 
    EBM_ASSERT(0 < cFeatures);
@@ -60,29 +141,29 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
    EBM_ASSERT(0 < cInstances);
    EBM_ASSERT(nullptr != aBinnedData);
 
-   if(IsMultiplyError(sizeof(StorageDataTypeCore), cInstances)) {
+   if(IsMultiplyError(sizeof(TBin), cInstances)) {
       // we're checking this early instead of checking it inside our loop
-      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData IsMultiplyError(sizeof(StorageDataTypeCore), cInstances)");
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData IsMultiplyError(sizeof(TBin), cInstances)");
       return nullptr;
    }
-   const size_t cSubBytesData = sizeof(StorageDataTypeCore) * cInstances;
+   const size_t cSubBytesData = sizeof(TBin) * cInstances;
 
    if(IsMultiplyError(sizeof(void *), cFeatures)) {
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData IsMultiplyError(sizeof(void *), cFeatures)");
       return nullptr;
    }
    const size_t cBytesMemoryArray = sizeof(void *) * cFeatures;
-   StorageDataTypeCore ** const aaInputDataTo = static_cast<StorageDataTypeCore * *>(malloc(cBytesMemoryArray));
+   void ** const aaInputDataTo = static_cast<void * *>(malloc(cBytesMemoryArray));
    if(nullptr == aaInputDataTo) {
       LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData nullptr == aaInputDataTo");
       return nullptr;
    }
 
-   StorageDataTypeCore ** paInputDataTo = aaInputDataTo;
+   void ** paInputDataTo = aaInputDataTo;
    const FeatureCore * pFeature = aFeatures;
    const FeatureCore * const pFeatureEnd = aFeatures + cFeatures;
    do {
-      StorageDataTypeCore * pInputDataTo = static_cast<StorageDataTypeCore *>(malloc(cSubBytesData));
+      TBin * pInputDataTo = static_cast<TBin *>(malloc(cSubBytesData));
       if(nullptr == pInputDataTo) {
          LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputData nullptr == pInputDataTo");
          goto free_all;
@@ -97,8 +178,8 @@ EBM_INLINE static const StorageDataTypeCore * const * ConstructInputData(const s
          EBM_ASSERT(0 <= data);
          EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(data))); // data must be lower than cBins and cBins fits into a size_t which we checked earlier
          EBM_ASSERT(static_cast<size_t>(data) < pFeature->m_cBins);
-         EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, IntegerDataType>(data)));
-         *pInputDataTo = static_cast<StorageDataTypeCore>(data);
+         EBM_ASSERT((IsNumberConvertable<TBin, IntegerDataType>(data))); // ChooseCountBytesPerBin picked a TBin that holds every bin index
+         *pInputDataTo = static_cast<TBin>(data);
          ++pInputDataTo;
          ++pInputDataFrom;
       } while(pInputDataFromEnd != pInputDataFrom);
@@ -118,30 +199,107 @@ free_all:
    return nullptr;
 }
 
-DataSetByFeature::DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses)
-   : m_aResidualErrors(ConstructResidualErrors(cInstances, aTargetData, aPredictorScores, runtimeLearningTypeOrCountTargetClasses))
-   , m_aaInputData(0 == cFeatures ? nullptr : ConstructInputData(cFeatures, aFeatures, cInstances, aBinnedData))
+EBM_INLINE static const void * const * ConstructInputDataCompact(const size_t cBytesPerBin, const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData) {
+   if(0 == cFeatures) {
+      return nullptr;
+   }
+   if(sizeof(unsigned char) == cBytesPerBin) {
+      return ConstructInputData<unsigned char>(cFeatures, aFeatures, cInstances, aBinnedData);
+   }
+   if(sizeof(unsigned short) == cBytesPerBin) {
+      return ConstructInputData<unsigned short>(cFeatures, aFeatures, cInstances, aBinnedData);
+   }
+   EBM_ASSERT(sizeof(StorageDataTypeCore) == cBytesPerBin);
+   return ConstructInputData<StorageDataTypeCore>(cFeatures, aFeatures, cInstances, aBinnedData);
+}
+
+DataSetByFeature::DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aBinnedData, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const bool bFloatResiduals)
+   : m_cBytesPerResidual(bFloatResiduals ? sizeof(float) : sizeof(FractionalDataType))
+   , m_aResidualErrors(ConstructResidualErrors(cInstances, aTargetData, aPredictorScores, runtimeLearningTypeOrCountTargetClasses, bFloatResiduals))
+   , m_cBytesPerBin(ChooseCountBytesPerBin(cFeatures, aFeatures))
+   , m_aaInputData(ConstructInputDataCompact(m_cBytesPerBin, cFeatures, aFeatures, cInstances, aBinnedData))
    , m_cInstances(cInstances)
-   , m_cFeatures(cFeatures) {
+   , m_cFeatures(cFeatures)
+   , m_pTrainingSet(nullptr)
+   , m_acItemsPerBitPackDataUnit(nullptr) {
 
    EBM_ASSERT(0 < cInstances);
 }
 
+EBM_INLINE static const void * const * ConstructInputDataView(const DataSetByFeatureCombination * const pTrainingSet, const size_t cFeatures, const FeatureCombinationCore * const * const apFeatureCombinationsByFeature) {
+   if(0 == cFeatures) {
+      return nullptr;
+   }
+   if(IsMultiplyError(sizeof(void *), cFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputDataView IsMultiplyError(sizeof(void *), cFeatures)");
+      return nullptr;
+   }
+   const void ** const aaInputData = static_cast<const void * *>(malloc(sizeof(void *) * cFeatures));
+   if(nullptr == aaInputData) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructInputDataView nullptr == aaInputData");
+      return nullptr;
+   }
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinationsByFeature[iFeature];
+      aaInputData[iFeature] = nullptr == pFeatureCombination ? nullptr : pTrainingSet->GetInputDataPointer(pFeatureCombination);
+   }
+   return aaInputData;
+}
+
+EBM_INLINE static const size_t * ConstructItemsPerBitPackDataUnit(const size_t cFeatures, const FeatureCombinationCore * const * const apFeatureCombinationsByFeature) {
+   if(0 == cFeatures) {
+      return nullptr;
+   }
+   if(IsMultiplyError(sizeof(size_t), cFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructItemsPerBitPackDataUnit IsMultiplyError(sizeof(size_t), cFeatures)");
+      return nullptr;
+   }
+   size_t * const acItemsPerBitPackDataUnit = static_cast<size_t *>(malloc(sizeof(size_t) * cFeatures));
+   if(nullptr == acItemsPerBitPackDataUnit) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeature::ConstructItemsPerBitPackDataUnit nullptr == acItemsPerBitPackDataUnit");
+      return nullptr;
+   }
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinationsByFeature[iFeature];
+      EBM_ASSERT(nullptr == pFeatureCombination || 1 == pFeatureCombination->m_cFeatures);
+      acItemsPerBitPackDataUnit[iFeature] = nullptr == pFeatureCombination ? size_t { 0 } : pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   }
+   return acItemsPerBitPackDataUnit;
+}
+
+DataSetByFeature::DataSetByFeature(const DataSetByFeatureCombination * const pTrainingSet, const size_t cFeatures, const FeatureCombinationCore * const * const apFeatureCombinationsByFeature)
+   : m_cBytesPerResidual(sizeof(FractionalDataType))
+   , m_aResidualErrors(pTrainingSet->GetResidualPointer())
+   , m_cBytesPerBin(sizeof(StorageDataTypeCore))
+   , m_aaInputData(ConstructInputDataView(pTrainingSet, cFeatures, apFeatureCombinationsByFeature))
+   , m_cInstances(pTrainingSet->GetCountInstances())
+   , m_cFeatures(cFeatures)
+   , m_pTrainingSet(pTrainingSet)
+   , m_acItemsPerBitPackDataUnit(ConstructItemsPerBitPackDataUnit(cFeatures, apFeatureCombinationsByFeature)) {
+
+   EBM_ASSERT(0 < m_cInstances);
+}
+
 DataSetByFeature::~DataSetByFeature() {
    LOG_0(TraceLevelInfo, "Entered ~DataSetByFeature");
 
-   FractionalDataType * aResidualErrors = const_cast<FractionalDataType *>(m_aResidualErrors);
-   free(aResidualErrors);
-   if(nullptr != m_aaInputData) {
-      EBM_ASSERT(1 <= m_cFeatures);
-      const StorageDataTypeCore * const * paInputData = m_aaInputData;
-      const StorageDataTypeCore * const * const paInputDataEnd = m_aaInputData + m_cFeatures;
-      do {
-         EBM_ASSERT(nullptr != *paInputData);
-         free(const_cast<StorageDataTypeCore *>(*paInputData));
-         ++paInputData;
-      } while(paInputDataEnd != paInputData);
-      free(const_cast<StorageDataTypeCore * *>(m_aaInputData));
+   if(nullptr != m_pTrainingSet) {
+      // the residuals and the columns that we view belong to the training set
+      free(const_cast<void * *>(m_aaInputData));
+      free(const_cast<size_t *>(m_acItemsPerBitPackDataUnit));
+   } else {
+      free(const_cast<void *>(m_aResidualErrors));
+      if(nullptr != m_aaInputData) {
+         EBM_ASSERT(1 <= m_cFeatures);
+         const void * const * paInputData = m_aaInputData;
+         const void * const * const paInputDataEnd = m_aaInputData + m_cFeatures;
+         do {
+            EBM_ASSERT(nullptr != *paInputData);
+            free(const_cast<void *>(*paInputData));
+            ++paInputData;
+         } while(paInputDataEnd != paInputData);
+         free(const_cast<void * *>(m_aaInputData));
+      }
    }
 
    LOG_0(TraceLevelInfo, "Exited ~DataSetByFeature");
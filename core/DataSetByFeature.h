@@ -11,32 +11,84 @@
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCore.h"
+#include "FeatureCombinationCore.h"
+#include "DataSetByFeatureCombination.h"
 
+// DataSetByFeature keeps one bin column per feature for interaction detection.  Every column is stored with the narrowest unsigned type that holds the
+// largest m_cBins of any feature (unsigned char, unsigned short, or StorageDataTypeCore), so with typical bin counts the columns take an eighth of
+// the memory and bandwidth that full StorageDataTypeCore columns would.  We pick one width per DataSetByFeature instead of one per feature so that our
+// binning kernels only need to be compiled once per width instead of once per combination of widths.  The residuals are either FractionalDataType or,
+// if our caller asks for it, float.
+//
+// A DataSetByFeature can instead view the training set of an EbmTrainingState, in which case it owns nothing but two small arrays.  Each feature's
+// column is then the bit packed data of the feature's single feature combination, and the residuals are the training set's current residuals
 class DataSetByFeature final {
-   const FractionalDataType * const m_aResidualErrors;
-   const StorageDataTypeCore * const * const m_aaInputData;
+   const size_t m_cBytesPerResidual;
+   const void * const m_aResidualErrors;
+   const size_t m_cBytesPerBin;
+   const void * const * const m_aaInputData;
    const size_t m_cInstances;
    const size_t m_cFeatures;
 
+   // nullptr unless we view a training set.  m_acItemsPerBitPackDataUnit holds the packing of each feature's column, or 0 for features that have a
+   // single bin and so no column
+   const DataSetByFeatureCombination * const m_pTrainingSet;
+   const size_t * const m_acItemsPerBitPackDataUnit;
+
 public:
 
-   DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses);
+   DataSetByFeature(const size_t cFeatures, const FeatureCore * const aFeatures, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargetData, const FractionalDataType * const aPredictorScores, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const bool bFloatResiduals);
+   // views pTrainingSet, which needs to outlive us.  apFeatureCombinationsByFeature holds the single feature combination of each feature that has more
+   // than one bin, and nullptr for the others
+   DataSetByFeature(const DataSetByFeatureCombination * const pTrainingSet, const size_t cFeatures, const FeatureCombinationCore * const * const apFeatureCombinationsByFeature);
    ~DataSetByFeature();
 
    EBM_INLINE bool IsError() const {
-      return nullptr == m_aResidualErrors || (0 != m_cFeatures && nullptr == m_aaInputData);
+      return nullptr == m_aResidualErrors || (0 != m_cFeatures && nullptr == m_aaInputData) || (nullptr != m_pTrainingSet && 0 != m_cFeatures && nullptr == m_acItemsPerBitPackDataUnit);
    }
 
-   EBM_INLINE const FractionalDataType * GetResidualPointer() const {
+   template<typename TResidual>
+   EBM_INLINE const TResidual * GetResidualPointer() const {
       EBM_ASSERT(nullptr != m_aResidualErrors);
-      return m_aResidualErrors;
+      EBM_ASSERT(sizeof(TResidual) == m_cBytesPerResidual);
+      return static_cast<const TResidual *>(m_aResidualErrors);
+   }
+   EBM_INLINE size_t GetCountBytesPerResidual() const {
+      return m_cBytesPerResidual;
    }
    // TODO: we can change this to take the m_iFeatureData value directly, which we get from a loop index
-   EBM_INLINE const StorageDataTypeCore * GetInputDataPointer(const FeatureCore * const pFeature) const {
+   template<typename TBin>
+   EBM_INLINE const TBin * GetInputDataPointer(const FeatureCore * const pFeature) const {
       EBM_ASSERT(nullptr != pFeature);
       EBM_ASSERT(pFeature->m_iFeatureData < m_cFeatures);
       EBM_ASSERT(nullptr != m_aaInputData);
-      return m_aaInputData[pFeature->m_iFeatureData];
+      EBM_ASSERT(nullptr == m_pTrainingSet);
+      EBM_ASSERT(sizeof(TBin) == m_cBytesPerBin);
+      return static_cast<const TBin *>(m_aaInputData[pFeature->m_iFeatureData]);
+   }
+   EBM_INLINE size_t GetCountBytesPerBin() const {
+      EBM_ASSERT(nullptr == m_pTrainingSet);
+      return m_cBytesPerBin;
+   }
+   EBM_INLINE bool IsTrainingSetView() const {
+      return nullptr != m_pTrainingSet;
+   }
+   EBM_INLINE const StorageDataTypeCore * GetBitPackedInputDataPointer(const FeatureCore * const pFeature) const {
+      EBM_ASSERT(nullptr != pFeature);
+      EBM_ASSERT(pFeature->m_iFeatureData < m_cFeatures);
+      EBM_ASSERT(nullptr != m_pTrainingSet);
+      EBM_ASSERT(nullptr != m_aaInputData[pFeature->m_iFeatureData]);
+      return static_cast<const StorageDataTypeCore *>(m_aaInputData[pFeature->m_iFeatureData]);
+   }
+   EBM_INLINE size_t GetCountItemsPerBitPackDataUnit(const FeatureCore * const pFeature) const {
+      EBM_ASSERT(nullptr != pFeature);
+      EBM_ASSERT(pFeature->m_iFeatureData < m_cFeatures);
+      EBM_ASSERT(nullptr != m_acItemsPerBitPackDataUnit);
+      return m_acItemsPerBitPackDataUnit[pFeature->m_iFeatureData];
+   }
+   // when we view a training set with sparse columns, each instance's true residual is its stored residual minus this shift.  See SparseColumn.h
+   EBM_INLINE FractionalDataType GetResidualShift() const {
+      return nullptr == m_pTrainingSet || !m_pTrainingSet->HasSparseColumns() ? FractionalDataType { 0 } : m_pTrainingSet->GetResidualShift();
    }
    EBM_INLINE size_t GetCountInstances() const {
       return m_cInstances;
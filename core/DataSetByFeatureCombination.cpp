@@ -7,6 +7,8 @@
 #include <string.h> // memset
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
+#include <type_traits> // is_same, make_unsigned
+#include <limits> // numeric_limits
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // FeatureTypeCore
@@ -40,6 +42,49 @@ EBM_INLINE static FractionalDataType * ConstructResidualErrors(const size_t cIns
    return aResidualErrors;
 }
 
+// we can only read our caller's targets in place if IntegerDataType and StorageDataTypeCore are the signed and unsigned versions of the same type, since
+// that's the only case where C++ allows us to read one through a pointer to the other
+constexpr bool k_bBorrowableTargetData = std::is_same<std::make_unsigned<IntegerDataType>::type, StorageDataTypeCore>::value;
+
+EBM_INLINE static bool IsBorrowingPredictorScores(const bool bAllocatePredictorScores, const bool bBorrowBuffers, const FractionalDataType * const aPredictorScoresFrom) {
+   return bAllocatePredictorScores && bBorrowBuffers && nullptr != aPredictorScoresFrom;
+}
+
+EBM_INLINE static bool IsBorrowingTargetData(const bool bAllocateTargetData, const bool bBorrowBuffers) {
+   return bAllocateTargetData && bBorrowBuffers && k_bBorrowableTargetData;
+}
+
+EBM_INLINE static void ZeroLogits(const size_t cInstances, const size_t cVectorLength, FractionalDataType * const aPredictorScores) {
+   constexpr bool bZeroingLogits = 0 <= k_iZeroClassificationLogitAtInitialize;
+   if(bZeroingLogits) {
+      FractionalDataType * pScore = aPredictorScores;
+      const FractionalDataType * const pScoreExteriorEnd = pScore + cVectorLength * cInstances;
+      do {
+         FractionalDataType scoreShift = pScore[k_iZeroClassificationLogitAtInitialize];
+         const FractionalDataType * const pScoreInteriorEnd = pScore + cVectorLength;
+         do {
+            *pScore -= scoreShift;
+            ++pScore;
+         } while(pScoreInteriorEnd != pScore);
+      } while(pScoreExteriorEnd != pScore);
+   }
+}
+
+EBM_INLINE static FractionalDataType * BorrowPredictorScores(const size_t cInstances, const size_t cVectorLength, const FractionalDataType * const aPredictorScoresFrom) {
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::BorrowPredictorScores");
+
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(0 < cVectorLength);
+   EBM_ASSERT(nullptr != aPredictorScoresFrom);
+
+   // our caller asked us to keep their predictor scores up to date in place instead of keeping our own copy
+   FractionalDataType * const aPredictorScores = const_cast<FractionalDataType *>(aPredictorScoresFrom);
+   ZeroLogits(cInstances, cVectorLength, aPredictorScores);
+
+   LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::BorrowPredictorScores");
+   return aPredictorScores;
+}
+
 EBM_INLINE static FractionalDataType * ConstructPredictorScores(const size_t cInstances, const size_t cVectorLength, const FractionalDataType * const aPredictorScoresFrom) {
    LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::ConstructPredictorScores");
 
@@ -69,20 +114,8 @@ EBM_INLINE static FractionalDataType * ConstructPredictorScores(const size_t cIn
       memset(aPredictorScoresTo, 0, cBytes);
    } else {
       memcpy(aPredictorScoresTo, aPredictorScoresFrom, cBytes);
-      constexpr bool bZeroingLogits = 0 <= k_iZeroClassificationLogitAtInitialize;
-      if(bZeroingLogits) {
-         // TODO : integrate this subtraction into the copy instead of doing it afterwards
-         FractionalDataType * pScore = aPredictorScoresTo;
-         const FractionalDataType * const pScoreExteriorEnd = pScore + cVectorLength * cInstances;
-         do {
-            FractionalDataType scoreShift = pScore[k_iZeroClassificationLogitAtInitialize];
-            const FractionalDataType * const pScoreInteriorEnd = pScore + cVectorLength;
-            do {
-               *pScore -= scoreShift;
-               ++pScore;
-            } while(pScoreInteriorEnd != pScore);
-         } while(pScoreExteriorEnd != pScore);
-      }
+      // TODO : integrate this subtraction into the copy instead of doing it afterwards
+      ZeroLogits(cInstances, cVectorLength, aPredictorScoresTo);
    }
 
    LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::ConstructPredictorScores");
@@ -262,27 +295,98 @@ free_all:
    return nullptr;
 }
 
-DataSetByFeatureCombination::DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
+DataSetByFeatureCombination::DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const bool bBorrowBuffers, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
    : m_aResidualErrors(bAllocateResidualErrors ? ConstructResidualErrors(cInstances, cVectorLength) : static_cast<FractionalDataType *>(nullptr))
-   , m_aPredictorScores(bAllocatePredictorScores ? ConstructPredictorScores(cInstances, cVectorLength, aPredictorScoresFrom) : static_cast<FractionalDataType *>(nullptr))
-   , m_aTargetData(bAllocateTargetData ? ConstructTargetData(cInstances, static_cast<const IntegerDataType *>(aTargets)) : static_cast<const StorageDataTypeCore *>(nullptr))
+   , m_aPredictorScores(!bAllocatePredictorScores ? static_cast<FractionalDataType *>(nullptr) : IsBorrowingPredictorScores(bAllocatePredictorScores, bBorrowBuffers, aPredictorScoresFrom) ? BorrowPredictorScores(cInstances, cVectorLength, aPredictorScoresFrom) : ConstructPredictorScores(cInstances, cVectorLength, aPredictorScoresFrom))
+   , m_aTargetData(!bAllocateTargetData ? static_cast<const StorageDataTypeCore *>(nullptr) : IsBorrowingTargetData(bAllocateTargetData, bBorrowBuffers) ? reinterpret_cast<const StorageDataTypeCore *>(aTargets) : ConstructTargetData(cInstances, static_cast<const IntegerDataType *>(aTargets)))
    , m_aaInputData(0 == cFeatureCombinations ? nullptr : ConstructInputData(cFeatureCombinations, apFeatureCombination, cInstances, aInputDataFrom))
    , m_cInstances(cInstances)
    , m_cFeatureCombinations(cFeatureCombinations) 
    , m_bAllocateResidualErrors(bAllocateResidualErrors)
    , m_bAllocatePredictorScores(bAllocatePredictorScores)
-   , m_bAllocateTargetData(bAllocateTargetData) {
+   , m_bAllocateTargetData(bAllocateTargetData)
+   , m_bOwnPredictorScores(!IsBorrowingPredictorScores(bAllocatePredictorScores, bBorrowBuffers, aPredictorScoresFrom))
+   , m_bOwnTargetData(!IsBorrowingTargetData(bAllocateTargetData, bBorrowBuffers))
+   , m_bOwnInputData(true)
+   , m_aWeights(nullptr)
+   , m_weightTotal(static_cast<FractionalDataType>(cInstances))
+   , m_aSparseColumns(nullptr)
+   , m_residualShift(0)
+   , m_aInstanceLosses(nullptr)
+   , m_bInstanceLossesCurrent(false) {
    EBM_ASSERT(0 < cInstances);
 }
 
+DataSetByFeatureCombination::DataSetByFeatureCombination(const size_t cFeatureCombinations, const StorageDataTypeCore * const * const aaInputData, const size_t cInstances, const bool bAllocateTargetData, const void * const aTargets)
+   : m_aResidualErrors(nullptr)
+   , m_aPredictorScores(nullptr)
+   , m_aTargetData(!bAllocateTargetData ? static_cast<const StorageDataTypeCore *>(nullptr) : IsBorrowingTargetData(bAllocateTargetData, true) ? reinterpret_cast<const StorageDataTypeCore *>(aTargets) : ConstructTargetData(cInstances, static_cast<const IntegerDataType *>(aTargets)))
+   , m_aaInputData(aaInputData)
+   , m_cInstances(cInstances)
+   , m_cFeatureCombinations(cFeatureCombinations)
+   , m_bAllocateResidualErrors(false)
+   , m_bAllocatePredictorScores(false)
+   , m_bAllocateTargetData(bAllocateTargetData)
+   , m_bOwnPredictorScores(true)
+   , m_bOwnTargetData(!IsBorrowingTargetData(bAllocateTargetData, true))
+   , m_bOwnInputData(false)
+   , m_aWeights(nullptr)
+   , m_weightTotal(static_cast<FractionalDataType>(cInstances))
+   , m_aSparseColumns(nullptr)
+   , m_residualShift(0)
+   , m_aInstanceLosses(nullptr)
+   , m_bInstanceLossesCurrent(false) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(0 == cFeatureCombinations || nullptr != aaInputData);
+}
+
+DataSetByFeatureCombination::DataSetByFeatureCombination(const DataSetByFeatureCombination * const pDataSetShared, const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bBorrowBuffers, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength)
+   : m_aResidualErrors(bAllocateResidualErrors ? ConstructResidualErrors(pDataSetShared->m_cInstances, cVectorLength) : static_cast<FractionalDataType *>(nullptr))
+   , m_aPredictorScores(!bAllocatePredictorScores ? static_cast<FractionalDataType *>(nullptr) : IsBorrowingPredictorScores(bAllocatePredictorScores, bBorrowBuffers, aPredictorScoresFrom) ? BorrowPredictorScores(pDataSetShared->m_cInstances, cVectorLength, aPredictorScoresFrom) : ConstructPredictorScores(pDataSetShared->m_cInstances, cVectorLength, aPredictorScoresFrom))
+   , m_aTargetData(pDataSetShared->m_aTargetData)
+   , m_aaInputData(pDataSetShared->m_aaInputData)
+   , m_cInstances(pDataSetShared->m_cInstances)
+   , m_cFeatureCombinations(pDataSetShared->m_cFeatureCombinations)
+   , m_bAllocateResidualErrors(bAllocateResidualErrors)
+   , m_bAllocatePredictorScores(bAllocatePredictorScores)
+   , m_bAllocateTargetData(pDataSetShared->m_bAllocateTargetData)
+   , m_bOwnPredictorScores(!IsBorrowingPredictorScores(bAllocatePredictorScores, bBorrowBuffers, aPredictorScoresFrom))
+   , m_bOwnTargetData(false)
+   , m_bOwnInputData(false)
+   , m_aWeights(nullptr)
+   , m_weightTotal(static_cast<FractionalDataType>(pDataSetShared->m_cInstances))
+   , m_aSparseColumns(nullptr)
+   , m_residualShift(0)
+   , m_aInstanceLosses(nullptr)
+   , m_bInstanceLossesCurrent(false) {
+   EBM_ASSERT(!pDataSetShared->IsError());
+   EBM_ASSERT(0 < m_cInstances);
+}
+
+static void FreeSparseColumns(const size_t cFeatureCombinations, SparseColumn * const aSparseColumns) {
+   if(nullptr != aSparseColumns) {
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         free(aSparseColumns[iFeatureCombination].m_aExceptions);
+      }
+      free(aSparseColumns);
+   }
+}
+
 DataSetByFeatureCombination::~DataSetByFeatureCombination() {
    LOG_0(TraceLevelInfo, "Entered ~DataSetByFeatureCombination");
 
    free(m_aResidualErrors);
-   free(m_aPredictorScores);
-   free(const_cast<StorageDataTypeCore *>(m_aTargetData));
+   free(m_aWeights);
+   free(m_aInstanceLosses);
+   FreeSparseColumns(m_cFeatureCombinations, m_aSparseColumns);
+   if(m_bOwnPredictorScores) {
+      free(m_aPredictorScores);
+   }
+   if(m_bOwnTargetData) {
+      free(const_cast<StorageDataTypeCore *>(m_aTargetData));
+   }
 
-   if(nullptr != m_aaInputData) {
+   if(m_bOwnInputData && nullptr != m_aaInputData) {
       EBM_ASSERT(0 < m_cFeatureCombinations);
       const StorageDataTypeCore * const * paInputData = m_aaInputData;
       const StorageDataTypeCore * const * const paInputDataEnd = m_aaInputData + m_cFeatureCombinations;
@@ -295,3 +399,205 @@ DataSetByFeatureCombination::~DataSetByFeatureCombination() {
 
    LOG_0(TraceLevelInfo, "Exited ~DataSetByFeatureCombination");
 }
+
+bool DataSetByFeatureCombination::SetWeights(const FractionalDataType * const aWeights) {
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::SetWeights");
+
+   free(m_aWeights);
+   m_aWeights = nullptr;
+   m_weightTotal = static_cast<FractionalDataType>(m_cInstances);
+   if(nullptr != aWeights) {
+      EBM_ASSERT(0 < m_cInstances);
+      if(IsMultiplyError(sizeof(FractionalDataType), m_cInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::SetWeights IsMultiplyError(sizeof(FractionalDataType), m_cInstances)");
+         return true;
+      }
+      FractionalDataType * const aWeightsCopy = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * m_cInstances));
+      if(nullptr == aWeightsCopy) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::SetWeights nullptr == aWeightsCopy");
+         return true;
+      }
+      FractionalDataType weightTotal = 0;
+      for(size_t iInstance = 0; iInstance < m_cInstances; ++iInstance) {
+         const FractionalDataType weight = aWeights[iInstance];
+         aWeightsCopy[iInstance] = weight;
+         weightTotal += weight;
+      }
+      m_aWeights = aWeightsCopy;
+      m_weightTotal = weightTotal;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::SetWeights");
+   return false;
+}
+
+bool DataSetByFeatureCombination::AllocateInstanceLosses() {
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::AllocateInstanceLosses");
+
+   EBM_ASSERT(nullptr == m_aInstanceLosses);
+   EBM_ASSERT(0 < m_cInstances);
+   if(IsMultiplyError(sizeof(FractionalDataType), m_cInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::AllocateInstanceLosses IsMultiplyError(sizeof(FractionalDataType), m_cInstances)");
+      return true;
+   }
+   m_aInstanceLosses = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * m_cInstances));
+   if(nullptr == m_aInstanceLosses) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::AllocateInstanceLosses nullptr == m_aInstanceLosses");
+      return true;
+   }
+   m_bInstanceLossesCurrent = false;
+
+   LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::AllocateInstanceLosses");
+   return false;
+}
+
+// calls callback(iInstance, iBin) for each instance of a single feature combination in instance order, unpacking the bins the same way that the
+// training loops do
+template<typename TCallback>
+static void UnpackSingleFeatureBins(const FeatureCombinationCore * const pFeatureCombination, const StorageDataTypeCore * const aInputData, const size_t cInstances, TCallback & callback) {
+   const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cBitsForStorageType);
+   const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+   EBM_ASSERT(1 <= cBitsPerItemMax);
+   EBM_ASSERT(cBitsPerItemMax <= k_cBitsForStorageType);
+   const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
+
+   const StorageDataTypeCore * pInputData = aInputData;
+   size_t iInstance = 0;
+   while(iInstance < cInstances) {
+      size_t iTensorBinCombined = static_cast<size_t>(*pInputData);
+      ++pInputData;
+      const size_t cItems = cInstances - iInstance < cItemsPerBitPackDataUnit ? cInstances - iInstance : cItemsPerBitPackDataUnit;
+      for(size_t iItem = 0; iItem < cItems; ++iItem) {
+         callback(iInstance, maskBits & iTensorBinCombined);
+         iTensorBinCombined >>= cBitsPerItemMax;
+         ++iInstance;
+      }
+   }
+}
+
+struct CountBinsCallback final {
+   size_t * m_aBinCounts;
+
+   EBM_INLINE void operator() (const size_t iInstance, const size_t iBin) {
+      UNUSED(iInstance);
+      ++m_aBinCounts[iBin];
+   }
+};
+
+struct RecordExceptionsCallback final {
+   SparseException * m_pException;
+   size_t m_iDominantBin;
+
+   EBM_INLINE void operator() (const size_t iInstance, const size_t iBin) {
+      if(m_iDominantBin != iBin) {
+         m_pException->m_iInstance = iInstance;
+         m_pException->m_iBin = iBin;
+         ++m_pException;
+      }
+   }
+};
+
+bool DataSetByFeatureCombination::BuildSparseColumns(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination) {
+   LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination::BuildSparseColumns");
+
+   EBM_ASSERT(nullptr == m_aSparseColumns);
+   EBM_ASSERT(0 < m_cInstances);
+   EBM_ASSERT(cFeatureCombinations == m_cFeatureCombinations);
+
+   if(0 == m_cFeatureCombinations) {
+      LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::BuildSparseColumns with no feature combinations");
+      return false;
+   }
+   if(IsMultiplyError(sizeof(SparseColumn), m_cFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::BuildSparseColumns IsMultiplyError(sizeof(SparseColumn), m_cFeatureCombinations)");
+      return true;
+   }
+   SparseColumn * const aSparseColumns = static_cast<SparseColumn *>(malloc(sizeof(SparseColumn) * m_cFeatureCombinations));
+   if(nullptr == aSparseColumns) {
+      LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::BuildSparseColumns nullptr == aSparseColumns");
+      return true;
+   }
+   for(size_t iInputData = 0; iInputData < m_cFeatureCombinations; ++iInputData) {
+      aSparseColumns[iInputData].m_aExceptions = nullptr;
+      aSparseColumns[iInputData].m_cExceptions = 0;
+      aSparseColumns[iInputData].m_iDominantBin = 0;
+   }
+
+   // the instances that a sparse column may hold as exceptions.  Written this way so that we round down
+   const size_t cExceptionsMax = static_cast<size_t>((FractionalDataType { 1 } - k_sparseDominantBinFractionMin) * static_cast<FractionalDataType>(m_cInstances));
+
+   size_t * aBinCounts = nullptr;
+   size_t cBinCountsCapacity = 0;
+   bool bSparse = false;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const FeatureCombinationCore * const pFeatureCombination = apFeatureCombination[iFeatureCombination];
+      EBM_ASSERT(nullptr != pFeatureCombination);
+      if(1 != pFeatureCombination->m_cFeatures) {
+         continue;
+      }
+      SparseColumn * const pSparseColumn = &aSparseColumns[pFeatureCombination->m_iInputData];
+      if(nullptr != pSparseColumn->m_aExceptions) {
+         // another feature combination over the same input data already built this column
+         continue;
+      }
+      const size_t cBins = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
+      if(cBinCountsCapacity < cBins) {
+         free(aBinCounts);
+         // the feature's bins were allocated as tensors elsewhere, so this can't overflow
+         EBM_ASSERT(!IsMultiplyError(sizeof(size_t), cBins));
+         aBinCounts = static_cast<size_t *>(malloc(sizeof(size_t) * cBins));
+         if(nullptr == aBinCounts) {
+            LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::BuildSparseColumns nullptr == aBinCounts");
+            FreeSparseColumns(m_cFeatureCombinations, aSparseColumns);
+            return true;
+         }
+         cBinCountsCapacity = cBins;
+      }
+      memset(aBinCounts, 0, sizeof(size_t) * cBins);
+
+      const StorageDataTypeCore * const aInputData = GetInputDataPointer(pFeatureCombination);
+      CountBinsCallback countBins { aBinCounts };
+      UnpackSingleFeatureBins(pFeatureCombination, aInputData, m_cInstances, countBins);
+
+      size_t iDominantBin = 0;
+      for(size_t iBin = 1; iBin < cBins; ++iBin) {
+         if(aBinCounts[iDominantBin] < aBinCounts[iBin]) {
+            iDominantBin = iBin;
+         }
+      }
+      const size_t cExceptions = m_cInstances - aBinCounts[iDominantBin];
+      if(cExceptionsMax < cExceptions) {
+         continue;
+      }
+      // allocate at least one so that a feature that never leaves its dominant bin is still recognizably sparse
+      const size_t cExceptionsAllocated = 0 == cExceptions ? size_t { 1 } : cExceptions;
+      EBM_ASSERT(!IsMultiplyError(sizeof(SparseException), cExceptionsAllocated)); // we have an instance for each exception
+      SparseException * const aExceptions = static_cast<SparseException *>(malloc(sizeof(SparseException) * cExceptionsAllocated));
+      if(nullptr == aExceptions) {
+         LOG_0(TraceLevelWarning, "WARNING DataSetByFeatureCombination::BuildSparseColumns nullptr == aExceptions");
+         free(aBinCounts);
+         FreeSparseColumns(m_cFeatureCombinations, aSparseColumns);
+         return true;
+      }
+      RecordExceptionsCallback recordExceptions { aExceptions, iDominantBin };
+      UnpackSingleFeatureBins(pFeatureCombination, aInputData, m_cInstances, recordExceptions);
+      EBM_ASSERT(aExceptions + cExceptions == recordExceptions.m_pException);
+
+      pSparseColumn->m_aExceptions = aExceptions;
+      pSparseColumn->m_cExceptions = cExceptions;
+      pSparseColumn->m_iDominantBin = iDominantBin;
+      bSparse = true;
+   }
+   free(aBinCounts);
+
+   if(bSparse) {
+      m_aSparseColumns = aSparseColumns;
+   } else {
+      free(aSparseColumns);
+   }
+
+   LOG_0(TraceLevelInfo, "Exited DataSetByFeatureCombination::BuildSparseColumns");
+   return false;
+}
@@ -12,6 +12,7 @@
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
 #include "FeatureCombinationCore.h"
+#include "SparseColumn.h"
 
 // TODO: let's take how clean this class is (with almost everything const and the arrays constructed in initialization list) and apply it to as many other classes as we can
 class DataSetByFeatureCombination final {
@@ -25,10 +26,35 @@ class DataSetByFeatureCombination final {
    const bool m_bAllocateResidualErrors;
    const bool m_bAllocatePredictorScores;
    const bool m_bAllocateTargetData;
+   // if bBorrowBuffers is set, m_aPredictorScores and m_aTargetData can point into our caller's buffers, which we then don't own
+   const bool m_bOwnPredictorScores;
+   const bool m_bOwnTargetData;
+   // datasets that view an EbmTrainingDataSet share its bit packed input data and target data and own only their residuals and predictor scores
+   const bool m_bOwnInputData;
+
+   // instance weights arrive after we're constructed, so unlike our other arrays these aren't const.  m_aWeights is nullptr when we're unweighted,
+   // in which case m_weightTotal is our instance count
+   FractionalDataType * m_aWeights;
+   FractionalDataType m_weightTotal;
+
+   // indexed like m_aaInputData, or nullptr if none of our feature combinations are stored sparsely.  See SparseColumn.h
+   SparseColumn * m_aSparseColumns;
+   // when we have sparse columns, each instance's true residual is its stored residual minus m_residualShift.  Updates that move every instance in a
+   // dominant bin, or every instance for the intercept, add to the shift instead of writing to each residual
+   FractionalDataType m_residualShift;
+
+   // the unweighted loss of each instance as of the last time that we computed our validation metric, or nullptr if we don't keep them.  Instances whose
+   // scores haven't moved since then can reuse their loss instead of recomputing it.  m_bInstanceLossesCurrent is false until the losses are filled and
+   // whenever scores have moved without their losses being recomputed
+   FractionalDataType * m_aInstanceLosses;
+   bool m_bInstanceLossesCurrent;
 
 public:
 
-   DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
+   DataSetByFeatureCombination(const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bAllocateTargetData, const bool bBorrowBuffers, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination, const size_t cInstances, const IntegerDataType * const aInputDataFrom, const void * const aTargets, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
+   // aaInputData is already bit packed and belongs to our caller, who needs to keep it alive until we are deleted
+   DataSetByFeatureCombination(const size_t cFeatureCombinations, const StorageDataTypeCore * const * const aaInputData, const size_t cInstances, const bool bAllocateTargetData, const void * const aTargets);
+   DataSetByFeatureCombination(const DataSetByFeatureCombination * const pDataSetShared, const bool bAllocateResidualErrors, const bool bAllocatePredictorScores, const bool bBorrowBuffers, const FractionalDataType * const aPredictorScoresFrom, const size_t cVectorLength);
    ~DataSetByFeatureCombination();
 
    EBM_INLINE bool IsError() const {
@@ -64,6 +90,54 @@ public:
    EBM_INLINE size_t GetCountFeatureCombinations() const {
       return m_cFeatureCombinations;
    }
+   // nullptr if we don't have instance weights
+   EBM_INLINE const FractionalDataType * GetWeights() const {
+      return m_aWeights;
+   }
+   EBM_INLINE FractionalDataType GetWeightTotal() const {
+      return m_weightTotal;
+   }
+   EBM_INLINE bool HasSparseColumns() const {
+      return nullptr != m_aSparseColumns;
+   }
+   // nullptr if pFeatureCombination is stored densely
+   EBM_INLINE const SparseColumn * GetSparseColumn(const FeatureCombinationCore * const pFeatureCombination) const {
+      EBM_ASSERT(nullptr != pFeatureCombination);
+      EBM_ASSERT(pFeatureCombination->m_iInputData < m_cFeatureCombinations);
+      if(nullptr == m_aSparseColumns) {
+         return nullptr;
+      }
+      const SparseColumn * const pSparseColumn = &m_aSparseColumns[pFeatureCombination->m_iInputData];
+      return nullptr == pSparseColumn->m_aExceptions ? nullptr : pSparseColumn;
+   }
+   EBM_INLINE FractionalDataType GetResidualShift() const {
+      return m_residualShift;
+   }
+   EBM_INLINE void SetResidualShift(const FractionalDataType residualShift) {
+      EBM_ASSERT(nullptr != m_aSparseColumns);
+      m_residualShift = residualShift;
+   }
+   // stores each single feature combination whose dominant bin holds at least k_sparseDominantBinFractionMin of our instances as a SparseColumn
+   // alongside its bit packed data.  Returns true on allocation failure, in which case we're left without any sparse columns
+   bool BuildSparseColumns(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombination);
+
+   // nullptr if we don't keep per-instance losses
+   EBM_INLINE FractionalDataType * GetInstanceLosses() {
+      return m_aInstanceLosses;
+   }
+   EBM_INLINE bool AreInstanceLossesCurrent() const {
+      return m_bInstanceLossesCurrent;
+   }
+   EBM_INLINE void SetInstanceLossesCurrent(const bool bInstanceLossesCurrent) {
+      EBM_ASSERT(!bInstanceLossesCurrent || nullptr != m_aInstanceLosses);
+      m_bInstanceLossesCurrent = bInstanceLossesCurrent;
+   }
+   // starts keeping one loss per instance, which aren't current until our validation metric is next computed.  Returns true on allocation failure
+   bool AllocateInstanceLosses();
+
+   // copies aWeights, which has one weight per instance, or goes back to being unweighted if aWeights is nullptr.  Returns true on allocation failure,
+   // in which case we're left unweighted
+   bool SetWeights(const FractionalDataType * const aWeights);
 };
 
 #endif // DATA_SET_BY_FEATURE_COMBINATION_H
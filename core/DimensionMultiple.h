@@ -6,6 +6,7 @@
 #define DIMENSION_MULTIPLE_H
 
 #include <type_traits> // std::is_standard_layout
+#include <cmath> // std::isnan
 #include <stddef.h> // size_t, ptrdiff_t
 
 #include "EbmInternal.h" // EBM_INLINE
@@ -13,15 +14,18 @@
 #include "SegmentedTensor.h"
 #include "EbmStatistics.h"
 #include "CachedThreadResources.h"
+#include "PhaseStatistics.h"
 #include "FeatureCore.h"
 #include "SamplingWithReplacement.h"
 #include "HistogramBucket.h"
+#include "ThreadPool.h"
+#include "HistogramCache.h"
 
 #ifndef NDEBUG
 
 // TODO: remove the templating on these debug functions.  We don't need to replicate this function 63 times!!
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
-void GetTotalsDebugSlow(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiStart, const size_t * const aiLast, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRet) {
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted, bool bClassificationBucket>
+void GetTotalsDebugSlow(const HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiStart, const size_t * const aiLast, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<bClassificationBucket> * const pRet) {
    const size_t cDimensions = GET_ATTRIBUTE_COMBINATION_DIMENSIONS(countCompilerDimensions, pFeatureCombination->m_cFeatures);
    EBM_ASSERT(1 <= cDimensions); // why bother getting totals if we just have 1 bin
    size_t aiDimensions[k_cDimensionsMax];
@@ -43,14 +47,14 @@ void GetTotalsDebugSlow(const HistogramBucket<IsClassification(compilerLearningT
    } while(iDimensionInitialize < cDimensions);
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we've allocated this, so it should fit
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
-   pRet->Zero(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we've allocated this, so it should fit
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
+   pRet->Zero(cVectorLength, bWeighted);
 
    while(true) {
-      const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucket = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, iTensorBin);
+      const HistogramBucket<bClassificationBucket> * const pHistogramBucket = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, iTensorBin);
 
-      pRet->Add(*pHistogramBucket, cVectorLength);
+      pRet->Add(*pHistogramBucket, cVectorLength, bWeighted);
 
       size_t iDimension = 0;
       size_t valueMultipleLoop = 1;
@@ -75,11 +79,11 @@ void GetTotalsDebugSlow(const HistogramBucket<IsClassification(compilerLearningT
 }
 
 // TODO: remove the templating on these debug functions.  We don't need to replicate this function 63 times!!
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
-void CompareTotalsDebug(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiPoint, const size_t directionVector, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pComparison) {
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted, bool bClassificationBucket>
+void CompareTotalsDebug(const HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiPoint, const size_t directionVector, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const HistogramBucket<bClassificationBucket> * const pComparison) {
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
 
    size_t aiStart[k_cDimensionsMax];
    size_t aiLast[k_cDimensionsMax];
@@ -96,10 +100,10 @@ void CompareTotalsDebug(const HistogramBucket<IsClassification(compilerLearningT
       directionVectorDestroy >>= 1;
    }
 
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pComparison2 = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesPerHistogramBucket));
+   HistogramBucket<bClassificationBucket> * const pComparison2 = static_cast<HistogramBucket<bClassificationBucket> *>(malloc(cBytesPerHistogramBucket));
    if(nullptr != pComparison2) {
       // if we can't obtain the memory, then don't do the comparison and exit
-      GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pComparison2);
+      GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted, bClassificationBucket>(aHistogramBuckets, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pComparison2);
       EBM_ASSERT(pComparison->m_cInstancesInBucket == pComparison2->m_cInstancesInBucket);
       free(pComparison2);
    }
@@ -386,8 +390,7 @@ void CompareTotalsDebug(const HistogramBucket<IsClassification(compilerLearningT
 //- have a look at our final dimensionality.Is the totals calculation the bottleneck, or the point to corner totals function ?
 //- I think I understand the costs of all implementations of point to corner computation, so don't implement the (1,1,...,1,1) to point algorithm yet.. try implementing the more optimized totals calculation (with more memory).  After we have the optimized totals calculation, then try to re-do the splitting code to do splitting at the same time as totals calculation.  If that isn't better than our existing stuff, then optimzie the point to corner calculation code
 //- implement a function that calcualtes the total of any volume using just the(0, 0, ..., 0, 0) totals ..as a debugging function.We might use this for trying out more complicated splits where we allow 2 splits on some axies
-// TODO: build a pair and triple specific version of this function.  For pairs we can get ride of the pPrevious and just use the actual cell at (-1,-1) from our current cell, and we can use two loops with everything in memory [look at code above from before we incoporated the previous totals].  Triples would also benefit from pulling things out since we have low iterations of the inner loop and we can access indicies directly without additional add/subtract/bit operations.  Beyond triples, the combinatorial choices start to explode, so we should probably use this general N-dimensional code.
-// TODO: after we build pair and triple specific versions of this function, we don't need to have a compiler countCompilerDimensions, since the compiler won't really be able to simpify the loops that are exploding in dimensionality
+// TODO: build a triple specific version of this function like BuildFastTotalsPairKernel below.  Triples would also benefit from pulling things out since we have low iterations of the inner loop and we can access indicies directly without additional add/subtract/bit operations.  Beyond triples, the combinatorial choices start to explode, so we should probably use this general N-dimensional code.
 // TODO: sort our N-dimensional combinations at program startup so that the longest dimension is first!  That way we can more efficiently walk through contiguous memory better in this function!
 template<bool bClassification>
 struct FastTotalState {
@@ -397,25 +400,134 @@ struct FastTotalState {
    size_t m_iCur;
    size_t m_cBins;
 };
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
-void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const FeatureCombinationCore * const pFeatureCombination, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pBucketAuxiliaryBuildZone
+// for pairs the general code below keeps one running total for the first dimension and one per column of the second dimension.  We keep exactly the same
+// running totals and add them in the same order, so the totals are bit for bit identical to the general code's, but we walk the tensor with two plain
+// loops instead of ringing through FastTotalState for every cell.  Our auxillary zone holds the running row total in bucket 0 followed by the cBins1
+// running column totals, which is the same 1 + cBins1 buckets that our callers reserve for the general code
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted, bool bClassificationBucket>
+EBM_INLINE void BuildFastTotalsPairKernel(HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const FeatureCombinationCore * const pFeatureCombination, HistogramBucket<bClassificationBucket> * const pBucketAuxiliaryBuildZone
 #ifndef NDEBUG
-   , const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
+   , const HistogramBucket<bClassificationBucket> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
 ) {
+   LOG_0(TraceLevelVerbose, "Entered BuildFastTotalsPairKernel");
+
+   EBM_ASSERT(2 == pFeatureCombination->m_cFeatures);
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
+
+   const size_t cBins1 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
+   const size_t cBins2 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[1].m_pFeature->m_cBins;
+   EBM_ASSERT(1 <= cBins1); // this function can handle 1 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value)
+   EBM_ASSERT(1 <= cBins2); // this function can handle 1 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value)
+
+   HistogramBucket<bClassificationBucket> * const pRowTotal = pBucketAuxiliaryBuildZone;
+   HistogramBucket<bClassificationBucket> * const aColumnTotals = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pBucketAuxiliaryBuildZone, 1);
+   EBM_ASSERT(!IsMultiplyError(cBins1 + 1, cBytesPerHistogramBucket)); // our caller allocated this auxillary space
+   const size_t cBytesAuxiliaryBuildZone = (cBins1 + 1) * cBytesPerHistogramBucket;
+   EBM_ASSERT(reinterpret_cast<unsigned char *>(pBucketAuxiliaryBuildZone) + cBytesAuxiliaryBuildZone <= aHistogramBucketsEndDebug);
+
+#ifndef NDEBUG
+   for(size_t iBucketDebug = 0; iBucketDebug <= cBins1; ++iBucketDebug) {
+      GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pBucketAuxiliaryBuildZone, iBucketDebug)->AssertZero(cVectorLength, bWeighted);
+   }
+   HistogramBucket<bClassificationBucket> * const pDebugBucket = static_cast<HistogramBucket<bClassificationBucket> *>(malloc(cBytesPerHistogramBucket));
+#endif //NDEBUG
+
+   HistogramBucket<bClassificationBucket> * pHistogramBucket = aHistogramBuckets;
+   for(size_t iBin2 = 0; iBin2 < cBins2; ++iBin2) {
+      HistogramBucket<bClassificationBucket> * pColumnTotal = aColumnTotals;
+      for(size_t iBin1 = 0; iBin1 < cBins1; ++iBin1) {
+         ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucket, aHistogramBucketsEndDebug);
+         ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pColumnTotal, aHistogramBucketsEndDebug);
+
+         pColumnTotal->Add(*pHistogramBucket, cVectorLength, bWeighted);
+         pRowTotal->Add(*pColumnTotal, cVectorLength, bWeighted);
+         pHistogramBucket->Copy(*pRowTotal, cVectorLength, bWeighted);
+
+#ifndef NDEBUG
+         if(nullptr != aHistogramBucketsDebugCopy && nullptr != pDebugBucket) {
+            size_t aiStart[k_cDimensionsMax];
+            size_t aiLast[k_cDimensionsMax];
+            aiStart[0] = 0;
+            aiStart[1] = 0;
+            aiLast[0] = iBin1;
+            aiLast[1] = iBin2;
+            GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, 2, bWeighted, bClassificationBucket>(aHistogramBucketsDebugCopy, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pDebugBucket);
+            EBM_ASSERT(pDebugBucket->m_cInstancesInBucket == pHistogramBucket->m_cInstancesInBucket);
+         }
+#endif // NDEBUG
+
+         pHistogramBucket = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pHistogramBucket, 1);
+         pColumnTotal = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pColumnTotal, 1);
+      }
+      pRowTotal->Zero(cVectorLength, bWeighted);
+   }
+   // the general code leaves the auxillary zone zeroed when it exits, so we do the same
+   memset(pBucketAuxiliaryBuildZone, 0, cBytesAuxiliaryBuildZone);
+
+#ifndef NDEBUG
+   free(pDebugBucket);
+#endif // NDEBUG
+
+   LOG_0(TraceLevelVerbose, "Exited BuildFastTotalsPairKernel");
+}
+
+// bClassificationBucket picks the bucket layout.  Training keeps the denominator for classification, but interaction detection passes false for
+// every learning type since its scores only use the counts and residual sums
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted, bool bClassificationBucket = IsClassification(compilerLearningTypeOrCountTargetClasses)>
+void BuildFastTotals(HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const FeatureCombinationCore * const pFeatureCombination, HistogramBucket<bClassificationBucket> * pBucketAuxiliaryBuildZone
+#ifndef NDEBUG
+   , const HistogramBucket<bClassificationBucket> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(2 == countCompilerDimensions) {
+      BuildFastTotalsPairKernel<compilerLearningTypeOrCountTargetClasses, bWeighted, bClassificationBucket>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, pBucketAuxiliaryBuildZone
+#ifndef NDEBUG
+         , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+
+#ifndef NDEBUG
+      if(nullptr != aHistogramBucketsDebugCopy) {
+         // our pair kernel promises the same totals as the runtime dimension code, bit for bit, so build them again from the binned copy with that code
+         // in a scratch tensor that has its own auxillary zone, and compare every bucket
+         const size_t cVectorLengthDebug = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+         const size_t cBytesPerHistogramBucketDebug = GetHistogramBucketSize<bClassificationBucket>(cVectorLengthDebug, bWeighted);
+         const size_t cBins1Debug = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
+         const size_t cBins2Debug = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[1].m_pFeature->m_cBins;
+         // our caller allocated the tensor and the auxillary zone with these sizes, so none of this overflows
+         const size_t cBytesTensorDebug = cBins1Debug * cBins2Debug * cBytesPerHistogramBucketDebug;
+         const size_t cBytesGeneralDebug = cBytesTensorDebug + (cBins1Debug + 1) * cBytesPerHistogramBucketDebug;
+         HistogramBucket<bClassificationBucket> * const aGeneralBucketsDebug = static_cast<HistogramBucket<bClassificationBucket> *>(malloc(cBytesGeneralDebug));
+         if(nullptr != aGeneralBucketsDebug) {
+            // if we can't allocate, don't fail.. just stop checking
+            memcpy(aGeneralBucketsDebug, aHistogramBucketsDebugCopy, cBytesTensorDebug);
+            memset(reinterpret_cast<unsigned char *>(aGeneralBucketsDebug) + cBytesTensorDebug, 0, cBytesGeneralDebug - cBytesTensorDebug);
+            BuildFastTotals<compilerLearningTypeOrCountTargetClasses, 0, bWeighted, bClassificationBucket>(aGeneralBucketsDebug, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucketDebug, aGeneralBucketsDebug, cBins1Debug * cBins2Debug), aHistogramBucketsDebugCopy, reinterpret_cast<unsigned char *>(aGeneralBucketsDebug) + cBytesGeneralDebug);
+            EBM_ASSERT(0 == memcmp(aGeneralBucketsDebug, aHistogramBuckets, cBytesTensorDebug));
+            free(aGeneralBucketsDebug);
+         }
+      }
+#endif // NDEBUG
+      return;
+   }
+
    LOG_0(TraceLevelVerbose, "Entered BuildFastTotals");
 
    const size_t cDimensions = GET_ATTRIBUTE_COMBINATION_DIMENSIONS(countCompilerDimensions, pFeatureCombination->m_cFeatures);
    EBM_ASSERT(1 <= cDimensions);
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
 
-   FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> fastTotalState[k_cDimensionsMax];
-   const FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pFastTotalStateEnd = &fastTotalState[cDimensions];
+   FastTotalState<bClassificationBucket> fastTotalState[k_cDimensionsMax];
+   const FastTotalState<bClassificationBucket> * const pFastTotalStateEnd = &fastTotalState[cDimensions];
    {
-      FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pFastTotalStateInitialize = fastTotalState;
+      FastTotalState<bClassificationBucket> * pFastTotalStateInitialize = fastTotalState;
       const FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry);
       size_t multiply = 1;
       EBM_ASSERT(0 < cDimensions);
@@ -431,7 +543,7 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
          pFastTotalStateInitialize->m_pDimensionalFirst = pBucketAuxiliaryBuildZone;
          pFastTotalStateInitialize->m_pDimensionalCur = pBucketAuxiliaryBuildZone;
          // when we exit, pBucketAuxiliaryBuildZone should be == to aHistogramBucketsEndDebug, which is legal in C++ since it doesn't extend beyond 1 item past the end of the array
-         pBucketAuxiliaryBuildZone = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pBucketAuxiliaryBuildZone, multiply);
+         pBucketAuxiliaryBuildZone = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pBucketAuxiliaryBuildZone, multiply);
 
 #ifndef NDEBUG
          if(pFastTotalStateEnd == pFastTotalStateInitialize + 1) {
@@ -442,8 +554,8 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
             // if this isn't the last iteration, then we'll actually be using this memory, so the entire bucket had better be useable
             EBM_ASSERT(reinterpret_cast<unsigned char *>(pBucketAuxiliaryBuildZone) + cBytesPerHistogramBucket <= aHistogramBucketsEndDebug);
          }
-         for(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pDimensionalCur = pFastTotalStateInitialize->m_pDimensionalCur; pBucketAuxiliaryBuildZone != pDimensionalCur; pDimensionalCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pDimensionalCur, 1)) {
-            pDimensionalCur->AssertZero(cVectorLength);
+         for(HistogramBucket<bClassificationBucket> * pDimensionalCur = pFastTotalStateInitialize->m_pDimensionalCur; pBucketAuxiliaryBuildZone != pDimensionalCur; pDimensionalCur = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pDimensionalCur, 1)) {
+            pDimensionalCur->AssertZero(cVectorLength, bWeighted);
          }
 #endif // NDEBUG
 
@@ -458,28 +570,28 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
    }
 
 #ifndef NDEBUG
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pDebugBucket = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesPerHistogramBucket));
+   HistogramBucket<bClassificationBucket> * const pDebugBucket = static_cast<HistogramBucket<bClassificationBucket> *>(malloc(cBytesPerHistogramBucket));
 #endif //NDEBUG
 
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucket = aHistogramBuckets;
+   HistogramBucket<bClassificationBucket> * pHistogramBucket = aHistogramBuckets;
 
    while(true) {
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucket, aHistogramBucketsEndDebug);
 
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pAddPrev = pHistogramBucket;
+      HistogramBucket<bClassificationBucket> * pAddPrev = pHistogramBucket;
       size_t iDimension = cDimensions;
       do {
          --iDimension;
-         HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pAddTo = fastTotalState[iDimension].m_pDimensionalCur;
-         pAddTo->Add(*pAddPrev, cVectorLength);
+         HistogramBucket<bClassificationBucket> * pAddTo = fastTotalState[iDimension].m_pDimensionalCur;
+         pAddTo->Add(*pAddPrev, cVectorLength, bWeighted);
          pAddPrev = pAddTo;
-         pAddTo = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAddTo, 1);
+         pAddTo = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pAddTo, 1);
          if(pAddTo == fastTotalState[iDimension].m_pDimensionalWrap) {
             pAddTo = fastTotalState[iDimension].m_pDimensionalFirst;
          }
          fastTotalState[iDimension].m_pDimensionalCur = pAddTo;
       } while(0 != iDimension);
-      pHistogramBucket->Copy(*pAddPrev, cVectorLength);
+      pHistogramBucket->Copy(*pAddPrev, cVectorLength, bWeighted);
 
 #ifndef NDEBUG
       if(nullptr != aHistogramBucketsDebugCopy && nullptr != pDebugBucket) {
@@ -489,15 +601,15 @@ void BuildFastTotals(HistogramBucket<IsClassification(compilerLearningTypeOrCoun
             aiStart[iDebugDimension] = 0;
             aiLast[iDebugDimension] = fastTotalState[iDebugDimension].m_iCur;
          }
-         GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBucketsDebugCopy, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pDebugBucket);
+         GetTotalsDebugSlow<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted, bClassificationBucket>(aHistogramBucketsDebugCopy, pFeatureCombination, aiStart, aiLast, runtimeLearningTypeOrCountTargetClasses, pDebugBucket);
          EBM_ASSERT(pDebugBucket->m_cInstancesInBucket == pHistogramBucket->m_cInstancesInBucket);
       }
 #endif // NDEBUG
 
       // we're walking through all buckets, so just move to the next one in the flat array, with the knowledge that we'll figure out it's multi-dimenional index below
-      pHistogramBucket = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucket, 1);
+      pHistogramBucket = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, pHistogramBucket, 1);
 
-      FastTotalState<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pFastTotalState = &fastTotalState[0];
+      FastTotalState<bClassificationBucket> * pFastTotalState = &fastTotalState[0];
       while(true) {
          ++pFastTotalState->m_iCur;
          if(LIKELY(pFastTotalState->m_cBins != pFastTotalState->m_iCur)) {
@@ -701,22 +813,117 @@ struct TotalsDimension {
    size_t m_cLast;
 };
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
-void GetTotals(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiPoint, const size_t directionVector, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRet
+// for pairs our main space holds the totals from (0,0) to each cell, so the total of any of the 4 rectangles around a point is at most 4 lookups at corners
+// that we can compute directly.  We add and subtract the corners in the same order as the general permutation loop in GetTotals, so our results are
+// bit for bit identical to the general code's
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted, bool bClassificationBucket>
+EBM_INLINE void GetTotalsPair(const HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiPoint, const size_t directionVector, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<bClassificationBucket> * const pRet
 #ifndef NDEBUG
-   , const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
+   , const HistogramBucket<bClassificationBucket> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
 ) {
    // don't LOG this!  It would create way too much chatter!
 
+   EBM_ASSERT(2 == pFeatureCombination->m_cFeatures);
+   EBM_ASSERT(directionVector <= 0x3);
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
+
+   const size_t cBins1 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
+   const size_t cBins2 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[1].m_pFeature->m_cBins;
+   EBM_ASSERT(aiPoint[0] < cBins1);
+   EBM_ASSERT(aiPoint[1] < cBins2);
+
+   // the index of the point and of the far edge in each dimension.  The rectangles on the high side of a dimension are the totals at the far edge minus the totals at the point
+   const size_t iPoint1 = aiPoint[0];
+   const size_t iLast1 = cBins1 - 1;
+   EBM_ASSERT(!IsMultiplyError(cBins1, cBins2)); // we're accessing allocated memory, so this needs to multiply
+   const size_t iPoint2 = cBins1 * aiPoint[1];
+   const size_t iLast2 = cBins1 * (cBins2 - 1);
+
+   const HistogramBucket<bClassificationBucket> * const pPointPoint = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, iPoint1 + iPoint2);
+   ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pRet, aHistogramBucketsEndDebug);
+   ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pPointPoint, aHistogramBucketsEndDebug);
+   if(0x0 == directionVector) {
+      pRet->Copy(*pPointPoint, cVectorLength, bWeighted);
+   } else if(0x3 != directionVector) {
+      const HistogramBucket<bClassificationBucket> * const pLast = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, 0x1 == directionVector ? iLast1 + iPoint2 : iPoint1 + iLast2);
+      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pLast, aHistogramBucketsEndDebug);
+      pRet->Zero(cVectorLength, bWeighted);
+      pRet->Subtract(*pPointPoint, cVectorLength, bWeighted);
+      pRet->Add(*pLast, cVectorLength, bWeighted);
+   } else {
+      const HistogramBucket<bClassificationBucket> * const pLastPoint = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, iLast1 + iPoint2);
+      const HistogramBucket<bClassificationBucket> * const pPointLast = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, iPoint1 + iLast2);
+      const HistogramBucket<bClassificationBucket> * const pLastLast = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, iLast1 + iLast2);
+      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pLastPoint, aHistogramBucketsEndDebug);
+      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pPointLast, aHistogramBucketsEndDebug);
+      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pLastLast, aHistogramBucketsEndDebug);
+      pRet->Zero(cVectorLength, bWeighted);
+      pRet->Add(*pPointPoint, cVectorLength, bWeighted);
+      pRet->Subtract(*pLastPoint, cVectorLength, bWeighted);
+      pRet->Subtract(*pPointLast, cVectorLength, bWeighted);
+      pRet->Add(*pLastLast, cVectorLength, bWeighted);
+   }
+
+#ifndef NDEBUG
+   if(nullptr != aHistogramBucketsDebugCopy) {
+      CompareTotalsDebug<compilerLearningTypeOrCountTargetClasses, 2, bWeighted, bClassificationBucket>(aHistogramBucketsDebugCopy, pFeatureCombination, aiPoint, directionVector, runtimeLearningTypeOrCountTargetClasses, pRet);
+   }
+#endif // NDEBUG
+}
+
+// bClassificationBucket works as it does in BuildFastTotals
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted, bool bClassificationBucket = IsClassification(compilerLearningTypeOrCountTargetClasses)>
+void GetTotals(const HistogramBucket<bClassificationBucket> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const size_t * const aiPoint, const size_t directionVector, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<bClassificationBucket> * const pRet
+#ifndef NDEBUG
+   , const HistogramBucket<bClassificationBucket> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   // don't LOG this!  It would create way too much chatter!
+
+   if(2 == countCompilerDimensions) {
+      GetTotalsPair<compilerLearningTypeOrCountTargetClasses, bWeighted, bClassificationBucket>(aHistogramBuckets, pFeatureCombination, aiPoint, directionVector, runtimeLearningTypeOrCountTargetClasses, pRet
+#ifndef NDEBUG
+         , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+
+#ifndef NDEBUG
+      {
+         // our corner lookups promise the same totals as the permutation loop below, bit for bit.  The runtime dimension code checks that its result
+         // lies within its tensor, so we give it a scratch copy of the totals with one more bucket on the end to hold its result
+         const size_t cVectorLengthDebug = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+         const size_t cBytesPerHistogramBucketDebug = GetHistogramBucketSize<bClassificationBucket>(cVectorLengthDebug, bWeighted);
+         const size_t cBins1Debug = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
+         const size_t cBins2Debug = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[1].m_pFeature->m_cBins;
+         // our caller allocated the tensor with this size, so none of this overflows
+         const size_t cBytesTensorDebug = cBins1Debug * cBins2Debug * cBytesPerHistogramBucketDebug;
+         const size_t cBytesGeneralDebug = cBytesTensorDebug + cBytesPerHistogramBucketDebug;
+         HistogramBucket<bClassificationBucket> * const aGeneralBucketsDebug = static_cast<HistogramBucket<bClassificationBucket> *>(malloc(cBytesGeneralDebug));
+         if(nullptr != aGeneralBucketsDebug) {
+            // if we can't allocate, don't fail.. just stop checking
+            memcpy(aGeneralBucketsDebug, aHistogramBuckets, cBytesTensorDebug);
+            HistogramBucket<bClassificationBucket> * const pGeneralRetDebug = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucketDebug, aGeneralBucketsDebug, cBins1Debug * cBins2Debug);
+            GetTotals<compilerLearningTypeOrCountTargetClasses, 0, bWeighted, bClassificationBucket>(aGeneralBucketsDebug, pFeatureCombination, aiPoint, directionVector, runtimeLearningTypeOrCountTargetClasses, pGeneralRetDebug, nullptr, reinterpret_cast<unsigned char *>(aGeneralBucketsDebug) + cBytesGeneralDebug);
+            EBM_ASSERT(0 == memcmp(pGeneralRetDebug, pRet, cBytesPerHistogramBucketDebug));
+            free(aGeneralBucketsDebug);
+         }
+      }
+#endif // NDEBUG
+      return;
+   }
+
    static_assert(k_cDimensionsMax < k_cBitsForSizeTCore, "reserve the highest bit for bit manipulation space");
    const size_t cDimensions = GET_ATTRIBUTE_COMBINATION_DIMENSIONS(countCompilerDimensions, pFeatureCombination->m_cFeatures);
    EBM_ASSERT(1 <= cDimensions);
    EBM_ASSERT(cDimensions < k_cBitsForSizeTCore);
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassificationBucket>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassificationBucket>(cVectorLength, bWeighted);
 
    size_t multipleTotalInitialize = 1;
    size_t startingOffset = 0;
@@ -740,10 +947,10 @@ void GetTotals(const HistogramBucket<IsClassification(compilerLearningTypeOrCoun
          ++pFeatureCombinationEntry;
          ++piPointInitialize;
       } while(LIKELY(pFeatureCombinationEntryEnd != pFeatureCombinationEntry));
-      const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucket = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, startingOffset);
+      const HistogramBucket<bClassificationBucket> * const pHistogramBucket = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, startingOffset);
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pRet, aHistogramBucketsEndDebug);
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucket, aHistogramBucketsEndDebug);
-      pRet->Copy(*pHistogramBucket, cVectorLength);
+      pRet->Copy(*pHistogramBucket, cVectorLength, bWeighted);
       return;
    }
 
@@ -788,7 +995,7 @@ void GetTotals(const HistogramBucket<IsClassification(compilerLearningTypeOrCoun
    const unsigned int cAllBits = static_cast<unsigned int>(pTotalsDimensionEnd - totalsDimension);
    EBM_ASSERT(cAllBits < k_cBitsForSizeTCore);
 
-   pRet->Zero(cVectorLength);
+   pRet->Zero(cVectorLength, bWeighted);
 
    size_t permuteVector = 0;
    do {
@@ -804,28 +1011,28 @@ void GetTotals(const HistogramBucket<IsClassification(compilerLearningTypeOrCoun
          // TODO : this (pTotalsDimensionEnd != pTotalsDimensionLoop) condition is somewhat unpredictable since the number of dimensions is small.  Since the number of iterations will remain constant, we can use templates to move this check out of both loop to the completely non-looped outer body and then we eliminate a bunch of unpredictable branches AND a bunch of adds and a lot of other stuff.  If we allow ourselves to come at the vector from either size (0,0,...,0,0) or (1,1,...,1,1) then we only need to hardcode 63/2 loops.
       } while(LIKELY(pTotalsDimensionEnd != pTotalsDimensionLoop));
       // TODO : eliminate this multiplication of cBytesPerHistogramBucket by offsetPointer by multiplying both the startingOffset and the m_cLast & m_cIncrement values by cBytesPerHistogramBucket.  We can eliminate this multiplication each loop!
-      const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucket = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, offsetPointer);
+      const HistogramBucket<bClassificationBucket> * const pHistogramBucket = GetHistogramBucketByIndex<bClassificationBucket>(cBytesPerHistogramBucket, aHistogramBuckets, offsetPointer);
       // TODO : we can eliminate this really bad unpredictable branch if we use conditional negation on the values in pHistogramBucket.  We can pass in a bool that indicates if we should take the negation value or the original at each step (so we don't need to store it beyond one value either).  We would then have an Add(bool bSubtract, ...) function
       if(UNPREDICTABLE(0 != (1 & evenOdd))) {
          ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pRet, aHistogramBucketsEndDebug);
          ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucket, aHistogramBucketsEndDebug);
-         pRet->Subtract(*pHistogramBucket, cVectorLength);
+         pRet->Subtract(*pHistogramBucket, cVectorLength, bWeighted);
       } else {
          ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pRet, aHistogramBucketsEndDebug);
          ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucket, aHistogramBucketsEndDebug);
-         pRet->Add(*pHistogramBucket, cVectorLength);
+         pRet->Add(*pHistogramBucket, cVectorLength, bWeighted);
       }
       ++permuteVector;
    } while(LIKELY(0 == (permuteVector >> cAllBits)));
 
 #ifndef NDEBUG
    if(nullptr != aHistogramBucketsDebugCopy) {
-      CompareTotalsDebug<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBucketsDebugCopy, pFeatureCombination, aiPoint, directionVector, runtimeLearningTypeOrCountTargetClasses, pRet);
+      CompareTotalsDebug<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted, bClassificationBucket>(aHistogramBucketsDebugCopy, pFeatureCombination, aiPoint, directionVector, runtimeLearningTypeOrCountTargetClasses, pRet);
    }
 #endif // NDEBUG
 }
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted>
 FractionalDataType SweepMultiDiemensional(const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, size_t * const aiPoint, const size_t directionVectorLow, const unsigned int iDimensionSweep, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketBestAndTemp, size_t * const piBestCut
 #ifndef NDEBUG
    , const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy, const unsigned char * const aHistogramBucketsEndDebug
@@ -840,8 +1047,8 @@ FractionalDataType SweepMultiDiemensional(const HistogramBucket<IsClassification
    EBM_ASSERT(0 == (directionVectorLow & (size_t { 1 } << iDimensionSweep)));
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
    EBM_ASSERT(!IsMultiplyError(2, cBytesPerHistogramBucket)); // we're accessing allocated memory
    const size_t cBytesPerTwoHistogramBuckets = cBytesPerHistogramBucket << 1;
 
@@ -865,13 +1072,13 @@ FractionalDataType SweepMultiDiemensional(const HistogramBucket<IsClassification
    do {
       *piBin = iBin;
 
-      GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiPoint, directionVectorLow, runtimeLearningTypeOrCountTargetClasses, pTotalsLow
+      GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiPoint, directionVectorLow, runtimeLearningTypeOrCountTargetClasses, pTotalsLow
 #ifndef NDEBUG
          , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
       );
 
-      GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiPoint, directionVectorHigh, runtimeLearningTypeOrCountTargetClasses, pTotalsHigh
+      GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiPoint, directionVectorHigh, runtimeLearningTypeOrCountTargetClasses, pTotalsHigh
 #ifndef NDEBUG
          , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -879,9 +1086,9 @@ FractionalDataType SweepMultiDiemensional(const HistogramBucket<IsClassification
 
       FractionalDataType splittingScore = 0;
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
-         splittingScore += 0 == pTotalsLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLow->m_cInstancesInBucket);
+         splittingScore += 0 == pTotalsLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLow->GetWeight(cVectorLength, bWeighted));
          EBM_ASSERT(0 <= splittingScore);
-         splittingScore += 0 == pTotalsHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHigh->m_cInstancesInBucket);
+         splittingScore += 0 == pTotalsHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHigh->GetWeight(cVectorLength, bWeighted));
          EBM_ASSERT(0 <= splittingScore);
       }
       EBM_ASSERT(0 <= splittingScore);
@@ -900,14 +1107,47 @@ FractionalDataType SweepMultiDiemensional(const HistogramBucket<IsClassification
    return bestSplit;
 }
 
+// fills the main space of aHistogramBuckets (cTotalBucketsMainSpace zeroed buckets, which is cBytesMainSpace bytes) with the histogram of our sampling set,
+// from pHistogramCache if it holds it for its key or else by binning, in which case we cache it.  This is the only binning that TrainMultiDimensional
+// does, so BuildModelFeatureCombinationHistograms calls it to export exactly the histogram that training would have used
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+bool BinMultiDimensionalHistogram(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cTotalBucketsMainSpace, const size_t cBytesMainSpace, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(!pHistogramCache->Load(aHistogramBuckets, cBytesMainSpace)) {
+      {
+         PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticBinningNanoseconds);
+         if(RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(pFeatureCombination->m_cFeatures, pThreadPool, pCachedThreadResources, aHistogramBuckets, cTotalBucketsMainSpace, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+            , aHistogramBucketsEndDebug
+#endif // NDEBUG
+         )) {
+            LOG_0(TraceLevelWarning, "WARNING BinMultiDimensionalHistogram RecursiveBinDataSetTraining failed");
+            return true;
+         }
+         if(IsRegression(compilerLearningTypeOrCountTargetClasses) && pTrainingSet->m_pOriginDataSet->HasSparseColumns()) {
+            const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+            RemoveResidualShiftFromHistogram<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBuckets, cTotalBucketsMainSpace, pTrainingSet, bWeighted);
+         }
+      }
+      pCachedThreadResources->m_pStatistics->Add(StatisticInstancesScanned, pTrainingSet->m_pOriginDataSet->GetCountInstances());
+      pCachedThreadResources->m_pStatistics->Add(StatisticBinsTouched, cTotalBucketsMainSpace);
+      pHistogramCache->Store(aHistogramBuckets, cBytesMainSpace);
+   }
+   return false;
+}
+
 WARNING_PUSH
 WARNING_DISABLE_UNINITIALIZED_LOCAL_VARIABLE
 
 // TODO: consider adding controls to disallow cuts that would leave too few cases in a region (use the same minimum number of cases paraemter as the mains)
 // TODO: for higher dimensional spaces, we need to add/subtract individual cells alot and the denominator isn't required in order to make decisions about where to cut.  For dimensions higher than 2, we might want to copy the tensor to a new tensor AFTER binning that keeps only the residuals and then go back to our original tensor after splits to determine the denominator
-// TODO: do we really require countCompilerDimensions here?  Does it make any of the code below faster... or alternatively, should we puth the distinction down into a sub-function
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
-bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+// countCompilerDimensions is 2 for pairs, which selects our pair kernels in BuildFastTotals and GetTotals, or 0 for the runtime dimension code
+// bWeighted is a template parameter rather than a runtime flag so that unweighted training keeps its smaller buckets at a compile time constant size
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions, bool bWeighted>
+bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    LOG_0(TraceLevelVerbose, "Entered TrainMultiDimensional");
 
    // TODO: we can just re-generate this code 63 times and eliminate the dynamic cDimensions value.  We can also do this in several other places like for SegmentedRegion and other critical places
@@ -935,11 +1175,11 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
    const size_t cTotalBuckets =  cTotalBucketsMainSpace + cAuxillaryBuckets;
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)) {
-      LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)");
+   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)) {
+      LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)");
       return true;
    }
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
    if(IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)) {
       LOG_0(TraceLevelWarning, "WARNING TrainMultiDimensional IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)");
       return true;
@@ -959,11 +1199,17 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
    const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
 #endif // NDEBUG
 
-   RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(cDimensions, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+   // BuildFastTotals overwrites our main space with totals below, so we cache the main space as it comes out of binning.  Our auxillary space is always
+   // zero at this point, so we don't need to keep it
+   EBM_ASSERT(!IsMultiplyError(cTotalBucketsMainSpace, cBytesPerHistogramBucket)); // cTotalBucketsMainSpace is smaller than cTotalBuckets, which we checked above
+   const size_t cBytesMainSpace = cTotalBucketsMainSpace * cBytesPerHistogramBucket;
+   if(BinMultiDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, aHistogramBuckets, cTotalBucketsMainSpace, cBytesMainSpace, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
-   );
+   )) {
+      return true;
+   }
 
 #ifndef NDEBUG
    // make a copy of the original binned buckets for debugging purposes
@@ -982,7 +1228,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
    }
 #endif // NDEBUG
 
-   BuildFastTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, pAuxiliaryBucketZone
+   // everything from here to our return is the sweep
+   PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticTensorSweepNanoseconds);
+
+   BuildFastTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, pAuxiliaryBucketZone
 #ifndef NDEBUG
       , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1120,7 +1369,7 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          size_t cutSecond1LowBest;
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals2LowLowBest = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 4);
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals2LowHighBest = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 5);
-         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x0, 1, runtimeLearningTypeOrCountTargetClasses, pTotals2LowLowBest, &cutSecond1LowBest
+         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiStart, 0x0, 1, runtimeLearningTypeOrCountTargetClasses, pTotals2LowLowBest, &cutSecond1LowBest
 #ifndef NDEBUG
             , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1130,7 +1379,7 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          size_t cutSecond1HighBest;
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals2HighLowBest = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 8);
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals2HighHighBest = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 9);
-         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x1, 1, runtimeLearningTypeOrCountTargetClasses, pTotals2HighLowBest, &cutSecond1HighBest
+         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiStart, 0x1, 1, runtimeLearningTypeOrCountTargetClasses, pTotals2HighLowBest, &cutSecond1HighBest
 #ifndef NDEBUG
             , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1143,10 +1392,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
             cutFirst1LowBest = cutSecond1LowBest;
             cutFirst1HighBest = cutSecond1HighBest;
 
-            pTotals1LowLowBest->Copy(*pTotals2LowLowBest, cVectorLength);
-            pTotals1LowHighBest->Copy(*pTotals2LowHighBest, cVectorLength);
-            pTotals1HighLowBest->Copy(*pTotals2HighLowBest, cVectorLength);
-            pTotals1HighHighBest->Copy(*pTotals2HighHighBest, cVectorLength);
+            pTotals1LowLowBest->Copy(*pTotals2LowLowBest, cVectorLength, bWeighted);
+            pTotals1LowHighBest->Copy(*pTotals2LowHighBest, cVectorLength, bWeighted);
+            pTotals1HighLowBest->Copy(*pTotals2HighLowBest, cVectorLength, bWeighted);
+            pTotals1HighHighBest->Copy(*pTotals2HighHighBest, cVectorLength, bWeighted);
          }
          ++iBin1;
       } while(iBin1 < cBinsDimension1 - 1);
@@ -1172,7 +1421,7 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          size_t cutSecond2LowBest;
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals1LowLowBestInner = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 16);
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals1LowHighBestInner = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 17);
-         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x0, 0, runtimeLearningTypeOrCountTargetClasses, pTotals1LowLowBestInner, &cutSecond2LowBest
+         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiStart, 0x0, 0, runtimeLearningTypeOrCountTargetClasses, pTotals1LowLowBestInner, &cutSecond2LowBest
 #ifndef NDEBUG
             , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1182,7 +1431,7 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
          size_t cutSecond2HighBest;
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals1HighLowBestInner = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 20);
          HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotals1HighHighBestInner = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 21);
-         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x2, 0, runtimeLearningTypeOrCountTargetClasses, pTotals1HighLowBestInner, &cutSecond2HighBest
+         splittingScore += SweepMultiDiemensional<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, bWeighted>(aHistogramBuckets, pFeatureCombination, aiStart, 0x2, 0, runtimeLearningTypeOrCountTargetClasses, pTotals1HighLowBestInner, &cutSecond2HighBest
 #ifndef NDEBUG
             , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1195,10 +1444,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
             cutFirst2LowBest = cutSecond2LowBest;
             cutFirst2HighBest = cutSecond2HighBest;
 
-            pTotals2LowLowBest->Copy(*pTotals1LowLowBestInner, cVectorLength);
-            pTotals2LowHighBest->Copy(*pTotals1LowHighBestInner, cVectorLength);
-            pTotals2HighLowBest->Copy(*pTotals1HighLowBestInner, cVectorLength);
-            pTotals2HighHighBest->Copy(*pTotals1HighHighBestInner, cVectorLength);
+            pTotals2LowLowBest->Copy(*pTotals1LowLowBestInner, cVectorLength, bWeighted);
+            pTotals2LowHighBest->Copy(*pTotals1LowHighBestInner, cVectorLength, bWeighted);
+            pTotals2HighLowBest->Copy(*pTotals1HighLowBestInner, cVectorLength, bWeighted);
+            pTotals2HighHighBest->Copy(*pTotals1HighHighBestInner, cVectorLength, bWeighted);
 
             bCutFirst2 = true;
          }
@@ -1277,10 +1526,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
 
             if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
                // regression
-               predictionLowLow = 0 == pTotals2LowLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2LowLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2LowLowBest->m_cInstancesInBucket);
-               predictionLowHigh = 0 == pTotals2LowHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2LowHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2LowHighBest->m_cInstancesInBucket);
-               predictionHighLow = 0 == pTotals2HighLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2HighLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2HighLowBest->m_cInstancesInBucket);
-               predictionHighHigh = 0 == pTotals2HighHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2HighHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2HighHighBest->m_cInstancesInBucket);
+               predictionLowLow = 0 == pTotals2LowLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2LowLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2LowLowBest->GetWeight(cVectorLength, bWeighted));
+               predictionLowHigh = 0 == pTotals2LowHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2LowHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2LowHighBest->GetWeight(cVectorLength, bWeighted));
+               predictionHighLow = 0 == pTotals2HighLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2HighLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2HighLowBest->GetWeight(cVectorLength, bWeighted));
+               predictionHighHigh = 0 == pTotals2HighHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals2HighHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals2HighHighBest->GetWeight(cVectorLength, bWeighted));
             } else {
                // classification
                EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
@@ -1383,10 +1632,10 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
 
             if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
                // regression
-               predictionLowLow = 0 == pTotals1LowLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1LowLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1LowLowBest->m_cInstancesInBucket);
-               predictionLowHigh = 0 == pTotals1LowHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1LowHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1LowHighBest->m_cInstancesInBucket);
-               predictionHighLow = 0 == pTotals1HighLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1HighLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1HighLowBest->m_cInstancesInBucket);
-               predictionHighHigh = 0 == pTotals1HighHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1HighHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1HighHighBest->m_cInstancesInBucket);
+               predictionLowLow = 0 == pTotals1LowLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1LowLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1LowLowBest->GetWeight(cVectorLength, bWeighted));
+               predictionLowHigh = 0 == pTotals1LowHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1LowHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1LowHighBest->GetWeight(cVectorLength, bWeighted));
+               predictionHighLow = 0 == pTotals1HighLowBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1HighLowBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1HighLowBest->GetWeight(cVectorLength, bWeighted));
+               predictionHighHigh = 0 == pTotals1HighHighBest->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER(pTotals1HighHighBest->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotals1HighHighBest->GetWeight(cVectorLength, bWeighted));
             } else {
                EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
                // classification
@@ -1438,6 +1687,44 @@ bool TrainMultiDimensional(CachedTrainingThreadResources<IsClassification(compil
 }
 WARNING_POP
 
+// nearly all of our interaction terms are pairs, so pairs get a compile time dimension count, which selects our pair kernels in BuildFastTotals and
+// GetTotals.  Any other number of dimensions uses the runtime dimension code.  Raise this as we add kernels for more dimensions
+constexpr size_t k_cCompilerOptimizedDimensionsMax = 2;
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+class RecursiveTrainMultiDimensional {
+   // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
+public:
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+      static_assert(2 <= cCompilerDimensions, "TrainMultiDimensional is only for 2 or more dimensions");
+      static_assert(cCompilerDimensions <= k_cCompilerOptimizedDimensionsMax, "cCompilerDimensions must be less than or equal to k_cCompilerOptimizedDimensionsMax.  Anything above that is handled in a partial specialization template.");
+      if(cCompilerDimensions == cRuntimeDimensions) {
+         if(nullptr != pTrainingSet->m_pOriginDataSet->GetWeights()) {
+            return TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions, true>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, runtimeLearningTypeOrCountTargetClasses);
+         } else {
+            return TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions, false>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, runtimeLearningTypeOrCountTargetClasses);
+         }
+      } else {
+         return RecursiveTrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, runtimeLearningTypeOrCountTargetClasses);
+      }
+   }
+};
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+class RecursiveTrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, k_cCompilerOptimizedDimensionsMax + 1> {
+   // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
+public:
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+      UNUSED(cRuntimeDimensions);
+      EBM_ASSERT(k_cCompilerOptimizedDimensionsMax < cRuntimeDimensions);
+      if(nullptr != pTrainingSet->m_pOriginDataSet->GetWeights()) {
+         return TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 0, true>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, runtimeLearningTypeOrCountTargetClasses);
+      } else {
+         return TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 0, false>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, runtimeLearningTypeOrCountTargetClasses);
+      }
+   }
+};
+
 //template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
 //bool TrainMultiDimensionalPaulAlgorithm(CachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const FeatureInternal * const pTargetFeature, SamplingMethod const * const pTrainingSet, const FeatureCombination * const pFeatureCombination, SegmentedRegion<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet) {
 //   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets = BinDataSet<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pFeatureCombination, pTrainingSet, pTargetFeature);
@@ -1717,7 +2004,8 @@ WARNING_POP
 
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t countCompilerDimensions>
 bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, CachedInteractionThreadResources * const pCachedThreadResources, const DataSetByFeature * const pDataSet, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
-   // TODO : we NEVER use the denominator term in HistogramBucketVectorEntry when calculating interaction scores, but we're spending time calculating it, and it's taking up precious memory.  We should eliminate the denominator term HERE in our datastructures OR we should think whether we can use the denominator as part of the gain function!!!
+   // our interaction scores only use the instance counts and residual sums, so we always use the buckets without the classification denominator.  For
+   // classification that skips computing the denominator for every instance during binning and keeps it out of our tensor totals and memory
 
    LOG_0(TraceLevelVerbose, "Entered CalculateInteractionScore");
 
@@ -1754,11 +2042,11 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    const size_t cTotalBuckets = cTotalBucketsMainSpace + cAuxillaryBuckets;
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)) {
-      LOG_0(TraceLevelWarning, "WARNING CalculateInteractionScore GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)");
+   if(GetHistogramBucketSizeOverflow<false>(cVectorLength, false)) {
+      LOG_0(TraceLevelWarning, "WARNING CalculateInteractionScore GetHistogramBucketSizeOverflow<false>(cVectorLength, false)");
       return true;
    }
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<false>(cVectorLength, false);
    if(IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)) {
       LOG_0(TraceLevelWarning, "WARNING CalculateInteractionScore IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)");
       return true;
@@ -1766,26 +2054,31 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    const size_t cBytesBuffer = cTotalBuckets * cBytesPerHistogramBucket;
 
    // this doesn't need to be freed since it's tracked and re-used by the class CachedInteractionThreadResources
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer1(cBytesBuffer));
+   HistogramBucket<false> * const aHistogramBuckets = static_cast<HistogramBucket<false> *>(pCachedThreadResources->GetThreadByteBuffer1(cBytesBuffer));
    if(UNLIKELY(nullptr == aHistogramBuckets)) {
       LOG_0(TraceLevelWarning, "WARNING CalculateInteractionScore nullptr == aHistogramBuckets");
       return true;
    }
    memset(aHistogramBuckets, 0, cBytesBuffer);
 
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pAuxiliaryBucketZone = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, cTotalBucketsMainSpace);
+   HistogramBucket<false> * pAuxiliaryBucketZone = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, aHistogramBuckets, cTotalBucketsMainSpace);
 
 #ifndef NDEBUG
    const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
 #endif // NDEBUG
 
    
-   // TODO : use the fancy recursive binner that we use in the training version of this function
-   BinDataSetInteraction<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+   // BinDataSetInteraction reads the compact bin columns that DataSetByFeature built once at initialization, with dedicated kernels for pairs and triples
+   {
+      PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticBinningNanoseconds);
+      BinDataSetInteraction<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
-      , aHistogramBucketsEndDebug
+         , aHistogramBucketsEndDebug
 #endif // NDEBUG
-      );
+         );
+   }
+   pCachedThreadResources->m_pStatistics->Add(StatisticInstancesScanned, pDataSet->GetCountInstances());
+   pCachedThreadResources->m_pStatistics->Add(StatisticBinsTouched, cTotalBucketsMainSpace);
 
 #ifndef NDEBUG
    // make a copy of the original binned buckets for debugging purposes
@@ -1797,14 +2090,16 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    }
    EBM_ASSERT(!IsMultiplyError(cTotalBucketsDebug, cBytesPerHistogramBucket)); // we wouldn't have been able to allocate our main buffer above if this wasn't ok
    const size_t cBytesBufferDebug = cTotalBucketsDebug * cBytesPerHistogramBucket;
-   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(malloc(cBytesBufferDebug));
+   HistogramBucket<false> * const aHistogramBucketsDebugCopy = static_cast<HistogramBucket<false> *>(malloc(cBytesBufferDebug));
    if(nullptr != aHistogramBucketsDebugCopy) {
       // if we can't allocate, don't fail.. just stop checking
       memcpy(aHistogramBucketsDebugCopy, aHistogramBuckets, cBytesBufferDebug);
    }
 #endif // NDEBUG
 
-   BuildFastTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, pAuxiliaryBucketZone
+   PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticTensorSweepNanoseconds);
+
+   BuildFastTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, false, false>(aHistogramBuckets, runtimeLearningTypeOrCountTargetClasses, pFeatureCombination, pAuxiliaryBucketZone
 #ifndef NDEBUG
       , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1813,10 +2108,10 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    size_t aiStart[k_cDimensionsMax];
 
    if(2 == cDimensions) {
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotalsLowLow = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 0);
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotalsLowHigh = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 1);
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotalsHighLow = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 2);
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTotalsHighHigh = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 3);
+      HistogramBucket<false> * pTotalsLowLow = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 0);
+      HistogramBucket<false> * pTotalsLowHigh = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 1);
+      HistogramBucket<false> * pTotalsHighLow = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 2);
+      HistogramBucket<false> * pTotalsHighHigh = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, pAuxiliaryBucketZone, 3);
 
       const size_t cBinsDimension1 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
       const size_t cBinsDimension2 = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[1].m_pFeature->m_cBins;
@@ -1833,25 +2128,25 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
          for(size_t iBin2 = 0; iBin2 < cBinsDimension2 - 1; ++iBin2) {
             aiStart[1] = iBin2;
 
-            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x00, runtimeLearningTypeOrCountTargetClasses, pTotalsLowLow
+            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, false, false>(aHistogramBuckets, pFeatureCombination, aiStart, 0x00, runtimeLearningTypeOrCountTargetClasses, pTotalsLowLow
 #ifndef NDEBUG
                , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
                );
 
-            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x02, runtimeLearningTypeOrCountTargetClasses, pTotalsLowHigh
+            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, false, false>(aHistogramBuckets, pFeatureCombination, aiStart, 0x02, runtimeLearningTypeOrCountTargetClasses, pTotalsLowHigh
 #ifndef NDEBUG
                , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
                );
 
-            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x01, runtimeLearningTypeOrCountTargetClasses, pTotalsHighLow
+            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, false, false>(aHistogramBuckets, pFeatureCombination, aiStart, 0x01, runtimeLearningTypeOrCountTargetClasses, pTotalsHighLow
 #ifndef NDEBUG
                , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
                );
 
-            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions>(aHistogramBuckets, pFeatureCombination, aiStart, 0x03, runtimeLearningTypeOrCountTargetClasses, pTotalsHighHigh
+            GetTotals<compilerLearningTypeOrCountTargetClasses, countCompilerDimensions, false, false>(aHistogramBuckets, pFeatureCombination, aiStart, 0x03, runtimeLearningTypeOrCountTargetClasses, pTotalsHighHigh
 #ifndef NDEBUG
                , aHistogramBucketsDebugCopy, aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -1859,15 +2154,16 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
 
             FractionalDataType splittingScore = 0;
             for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
-               splittingScore += 0 == pTotalsLowLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLowLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLowLow->m_cInstancesInBucket);
-               splittingScore += 0 == pTotalsLowHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLowHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLowHigh->m_cInstancesInBucket);
-               splittingScore += 0 == pTotalsHighLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHighLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHighLow->m_cInstancesInBucket);
-               splittingScore += 0 == pTotalsHighHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHighHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHighHigh->m_cInstancesInBucket);
-               EBM_ASSERT(0 <= splittingScore);
+               splittingScore += 0 == pTotalsLowLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLowLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLowLow->GetWeight(cVectorLength, false));
+               splittingScore += 0 == pTotalsLowHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsLowHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsLowHigh->GetWeight(cVectorLength, false));
+               splittingScore += 0 == pTotalsHighLow->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHighLow->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHighLow->GetWeight(cVectorLength, false));
+               splittingScore += 0 == pTotalsHighHigh->m_cInstancesInBucket ? 0 : EbmStatistics::ComputeNodeSplittingScore(ARRAY_TO_POINTER(pTotalsHighHigh->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError, pTotalsHighHigh->GetWeight(cVectorLength, false));
+               EBM_ASSERT(std::isnan(splittingScore) || 0 <= splittingScore);
             }
-            EBM_ASSERT(0 <= splittingScore);
+            EBM_ASSERT(std::isnan(splittingScore) || 0 <= splittingScore);
 
-            if(bestSplittingScore < splittingScore) {
+            // if our residual sums overflowed, subtracting infinities while getting the totals leaves NaN, which we report rather than skip
+            if(bestSplittingScore < splittingScore || std::isnan(splittingScore)) {
                bestSplittingScore = splittingScore;
             }
          }
@@ -1895,4 +2191,29 @@ bool CalculateInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetC
    return false;
 }
 
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+class RecursiveCalculateInteractionScore {
+   // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
+public:
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, CachedInteractionThreadResources * const pCachedThreadResources, const DataSetByFeature * const pDataSet, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+      static_assert(2 <= cCompilerDimensions, "our interaction scores are only for 2 or more dimensions");
+      static_assert(cCompilerDimensions <= k_cCompilerOptimizedDimensionsMax, "cCompilerDimensions must be less than or equal to k_cCompilerOptimizedDimensionsMax.  Anything above that is handled in a partial specialization template.");
+      if(cCompilerDimensions == cRuntimeDimensions) {
+         return CalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pDataSet, pFeatureCombination, pInteractionScoreReturn);
+      } else {
+         return RecursiveCalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pDataSet, pFeatureCombination, pInteractionScoreReturn);
+      }
+   }
+};
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+class RecursiveCalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, k_cCompilerOptimizedDimensionsMax + 1> {
+   // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
+public:
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, CachedInteractionThreadResources * const pCachedThreadResources, const DataSetByFeature * const pDataSet, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+      UNUSED(cRuntimeDimensions);
+      return CalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, 0>(runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pDataSet, pFeatureCombination, pInteractionScoreReturn);
+   }
+};
+
 #endif // DIMENSION_MULTIPLE_H
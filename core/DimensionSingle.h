@@ -6,6 +6,7 @@
 #define DIMENSION_SINGLE_H
 
 #include <type_traits> // std::is_standard_layout
+#include <algorithm> // std::push_heap, std::pop_heap
 #include <stddef.h> // size_t, ptrdiff_t
 
 #include "EbmInternal.h" // EBM_INLINE
@@ -13,14 +14,17 @@
 #include "SegmentedTensor.h"
 #include "EbmStatistics.h"
 #include "CachedThreadResources.h"
+#include "PhaseStatistics.h"
 #include "FeatureCore.h"
 #include "SamplingWithReplacement.h"
 #include "HistogramBucket.h"
+#include "ThreadPool.h"
+#include "HistogramCache.h"
 
 #include "TreeNode.h"
 
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNode, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pTreeNodeChildrenAvailableStorageSpaceCur, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNode, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pTreeNodeChildrenAvailableStorageSpaceCur, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const bool bWeighted
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -30,8 +34,8 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
    EBM_ASSERT(!GetTreeNodeSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
    const size_t cBytesPerTreeNode = GetTreeNodeSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
 
    const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketEntryCur = pTreeNode->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryFirst;
    const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntryLast = pTreeNode->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryLast;
@@ -43,6 +47,8 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
 
    size_t cInstancesLeft = pHistogramBucketEntryCur->m_cInstancesInBucket;
    size_t cInstancesRight = pTreeNode->GetInstances() - cInstancesLeft;
+   FractionalDataType weightLeft = pHistogramBucketEntryCur->GetWeight(cVectorLength, bWeighted);
+   FractionalDataType weightRight = pTreeNode->GetWeight() - weightLeft;
 
    HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntryLeft = pCachedThreadResources->m_aSumHistogramBucketVectorEntry1;
    FractionalDataType * const aSumResidualErrorsRight = pCachedThreadResources->m_aSumResidualErrors2;
@@ -52,7 +58,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
       const FractionalDataType sumResidualErrorLeft = ARRAY_TO_POINTER_CONST(pHistogramBucketEntryCur->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError;
       const FractionalDataType sumResidualErrorRight = ARRAY_TO_POINTER_CONST(pTreeNode->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError - sumResidualErrorLeft;
 
-      BEST_nodeSplittingScore += EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, cInstancesLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, cInstancesRight);
+      BEST_nodeSplittingScore += EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, weightLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, weightRight);
 
       aSumHistogramBucketVectorEntryLeft[iVector].m_sumResidualError = sumResidualErrorLeft;
       aSumHistogramBucketVectorEntryBest[iVector].m_sumResidualError = sumResidualErrorLeft;
@@ -67,12 +73,16 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
    EBM_ASSERT(0 <= BEST_nodeSplittingScore);
    const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * BEST_pHistogramBucketEntry = pHistogramBucketEntryCur;
    size_t BEST_cInstancesLeft = cInstancesLeft;
+   FractionalDataType BEST_weightLeft = weightLeft;
    for(pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1); pHistogramBucketEntryLast != pHistogramBucketEntryCur; pHistogramBucketEntryCur = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, pHistogramBucketEntryCur, 1)) {
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntryCur, aHistogramBucketsEndDebug);
 
       const size_t CHANGE_cInstances = pHistogramBucketEntryCur->m_cInstancesInBucket;
       cInstancesLeft += CHANGE_cInstances;
       cInstancesRight -= CHANGE_cInstances;
+      const FractionalDataType CHANGE_weight = pHistogramBucketEntryCur->GetWeight(cVectorLength, bWeighted);
+      weightLeft += CHANGE_weight;
+      weightRight -= CHANGE_weight;
 
       FractionalDataType nodeSplittingScore = 0;
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
@@ -88,7 +98,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
          aSumResidualErrorsRight[iVector] = sumResidualErrorRight;
 
          // TODO : we can make this faster by doing the division in ComputeNodeSplittingScore after we add all the numerators
-         const FractionalDataType nodeSplittingScoreOneVector = EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, cInstancesLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, cInstancesRight);
+         const FractionalDataType nodeSplittingScoreOneVector = EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorLeft, weightLeft) + EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorRight, weightRight);
          EBM_ASSERT(0 <= nodeSplittingScore);
          nodeSplittingScore += nodeSplittingScoreOneVector;
       }
@@ -99,6 +109,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
          BEST_nodeSplittingScore = nodeSplittingScore;
          BEST_pHistogramBucketEntry = pHistogramBucketEntryCur;
          BEST_cInstancesLeft = cInstancesLeft;
+         BEST_weightLeft = weightLeft;
          memcpy(aSumHistogramBucketVectorEntryBest, aSumHistogramBucketVectorEntryLeft, sizeof(*aSumHistogramBucketVectorEntryBest) * cVectorLength);
       }
    }
@@ -108,6 +119,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
 
    pLeftChild->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryLast = BEST_pHistogramBucketEntry;
    pLeftChild->SetInstances(BEST_cInstancesLeft);
+   pLeftChild->SetWeight(BEST_weightLeft);
 
    const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const BEST_pHistogramBucketEntryNext = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, BEST_pHistogramBucketEntry, 1);
    ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, BEST_pHistogramBucketEntryNext, aHistogramBucketsEndDebug);
@@ -115,6 +127,8 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
    pRightChild->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryFirst = BEST_pHistogramBucketEntryNext;
    size_t cInstancesParent = pTreeNode->GetInstances();
    pRightChild->SetInstances(cInstancesParent - BEST_cInstancesLeft);
+   const FractionalDataType weightParent = pTreeNode->GetWeight();
+   pRightChild->SetWeight(weightParent - BEST_weightLeft);
 
    FractionalDataType originalParentScore = 0;
    for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
@@ -124,7 +138,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
       }
 
       const FractionalDataType sumResidualErrorParent = ARRAY_TO_POINTER(pTreeNode->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError;
-      originalParentScore += EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorParent, cInstancesParent);
+      originalParentScore += EbmStatistics::ComputeNodeSplittingScore(sumResidualErrorParent, weightParent);
 
       ARRAY_TO_POINTER(pRightChild->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError = sumResidualErrorParent - aSumHistogramBucketVectorEntryBest[iVector].m_sumResidualError;
       if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
@@ -134,7 +148,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
 
 
 
-   // IMPORTANT!! : we need to finish all our calls that use this->m_UNION.m_beforeExaminationForPossibleSplitting BEFORE setting anything in m_UNION.m_afterExaminationForPossibleSplitting as we do below this comment!  The call above to this->GetInstances() needs to be done above these lines because it uses m_UNION.m_beforeExaminationForPossibleSplitting for classification!
+   // IMPORTANT!! : we need to finish all our calls that use this->m_UNION.m_beforeExaminationForPossibleSplitting BEFORE setting anything in m_UNION.m_afterExaminationForPossibleSplitting as we do below this comment!  The calls above to this->GetInstances() and this->GetWeight() need to be done above these lines because it uses m_UNION.m_beforeExaminationForPossibleSplitting for classification!
 
 
 
@@ -154,7 +168,7 @@ void ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint(TreeNode<IsClassi
 }
 
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-bool GrowDecisionTree(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cHistogramBuckets, const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucket, const size_t cInstancesTotal, const HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, FractionalDataType * const pTotalGain
+bool GrowDecisionTree(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cHistogramBuckets, const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBucket, const size_t cInstancesTotal, const FractionalDataType weightTotal, const bool bWeighted, const HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, FractionalDataType * const pTotalGain
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -177,7 +191,7 @@ bool GrowDecisionTree(CachedTrainingThreadResources<IsClassification(compilerLea
       // we don't need to call EnsureValueCapacity because by default we start with a value capacity of 2 * cVectorLength
 
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-         FractionalDataType smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(aSumHistogramBucketVectorEntry[0].m_sumResidualError, cInstancesTotal);
+         FractionalDataType smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(aSumHistogramBucketVectorEntry[0].m_sumResidualError, weightTotal);
          FractionalDataType * pValues = pSmallChangeToModelOverwriteSingleSamplingSet->GetValuePointer();
          pValues[0] = smallChangeToModel;
       } else {
@@ -201,31 +215,36 @@ bool GrowDecisionTree(CachedTrainingThreadResources<IsClassification(compilerLea
       return true; // we haven't accessed this TreeNode memory yet, so we don't know if it overflows yet
    }
    const size_t cBytesPerTreeNode = GetTreeNodeSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
-
-retry_with_bigger_tree_node_children_array:
-   size_t cBytesBuffer2 = pCachedThreadResources->GetThreadByteBuffer2Size();
-   const size_t cBytesInitialNeededAllocation = 3 * cBytesPerTreeNode; // we need 1 TreeNode for the root, 1 for the left child of the root and 1 for the right child of the root
-   if(cBytesBuffer2 < cBytesInitialNeededAllocation) {
-      // TODO : we can eliminate this check as long as we ensure that the ThreadByteBuffer2 is always initialized to be equal to the size of three TreeNodes (left and right) == GET_SIZEOF_ONE_TREE_NODE_CHILDREN(cBytesPerTreeNode)
-      if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesInitialNeededAllocation)) {
-         LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesInitialNeededAllocation)");
-         return true;
-      }
-      cBytesBuffer2 = pCachedThreadResources->GetThreadByteBuffer2Size();
-      EBM_ASSERT(cBytesInitialNeededAllocation <= cBytesBuffer2);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+
+   // a TreeNode needs at least 2 buckets to be splittable, so we can't split more than cHistogramBuckets - 1 times.  Each split examines up to 2 children,
+   // and each examination fills in a pair of TreeNodes for the children it might split into, so with the root and its examination, our tree can't
+   // have more than 3 + 4 * cSplitsMax TreeNodes and our frontier of TreeNodes that could be split next can't hold more than 2 * cSplitsMax of them
+   const size_t cSplitsMax = cTreeSplitsMax < cHistogramBuckets - 1 ? cTreeSplitsMax : cHistogramBuckets - 1;
+   // cSplitsMax is less than cHistogramBuckets, and we allocated more than 4 bytes for each of our histogram buckets, so this can't overflow
+   EBM_ASSERT(!IsMultiplyError(size_t { 4 }, cHistogramBuckets));
+   const size_t cTreeNodesMax = 3 + 4 * cSplitsMax;
+   if(IsMultiplyError(cBytesPerTreeNode, cTreeNodesMax)) {
+      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree IsMultiplyError(cBytesPerTreeNode, cTreeNodesMax)");
+      return true;
+   }
+   const size_t cBytesBuffer2 = cBytesPerTreeNode * cTreeNodesMax;
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRootTreeNode = static_cast<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer2(cBytesBuffer2));
+   if(UNLIKELY(nullptr == pRootTreeNode)) {
+      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree nullptr == pRootTreeNode");
+      return true;
    }
-   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pRootTreeNode = static_cast<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer2());
 
    pRootTreeNode->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryFirst = aHistogramBucket;
    pRootTreeNode->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryLast = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBucket, cHistogramBuckets - 1);
    ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pRootTreeNode->m_UNION.m_beforeExaminationForPossibleSplitting.m_pHistogramBucketEntryLast, aHistogramBucketsEndDebug);
    pRootTreeNode->SetInstances(cInstancesTotal);
+   pRootTreeNode->SetWeight(weightTotal);
 
    memcpy(ARRAY_TO_POINTER(pRootTreeNode->m_aHistogramBucketVectorEntry), aSumHistogramBucketVectorEntry, cVectorLength * sizeof(*aSumHistogramBucketVectorEntry)); // copying existing mem
 
-   ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pRootTreeNode, pCachedThreadResources, AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pRootTreeNode, cBytesPerTreeNode), runtimeLearningTypeOrCountTargetClasses
+   ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pRootTreeNode, pCachedThreadResources, AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pRootTreeNode, cBytesPerTreeNode), runtimeLearningTypeOrCountTargetClasses, bWeighted
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -252,8 +271,8 @@ retry_with_bigger_tree_node_children_array:
 
       FractionalDataType * const aValues = pSmallChangeToModelOverwriteSingleSamplingSet->GetValuePointer();
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-         aValues[0] = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER_CONST(pLeftChild->m_aHistogramBucketVectorEntry)[0].m_sumResidualError, pLeftChild->GetInstances());
-         aValues[1] = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER_CONST(pRightChild->m_aHistogramBucketVectorEntry)[0].m_sumResidualError, pRightChild->GetInstances());
+         aValues[0] = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER_CONST(pLeftChild->m_aHistogramBucketVectorEntry)[0].m_sumResidualError, pLeftChild->GetWeight());
+         aValues[1] = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(ARRAY_TO_POINTER_CONST(pRightChild->m_aHistogramBucketVectorEntry)[0].m_sumResidualError, pRightChild->GetWeight());
       } else {
          EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
          for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
@@ -262,6 +281,7 @@ retry_with_bigger_tree_node_children_array:
          }
       }
 
+      pCachedThreadResources->m_pStatistics->Add(StatisticNodesSplit, 1);
       LOG_0(TraceLevelVerbose, "Exited GrowDecisionTree via one tree split");
       *pTotalGain = pRootTreeNode->EXTRACT_GAIN_BEFORE_SPLITTING();
       return false;
@@ -274,94 +294,87 @@ retry_with_bigger_tree_node_children_array:
    //       1) When the data is the smallest(1-5 items), just iterate over all items in our TreeNode buffer looking for the best Node.  Zero the value on any nodes that have been removed from the queue.  For 1 or 2 instructions in the loop WITHOUT a branch we can probably save the pointer to the first TreeNode with data so that we can start from there next time we loop
    //       2) When the data is a tiny bit bigger and there are holes in our array of TreeNodes, we can maintain a pointer and value in a separate list and zip through the values and then go to the pointer to the best node.  Since the list is unordered, when we find a TreeNode to remove, we just move the last one into the hole
    //       3) The full fleged priority queue below
-   size_t cSplits;
-   try {
-      std::priority_queue<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *, std::vector<TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>, CompareTreeNodeSplittingGain<IsClassification(compilerLearningTypeOrCountTargetClasses)>> * pBestTreeNodeToSplit = &pCachedThreadResources->m_bestTreeNodeToSplit;
-
-      // it is ridiculous that we need to do this in order to clear the tree (there is no "clear" function), but inside this queue is a chunk of memory, and we want to ensure that the chunk of memory stays in L1 cache, so we pop all the previous garbage off instead of allocating a new one!
-      while(!pBestTreeNodeToSplit->empty()) {
-         pBestTreeNodeToSplit->pop();
-      }
+   // our frontier is a binary heap kept with std::push_heap and std::pop_heap, which is how std::priority_queue keeps its heap, so we split our TreeNodes
+   // in the same order that a priority_queue would, but we keep our heap in memory that we sized for this tree before we started
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> ** const apTreeNodeSplitFrontier = pCachedThreadResources->GetTreeNodeSplitFrontier(2 * cSplitsMax);
+   if(UNLIKELY(nullptr == apTreeNodeSplitFrontier)) {
+      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree nullptr == apTreeNodeSplitFrontier");
+      return true;
+   }
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> ** pTreeNodeSplitFrontierEnd = apTreeNodeSplitFrontier;
+   const CompareTreeNodeSplittingGain<IsClassification(compilerLearningTypeOrCountTargetClasses)> compareTreeNodeSplittingGain;
 
-      cSplits = 0;
-      TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pParentTreeNode = pRootTreeNode;
+   size_t cSplits = 0;
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pParentTreeNode = pRootTreeNode;
 
-      // we skip 3 tree nodes.  The root, the left child of the root, and the right child of the root
-      TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceCur = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pRootTreeNode, cBytesInitialNeededAllocation);
+   // we skip 3 tree nodes.  The root, the left child of the root, and the right child of the root
+   TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceCur = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pRootTreeNode, 3 * cBytesPerTreeNode);
 
-      FractionalDataType totalGain = 0;
+   FractionalDataType totalGain = 0;
 
-      goto skip_first_push_pop;
+   goto skip_first_push_pop;
 
-      do {
-         // there is no way to get the top and pop at the same time.. would be good to get a better queue, but our code isn't bottlenecked by it
-         pParentTreeNode = pBestTreeNodeToSplit->top();
-         pBestTreeNodeToSplit->pop();
+   do {
+      pParentTreeNode = *apTreeNodeSplitFrontier;
+      std::pop_heap(apTreeNodeSplitFrontier, pTreeNodeSplitFrontierEnd, compareTreeNodeSplittingGain);
+      --pTreeNodeSplitFrontierEnd;
 
-      skip_first_push_pop:
+   skip_first_push_pop:
 
-         // ONLY AFTER WE'VE POPPED pParentTreeNode OFF the priority queue is it considered to have been split.  Calling SPLIT_THIS_NODE makes it formal
-         totalGain += pParentTreeNode->EXTRACT_GAIN_BEFORE_SPLITTING();
-         pParentTreeNode->SPLIT_THIS_NODE();
+      // ONLY AFTER WE'VE POPPED pParentTreeNode OFF the priority queue is it considered to have been split.  Calling SPLIT_THIS_NODE makes it formal
+      totalGain += pParentTreeNode->EXTRACT_GAIN_BEFORE_SPLITTING();
+      pParentTreeNode->SPLIT_THIS_NODE();
 
-         TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pLeftChild = GetLeftTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.m_afterExaminationForPossibleSplitting.m_pTreeNodeChildren, cBytesPerTreeNode);
-         if(pLeftChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
-            TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
-            if(cBytesBuffer2 < static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode))) {
-               if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)) {
-                  LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)");
-                  return true;
-               }
-               goto retry_with_bigger_tree_node_children_array;
-            }
-            // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
-            ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pLeftChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses
+      TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pLeftChild = GetLeftTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.m_afterExaminationForPossibleSplitting.m_pTreeNodeChildren, cBytesPerTreeNode);
+      if(pLeftChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
+         TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
+         EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
+         // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
+         ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pLeftChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses, bWeighted
 #ifndef NDEBUG
-               , aHistogramBucketsEndDebug
+            , aHistogramBucketsEndDebug
 #endif // NDEBUG
-            );
-            pTreeNodeChildrenAvailableStorageSpaceCur = pTreeNodeChildrenAvailableStorageSpaceNext;
-            pBestTreeNodeToSplit->push(pLeftChild);
-         } else {
-            // we aren't going to split this TreeNode because we can't.  We need to set the splitGain value here because otherwise it is filled with garbage that could be NaN (meaning the node was a branch)
-            // we can't call INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED before calling SplitTreeNode because INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED sets m_UNION.m_afterExaminationForPossibleSplitting.m_splitGain and the m_UNION.m_beforeExaminationForPossibleSplitting values are needed if we had decided to call ExamineNodeForSplittingAndDetermineBestPossibleSplit
-            pLeftChild->INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED();
-         }
+         );
+         pTreeNodeChildrenAvailableStorageSpaceCur = pTreeNodeChildrenAvailableStorageSpaceNext;
+         EBM_ASSERT(static_cast<size_t>(pTreeNodeSplitFrontierEnd - apTreeNodeSplitFrontier) < 2 * cSplitsMax);
+         *pTreeNodeSplitFrontierEnd = pLeftChild;
+         ++pTreeNodeSplitFrontierEnd;
+         std::push_heap(apTreeNodeSplitFrontier, pTreeNodeSplitFrontierEnd, compareTreeNodeSplittingGain);
+      } else {
+         // we aren't going to split this TreeNode because we can't.  We need to set the splitGain value here because otherwise it is filled with garbage that could be NaN (meaning the node was a branch)
+         // we can't call INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED before calling SplitTreeNode because INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED sets m_UNION.m_afterExaminationForPossibleSplitting.m_splitGain and the m_UNION.m_beforeExaminationForPossibleSplitting values are needed if we had decided to call ExamineNodeForSplittingAndDetermineBestPossibleSplit
+         pLeftChild->INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED();
+      }
 
-         TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRightChild = GetRightTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.m_afterExaminationForPossibleSplitting.m_pTreeNodeChildren, cBytesPerTreeNode);
-         if(pRightChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
-            TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
-            if(cBytesBuffer2 < static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode))) {
-               if(pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)) {
-                  LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pCachedThreadResources->GrowThreadByteBuffer2(cBytesPerTreeNode)");
-                  return true;
-               }
-               goto retry_with_bigger_tree_node_children_array;
-            }
-            // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
-            ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pRightChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses
+      TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pRightChild = GetRightTreeNodeChild<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pParentTreeNode->m_UNION.m_afterExaminationForPossibleSplitting.m_pTreeNodeChildren, cBytesPerTreeNode);
+      if(pRightChild->IsSplittable(cInstancesRequiredForParentSplitMin)) {
+         TreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pTreeNodeChildrenAvailableStorageSpaceNext = AddBytesTreeNode<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pTreeNodeChildrenAvailableStorageSpaceCur, cBytesPerTreeNode << 1);
+         EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceNext) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
+         // the act of splitting it implicitly sets INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED because splitting sets splitGain to a non-NaN value
+         ExamineNodeForPossibleSplittingAndDetermineBestSplitPoint<compilerLearningTypeOrCountTargetClasses>(pRightChild, pCachedThreadResources, pTreeNodeChildrenAvailableStorageSpaceCur, runtimeLearningTypeOrCountTargetClasses, bWeighted
 #ifndef NDEBUG
-               , aHistogramBucketsEndDebug
+            , aHistogramBucketsEndDebug
 #endif // NDEBUG
-            );
-            pTreeNodeChildrenAvailableStorageSpaceCur = pTreeNodeChildrenAvailableStorageSpaceNext;
-            pBestTreeNodeToSplit->push(pRightChild);
-         } else {
-            // we aren't going to split this TreeNode because we can't.  We need to set the splitGain value here because otherwise it is filled with garbage that could be NaN (meaning the node was a branch)
-            // we can't call INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED before calling SplitTreeNode because INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED sets m_UNION.m_afterExaminationForPossibleSplitting.m_splitGain and the m_UNION.m_beforeExaminationForPossibleSplitting values are needed if we had decided to call ExamineNodeForSplittingAndDetermineBestPossibleSplit
-            pRightChild->INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED();
-         }
-         ++cSplits;
-      } while(cSplits < cTreeSplitsMax && UNLIKELY(!pBestTreeNodeToSplit->empty()));
-      // we DON'T need to call SetLeafAfterDone() on any items that remain in the pBestTreeNodeToSplit queue because everything in that queue has set a non-NaN nodeSplittingScore value
-
-      // we might as well dump this value out to our pointer, even if later fail the function below.  If the function is failed, we make no guarantees about what we did with the value pointed to at *pTotalGain
-      *pTotalGain = totalGain;
-      EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceCur) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
-   } catch(...) {
-      LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree exception");
-      return true;
-   }
+         );
+         pTreeNodeChildrenAvailableStorageSpaceCur = pTreeNodeChildrenAvailableStorageSpaceNext;
+         EBM_ASSERT(static_cast<size_t>(pTreeNodeSplitFrontierEnd - apTreeNodeSplitFrontier) < 2 * cSplitsMax);
+         *pTreeNodeSplitFrontierEnd = pRightChild;
+         ++pTreeNodeSplitFrontierEnd;
+         std::push_heap(apTreeNodeSplitFrontier, pTreeNodeSplitFrontierEnd, compareTreeNodeSplittingGain);
+      } else {
+         // we aren't going to split this TreeNode because we can't.  We need to set the splitGain value here because otherwise it is filled with garbage that could be NaN (meaning the node was a branch)
+         // we can't call INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED before calling SplitTreeNode because INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED sets m_UNION.m_afterExaminationForPossibleSplitting.m_splitGain and the m_UNION.m_beforeExaminationForPossibleSplitting values are needed if we had decided to call ExamineNodeForSplittingAndDetermineBestPossibleSplit
+         pRightChild->INDICATE_THIS_NODE_EXAMINED_FOR_SPLIT_AND_REJECTED();
+      }
+      ++cSplits;
+   } while(cSplits < cTreeSplitsMax && UNLIKELY(apTreeNodeSplitFrontier != pTreeNodeSplitFrontierEnd));
+   // we DON'T need to call SetLeafAfterDone() on any items that remain in our frontier because everything in it has set a non-NaN nodeSplittingScore value
+   EBM_ASSERT(cSplits <= cSplitsMax);
+   pCachedThreadResources->m_pStatistics->Add(StatisticNodesSplit, cSplits);
+
+   // we might as well dump this value out to our pointer, even if later fail the function below.  If the function is failed, we make no guarantees about what we did with the value pointed to at *pTotalGain
+   *pTotalGain = totalGain;
+   EBM_ASSERT(static_cast<size_t>(reinterpret_cast<char *>(pTreeNodeChildrenAvailableStorageSpaceCur) - reinterpret_cast<char *>(pRootTreeNode)) <= cBytesBuffer2);
 
    if(UNLIKELY(pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, cSplits))) {
       LOG_0(TraceLevelWarning, "WARNING GrowDecisionTree pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDivisions(0, cSplits)");
@@ -391,18 +404,83 @@ retry_with_bigger_tree_node_children_array:
    return false;
 }
 
+// fills pHistogramBucket with the totals of our sampling set, from pHistogramCache if it holds them for its key or else by binning, in which case we cache
+// them.  pHistogramBucket needs to be zeroed.  This is the only binning that TrainZeroDimensional does, so BuildModelFeatureCombinationHistograms calls it
+// to export exactly the histogram that training would have used
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+void BinZeroDimensionalHistogram(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucket, const size_t cBytesPerHistogramBucket, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   if(!pHistogramCache->Load(pHistogramBucket, cBytesPerHistogramBucket)) {
+      if(IsRegression(compilerLearningTypeOrCountTargetClasses) && pTrainingSet->m_pOriginDataSet->HasSparseColumns()) {
+         const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+         BinDataSetTrainingZeroDimensionsFromTotals<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pHistogramBucket, pTrainingSet, bWeighted);
+      } else {
+         {
+            PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticBinningNanoseconds);
+            BinDataSetTrainingZeroDimensions<compilerLearningTypeOrCountTargetClasses>(pHistogramBucket, pTrainingSet, runtimeLearningTypeOrCountTargetClasses);
+         }
+         pCachedThreadResources->m_pStatistics->Add(StatisticInstancesScanned, pTrainingSet->m_pOriginDataSet->GetCountInstances());
+      }
+      pCachedThreadResources->m_pStatistics->Add(StatisticBinsTouched, 1);
+      pHistogramCache->Store(pHistogramBucket, cBytesPerHistogramBucket);
+   }
+}
+
+// the single feature version of BinZeroDimensionalHistogram.  aHistogramBuckets holds cTotalBuckets zeroed buckets, which is cBytesBuffer bytes
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+bool BinSingleDimensionalHistogram(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cTotalBuckets, const size_t cBytesBuffer, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(!pHistogramCache->Load(aHistogramBuckets, cBytesBuffer)) {
+      const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+      const SparseColumn * const pSparseColumn = IsRegression(compilerLearningTypeOrCountTargetClasses) ? pTrainingSet->m_pOriginDataSet->GetSparseColumn(pFeatureCombination) : nullptr;
+      if(nullptr != pSparseColumn) {
+         {
+            PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticBinningNanoseconds);
+            if(bWeighted) {
+               BinDataSetTrainingSparse<IsClassification(compilerLearningTypeOrCountTargetClasses), true>(aHistogramBuckets, pSparseColumn, pTrainingSet);
+            } else {
+               BinDataSetTrainingSparse<IsClassification(compilerLearningTypeOrCountTargetClasses), false>(aHistogramBuckets, pSparseColumn, pTrainingSet);
+            }
+         }
+         pCachedThreadResources->m_pStatistics->Add(StatisticInstancesScanned, pSparseColumn->m_cExceptions);
+      } else {
+         {
+            PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticBinningNanoseconds);
+            if(BinDataSetTrainingChunks<compilerLearningTypeOrCountTargetClasses, 1>(pThreadPool, pCachedThreadResources, aHistogramBuckets, cTotalBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+               , aHistogramBucketsEndDebug
+#endif // NDEBUG
+            )) {
+               LOG_0(TraceLevelWarning, "WARNING BinSingleDimensionalHistogram BinDataSetTrainingChunks failed");
+               return true;
+            }
+            if(IsRegression(compilerLearningTypeOrCountTargetClasses) && pTrainingSet->m_pOriginDataSet->HasSparseColumns()) {
+               RemoveResidualShiftFromHistogram<IsClassification(compilerLearningTypeOrCountTargetClasses)>(aHistogramBuckets, cTotalBuckets, pTrainingSet, bWeighted);
+            }
+         }
+         pCachedThreadResources->m_pStatistics->Add(StatisticInstancesScanned, pTrainingSet->m_pOriginDataSet->GetCountInstances());
+      }
+      pCachedThreadResources->m_pStatistics->Add(StatisticBinsTouched, cTotalBuckets);
+      pHistogramCache->Store(aHistogramBuckets, cBytesBuffer);
+   }
+   return false;
+}
+
 // TODO : make variable ordering consistent with BinDataSet call below (put the feature first since that's a definition that happens before the training data set)
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-bool TrainZeroDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const SamplingMethod * const pTrainingSet, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+bool TrainZeroDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    LOG_0(TraceLevelVerbose, "Entered TrainZeroDimensional");
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)) {
+   const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)) {
       // TODO : move this to initialization where we execute it only once
-      LOG_0(TraceLevelWarning, "GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)");
+      LOG_0(TraceLevelWarning, "GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)");
       return true;
    }
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
    HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucket = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer1(cBytesPerHistogramBucket));
    if(UNLIKELY(nullptr == pHistogramBucket)) {
       LOG_0(TraceLevelWarning, "WARNING nullptr == pHistogramBucket");
@@ -410,11 +488,11 @@ bool TrainZeroDimensional(CachedTrainingThreadResources<IsClassification(compile
    }
    memset(pHistogramBucket, 0, cBytesPerHistogramBucket);
 
-   BinDataSetTrainingZeroDimensions<compilerLearningTypeOrCountTargetClasses>(pHistogramBucket, pTrainingSet, runtimeLearningTypeOrCountTargetClasses);
+   BinZeroDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pHistogramCache, pTrainingSet, pHistogramBucket, cBytesPerHistogramBucket, runtimeLearningTypeOrCountTargetClasses);
 
    const HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry = ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry);
    if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
-      FractionalDataType smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(aSumHistogramBucketVectorEntry[0].m_sumResidualError, pHistogramBucket->m_cInstancesInBucket);
+      FractionalDataType smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(aSumHistogramBucketVectorEntry[0].m_sumResidualError, pHistogramBucket->GetWeight(cVectorLength, bWeighted));
       FractionalDataType * pValues = pSmallChangeToModelOverwriteSingleSamplingSet->GetValuePointer();
       pValues[0] = smallChangeToModel;
    } else {
@@ -432,19 +510,20 @@ bool TrainZeroDimensional(CachedTrainingThreadResources<IsClassification(compile
 
 // TODO : make variable ordering consistent with BinDataSet call below (put the feature first since that's a definition that happens before the training data set)
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, FractionalDataType * const pTotalGain, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, ThreadPool * const pThreadPool, HistogramCache * const pHistogramCache, const SamplingMethod * const pTrainingSet, const FeatureCombinationCore * const pFeatureCombination, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet, FractionalDataType * const pTotalGain, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
    LOG_0(TraceLevelVerbose, "Entered TrainSingleDimensional");
 
    EBM_ASSERT(1 == pFeatureCombination->m_cFeatures);
    size_t cTotalBuckets = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)) {
+   const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)) {
       // TODO : move this to initialization where we execute it only once
-      LOG_0(TraceLevelWarning, "WARNING GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)");
+      LOG_0(TraceLevelWarning, "WARNING GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)");
       return true;
    }
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
    if(IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)) {
       // TODO : move this to initialization where we execute it only once
       LOG_0(TraceLevelWarning, "WARNING IsMultiplyError(cTotalBuckets, cBytesPerHistogramBucket)");
@@ -463,11 +542,14 @@ bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compi
    const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
 #endif // NDEBUG
 
-   BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+   // CompressHistogramBuckets rearranges our buckets below, so we cache them as they come out of binning
+   if(BinSingleDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pThreadPool, pHistogramCache, pTrainingSet, pFeatureCombination, aHistogramBuckets, cTotalBuckets, cBytesBuffer, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
-   );
+   )) {
+      return true;
+   }
 
    HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry = pCachedThreadResources->m_aSumHistogramBucketVectorEntry;
    memset(aSumHistogramBucketVectorEntry, 0, sizeof(*aSumHistogramBucketVectorEntry) * cVectorLength); // can't overflow, accessing existing memory
@@ -475,7 +557,8 @@ bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compi
    size_t cHistogramBuckets = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins;
    EBM_ASSERT(1 <= cHistogramBuckets); // this function can handle 1 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value)
    size_t cInstancesTotal;
-   cHistogramBuckets = CompressHistogramBuckets<compilerLearningTypeOrCountTargetClasses>(pTrainingSet, cHistogramBuckets, aHistogramBuckets, &cInstancesTotal, aSumHistogramBucketVectorEntry, runtimeLearningTypeOrCountTargetClasses
+   FractionalDataType weightTotal;
+   cHistogramBuckets = CompressHistogramBuckets<compilerLearningTypeOrCountTargetClasses>(pTrainingSet, cHistogramBuckets, aHistogramBuckets, &cInstancesTotal, &weightTotal, aSumHistogramBucketVectorEntry, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -484,7 +567,8 @@ bool TrainSingleDimensional(CachedTrainingThreadResources<IsClassification(compi
    EBM_ASSERT(1 <= cInstancesTotal);
    EBM_ASSERT(1 <= cHistogramBuckets);
 
-   bool bRet = GrowDecisionTree<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, runtimeLearningTypeOrCountTargetClasses, cHistogramBuckets, aHistogramBuckets, cInstancesTotal, aSumHistogramBucketVectorEntry, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pSmallChangeToModelOverwriteSingleSamplingSet, pTotalGain
+   PhaseTimer phaseTimer(pCachedThreadResources->m_pStatistics, StatisticTreeGrowingNanoseconds);
+   bool bRet = GrowDecisionTree<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, runtimeLearningTypeOrCountTargetClasses, cHistogramBuckets, aHistogramBuckets, cInstancesTotal, weightTotal, bWeighted, aSumHistogramBucketVectorEntry, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pSmallChangeToModelOverwriteSingleSamplingSet, pTotalGain
 #ifndef NDEBUG
       , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -16,6 +16,9 @@
 #include "FeatureCore.h"
 // dataset depends on features
 #include "DataSetByFeature.h"
+#include "CachedThreadResources.h"
+#include "ThreadPool.h"
+#include "PhaseStatistics.h"
 
 class EbmInteractionState {
 public:
@@ -24,8 +27,19 @@ public:
    const size_t m_cFeatures;
    // TODO : in the future, we can allocate this inside a function so that even the objects inside are const
    FeatureCore * const m_aFeatures;
+   // false if m_aFeatures belongs to the EbmTrainingState whose training set our m_pDataSet views
+   const bool m_bOwnFeatures;
    DataSetByFeature * m_pDataSet;
 
+   // GetInteractionScores allocates these the first time that it's called.  We keep one CachedInteractionThreadResources per thread, indexed by the
+   // iThread that the ThreadPool gives our tasks.  m_pThreadPool stays nullptr if we only have one core
+   ThreadPool * m_pThreadPool;
+   size_t m_cCachedThreadResources;
+   CachedInteractionThreadResources * m_aCachedThreadResources;
+
+   // read by GetInteractionStatistics
+   PhaseStatistics m_statistics;
+
    unsigned int m_cLogEnterMessages;
    unsigned int m_cLogExitMessages;
 
@@ -33,7 +47,25 @@ public:
       : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
       , m_cFeatures(cFeatures)
       , m_aFeatures(0 == cFeatures || IsMultiplyError(sizeof(FeatureCore), cFeatures) ? nullptr : static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * cFeatures)))
+      , m_bOwnFeatures(true)
+      , m_pDataSet(nullptr)
+      , m_pThreadPool(nullptr)
+      , m_cCachedThreadResources(0)
+      , m_aCachedThreadResources(nullptr)
+      , m_cLogEnterMessages(1000)
+      , m_cLogExitMessages(1000) {
+   }
+
+   // we share aFeatures with an EbmTrainingState, which needs to outlive us
+   EBM_INLINE EbmInteractionState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, FeatureCore * const aFeatures)
+      : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_cFeatures(cFeatures)
+      , m_aFeatures(aFeatures)
+      , m_bOwnFeatures(false)
       , m_pDataSet(nullptr)
+      , m_pThreadPool(nullptr)
+      , m_cCachedThreadResources(0)
+      , m_aCachedThreadResources(nullptr)
       , m_cLogEnterMessages(1000)
       , m_cLogExitMessages(1000) {
    }
@@ -41,13 +73,18 @@ public:
    EBM_INLINE ~EbmInteractionState() {
       LOG_0(TraceLevelInfo, "Entered ~EbmInteractionState");
 
+      // our ThreadPool doesn't own any threads, and ThreadPool::Run doesn't return until every worker has left our tasks
+      delete m_pThreadPool;
+      delete[] m_aCachedThreadResources;
       delete m_pDataSet;
-      free(m_aFeatures);
+      if(m_bOwnFeatures) {
+         free(m_aFeatures);
+      }
 
       LOG_0(TraceLevelInfo, "Exited ~EbmInteractionState");
    }
 
-   EBM_INLINE bool InitializeInteraction(const EbmCoreFeature * const aFeatures, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData, const FractionalDataType * const aPredictorScores) {
+   EBM_INLINE bool InitializeInteraction(const EbmCoreFeature * const aFeatures, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData, const FractionalDataType * const aPredictorScores, const bool bFloatResiduals) {
       LOG_0(TraceLevelInfo, "Entered InitializeInteraction");
 
       if(0 != m_cFeatures && nullptr == m_aFeatures) {
@@ -99,7 +136,7 @@ public:
       LOG_0(TraceLevelInfo, "Entered DataSetByFeature");
       EBM_ASSERT(nullptr == m_pDataSet);
       if(0 != cInstances) {
-         m_pDataSet = new (std::nothrow) DataSetByFeature(m_cFeatures, m_aFeatures, cInstances, aBinnedData, aTargets, aPredictorScores, m_runtimeLearningTypeOrCountTargetClasses);
+         m_pDataSet = new (std::nothrow) DataSetByFeature(m_cFeatures, m_aFeatures, cInstances, aBinnedData, aTargets, aPredictorScores, m_runtimeLearningTypeOrCountTargetClasses, bFloatResiduals);
          if(nullptr == m_pDataSet || m_pDataSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING InitializeInteraction nullptr == pDataSet || pDataSet->IsError()");
             return true;
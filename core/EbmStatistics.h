@@ -10,6 +10,7 @@
 
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "MulticlassExp.h"
 
 class EbmStatistics final {
    EBM_INLINE EbmStatistics() {
@@ -24,12 +25,13 @@ public:
       return absResidualError * (1 - absResidualError);
    }
 
-   EBM_INLINE static FractionalDataType ComputeNodeSplittingScore(const FractionalDataType sumResidualError, const size_t cInstances) {
+   // weight is the sum of the instance weights behind sumResidualError, which is the instance count if we don't have instance weights
+   EBM_INLINE static FractionalDataType ComputeNodeSplittingScore(const FractionalDataType sumResidualError, const FractionalDataType weight) {
       // !!! IMPORTANT: This gain function used to determine splits is equivalent to minimizing sum of squared error SSE, which can be seen following the derivation of Equation #7 in Ping Li's paper -> https://arxiv.org/pdf/1203.3491.pdf
 
-      // TODO: after we eliminate bin compression, we should be checking to see if cInstances is zero before divding by it.. Instead of doing that outside this function, we can move all instances of checking for zero into this function
-      EBM_ASSERT(0 < cInstances); // we purge bins that have an instance counts of zero, so cInstances should never be zero
-      return sumResidualError / cInstances * sumResidualError;
+      // TODO: after we eliminate bin compression, we should be checking to see if weight is zero before divding by it.. Instead of doing that outside this function, we can move all instances of checking for zero into this function
+      EBM_ASSERT(0 < weight); // we purge bins that have an instance counts of zero and instance weights are positive, so weight should never be zero
+      return sumResidualError / weight * sumResidualError;
    }
 
    WARNING_PUSH
@@ -44,11 +46,11 @@ public:
    }
    WARNING_POP
 
-   EBM_INLINE static FractionalDataType ComputeSmallChangeInRegressionPredictionForOneSegment(const FractionalDataType sumResidualError, const size_t cInstances) {
+   EBM_INLINE static FractionalDataType ComputeSmallChangeInRegressionPredictionForOneSegment(const FractionalDataType sumResidualError, const FractionalDataType weight) {
       // TODO: check again if we can ever have a zero here
-      // TODO: after we eliminate bin compression, we should be checking to see if cInstances is zero before divding by it.. Instead of doing that outside this function, we can move all instances of checking for zero into this function
-      EBM_ASSERT(0 != cInstances);
-      return sumResidualError / cInstances;
+      // TODO: after we eliminate bin compression, we should be checking to see if weight is zero before divding by it.. Instead of doing that outside this function, we can move all instances of checking for zero into this function
+      EBM_ASSERT(0 != weight);
+      return sumResidualError / weight;
    }
 
    EBM_INLINE static FractionalDataType ComputeRegressionResidualError(const FractionalDataType predictionScore, const FractionalDataType actualValue) {
@@ -92,6 +94,80 @@ public:
       return ret;
    }
 
+   // below this many classes there isn't enough per-class work to fill a vector, and std::exp beats our polynomial when run one value at a time
+   static constexpr size_t k_cMulticlassPolynomialExpMin = 8;
+
+   // exp(..) of a single log weight, matching what ExpAndSumMulticlass and SumExpMulticlass compute for a model with cVectorLength classes
+   EBM_INLINE static FractionalDataType ExpForMulticlass(const size_t cVectorLength, const FractionalDataType value) {
+      if(cVectorLength < k_cMulticlassPolynomialExpMin) {
+         return std::exp(value);
+      }
+      return MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(value));
+   }
+
+   // replaces each class's log weight in aValues with exp(..) of it and returns the sum of the exps.  The sum is kept out of the exp loop because
+   // floating point reductions don't vectorize without reordering the additions, which would change our results
+   EBM_INLINE static FractionalDataType ExpAndSumMulticlass(const size_t cVectorLength, FractionalDataType * const aValues) {
+      EBM_ASSERT(1 <= cVectorLength);
+      if(cVectorLength < k_cMulticlassPolynomialExpMin) {
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            aValues[iVector] = std::exp(aValues[iVector]);
+         }
+      } else {
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            aValues[iVector] = MulticlassExp::ClampForMulticlassExp(aValues[iVector]);
+         }
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            aValues[iVector] = MulticlassExp::ExpForMulticlassClamped(aValues[iVector]);
+         }
+      }
+      FractionalDataType sumExp = 0;
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         sumExp += aValues[iVector];
+      }
+      return sumExp;
+   }
+
+   // same as ExpAndSumMulticlass, but for callers that need to keep their log weights.  We go through a stack buffer in chunks so that the exp loops
+   // still vectorize
+   EBM_INLINE static FractionalDataType SumExpMulticlass(const size_t cVectorLength, const FractionalDataType * const aValues) {
+      EBM_ASSERT(1 <= cVectorLength);
+      FractionalDataType sumExp = 0;
+      if(cVectorLength < k_cMulticlassPolynomialExpMin) {
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            sumExp += std::exp(aValues[iVector]);
+         }
+         return sumExp;
+      }
+      constexpr size_t k_cExpsPerChunk = 64;
+      FractionalDataType aExps[k_cExpsPerChunk];
+      size_t iVectorStart = 0;
+      do {
+         const size_t cChunk = cVectorLength - iVectorStart < k_cExpsPerChunk ? cVectorLength - iVectorStart : k_cExpsPerChunk;
+         for(size_t iVector = 0; iVector < cChunk; ++iVector) {
+            aExps[iVector] = MulticlassExp::ClampForMulticlassExp(aValues[iVectorStart + iVector]);
+         }
+         for(size_t iVector = 0; iVector < cChunk; ++iVector) {
+            aExps[iVector] = MulticlassExp::ExpForMulticlassClamped(aExps[iVector]);
+         }
+         for(size_t iVector = 0; iVector < cChunk; ++iVector) {
+            sumExp += aExps[iVector];
+         }
+         iVectorStart += cChunk;
+      } while(iVectorStart < cVectorLength);
+      return sumExp;
+   }
+
+   // turns the exps left by ExpAndSumMulticlass into residuals in place.  Negating every class and then adding 1 to the target class gives exactly
+   // yi - exp / sumExp for each class, but without a per-class comparison in the vectorized loop
+   EBM_INLINE static void ComputeClassificationResidualErrorsMulticlassFromExps(const size_t cVectorLength, const FractionalDataType sumExp, const StorageDataTypeCore binnedActualValue, FractionalDataType * const aExpsToResiduals) {
+      EBM_ASSERT(static_cast<size_t>(binnedActualValue) < cVectorLength);
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         aExpsToResiduals[iVector] = -(aExpsToResiduals[iVector] / sumExp);
+      }
+      aExpsToResiduals[static_cast<size_t>(binnedActualValue)] += FractionalDataType { 1 };
+   }
+
    // if trainingLogWeight is zero, we can call this simpler function
    EBM_INLINE static FractionalDataType ComputeClassificationResidualErrorMulticlass(const bool isMatch, const FractionalDataType sumExp) {
       const FractionalDataType yi = UNPREDICTABLE(isMatch) ? FractionalDataType { 1 } : FractionalDataType { 0 };
@@ -113,16 +189,17 @@ public:
    EBM_INLINE static FractionalDataType ComputeClassificationSingleInstanceLogLossBinaryclass(const FractionalDataType validationLogOddsPrediction, const StorageDataTypeCore binnedActualValue) {
       EBM_ASSERT(0 == binnedActualValue || 1 == binnedActualValue);
 
-      // TODO: also try log1p and I guess (exp1p?) for accuracy and performance
       // TODO: the calls to log and exp have loops and conditional statements.  Suposedly the assembly FYL2X is slower than the C++ log/exp functions.  Look into this more.  We might end up sorting our input data by the target to avoid this if we can't find a non-branching solution because branch prediction will be important here
       // https://stackoverflow.com/questions/45785705/logarithm-in-c-and-assembly
 
-      return std::log(1 + std::exp(UNPREDICTABLE(0 == binnedActualValue) ? validationLogOddsPrediction : -validationLogOddsPrediction)); // log & exp will return the same type that it is given, either float or double
+      // log1p costs the same as log, but it doesn't lose all our precision when exp(..) is tiny, which is the common case once the model predicts well
+      return std::log1p(std::exp(UNPREDICTABLE(0 == binnedActualValue) ? validationLogOddsPrediction : -validationLogOddsPrediction)); // log1p & exp will return the same type that it is given, either float or double
    }
 
-   EBM_INLINE static FractionalDataType ComputeClassificationSingleInstanceLogLossMulticlass(const FractionalDataType sumExp, const FractionalDataType * const aValidationLogWeight, const StorageDataTypeCore binnedActualValue) {
+   // validationExpWeight is the exp(..) of the log weight for the actual class, which our caller already computed while summing sumExp
+   EBM_INLINE static FractionalDataType ComputeClassificationSingleInstanceLogLossMulticlass(const FractionalDataType sumExp, const FractionalDataType validationExpWeight) {
       // TODO: avoid doing the negation below.  Also, can we optimize further?
-      return -std::log(std::exp(aValidationLogWeight[binnedActualValue]) / sumExp);
+      return -std::log(validationExpWeight / sumExp);
    }
 };
 
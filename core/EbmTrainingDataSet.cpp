@@ -0,0 +1,1300 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <string.h> // memcpy, memcmp
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // FILE, fopen, fwrite, fclose
+#include <inttypes.h> // uint64_t, int64_t
+#include <new> // std::nothrow
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+// very independent includes
+#include "Logging.h" // EBM_ASSERT & LOG
+// feature includes
+#include "FeatureCore.h"
+// FeatureCombination.h depends on FeatureInternal.h
+#include "FeatureCombinationCore.h"
+// dataset depends on features
+#include "DataSetByFeatureCombination.h"
+#include "MemoryMappedFile.h"
+#include "Binning.h"
+#include "EbmTrainingDataSet.h"
+
+bool EbmTrainingDataSet::InitializeFeatures(const size_t cFeatures, FeatureCore * const aFeaturesCore, const EbmCoreFeature * const aFeatures, const size_t cTrainingInstances, const size_t cValidationInstances) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSet::InitializeFeatures");
+   // the instance counts are only used in asserts
+   UNUSED(cTrainingInstances);
+   UNUSED(cValidationInstances);
+   if(0 != cFeatures) {
+      EBM_ASSERT(!IsMultiplyError(cFeatures, sizeof(*aFeatures))); // if this overflows then our caller should not have been able to allocate the array
+      const EbmCoreFeature * pFeatureInitialize = aFeatures;
+      const EbmCoreFeature * const pFeatureEnd = &aFeatures[cFeatures];
+      EBM_ASSERT(pFeatureInitialize < pFeatureEnd);
+      size_t iFeatureInitialize = 0;
+      do {
+         static_assert(FeatureTypeCore::OrdinalCore == static_cast<FeatureTypeCore>(FeatureTypeOrdinal), "FeatureTypeCore::OrdinalCore must have the same value as FeatureTypeOrdinal");
+         static_assert(FeatureTypeCore::NominalCore == static_cast<FeatureTypeCore>(FeatureTypeNominal), "FeatureTypeCore::NominalCore must have the same value as FeatureTypeNominal");
+         EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType || FeatureTypeNominal == pFeatureInitialize->featureType);
+         FeatureTypeCore featureTypeCore = static_cast<FeatureTypeCore>(pFeatureInitialize->featureType);
+
+         IntegerDataType countBins = pFeatureInitialize->countBins;
+         EBM_ASSERT(0 <= countBins); // we can handle 1 == cBins or 0 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value).  0 cases could only occur if there were zero training and zero validation cases since the features would require a value, even if it was 0
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatures !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
+            return true;
+         }
+         size_t cBins = static_cast<size_t>(countBins);
+         if(cBins <= 1) {
+            EBM_ASSERT(0 != cBins || 0 == cTrainingInstances && 0 == cValidationInstances);
+            LOG_0(TraceLevelInfo, "INFO EbmTrainingDataSet::InitializeFeatures feature with 0/1 values");
+         }
+
+         EBM_ASSERT(0 == pFeatureInitialize->hasMissing || 1 == pFeatureInitialize->hasMissing);
+         bool bMissing = 0 != pFeatureInitialize->hasMissing;
+
+         // this is an in-place new, so there is no new memory allocated, and we already knew where it was going, so we don't need the resulting pointer returned
+         new (&aFeaturesCore[iFeatureInitialize]) FeatureCore(cBins, iFeatureInitialize, featureTypeCore, bMissing);
+         // we don't allocate memory and our constructor doesn't have errors, so we shouldn't have an error here
+
+         EBM_ASSERT(0 == pFeatureInitialize->hasMissing); // TODO : implement this, then remove this assert
+         EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType); // TODO : implement this, then remove this assert
+
+         ++iFeatureInitialize;
+         ++pFeatureInitialize;
+      } while(pFeatureEnd != pFeatureInitialize);
+   }
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSet::InitializeFeatures");
+   return false;
+}
+
+bool EbmTrainingDataSet::InitializeFeatureCombinations(const size_t cFeatures, FeatureCore * const aFeaturesCore, const size_t cFeatureCombinations, FeatureCombinationCore ** const apFeatureCombinations, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSet::InitializeFeatureCombinations");
+   UNUSED(cFeatures); // only used in asserts
+   if(0 != cFeatureCombinations) {
+      const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
+      size_t iFeatureCombination = 0;
+      do {
+         const EbmCoreFeatureCombination * const pFeatureCombinationInterop = &aFeatureCombinations[iFeatureCombination];
+
+         IntegerDataType countFeaturesInCombination = pFeatureCombinationInterop->countFeaturesInCombination;
+         EBM_ASSERT(0 <= countFeaturesInCombination);
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatureCombinations !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+            return true;
+         }
+         size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+         size_t cSignificantFeaturesInCombination = 0;
+         const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
+         if(UNLIKELY(0 == cFeaturesInCombination)) {
+            LOG_0(TraceLevelInfo, "INFO EbmTrainingDataSet::InitializeFeatureCombinations empty feature combination");
+         } else {
+            EBM_ASSERT(nullptr != featureCombinationIndexes);
+            const IntegerDataType * pFeatureCombinationIndexTemp = pFeatureCombinationIndex;
+            do {
+               const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndexTemp;
+               EBM_ASSERT(0 <= indexFeatureInterop);
+               if(!IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)) {
+                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatureCombinations !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)");
+                  return true;
+               }
+               const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
+               EBM_ASSERT(iFeatureForCombination < cFeatures);
+               FeatureCore * const pInputFeature = &aFeaturesCore[iFeatureForCombination];
+               if(LIKELY(1 < pInputFeature->m_cBins)) {
+                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
+                  ++cSignificantFeaturesInCombination;
+               } else {
+                  LOG_0(TraceLevelInfo, "INFO EbmTrainingDataSet::InitializeFeatureCombinations feature combination with no useful features");
+               }
+               ++pFeatureCombinationIndexTemp;
+            } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndexTemp);
+
+            if(k_cDimensionsMax < cSignificantFeaturesInCombination) {
+               // if we try to run with more than k_cDimensionsMax we'll exceed our memory capacity, so let's exit here instead
+               LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatureCombinations k_cDimensionsMax < cSignificantFeaturesInCombination");
+               return true;
+            }
+         }
+
+         FeatureCombinationCore * pFeatureCombination = FeatureCombinationCore::Allocate(cSignificantFeaturesInCombination, iFeatureCombination);
+         if(nullptr == pFeatureCombination) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatureCombinations nullptr == pFeatureCombination");
+            return true;
+         }
+         // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
+         apFeatureCombinations[iFeatureCombination] = pFeatureCombination;
+
+         if(LIKELY(0 == cSignificantFeaturesInCombination)) {
+            // move our index forward to the next feature.  
+            // We won't be executing the loop below that would otherwise increment it by the number of features in this feature combination
+            pFeatureCombinationIndex = pFeatureCombinationIndexEnd;
+         } else {
+            EBM_ASSERT(nullptr != featureCombinationIndexes);
+            size_t cTensorBins = 1;
+            FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = ARRAY_TO_POINTER(pFeatureCombination->m_FeatureCombinationEntry);
+            do {
+               const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndex;
+               EBM_ASSERT(0 <= indexFeatureInterop);
+               EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop))); // this was checked above
+               const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
+               EBM_ASSERT(iFeatureForCombination < cFeatures);
+               const FeatureCore * const pInputFeature = &aFeaturesCore[iFeatureForCombination];
+               const size_t cBins = pInputFeature->m_cBins;
+               if(LIKELY(1 < cBins)) {
+                  // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
+                  pFeatureCombinationEntry->m_pFeature = pInputFeature;
+                  ++pFeatureCombinationEntry;
+                  if(IsMultiplyError(cTensorBins, cBins)) {
+                     // if this overflows, we definetly won't be able to allocate it
+                     LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFeatureCombinations IsMultiplyError(cTensorStates, cBins)");
+                     return true;
+                  }
+                  cTensorBins *= cBins;
+               }
+               ++pFeatureCombinationIndex;
+            } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
+            // if cSignificantFeaturesInCombination is zero, don't both initializing pFeatureCombination->m_cItemsPerBitPackDataUnit
+            const size_t cBitsRequiredMin = CountBitsRequiredCore(cTensorBins - 1);
+            pFeatureCombination->m_cItemsPerBitPackDataUnit = GetCountItemsBitPacked(cBitsRequiredMin);
+         }
+         ++iFeatureCombination;
+      } while(iFeatureCombination < cFeatureCombinations);
+   }
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSet::InitializeFeatureCombinations");
+   return false;
+}
+
+EBM_INLINE static void * CopyTargets(const size_t cInstances, const size_t cBytesPerTarget, const void * const aTargets) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(nullptr != aTargets);
+   if(IsMultiplyError(cBytesPerTarget, cInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING CopyTargets IsMultiplyError(cBytesPerTarget, cInstances)");
+      return nullptr;
+   }
+   const size_t cBytes = cBytesPerTarget * cInstances;
+   void * const aTargetsCopy = malloc(cBytes);
+   if(nullptr == aTargetsCopy) {
+      LOG_0(TraceLevelWarning, "WARNING CopyTargets nullptr == aTargetsCopy");
+      return nullptr;
+   }
+   memcpy(aTargetsCopy, aTargets, cBytes);
+   return aTargetsCopy;
+}
+
+bool EbmTrainingDataSet::Initialize(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSet::Initialize");
+   try {
+      if(0 != m_cFeatures && nullptr == m_aFeatures) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize 0 != m_cFeatures && nullptr == m_aFeatures");
+         return true;
+      }
+
+      if(UNLIKELY(0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize 0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations");
+         return true;
+      }
+
+      if(InitializeFeatures(m_cFeatures, m_aFeatures, aFeatures, cTrainingInstances, cValidationInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize InitializeFeatures");
+         return true;
+      }
+      if(InitializeFeatureCombinations(m_cFeatures, m_aFeatures, m_cFeatureCombinations, m_apFeatureCombinations, aFeatureCombinations, featureCombinationIndexes)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize InitializeFeatureCombinations");
+         return true;
+      }
+
+      const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+      const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
+      const size_t cBytesPerTarget = bRegression ? sizeof(FractionalDataType) : sizeof(IntegerDataType);
+
+      // we own the target copies, so our datasets can always borrow them.  Residuals and predictor scores belong to each EbmTrainingState
+      if(0 != cTrainingInstances) {
+         m_aTrainingTargets = CopyTargets(cTrainingInstances, cBytesPerTarget, aTrainingTargets);
+         if(nullptr == m_aTrainingTargets) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize nullptr == m_aTrainingTargets");
+            return true;
+         }
+         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(false, false, !bRegression, true, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, aTrainingBinnedData, m_aTrainingTargets, nullptr, cVectorLength);
+         if(nullptr == m_pTrainingSet || m_pTrainingSet->IsError()) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
+            return true;
+         }
+      }
+
+      if(0 != cValidationInstances) {
+         m_aValidationTargets = CopyTargets(cValidationInstances, cBytesPerTarget, aValidationTargets);
+         if(nullptr == m_aValidationTargets) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize nullptr == m_aValidationTargets");
+            return true;
+         }
+         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(false, false, !bRegression, true, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, aValidationBinnedData, m_aValidationTargets, nullptr, cVectorLength);
+         if(nullptr == m_pValidationSet || m_pValidationSet->IsError()) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize nullptr == m_pValidationSet || m_pValidationSet->IsError()");
+            return true;
+         }
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSet::Initialize");
+      return false;
+   } catch(...) {
+      // this is here to catch exceptions from any C++ types that we put in here later
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Initialize exception");
+      return true;
+   }
+}
+
+// A binned data set file starts with a DataSetFileHeader that is followed by these sections in order:
+//   EbmCoreFeature[m_cFeatures]
+//   EbmCoreFeatureCombination[m_cFeatureCombinations]
+//   IntegerDataType featureCombinationIndexes[m_cFeatureCombinationIndexes]
+//   the training targets, which are FractionalDataType for regression and IntegerDataType for classification
+//   the training data of each feature combination with features, bit packed exactly as DataSetByFeatureCombination lays it out in memory
+//   the validation targets and the validation data, laid out like the training ones
+// Every section is padded to a multiple of 8 bytes, so every section is aligned for any of our types when we read it in place from the mapping.  The
+// feature combinations only list the features with more than one bin since the others don't change the bit packing.  We write in the byte order and
+// StorageDataTypeCore width of the machine that we run on, and refuse to open files that were written with a different byte order or width
+constexpr char k_dataSetFileMagic[8] = { 'E', 'B', 'M', 'B', 'I', 'N', 'D', 'S' };
+constexpr uint64_t k_dataSetFileVersion = 1;
+constexpr uint64_t k_dataSetFileByteOrderMark = uint64_t { 0x0102030405060708 };
+constexpr size_t k_cBytesDataSetFileAlignment = 8;
+
+struct DataSetFileHeader final {
+   char m_magic[8];
+   uint64_t m_version;
+   uint64_t m_byteOrderMark;
+   uint64_t m_cBytesStorageDataType;
+   int64_t m_runtimeLearningTypeOrCountTargetClasses;
+   uint64_t m_cFeatures;
+   uint64_t m_cFeatureCombinations;
+   uint64_t m_cFeatureCombinationIndexes;
+   uint64_t m_cTrainingInstances;
+   uint64_t m_cValidationInstances;
+};
+
+static_assert(0 == sizeof(DataSetFileHeader) % k_cBytesDataSetFileAlignment, "DataSetFileHeader must keep the sections after it aligned");
+static_assert(0 == sizeof(EbmCoreFeature) % k_cBytesDataSetFileAlignment, "EbmCoreFeature must keep the sections after it aligned");
+static_assert(0 == sizeof(EbmCoreFeatureCombination) % k_cBytesDataSetFileAlignment, "EbmCoreFeatureCombination must keep the sections after it aligned");
+static_assert(sizeof(IntegerDataType) == sizeof(FractionalDataType), "we store regression and classification targets in the same number of bytes");
+
+EBM_INLINE static size_t GetCountBytesTargets(const size_t cInstances) {
+   // both our target types are 8 bytes, and we check that the file can hold them before we multiply, so this can't overflow
+   return sizeof(IntegerDataType) * cInstances;
+}
+
+EBM_INLINE static size_t GetCountBytesInputData(const FeatureCombinationCore * const pFeatureCombination, const size_t cInstances) {
+   EBM_ASSERT(0 < pFeatureCombination->m_cFeatures);
+   EBM_ASSERT(0 < cInstances);
+   const size_t cDataUnits = (cInstances - 1) / pFeatureCombination->m_cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+   EBM_ASSERT(!IsMultiplyError(sizeof(StorageDataTypeCore), cDataUnits)); // we only call this for datasets that we've already bit packed or have room for
+   return sizeof(StorageDataTypeCore) * cDataUnits;
+}
+
+EBM_INLINE static size_t GetCountBytesPadding(const size_t cBytes) {
+   return (k_cBytesDataSetFileAlignment - cBytes % k_cBytesDataSetFileAlignment) % k_cBytesDataSetFileAlignment;
+}
+
+// returns a pointer to the next cBytes of the mapping, or nullptr if they run past the end of the file
+EBM_INLINE static const void * ReadSection(const MemoryMappedFile * const pMemoryMappedFile, size_t * const pcBytesConsumed, const size_t cItems, const size_t cBytesPerItem) {
+   if(IsMultiplyError(cItems, cBytesPerItem)) {
+      LOG_0(TraceLevelWarning, "WARNING ReadSection IsMultiplyError(cItems, cBytesPerItem)");
+      return nullptr;
+   }
+   const size_t cBytes = cItems * cBytesPerItem;
+   const size_t cBytesPadding = GetCountBytesPadding(cBytes);
+   const size_t cBytesRemaining = pMemoryMappedFile->GetCountBytes() - *pcBytesConsumed;
+   if(cBytesRemaining < cBytes || cBytesRemaining - cBytes < cBytesPadding) {
+      LOG_0(TraceLevelWarning, "WARNING ReadSection the file is too short");
+      return nullptr;
+   }
+   const void * const pSection = static_cast<const char *>(pMemoryMappedFile->GetData()) + *pcBytesConsumed;
+   *pcBytesConsumed += cBytes + cBytesPadding;
+   return pSection;
+}
+
+static bool WriteSection(FILE * const pFile, const void * const pData, const size_t cBytes) {
+   static constexpr char k_padding[k_cBytesDataSetFileAlignment] = { 0 };
+   if(0 != cBytes && cBytes != fwrite(pData, 1, cBytes, pFile)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteSection fwrite failed");
+      return true;
+   }
+   const size_t cBytesPadding = GetCountBytesPadding(cBytes);
+   if(0 != cBytesPadding && cBytesPadding != fwrite(k_padding, 1, cBytesPadding, pFile)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteSection fwrite failed for the padding");
+      return true;
+   }
+   return false;
+}
+
+// sets up *paaInputData to point at each feature combination's bit packed data within the mapping, and then the DataSetByFeatureCombination on top of it
+static DataSetByFeatureCombination * ReadDataSet(const MemoryMappedFile * const pMemoryMappedFile, size_t * const pcBytesConsumed, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cInstances, const void ** const paTargets, const StorageDataTypeCore *** const paaInputData) {
+   EBM_ASSERT(0 < cInstances);
+
+   const void * const aTargets = ReadSection(pMemoryMappedFile, pcBytesConsumed, cInstances, sizeof(IntegerDataType));
+   if(nullptr == aTargets) {
+      LOG_0(TraceLevelWarning, "WARNING ReadDataSet nullptr == aTargets");
+      return nullptr;
+   }
+   *paTargets = aTargets;
+   EBM_ASSERT(GetCountBytesTargets(cInstances) == cInstances * sizeof(IntegerDataType));
+
+   const bool bRegression = IsRegression(runtimeLearningTypeOrCountTargetClasses);
+   if(!bRegression) {
+      // bad targets would make us index outside of our histograms, so unlike the bit packed data, which we trust, we check these
+      const IntegerDataType * pTarget = static_cast<const IntegerDataType *>(aTargets);
+      const IntegerDataType * const pTargetEnd = pTarget + cInstances;
+      do {
+         const IntegerDataType target = *pTarget;
+         if(target < 0 || !IsNumberConvertable<ptrdiff_t, IntegerDataType>(target) || runtimeLearningTypeOrCountTargetClasses <= static_cast<ptrdiff_t>(target) || !IsNumberConvertable<StorageDataTypeCore, IntegerDataType>(target)) {
+            LOG_0(TraceLevelWarning, "WARNING ReadDataSet classification target out of range");
+            return nullptr;
+         }
+         ++pTarget;
+      } while(pTargetEnd != pTarget);
+   }
+
+   if(0 != cFeatureCombinations) {
+      EBM_ASSERT(!IsMultiplyError(sizeof(*paaInputData), cFeatureCombinations)); // we allocated apFeatureCombinations with the same count
+      const StorageDataTypeCore ** const aaInputData = static_cast<const StorageDataTypeCore **>(malloc(sizeof(*aaInputData) * cFeatureCombinations));
+      if(nullptr == aaInputData) {
+         LOG_0(TraceLevelWarning, "WARNING ReadDataSet nullptr == aaInputData");
+         return nullptr;
+      }
+      *paaInputData = aaInputData;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinations[iFeatureCombination];
+         if(0 == pFeatureCombination->m_cFeatures) {
+            aaInputData[iFeatureCombination] = nullptr;
+         } else {
+            const size_t cDataUnits = (cInstances - 1) / pFeatureCombination->m_cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+            const void * const aInputData = ReadSection(pMemoryMappedFile, pcBytesConsumed, cDataUnits, sizeof(StorageDataTypeCore));
+            if(nullptr == aInputData) {
+               LOG_0(TraceLevelWarning, "WARNING ReadDataSet nullptr == aInputData");
+               return nullptr;
+            }
+            aaInputData[iFeatureCombination] = static_cast<const StorageDataTypeCore *>(aInputData);
+         }
+      }
+   }
+
+   DataSetByFeatureCombination * const pDataSet = new (std::nothrow) DataSetByFeatureCombination(cFeatureCombinations, *paaInputData, cInstances, !bRegression, aTargets);
+   if(nullptr == pDataSet || pDataSet->IsError()) {
+      LOG_0(TraceLevelWarning, "WARNING ReadDataSet nullptr == pDataSet || pDataSet->IsError()");
+      delete pDataSet;
+      return nullptr;
+   }
+   return pDataSet;
+}
+
+bool EbmTrainingDataSet::InitializeFromFile(MemoryMappedFile * const pMemoryMappedFile) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSet::InitializeFromFile");
+   EBM_ASSERT(nullptr != pMemoryMappedFile);
+   EBM_ASSERT(nullptr == m_pMemoryMappedFile);
+   // take ownership first so that our destructor cleans up the mapping if we exit early
+   m_pMemoryMappedFile = pMemoryMappedFile;
+   try {
+      if(0 != m_cFeatures && nullptr == m_aFeatures) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile 0 != m_cFeatures && nullptr == m_aFeatures");
+         return true;
+      }
+
+      if(UNLIKELY(0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile 0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations");
+         return true;
+      }
+
+      // our caller checked the header
+      const DataSetFileHeader * const pHeader = static_cast<const DataSetFileHeader *>(pMemoryMappedFile->GetData());
+      EBM_ASSERT(sizeof(*pHeader) <= pMemoryMappedFile->GetCountBytes());
+      size_t cBytesConsumed = sizeof(*pHeader);
+
+      EBM_ASSERT((IsNumberConvertable<size_t, uint64_t>(pHeader->m_cTrainingInstances)));
+      const size_t cTrainingInstances = static_cast<size_t>(pHeader->m_cTrainingInstances);
+      EBM_ASSERT((IsNumberConvertable<size_t, uint64_t>(pHeader->m_cValidationInstances)));
+      const size_t cValidationInstances = static_cast<size_t>(pHeader->m_cValidationInstances);
+      EBM_ASSERT((IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatureCombinationIndexes)));
+      const size_t cFeatureCombinationIndexes = static_cast<size_t>(pHeader->m_cFeatureCombinationIndexes);
+
+      const EbmCoreFeature * const aFeatures = static_cast<const EbmCoreFeature *>(ReadSection(pMemoryMappedFile, &cBytesConsumed, m_cFeatures, sizeof(EbmCoreFeature)));
+      const EbmCoreFeatureCombination * const aFeatureCombinations = nullptr == aFeatures ? nullptr : static_cast<const EbmCoreFeatureCombination *>(ReadSection(pMemoryMappedFile, &cBytesConsumed, m_cFeatureCombinations, sizeof(EbmCoreFeatureCombination)));
+      const IntegerDataType * const aFeatureCombinationIndexes = nullptr == aFeatureCombinations ? nullptr : static_cast<const IntegerDataType *>(ReadSection(pMemoryMappedFile, &cBytesConsumed, cFeatureCombinationIndexes, sizeof(IntegerDataType)));
+      if(nullptr == aFeatureCombinationIndexes) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile the file is too short for the features and feature combinations");
+         return true;
+      }
+
+      // InitializeFeatures and InitializeFeatureCombinations trust their inputs, but this came from a file, so check everything that they only assert
+      for(size_t iFeature = 0; iFeature < m_cFeatures; ++iFeature) {
+         const EbmCoreFeature * const pFeature = &aFeatures[iFeature];
+         if(FeatureTypeOrdinal != pFeature->featureType || 0 != pFeature->hasMissing || pFeature->countBins < 0 || 0 == pFeature->countBins && (0 != cTrainingInstances || 0 != cValidationInstances)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile bad feature");
+            return true;
+         }
+      }
+      size_t cFeatureCombinationIndexesUsed = 0;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < m_cFeatureCombinations; ++iFeatureCombination) {
+         const IntegerDataType countFeaturesInCombination = aFeatureCombinations[iFeatureCombination].countFeaturesInCombination;
+         if(countFeaturesInCombination < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination) || cFeatureCombinationIndexes - cFeatureCombinationIndexesUsed < static_cast<size_t>(countFeaturesInCombination)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile bad countFeaturesInCombination");
+            return true;
+         }
+         cFeatureCombinationIndexesUsed += static_cast<size_t>(countFeaturesInCombination);
+      }
+      if(cFeatureCombinationIndexes != cFeatureCombinationIndexesUsed) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile cFeatureCombinationIndexes != cFeatureCombinationIndexesUsed");
+         return true;
+      }
+      for(size_t iFeatureCombinationIndex = 0; iFeatureCombinationIndex < cFeatureCombinationIndexes; ++iFeatureCombinationIndex) {
+         const IntegerDataType indexFeature = aFeatureCombinationIndexes[iFeatureCombinationIndex];
+         if(indexFeature < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexFeature) || m_cFeatures <= static_cast<size_t>(indexFeature)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile bad feature index");
+            return true;
+         }
+      }
+
+      if(InitializeFeatures(m_cFeatures, m_aFeatures, aFeatures, cTrainingInstances, cValidationInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile InitializeFeatures");
+         return true;
+      }
+      if(InitializeFeatureCombinations(m_cFeatures, m_aFeatures, m_cFeatureCombinations, m_apFeatureCombinations, aFeatureCombinations, 0 == cFeatureCombinationIndexes ? nullptr : aFeatureCombinationIndexes)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile InitializeFeatureCombinations");
+         return true;
+      }
+
+      if(0 != cTrainingInstances) {
+         m_pTrainingSet = ReadDataSet(pMemoryMappedFile, &cBytesConsumed, m_runtimeLearningTypeOrCountTargetClasses, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, &m_aTrainingTargets, &m_aaTrainingInputData);
+         if(nullptr == m_pTrainingSet) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile nullptr == m_pTrainingSet");
+            return true;
+         }
+      }
+      if(0 != cValidationInstances) {
+         m_pValidationSet = ReadDataSet(pMemoryMappedFile, &cBytesConsumed, m_runtimeLearningTypeOrCountTargetClasses, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, &m_aValidationTargets, &m_aaValidationInputData);
+         if(nullptr == m_pValidationSet) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile nullptr == m_pValidationSet");
+            return true;
+         }
+      }
+
+      if(pMemoryMappedFile->GetCountBytes() != cBytesConsumed) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile the file is longer than its contents");
+         return true;
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSet::InitializeFromFile");
+      return false;
+   } catch(...) {
+      // this is here to catch exceptions from any C++ types that we put in here later
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::InitializeFromFile exception");
+      return true;
+   }
+}
+
+static bool WriteDataSet(FILE * const pFile, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const DataSetByFeatureCombination * const pDataSet, const void * const aTargets) {
+   if(nullptr != pDataSet) {
+      const size_t cInstances = pDataSet->GetCountInstances();
+      if(WriteSection(pFile, aTargets, GetCountBytesTargets(cInstances))) {
+         LOG_0(TraceLevelWarning, "WARNING WriteDataSet WriteSection for the targets");
+         return true;
+      }
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinations[iFeatureCombination];
+         if(0 != pFeatureCombination->m_cFeatures) {
+            if(WriteSection(pFile, pDataSet->GetInputDataPointer(pFeatureCombination), GetCountBytesInputData(pFeatureCombination, cInstances))) {
+               LOG_0(TraceLevelWarning, "WARNING WriteDataSet WriteSection for the input data");
+               return true;
+            }
+         }
+      }
+   }
+   return false;
+}
+
+bool EbmTrainingDataSet::Save(const char * const filePath) const {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSet::Save");
+   EBM_ASSERT(nullptr != filePath);
+
+   FILE * const pFile = fopen(filePath, "wb");
+   if(nullptr == pFile) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Save nullptr == pFile");
+      return true;
+   }
+
+   bool bError = false;
+
+   size_t cFeatureCombinationIndexes = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < m_cFeatureCombinations; ++iFeatureCombination) {
+      cFeatureCombinationIndexes += m_apFeatureCombinations[iFeatureCombination]->m_cFeatures;
+   }
+
+   DataSetFileHeader header;
+   memcpy(header.m_magic, k_dataSetFileMagic, sizeof(header.m_magic));
+   header.m_version = k_dataSetFileVersion;
+   header.m_byteOrderMark = k_dataSetFileByteOrderMark;
+   header.m_cBytesStorageDataType = sizeof(StorageDataTypeCore);
+   header.m_runtimeLearningTypeOrCountTargetClasses = static_cast<int64_t>(m_runtimeLearningTypeOrCountTargetClasses);
+   header.m_cFeatures = static_cast<uint64_t>(m_cFeatures);
+   header.m_cFeatureCombinations = static_cast<uint64_t>(m_cFeatureCombinations);
+   header.m_cFeatureCombinationIndexes = static_cast<uint64_t>(cFeatureCombinationIndexes);
+   header.m_cTrainingInstances = static_cast<uint64_t>(GetCountTrainingInstances());
+   header.m_cValidationInstances = static_cast<uint64_t>(GetCountValidationInstances());
+   bError = bError || WriteSection(pFile, &header, sizeof(header));
+
+   for(size_t iFeature = 0; !bError && iFeature < m_cFeatures; ++iFeature) {
+      const FeatureCore * const pFeature = &m_aFeatures[iFeature];
+      EbmCoreFeature feature;
+      feature.featureType = static_cast<IntegerDataType>(pFeature->m_featureType);
+      feature.hasMissing = pFeature->m_bMissing ? IntegerDataType { 1 } : IntegerDataType { 0 };
+      feature.countBins = static_cast<IntegerDataType>(pFeature->m_cBins);
+      bError = fwrite(&feature, sizeof(feature), 1, pFile) != 1;
+   }
+   for(size_t iFeatureCombination = 0; !bError && iFeatureCombination < m_cFeatureCombinations; ++iFeatureCombination) {
+      EbmCoreFeatureCombination featureCombination;
+      featureCombination.countFeaturesInCombination = static_cast<IntegerDataType>(m_apFeatureCombinations[iFeatureCombination]->m_cFeatures);
+      bError = fwrite(&featureCombination, sizeof(featureCombination), 1, pFile) != 1;
+   }
+   for(size_t iFeatureCombination = 0; !bError && iFeatureCombination < m_cFeatureCombinations; ++iFeatureCombination) {
+      const FeatureCombinationCore * const pFeatureCombination = m_apFeatureCombinations[iFeatureCombination];
+      const FeatureCombinationCore::FeatureCombinationEntry * const aFeatureCombinationEntry = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry);
+      for(size_t iEntry = 0; !bError && iEntry < pFeatureCombination->m_cFeatures; ++iEntry) {
+         const IntegerDataType indexFeature = static_cast<IntegerDataType>(aFeatureCombinationEntry[iEntry].m_pFeature->m_iFeatureData);
+         bError = fwrite(&indexFeature, sizeof(indexFeature), 1, pFile) != 1;
+      }
+   }
+
+   bError = bError || WriteDataSet(pFile, m_cFeatureCombinations, m_apFeatureCombinations, m_pTrainingSet, m_aTrainingTargets);
+   bError = bError || WriteDataSet(pFile, m_cFeatureCombinations, m_apFeatureCombinations, m_pValidationSet, m_aValidationTargets);
+
+   if(0 != fclose(pFile)) {
+      bError = true;
+   }
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSet::Save failed to write the file");
+      return true;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSet::Save");
+   return false;
+}
+
+static EbmTrainingDataSet * AllocateCoreTrainingDataSetFromFile(const char * const filePath) {
+   MemoryMappedFile * const pMemoryMappedFile = MemoryMappedFile::Open(filePath);
+   if(nullptr == pMemoryMappedFile) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile nullptr == pMemoryMappedFile");
+      return nullptr;
+   }
+   if(pMemoryMappedFile->GetCountBytes() < sizeof(DataSetFileHeader)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile the file is too short for the header");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const DataSetFileHeader * const pHeader = static_cast<const DataSetFileHeader *>(pMemoryMappedFile->GetData());
+   if(0 != memcmp(pHeader->m_magic, k_dataSetFileMagic, sizeof(pHeader->m_magic)) || k_dataSetFileVersion != pHeader->m_version || k_dataSetFileByteOrderMark != pHeader->m_byteOrderMark || sizeof(StorageDataTypeCore) != pHeader->m_cBytesStorageDataType) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile this isn't a data set file version that this machine can read");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const int64_t runtimeLearningTypeOrCountTargetClasses = pHeader->m_runtimeLearningTypeOrCountTargetClasses;
+   if(k_Regression != runtimeLearningTypeOrCountTargetClasses && runtimeLearningTypeOrCountTargetClasses < 0 || !IsNumberConvertable<ptrdiff_t, int64_t>(runtimeLearningTypeOrCountTargetClasses) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatures) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatureCombinations) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatureCombinationIndexes) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cTrainingInstances) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile bad header");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   if(0 == runtimeLearningTypeOrCountTargetClasses && (0 != pHeader->m_cTrainingInstances || 0 != pHeader->m_cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile zero target classes with instances");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClassesCore = static_cast<ptrdiff_t>(runtimeLearningTypeOrCountTargetClasses);
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClassesCore);
+   const size_t cTrainingInstances = static_cast<size_t>(pHeader->m_cTrainingInstances);
+   const size_t cValidationInstances = static_cast<size_t>(pHeader->m_cValidationInstances);
+   // each EbmTrainingState that views us allocates cVectorLength residuals per instance, so check for overflow here where we can still report it
+   if(IsMultiplyError(cVectorLength, cTrainingInstances) || IsMultiplyError(cVectorLength, cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile IsMultiplyError(cVectorLength, cInstances)");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const size_t cFeatures = static_cast<size_t>(pHeader->m_cFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(pHeader->m_cFeatureCombinations);
+   // the file has to hold these arrays, so don't allocate anything for counts that the file is too short for
+   if(pMemoryMappedFile->GetCountBytes() / sizeof(EbmCoreFeature) < cFeatures || pMemoryMappedFile->GetCountBytes() / sizeof(EbmCoreFeatureCombination) < cFeatureCombinations) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile the file is too short for its counts");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+
+   EbmTrainingDataSet * const pEbmTrainingDataSet = new (std::nothrow) EbmTrainingDataSet(runtimeLearningTypeOrCountTargetClassesCore, cFeatures, cFeatureCombinations);
+   if(UNLIKELY(nullptr == pEbmTrainingDataSet)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile nullptr == pEbmTrainingDataSet");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingDataSet->InitializeFromFile(pMemoryMappedFile))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetFromFile pEbmTrainingDataSet->InitializeFromFile");
+      // pEbmTrainingDataSet owns the mapping now
+      EbmTrainingDataSet::Release(pEbmTrainingDataSet);
+      return nullptr;
+   }
+   return pEbmTrainingDataSet;
+}
+
+void EbmTrainingDataSet::FreeInputData(const size_t cFeatureCombinations, const StorageDataTypeCore * const * const aaInputData) {
+   if(nullptr != aaInputData) {
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         // feature combinations without features have nullptr here, which free skips
+         free(const_cast<StorageDataTypeCore *>(aaInputData[iFeatureCombination]));
+      }
+      free(const_cast<const StorageDataTypeCore **>(aaInputData));
+   }
+}
+
+bool EbmTrainingDataSetBuilder::InitializeInstances(InstancesBuilder * const pInstances, const size_t cInstances, const size_t cBytesPerTarget, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations) {
+   pInstances->m_cInstances = cInstances;
+   if(0 != cInstances) {
+      if(IsMultiplyError(cBytesPerTarget, cInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::InitializeInstances IsMultiplyError(cBytesPerTarget, cInstances)");
+         return true;
+      }
+      pInstances->m_aTargets = malloc(cBytesPerTarget * cInstances);
+      if(nullptr == pInstances->m_aTargets) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::InitializeInstances nullptr == pInstances->m_aTargets");
+         return true;
+      }
+      if(0 != cFeatureCombinations) {
+         EBM_ASSERT(!IsMultiplyError(sizeof(*pInstances->m_aaInputData), cFeatureCombinations)); // we allocated apFeatureCombinations with the same count
+         StorageDataTypeCore ** const aaInputData = static_cast<StorageDataTypeCore **>(malloc(sizeof(*aaInputData) * cFeatureCombinations));
+         if(nullptr == aaInputData) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::InitializeInstances nullptr == aaInputData");
+            return true;
+         }
+         // zero the pointers first so that our destructor can free whatever we managed to allocate if we exit early
+         for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+            aaInputData[iFeatureCombination] = nullptr;
+         }
+         pInstances->m_aaInputData = aaInputData;
+         for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+            const FeatureCombinationCore * const pFeatureCombination = apFeatureCombinations[iFeatureCombination];
+            if(0 != pFeatureCombination->m_cFeatures) {
+               const size_t cDataUnits = (cInstances - 1) / pFeatureCombination->m_cItemsPerBitPackDataUnit + 1; // this can't overflow or underflow
+               if(IsMultiplyError(sizeof(StorageDataTypeCore), cDataUnits)) {
+                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::InitializeInstances IsMultiplyError(sizeof(StorageDataTypeCore), cDataUnits)");
+                  return true;
+               }
+               const size_t cBytesData = sizeof(StorageDataTypeCore) * cDataUnits;
+               StorageDataTypeCore * const aInputData = static_cast<StorageDataTypeCore *>(malloc(cBytesData));
+               if(nullptr == aInputData) {
+                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::InitializeInstances nullptr == aInputData");
+                  return true;
+               }
+               // Append ORs each item into its data unit, and the unused bits past the last item need to be zero like ConstructInputData leaves them
+               memset(aInputData, 0, cBytesData);
+               aaInputData[iFeatureCombination] = aInputData;
+            }
+         }
+      }
+   }
+   return false;
+}
+
+bool EbmTrainingDataSetBuilder::Initialize(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const size_t cValidationInstances) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSetBuilder::Initialize");
+   try {
+      EbmTrainingDataSet * const pEbmTrainingDataSet = m_pEbmTrainingDataSet;
+      if(0 != pEbmTrainingDataSet->m_cFeatures && nullptr == pEbmTrainingDataSet->m_aFeatures) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize 0 != m_cFeatures && nullptr == m_aFeatures");
+         return true;
+      }
+
+      if(UNLIKELY(0 != pEbmTrainingDataSet->m_cFeatureCombinations && nullptr == pEbmTrainingDataSet->m_apFeatureCombinations)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize 0 != m_cFeatureCombinations && nullptr == m_apFeatureCombinations");
+         return true;
+      }
+
+      if(EbmTrainingDataSet::InitializeFeatures(pEbmTrainingDataSet->m_cFeatures, pEbmTrainingDataSet->m_aFeatures, aFeatures, cTrainingInstances, cValidationInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize InitializeFeatures");
+         return true;
+      }
+      if(EbmTrainingDataSet::InitializeFeatureCombinations(pEbmTrainingDataSet->m_cFeatures, pEbmTrainingDataSet->m_aFeatures, pEbmTrainingDataSet->m_cFeatureCombinations, pEbmTrainingDataSet->m_apFeatureCombinations, aFeatureCombinations, featureCombinationIndexes)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize InitializeFeatureCombinations");
+         return true;
+      }
+
+      const size_t cBytesPerTarget = IsRegression(pEbmTrainingDataSet->m_runtimeLearningTypeOrCountTargetClasses) ? sizeof(FractionalDataType) : sizeof(IntegerDataType);
+      if(InitializeInstances(&m_training, cTrainingInstances, cBytesPerTarget, pEbmTrainingDataSet->m_cFeatureCombinations, pEbmTrainingDataSet->m_apFeatureCombinations)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize InitializeInstances training");
+         return true;
+      }
+      if(InitializeInstances(&m_validation, cValidationInstances, cBytesPerTarget, pEbmTrainingDataSet->m_cFeatureCombinations, pEbmTrainingDataSet->m_apFeatureCombinations)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize InitializeInstances validation");
+         return true;
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSetBuilder::Initialize");
+      return false;
+   } catch(...) {
+      // this is here to catch exceptions from any C++ types that we put in here later
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Initialize exception");
+      return true;
+   }
+}
+
+bool EbmTrainingDataSetBuilder::Append(const bool bValidation, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData) {
+   LOG_0(TraceLevelVerbose, "Entered EbmTrainingDataSetBuilder::Append");
+
+   EBM_ASSERT(nullptr != m_pEbmTrainingDataSet);
+   InstancesBuilder * const pInstances = bValidation ? &m_validation : &m_training;
+   EBM_ASSERT(pInstances->m_cInstancesAppended <= pInstances->m_cInstances);
+   if(pInstances->m_cInstances - pInstances->m_cInstancesAppended < cInstances) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Append more instances than we were created for");
+      return true;
+   }
+   if(0 == cInstances) {
+      return false;
+   }
+   EBM_ASSERT(nullptr != aTargets);
+
+#ifndef NDEBUG
+   CheckTargets(m_pEbmTrainingDataSet->m_runtimeLearningTypeOrCountTargetClasses, cInstances, aTargets);
+#endif // NDEBUG
+
+   const size_t iInstanceStart = pInstances->m_cInstancesAppended;
+   // both our target types are 8 bytes, and we allocated m_aTargets for m_cInstances of them, so none of these can overflow
+   static_assert(sizeof(IntegerDataType) == sizeof(FractionalDataType), "we store regression and classification targets in the same number of bytes");
+   memcpy(static_cast<char *>(pInstances->m_aTargets) + sizeof(IntegerDataType) * iInstanceStart, aTargets, sizeof(IntegerDataType) * cInstances);
+
+   const size_t cFeatureCombinations = m_pEbmTrainingDataSet->m_cFeatureCombinations;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const FeatureCombinationCore * const pFeatureCombination = m_pEbmTrainingDataSet->m_apFeatureCombinations[iFeatureCombination];
+      const size_t cFeatures = pFeatureCombination->m_cFeatures;
+      if(0 != cFeatures) {
+         EBM_ASSERT(nullptr != aBinnedData);
+         const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
+         const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+         const size_t shiftEnd = cBitsPerItemMax * cItemsPerBitPackDataUnit;
+         EBM_ASSERT(shiftEnd <= CountBitsRequiredPositiveMax<StorageDataTypeCore>());
+
+         const IntegerDataType * apInputData[k_cDimensionsMax];
+         size_t acBins[k_cDimensionsMax];
+         const FeatureCombinationCore::FeatureCombinationEntry * const aFeatureCombinationEntry = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry);
+         for(size_t iDimension = 0; iDimension < cFeatures; ++iDimension) {
+            const FeatureCore * const pFeature = aFeatureCombinationEntry[iDimension].m_pFeature;
+            apInputData[iDimension] = &aBinnedData[pFeature->m_iFeatureData * cInstances];
+            acBins[iDimension] = pFeature->m_cBins;
+         }
+
+         // pick up where the last chunk stopped, which can be in the middle of a data unit
+         StorageDataTypeCore * pInputDataTo = pInstances->m_aaInputData[iFeatureCombination] + iInstanceStart / cItemsPerBitPackDataUnit;
+         size_t shift = iInstanceStart % cItemsPerBitPackDataUnit * cBitsPerItemMax;
+         size_t bits = static_cast<size_t>(*pInputDataTo);
+         for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+            size_t tensorMultiple = 1;
+            size_t tensorIndex = 0;
+            for(size_t iDimension = 0; iDimension < cFeatures; ++iDimension) {
+               const IntegerDataType inputData = apInputData[iDimension][iInstance];
+               EBM_ASSERT(0 <= inputData);
+               EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(inputData)));
+               EBM_ASSERT(static_cast<size_t>(inputData) < acBins[iDimension]);
+               EBM_ASSERT(!IsMultiplyError(tensorMultiple, acBins[iDimension])); // we check for overflows during FeatureCombination construction, but let's check here again
+               tensorIndex += tensorMultiple * static_cast<size_t>(inputData);
+               tensorMultiple *= acBins[iDimension];
+            }
+            // like ConstructInputData, our first item goes in the least significant bits
+            bits |= tensorIndex << shift;
+            shift += cBitsPerItemMax;
+            if(shiftEnd == shift) {
+               EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(bits)));
+               *pInputDataTo = static_cast<StorageDataTypeCore>(bits);
+               ++pInputDataTo;
+               bits = 0;
+               shift = 0;
+            }
+         }
+         if(0 != shift) {
+            // the next chunk continues filling this data unit, and if there isn't one, the remaining bits stay zero
+            EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(bits)));
+            *pInputDataTo = static_cast<StorageDataTypeCore>(bits);
+         }
+      }
+   }
+   pInstances->m_cInstancesAppended = iInstanceStart + cInstances;
+
+   LOG_0(TraceLevelVerbose, "Exited EbmTrainingDataSetBuilder::Append");
+   return false;
+}
+
+bool EbmTrainingDataSetBuilder::AppendValues(const bool bValidation, const size_t cInstances, const void * const aTargets, const FractionalDataType * const aCuts, const FractionalDataType * const aValues) {
+   LOG_0(TraceLevelVerbose, "Entered EbmTrainingDataSetBuilder::AppendValues");
+
+   EBM_ASSERT(nullptr != m_pEbmTrainingDataSet);
+   const InstancesBuilder * const pInstances = bValidation ? &m_validation : &m_training;
+   EBM_ASSERT(pInstances->m_cInstancesAppended <= pInstances->m_cInstances);
+   if(pInstances->m_cInstances - pInstances->m_cInstancesAppended < cInstances) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::AppendValues more instances than we were created for");
+      return true;
+   }
+   const size_t cFeatures = m_pEbmTrainingDataSet->m_cFeatures;
+   if(0 == cInstances) {
+      return false;
+   }
+   if(0 == cFeatures) {
+      return Append(bValidation, cInstances, aTargets, nullptr);
+   }
+   EBM_ASSERT(nullptr != aValues);
+
+   const size_t cInstancesBlockMax = cInstances < k_cInstancesPerBinningBlock ? cInstances : k_cInstancesPerBinningBlock;
+   // our caller passed us cFeatures * cInstances values of the same size as IntegerDataType, so neither of these can overflow
+   static_assert(sizeof(IntegerDataType) == sizeof(FractionalDataType), "our binned block can't be larger than the values");
+   size_t * const aiCutsStart = static_cast<size_t *>(malloc(sizeof(size_t) * cFeatures));
+   IntegerDataType * const aBinnedBlock = static_cast<IntegerDataType *>(malloc(sizeof(IntegerDataType) * cFeatures * cInstancesBlockMax));
+   if(UNLIKELY(nullptr == aiCutsStart || nullptr == aBinnedBlock)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::AppendValues nullptr == aiCutsStart || nullptr == aBinnedBlock");
+      free(aBinnedBlock);
+      free(aiCutsStart);
+      return true;
+   }
+
+   size_t cCutsTotal = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      aiCutsStart[iFeature] = cCutsTotal;
+      cCutsTotal += GetCountCuts(m_pEbmTrainingDataSet->m_aFeatures[iFeature].m_cBins);
+   }
+   EBM_ASSERT(0 == cCutsTotal || nullptr != aCuts);
+
+   const char * pTargets = static_cast<const char *>(aTargets);
+   size_t iInstanceStart = 0;
+   do {
+      const size_t cInstancesRemaining = cInstances - iInstanceStart;
+      const size_t cInstancesBlock = cInstancesRemaining < cInstancesBlockMax ? cInstancesRemaining : cInstancesBlockMax;
+      // the block is feature major just like the chunks that Append takes, but holds only cInstancesBlock instances per feature
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         BinFeatureColumn(
+            GetCountCuts(m_pEbmTrainingDataSet->m_aFeatures[iFeature].m_cBins),
+            &aCuts[aiCutsStart[iFeature]],
+            cInstancesBlock,
+            &aValues[iFeature * cInstances + iInstanceStart],
+            &aBinnedBlock[iFeature * cInstancesBlock]
+         );
+      }
+      // we checked above that every block fits, so Append can't fail
+      const bool bError = Append(bValidation, cInstancesBlock, pTargets, aBinnedBlock);
+      EBM_ASSERT(!bError);
+      UNUSED(bError);
+      // both our target types are 8 bytes
+      pTargets += sizeof(IntegerDataType) * cInstancesBlock;
+      iInstanceStart += cInstancesBlock;
+   } while(cInstances != iInstanceStart);
+
+   free(aBinnedBlock);
+   free(aiCutsStart);
+
+   LOG_0(TraceLevelVerbose, "Exited EbmTrainingDataSetBuilder::AppendValues");
+   return false;
+}
+
+EbmTrainingDataSet * EbmTrainingDataSetBuilder::Finish() {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingDataSetBuilder::Finish");
+
+   EbmTrainingDataSet * const pEbmTrainingDataSet = m_pEbmTrainingDataSet;
+   EBM_ASSERT(nullptr != pEbmTrainingDataSet);
+   if(m_training.m_cInstances != m_training.m_cInstancesAppended || m_validation.m_cInstances != m_validation.m_cInstancesAppended) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Finish instances are missing");
+      return nullptr;
+   }
+
+   // the data set owns the targets and bit packed data from here on, and our destructor won't free them
+   pEbmTrainingDataSet->m_aTrainingTargets = m_training.m_aTargets;
+   m_training.m_aTargets = nullptr;
+   pEbmTrainingDataSet->m_aaTrainingInputData = const_cast<const StorageDataTypeCore **>(m_training.m_aaInputData);
+   m_training.m_aaInputData = nullptr;
+   pEbmTrainingDataSet->m_aValidationTargets = m_validation.m_aTargets;
+   m_validation.m_aTargets = nullptr;
+   pEbmTrainingDataSet->m_aaValidationInputData = const_cast<const StorageDataTypeCore **>(m_validation.m_aaInputData);
+   m_validation.m_aaInputData = nullptr;
+
+   const bool bRegression = IsRegression(pEbmTrainingDataSet->m_runtimeLearningTypeOrCountTargetClasses);
+   const size_t cFeatureCombinations = pEbmTrainingDataSet->m_cFeatureCombinations;
+   if(0 != m_training.m_cInstances) {
+      pEbmTrainingDataSet->m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(cFeatureCombinations, pEbmTrainingDataSet->m_aaTrainingInputData, m_training.m_cInstances, !bRegression, pEbmTrainingDataSet->m_aTrainingTargets);
+      if(nullptr == pEbmTrainingDataSet->m_pTrainingSet || pEbmTrainingDataSet->m_pTrainingSet->IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Finish nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
+         return nullptr;
+      }
+   }
+   if(0 != m_validation.m_cInstances) {
+      pEbmTrainingDataSet->m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(cFeatureCombinations, pEbmTrainingDataSet->m_aaValidationInputData, m_validation.m_cInstances, !bRegression, pEbmTrainingDataSet->m_aValidationTargets);
+      if(nullptr == pEbmTrainingDataSet->m_pValidationSet || pEbmTrainingDataSet->m_pValidationSet->IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingDataSetBuilder::Finish nullptr == m_pValidationSet || m_pValidationSet->IsError()");
+         return nullptr;
+      }
+   }
+
+   // our reference goes to our caller
+   m_pEbmTrainingDataSet = nullptr;
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingDataSetBuilder::Finish");
+   return pEbmTrainingDataSet;
+}
+
+static EbmTrainingDataSet * AllocateCoreTrainingDataSet(const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const void * const trainingTargets, const IntegerDataType * const trainingBinnedData, const IntegerDataType countValidationInstances, const void * const validationTargets, const IntegerDataType * const validationBinnedData) {
+   EBM_ASSERT(0 <= countFeatures);
+   EBM_ASSERT(0 == countFeatures || nullptr != features);
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   EBM_ASSERT(0 <= countTrainingInstances);
+   EBM_ASSERT(0 == countTrainingInstances || nullptr != trainingTargets);
+   EBM_ASSERT(0 == countTrainingInstances || 0 == countFeatures || nullptr != trainingBinnedData);
+   EBM_ASSERT(0 <= countValidationInstances);
+   EBM_ASSERT(0 == countValidationInstances || nullptr != validationTargets);
+   EBM_ASSERT(0 == countValidationInstances || 0 == countFeatures || nullptr != validationBinnedData);
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet !IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet !IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)");
+      return nullptr;
+   }
+
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   const size_t cTrainingInstances = static_cast<size_t>(countTrainingInstances);
+   const size_t cValidationInstances = static_cast<size_t>(countValidationInstances);
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+
+   // each EbmTrainingState that views us allocates cVectorLength residuals per instance, so check for overflow here where we can still report it
+   if(IsMultiplyError(cVectorLength, cTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet IsMultiplyError(cVectorLength, cTrainingInstances)");
+      return nullptr;
+   }
+   if(IsMultiplyError(cVectorLength, cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet IsMultiplyError(cVectorLength, cValidationInstances)");
+      return nullptr;
+   }
+
+#ifndef NDEBUG
+   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cTrainingInstances, trainingTargets);
+   CheckTargets(runtimeLearningTypeOrCountTargetClasses, cValidationInstances, validationTargets);
+#endif // NDEBUG
+
+   EbmTrainingDataSet * const pEbmTrainingDataSet = new (std::nothrow) EbmTrainingDataSet(runtimeLearningTypeOrCountTargetClasses, cFeatures, cFeatureCombinations);
+   if(UNLIKELY(nullptr == pEbmTrainingDataSet)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet nullptr == pEbmTrainingDataSet");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingDataSet->Initialize(features, featureCombinations, featureCombinationIndexes, cTrainingInstances, trainingTargets, trainingBinnedData, cValidationInstances, validationTargets, validationBinnedData))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSet pEbmTrainingDataSet->Initialize");
+      EbmTrainingDataSet::Release(pEbmTrainingDataSet);
+      return nullptr;
+   }
+   return pEbmTrainingDataSet;
+}
+
+static EbmTrainingDataSetBuilder * AllocateCoreTrainingDataSetBuilder(const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const IntegerDataType countValidationInstances) {
+   EBM_ASSERT(0 <= countFeatures);
+   EBM_ASSERT(0 == countFeatures || nullptr != features);
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   EBM_ASSERT(0 <= countTrainingInstances);
+   EBM_ASSERT(0 <= countValidationInstances);
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder !IsNumberConvertable<size_t, IntegerDataType>(countTrainingInstances)");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder !IsNumberConvertable<size_t, IntegerDataType>(countValidationInstances)");
+      return nullptr;
+   }
+
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   const size_t cTrainingInstances = static_cast<size_t>(countTrainingInstances);
+   const size_t cValidationInstances = static_cast<size_t>(countValidationInstances);
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+
+   // each EbmTrainingState that views our data set allocates cVectorLength residuals per instance, so check for overflow here where we can still report it
+   if(IsMultiplyError(cVectorLength, cTrainingInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder IsMultiplyError(cVectorLength, cTrainingInstances)");
+      return nullptr;
+   }
+   if(IsMultiplyError(cVectorLength, cValidationInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder IsMultiplyError(cVectorLength, cValidationInstances)");
+      return nullptr;
+   }
+
+   EbmTrainingDataSet * const pEbmTrainingDataSet = new (std::nothrow) EbmTrainingDataSet(runtimeLearningTypeOrCountTargetClasses, cFeatures, cFeatureCombinations);
+   if(UNLIKELY(nullptr == pEbmTrainingDataSet)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder nullptr == pEbmTrainingDataSet");
+      return nullptr;
+   }
+   EbmTrainingDataSetBuilder * const pEbmTrainingDataSetBuilder = new (std::nothrow) EbmTrainingDataSetBuilder(pEbmTrainingDataSet);
+   if(UNLIKELY(nullptr == pEbmTrainingDataSetBuilder)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder nullptr == pEbmTrainingDataSetBuilder");
+      EbmTrainingDataSet::Release(pEbmTrainingDataSet);
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingDataSetBuilder->Initialize(features, featureCombinations, featureCombinationIndexes, cTrainingInstances, cValidationInstances))) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCoreTrainingDataSetBuilder pEbmTrainingDataSetBuilder->Initialize");
+      delete pEbmTrainingDataSetBuilder;
+      return nullptr;
+   }
+   return pEbmTrainingDataSetBuilder;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION InitializeTrainingDataSetRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   const FractionalDataType * trainingTargets,
+   const IntegerDataType * trainingBinnedData,
+   IntegerDataType countValidationInstances,
+   const FractionalDataType * validationTargets,
+   const IntegerDataType * validationBinnedData
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingDataSetRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData));
+   const PEbmTrainingDataSet pEbmTrainingDataSet = reinterpret_cast<PEbmTrainingDataSet>(AllocateCoreTrainingDataSet(countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, trainingTargets, trainingBinnedData, countValidationInstances, validationTargets, validationBinnedData));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingDataSetRegression %p", static_cast<void *>(pEbmTrainingDataSet));
+   return pEbmTrainingDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION InitializeTrainingDataSetClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingTargets,
+   const IntegerDataType * trainingBinnedData,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationTargets,
+   const IntegerDataType * validationBinnedData
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingDataSetClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData));
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingDataSetClassification countTargetClasses can't be negative");
+      return nullptr;
+   }
+   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingDataSetClassification countTargetClasses can't be zero unless there are no training and no validation cases");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingDataSetClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const PEbmTrainingDataSet pEbmTrainingDataSet = reinterpret_cast<PEbmTrainingDataSet>(AllocateCoreTrainingDataSet(countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, countValidationInstances, validationTargets, validationBinnedData));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingDataSetClassification %p", static_cast<void *>(pEbmTrainingDataSet));
+   return pEbmTrainingDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeTrainingDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeTrainingDataSet: ebmTrainingDataSet=%p", static_cast<void *>(ebmTrainingDataSet));
+   EbmTrainingDataSet * const pEbmTrainingDataSet = reinterpret_cast<EbmTrainingDataSet *>(ebmTrainingDataSet);
+   EBM_ASSERT(nullptr != pEbmTrainingDataSet);
+   EbmTrainingDataSet::Release(pEbmTrainingDataSet);
+   LOG_0(TraceLevelInfo, "Exited FreeTrainingDataSet");
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SaveTrainingDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet,
+   const char * filePath
+) {
+   LOG_N(TraceLevelInfo, "Entered SaveTrainingDataSet: ebmTrainingDataSet=%p, filePath=%p", static_cast<void *>(ebmTrainingDataSet), static_cast<const void *>(filePath));
+   const EbmTrainingDataSet * const pEbmTrainingDataSet = reinterpret_cast<const EbmTrainingDataSet *>(ebmTrainingDataSet);
+   EBM_ASSERT(nullptr != pEbmTrainingDataSet);
+   if(nullptr == filePath) {
+      LOG_0(TraceLevelError, "ERROR SaveTrainingDataSet filePath cannot be nullptr");
+      return 1;
+   }
+   const IntegerDataType ret = pEbmTrainingDataSet->Save(filePath) ? IntegerDataType { 1 } : IntegerDataType { 0 };
+   LOG_N(TraceLevelInfo, "Exited SaveTrainingDataSet %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION OpenTrainingDataSet(
+   const char * filePath
+) {
+   LOG_N(TraceLevelInfo, "Entered OpenTrainingDataSet: filePath=%p", static_cast<const void *>(filePath));
+   if(nullptr == filePath) {
+      LOG_0(TraceLevelError, "ERROR OpenTrainingDataSet filePath cannot be nullptr");
+      return nullptr;
+   }
+   const PEbmTrainingDataSet pEbmTrainingDataSet = reinterpret_cast<PEbmTrainingDataSet>(AllocateCoreTrainingDataSetFromFile(filePath));
+   LOG_N(TraceLevelInfo, "Exited OpenTrainingDataSet %p", static_cast<void *>(pEbmTrainingDataSet));
+   return pEbmTrainingDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSetBuilder EBMCORE_CALLING_CONVENTION CreateTrainingDataSetBuilderRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTrainingInstances,
+   IntegerDataType countValidationInstances
+) {
+   LOG_N(TraceLevelInfo, "Entered CreateTrainingDataSetBuilderRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", countValidationInstances=%" IntegerDataTypePrintf, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, countValidationInstances);
+   const PEbmTrainingDataSetBuilder pEbmTrainingDataSetBuilder = reinterpret_cast<PEbmTrainingDataSetBuilder>(AllocateCoreTrainingDataSetBuilder(countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, countValidationInstances));
+   LOG_N(TraceLevelInfo, "Exited CreateTrainingDataSetBuilderRegression %p", static_cast<void *>(pEbmTrainingDataSetBuilder));
+   return pEbmTrainingDataSetBuilder;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSetBuilder EBMCORE_CALLING_CONVENTION CreateTrainingDataSetBuilderClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   IntegerDataType countValidationInstances
+) {
+   LOG_N(TraceLevelInfo, "Entered CreateTrainingDataSetBuilderClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", countValidationInstances=%" IntegerDataTypePrintf, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, countValidationInstances);
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR CreateTrainingDataSetBuilderClassification countTargetClasses can't be negative");
+      return nullptr;
+   }
+   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
+      LOG_0(TraceLevelError, "ERROR CreateTrainingDataSetBuilderClassification countTargetClasses can't be zero unless there are no training and no validation cases");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING CreateTrainingDataSetBuilderClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const PEbmTrainingDataSetBuilder pEbmTrainingDataSetBuilder = reinterpret_cast<PEbmTrainingDataSetBuilder>(AllocateCoreTrainingDataSetBuilder(countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, countValidationInstances));
+   LOG_N(TraceLevelInfo, "Exited CreateTrainingDataSetBuilderClassification %p", static_cast<void *>(pEbmTrainingDataSetBuilder));
+   return pEbmTrainingDataSetBuilder;
+}
+
+EBM_INLINE static IntegerDataType AppendTrainingDataSetBuilder(const PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder, const IntegerDataType isValidation, const IntegerDataType countInstances, const void * const targets, const IntegerDataType * const binnedData, const FractionalDataType * const cuts, const FractionalDataType * const values) {
+   EbmTrainingDataSetBuilder * const pEbmTrainingDataSetBuilder = reinterpret_cast<EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder);
+   EBM_ASSERT(nullptr != pEbmTrainingDataSetBuilder);
+   if(countInstances < 0) {
+      LOG_0(TraceLevelError, "ERROR AppendTrainingDataSetBuilder countInstances can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING AppendTrainingDataSetBuilder !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return 1;
+   }
+   // values is nullptr if our caller binned the data itself
+   const bool bError = nullptr == values ?
+      pEbmTrainingDataSetBuilder->Append(0 != isValidation, static_cast<size_t>(countInstances), targets, binnedData) :
+      pEbmTrainingDataSetBuilder->AppendValues(0 != isValidation, static_cast<size_t>(countInstances), targets, cuts, values);
+   return bError ? IntegerDataType { 1 } : IntegerDataType { 0 };
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderRegression(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData
+) {
+   LOG_N(TraceLevelVerbose, "Entered AppendTrainingDataSetBuilderRegression: ebmTrainingDataSetBuilder=%p, isValidation=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p", static_cast<void *>(ebmTrainingDataSetBuilder), isValidation, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData));
+   EBM_ASSERT(nullptr == ebmTrainingDataSetBuilder || IsRegression(reinterpret_cast<const EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder)->GetRuntimeLearningTypeOrCountTargetClasses()));
+   const IntegerDataType ret = AppendTrainingDataSetBuilder(ebmTrainingDataSetBuilder, isValidation, countInstances, targets, binnedData, nullptr, nullptr);
+   LOG_N(TraceLevelVerbose, "Exited AppendTrainingDataSetBuilderRegression %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderClassification(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData
+) {
+   LOG_N(TraceLevelVerbose, "Entered AppendTrainingDataSetBuilderClassification: ebmTrainingDataSetBuilder=%p, isValidation=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p", static_cast<void *>(ebmTrainingDataSetBuilder), isValidation, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData));
+   EBM_ASSERT(nullptr == ebmTrainingDataSetBuilder || IsClassification(reinterpret_cast<const EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder)->GetRuntimeLearningTypeOrCountTargetClasses()));
+   const IntegerDataType ret = AppendTrainingDataSetBuilder(ebmTrainingDataSetBuilder, isValidation, countInstances, targets, binnedData, nullptr, nullptr);
+   LOG_N(TraceLevelVerbose, "Exited AppendTrainingDataSetBuilderClassification %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderRegressionValues(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values
+) {
+   LOG_N(TraceLevelVerbose, "Entered AppendTrainingDataSetBuilderRegressionValues: ebmTrainingDataSetBuilder=%p, isValidation=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, cuts=%p, values=%p", static_cast<void *>(ebmTrainingDataSetBuilder), isValidation, countInstances, static_cast<const void *>(targets), static_cast<const void *>(cuts), static_cast<const void *>(values));
+   EBM_ASSERT(nullptr == ebmTrainingDataSetBuilder || IsRegression(reinterpret_cast<const EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder)->GetRuntimeLearningTypeOrCountTargetClasses()));
+   const IntegerDataType ret = AppendTrainingDataSetBuilder(ebmTrainingDataSetBuilder, isValidation, countInstances, targets, nullptr, cuts, values);
+   LOG_N(TraceLevelVerbose, "Exited AppendTrainingDataSetBuilderRegressionValues %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderClassificationValues(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values
+) {
+   LOG_N(TraceLevelVerbose, "Entered AppendTrainingDataSetBuilderClassificationValues: ebmTrainingDataSetBuilder=%p, isValidation=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, cuts=%p, values=%p", static_cast<void *>(ebmTrainingDataSetBuilder), isValidation, countInstances, static_cast<const void *>(targets), static_cast<const void *>(cuts), static_cast<const void *>(values));
+   EBM_ASSERT(nullptr == ebmTrainingDataSetBuilder || IsClassification(reinterpret_cast<const EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder)->GetRuntimeLearningTypeOrCountTargetClasses()));
+   const IntegerDataType ret = AppendTrainingDataSetBuilder(ebmTrainingDataSetBuilder, isValidation, countInstances, targets, nullptr, cuts, values);
+   LOG_N(TraceLevelVerbose, "Exited AppendTrainingDataSetBuilderClassificationValues %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION FinishTrainingDataSetBuilder(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder
+) {
+   LOG_N(TraceLevelInfo, "Entered FinishTrainingDataSetBuilder: ebmTrainingDataSetBuilder=%p", static_cast<void *>(ebmTrainingDataSetBuilder));
+   EbmTrainingDataSetBuilder * const pEbmTrainingDataSetBuilder = reinterpret_cast<EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder);
+   EBM_ASSERT(nullptr != pEbmTrainingDataSetBuilder);
+   const PEbmTrainingDataSet pEbmTrainingDataSet = reinterpret_cast<PEbmTrainingDataSet>(pEbmTrainingDataSetBuilder->Finish());
+   // we consume the builder whether we succeed or not
+   delete pEbmTrainingDataSetBuilder;
+   LOG_N(TraceLevelInfo, "Exited FinishTrainingDataSetBuilder %p", static_cast<void *>(pEbmTrainingDataSet));
+   return pEbmTrainingDataSet;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeTrainingDataSetBuilder(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeTrainingDataSetBuilder: ebmTrainingDataSetBuilder=%p", static_cast<void *>(ebmTrainingDataSetBuilder));
+   EbmTrainingDataSetBuilder * const pEbmTrainingDataSetBuilder = reinterpret_cast<EbmTrainingDataSetBuilder *>(ebmTrainingDataSetBuilder);
+   // pEbmTrainingDataSetBuilder is allowed to be nullptr.  We handle that inside the delete operator
+   delete pEbmTrainingDataSetBuilder;
+   LOG_0(TraceLevelInfo, "Exited FreeTrainingDataSetBuilder");
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef EBM_TRAINING_DATA_SET_H
+#define EBM_TRAINING_DATA_SET_H
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <atomic> // atomic
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+// very independent includes
+#include "Logging.h" // EBM_ASSERT & LOG
+// feature includes
+#include "FeatureCore.h"
+// FeatureCombination.h depends on FeatureInternal.h
+#include "FeatureCombinationCore.h"
+// dataset depends on features
+#include "DataSetByFeatureCombination.h"
+#include "MemoryMappedFile.h"
+
+#ifndef NDEBUG
+// defined in Training.cpp
+void CheckTargets(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cInstances, const void * const aTargets);
+#endif // NDEBUG
+
+// EbmTrainingDataSet holds everything about our training and validation data that doesn't change while we train: the features, the feature combinations,
+// the bit packed input data and the targets.  Any number of EbmTrainingState objects (usually one per outer bag) can train on it at the same time since each
+// of them allocates its own residuals, predictor scores, sampling sets and models.  Each EbmTrainingState holds a reference, so our caller can free its own
+// reference at any time after the EbmTrainingState objects are initialized, and whichever holder lets go of the last reference deletes us.  We can also
+// be saved to a file and reopened from it, in which case the targets and bit packed data stay in the memory mapped file instead of being loaded
+class EbmTrainingDataSet final {
+   std::atomic<size_t> m_cReferences;
+
+   EBM_INLINE ~EbmTrainingDataSet() {
+      LOG_0(TraceLevelInfo, "Entered ~EbmTrainingDataSet");
+
+      delete m_pTrainingSet;
+      delete m_pValidationSet;
+
+      if(nullptr == m_pMemoryMappedFile) {
+         FreeInputData(m_cFeatureCombinations, m_aaTrainingInputData);
+         FreeInputData(m_cFeatureCombinations, m_aaValidationInputData);
+         free(const_cast<void *>(m_aTrainingTargets));
+         free(const_cast<void *>(m_aValidationTargets));
+      } else {
+         free(m_aaTrainingInputData);
+         free(m_aaValidationInputData);
+         // our targets point into the mapping
+         delete m_pMemoryMappedFile;
+      }
+
+      FeatureCombinationCore::FreeFeatureCombinations(m_cFeatureCombinations, m_apFeatureCombinations);
+
+      free(m_aFeatures);
+
+      LOG_0(TraceLevelInfo, "Exited ~EbmTrainingDataSet");
+   }
+
+public:
+   const ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+
+   const size_t m_cFeatureCombinations;
+   FeatureCombinationCore ** const m_apFeatureCombinations;
+
+   const size_t m_cFeatures;
+   FeatureCore * const m_aFeatures;
+
+   // our copies of the caller's targets, or the targets in our memory mapped file.  Every EbmTrainingState needs them to initialize its residuals, and
+   // for classification our datasets read their target data from them where IntegerDataType allows it instead of keeping a second copy
+   const void * m_aTrainingTargets;
+   const void * m_aValidationTargets;
+
+   // if we were opened from a file, these hold the pointers into the mapping for each feature combination's bit packed data.  If we were built by an
+   // EbmTrainingDataSetBuilder, they hold the bit packed data that it appended, which we own.  Otherwise our datasets allocate and own their bit packed
+   // data, and these stay nullptr
+   MemoryMappedFile * m_pMemoryMappedFile;
+   const StorageDataTypeCore ** m_aaTrainingInputData;
+   const StorageDataTypeCore ** m_aaValidationInputData;
+
+   // these hold the input data and target data only.  The EbmTrainingState objects construct DataSetByFeatureCombination views of them
+   DataSetByFeatureCombination * m_pTrainingSet;
+   DataSetByFeatureCombination * m_pValidationSet;
+
+   EBM_INLINE EbmTrainingDataSet(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cFeatureCombinations)
+      : m_cReferences(1)
+      , m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_cFeatureCombinations(cFeatureCombinations)
+      , m_apFeatureCombinations(0 == cFeatureCombinations ? nullptr : FeatureCombinationCore::AllocateFeatureCombinations(cFeatureCombinations))
+      , m_cFeatures(cFeatures)
+      , m_aFeatures(0 == cFeatures || IsMultiplyError(sizeof(FeatureCore), cFeatures) ? nullptr : static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * cFeatures)))
+      , m_aTrainingTargets(nullptr)
+      , m_aValidationTargets(nullptr)
+      , m_pMemoryMappedFile(nullptr)
+      , m_aaTrainingInputData(nullptr)
+      , m_aaValidationInputData(nullptr)
+      , m_pTrainingSet(nullptr)
+      , m_pValidationSet(nullptr) {
+   }
+
+   // frees the bit packed data of each feature combination and then the array that points to them.  aaInputData can be nullptr
+   static void FreeInputData(const size_t cFeatureCombinations, const StorageDataTypeCore * const * const aaInputData);
+
+   EBM_INLINE void AddReference() {
+      m_cReferences.fetch_add(1, std::memory_order_relaxed);
+   }
+
+   EBM_INLINE static void Release(EbmTrainingDataSet * const pEbmTrainingDataSet) {
+      if(nullptr != pEbmTrainingDataSet) {
+         // acq_rel so that whichever thread deletes us sees every write that the other holders made before letting go of their references
+         if(size_t { 1 } == pEbmTrainingDataSet->m_cReferences.fetch_sub(1, std::memory_order_acq_rel)) {
+            delete pEbmTrainingDataSet;
+         }
+      }
+   }
+
+   EBM_INLINE size_t GetCountTrainingInstances() const {
+      return nullptr == m_pTrainingSet ? size_t { 0 } : m_pTrainingSet->GetCountInstances();
+   }
+   EBM_INLINE size_t GetCountValidationInstances() const {
+      return nullptr == m_pValidationSet ? size_t { 0 } : m_pValidationSet->GetCountInstances();
+   }
+
+   // these are shared with EbmTrainingState, which initializes its own features and feature combinations when it doesn't use an EbmTrainingDataSet
+   static bool InitializeFeatures(const size_t cFeatures, FeatureCore * const aFeaturesCore, const EbmCoreFeature * const aFeatures, const size_t cTrainingInstances, const size_t cValidationInstances);
+   static bool InitializeFeatureCombinations(const size_t cFeatures, FeatureCore * const aFeaturesCore, const size_t cFeatureCombinations, FeatureCombinationCore ** const apFeatureCombinations, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes);
+
+   bool Initialize(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData);
+   // we take ownership of pMemoryMappedFile even if we return an error
+   bool InitializeFromFile(MemoryMappedFile * const pMemoryMappedFile);
+   bool Save(const char * const filePath) const;
+};
+
+// EbmTrainingDataSetBuilder creates an EbmTrainingDataSet from chunks of instances so that our caller never needs to hold the complete binned matrix.  We
+// know the number of training and validation instances up front, so we allocate the targets and the bit packed data of each feature combination once,
+// and then bit pack every chunk straight into them as it is appended.  Chunks can be any size, and they don't need to end on a bit pack boundary
+class EbmTrainingDataSetBuilder final {
+   struct InstancesBuilder final {
+      size_t m_cInstances;
+      size_t m_cInstancesAppended;
+      void * m_aTargets;
+      StorageDataTypeCore ** m_aaInputData;
+   };
+
+   // holds a reference, which we give to our caller in Finish
+   EbmTrainingDataSet * m_pEbmTrainingDataSet;
+   InstancesBuilder m_training;
+   InstancesBuilder m_validation;
+
+   static bool InitializeInstances(InstancesBuilder * const pInstances, const size_t cInstances, const size_t cBytesPerTarget, const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations);
+
+public:
+   EBM_INLINE EbmTrainingDataSetBuilder(EbmTrainingDataSet * const pEbmTrainingDataSet)
+      : m_pEbmTrainingDataSet(pEbmTrainingDataSet)
+      , m_training { 0, 0, nullptr, nullptr }
+      , m_validation { 0, 0, nullptr, nullptr } {
+   }
+
+   EBM_INLINE ~EbmTrainingDataSetBuilder() {
+      LOG_0(TraceLevelInfo, "Entered ~EbmTrainingDataSetBuilder");
+
+      const size_t cFeatureCombinations = nullptr == m_pEbmTrainingDataSet ? size_t { 0 } : m_pEbmTrainingDataSet->m_cFeatureCombinations;
+      EbmTrainingDataSet::FreeInputData(cFeatureCombinations, const_cast<const StorageDataTypeCore * const *>(m_training.m_aaInputData));
+      EbmTrainingDataSet::FreeInputData(cFeatureCombinations, const_cast<const StorageDataTypeCore * const *>(m_validation.m_aaInputData));
+      free(m_training.m_aTargets);
+      free(m_validation.m_aTargets);
+      EbmTrainingDataSet::Release(m_pEbmTrainingDataSet);
+
+      LOG_0(TraceLevelInfo, "Exited ~EbmTrainingDataSetBuilder");
+   }
+
+   EBM_INLINE ptrdiff_t GetRuntimeLearningTypeOrCountTargetClasses() const {
+      return m_pEbmTrainingDataSet->m_runtimeLearningTypeOrCountTargetClasses;
+   }
+
+   bool Initialize(const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const size_t cValidationInstances);
+   // aBinnedData is feature major like the binned data of InitializeTrainingDataSetRegression, but holds only these cInstances
+   bool Append(const bool bValidation, const size_t cInstances, const void * const aTargets, const IntegerDataType * const aBinnedData);
+   // aValues holds raw feature values in the same layout, and aCuts holds the cuts of every feature concatenated (see Binning.h).  We bin and bit pack them
+   // one block at a time, so we never hold the binned chunk
+   bool AppendValues(const bool bValidation, const size_t cInstances, const void * const aTargets, const FractionalDataType * const aCuts, const FractionalDataType * const aValues);
+   // returns nullptr if any instances are missing.  On success our caller owns the returned data set, and we can only be deleted after that
+   EbmTrainingDataSet * Finish();
+};
+
+#endif // EBM_TRAINING_DATA_SET_H
@@ -22,38 +22,12 @@
 #include "FeatureCombinationCore.h"
 // dataset depends on features
 #include "DataSetByFeatureCombination.h"
+// the features, feature combinations and bit packed data that we can share with other EbmTrainingState objects
+#include "EbmTrainingDataSet.h"
 // samples is somewhat independent from datasets, but relies on an indirect coupling with them
 #include "SamplingWithReplacement.h"
-
-union CachedThreadResourcesUnion {
-   CachedTrainingThreadResources<false> regression;
-   CachedTrainingThreadResources<true> classification;
-
-   EBM_INLINE CachedThreadResourcesUnion(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
-      LOG_N(TraceLevelInfo, "Entered CachedThreadResourcesUnion: runtimeLearningTypeOrCountTargetClasses=%td", runtimeLearningTypeOrCountTargetClasses);
-      const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
-      if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
-         // member classes inside a union requre explicit call to constructor
-         new(&regression) CachedTrainingThreadResources<false>(cVectorLength);
-      } else {
-         EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
-         // member classes inside a union requre explicit call to constructor
-         new(&classification) CachedTrainingThreadResources<true>(cVectorLength);
-      }
-      LOG_0(TraceLevelInfo, "Exited CachedThreadResourcesUnion");
-   }
-
-   EBM_INLINE ~CachedThreadResourcesUnion() {
-      // TODO: figure out why this is being called, and if that is bad!
-      //LOG_0(TraceLevelError, "ERROR ~CachedThreadResourcesUnion called.  It's union destructors should be called explicitly");
-
-      // we don't have enough information here to delete this object, so we do it from our caller
-      // we still need this destructor for a technicality that it might be called
-      // if there were an excpetion generated in the initializer list which it is constructed in
-      // but we have been careful to ensure that the class we are including it in doesn't thow exceptions in the
-      // initializer list
-   }
-};
+#include "EbmTrainingWorkspace.h"
+#include "PhaseStatistics.h"
 
 class EbmTrainingState {
 public:
@@ -74,14 +48,35 @@ public:
 
    FractionalDataType m_bestModelMetric;
 
-   SegmentedTensor<ActiveDataType, FractionalDataType> * const m_pSmallChangeToModelOverwriteSingleSamplingSet;
-   SegmentedTensor<ActiveDataType, FractionalDataType> * const m_pSmallChangeToModelAccumulatedFromSamplingSets;
+   // the feature combinations whose current model has changed since we last copied it into m_apBestModel, so that an improvement in our validation
+   // metric only needs to copy those.  m_abBestModelStale marks which feature combinations are already in m_aiBestModelStale so that we list each once
+   bool * m_abBestModelStale;
+   size_t * m_aiBestModelStale;
+   size_t m_cBestModelStale;
+
+   // we compute our validation metric on every m_cUpdatesPerValidationMetric-th update, or only when TrainingRounds finishes a round if it's zero.  The
+   // updates in between return m_validationMetricLast.  See SetValidationMetricInterval
+   size_t m_cUpdatesPerValidationMetric;
+   size_t m_cUpdatesSinceValidationMetric;
+   FractionalDataType m_validationMetricLast;
+   // set by our first ApplyModelFeatureCombinationUpdate.  m_bestModelMetric can't tell us this since it stays at infinity until we compute a metric
+   bool m_bUpdatesApplied;
 
    const size_t m_cFeatures;
    // TODO : in the future, we can allocate this inside a function so that even the objects inside are const
    FeatureCore * const m_aFeatures;
 
-   CachedThreadResourcesUnion m_cachedThreadResourcesUnion;
+   // the scratch space used by GenerateModelFeatureCombinationUpdate and TrainingStep.  Callers that want to generate updates simultaneously allocate their own
+   EbmTrainingWorkspace * m_pEbmTrainingWorkspace;
+
+   // incremented each time that we change the training residuals, so that HistogramCache entries binned from older residuals can be recognized as stale
+   size_t m_iResidualGeneration;
+
+   // if we were initialized from an EbmTrainingDataSet, m_aFeatures, m_apFeatureCombinations and the input and target data of our datasets belong to it
+   EbmTrainingDataSet * const m_pTrainingDataSet;
+
+   // read by GetTrainingStatistics.  mutable because the sampling set training threads only get a const EbmTrainingState, and the counters are atomic
+   mutable PhaseStatistics m_statistics;
 
    EBM_INLINE EbmTrainingState(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cFeatures, const size_t cFeatureCombinations, const size_t cSamplingSets)
       : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
@@ -94,48 +89,80 @@ public:
       , m_apCurrentModel(nullptr)
       , m_apBestModel(nullptr)
       , m_bestModelMetric(FractionalDataType { std::numeric_limits<FractionalDataType>::infinity() })
-      , m_pSmallChangeToModelOverwriteSingleSamplingSet(SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(k_cDimensionsMax, GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses)))
-      , m_pSmallChangeToModelAccumulatedFromSamplingSets(SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(k_cDimensionsMax, GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses)))
+      , m_abBestModelStale(nullptr)
+      , m_aiBestModelStale(nullptr)
+      , m_cBestModelStale(0)
+      , m_cUpdatesPerValidationMetric(1)
+      , m_cUpdatesSinceValidationMetric(0)
+      , m_validationMetricLast(FractionalDataType { std::numeric_limits<FractionalDataType>::infinity() })
+      , m_bUpdatesApplied(false)
       , m_cFeatures(cFeatures)
       , m_aFeatures(0 == cFeatures || IsMultiplyError(sizeof(FeatureCore), cFeatures) ? nullptr : static_cast<FeatureCore *>(malloc(sizeof(FeatureCore) * cFeatures)))
-      // we catch any errors in the constructor, so this should not be able to throw
-      , m_cachedThreadResourcesUnion(runtimeLearningTypeOrCountTargetClasses) {
+      , m_pEbmTrainingWorkspace(nullptr)
+      , m_iResidualGeneration(0)
+      , m_pTrainingDataSet(nullptr) {
+   }
+
+   // we take one of pEbmTrainingDataSet's references, so our caller needs to call AddReference for us
+   EBM_INLINE EbmTrainingState(EbmTrainingDataSet * const pEbmTrainingDataSet, const size_t cSamplingSets)
+      : m_runtimeLearningTypeOrCountTargetClasses(pEbmTrainingDataSet->m_runtimeLearningTypeOrCountTargetClasses)
+      , m_cFeatureCombinations(pEbmTrainingDataSet->m_cFeatureCombinations)
+      , m_apFeatureCombinations(pEbmTrainingDataSet->m_apFeatureCombinations)
+      , m_pTrainingSet(nullptr)
+      , m_pValidationSet(nullptr)
+      , m_cSamplingSets(cSamplingSets)
+      , m_apSamplingSets(nullptr)
+      , m_apCurrentModel(nullptr)
+      , m_apBestModel(nullptr)
+      , m_bestModelMetric(FractionalDataType { std::numeric_limits<FractionalDataType>::infinity() })
+      , m_abBestModelStale(nullptr)
+      , m_aiBestModelStale(nullptr)
+      , m_cBestModelStale(0)
+      , m_cUpdatesPerValidationMetric(1)
+      , m_cUpdatesSinceValidationMetric(0)
+      , m_validationMetricLast(FractionalDataType { std::numeric_limits<FractionalDataType>::infinity() })
+      , m_bUpdatesApplied(false)
+      , m_cFeatures(pEbmTrainingDataSet->m_cFeatures)
+      , m_aFeatures(pEbmTrainingDataSet->m_aFeatures)
+      , m_pEbmTrainingWorkspace(nullptr)
+      , m_iResidualGeneration(0)
+      , m_pTrainingDataSet(pEbmTrainingDataSet) {
    }
 
    EBM_INLINE ~EbmTrainingState() {
       LOG_0(TraceLevelInfo, "Entered ~EbmTrainingState");
 
-      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
-         // member classes inside a union requre explicit call to destructor
-         LOG_0(TraceLevelInfo, "~EbmTrainingState identified as regression type");
-         m_cachedThreadResourcesUnion.regression.~CachedTrainingThreadResources();
-      } else {
-         EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
-         // member classes inside a union requre explicit call to destructor
-         LOG_0(TraceLevelInfo, "~EbmTrainingState identified as classification type");
-         m_cachedThreadResourcesUnion.classification.~CachedTrainingThreadResources();
-      }
+      // stop our threads before freeing anything that they could be referencing
+      delete m_pEbmTrainingWorkspace;
 
-      SamplingWithReplacement::FreeSamplingSets(m_cSamplingSets, m_apSamplingSets);
+      SamplingMethod::FreeSamplingSets(m_cSamplingSets, m_apSamplingSets);
 
       delete m_pTrainingSet;
       delete m_pValidationSet;
 
-      FeatureCombinationCore::FreeFeatureCombinations(m_cFeatureCombinations, m_apFeatureCombinations);
-
-      free(m_aFeatures);
-
       DeleteSegmentedTensors(m_cFeatureCombinations, m_apCurrentModel);
       DeleteSegmentedTensors(m_cFeatureCombinations, m_apBestModel);
-      SegmentedTensor<ActiveDataType, FractionalDataType>::Free(m_pSmallChangeToModelOverwriteSingleSamplingSet);
-      SegmentedTensor<ActiveDataType, FractionalDataType>::Free(m_pSmallChangeToModelAccumulatedFromSamplingSets);
+      free(m_abBestModelStale);
+      free(m_aiBestModelStale);
+
+      if(nullptr == m_pTrainingDataSet) {
+         FeatureCombinationCore::FreeFeatureCombinations(m_cFeatureCombinations, m_apFeatureCombinations);
+         free(m_aFeatures);
+      } else {
+         // our datasets and models are already gone, so nothing of ours still points into the shared data
+         EbmTrainingDataSet::Release(m_pTrainingDataSet);
+      }
 
       LOG_0(TraceLevelInfo, "Exited ~EbmTrainingState");
    }
 
    static void DeleteSegmentedTensors(const size_t cFeatureCombinations, SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSegmentedTensors);
    static SegmentedTensor<ActiveDataType, FractionalDataType> ** InitializeSegmentedTensors(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength);
-   bool Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores);
+   bool Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores, const bool bBorrowBuffers);
+   bool InitializeFromDataSet(const IntegerDataType randomSeed, const FractionalDataType * const aTrainingPredictorScores, const FractionalDataType * const aValidationPredictorScores, const bool bBorrowBuffers);
+
+private:
+   bool InitializeSamplingSetsAndModels(const IntegerDataType randomSeed, const size_t cTrainingInstances, const void * const aTrainingTargets, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const FractionalDataType * const aValidationPredictorScores);
 };
 
 #endif // EBM_TRAINING_STATE_H
\ No newline at end of file
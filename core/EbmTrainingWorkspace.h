@@ -0,0 +1,122 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef EBM_TRAINING_WORKSPACE_H
+#define EBM_TRAINING_WORKSPACE_H
+
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+// very independent includes
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "SegmentedTensor.h"
+// this depends on TreeNode pointers, but doesn't require the full definition of TreeNode
+#include "CachedThreadResources.h"
+#include "ThreadPool.h"
+#include "HistogramCache.h"
+
+union CachedThreadResourcesUnion {
+   CachedTrainingThreadResources<false> regression;
+   CachedTrainingThreadResources<true> classification;
+
+   EBM_INLINE CachedThreadResourcesUnion(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+      LOG_N(TraceLevelInfo, "Entered CachedThreadResourcesUnion: runtimeLearningTypeOrCountTargetClasses=%td", runtimeLearningTypeOrCountTargetClasses);
+      const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+      if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+         // member classes inside a union requre explicit call to constructor
+         new(&regression) CachedTrainingThreadResources<false>(cVectorLength);
+      } else {
+         EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+         // member classes inside a union requre explicit call to constructor
+         new(&classification) CachedTrainingThreadResources<true>(cVectorLength);
+      }
+      LOG_0(TraceLevelInfo, "Exited CachedThreadResourcesUnion");
+   }
+
+   EBM_INLINE ~CachedThreadResourcesUnion() {
+      // TODO: figure out why this is being called, and if that is bad!
+      //LOG_0(TraceLevelError, "ERROR ~CachedThreadResourcesUnion called.  It's union destructors should be called explicitly");
+
+      // we don't have enough information here to delete this object, so we do it from our caller
+      // we still need this destructor for a technicality that it might be called
+      // if there were an excpetion generated in the initializer list which it is constructed in
+      // but we have been careful to ensure that the class we are including it in doesn't thow exceptions in the
+      // initializer list
+   }
+};
+
+// EbmTrainingWorkspace holds all the scratch memory that GenerateModelFeatureCombinationUpdate writes to.  Everything else that it touches in the
+// EbmTrainingState is read-only, so separate threads can each generate model updates against the same EbmTrainingState if each thread has its own
+// EbmTrainingWorkspace.  The EbmTrainingState owns one workspace for the non-reentrant GenerateModelFeatureCombinationUpdate and TrainingStep calls.
+class EbmTrainingWorkspace final {
+public:
+   const ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t m_cSamplingSets;
+
+   // nullptr if we only have one sampling set, only one core, or if our caller is doing the threading, in which case we train everything on the caller's thread
+   ThreadPool * m_pThreadPool;
+   // one per thread, indexed by the iThread that the ThreadPool gives our tasks.  Constructed in Initialize
+   size_t m_cCachedThreadResources;
+   CachedThreadResourcesUnion * m_aCachedThreadResourcesUnion;
+
+   // each sampling set gets its own tensor so that sampling sets can be trained simultaneously on different threads.  We add them together afterwards
+   // in a fixed order so that our results do not depend on the number of threads or on how the operating system schedules them
+   SegmentedTensor<ActiveDataType, FractionalDataType> ** m_apSmallChangeToModelOverwriteSingleSamplingSet;
+   FractionalDataType * m_aSamplingSetGains;
+   SegmentedTensor<ActiveDataType, FractionalDataType> * const m_pSmallChangeToModelAccumulatedFromSamplingSets;
+
+   // one per sampling set.  Each sampling set is trained by only one thread at a time, so the caches don't need to be per-thread
+   HistogramCache * m_aHistogramCaches;
+
+   EBM_INLINE EbmTrainingWorkspace(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cSamplingSets)
+      : m_runtimeLearningTypeOrCountTargetClasses(runtimeLearningTypeOrCountTargetClasses)
+      , m_cSamplingSets(cSamplingSets)
+      , m_pThreadPool(nullptr)
+      , m_cCachedThreadResources(0)
+      , m_aCachedThreadResourcesUnion(nullptr)
+      , m_apSmallChangeToModelOverwriteSingleSamplingSet(nullptr)
+      , m_aSamplingSetGains(nullptr)
+      , m_pSmallChangeToModelAccumulatedFromSamplingSets(SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(k_cDimensionsMax, GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses)))
+      , m_aHistogramCaches(nullptr) {
+   }
+
+   EBM_INLINE ~EbmTrainingWorkspace() {
+      LOG_0(TraceLevelInfo, "Entered ~EbmTrainingWorkspace");
+
+      // our ThreadPool doesn't own any threads, and ThreadPool::Run doesn't return until every worker has left our tasks
+      delete m_pThreadPool;
+
+      for(size_t iCachedThreadResources = 0; iCachedThreadResources < m_cCachedThreadResources; ++iCachedThreadResources) {
+         if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
+            // member classes inside a union requre explicit call to destructor
+            LOG_0(TraceLevelInfo, "~EbmTrainingWorkspace identified as regression type");
+            m_aCachedThreadResourcesUnion[iCachedThreadResources].regression.~CachedTrainingThreadResources();
+         } else {
+            EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
+            // member classes inside a union requre explicit call to destructor
+            LOG_0(TraceLevelInfo, "~EbmTrainingWorkspace identified as classification type");
+            m_aCachedThreadResourcesUnion[iCachedThreadResources].classification.~CachedTrainingThreadResources();
+         }
+      }
+      free(m_aCachedThreadResourcesUnion);
+
+      FreeSmallChangeToModelOverwriteSingleSamplingSets(m_cSamplingSets, m_apSmallChangeToModelOverwriteSingleSamplingSet);
+      free(m_aSamplingSetGains);
+      SegmentedTensor<ActiveDataType, FractionalDataType>::Free(m_pSmallChangeToModelAccumulatedFromSamplingSets);
+      delete[] m_aHistogramCaches;
+
+      LOG_0(TraceLevelInfo, "Exited ~EbmTrainingWorkspace");
+   }
+
+   static void FreeSmallChangeToModelOverwriteSingleSamplingSets(const size_t cSamplingSets, SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSmallChangeToModelOverwriteSingleSamplingSet);
+   static SegmentedTensor<ActiveDataType, FractionalDataType> ** AllocateSmallChangeToModelOverwriteSingleSamplingSets(const size_t cSamplingSets, const size_t cVectorLength);
+   bool Initialize(const bool bUseThreadPool);
+
+   // returns nullptr on error
+   static EbmTrainingWorkspace * Allocate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cSamplingSets, const bool bUseThreadPool);
+};
+
+#endif // EBM_TRAINING_WORKSPACE_H
@@ -8,7 +8,8 @@
 #include <type_traits> // std::is_standard_layout
 #include <string.h> // memset
 #include <stddef.h> // size_t, ptrdiff_t
-#include <cmath> // abs
+#include <cmath> // abs, std::floor
+#include <limits> // numeric_limits
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // EBM_INLINE
@@ -19,7 +20,10 @@
 #include "FeatureCombinationCore.h"
 #include "DataSetByFeatureCombination.h"
 #include "DataSetByFeature.h"
+#include "SparseColumn.h"
 #include "SamplingWithReplacement.h"
+#include "SamplingWithoutReplacement.h"
+#include "ThreadPool.h"
 
 // we don't need to handle multi-dimensional inputs with more than 64 bits total
 // the rational is that we need to bin this data, and our binning memory will be N1*N1*...*N(D-1)*N(D)
@@ -36,13 +40,18 @@
 template<bool bClassification>
 struct HistogramBucket;
 
+// CachedThreadResources.h includes us indirectly through TreeNode.h, so we can't rely on having the full definition here
 template<bool bClassification>
-EBM_INLINE bool GetHistogramBucketSizeOverflow(const size_t cVectorLength) {
-   return IsMultiplyError(sizeof(HistogramBucketVectorEntry<bClassification>), cVectorLength) ? true : IsAddError(sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>), sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength) ? true : false;
+class CachedTrainingThreadResources;
+
+// if bWeighted, each bucket has room for the sum of its instance weights after its vector entries (see HistogramBucket::GetWeightPointer)
+template<bool bClassification>
+EBM_INLINE bool GetHistogramBucketSizeOverflow(const size_t cVectorLength, const bool bWeighted) {
+   return IsMultiplyError(sizeof(HistogramBucketVectorEntry<bClassification>), cVectorLength) ? true : IsAddError(sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>), sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength) ? true : IsAddError(sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>) + sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength, bWeighted ? sizeof(FractionalDataType) : size_t { 0 }) ? true : false;
 }
 template<bool bClassification>
-EBM_INLINE size_t GetHistogramBucketSize(const size_t cVectorLength) {
-   return sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>) + sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength;
+EBM_INLINE size_t GetHistogramBucketSize(const size_t cVectorLength, const bool bWeighted) {
+   return sizeof(HistogramBucket<bClassification>) - sizeof(HistogramBucketVectorEntry<bClassification>) + sizeof(HistogramBucketVectorEntry<bClassification>) * cVectorLength + (bWeighted ? sizeof(FractionalDataType) : size_t { 0 });
 }
 template<bool bClassification>
 EBM_INLINE HistogramBucket<bClassification> * GetHistogramBucketByIndex(const size_t cBytesPerHistogramBucket, HistogramBucket<bClassification> * const aHistogramBuckets, const size_t iBin) {
@@ -75,36 +84,67 @@ public:
    // aHistogramBucketVectorEntry must be the last item in this struct
    HistogramBucketVectorEntry<bClassification> m_aHistogramBucketVectorEntry[1];
 
-   EBM_INLINE void Add(const HistogramBucket<bClassification> & other, const size_t cVectorLength) {
+   // the sum of the instance weights in this bucket is what we divide by when scoring splits and computing updates.  We keep the integer count too
+   // since it's what decides if a bucket is empty and if a node has enough instances to split.  Weighted buckets keep their weight in one more
+   // FractionalDataType just past their last vector entry.  Unweighted buckets don't have room for it, since a bigger bucket costs us cache misses on
+   // every instance that we bin, and their weight is their count, which also keeps unweighted models identical to when we divided by the count
+   EBM_INLINE FractionalDataType * GetWeightPointer(const size_t cVectorLength) {
+      return reinterpret_cast<FractionalDataType *>(&ARRAY_TO_POINTER(m_aHistogramBucketVectorEntry)[cVectorLength]);
+   }
+   EBM_INLINE const FractionalDataType * GetWeightPointer(const size_t cVectorLength) const {
+      return reinterpret_cast<const FractionalDataType *>(&ARRAY_TO_POINTER_CONST(m_aHistogramBucketVectorEntry)[cVectorLength]);
+   }
+   EBM_INLINE FractionalDataType GetWeight(const size_t cVectorLength, const bool bWeighted) const {
+      return bWeighted ? *GetWeightPointer(cVectorLength) : static_cast<FractionalDataType>(m_cInstancesInBucket);
+   }
+
+   EBM_INLINE void Add(const HistogramBucket<bClassification> & other, const size_t cVectorLength, const bool bWeighted) {
       m_cInstancesInBucket += other.m_cInstancesInBucket;
+      if(bWeighted) {
+         *GetWeightPointer(cVectorLength) += *other.GetWeightPointer(cVectorLength);
+      }
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
          ARRAY_TO_POINTER(m_aHistogramBucketVectorEntry)[iVector].Add(ARRAY_TO_POINTER_CONST(other.m_aHistogramBucketVectorEntry)[iVector]);
       }
    }
 
-   EBM_INLINE void Subtract(const HistogramBucket<bClassification> & other, const size_t cVectorLength) {
+   EBM_INLINE void Subtract(const HistogramBucket<bClassification> & other, const size_t cVectorLength, const bool bWeighted) {
       m_cInstancesInBucket -= other.m_cInstancesInBucket;
+      if(bWeighted) {
+         *GetWeightPointer(cVectorLength) -= *other.GetWeightPointer(cVectorLength);
+      }
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
          ARRAY_TO_POINTER(m_aHistogramBucketVectorEntry)[iVector].Subtract(ARRAY_TO_POINTER_CONST(other.m_aHistogramBucketVectorEntry)[iVector]);
       }
    }
 
-   EBM_INLINE void Copy(const HistogramBucket<bClassification> & other, const size_t cVectorLength) {
-      EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength)); // we're accessing allocated memory
-      const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(cVectorLength);
-      memcpy(this, &other, cBytesPerHistogramBucket);
+   EBM_INLINE void Copy(const HistogramBucket<bClassification> & other, const size_t cVectorLength, const bool bWeighted) {
+      EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength, bWeighted)); // we're accessing allocated memory
+      // we branch on bWeighted so that each memcpy has a size that is a compile time constant whenever cVectorLength is, which lets the compiler
+      // inline the copy instead of calling memcpy for every bucket in our tensor loops
+      if(bWeighted) {
+         memcpy(this, &other, GetHistogramBucketSize<bClassification>(cVectorLength, true));
+      } else {
+         memcpy(this, &other, GetHistogramBucketSize<bClassification>(cVectorLength, false));
+      }
    }
 
-   EBM_INLINE void Zero(const size_t cVectorLength) {
-      EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength)); // we're accessing allocated memory
-      const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(cVectorLength);
-      memset(this, 0, cBytesPerHistogramBucket);
+   EBM_INLINE void Zero(const size_t cVectorLength, const bool bWeighted) {
+      EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength, bWeighted)); // we're accessing allocated memory
+      // same as Copy, we keep the size of each memset a compile time constant whenever cVectorLength is
+      if(bWeighted) {
+         memset(this, 0, GetHistogramBucketSize<bClassification>(cVectorLength, true));
+      } else {
+         memset(this, 0, GetHistogramBucketSize<bClassification>(cVectorLength, false));
+      }
    }
 
-   EBM_INLINE void AssertZero(const size_t cVectorLength) const {
+   EBM_INLINE void AssertZero(const size_t cVectorLength, const bool bWeighted) const {
       UNUSED(cVectorLength);
+      UNUSED(bWeighted);
 #ifndef NDEBUG
       EBM_ASSERT(0 == m_cInstancesInBucket);
+      EBM_ASSERT(!bWeighted || 0 == *GetWeightPointer(cVectorLength));
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
          ARRAY_TO_POINTER_CONST(m_aHistogramBucketVectorEntry)[iVector].AssertZero();
       }
@@ -114,19 +154,158 @@ public:
 
 static_assert(std::is_standard_layout<HistogramBucket<false>>::value && std::is_standard_layout<HistogramBucket<true>>::value, "HistogramBucket will be more efficient as a standard layout class as we make potentially large arrays of them!");
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
-   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensions");
+// BuildModelFeatureCombinationHistograms exports our histograms as plain FractionalDataType values so that processes that train on different instances
+// can sum them elementwise (an allreduce) without knowing our bucket layout.  Each bucket becomes its instance count, then its weight if bWeighted, then
+// the sum of the residuals of each vector entry, each followed by its sum of denominators for classification.  We export at most one value per
+// FractionalDataType in the bucket, so this can't overflow if GetHistogramBucketSizeOverflow didn't
+template<bool bClassification>
+EBM_INLINE size_t GetHistogramBucketExportLength(const size_t cVectorLength, const bool bWeighted) {
+   return size_t { 1 } + (bWeighted ? size_t { 1 } : size_t { 0 }) + (bClassification ? size_t { 2 } : size_t { 1 }) * cVectorLength;
+}
+
+template<bool bClassification>
+void ExportHistogramBuckets(const size_t cVectorLength, const bool bWeighted, const size_t cHistogramBuckets, const HistogramBucket<bClassification> * const aHistogramBuckets, FractionalDataType * pValue) {
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(cVectorLength, bWeighted);
+   for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+      const HistogramBucket<bClassification> * const pHistogramBucket = GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+      *pValue = static_cast<FractionalDataType>(pHistogramBucket->m_cInstancesInBucket);
+      ++pValue;
+      if(bWeighted) {
+         *pValue = *pHistogramBucket->GetWeightPointer(cVectorLength);
+         ++pValue;
+      }
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         const HistogramBucketVectorEntry<bClassification> * const pHistogramBucketVectorEntry = &ARRAY_TO_POINTER_CONST(pHistogramBucket->m_aHistogramBucketVectorEntry)[iVector];
+         *pValue = pHistogramBucketVectorEntry->m_sumResidualError;
+         ++pValue;
+         if(bClassification) {
+            *pValue = pHistogramBucketVectorEntry->GetSumDenominator();
+            ++pValue;
+         }
+      }
+   }
+}
+
+// the reverse of ExportHistogramBuckets.  Our tree growing trusts the instance counts in the buckets, so we return true if any count isn't a whole
+// number that fits into a size_t, which means the values weren't a sum of our exported histograms
+template<bool bClassification>
+bool ImportHistogramBuckets(const size_t cVectorLength, const bool bWeighted, const size_t cHistogramBuckets, const FractionalDataType * pValue, HistogramBucket<bClassification> * const aHistogramBuckets) {
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(cVectorLength, bWeighted);
+   // the largest double below 2^64 converts to a size_t, and 2^64 itself doesn't
+   constexpr FractionalDataType instancesLimit = static_cast<FractionalDataType>(std::numeric_limits<size_t>::max() / 2 + 1) * FractionalDataType { 2 };
+   for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+      HistogramBucket<bClassification> * const pHistogramBucket = GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+      const FractionalDataType cInstances = *pValue;
+      ++pValue;
+      // NaN fails the first comparison
+      if(UNLIKELY(!(FractionalDataType { 0 } <= cInstances && cInstances < instancesLimit && std::floor(cInstances) == cInstances))) {
+         LOG_0(TraceLevelError, "ERROR ImportHistogramBuckets a histogram instance count is not a whole number that fits into a size_t");
+         return true;
+      }
+      pHistogramBucket->m_cInstancesInBucket = static_cast<size_t>(cInstances);
+      pHistogramBucket->m_bucketValue = 0;
+      if(bWeighted) {
+         *pHistogramBucket->GetWeightPointer(cVectorLength) = *pValue;
+         ++pValue;
+      }
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         HistogramBucketVectorEntry<bClassification> * const pHistogramBucketVectorEntry = &ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry)[iVector];
+         pHistogramBucketVectorEntry->m_sumResidualError = *pValue;
+         ++pValue;
+         if(bClassification) {
+            pHistogramBucketVectorEntry->SetSumDenominator(*pValue);
+            ++pValue;
+         }
+      }
+   }
+   return false;
+}
+
+// adds an instance that occurs cOccurrences times to a bucket.  weightedOccurrences is cOccurrences as a FractionalDataType, or the sum of the weights of
+// those occurrences if bWeighted
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+EBM_INLINE void AddInstanceToHistogramBucketOccurrences(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const size_t cOccurrences, const FractionalDataType weightedOccurrences, const FractionalDataType * const aResidualError, const size_t cVectorLength) {
+   pHistogramBucketEntry->m_cInstancesInBucket += cOccurrences;
+   if(bWeighted) {
+      *pHistogramBucketEntry->GetWeightPointer(cVectorLength) += weightedOccurrences;
+   }
+   HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketVectorEntry = ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry);
+   size_t iVector = 0;
+   do {
+      const FractionalDataType residualError = aResidualError[iVector];
+      pHistogramBucketVectorEntry[iVector].m_sumResidualError += weightedOccurrences * residualError;
+      if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
+         const FractionalDataType denominator = EbmStatistics::ComputeNewtonRaphsonStep(residualError);
+         pHistogramBucketVectorEntry[iVector].SetSumDenominator(pHistogramBucketVectorEntry[iVector].GetSumDenominator() + weightedOccurrences * denominator);
+      }
+      ++iVector;
+      // if we use this specific format where (iVector < cVectorLength) then the compiler collapses alway the loop for small cVectorLength values
+   } while(iVector < cVectorLength);
+}
+
+// SamplingWithoutReplacement selects each instance 0 or 1 times.  We add every instance scaled by its selection bit rather than branch on the bit, since
+// the bits are unpredictable and a mispredicted branch per instance costs more than the multiplications.  If bWeighted, pWeight points to the instance's weight
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+EBM_INLINE void AddInstanceToHistogramBucketSelected(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const size_t cSelected, const FractionalDataType * const pWeight, const FractionalDataType * const aResidualError, const size_t cVectorLength) {
+   EBM_ASSERT(cSelected <= 1);
+   FractionalDataType selected = static_cast<FractionalDataType>(cSelected);
+   if(bWeighted) {
+      selected *= *pWeight;
+   } else {
+      UNUSED(pWeight);
+   }
+   AddInstanceToHistogramBucketOccurrences<compilerLearningTypeOrCountTargetClasses, bWeighted>(pHistogramBucketEntry, cSelected, selected, aResidualError, cVectorLength);
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+void BinDataSetTrainingZeroDimensionsWithoutReplacement(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingWithoutReplacement * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensionsWithoutReplacement");
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+
+   size_t cInstancesRemaining = pTrainingSet->m_pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstancesRemaining);
+
+   const BitMaskWordType * pBitMask = pTrainingSet->m_aBitMask;
+   const FractionalDataType * pWeight = pTrainingSet->m_pOriginDataSet->GetWeights();
+   EBM_ASSERT(bWeighted == (nullptr != pWeight));
+   const FractionalDataType * pResidualError = pTrainingSet->m_pOriginDataSet->GetResidualPointer();
+   do {
+      // process a whole mask word at a time by shifting the selection bits out of a register
+      BitMaskWordType bitMask = *pBitMask;
+      ++pBitMask;
+      size_t cInstancesInWord = cInstancesRemaining < k_cBitsPerBitMaskWord ? cInstancesRemaining : k_cBitsPerBitMaskWord;
+      cInstancesRemaining -= cInstancesInWord;
+      do {
+         AddInstanceToHistogramBucketSelected<compilerLearningTypeOrCountTargetClasses, bWeighted>(pHistogramBucketEntry, static_cast<size_t>(bitMask & BitMaskWordType { 1 }), pWeight, pResidualError, cVectorLength);
+         bitMask >>= 1;
+         if(bWeighted) {
+            ++pWeight;
+         }
+         pResidualError += cVectorLength;
+         --cInstancesInWord;
+      } while(0 != cInstancesInWord);
+   } while(0 != cInstancesRemaining);
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensionsWithoutReplacement");
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+void BinDataSetTrainingZeroDimensionsWithReplacement(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingWithReplacement * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensionsWithReplacement");
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
 
    const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
 
-   const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
-   const size_t * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences;
-   const FractionalDataType * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer();
+   const size_t * pCountOccurrences = pTrainingSet->m_aCountOccurrences;
+   const FractionalDataType * pWeightedCountOccurrences = pTrainingSet->m_aWeightedCountOccurrences;
+   EBM_ASSERT(bWeighted == (nullptr != pWeightedCountOccurrences));
+   const FractionalDataType * pResidualError = pTrainingSet->m_pOriginDataSet->GetResidualPointer();
    // this shouldn't overflow since we're accessing existing memory
    const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectorLength * cInstances;
 
@@ -137,12 +316,18 @@ void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerL
       // this loop gets about 10 times slower if you use a proper pseudo random number generator like std::default_random_engine
       // taking all the above together, it seems unlikley we'll use a method of separating sets via single pass randomized set splitting.  Even if count is stored in memory if shouldn't increase the time spent fetching it by 2 times, unless our bottleneck when threading is overwhelmingly memory pressure related, and even then we could store the count for a single bit aleviating the memory pressure greatly, if we use the right sampling method 
 
-      // TODO : try using a sampling method with non-repeating instances, and put the count into a bit.  Then unwind that loop either at the byte level (8 times) or the uint64_t level.  This can be done without branching and doesn't require random number generators
-
       const size_t cOccurences = *pCountOccurrences;
       ++pCountOccurrences;
       pHistogramBucketEntry->m_cInstancesInBucket += cOccurences;
-      const FractionalDataType cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
+      // with instance weights, this is the sum of the weights of this instance's occurrences
+      FractionalDataType cFloatOccurences;
+      if(bWeighted) {
+         cFloatOccurences = *pWeightedCountOccurrences;
+         ++pWeightedCountOccurrences;
+         *pHistogramBucketEntry->GetWeightPointer(cVectorLength) += cFloatOccurences;
+      } else {
+         cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
+      }
 
 #ifndef NDEBUG
 #ifdef EXPAND_BINARY_LOGITS
@@ -174,17 +359,198 @@ void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerL
 
       EBM_ASSERT(!IsClassification(compilerLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } == runtimeLearningTypeOrCountTargetClasses && !bExpandBinaryLogits || 0 <= k_iZeroResidual || std::isnan(residualTotalDebug) || -0.00000000001 < residualTotalDebug && residualTotalDebug < 0.00000000001);
    } while(pResidualErrorEnd != pResidualError);
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensionsWithReplacement");
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+void BinDataSetTrainingZeroDimensions(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingZeroDimensions");
+
+   // we choose between the weighted and unweighted loops once here so that the unweighted loops don't carry any per instance weight work
+   if(SamplingMethodType::WithoutReplacement == pTrainingSet->m_samplingMethodType) {
+      const SamplingWithoutReplacement * const pSamplingWithoutReplacement = static_cast<const SamplingWithoutReplacement *>(pTrainingSet);
+      if(nullptr == pTrainingSet->m_pOriginDataSet->GetWeights()) {
+         BinDataSetTrainingZeroDimensionsWithoutReplacement<compilerLearningTypeOrCountTargetClasses, false>(pHistogramBucketEntry, pSamplingWithoutReplacement, runtimeLearningTypeOrCountTargetClasses);
+      } else {
+         BinDataSetTrainingZeroDimensionsWithoutReplacement<compilerLearningTypeOrCountTargetClasses, true>(pHistogramBucketEntry, pSamplingWithoutReplacement, runtimeLearningTypeOrCountTargetClasses);
+      }
+   } else {
+      EBM_ASSERT(SamplingMethodType::WithReplacement == pTrainingSet->m_samplingMethodType);
+      const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
+      if(nullptr == pSamplingWithReplacement->m_aWeightedCountOccurrences) {
+         BinDataSetTrainingZeroDimensionsWithReplacement<compilerLearningTypeOrCountTargetClasses, false>(pHistogramBucketEntry, pSamplingWithReplacement, runtimeLearningTypeOrCountTargetClasses);
+      } else {
+         BinDataSetTrainingZeroDimensionsWithReplacement<compilerLearningTypeOrCountTargetClasses, true>(pHistogramBucketEntry, pSamplingWithReplacement, runtimeLearningTypeOrCountTargetClasses);
+      }
+   }
    LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingZeroDimensions");
 }
 
+// returns how many times the sampling set selected iInstance, and sets *pWeightedOccurrences to that count multiplied by the instance's weight
+EBM_INLINE size_t GetInstanceOccurrences(const SamplingMethod * const pTrainingSet, const size_t iInstance, FractionalDataType * const pWeightedOccurrences) {
+   if(SamplingMethodType::WithoutReplacement == pTrainingSet->m_samplingMethodType) {
+      const size_t cSelected = SamplingWithoutReplacement::GetSelectedBit(static_cast<const SamplingWithoutReplacement *>(pTrainingSet)->m_aBitMask, iInstance);
+      const FractionalDataType * const aWeights = pTrainingSet->m_pOriginDataSet->GetWeights();
+      *pWeightedOccurrences = nullptr == aWeights ? static_cast<FractionalDataType>(cSelected) : static_cast<FractionalDataType>(cSelected) * aWeights[iInstance];
+      return cSelected;
+   } else {
+      EBM_ASSERT(SamplingMethodType::WithReplacement == pTrainingSet->m_samplingMethodType);
+      const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
+      const size_t cOccurrences = pSamplingWithReplacement->m_aCountOccurrences[iInstance];
+      *pWeightedOccurrences = nullptr == pSamplingWithReplacement->m_aWeightedCountOccurrences ? static_cast<FractionalDataType>(cOccurrences) : pSamplingWithReplacement->m_aWeightedCountOccurrences[iInstance];
+      return cOccurrences;
+   }
+}
+
+// the sparse versions of binning below are only used for regression, where DataSetByFeatureCombination::BuildSparseColumns is called.  They're
+// templated on bClassification only so that the classification instantiations of our callers compile
+
+// with sparse columns the intercept's histogram is just the sampling set's totals
+template<bool bClassification>
+EBM_INLINE void BinDataSetTrainingZeroDimensionsFromTotals(HistogramBucket<bClassification> * const pHistogramBucketEntry, const SamplingMethod * const pTrainingSet, const bool bWeighted) {
+   EBM_ASSERT(!bClassification);
+   EBM_ASSERT(pTrainingSet->m_pOriginDataSet->HasSparseColumns());
+   pHistogramBucketEntry->m_cInstancesInBucket = pTrainingSet->m_cOccurrencesTotal;
+   if(bWeighted) {
+      *pHistogramBucketEntry->GetWeightPointer(1) = pTrainingSet->m_weightTotal;
+   }
+   ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry)[0].m_sumResidualError = pTrainingSet->m_sumResidualErrorTotal;
+}
+
+// the dense binning loops sum the stored residuals, which are offset from the true residuals by our origin dataset's residual shift.  The offset is the
+// same for every instance, so we correct each bucket once instead of each instance
+template<bool bClassification>
+void RemoveResidualShiftFromHistogram(HistogramBucket<bClassification> * const aHistogramBuckets, const size_t cHistogramBuckets, const SamplingMethod * const pTrainingSet, const bool bWeighted) {
+   EBM_ASSERT(!bClassification);
+   EBM_ASSERT(pTrainingSet->m_pOriginDataSet->HasSparseColumns());
+   const FractionalDataType residualShift = pTrainingSet->m_pOriginDataSet->GetResidualShift();
+   if(0 != residualShift) {
+      const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(1, bWeighted);
+      for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+         HistogramBucket<bClassification> * const pHistogramBucket = GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+         ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry)[0].m_sumResidualError -= residualShift * pHistogramBucket->GetWeight(1, bWeighted);
+      }
+   }
+}
+
+// the SparseColumn version of BinDataSetTraining.  We bin the exceptions and then take the dominant bin's bucket as the sampling set's totals minus
+// everything else, so we visit pSparseColumn->m_cExceptions instances instead of all of them
+template<bool bClassification, bool bWeighted>
+void BinDataSetTrainingSparse(HistogramBucket<bClassification> * const aHistogramBuckets, const SparseColumn * const pSparseColumn, const SamplingMethod * const pTrainingSet) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingSparse");
+
+   EBM_ASSERT(!bClassification);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<bClassification>(1, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(1, bWeighted);
+
+   const FractionalDataType * const aResidualErrors = pTrainingSet->m_pOriginDataSet->GetResidualPointer();
+   const FractionalDataType residualShift = pTrainingSet->m_pOriginDataSet->GetResidualShift();
+
+   size_t cOccurrencesExceptions = 0;
+   FractionalDataType weightExceptions = 0;
+   FractionalDataType sumResidualErrorExceptions = 0;
+   const SparseException * pException = pSparseColumn->m_aExceptions;
+   const SparseException * const pExceptionEnd = pException + pSparseColumn->m_cExceptions;
+   for(; pExceptionEnd != pException; ++pException) {
+      const size_t iInstance = pException->m_iInstance;
+      FractionalDataType weightedOccurrences;
+      const size_t cOccurrences = GetInstanceOccurrences(pTrainingSet, iInstance, &weightedOccurrences);
+      HistogramBucket<bClassification> * const pHistogramBucket = GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, aHistogramBuckets, pException->m_iBin);
+      pHistogramBucket->m_cInstancesInBucket += cOccurrences;
+      if(bWeighted) {
+         *pHistogramBucket->GetWeightPointer(1) += weightedOccurrences;
+      }
+      const FractionalDataType sumResidualError = weightedOccurrences * (aResidualErrors[iInstance] - residualShift);
+      ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry)[0].m_sumResidualError += sumResidualError;
+      cOccurrencesExceptions += cOccurrences;
+      weightExceptions += weightedOccurrences;
+      sumResidualErrorExceptions += sumResidualError;
+   }
+
+   HistogramBucket<bClassification> * const pHistogramBucketDominant = GetHistogramBucketByIndex<bClassification>(cBytesPerHistogramBucket, aHistogramBuckets, pSparseColumn->m_iDominantBin);
+   EBM_ASSERT(0 == pHistogramBucketDominant->m_cInstancesInBucket);
+   EBM_ASSERT(cOccurrencesExceptions <= pTrainingSet->m_cOccurrencesTotal);
+   const size_t cOccurrencesDominant = pTrainingSet->m_cOccurrencesTotal - cOccurrencesExceptions;
+   pHistogramBucketDominant->m_cInstancesInBucket = cOccurrencesDominant;
+   // if the sampling set didn't select anything in the dominant bin, we leave the bucket zeroed instead of holding the rounding error of a subtraction
+   if(0 != cOccurrencesDominant) {
+      if(bWeighted) {
+         *pHistogramBucketDominant->GetWeightPointer(1) = pTrainingSet->m_weightTotal - weightExceptions;
+      }
+      ARRAY_TO_POINTER(pHistogramBucketDominant->m_aHistogramBucketVectorEntry)[0].m_sumResidualError = pTrainingSet->m_sumResidualErrorTotal - sumResidualErrorExceptions;
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingSparse");
+}
+
+// the SamplingWithoutReplacement version of BinDataSetTraining.  iInstanceStart needs to be on a bit pack data unit boundary, but not on a mask word boundary
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+EBM_INLINE void BinDataSetTrainingWithoutReplacement(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingWithoutReplacement * const pTrainingSet, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingWithoutReplacement");
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   const size_t cItemsPerBitPackDataUnit = pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cBitsForStorageType);
+   const size_t cBitsPerItemMax = GetCountBits(cItemsPerBitPackDataUnit);
+   EBM_ASSERT(1 <= cBitsPerItemMax);
+   EBM_ASSERT(cBitsPerItemMax <= k_cBitsForStorageType);
+   const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnit);
+   EBM_ASSERT(iInstanceStart + cInstances <= pTrainingSet->m_pOriginDataSet->GetCountInstances());
+
+   const BitMaskWordType * const aBitMask = pTrainingSet->m_aBitMask;
+   // none of these can overflow since we're pointing into existing memory
+   const StorageDataTypeCore * pInputData = pTrainingSet->m_pOriginDataSet->GetInputDataPointer(pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnit;
+   const FractionalDataType * pResidualError = pTrainingSet->m_pOriginDataSet->GetResidualPointer() + iInstanceStart * cVectorLength;
+   const FractionalDataType * const aWeights = pTrainingSet->m_pOriginDataSet->GetWeights();
+   EBM_ASSERT(bWeighted == (nullptr != aWeights));
+
+   size_t iInstance = iInstanceStart;
+   const size_t iInstanceEnd = iInstanceStart + cInstances;
+   do {
+      // we store the already multiplied dimensional value in *pInputData
+      size_t iTensorBinCombined = static_cast<size_t>(*pInputData);
+      ++pInputData;
+      const size_t cInstancesLeft = iInstanceEnd - iInstance;
+      size_t cItemsRemaining = cInstancesLeft < cItemsPerBitPackDataUnit ? cInstancesLeft : cItemsPerBitPackDataUnit;
+      do {
+         const size_t iTensorBin = maskBits & iTensorBinCombined;
+
+         HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry = GetHistogramBucketByIndex(cBytesPerHistogramBucket, aHistogramBuckets, iTensorBin);
+         ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntry, aHistogramBucketsEndDebug);
+
+         // bit pack data units don't line up with mask words, so we index the bit directly.  Consecutive instances read the same mask word, so this stays in L1
+         AddInstanceToHistogramBucketSelected<compilerLearningTypeOrCountTargetClasses, bWeighted>(pHistogramBucketEntry, SamplingWithoutReplacement::GetSelectedBit(aBitMask, iInstance), bWeighted ? &aWeights[iInstance] : nullptr, pResidualError, cVectorLength);
+         pResidualError += cVectorLength;
+         ++iInstance;
+
+         iTensorBinCombined >>= cBitsPerItemMax;
+         --cItemsRemaining;
+      } while(0 != cItemsRemaining);
+   } while(iInstanceEnd != iInstance);
+
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingWithoutReplacement");
+}
+
+// the SamplingWithReplacement version of BinDataSetTraining.  If bWeighted, we scale each instance by its weighted occurrence count instead of its occurrence count
 // TODO : remove cCompilerDimensions since we don't need it anymore, and replace it with a more useful number like the number of cItemsPerBitPackDataUnit
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
-void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+// iInstanceStart needs to be on a bit pack data unit boundary.  cInstances can end anywhere, but only the last chunk should end on a partial bit pack data unit
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions, bool bWeighted>
+EBM_INLINE void BinDataSetTrainingWithReplacement(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingWithReplacement * const pTrainingSet, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
 ) {
-   LOG_0(TraceLevelVerbose, "Entered BinDataSetTraining");
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetTrainingWithReplacement");
 
    EBM_ASSERT(cCompilerDimensions == pFeatureCombination->m_cFeatures);
    static_assert(1 <= cCompilerDimensions, "cCompilerDimensions must be 1 or greater");
@@ -197,16 +563,19 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
    EBM_ASSERT(1 <= cBitsPerItemMax);
    EBM_ASSERT(cBitsPerItemMax <= k_cBitsForStorageType);
    const size_t maskBits = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMax);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
 
-   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnit);
+   EBM_ASSERT(iInstanceStart + cInstances <= pTrainingSet->m_pOriginDataSet->GetCountInstances());
 
-   const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
-   const size_t * pCountOccurrences = pSamplingWithReplacement->m_aCountOccurrences;
-   const StorageDataTypeCore * pInputData = pSamplingWithReplacement->m_pOriginDataSet->GetInputDataPointer(pFeatureCombination);
-   const FractionalDataType * pResidualError = pSamplingWithReplacement->m_pOriginDataSet->GetResidualPointer();
+   // none of these can overflow since we're pointing into existing memory
+   const size_t * pCountOccurrences = pTrainingSet->m_aCountOccurrences + iInstanceStart;
+   const FractionalDataType * pWeightedCountOccurrences = bWeighted ? pTrainingSet->m_aWeightedCountOccurrences + iInstanceStart : nullptr;
+   EBM_ASSERT(bWeighted == (nullptr != pTrainingSet->m_aWeightedCountOccurrences));
+   const StorageDataTypeCore * pInputData = pTrainingSet->m_pOriginDataSet->GetInputDataPointer(pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnit;
+   const FractionalDataType * pResidualError = pTrainingSet->m_pOriginDataSet->GetResidualPointer() + iInstanceStart * cVectorLength;
 
    // this shouldn't overflow since we're accessing existing memory
    const FractionalDataType * const pResidualErrorTrueEnd = pResidualError + cVectorLength * cInstances;
@@ -225,8 +594,6 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
       // this loop gets about 10 times slower if you use a proper pseudo random number generator like std::default_random_engine
       // taking all the above together, it seems unlikley we'll use a method of separating sets via single pass randomized set splitting.  Even if count is stored in memory if shouldn't increase the time spent fetching it by 2 times, unless our bottleneck when threading is overwhelmingly memory pressure related, and even then we could store the count for a single bit aleviating the memory pressure greatly, if we use the right sampling method 
 
-      // TODO : try using a sampling method with non-repeating instances, and put the count into a bit.  Then unwind that loop either at the byte level (8 times) or the uint64_t level.  This can be done without branching and doesn't require random number generators
-
       cItemsRemaining = cItemsPerBitPackDataUnit;
       // TODO : jumping back into this loop and changing cItemsRemaining to a dynamic value that isn't compile time determinable
       // causes this function to NOT be optimized as much as it could if we had two separate loops.  We're just trying this out for now though
@@ -243,7 +610,15 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
          const size_t cOccurences = *pCountOccurrences;
          ++pCountOccurrences;
          pHistogramBucketEntry->m_cInstancesInBucket += cOccurences;
-         const FractionalDataType cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
+         // with instance weights, this is the sum of the weights of this instance's occurrences
+         FractionalDataType cFloatOccurences;
+         if(bWeighted) {
+            cFloatOccurences = *pWeightedCountOccurrences;
+            ++pWeightedCountOccurrences;
+            *pHistogramBucketEntry->GetWeightPointer(cVectorLength) += cFloatOccurences;
+         } else {
+            cFloatOccurences = static_cast<FractionalDataType>(cOccurences);
+         }
          HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketVectorEntry = ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry);
          size_t iVector = 0;
 
@@ -284,7 +659,7 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
 
    // first time through?
    if(pResidualErrorTrueEnd != pResidualError) {
-      LOG_0(TraceLevelVerbose, "Handling last BinDataSetTraining loop");
+      LOG_0(TraceLevelVerbose, "Handling last BinDataSetTrainingWithReplacement loop");
 
       EBM_ASSERT(0 == (pResidualErrorTrueEnd - pResidualError) % cVectorLength);
       cItemsRemaining = (pResidualErrorTrueEnd - pResidualError) / cVectorLength;
@@ -296,14 +671,203 @@ void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrC
       goto one_last_loop;
    }
 
-   LOG_0(TraceLevelVerbose, "Exited BinDataSetTraining");
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetTrainingWithReplacement");
+}
+
+// we choose between the weighted and unweighted loops once per call here so that the unweighted loops don't carry any per instance weight work
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+void BinDataSetTraining(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const size_t iInstanceStart, const size_t cInstances, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(SamplingMethodType::WithoutReplacement == pTrainingSet->m_samplingMethodType) {
+      const SamplingWithoutReplacement * const pSamplingWithoutReplacement = static_cast<const SamplingWithoutReplacement *>(pTrainingSet);
+      if(nullptr == pTrainingSet->m_pOriginDataSet->GetWeights()) {
+         BinDataSetTrainingWithoutReplacement<compilerLearningTypeOrCountTargetClasses, false>(aHistogramBuckets, pFeatureCombination, pSamplingWithoutReplacement, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+            , aHistogramBucketsEndDebug
+#endif // NDEBUG
+         );
+      } else {
+         BinDataSetTrainingWithoutReplacement<compilerLearningTypeOrCountTargetClasses, true>(aHistogramBuckets, pFeatureCombination, pSamplingWithoutReplacement, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+            , aHistogramBucketsEndDebug
+#endif // NDEBUG
+         );
+      }
+   } else {
+      EBM_ASSERT(SamplingMethodType::WithReplacement == pTrainingSet->m_samplingMethodType);
+      const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pTrainingSet);
+      if(nullptr == pSamplingWithReplacement->m_aWeightedCountOccurrences) {
+         BinDataSetTrainingWithReplacement<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions, false>(aHistogramBuckets, pFeatureCombination, pSamplingWithReplacement, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+            , aHistogramBucketsEndDebug
+#endif // NDEBUG
+         );
+      } else {
+         BinDataSetTrainingWithReplacement<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions, true>(aHistogramBuckets, pFeatureCombination, pSamplingWithReplacement, iInstanceStart, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+            , aHistogramBucketsEndDebug
+#endif // NDEBUG
+         );
+      }
+   }
+}
+
+// we bin large data sets in chunks of whole bit pack data units with each chunk going into its own histogram, and then we add the chunk histograms
+// together in order.  The chunking depends only on the data and never on the number of threads, so we get identical floating point sums whether we
+// run the chunks on a ThreadPool or on a single thread
+constexpr size_t k_cInstancesPerBinningChunkMin = size_t { 1 } << 16;
+constexpr size_t k_cBinningChunksMax = 64;
+// limit the memory used for the extra chunk histograms, which matters for pairs and higher dimensional tensors with many bins
+constexpr size_t k_cBytesBinningChunksMax = size_t { 1 } << 26;
+
+// returns how many chunks BinDataSetTrainingChunks splits cInstances into for a feature combination whose histogram is cBytesHistogramBuckets bytes, and
+// sets *pcInstancesPerChunk if there is more than one.  The fused apply and bin pass of TrainingRounds uses the same chunks so that its histograms come out
+// identical to the ones that we would have binned
+EBM_INLINE size_t GetCountBinningChunks(const size_t cInstances, const size_t cItemsPerBitPackDataUnit, const size_t cBytesHistogramBuckets, size_t * const pcInstancesPerChunk) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+   EBM_ASSERT(0 < cBytesHistogramBuckets);
+
+   size_t cChunks = cInstances / k_cInstancesPerBinningChunkMin;
+   cChunks = k_cBinningChunksMax < cChunks ? k_cBinningChunksMax : cChunks;
+   const size_t cChunksMemoryMax = k_cBytesBinningChunksMax / cBytesHistogramBuckets + 1;
+   cChunks = cChunksMemoryMax < cChunks ? cChunksMemoryMax : cChunks;
+   if(cChunks <= 1) {
+      *pcInstancesPerChunk = cInstances;
+      return 1;
+   }
+
+   // round each chunk up to a whole number of bit pack data units, which can leave us with fewer chunks than we asked for
+   const size_t cBitPackDataUnits = (cInstances - 1) / cItemsPerBitPackDataUnit + 1;
+   const size_t cBitPackDataUnitsPerChunk = (cBitPackDataUnits - 1) / cChunks + 1;
+   EBM_ASSERT(!IsMultiplyError(cBitPackDataUnitsPerChunk, cItemsPerBitPackDataUnit)); // this is less than cInstances rounded up to a bit pack data unit
+   const size_t cInstancesPerChunk = cBitPackDataUnitsPerChunk * cItemsPerBitPackDataUnit;
+   cChunks = (cInstances - 1) / cInstancesPerChunk + 1;
+   EBM_ASSERT(2 <= cChunks);
+   *pcInstancesPerChunk = cInstancesPerChunk;
+   return cChunks;
+}
+
+template<bool bClassification>
+struct BinDataSetTrainingChunksContext final {
+   // the first chunk bins directly into our caller's histogram, and the rest bin into the chunk histograms
+   HistogramBucket<bClassification> * m_aHistogramBuckets;
+   unsigned char * m_aChunkHistogramBuckets;
+   size_t m_cBytesHistogramBuckets;
+   const FeatureCombinationCore * m_pFeatureCombination;
+   const SamplingMethod * m_pTrainingSet;
+   size_t m_cInstances;
+   size_t m_cInstancesPerChunk;
+   ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+#ifndef NDEBUG
+   const unsigned char * m_aHistogramBucketsEndDebug;
+#endif // NDEBUG
+};
+
+// this is a THREAD_POOL_TASK.  Each chunk writes only to its own histogram
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+bool BinDataSetTrainingChunk(void * const pContext, const size_t iThread, const size_t iChunk) {
+   UNUSED(iThread);
+   const BinDataSetTrainingChunksContext<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pBinDataSetTrainingChunksContext = static_cast<const BinDataSetTrainingChunksContext<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pContext);
+
+   const size_t iInstanceStart = iChunk * pBinDataSetTrainingChunksContext->m_cInstancesPerChunk;
+   EBM_ASSERT(iInstanceStart < pBinDataSetTrainingChunksContext->m_cInstances);
+   const size_t cInstancesRemaining = pBinDataSetTrainingChunksContext->m_cInstances - iInstanceStart;
+   const size_t cInstances = cInstancesRemaining < pBinDataSetTrainingChunksContext->m_cInstancesPerChunk ? cInstancesRemaining : pBinDataSetTrainingChunksContext->m_cInstancesPerChunk;
+
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * aHistogramBuckets = pBinDataSetTrainingChunksContext->m_aHistogramBuckets;
+#ifndef NDEBUG
+   const unsigned char * aHistogramBucketsEndDebug = pBinDataSetTrainingChunksContext->m_aHistogramBucketsEndDebug;
+#endif // NDEBUG
+   if(0 != iChunk) {
+      // our caller zeroed the first chunk's histogram, but we zero the rest here so that the threads share that work
+      unsigned char * const pChunkHistogramBuckets = pBinDataSetTrainingChunksContext->m_aChunkHistogramBuckets + (iChunk - 1) * pBinDataSetTrainingChunksContext->m_cBytesHistogramBuckets;
+      memset(pChunkHistogramBuckets, 0, pBinDataSetTrainingChunksContext->m_cBytesHistogramBuckets);
+      aHistogramBuckets = reinterpret_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pChunkHistogramBuckets);
+#ifndef NDEBUG
+      aHistogramBucketsEndDebug = pChunkHistogramBuckets + pBinDataSetTrainingChunksContext->m_cBytesHistogramBuckets;
+#endif // NDEBUG
+   }
+
+   BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(aHistogramBuckets, pBinDataSetTrainingChunksContext->m_pFeatureCombination, pBinDataSetTrainingChunksContext->m_pTrainingSet, iInstanceStart, cInstances, pBinDataSetTrainingChunksContext->m_runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+      , aHistogramBucketsEndDebug
+#endif // NDEBUG
+   );
+   return false;
+}
+
+// aHistogramBuckets needs to be zeroed by our caller.  cHistogramBuckets is the number of buckets that binning writes into, which excludes any auxillary buckets
+// that our caller keeps after them.  pThreadPool can be nullptr, in which case all chunks are binned on this thread.  Returns true on error
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+bool BinDataSetTrainingChunks(ThreadPool * const pThreadPool, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+   EBM_ASSERT(!IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)); // our caller allocated at least this much memory
+   const size_t cBytesHistogramBuckets = cHistogramBuckets * cBytesPerHistogramBucket;
+
+   const size_t cInstances = pTrainingSet->m_pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances);
+
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountBinningChunks(cInstances, pFeatureCombination->m_cItemsPerBitPackDataUnit, cBytesHistogramBuckets, &cInstancesPerChunk);
+   if(cChunks <= 1) {
+      BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(aHistogramBuckets, pFeatureCombination, pTrainingSet, 0, cInstances, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+      return false;
+   }
+
+   // we don't need to free this!  It's tracked and reused by pCachedThreadResources.  This can't overflow since we limited cChunks above
+   unsigned char * const aChunkHistogramBuckets = static_cast<unsigned char *>(pCachedThreadResources->GetThreadByteBuffer3((cChunks - 1) * cBytesHistogramBuckets));
+   if(UNLIKELY(nullptr == aChunkHistogramBuckets)) {
+      LOG_0(TraceLevelWarning, "WARNING BinDataSetTrainingChunks nullptr == aChunkHistogramBuckets");
+      return true;
+   }
+
+   BinDataSetTrainingChunksContext<IsClassification(compilerLearningTypeOrCountTargetClasses)> binDataSetTrainingChunksContext;
+   binDataSetTrainingChunksContext.m_aHistogramBuckets = aHistogramBuckets;
+   binDataSetTrainingChunksContext.m_aChunkHistogramBuckets = aChunkHistogramBuckets;
+   binDataSetTrainingChunksContext.m_cBytesHistogramBuckets = cBytesHistogramBuckets;
+   binDataSetTrainingChunksContext.m_pFeatureCombination = pFeatureCombination;
+   binDataSetTrainingChunksContext.m_pTrainingSet = pTrainingSet;
+   binDataSetTrainingChunksContext.m_cInstances = cInstances;
+   binDataSetTrainingChunksContext.m_cInstancesPerChunk = cInstancesPerChunk;
+   binDataSetTrainingChunksContext.m_runtimeLearningTypeOrCountTargetClasses = runtimeLearningTypeOrCountTargetClasses;
+#ifndef NDEBUG
+   binDataSetTrainingChunksContext.m_aHistogramBucketsEndDebug = aHistogramBucketsEndDebug;
+#endif // NDEBUG
+
+   if(ThreadPool::Run(pThreadPool, cChunks, &BinDataSetTrainingChunk<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>, &binDataSetTrainingChunksContext)) {
+      return true;
+   }
+
+   // there are far fewer buckets than instances in each chunk, so adding the chunks together on this thread is cheap
+   for(size_t iChunk = 1; iChunk < cChunks; ++iChunk) {
+      const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aChunkHistogramBucketsOne = reinterpret_cast<const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aChunkHistogramBuckets + (iChunk - 1) * cBytesHistogramBuckets);
+      for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+         GetHistogramBucketByIndex(cBytesPerHistogramBucket, aHistogramBuckets, iBucket)->Add(*GetHistogramBucketByIndex(cBytesPerHistogramBucket, aChunkHistogramBucketsOne, iBucket), cVectorLength, bWeighted);
+      }
+   }
+   return false;
 }
 
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
 class RecursiveBinDataSetTraining {
    // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
 public:
-   EBM_INLINE static void Recursive(const size_t cRuntimeDimensions, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, ThreadPool * const pThreadPool, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -311,13 +875,13 @@ public:
       EBM_ASSERT(cRuntimeDimensions < k_cDimensionsMax);
       static_assert(cCompilerDimensions < k_cDimensionsMax, "cCompilerDimensions must be less than or equal to k_cDimensionsMax.  This line only handles the less than part, but we handle the equals in a partial specialization template.");
       if(cCompilerDimensions == cRuntimeDimensions) {
-         BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+         return BinDataSetTrainingChunks<compilerLearningTypeOrCountTargetClasses, cCompilerDimensions>(pThreadPool, pCachedThreadResources, aHistogramBuckets, cHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
             , aHistogramBucketsEndDebug
 #endif // NDEBUG
          );
       } else {
-         RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+         return RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, 1 + cCompilerDimensions>::Recursive(cRuntimeDimensions, pThreadPool, pCachedThreadResources, aHistogramBuckets, cHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
             , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -330,14 +894,14 @@ template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
 class RecursiveBinDataSetTraining<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax> {
    // C++ does not allow partial function specialization, so we need to use these cumbersome inline static class functions to do partial function specialization
 public:
-   EBM_INLINE static void Recursive(const size_t cRuntimeDimensions, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+   EBM_INLINE static bool Recursive(const size_t cRuntimeDimensions, ThreadPool * const pThreadPool, CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const size_t cHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const SamplingMethod * const pTrainingSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
       , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
    ) {
       UNUSED(cRuntimeDimensions);
       EBM_ASSERT(k_cDimensionsMax == cRuntimeDimensions);
-      BinDataSetTraining<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax>(aHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
+      return BinDataSetTrainingChunks<compilerLearningTypeOrCountTargetClasses, k_cDimensionsMax>(pThreadPool, pCachedThreadResources, aHistogramBuckets, cHistogramBuckets, pFeatureCombination, pTrainingSet, runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
          , aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -345,71 +909,272 @@ public:
    }
 };
 
-// TODO: make the number of dimensions (pFeatureCombination->m_cFeatures) a template parameter so that we don't have to have the inner loop that is very bad for performance.  Since the data will be stored contiguously and have the same length in the future, we can just loop based on the number of dimensions, so we might as well have a couple of different values
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-void BinDataSetInteraction(HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+// cCompilerDimensions is 2 or 3 for our dedicated pair and triple kernels, where the compiler fully unrolls the dimension loop and the per instance work is
+// one streaming read from each compact column.  0 means that the number of dimensions is only known at runtime.  Interaction scores only use the
+// counts and residual sums, so these kernels always fill the buckets without the classification denominator
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions, typename TResidual, typename TBin>
+void BinDataSetInteractionColumns(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
 ) {
-   LOG_0(TraceLevelVerbose, "Entered BinDataSetInteraction");
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetInteractionColumns");
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
-
-   const FractionalDataType * pResidualError = pDataSet->GetResidualPointer();
-   const FractionalDataType * const pResidualErrorEnd = pResidualError + cVectorLength * pDataSet->GetCountInstances();
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<false>(cVectorLength, false)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<false>(cVectorLength, false);
+
+   const size_t cDimensions = 0 == cCompilerDimensions ? pFeatureCombination->m_cFeatures : cCompilerDimensions;
+   EBM_ASSERT(1 <= cDimensions); // for interactions, we just return 0 for interactions with zero features
+   EBM_ASSERT(cDimensions <= k_cDimensionsMax);
+   EBM_ASSERT(cDimensions == pFeatureCombination->m_cFeatures);
+
+   // the first dimension always has a stride of 1, so we only keep strides for the dimensions after it
+   const TBin * aInputData[0 == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
+   size_t aBucketStrides[0 == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions];
+   size_t cBucketsStride = 1;
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      const FeatureCore * const pInputFeature = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature;
+      aInputData[iDimension] = pDataSet->GetInputDataPointer<TBin>(pInputFeature);
+      aBucketStrides[iDimension] = cBucketsStride;
+      // our caller checked that the tensor size doesn't overflow
+      cBucketsStride *= pInputFeature->m_cBins;
+   }
 
-   size_t cFeatures = pFeatureCombination->m_cFeatures;
-   EBM_ASSERT(1 <= cFeatures); // for interactions, we just return 0 for interactions with zero features
-   for(size_t iInstance = 0; pResidualErrorEnd != pResidualError; ++iInstance) {
+   const TResidual * pResidualError = pDataSet->GetResidualPointer<TResidual>();
+   const size_t cInstances = pDataSet->GetCountInstances();
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
       // this loop gets about twice as slow if you add a single unpredictable branching if statement based on count, even if you still access all the memory in complete sequential order, so we'll probably want to use non-branching instructions for any solution like conditional selection or multiplication
       // this loop gets about 3 times slower if you use a bad pseudo random number generator like rand(), although it might be better if you inlined rand().
       // this loop gets about 10 times slower if you use a proper pseudo random number generator like std::default_random_engine
       // taking all the above together, it seems unlikley we'll use a method of separating sets via single pass randomized set splitting.  Even if count is stored in memory if shouldn't increase the time spent fetching it by 2 times, unless our bottleneck when threading is overwhelmingly memory pressure related, and even then we could store the count for a single bit aleviating the memory pressure greatly, if we use the right sampling method 
 
-      // TODO : try using a sampling method with non-repeating instances, and put the count into a bit.  Then unwind that loop either at the byte level (8 times) or the uint64_t level.  This can be done without branching and doesn't require random number generators
-
-      // TODO : we can elminate the inner vector loop for regression at least, and also if we add a templated bool for binary class.  Propegate this change to all places that we loop on the vector
-
-      size_t cBuckets = 1;
-      size_t iBucket = 0;
-      size_t iDimension = 0;
-      do {
-         const FeatureCore * const pInputFeature = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature;
-         const size_t cBins = pInputFeature->m_cBins;
-         const StorageDataTypeCore * pInputData = pDataSet->GetInputDataPointer(pInputFeature);
-         pInputData += iInstance;
-         StorageDataTypeCore iBinOriginal = *pInputData;
-         EBM_ASSERT((IsNumberConvertable<size_t, StorageDataTypeCore>(iBinOriginal)));
-         size_t iBin = static_cast<size_t>(iBinOriginal);
-         EBM_ASSERT(iBin < cBins);
-         iBucket += cBuckets * iBin;
-         cBuckets *= cBins;
-         ++iDimension;
-      } while(iDimension < cFeatures);
+      size_t iBucket = static_cast<size_t>(aInputData[0][iInstance]);
+      EBM_ASSERT(iBucket < ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_cBins);
+      for(size_t iDimension = 1; iDimension < cDimensions; ++iDimension) {
+         const size_t iBin = static_cast<size_t>(aInputData[iDimension][iInstance]);
+         EBM_ASSERT(iBin < ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature->m_cBins);
+         iBucket += aBucketStrides[iDimension] * iBin;
+      }
  
-      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pHistogramBucketEntry = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+      HistogramBucket<false> * pHistogramBucketEntry = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
       ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntry, aHistogramBucketsEndDebug);
       pHistogramBucketEntry->m_cInstancesInBucket += 1;
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
-         const FractionalDataType residualError = *pResidualError;
+         // float residuals are widened here so that the histogram sums accumulate in FractionalDataType
+         const FractionalDataType residualError = static_cast<FractionalDataType>(*pResidualError);
          ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError += residualError;
-         if(IsClassification(compilerLearningTypeOrCountTargetClasses)) {
-            // TODO : this code gets executed for each SamplingWithReplacement set.  I could probably execute it once and then all the SamplingWithReplacement sets would have this value, but I would need to store the computation in a new memory place, and it might make more sense to calculate this values in the CPU rather than put more pressure on memory.  I think controlling this should be done in a MACRO and we should use a class to hold the residualError and this computation from that value and then comment out the computation if not necssary and access it through an accessor so that we can make the change entirely via macro
-            const FractionalDataType denominator = EbmStatistics::ComputeNewtonRaphsonStep(residualError);
-            ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry)[iVector].SetSumDenominator(ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry)[iVector].GetSumDenominator() + denominator);
+         ++pResidualError;
+      }
+   }
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetInteractionColumns");
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, typename TResidual, typename TBin>
+EBM_INLINE void BinDataSetInteractionDimensions(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(2 == pFeatureCombination->m_cFeatures) {
+      BinDataSetInteractionColumns<compilerLearningTypeOrCountTargetClasses, 2, TResidual, TBin>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else if(3 == pFeatureCombination->m_cFeatures) {
+      BinDataSetInteractionColumns<compilerLearningTypeOrCountTargetClasses, 3, TResidual, TBin>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else {
+      BinDataSetInteractionColumns<compilerLearningTypeOrCountTargetClasses, 0, TResidual, TBin>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   }
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, typename TResidual>
+EBM_INLINE void BinDataSetInteractionBinWidth(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   const size_t cBytesPerBin = pDataSet->GetCountBytesPerBin();
+   if(sizeof(unsigned char) == cBytesPerBin) {
+      BinDataSetInteractionDimensions<compilerLearningTypeOrCountTargetClasses, TResidual, unsigned char>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else if(sizeof(unsigned short) == cBytesPerBin) {
+      BinDataSetInteractionDimensions<compilerLearningTypeOrCountTargetClasses, TResidual, unsigned short>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else {
+      EBM_ASSERT(sizeof(StorageDataTypeCore) == cBytesPerBin);
+      BinDataSetInteractionDimensions<compilerLearningTypeOrCountTargetClasses, TResidual, StorageDataTypeCore>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   }
+}
+
+// the kernel for a DataSetByFeature that views an EbmTrainingState's training set.  Each dimension reads the bit packed column of its feature's single
+// feature combination, and since the features can be packed at different widths, each dimension unpacks its own data units as it goes
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, size_t cCompilerDimensions>
+void BinDataSetInteractionBitPacked(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetInteractionBitPacked");
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<false>(cVectorLength, false)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<false>(cVectorLength, false);
+
+   const size_t cDimensions = 0 == cCompilerDimensions ? pFeatureCombination->m_cFeatures : cCompilerDimensions;
+   EBM_ASSERT(1 <= cDimensions); // for interactions, we just return 0 for interactions with zero features
+   EBM_ASSERT(cDimensions <= k_cDimensionsMax);
+   EBM_ASSERT(cDimensions == pFeatureCombination->m_cFeatures);
+
+   constexpr size_t cDimensionsArray = 0 == cCompilerDimensions ? k_cDimensionsMax : cCompilerDimensions;
+   const StorageDataTypeCore * apInputData[cDimensionsArray];
+   size_t aBucketStrides[cDimensionsArray];
+   size_t acItemsPerBitPackDataUnit[cDimensionsArray];
+   size_t acBitsPerItem[cDimensionsArray];
+   size_t aMaskBits[cDimensionsArray];
+   size_t aDataUnits[cDimensionsArray];
+   size_t acItemsRemaining[cDimensionsArray];
+   size_t cBucketsStride = 1;
+   for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+      const FeatureCore * const pInputFeature = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature;
+      apInputData[iDimension] = pDataSet->GetBitPackedInputDataPointer(pInputFeature);
+      const size_t cItemsPerBitPackDataUnit = pDataSet->GetCountItemsPerBitPackDataUnit(pInputFeature);
+      EBM_ASSERT(1 <= cItemsPerBitPackDataUnit);
+      EBM_ASSERT(cItemsPerBitPackDataUnit <= k_cBitsForStorageType);
+      acItemsPerBitPackDataUnit[iDimension] = cItemsPerBitPackDataUnit;
+      const size_t cBitsPerItem = GetCountBits(cItemsPerBitPackDataUnit);
+      EBM_ASSERT(1 <= cBitsPerItem);
+      EBM_ASSERT(cBitsPerItem <= k_cBitsForStorageType);
+      acBitsPerItem[iDimension] = cBitsPerItem;
+      aMaskBits[iDimension] = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItem);
+      aDataUnits[iDimension] = 0;
+      acItemsRemaining[iDimension] = 0;
+      aBucketStrides[iDimension] = cBucketsStride;
+      // our caller checked that the tensor size doesn't overflow
+      cBucketsStride *= pInputFeature->m_cBins;
+   }
+
+   const FractionalDataType * pResidualError = pDataSet->GetResidualPointer<FractionalDataType>();
+   const size_t cInstances = pDataSet->GetCountInstances();
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      size_t iBucket = 0;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         if(0 == acItemsRemaining[iDimension]) {
+            aDataUnits[iDimension] = static_cast<size_t>(*apInputData[iDimension]);
+            ++apInputData[iDimension];
+            acItemsRemaining[iDimension] = acItemsPerBitPackDataUnit[iDimension];
          }
+         const size_t iBin = aMaskBits[iDimension] & aDataUnits[iDimension];
+         EBM_ASSERT(iBin < ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature->m_cBins);
+         iBucket += aBucketStrides[iDimension] * iBin;
+         aDataUnits[iDimension] >>= acBitsPerItem[iDimension];
+         --acItemsRemaining[iDimension];
+      }
+
+      HistogramBucket<false> * pHistogramBucketEntry = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+      ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pHistogramBucketEntry, aHistogramBucketsEndDebug);
+      pHistogramBucketEntry->m_cInstancesInBucket += 1;
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         ARRAY_TO_POINTER(pHistogramBucketEntry->m_aHistogramBucketVectorEntry)[iVector].m_sumResidualError += *pResidualError;
          ++pResidualError;
       }
    }
+
+   // the training set's sparse columns leave each stored residual offset from its true residual by the training set's residual shift.  The offset is
+   // the same for every instance, so we correct each bucket once instead of each instance
+   const FractionalDataType residualShift = pDataSet->GetResidualShift();
+   if(0 != residualShift) {
+      EBM_ASSERT(1 == cVectorLength);
+      for(size_t iBucket = 0; iBucket < cBucketsStride; ++iBucket) {
+         HistogramBucket<false> * const pHistogramBucket = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, aHistogramBuckets, iBucket);
+         ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry)[0].m_sumResidualError -= residualShift * static_cast<FractionalDataType>(pHistogramBucket->m_cInstancesInBucket);
+      }
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited BinDataSetInteractionBitPacked");
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+EBM_INLINE void BinDataSetInteractionBitPackedDimensions(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   if(2 == pFeatureCombination->m_cFeatures) {
+      BinDataSetInteractionBitPacked<compilerLearningTypeOrCountTargetClasses, 2>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else if(3 == pFeatureCombination->m_cFeatures) {
+      BinDataSetInteractionBitPacked<compilerLearningTypeOrCountTargetClasses, 3>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else {
+      BinDataSetInteractionBitPacked<compilerLearningTypeOrCountTargetClasses, 0>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   }
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+void BinDataSetInteraction(HistogramBucket<false> * const aHistogramBuckets, const FeatureCombinationCore * const pFeatureCombination, const DataSetByFeature * const pDataSet, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+   , const unsigned char * const aHistogramBucketsEndDebug
+#endif // NDEBUG
+) {
+   LOG_0(TraceLevelVerbose, "Entered BinDataSetInteraction");
+
+   if(pDataSet->IsTrainingSetView()) {
+      BinDataSetInteractionBitPackedDimensions<compilerLearningTypeOrCountTargetClasses>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else if(sizeof(float) == pDataSet->GetCountBytesPerResidual()) {
+      BinDataSetInteractionBinWidth<compilerLearningTypeOrCountTargetClasses, float>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   } else {
+      EBM_ASSERT(sizeof(FractionalDataType) == pDataSet->GetCountBytesPerResidual());
+      BinDataSetInteractionBinWidth<compilerLearningTypeOrCountTargetClasses, FractionalDataType>(aHistogramBuckets, pFeatureCombination, pDataSet, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      );
+   }
+
    LOG_0(TraceLevelVerbose, "Exited BinDataSetInteraction");
 }
 
 // TODO: change our downstream code to not need this Compression.  This compression often won't do anything because most of the time every bin will have data, and if there is sparse data with lots of values then maybe we don't want to do a complete sweep of this data moving it arround anyways.  We only do a minimial # of splits anyways.  I can calculate the sums in the loop that builds the bins instead of here!
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const size_t cHistogramBuckets, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, size_t * const pcInstancesTotal, HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
+size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const size_t cHistogramBuckets, HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets, size_t * const pcInstancesTotal, FractionalDataType * const pWeightTotal, HistogramBucketVectorEntry<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aSumHistogramBucketVectorEntry, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses
 #ifndef NDEBUG
    , const unsigned char * const aHistogramBucketsEndDebug
 #endif // NDEBUG
@@ -418,13 +1183,15 @@ size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const
 
    EBM_ASSERT(1 <= cHistogramBuckets); // this function can handle 1 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value)
 
-#ifndef NDEBUG
-   size_t cInstancesTotalDebug = 0;
-#endif // NDEBUG
+   // GenerateModelFeatureCombinationUpdateFromHistograms gives us histograms merged from other processes, so we count our instances from the buckets
+   // instead of asking our sampling set
+   size_t cInstancesTotal = 0;
+   FractionalDataType weightTotal = 0;
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
-   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength)); // we're accessing allocated memory
-   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength);
+   const bool bWeighted = nullptr != pTrainingSet->m_pOriginDataSet->GetWeights();
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
 
    HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pCopyFrom = aHistogramBuckets;
    HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * pCopyFromEnd = GetHistogramBucketByIndex<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cBytesPerHistogramBucket, aHistogramBuckets, cHistogramBuckets);
@@ -442,11 +1209,10 @@ size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const
          do {
             ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pCopyFrom, aHistogramBucketsEndDebug);
             if(LIKELY(0 != pCopyFrom->m_cInstancesInBucket)) {
-#ifndef NDEBUG
-               cInstancesTotalDebug += pCopyFrom->m_cInstancesInBucket;
-#endif // NDEBUG
+               cInstancesTotal += pCopyFrom->m_cInstancesInBucket;
                ASSERT_BINNED_BUCKET_OK(cBytesPerHistogramBucket, pCopyTo, aHistogramBucketsEndDebug);
                memcpy(pCopyTo, pCopyFrom, cBytesPerHistogramBucket);
+               weightTotal += pCopyFrom->GetWeight(cVectorLength, bWeighted);
 
                for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
                   aSumHistogramBucketVectorEntry[iVector].Add(ARRAY_TO_POINTER(pCopyFrom->m_aHistogramBucketVectorEntry)[iVector]);
@@ -463,9 +1229,8 @@ size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const
          pCopyFrom = pCopyTo;
          break;
       }
-#ifndef NDEBUG
-      cInstancesTotalDebug += pCopyFrom->m_cInstancesInBucket;
-#endif // NDEBUG
+      cInstancesTotal += pCopyFrom->m_cInstancesInBucket;
+      weightTotal += pCopyFrom->GetWeight(cVectorLength, bWeighted);
       for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
          aSumHistogramBucketVectorEntry[iVector].Add(ARRAY_TO_POINTER(pCopyFrom->m_aHistogramBucketVectorEntry)[iVector]);
       }
@@ -478,10 +1243,10 @@ size_t CompressHistogramBuckets(const SamplingMethod * const pTrainingSet, const
    EBM_ASSERT(0 == (reinterpret_cast<char *>(pCopyFrom) - reinterpret_cast<char *>(aHistogramBuckets)) % cBytesPerHistogramBucket);
    size_t cFinalItems = (reinterpret_cast<char *>(pCopyFrom) - reinterpret_cast<char *>(aHistogramBuckets)) / cBytesPerHistogramBucket;
 
-   const size_t cInstancesTotal = pTrainingSet->GetTotalCountInstanceOccurrences();
-   EBM_ASSERT(cInstancesTotal == cInstancesTotalDebug);
-
    *pcInstancesTotal = cInstancesTotal;
+   // integer valued doubles add exactly, so without weights this is exactly our count of instances
+   EBM_ASSERT(bWeighted || static_cast<FractionalDataType>(cInstancesTotal) == weightTotal);
+   *pWeightTotal = weightTotal;
 
    LOG_0(TraceLevelVerbose, "Exited CompressHistogramBuckets");
    return cFinalItems;
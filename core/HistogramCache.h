@@ -0,0 +1,102 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef HISTOGRAM_CACHE_H
+#define HISTOGRAM_CACHE_H
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <string.h> // memcpy
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// HistogramCache holds the binned histogram of one sampling set from the last time that a feature combination was binned on it.  Binning visits every
+// instance, while a histogram is only as big as the feature combination's tensor, so if we're asked for the same feature combination again before the
+// residuals have changed (callers probing different learning rates or split limits through a workspace), or if the only change to the residuals was the
+// update that we just made to this same feature combination (for regression we can apply that update directly to the histogram), then we can skip binning.
+// The key is the feature combination index and a generation number that EbmTrainingState increments every time that it changes the training residuals.
+// We only ever cache the main tensor space (before CompressHistogramBuckets or BuildFastTotals modify it), and we hold onto a single histogram per sampling
+// set since the cyclic boosting algorithm visits every other feature combination before returning to this one
+class HistogramCache final {
+   void * m_aHistogramBuckets;
+   size_t m_cBytesCapacity;
+   // zero when we don't hold a valid histogram
+   size_t m_cBytesHistogram;
+   size_t m_iFeatureCombination;
+   size_t m_iResidualGeneration;
+
+public:
+
+   EBM_INLINE HistogramCache()
+      : m_aHistogramBuckets(nullptr)
+      , m_cBytesCapacity(0)
+      , m_cBytesHistogram(0)
+      , m_iFeatureCombination(0)
+      , m_iResidualGeneration(0) {
+   }
+
+   EBM_INLINE ~HistogramCache() {
+      free(m_aHistogramBuckets);
+   }
+
+   // sets which histogram we're about to load or store.  If it's different than the one that we're holding, we throw our histogram away
+   EBM_INLINE void SetKey(const size_t iFeatureCombination, const size_t iResidualGeneration) {
+      if(iFeatureCombination != m_iFeatureCombination || iResidualGeneration != m_iResidualGeneration) {
+         m_cBytesHistogram = 0;
+         m_iFeatureCombination = iFeatureCombination;
+         m_iResidualGeneration = iResidualGeneration;
+      }
+   }
+
+   // returns true if we held the histogram for our key and copied it into aHistogramBuckets
+   EBM_INLINE bool Load(void * const aHistogramBuckets, const size_t cBytesHistogram) const {
+      EBM_ASSERT(nullptr != aHistogramBuckets);
+      EBM_ASSERT(0 < cBytesHistogram);
+      if(cBytesHistogram != m_cBytesHistogram) {
+         return false;
+      }
+      memcpy(aHistogramBuckets, m_aHistogramBuckets, cBytesHistogram);
+      return true;
+   }
+
+   // caching is an optimization, so if we can't allocate the memory we just don't cache anything and let our caller carry on without us
+   EBM_INLINE void Store(const void * const aHistogramBuckets, const size_t cBytesHistogram) {
+      EBM_ASSERT(nullptr != aHistogramBuckets);
+      EBM_ASSERT(0 < cBytesHistogram);
+      m_cBytesHistogram = 0;
+      if(m_cBytesCapacity < cBytesHistogram) {
+         free(m_aHistogramBuckets);
+         m_cBytesCapacity = 0;
+         m_aHistogramBuckets = malloc(cBytesHistogram);
+         if(UNLIKELY(nullptr == m_aHistogramBuckets)) {
+            LOG_0(TraceLevelWarning, "WARNING HistogramCache::Store nullptr == m_aHistogramBuckets");
+            return;
+         }
+         m_cBytesCapacity = cBytesHistogram;
+      }
+      memcpy(m_aHistogramBuckets, aHistogramBuckets, cBytesHistogram);
+      m_cBytesHistogram = cBytesHistogram;
+   }
+
+   // returns the histogram that we hold for the given key so that it can be modified in place, or nullptr if we don't have it
+   EBM_INLINE void * GetHistogram(const size_t iFeatureCombination, const size_t iResidualGeneration) const {
+      if(0 == m_cBytesHistogram || iFeatureCombination != m_iFeatureCombination || iResidualGeneration != m_iResidualGeneration) {
+         return nullptr;
+      }
+      return m_aHistogramBuckets;
+   }
+
+   // forgets our histogram without changing our key
+   EBM_INLINE void Clear() {
+      m_cBytesHistogram = 0;
+   }
+
+   // our caller changed the histogram we returned from GetHistogram to match the residuals of a new generation
+   EBM_INLINE void SetResidualGeneration(const size_t iResidualGeneration) {
+      m_iResidualGeneration = iResidualGeneration;
+   }
+};
+
+#endif // HISTOGRAM_CACHE_H
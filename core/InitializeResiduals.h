@@ -115,9 +115,6 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
 
          const IntegerDataType * pTargetData = static_cast<const IntegerDataType *>(aTargetData);
 
-         EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(cVectorLength)));
-         const StorageDataTypeCore cVectorLengthStorage = static_cast<StorageDataTypeCore>(cVectorLength);
-
          do {
             const IntegerDataType targetOriginal = *pTargetData;
             EBM_ASSERT(0 <= targetOriginal);
@@ -132,27 +129,18 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
                ++pPredictorScores;
                ++pResidualError;
             } else {
-               FractionalDataType sumExp = 0;
                // TODO : eventually eliminate this subtract variable once we've decided how to handle removing one logit
                const FractionalDataType subtract = 0 <= k_iZeroClassificationLogitAtInitialize ? pPredictorScores[k_iZeroClassificationLogitAtInitialize] : 0;
 
-               for(StorageDataTypeCore iVector = 0; iVector < cVectorLengthStorage; ++iVector) {
-                  const FractionalDataType predictionScore = *pPredictorScores - subtract;
-                  sumExp += std::exp(predictionScore);
-                  ++pPredictorScores;
-               }
-
-               // go back to the start so that we can iterate again
-               pPredictorScores -= cVectorLengthStorage;
-
-               for(StorageDataTypeCore iVector = 0; iVector < cVectorLengthStorage; ++iVector) {
-                  const FractionalDataType predictionScore = *pPredictorScores - subtract;
-                  // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
-                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, predictionScore, target, iVector);
-                  *pResidualError = residualError;
-                  ++pPredictorScores;
-                  ++pResidualError;
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+                  // we park the score and then its exp(..) in the residual slot that this class will overwrite below.  Keeping each step in its own
+                  // loop over the classes lets the compiler vectorize them
+                  pResidualError[iVector] = pPredictorScores[iVector] - subtract;
                }
+               pPredictorScores += cVectorLength;
+               const FractionalDataType sumExp = EbmStatistics::ExpAndSumMulticlass(cVectorLength, pResidualError);
+               EbmStatistics::ComputeClassificationResidualErrorsMulticlassFromExps(cVectorLength, sumExp, target, pResidualError);
+               pResidualError += cVectorLength;
                // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
                // 
                // this works out in the math as making the first model vector parameter equal to zero, which in turn removes one degree of freedom
@@ -163,7 +151,7 @@ static void InitializeResiduals(const size_t cInstances, const void * const aTar
                // means the numerator and denominator are multiplied by the same constant, which cancels eachother out.  We can thus set exp(T2 + I2) to exp(0) and adjust the other terms
                constexpr bool bZeroingResiduals = 0 <= k_iZeroResidual;
                if(bZeroingResiduals) {
-                  pResidualError[k_iZeroResidual - static_cast<ptrdiff_t>(cVectorLengthStorage)] = 0;
+                  pResidualError[k_iZeroResidual - static_cast<ptrdiff_t>(cVectorLength)] = 0;
                }
             }
             ++pTargetData;
@@ -8,23 +8,28 @@
 #include <stdlib.h> // malloc, realloc, free
 #include <stddef.h> // size_t, ptrdiff_t
 #include <limits> // numeric_limits
+#include <algorithm> // partial_sort
+#include <cmath> // std::isnan
 
 #include "ebmcore.h"
 #include "EbmInternal.h"
 #include "Logging.h" // EBM_ASSERT & LOG
 // feature includes
 #include "FeatureCore.h"
+#include "FeatureCombinationCore.h"
 // dataset depends on features
+#include "DataSetByFeatureCombination.h"
 #include "DataSetByFeature.h"
 // depends on the above
 #include "DimensionMultiple.h"
 
 #include "EbmInteractionState.h"
+#include "EbmTrainingState.h"
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
-EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, const EbmCoreFeature * features, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, IntegerDataType countInstances, const void * targets, const IntegerDataType * binnedData, const FractionalDataType * predictorScores) {
+EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, const EbmCoreFeature * features, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, IntegerDataType countInstances, const void * targets, const IntegerDataType * binnedData, const FractionalDataType * predictorScores, const IntegerDataType interactionOptions) {
    EBM_ASSERT(0 <= countFeatures);
    EBM_ASSERT(0 == countFeatures || nullptr != features);
    // countTargetClasses is checked by our caller since it's only valid for classification at this point
@@ -42,6 +47,12 @@ EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, con
       return nullptr;
    }
 
+   if(0 != (interactionOptions & ~InteractionOptionsFloatResiduals)) {
+      LOG_0(TraceLevelError, "ERROR AllocateCoreInteraction interactionOptions contains unknown options");
+      return nullptr;
+   }
+   const bool bFloatResiduals = 0 != (interactionOptions & InteractionOptionsFloatResiduals);
+
    size_t cFeatures = static_cast<size_t>(countFeatures);
    size_t cInstances = static_cast<size_t>(countInstances);
 
@@ -52,7 +63,7 @@ EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, con
       LOG_0(TraceLevelWarning, "WARNING AllocateCoreInteraction nullptr == pEbmInteractionState");
       return nullptr;
    }
-   if(UNLIKELY(pEbmInteractionState->InitializeInteraction(features, cInstances, targets, binnedData, predictorScores))) {
+   if(UNLIKELY(pEbmInteractionState->InitializeInteraction(features, cInstances, targets, binnedData, predictorScores, bFloatResiduals))) {
       LOG_0(TraceLevelWarning, "WARNING AllocateCoreInteraction pEbmInteractionState->InitializeInteraction");
       delete pEbmInteractionState;
       return nullptr;
@@ -60,6 +71,21 @@ EbmInteractionState * AllocateCoreInteraction(IntegerDataType countFeatures, con
    return pEbmInteractionState;
 }
 
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegressionWithOptions(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   IntegerDataType interactionOptions
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionRegressionWithOptions: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p, interactionOptions=%" IntegerDataTypePrintf, countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores), interactionOptions);
+   PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, k_Regression, countInstances, targets, binnedData, predictorScores, interactionOptions));
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionRegressionWithOptions %p", static_cast<void *>(pEbmInteraction));
+   return pEbmInteraction;
+}
+
 EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegression(
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
@@ -68,101 +94,157 @@ EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION Initialize
    const IntegerDataType * binnedData,
    const FractionalDataType * predictorScores
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeInteractionRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
-   PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, k_Regression, countInstances, targets, binnedData, predictorScores));
-   LOG_N(TraceLevelInfo, "Exited InitializeInteractionRegression %p", static_cast<void *>(pEbmInteraction));
-   return pEbmInteraction;
+   LOG_0(TraceLevelInfo, "Entered InitializeInteractionRegression");
+   return InitializeInteractionRegressionWithOptions(countFeatures, features, countInstances, targets, binnedData, predictorScores, InteractionOptionsNone);
 }
 
-EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassification(
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassificationWithOptions(
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
    IntegerDataType countTargetClasses,
    IntegerDataType countInstances,
    const IntegerDataType * targets,
    const IntegerDataType * binnedData,
-   const FractionalDataType * predictorScores
+   const FractionalDataType * predictorScores,
+   IntegerDataType interactionOptions
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeInteractionClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores));
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionClassificationWithOptions: countFeatures=%" IntegerDataTypePrintf ", features=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", targets=%p, binnedData=%p, predictorScores=%p, interactionOptions=%" IntegerDataTypePrintf, countFeatures, static_cast<const void *>(features), countTargetClasses, countInstances, static_cast<const void *>(targets), static_cast<const void *>(binnedData), static_cast<const void *>(predictorScores), interactionOptions);
    if(countTargetClasses < 0) {
-      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassification countTargetClasses can't be negative");
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassificationWithOptions countTargetClasses can't be negative");
       return nullptr;
    }
    if(0 == countTargetClasses && 0 != countInstances) {
-      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassification countTargetClasses can't be zero unless there are no instances");
+      LOG_0(TraceLevelError, "ERROR InitializeInteractionClassificationWithOptions countTargetClasses can't be zero unless there are no instances");
       return nullptr;
    }
    if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
-      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionClassificationWithOptions !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
       return nullptr;
    }
    const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
-   PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, runtimeLearningTypeOrCountTargetClasses, countInstances, targets, binnedData, predictorScores));
-   LOG_N(TraceLevelInfo, "Exited InitializeInteractionClassification %p", static_cast<void *>(pEbmInteraction));
+   PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(AllocateCoreInteraction(countFeatures, features, runtimeLearningTypeOrCountTargetClasses, countInstances, targets, binnedData, predictorScores, interactionOptions));
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionClassificationWithOptions %p", static_cast<void *>(pEbmInteraction));
    return pEbmInteraction;
 }
 
-template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static IntegerDataType GetInteractionScorePerTargetClasses(EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
-   // TODO : be smarter about our CachedInteractionThreadResources, otherwise why have it?
-   CachedInteractionThreadResources * const pCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources();
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores
+) {
+   LOG_0(TraceLevelInfo, "Entered InitializeInteractionClassification");
+   return InitializeInteractionClassificationWithOptions(countFeatures, features, countTargetClasses, countInstances, targets, binnedData, predictorScores, InteractionOptionsNone);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionFromTraining(
+   PEbmTraining ebmTraining
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeInteractionFromTraining: ebmTraining=%p", static_cast<void *>(ebmTraining));
+
+   EbmTrainingState * const pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   const size_t cFeatures = pEbmTrainingState->m_cFeatures;
+   LOG_0(TraceLevelInfo, "Entered EbmInteractionState");
+   EbmInteractionState * const pEbmInteractionState = new (std::nothrow) EbmInteractionState(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, cFeatures, pEbmTrainingState->m_aFeatures);
+   LOG_N(TraceLevelInfo, "Exited EbmInteractionState %p", static_cast<void *>(pEbmInteractionState));
+   if(UNLIKELY(nullptr == pEbmInteractionState)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromTraining nullptr == pEbmInteractionState");
+      return nullptr;
+   }
+
+   // with zero training instances we have no training set, and like InitializeInteraction we leave m_pDataSet nullptr so that every score is 0
+   const DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   if(nullptr != pTrainingSet && 0 != cFeatures) {
+      if(IsMultiplyError(sizeof(const FeatureCombinationCore *), cFeatures)) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromTraining IsMultiplyError(sizeof(const FeatureCombinationCore *), cFeatures)");
+         delete pEbmInteractionState;
+         return nullptr;
+      }
+      const FeatureCombinationCore ** const apFeatureCombinationsByFeature = static_cast<const FeatureCombinationCore * *>(malloc(sizeof(const FeatureCombinationCore *) * cFeatures));
+      if(nullptr == apFeatureCombinationsByFeature) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromTraining nullptr == apFeatureCombinationsByFeature");
+         delete pEbmInteractionState;
+         return nullptr;
+      }
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         apFeatureCombinationsByFeature[iFeature] = nullptr;
+      }
+      // features with a single bin are dropped from feature combinations, so only our features with more than one bin can turn up here
+      for(size_t iFeatureCombination = 0; iFeatureCombination < pEbmTrainingState->m_cFeatureCombinations; ++iFeatureCombination) {
+         const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
+         if(1 == pFeatureCombination->m_cFeatures) {
+            const size_t iFeature = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[0].m_pFeature->m_iFeatureData;
+            EBM_ASSERT(iFeature < cFeatures);
+            if(nullptr == apFeatureCombinationsByFeature[iFeature]) {
+               apFeatureCombinationsByFeature[iFeature] = pFeatureCombination;
+            }
+         }
+      }
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         if(2 <= pEbmTrainingState->m_aFeatures[iFeature].m_cBins && nullptr == apFeatureCombinationsByFeature[iFeature]) {
+            LOG_0(TraceLevelError, "ERROR InitializeInteractionFromTraining every feature with more than one bin needs a feature combination of its own");
+            free(apFeatureCombinationsByFeature);
+            delete pEbmInteractionState;
+            return nullptr;
+         }
+      }
 
-   if(CalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, 0>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pEbmInteractionState->m_pDataSet, pFeatureCombination, pInteractionScoreReturn)) {
-      delete pCachedThreadResources;
+      pEbmInteractionState->m_pDataSet = new (std::nothrow) DataSetByFeature(pTrainingSet, cFeatures, apFeatureCombinationsByFeature);
+      free(apFeatureCombinationsByFeature);
+      if(nullptr == pEbmInteractionState->m_pDataSet || pEbmInteractionState->m_pDataSet->IsError()) {
+         LOG_0(TraceLevelWarning, "WARNING InitializeInteractionFromTraining nullptr == m_pDataSet || m_pDataSet->IsError()");
+         delete pEbmInteractionState;
+         return nullptr;
+      }
+   }
+
+   PEbmInteraction pEbmInteraction = reinterpret_cast<PEbmInteraction>(pEbmInteractionState);
+   LOG_N(TraceLevelInfo, "Exited InitializeInteractionFromTraining %p", static_cast<void *>(pEbmInteraction));
+   return pEbmInteraction;
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static IntegerDataType GetInteractionScorePerTargetClasses(EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+   if(RecursiveCalculateInteractionScore<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(pFeatureCombination->m_cFeatures, pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pCachedThreadResources, pEbmInteractionState->m_pDataSet, pFeatureCombination, pInteractionScoreReturn)) {
       return 1;
    }
-   delete pCachedThreadResources;
    return 0;
 }
 
 template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
-EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
    static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    if(runtimeLearningTypeOrCountTargetClasses == possibleCompilerLearningTypeOrCountTargetClasses) {
       EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
-      return GetInteractionScorePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+      return GetInteractionScorePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
    } else {
-      return CompilerRecursiveGetInteractionScore<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+      return CompilerRecursiveGetInteractionScore<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
    }
 }
 
 template<>
-EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveGetInteractionScore<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const FeatureCombinationCore * const pFeatureCombination, FractionalDataType * const pInteractionScoreReturn) {
    UNUSED(runtimeLearningTypeOrCountTargetClasses);
    // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
    static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
-   return GetInteractionScorePerTargetClasses<k_DynamicClassification>(pEbmInteractionState, pFeatureCombination, pInteractionScoreReturn);
+   return GetInteractionScorePerTargetClasses<k_DynamicClassification>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, pInteractionScoreReturn);
 }
 
-// we made this a global because if we had put this variable inside the EbmInteractionState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmInteractionState object is sent into us
-// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
-static unsigned int g_cLogGetInteractionScoreParametersMessages = 10;
-
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
-   PEbmInteraction ebmInteraction,
-   IntegerDataType countFeaturesInCombination,
-   const IntegerDataType * featureIndexes,
-   FractionalDataType * interactionScoreReturn
-) {
-   LOG_COUNTED_N(&g_cLogGetInteractionScoreParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GetInteractionScore parameters: ebmInteraction=%p, countFeaturesInCombination=%" IntegerDataTypePrintf ", featureIndexes=%p, interactionScoreReturn=%p", static_cast<void *>(ebmInteraction), countFeaturesInCombination, static_cast<const void *>(featureIndexes), static_cast<void *>(interactionScoreReturn));
-
-   EBM_ASSERT(nullptr != ebmInteraction);
-   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
-
-   LOG_COUNTED_0(&pEbmInteractionState->m_cLogEnterMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GetInteractionScore");
-
-   EBM_ASSERT(0 <= countFeaturesInCombination);
-   EBM_ASSERT(0 == countFeaturesInCombination || nullptr != featureIndexes);
+// GetInteractionScoreCore doesn't modify pEbmInteractionState, so separate threads can call it at the same time if each uses its own pCachedThreadResources
+static IntegerDataType GetInteractionScoreCore(EbmInteractionState * const pEbmInteractionState, CachedInteractionThreadResources * const pCachedThreadResources, const size_t cFeaturesInCombination, const IntegerDataType * const featureIndexes, FractionalDataType * const interactionScoreReturn) {
+   EBM_ASSERT(nullptr != pEbmInteractionState);
+   EBM_ASSERT(nullptr != pCachedThreadResources);
+   EBM_ASSERT(0 == cFeaturesInCombination || nullptr != featureIndexes);
    // interactionScoreReturn can be nullptr
 
-   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
-      LOG_0(TraceLevelWarning, "WARNING GetInteractionScore !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
-      return 1;
-   }
-   size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
    if(0 == cFeaturesInCombination) {
       LOG_0(TraceLevelInfo, "INFO GetInteractionScore empty feature combination");
       if(nullptr != interactionScoreReturn) {
@@ -231,9 +313,8 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
       ++pFeatureCombinationIndex;
    } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
 
-   IntegerDataType ret;
    if(IsRegression(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses)) {
-      ret = GetInteractionScorePerTargetClasses<k_Regression>(pEbmInteractionState, pFeatureCombination, interactionScoreReturn);
+      return GetInteractionScorePerTargetClasses<k_Regression>(pEbmInteractionState, pCachedThreadResources, pFeatureCombination, interactionScoreReturn);
    } else {
       EBM_ASSERT(IsClassification(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses));
       if(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
@@ -243,13 +324,50 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
          }
          return 0;
       }
-      ret = CompilerRecursiveGetInteractionScore<2>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pFeatureCombination, interactionScoreReturn);
+      return CompilerRecursiveGetInteractionScore<2>(pEbmInteractionState->m_runtimeLearningTypeOrCountTargetClasses, pEbmInteractionState, pCachedThreadResources, pFeatureCombination, interactionScoreReturn);
    }
+}
+
+// we made this a global because if we had put this variable inside the EbmInteractionState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmInteractionState object is sent into us
+// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
+static unsigned int g_cLogGetInteractionScoreParametersMessages = 10;
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countFeaturesInCombination,
+   const IntegerDataType * featureIndexes,
+   FractionalDataType * interactionScoreReturn
+) {
+   LOG_COUNTED_N(&g_cLogGetInteractionScoreParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GetInteractionScore parameters: ebmInteraction=%p, countFeaturesInCombination=%" IntegerDataTypePrintf ", featureIndexes=%p, interactionScoreReturn=%p", static_cast<void *>(ebmInteraction), countFeaturesInCombination, static_cast<const void *>(featureIndexes), static_cast<void *>(interactionScoreReturn));
+
+   EBM_ASSERT(nullptr != ebmInteraction);
+   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
+
+   LOG_COUNTED_0(&pEbmInteractionState->m_cLogEnterMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GetInteractionScore");
+
+   EBM_ASSERT(0 <= countFeaturesInCombination);
+   EBM_ASSERT(0 == countFeaturesInCombination || nullptr != featureIndexes);
+   // interactionScoreReturn can be nullptr
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScore !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+      return 1;
+   }
+   const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+
+   CachedInteractionThreadResources * const pCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources();
+   if(UNLIKELY(nullptr == pCachedThreadResources)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScore nullptr == pCachedThreadResources");
+      return 1;
+   }
+   pCachedThreadResources->m_pStatistics = &pEbmInteractionState->m_statistics;
+   const IntegerDataType ret = GetInteractionScoreCore(pEbmInteractionState, pCachedThreadResources, cFeaturesInCombination, featureIndexes, interactionScoreReturn);
+   delete pCachedThreadResources;
    if(0 != ret) {
       LOG_N(TraceLevelWarning, "WARNING GetInteractionScore returned %" IntegerDataTypePrintf, ret);
    }
    if(nullptr != interactionScoreReturn) {
-      EBM_ASSERT(0 <= *interactionScoreReturn);
+      EBM_ASSERT(std::isnan(*interactionScoreReturn) || 0 <= *interactionScoreReturn);
       LOG_COUNTED_N(&pEbmInteractionState->m_cLogExitMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GetInteractionScore %" FractionalDataTypePrintf, *interactionScoreReturn);
    } else {
       LOG_COUNTED_0(&pEbmInteractionState->m_cLogExitMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GetInteractionScore");
@@ -257,6 +375,223 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInterac
    return ret;
 }
 
+// each task scores a contiguous range of feature combinations.  Individual interaction scores can be quick, so we hand them out in groups to keep
+// the threads from contending over the next task index
+constexpr size_t k_cFeatureCombinationsPerInteractionTask = 16;
+
+struct InteractionScoresContext {
+   EbmInteractionState * m_pEbmInteractionState;
+   size_t m_cFeatureCombinations;
+   const size_t * m_aiFeatureIndexesStart;
+   const size_t * m_acFeaturesInCombination;
+   const IntegerDataType * m_aFeatureIndexes;
+   FractionalDataType * m_aInteractionScores;
+};
+
+static bool ScoreInteractionsTask(void * const pContext, const size_t iThread, const size_t iTask) {
+   InteractionScoresContext * const pInteractionScoresContext = static_cast<InteractionScoresContext *>(pContext);
+   EbmInteractionState * const pEbmInteractionState = pInteractionScoresContext->m_pEbmInteractionState;
+   EBM_ASSERT(iThread < pEbmInteractionState->m_cCachedThreadResources);
+   CachedInteractionThreadResources * const pCachedThreadResources = &pEbmInteractionState->m_aCachedThreadResources[iThread];
+
+   const size_t iFeatureCombinationStart = iTask * k_cFeatureCombinationsPerInteractionTask;
+   EBM_ASSERT(iFeatureCombinationStart < pInteractionScoresContext->m_cFeatureCombinations);
+   const size_t cFeatureCombinationsRemaining = pInteractionScoresContext->m_cFeatureCombinations - iFeatureCombinationStart;
+   const size_t iFeatureCombinationEnd = iFeatureCombinationStart + (cFeatureCombinationsRemaining < k_cFeatureCombinationsPerInteractionTask ? cFeatureCombinationsRemaining : k_cFeatureCombinationsPerInteractionTask);
+   for(size_t iFeatureCombination = iFeatureCombinationStart; iFeatureCombination < iFeatureCombinationEnd; ++iFeatureCombination) {
+      const size_t cFeaturesInCombination = pInteractionScoresContext->m_acFeaturesInCombination[iFeatureCombination];
+      const IntegerDataType * const featureIndexes = 0 == cFeaturesInCombination ? nullptr : &pInteractionScoresContext->m_aFeatureIndexes[pInteractionScoresContext->m_aiFeatureIndexesStart[iFeatureCombination]];
+      if(0 != GetInteractionScoreCore(pEbmInteractionState, pCachedThreadResources, cFeaturesInCombination, featureIndexes, &pInteractionScoresContext->m_aInteractionScores[iFeatureCombination])) {
+         return true;
+      }
+   }
+   return false;
+}
+
+// returns true on error
+static bool InitializeInteractionThreads(EbmInteractionState * const pEbmInteractionState) {
+   EBM_ASSERT(nullptr == pEbmInteractionState->m_pThreadPool);
+   EBM_ASSERT(nullptr == pEbmInteractionState->m_aCachedThreadResources);
+   try {
+      const size_t cThreadsRecommended = ThreadPool::GetCountThreadsRecommended(std::numeric_limits<size_t>::max());
+      if(1 < cThreadsRecommended) {
+         pEbmInteractionState->m_pThreadPool = ThreadPool::Allocate(cThreadsRecommended - 1);
+         if(UNLIKELY(nullptr == pEbmInteractionState->m_pThreadPool)) {
+            LOG_0(TraceLevelWarning, "WARNING InitializeInteractionThreads nullptr == m_pThreadPool");
+            return true;
+         }
+      }
+   } catch(...) {
+      // ThreadPool::GetCountThreadsRecommended calls std::thread::hardware_concurrency, which isn't marked noexcept
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionThreads exception");
+      return true;
+   }
+   const size_t cThreads = nullptr == pEbmInteractionState->m_pThreadPool ? size_t { 1 } : pEbmInteractionState->m_pThreadPool->GetCountThreads();
+   pEbmInteractionState->m_aCachedThreadResources = new (std::nothrow) CachedInteractionThreadResources[cThreads];
+   if(UNLIKELY(nullptr == pEbmInteractionState->m_aCachedThreadResources)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeInteractionThreads nullptr == m_aCachedThreadResources");
+      return true;
+   }
+   for(size_t iThread = 0; iThread < cThreads; ++iThread) {
+      pEbmInteractionState->m_aCachedThreadResources[iThread].m_pStatistics = &pEbmInteractionState->m_statistics;
+   }
+   pEbmInteractionState->m_cCachedThreadResources = cThreads;
+   return false;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScores(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureIndexes,
+   IntegerDataType countTopScores,
+   IntegerDataType * featureCombinationIndexesReturn,
+   FractionalDataType * interactionScoresReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered GetInteractionScores: ebmInteraction=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureIndexes=%p, countTopScores=%" IntegerDataTypePrintf ", featureCombinationIndexesReturn=%p, interactionScoresReturn=%p", static_cast<void *>(ebmInteraction), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureIndexes), countTopScores, static_cast<void *>(featureCombinationIndexesReturn), static_cast<void *>(interactionScoresReturn));
+
+   EBM_ASSERT(nullptr != ebmInteraction);
+   EbmInteractionState * pEbmInteractionState = reinterpret_cast<EbmInteractionState *>(ebmInteraction);
+
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   // featureIndexes can be nullptr if all the feature combinations are empty
+   // featureCombinationIndexesReturn can be nullptr if countTopScores is negative
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != interactionScoresReturn);
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return 1;
+   }
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   if(0 == cFeatureCombinations) {
+      LOG_0(TraceLevelInfo, "Exited GetInteractionScores no feature combinations");
+      return 0;
+   }
+
+   const bool bTopScores = 0 <= countTopScores;
+   size_t cTopScores = cFeatureCombinations;
+   if(bTopScores) {
+      EBM_ASSERT(nullptr != featureCombinationIndexesReturn);
+      if(IsNumberConvertable<size_t, IntegerDataType>(countTopScores) && static_cast<size_t>(countTopScores) < cFeatureCombinations) {
+         cTopScores = static_cast<size_t>(countTopScores);
+      }
+   }
+
+   if(IsMultiplyError(sizeof(size_t) * 2 + sizeof(FractionalDataType), cFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores IsMultiplyError(sizeof(size_t) * 2 + sizeof(FractionalDataType), cFeatureCombinations)");
+      return 1;
+   }
+   size_t * const aiFeatureIndexesStart = static_cast<size_t *>(malloc(sizeof(size_t) * cFeatureCombinations));
+   size_t * const acFeaturesInCombination = static_cast<size_t *>(malloc(sizeof(size_t) * cFeatureCombinations));
+   // without a top K, we write the scores directly in the order that our caller gave us the feature combinations
+   FractionalDataType * const aInteractionScores = bTopScores ? static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cFeatureCombinations)) : interactionScoresReturn;
+   IntegerDataType ret = 1;
+   if(UNLIKELY(nullptr == aiFeatureIndexesStart || nullptr == acFeaturesInCombination || nullptr == aInteractionScores)) {
+      LOG_0(TraceLevelWarning, "WARNING GetInteractionScores nullptr == aiFeatureIndexesStart || nullptr == acFeaturesInCombination || nullptr == aInteractionScores");
+      goto exit_free;
+   }
+
+   {
+      size_t iFeatureIndexes = 0;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const IntegerDataType countFeaturesInCombination = featureCombinations[iFeatureCombination].countFeaturesInCombination;
+         EBM_ASSERT(0 <= countFeaturesInCombination);
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+            LOG_0(TraceLevelWarning, "WARNING GetInteractionScores !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+            goto exit_free;
+         }
+         const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+         EBM_ASSERT(0 == cFeaturesInCombination || nullptr != featureIndexes);
+         aiFeatureIndexesStart[iFeatureCombination] = iFeatureIndexes;
+         acFeaturesInCombination[iFeatureCombination] = cFeaturesInCombination;
+         // featureIndexes is an array in our caller's memory, so its length can't overflow
+         iFeatureIndexes += cFeaturesInCombination;
+      }
+
+      if(nullptr == pEbmInteractionState->m_aCachedThreadResources) {
+         if(InitializeInteractionThreads(pEbmInteractionState)) {
+            goto exit_free;
+         }
+      }
+
+      InteractionScoresContext interactionScoresContext;
+      interactionScoresContext.m_pEbmInteractionState = pEbmInteractionState;
+      interactionScoresContext.m_cFeatureCombinations = cFeatureCombinations;
+      interactionScoresContext.m_aiFeatureIndexesStart = aiFeatureIndexesStart;
+      interactionScoresContext.m_acFeaturesInCombination = acFeaturesInCombination;
+      interactionScoresContext.m_aFeatureIndexes = featureIndexes;
+      interactionScoresContext.m_aInteractionScores = aInteractionScores;
+      const size_t cTasks = (cFeatureCombinations - 1) / k_cFeatureCombinationsPerInteractionTask + 1;
+      if(ThreadPool::Run(pEbmInteractionState->m_pThreadPool, cTasks, &ScoreInteractionsTask, &interactionScoresContext)) {
+         LOG_0(TraceLevelWarning, "WARNING GetInteractionScores ThreadPool::Run");
+         goto exit_free;
+      }
+
+      if(bTopScores) {
+         // we reuse aiFeatureIndexesStart to hold the feature combination indexes that we're sorting.  Equal scores are ordered by their position in
+         // featureCombinations so that we don't depend on the sorting algorithm.  NaN doesn't compare with anything, so we put NaN scores after
+         // every other score ourselves to keep this a strict weak ordering, which std::partial_sort needs
+         size_t * const aiFeatureCombinations = aiFeatureIndexesStart;
+         for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+            aiFeatureCombinations[iFeatureCombination] = iFeatureCombination;
+         }
+         std::partial_sort(aiFeatureCombinations, aiFeatureCombinations + cTopScores, aiFeatureCombinations + cFeatureCombinations, [aInteractionScores](const size_t iLeft, const size_t iRight) {
+            const FractionalDataType scoreLeft = aInteractionScores[iLeft];
+            const FractionalDataType scoreRight = aInteractionScores[iRight];
+            if(UNLIKELY(std::isnan(scoreLeft))) {
+               return std::isnan(scoreRight) && iLeft < iRight;
+            }
+            if(UNLIKELY(std::isnan(scoreRight))) {
+               return true;
+            }
+            return scoreRight < scoreLeft || scoreLeft == scoreRight && iLeft < iRight;
+         });
+         for(size_t iTopScore = 0; iTopScore < cTopScores; ++iTopScore) {
+            const size_t iFeatureCombination = aiFeatureCombinations[iTopScore];
+            featureCombinationIndexesReturn[iTopScore] = static_cast<IntegerDataType>(iFeatureCombination);
+            interactionScoresReturn[iTopScore] = aInteractionScores[iFeatureCombination];
+         }
+      }
+      ret = 0;
+   }
+
+exit_free:;
+   if(bTopScores) {
+      free(aInteractionScores);
+   }
+   free(acFeaturesInCombination);
+   free(aiFeatureIndexesStart);
+
+   LOG_N(TraceLevelInfo, "Exited GetInteractionScores %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionStatistics(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countStatistics,
+   IntegerDataType * statisticsOut
+) {
+   LOG_N(TraceLevelInfo, "Entered GetInteractionStatistics: ebmInteraction=%p, countStatistics=%" IntegerDataTypePrintf ", statisticsOut=%p", static_cast<void *>(ebmInteraction), countStatistics, static_cast<void *>(statisticsOut));
+
+   const EbmInteractionState * const pEbmInteractionState = reinterpret_cast<const EbmInteractionState *>(ebmInteraction);
+   EBM_ASSERT(nullptr != pEbmInteractionState);
+
+   if(countStatistics < 0 || StatisticsCount < countStatistics) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionStatistics countStatistics must be in the range [0, StatisticsCount]");
+      return 1;
+   }
+   const size_t cStatistics = static_cast<size_t>(countStatistics);
+   if(0 != cStatistics && nullptr == statisticsOut) {
+      LOG_0(TraceLevelError, "ERROR GetInteractionStatistics 0 != countStatistics && nullptr == statisticsOut");
+      return 1;
+   }
+   pEbmInteractionState->m_statistics.Get(cStatistics, statisticsOut);
+
+   LOG_0(TraceLevelInfo, "Exited GetInteractionStatistics");
+   return 0;
+}
+
 EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeInteraction(
    PEbmInteraction ebmInteraction
 ) {
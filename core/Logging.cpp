@@ -7,6 +7,10 @@
 #include <assert.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string.h> // memcpy, strlen
+#include <new> // std::nothrow
+#include <atomic> // std::atomic
+#include <mutex> // std::mutex, std::lock_guard
 
 #include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // FeatureTypeCore
@@ -31,6 +35,133 @@ EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION SetTraceLevel(signed
    g_traceLevel = traceLevel;
 }
 
+// LogMessageEntry is one slot of our log message ring.  This is Dmitry Vyukov's bounded queue: m_sequence tells the producers and the consumer whose turn it
+// is to use the slot, so producers only need a compare exchange on g_iLogMessageEnqueue to claim a slot and never wait on each other or on the consumer
+constexpr static size_t k_cCharsLogMessageBuffered = 512;
+constexpr static size_t k_cLogMessagesBufferedMax = size_t { 1 } << 20;
+
+struct LogMessageEntry {
+   std::atomic<size_t> m_sequence;
+   signed char m_traceLevel;
+   char m_message[k_cCharsLogMessageBuffered];
+};
+
+static LogMessageEntry * g_aLogMessageEntries = nullptr;
+static size_t g_cLogMessageEntriesMask = 0;
+static std::atomic<size_t> g_iLogMessageEnqueue(0);
+static std::atomic<size_t> g_cLogMessagesDropped(0);
+// the consumer side is only touched while holding g_mutexLogMessageFlush.  Producers never take it
+static std::mutex g_mutexLogMessageFlush;
+static size_t g_iLogMessageDequeue = 0;
+// while buffering, g_pLogMessageFunc points to EnqueueLogMessage and this holds our caller's function
+static LOG_MESSAGE_FUNCTION g_pLogMessageFuncBuffered = nullptr;
+
+static void EBMCORE_CALLING_CONVENTION EnqueueLogMessage(signed char traceLevel, const char * message) {
+   EBM_ASSERT(nullptr != g_aLogMessageEntries);
+   size_t iEnqueue = g_iLogMessageEnqueue.load(std::memory_order_relaxed);
+   LogMessageEntry * pEntry;
+   while(true) {
+      pEntry = &g_aLogMessageEntries[iEnqueue & g_cLogMessageEntriesMask];
+      // the positions wrap around eventually, so compare them by their signed difference
+      const ptrdiff_t difference = static_cast<ptrdiff_t>(pEntry->m_sequence.load(std::memory_order_acquire) - iEnqueue);
+      if(0 == difference) {
+         // the slot is free for this position.  If another producer beat us to it, iEnqueue gets their new position and we try again
+         if(g_iLogMessageEnqueue.compare_exchange_weak(iEnqueue, iEnqueue + 1, std::memory_order_relaxed)) {
+            break;
+         }
+      } else if(difference < 0) {
+         // the slot still holds the message from one lap ago, so the ring is full.  We drop instead of waiting for the consumer
+         g_cLogMessagesDropped.fetch_add(1, std::memory_order_relaxed);
+         return;
+      } else {
+         iEnqueue = g_iLogMessageEnqueue.load(std::memory_order_relaxed);
+      }
+   }
+   size_t cChars = strlen(message);
+   if(k_cCharsLogMessageBuffered <= cChars) {
+      cChars = k_cCharsLogMessageBuffered - 1;
+   }
+   memcpy(pEntry->m_message, message, cChars);
+   pEntry->m_message[cChars] = '\0';
+   pEntry->m_traceLevel = traceLevel;
+   pEntry->m_sequence.store(iEnqueue + 1, std::memory_order_release);
+}
+
+// the caller holds g_mutexLogMessageFlush
+static size_t FlushLogMessagesLocked() {
+   EBM_ASSERT(nullptr != g_aLogMessageEntries);
+   EBM_ASSERT(nullptr != g_pLogMessageFuncBuffered);
+   while(true) {
+      LogMessageEntry * const pEntry = &g_aLogMessageEntries[g_iLogMessageDequeue & g_cLogMessageEntriesMask];
+      if(pEntry->m_sequence.load(std::memory_order_acquire) != g_iLogMessageDequeue + 1) {
+         // either the ring is empty or the producer that claimed this slot hasn't finished writing it.  We'll pick it up on the next flush
+         break;
+      }
+      (*g_pLogMessageFuncBuffered)(pEntry->m_traceLevel, pEntry->m_message);
+      // hand the slot back to the producers for the message one lap ahead
+      pEntry->m_sequence.store(g_iLogMessageDequeue + g_cLogMessageEntriesMask + 1, std::memory_order_release);
+      ++g_iLogMessageDequeue;
+   }
+   const size_t cDropped = g_cLogMessagesDropped.exchange(0, std::memory_order_relaxed);
+   if(0 != cDropped) {
+      char messageSpace[128];
+      snprintf(messageSpace, sizeof(messageSpace) / sizeof(messageSpace[0]), "WARNING %llu log messages were dropped because the log message buffer was full", static_cast<unsigned long long>(cDropped));
+      (*g_pLogMessageFuncBuffered)(TraceLevelWarning, messageSpace);
+   }
+   return cDropped;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetLogMessageBuffer(IntegerDataType countMessages) {
+   assert(nullptr != g_pLogMessageFunc); /* "call SetLogMessageFunction before calling SetLogMessageBuffer" */
+   if(countMessages < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countMessages) || k_cLogMessagesBufferedMax < static_cast<size_t>(countMessages)) {
+      return 1;
+   }
+   const size_t cMessages = static_cast<size_t>(countMessages);
+
+   std::lock_guard<std::mutex> lock(g_mutexLogMessageFlush);
+   if(nullptr != g_aLogMessageEntries) {
+      FlushLogMessagesLocked();
+      g_pLogMessageFunc = g_pLogMessageFuncBuffered;
+      g_pLogMessageFuncBuffered = nullptr;
+      delete[] g_aLogMessageEntries;
+      g_aLogMessageEntries = nullptr;
+      g_cLogMessageEntriesMask = 0;
+   }
+   if(0 == cMessages) {
+      return 0;
+   }
+
+   // the mask trick needs a power of two.  We need at least 2 slots so that a full ring is distinguishable from one whose only slot is being written
+   size_t cEntries = 2;
+   while(cEntries < cMessages) {
+      cEntries <<= 1;
+   }
+   LogMessageEntry * const aEntries = new (std::nothrow) LogMessageEntry[cEntries];
+   if(nullptr == aEntries) {
+      return 1;
+   }
+   for(size_t iEntry = 0; iEntry < cEntries; ++iEntry) {
+      aEntries[iEntry].m_sequence.store(iEntry, std::memory_order_relaxed);
+   }
+   g_aLogMessageEntries = aEntries;
+   g_cLogMessageEntriesMask = cEntries - 1;
+   g_iLogMessageEnqueue.store(0, std::memory_order_relaxed);
+   g_iLogMessageDequeue = 0;
+   g_cLogMessagesDropped.store(0, std::memory_order_relaxed);
+   g_pLogMessageFuncBuffered = g_pLogMessageFunc;
+   g_pLogMessageFunc = EnqueueLogMessage;
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION FlushLogMessages() {
+   std::lock_guard<std::mutex> lock(g_mutexLogMessageFlush);
+   if(nullptr == g_aLogMessageEntries) {
+      return 0;
+   }
+   const size_t cDropped = FlushLogMessagesLocked();
+   return IsNumberConvertable<IntegerDataType, size_t>(cDropped) ? static_cast<IntegerDataType>(cDropped) : std::numeric_limits<IntegerDataType>::max();
+}
+
 WARNING_PUSH
 WARNING_DISABLE_NON_LITERAL_PRINTF_STRING
 extern void InteralLogWithArguments(signed char traceLevel, const char * const pOriginalMessage, ...) {
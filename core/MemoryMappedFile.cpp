@@ -0,0 +1,130 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <new> // std::nothrow
+
+#ifdef _WIN32
+// we don't want to require windows.h in our precompiled header since then it will be needed in linux builds, which doesn't make sense
+#include <windows.h>
+#else // _WIN32
+#include <sys/types.h> // off_t
+#include <sys/stat.h> // fstat
+#include <sys/mman.h> // mmap, munmap, posix_madvise
+#include <fcntl.h> // open
+#include <unistd.h> // close
+#endif // _WIN32
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+
+MemoryMappedFile * MemoryMappedFile::Open(const char * const filePath) {
+   LOG_0(TraceLevelInfo, "Entered MemoryMappedFile::Open");
+   EBM_ASSERT(nullptr != filePath);
+
+   const HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+   if(INVALID_HANDLE_VALUE == hFile) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open INVALID_HANDLE_VALUE == hFile");
+      return nullptr;
+   }
+   LARGE_INTEGER cBytesFile;
+   if(!GetFileSizeEx(hFile, &cBytesFile) || cBytesFile.QuadPart <= 0 || !IsNumberConvertable<size_t, LONGLONG>(cBytesFile.QuadPart)) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open bad file size");
+      CloseHandle(hFile);
+      return nullptr;
+   }
+   const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+   // the mapping keeps the file open, so we don't need our own handle any longer
+   CloseHandle(hFile);
+   if(nullptr == hMapping) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open nullptr == hMapping");
+      return nullptr;
+   }
+   const void * const pData = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+   if(nullptr == pData) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open nullptr == pData");
+      CloseHandle(hMapping);
+      return nullptr;
+   }
+   MemoryMappedFile * const pMemoryMappedFile = new (std::nothrow) MemoryMappedFile();
+   if(nullptr == pMemoryMappedFile) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open nullptr == pMemoryMappedFile");
+      UnmapViewOfFile(pData);
+      CloseHandle(hMapping);
+      return nullptr;
+   }
+   pMemoryMappedFile->m_pData = pData;
+   pMemoryMappedFile->m_cBytes = static_cast<size_t>(cBytesFile.QuadPart);
+   pMemoryMappedFile->m_hMapping = hMapping;
+
+   LOG_0(TraceLevelInfo, "Exited MemoryMappedFile::Open");
+   return pMemoryMappedFile;
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+   LOG_0(TraceLevelInfo, "Entered ~MemoryMappedFile");
+   if(nullptr != m_pData) {
+      UnmapViewOfFile(m_pData);
+   }
+   if(nullptr != m_hMapping) {
+      CloseHandle(static_cast<HANDLE>(m_hMapping));
+   }
+   LOG_0(TraceLevelInfo, "Exited ~MemoryMappedFile");
+}
+
+#else // _WIN32
+
+MemoryMappedFile * MemoryMappedFile::Open(const char * const filePath) {
+   LOG_0(TraceLevelInfo, "Entered MemoryMappedFile::Open");
+   EBM_ASSERT(nullptr != filePath);
+
+   const int fileDescriptor = open(filePath, O_RDONLY);
+   if(fileDescriptor < 0) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open fileDescriptor < 0");
+      return nullptr;
+   }
+   struct stat fileStatus;
+   if(0 != fstat(fileDescriptor, &fileStatus) || fileStatus.st_size <= 0 || !IsNumberConvertable<size_t, off_t>(fileStatus.st_size)) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open bad file size");
+      close(fileDescriptor);
+      return nullptr;
+   }
+   const size_t cBytes = static_cast<size_t>(fileStatus.st_size);
+   void * const pData = mmap(nullptr, cBytes, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+   // the mapping keeps the file open, so we don't need our descriptor any longer
+   close(fileDescriptor);
+   if(MAP_FAILED == pData) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open MAP_FAILED == pData");
+      return nullptr;
+   }
+   // this is only a hint, so we don't care if it fails
+   posix_madvise(pData, cBytes, POSIX_MADV_SEQUENTIAL);
+
+   MemoryMappedFile * const pMemoryMappedFile = new (std::nothrow) MemoryMappedFile();
+   if(nullptr == pMemoryMappedFile) {
+      LOG_0(TraceLevelWarning, "WARNING MemoryMappedFile::Open nullptr == pMemoryMappedFile");
+      munmap(pData, cBytes);
+      return nullptr;
+   }
+   pMemoryMappedFile->m_pData = pData;
+   pMemoryMappedFile->m_cBytes = cBytes;
+
+   LOG_0(TraceLevelInfo, "Exited MemoryMappedFile::Open");
+   return pMemoryMappedFile;
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+   LOG_0(TraceLevelInfo, "Entered ~MemoryMappedFile");
+   if(nullptr != m_pData) {
+      munmap(const_cast<void *>(m_pData), m_cBytes);
+   }
+   LOG_0(TraceLevelInfo, "Exited ~MemoryMappedFile");
+}
+
+#endif // _WIN32
@@ -0,0 +1,43 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef MEMORY_MAPPED_FILE_H
+#define MEMORY_MAPPED_FILE_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// MemoryMappedFile maps an entire file read-only into our address space.  The operating system pages the file in as we touch it and can drop the pages
+// again under memory pressure, so we can train on files that are larger than physical memory.  We hint that the mapping will be read sequentially since
+// boosting makes full sequential passes over each feature combination's data.  We keep the platform specific handles opaque so that our callers don't
+// need windows.h or the posix headers
+class MemoryMappedFile final {
+   const void * m_pData;
+   size_t m_cBytes;
+   // the Windows file mapping handle, or unused on posix
+   void * m_hMapping;
+
+   EBM_INLINE MemoryMappedFile()
+      : m_pData(nullptr)
+      , m_cBytes(0)
+      , m_hMapping(nullptr) {
+   }
+
+public:
+   ~MemoryMappedFile();
+
+   // returns nullptr if the file can't be opened or mapped.  Empty files can't be mapped
+   static MemoryMappedFile * Open(const char * const filePath);
+
+   EBM_INLINE const void * GetData() const {
+      return m_pData;
+   }
+   EBM_INLINE size_t GetCountBytes() const {
+      return m_cBytes;
+   }
+};
+
+#endif // MEMORY_MAPPED_FILE_H
@@ -0,0 +1,105 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef MULTICLASS_EXP_H
+#define MULTICLASS_EXP_H
+
+#include <stdint.h> // uint64_t
+#include <string.h> // memcpy
+#include <type_traits> // std::is_same
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // EBM_INLINE
+
+// the exp(..) that EbmStatistics uses for the softmax of models with many classes.  Nothing in here logs or asserts, so our tests can include this
+// header directly and check it against std::exp
+class MulticlassExp final {
+   EBM_INLINE MulticlassExp() {
+      // DON'T allow anyone to make this static class
+   }
+
+public:
+
+   // bTrue ? valueTrue : valueFalse, but done with bit masks so that the compiler can turn it into a vector blend
+   EBM_INLINE static double SelectForMulticlass(const bool bTrue, const double valueTrue, const double valueFalse) {
+      const uint64_t mask = uint64_t { 0 } - static_cast<uint64_t>(bTrue);
+      uint64_t trueBits;
+      memcpy(&trueBits, &valueTrue, sizeof(trueBits));
+      uint64_t falseBits;
+      memcpy(&falseBits, &valueFalse, sizeof(falseBits));
+      const uint64_t retBits = (trueBits & mask) | (falseBits & ~mask);
+      double ret;
+      memcpy(&ret, &retBits, sizeof(ret));
+      return ret;
+   }
+
+   // limits exp(..) arguments to the range where ExpForMulticlassClamped can build its power of two.  exp(-746) rounds to 0 and exp(710) overflows
+   // to +inf, which is what std::exp returns for anything beyond those points too.  NaN fails both comparisons, so it flows through
+   EBM_INLINE static FractionalDataType ClampForMulticlassExp(const FractionalDataType value) {
+      constexpr double k_expArgumentMin = -746.0;
+      constexpr double k_expArgumentMax = 710.0;
+      // a plain floating point ternary won't vectorize unless the compiler is allowed to ignore floating point exceptions
+      const double clippedLow = SelectForMulticlass(value < k_expArgumentMin, k_expArgumentMin, value);
+      return SelectForMulticlass(k_expArgumentMax < clippedLow, k_expArgumentMax, clippedLow);
+   }
+
+   // exp(..) for the softmax in our multiclass kernels, for values that went through ClampForMulticlassExp.  std::exp is an opaque library call, so
+   // any per-class loop that calls it stays scalar.  We use Cody-Waite range reduction and a degree 13 Taylor polynomial, which stays within 2 ulps
+   // of std::exp, and then build 2^n directly in the exponent bits.  There are no calls or branches, so the per-class loops vectorize, including in
+   // our SSE2 baseline since the clamp with its 64 bit blends is kept in a separate loop.  It's all plain IEEE arithmetic, and our builds don't
+   // contract multiplies and adds, so every machine computes identical results
+   EBM_INLINE static FractionalDataType ExpForMulticlassClamped(const FractionalDataType clamped) {
+      static_assert(std::is_same<double, FractionalDataType>::value, "ExpForMulticlassClamped is written for doubles");
+
+      constexpr double k_log2e = 1.44269504088896340736;
+      // ln(2) split so that n * k_ln2High is exact for any n we can generate
+      constexpr double k_ln2High = 6.93147180369123816490e-01;
+      constexpr double k_ln2Low = 1.90821492927058770002e-10;
+      // adding 1.5 * 2^52 rounds to the nearest integer, which then sits in the low mantissa bits
+      constexpr double k_roundingShift = 6755399441055744.0;
+      constexpr uint64_t k_roundingShiftBits = uint64_t { 0x4338000000000000 };
+
+      const double shifted = clamped * k_log2e + k_roundingShift;
+      const double n = shifted - k_roundingShift;
+      const double r = (clamped - n * k_ln2High) - n * k_ln2Low;
+
+      // Estrin's scheme evaluates the polynomial as a tree, which is a much shorter dependency chain than Horner's rule
+      const double r2 = r * r;
+      const double r4 = r2 * r2;
+      const double r8 = r4 * r4;
+      const double p01 = 1.0 + r;
+      const double p23 = 1.0 / 2.0 + r * (1.0 / 6.0);
+      const double p45 = 1.0 / 24.0 + r * (1.0 / 120.0);
+      const double p67 = 1.0 / 720.0 + r * (1.0 / 5040.0);
+      const double p89 = 1.0 / 40320.0 + r * (1.0 / 362880.0);
+      const double p1011 = 1.0 / 3628800.0 + r * (1.0 / 39916800.0);
+      const double p1213 = 1.0 / 479001600.0 + r * (1.0 / 6227020800.0);
+      const double p03 = p01 + r2 * p23;
+      const double p47 = p45 + r2 * p67;
+      const double p811 = p89 + r2 * p1011;
+      const double p07 = p03 + r4 * p47;
+      const double p813 = p811 + r4 * p1213;
+      const double polynomial = p07 + r8 * p813;
+
+      // n is in [-1076, 1024], which doesn't fit in a normal number's exponent, so we scale by 2^n1 and then 2^(n - n1) with both halves in range.
+      // The first multiplication is exact, so overflow to +inf and rounding into subnormals happen once in the second, just like std::exp
+      const double shifted1 = n * 0.5 + k_roundingShift;
+      const double n1 = shifted1 - k_roundingShift;
+      const double shifted2 = (n - n1) + k_roundingShift;
+      uint64_t shiftedBits1;
+      memcpy(&shiftedBits1, &shifted1, sizeof(shiftedBits1));
+      uint64_t shiftedBits2;
+      memcpy(&shiftedBits2, &shifted2, sizeof(shiftedBits2));
+      // the halves are the low bits of the shifted values.  Unsigned arithmetic wraps the negative halves into the right exponent
+      const uint64_t scaleBits1 = (shiftedBits1 - k_roundingShiftBits + uint64_t { 1023 }) << 52;
+      const uint64_t scaleBits2 = (shiftedBits2 - k_roundingShiftBits + uint64_t { 1023 }) << 52;
+      double scale1;
+      memcpy(&scale1, &scaleBits1, sizeof(scale1));
+      double scale2;
+      memcpy(&scale2, &scaleBits2, sizeof(scale2));
+      return polynomial * scale1 * scale2;
+   }
+};
+
+#endif // MULTICLASS_EXP_H
@@ -0,0 +1,104 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef PHASE_STATISTICS_H
+#define PHASE_STATISTICS_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+#include <limits> // numeric_limits
+
+#ifndef EBM_NO_STATISTICS
+#include <atomic> // std::atomic
+#include <chrono> // std::chrono::steady_clock
+#endif // EBM_NO_STATISTICS
+
+#include "ebmcore.h" // IntegerDataType, Statistic*
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// PhaseStatistics accumulates the time that we spend in each phase of training or interaction detection along with counts of the work done, which our
+// callers read through GetTrainingStatistics and GetInteractionStatistics.  We only add once per phase (one binning pass, one tree, one sweep), never
+// per instance, so the cost is a couple of clock reads and a relaxed atomic add each time.  Workspaces and thread pools can add to the same
+// PhaseStatistics from several threads at once, so the counters are atomic.  Defining EBM_NO_STATISTICS compiles all of this away
+class PhaseStatistics final {
+#ifndef EBM_NO_STATISTICS
+   std::atomic<uint64_t> m_aStatistics[StatisticsCount];
+#endif // EBM_NO_STATISTICS
+
+public:
+
+   EBM_INLINE PhaseStatistics() {
+#ifndef EBM_NO_STATISTICS
+      for(size_t iStatistic = 0; iStatistic < static_cast<size_t>(StatisticsCount); ++iStatistic) {
+         m_aStatistics[iStatistic].store(0, std::memory_order_relaxed);
+      }
+#endif // EBM_NO_STATISTICS
+   }
+
+   EBM_INLINE void Add(const IntegerDataType iStatistic, const uint64_t c) {
+#ifndef EBM_NO_STATISTICS
+      EBM_ASSERT(0 <= iStatistic && iStatistic < StatisticsCount);
+      m_aStatistics[static_cast<size_t>(iStatistic)].fetch_add(c, std::memory_order_relaxed);
+#else // EBM_NO_STATISTICS
+      UNUSED(iStatistic);
+      UNUSED(c);
+#endif // EBM_NO_STATISTICS
+   }
+
+   // copies the first cStatistics counters, which are all zero if we were compiled with EBM_NO_STATISTICS
+   EBM_INLINE void Get(const size_t cStatistics, IntegerDataType * const aStatisticsOut) const {
+      EBM_ASSERT(cStatistics <= static_cast<size_t>(StatisticsCount));
+      EBM_ASSERT(0 == cStatistics || nullptr != aStatisticsOut);
+      for(size_t iStatistic = 0; iStatistic < cStatistics; ++iStatistic) {
+#ifndef EBM_NO_STATISTICS
+         const uint64_t statistic = m_aStatistics[iStatistic].load(std::memory_order_relaxed);
+         // a nanosecond total would need centuries of training to reach the top bit, but we saturate instead of wrapping negative anyway
+         aStatisticsOut[iStatistic] = IsNumberConvertable<IntegerDataType, uint64_t>(statistic) ? static_cast<IntegerDataType>(statistic) : std::numeric_limits<IntegerDataType>::max();
+#else // EBM_NO_STATISTICS
+         aStatisticsOut[iStatistic] = 0;
+#endif // EBM_NO_STATISTICS
+      }
+   }
+};
+
+// PhaseTimer adds the nanoseconds between its construction and destruction to one of the *Nanoseconds statistics.  Wall clock time is summed across
+// threads, so phases that run in parallel can add up to more than the time that our caller waited
+class PhaseTimer final {
+#ifndef EBM_NO_STATISTICS
+   PhaseStatistics * const m_pStatistics;
+   const IntegerDataType m_iStatistic;
+   const std::chrono::steady_clock::time_point m_start;
+#endif // EBM_NO_STATISTICS
+
+public:
+
+#ifndef EBM_NO_STATISTICS
+   EBM_INLINE PhaseTimer(PhaseStatistics * const pStatistics, const IntegerDataType iStatistic)
+      : m_pStatistics(pStatistics)
+      , m_iStatistic(iStatistic)
+      , m_start(std::chrono::steady_clock::now()) {
+      EBM_ASSERT(nullptr != pStatistics);
+   }
+
+   EBM_INLINE ~PhaseTimer() {
+      const std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - m_start;
+      const auto cNanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+      // steady_clock can't go backwards, but don't let a zero or negative reading wrap around our unsigned counter
+      if(LIKELY(0 < cNanoseconds)) {
+         m_pStatistics->Add(m_iStatistic, static_cast<uint64_t>(cNanoseconds));
+      }
+   }
+#else // EBM_NO_STATISTICS
+   EBM_INLINE PhaseTimer(PhaseStatistics * const pStatistics, const IntegerDataType iStatistic) {
+      UNUSED(pStatistics);
+      UNUSED(iStatistic);
+   }
+#endif // EBM_NO_STATISTICS
+
+   PhaseTimer(const PhaseTimer &) = delete;
+   PhaseTimer & operator=(const PhaseTimer &) = delete;
+};
+
+#endif // PHASE_STATISTICS_H
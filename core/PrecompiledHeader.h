@@ -14,6 +14,10 @@
 #include <queue>
 
 #include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <cmath> // log, exp, sqrt, etc.  Use cmath instead of math.h so that we get type overloading for these functions for seemless float/double useage
 
 #include <stdio.h> // snprintf/vsnprintf for logging
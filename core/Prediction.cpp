@@ -0,0 +1,1005 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <string.h> // memcpy, memcmp
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdio.h> // FILE, fopen, fwrite, fclose
+#include <inttypes.h> // uint64_t, int64_t
+#include <cmath> // exp
+
+#include "ebmcore.h"
+#include "EbmInternal.h"
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "Binning.h"
+#include "MemoryMappedFile.h"
+
+// we score a block of instances against every feature combination before moving on to the next block.  The block's predictor scores and tensor
+// indexes stay in L1 cache while we stream through each feature column sequentially, and each model tensor only needs to be in cache once per block
+constexpr size_t k_cInstancesPerPredictionBlock = k_cInstancesPerBinningBlock;
+
+struct PredictionDimension {
+   const IntegerDataType * m_aInputData;
+   size_t m_cBins;
+};
+
+// when we're given raw values instead of binned data, we bin each feature that the terms read into m_aBinnedBlock at the start of every block, and the
+// dimensions read their bins from there.  Each feature is binned once per block no matter how many terms use it
+struct PredictionRawFeature {
+   const FractionalDataType * m_aValues;
+   const FractionalDataType * m_aCuts;
+   size_t m_cCuts;
+   IntegerDataType * m_aBinnedBlock;
+};
+
+struct PredictionTerm {
+   // dimensions with only 1 bin always have a tensor index of 0, so we leave them out just like training does when it builds the model tensors
+   size_t m_cDimensions;
+   const PredictionDimension * m_aDimensions;
+   const FractionalDataType * m_aValues;
+};
+
+EBM_INLINE static void ConvertLogitsToProbabilities(const size_t cVectorLength, const size_t cInstances, FractionalDataType * const aPredictorScores) {
+   FractionalDataType * pPredictorScores = aPredictorScores;
+   const FractionalDataType * const pPredictorScoresEnd = aPredictorScores + cInstances * cVectorLength;
+   if(1 == cVectorLength) {
+      // for binary classification we have a single logit for the probability of the 1 target class.  We take exp of a non-positive value so that
+      // it can't overflow, but otherwise this is the odds / (1 + odds) form from ebmcore.h
+      do {
+         const FractionalDataType logit = *pPredictorScores;
+         const FractionalDataType oddsSmall = std::exp(logit < 0 ? logit : -logit);
+         *pPredictorScores = logit < 0 ? oddsSmall / (1 + oddsSmall) : 1 / (1 + oddsSmall);
+         ++pPredictorScores;
+      } while(pPredictorScoresEnd != pPredictorScores);
+   } else {
+      do {
+         // shifting every logit by the same amount doesn't change the probabilities, and shifting by the maximum prevents exp from overflowing
+         FractionalDataType logitMax = pPredictorScores[0];
+         for(size_t iVector = 1; iVector < cVectorLength; ++iVector) {
+            logitMax = logitMax < pPredictorScores[iVector] ? pPredictorScores[iVector] : logitMax;
+         }
+         FractionalDataType sumExp = 0;
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            const FractionalDataType oneExp = std::exp(pPredictorScores[iVector] - logitMax);
+            pPredictorScores[iVector] = oneExp;
+            sumExp += oneExp;
+         }
+         const FractionalDataType sumExpInverted = 1 / sumExp;
+         for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+            pPredictorScores[iVector] *= sumExpInverted;
+         }
+         pPredictorScores += cVectorLength;
+      } while(pPredictorScoresEnd != pPredictorScores);
+   }
+}
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static void PredictBatchPerTargetClasses(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cTerms, const PredictionTerm * const aTerms, const size_t cRawFeatures, const PredictionRawFeature * const aRawFeatures, const size_t cInstances, const bool bProbabilities, FractionalDataType * const aPredictorScores) {
+   EBM_ASSERT(0 < cInstances);
+   EBM_ASSERT(nullptr != aPredictorScores);
+   EBM_ASSERT(!bProbabilities || IsClassification(runtimeLearningTypeOrCountTargetClasses));
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+
+   size_t aTensorIndexes[k_cInstancesPerPredictionBlock];
+
+   size_t iInstanceStart = 0;
+   do {
+      const size_t cInstancesRemaining = cInstances - iInstanceStart;
+      const size_t cInstancesBlock = cInstancesRemaining < k_cInstancesPerPredictionBlock ? cInstancesRemaining : k_cInstancesPerPredictionBlock;
+      FractionalDataType * const aPredictorScoresBlock = aPredictorScores + iInstanceStart * cVectorLength;
+
+      // our dimensions point at the start of the binned data, or at the start of our binned block if we bin raw values
+      size_t iInputDataStart = iInstanceStart;
+      if(nullptr != aRawFeatures) {
+         const PredictionRawFeature * pRawFeature = aRawFeatures;
+         const PredictionRawFeature * const pRawFeatureEnd = aRawFeatures + cRawFeatures;
+         for(; pRawFeatureEnd != pRawFeature; ++pRawFeature) {
+            BinFeatureColumn(pRawFeature->m_cCuts, pRawFeature->m_aCuts, cInstancesBlock, pRawFeature->m_aValues + iInstanceStart, pRawFeature->m_aBinnedBlock);
+         }
+         iInputDataStart = 0;
+      }
+
+      const PredictionTerm * pTerm = aTerms;
+      const PredictionTerm * const pTermEnd = aTerms + cTerms;
+      for(; pTermEnd != pTerm; ++pTerm) {
+         const FractionalDataType * const aValues = pTerm->m_aValues;
+         const size_t cDimensions = pTerm->m_cDimensions;
+         FractionalDataType * pPredictorScores = aPredictorScoresBlock;
+         if(0 == cDimensions) {
+            // a tensor without any dimensions is a single logit vector that applies to every instance
+            for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+                  pPredictorScores[iVector] += aValues[iVector];
+               }
+               pPredictorScores += cVectorLength;
+            }
+            continue;
+         }
+
+         // build the tensor indexes one feature column at a time so that each column is read sequentially.  The first feature in the
+         // combination varies fastest within the tensor, which is the same layout that DataSetByFeatureCombination uses for training
+         const PredictionDimension * pDimension = pTerm->m_aDimensions;
+         const PredictionDimension * const pDimensionEnd = pDimension + cDimensions;
+         const IntegerDataType * pInputData = pDimension->m_aInputData + iInputDataStart;
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            const IntegerDataType inputData = pInputData[iInstance];
+            EBM_ASSERT(0 <= inputData);
+            EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(inputData)));
+            EBM_ASSERT(static_cast<size_t>(inputData) < pDimension->m_cBins);
+            aTensorIndexes[iInstance] = static_cast<size_t>(inputData);
+         }
+         size_t tensorMultiple = pDimension->m_cBins;
+         ++pDimension;
+         for(; pDimensionEnd != pDimension; ++pDimension) {
+            pInputData = pDimension->m_aInputData + iInputDataStart;
+            for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+               const IntegerDataType inputData = pInputData[iInstance];
+               EBM_ASSERT(0 <= inputData);
+               EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(inputData)));
+               EBM_ASSERT(static_cast<size_t>(inputData) < pDimension->m_cBins);
+               // this can't overflow since our caller checked that the tensor size fits into a size_t
+               aTensorIndexes[iInstance] += tensorMultiple * static_cast<size_t>(inputData);
+            }
+            tensorMultiple *= pDimension->m_cBins;
+         }
+
+         for(size_t iInstance = 0; iInstance < cInstancesBlock; ++iInstance) {
+            const FractionalDataType * const pValues = &aValues[aTensorIndexes[iInstance] * cVectorLength];
+            for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+               pPredictorScores[iVector] += pValues[iVector];
+            }
+            pPredictorScores += cVectorLength;
+         }
+      }
+
+      if(IsClassification(compilerLearningTypeOrCountTargetClasses) && bProbabilities) {
+         ConvertLogitsToProbabilities(cVectorLength, cInstancesBlock, aPredictorScoresBlock);
+      }
+
+      iInstanceStart += cInstancesBlock;
+   } while(cInstances != iInstanceStart);
+}
+
+template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
+EBM_INLINE void CompilerRecursivePredictBatch(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cTerms, const PredictionTerm * const aTerms, const size_t cRawFeatures, const PredictionRawFeature * const aRawFeatures, const size_t cInstances, const bool bProbabilities, FractionalDataType * const aPredictorScores) {
+   static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   if(runtimeLearningTypeOrCountTargetClasses == possibleCompilerLearningTypeOrCountTargetClasses) {
+      EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
+      PredictBatchPerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(runtimeLearningTypeOrCountTargetClasses, cTerms, aTerms, cRawFeatures, aRawFeatures, cInstances, bProbabilities, aPredictorScores);
+   } else {
+      CompilerRecursivePredictBatch<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, cTerms, aTerms, cRawFeatures, aRawFeatures, cInstances, bProbabilities, aPredictorScores);
+   }
+}
+
+template<>
+EBM_INLINE void CompilerRecursivePredictBatch<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cTerms, const PredictionTerm * const aTerms, const size_t cRawFeatures, const PredictionRawFeature * const aRawFeatures, const size_t cInstances, const bool bProbabilities, FractionalDataType * const aPredictorScores) {
+   static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
+   PredictBatchPerTargetClasses<k_DynamicClassification>(runtimeLearningTypeOrCountTargetClasses, cTerms, aTerms, cRawFeatures, aRawFeatures, cInstances, bProbabilities, aPredictorScores);
+}
+
+static IntegerDataType PredictBatchCore(
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses,
+   const IntegerDataType countFeatures,
+   const EbmCoreFeature * const features,
+   const IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * const featureCombinations,
+   const IntegerDataType * const featureCombinationIndexes,
+   const FractionalDataType * const * const modelFeatureCombinationTensors,
+   const IntegerDataType countInstances,
+   const IntegerDataType * const binnedData,
+   const FractionalDataType * const cuts,
+   const FractionalDataType * const values,
+   const bool bProbabilities,
+   FractionalDataType * const predictorScores
+) {
+   EBM_ASSERT(0 <= countFeatures);
+   EBM_ASSERT(0 == countFeatures || nullptr != features);
+   EBM_ASSERT(0 <= countFeatureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != featureCombinations);
+   EBM_ASSERT(0 == countFeatureCombinations || nullptr != modelFeatureCombinationTensors);
+   // featureCombinationIndexes can be nullptr if all our feature combinations are empty
+   EBM_ASSERT(0 <= countInstances);
+   // values is nullptr if our caller binned the data, and binnedData is nullptr if we bin the values ourselves
+   EBM_ASSERT(nullptr == binnedData || nullptr == values);
+   EBM_ASSERT(0 == countInstances || 0 == countFeatures || nullptr != binnedData || nullptr != values);
+   EBM_ASSERT(0 == countInstances || nullptr != predictorScores);
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return 1;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   const size_t cInstances = static_cast<size_t>(countInstances);
+
+   if(0 == cInstances) {
+      LOG_0(TraceLevelInfo, "INFO PredictBatchCore zero instances");
+      return 0;
+   }
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+
+   // first pass: validate everything and count the dimensions that we need to keep
+   size_t cDimensionsTotal = 0;
+   const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const IntegerDataType countFeaturesInCombination = featureCombinations[iFeatureCombination].countFeaturesInCombination;
+      EBM_ASSERT(0 <= countFeaturesInCombination);
+      if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+         LOG_0(TraceLevelWarning, "WARNING PredictBatchCore !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
+         return 1;
+      }
+      const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+      EBM_ASSERT(0 == cFeaturesInCombination || nullptr != pFeatureCombinationIndex);
+      EBM_ASSERT(nullptr != modelFeatureCombinationTensors[iFeatureCombination]);
+
+      size_t cSignificantFeaturesInCombination = 0;
+      size_t cTensorBins = 1;
+      const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
+      for(; pFeatureCombinationIndexEnd != pFeatureCombinationIndex; ++pFeatureCombinationIndex) {
+         const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndex;
+         if(indexFeatureInterop < 0 || cFeatures <= static_cast<size_t>(indexFeatureInterop)) {
+            LOG_0(TraceLevelError, "ERROR PredictBatchCore featureCombinationIndexes value must be a valid feature index");
+            return 1;
+         }
+         const IntegerDataType countBins = features[static_cast<size_t>(indexFeatureInterop)].countBins;
+         EBM_ASSERT(0 <= countBins);
+         if(!IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+            LOG_0(TraceLevelWarning, "WARNING PredictBatchCore !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
+            return 1;
+         }
+         const size_t cBins = static_cast<size_t>(countBins);
+         if(0 == cBins) {
+            LOG_0(TraceLevelError, "ERROR PredictBatchCore a feature can't have zero bins if there are instances");
+            return 1;
+         }
+         if(LIKELY(1 < cBins)) {
+            ++cSignificantFeaturesInCombination;
+            if(IsMultiplyError(cTensorBins, cBins)) {
+               LOG_0(TraceLevelWarning, "WARNING PredictBatchCore IsMultiplyError(cTensorBins, cBins)");
+               return 1;
+            }
+            cTensorBins *= cBins;
+         }
+      }
+      if(IsMultiplyError(cTensorBins, cVectorLength)) {
+         LOG_0(TraceLevelWarning, "WARNING PredictBatchCore IsMultiplyError(cTensorBins, cVectorLength)");
+         return 1;
+      }
+      cDimensionsTotal += cSignificantFeaturesInCombination;
+   }
+
+   if(IsMultiplyError(sizeof(PredictionTerm), cFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore IsMultiplyError(sizeof(PredictionTerm), cFeatureCombinations)");
+      return 1;
+   }
+   PredictionTerm * const aTerms = 0 == cFeatureCombinations ? nullptr : static_cast<PredictionTerm *>(malloc(sizeof(PredictionTerm) * cFeatureCombinations));
+   if(UNLIKELY(0 != cFeatureCombinations && nullptr == aTerms)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore nullptr == aTerms");
+      return 1;
+   }
+   // the total number of dimensions can't exceed the length of featureCombinationIndexes, so this multiplication can't overflow
+   PredictionDimension * const aDimensions = 0 == cDimensionsTotal ? nullptr : static_cast<PredictionDimension *>(malloc(sizeof(PredictionDimension) * cDimensionsTotal));
+   if(UNLIKELY(0 != cDimensionsTotal && nullptr == aDimensions)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchCore nullptr == aDimensions");
+      free(aTerms);
+      return 1;
+   }
+
+   PredictionRawFeature * aRawFeatures = nullptr;
+   size_t * aiRawFeatures = nullptr;
+   IntegerDataType * aBinnedBlocks = nullptr;
+   const size_t cInstancesBlockMax = cInstances < k_cInstancesPerPredictionBlock ? cInstances : k_cInstancesPerPredictionBlock;
+   if(nullptr != values && 0 != cDimensionsTotal) {
+      // a feature can't be binned more times than it appears in a dimension, so cDimensionsTotal bounds the number of features that we bin.  We size our
+      // blocks to the instances that we have so that scoring a single instance stays cheap
+      if(IsMultiplyError(cDimensionsTotal, cInstancesBlockMax) || IsMultiplyError(sizeof(IntegerDataType), cDimensionsTotal * cInstancesBlockMax)) {
+         LOG_0(TraceLevelWarning, "WARNING PredictBatchCore IsMultiplyError(sizeof(IntegerDataType), cDimensionsTotal * cInstancesBlockMax)");
+         free(aDimensions);
+         free(aTerms);
+         return 1;
+      }
+      aRawFeatures = static_cast<PredictionRawFeature *>(malloc(sizeof(PredictionRawFeature) * cDimensionsTotal));
+      // EbmCoreFeature is larger than 2 size_t values and our caller allocated cFeatures of them, so this can't overflow
+      aiRawFeatures = static_cast<size_t *>(malloc(sizeof(size_t) * 2 * cFeatures));
+      aBinnedBlocks = static_cast<IntegerDataType *>(malloc(sizeof(IntegerDataType) * cDimensionsTotal * cInstancesBlockMax));
+      if(UNLIKELY(nullptr == aRawFeatures || nullptr == aiRawFeatures || nullptr == aBinnedBlocks)) {
+         LOG_0(TraceLevelWarning, "WARNING PredictBatchCore nullptr == aRawFeatures || nullptr == aiRawFeatures || nullptr == aBinnedBlocks");
+         free(aBinnedBlocks);
+         free(aiRawFeatures);
+         free(aRawFeatures);
+         free(aDimensions);
+         free(aTerms);
+         return 1;
+      }
+      // the first half holds the index of each feature's PredictionRawFeature, where cFeatures marks the features that no dimension has needed yet.  The
+      // second half holds the index of each feature's first cut
+      size_t cCutsTotal = 0;
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         aiRawFeatures[iFeature] = cFeatures;
+         aiRawFeatures[cFeatures + iFeature] = cCutsTotal;
+         const IntegerDataType countBins = features[iFeature].countBins;
+         // the cuts are in memory that our caller allocated, so their total can't overflow
+         cCutsTotal += countBins <= 0 ? size_t { 0 } : GetCountCuts(static_cast<size_t>(countBins));
+      }
+      EBM_ASSERT(0 == cCutsTotal || nullptr != cuts);
+   }
+
+   // second pass: everything is valid, so fill in our terms
+   size_t cRawFeatures = 0;
+   PredictionDimension * pDimension = aDimensions;
+   pFeatureCombinationIndex = featureCombinationIndexes;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const size_t cFeaturesInCombination = static_cast<size_t>(featureCombinations[iFeatureCombination].countFeaturesInCombination);
+      PredictionTerm * const pTerm = &aTerms[iFeatureCombination];
+      pTerm->m_aDimensions = pDimension;
+      pTerm->m_aValues = modelFeatureCombinationTensors[iFeatureCombination];
+      const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
+      for(; pFeatureCombinationIndexEnd != pFeatureCombinationIndex; ++pFeatureCombinationIndex) {
+         const size_t iFeature = static_cast<size_t>(*pFeatureCombinationIndex);
+         EBM_ASSERT(iFeature < cFeatures);
+         const size_t cBins = static_cast<size_t>(features[iFeature].countBins);
+         if(LIKELY(1 < cBins)) {
+            if(nullptr == aRawFeatures) {
+               pDimension->m_aInputData = &binnedData[iFeature * cInstances];
+            } else {
+               if(cFeatures == aiRawFeatures[iFeature]) {
+                  // this is the first dimension that needs this feature
+                  PredictionRawFeature * const pRawFeature = &aRawFeatures[cRawFeatures];
+                  pRawFeature->m_aValues = &values[iFeature * cInstances];
+                  pRawFeature->m_aCuts = &cuts[aiRawFeatures[cFeatures + iFeature]];
+                  pRawFeature->m_cCuts = GetCountCuts(cBins);
+                  pRawFeature->m_aBinnedBlock = &aBinnedBlocks[cRawFeatures * cInstancesBlockMax];
+                  aiRawFeatures[iFeature] = cRawFeatures;
+                  ++cRawFeatures;
+               }
+               pDimension->m_aInputData = aRawFeatures[aiRawFeatures[iFeature]].m_aBinnedBlock;
+            }
+            pDimension->m_cBins = cBins;
+            ++pDimension;
+         }
+      }
+      pTerm->m_cDimensions = static_cast<size_t>(pDimension - pTerm->m_aDimensions);
+   }
+   EBM_ASSERT(aDimensions + cDimensionsTotal == pDimension);
+   EBM_ASSERT(cRawFeatures <= cDimensionsTotal);
+
+   if(IsRegression(runtimeLearningTypeOrCountTargetClasses)) {
+      PredictBatchPerTargetClasses<k_Regression>(runtimeLearningTypeOrCountTargetClasses, cFeatureCombinations, aTerms, cRawFeatures, aRawFeatures, cInstances, false, predictorScores);
+   } else {
+      EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+      CompilerRecursivePredictBatch<2>(runtimeLearningTypeOrCountTargetClasses, cFeatureCombinations, aTerms, cRawFeatures, aRawFeatures, cInstances, bProbabilities, predictorScores);
+   }
+
+   free(aBinnedBlocks);
+   free(aiRawFeatures);
+   free(aRawFeatures);
+   free(aDimensions);
+   free(aTerms);
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countInstances,
+   const IntegerDataType * binnedData,
+   FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered PredictBatchRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, countInstances=%" IntegerDataTypePrintf ", binnedData=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), countInstances, static_cast<const void *>(binnedData), static_cast<void *>(predictorScores));
+   const IntegerDataType ret = PredictBatchCore(k_Regression, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, countInstances, binnedData, nullptr, nullptr, false, predictorScores);
+   LOG_N(TraceLevelInfo, "Exited PredictBatchRegression %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * binnedData,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered PredictBatchClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", binnedData=%p, returnProbabilities=%" IntegerDataTypePrintf ", predictorScores=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), countTargetClasses, countInstances, static_cast<const void *>(binnedData), returnProbabilities, static_cast<void *>(predictorScores));
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR PredictBatchClassification countTargetClasses can't be negative");
+      return 1;
+   }
+   if(0 == countTargetClasses && 0 != countInstances) {
+      LOG_0(TraceLevelError, "ERROR PredictBatchClassification countTargetClasses can't be zero unless there are no instances");
+      return 1;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return 1;
+   }
+   if(countTargetClasses <= 1) {
+      // with only 1 target class there are no logits (GetBestModelFeatureCombination returns nullptr), and every instance is 100% that class
+      LOG_0(TraceLevelInfo, "INFO PredictBatchClassification target with 0/1 classes");
+      return 0;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const IntegerDataType ret = PredictBatchCore(runtimeLearningTypeOrCountTargetClasses, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, countInstances, binnedData, nullptr, nullptr, 0 != returnProbabilities, predictorScores);
+   LOG_N(TraceLevelInfo, "Exited PredictBatchClassification %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchRegressionValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countInstances,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values,
+   FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered PredictBatchRegressionValues: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, countInstances=%" IntegerDataTypePrintf ", cuts=%p, values=%p, predictorScores=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), countInstances, static_cast<const void *>(cuts), static_cast<const void *>(values), static_cast<void *>(predictorScores));
+   const IntegerDataType ret = PredictBatchCore(k_Regression, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, countInstances, nullptr, cuts, values, false, predictorScores);
+   LOG_N(TraceLevelInfo, "Exited PredictBatchRegressionValues %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchClassificationValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered PredictBatchClassificationValues: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, countTargetClasses=%" IntegerDataTypePrintf ", countInstances=%" IntegerDataTypePrintf ", cuts=%p, values=%p, returnProbabilities=%" IntegerDataTypePrintf ", predictorScores=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), countTargetClasses, countInstances, static_cast<const void *>(cuts), static_cast<const void *>(values), returnProbabilities, static_cast<void *>(predictorScores));
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR PredictBatchClassificationValues countTargetClasses can't be negative");
+      return 1;
+   }
+   if(0 == countTargetClasses && 0 != countInstances) {
+      LOG_0(TraceLevelError, "ERROR PredictBatchClassificationValues countTargetClasses can't be zero unless there are no instances");
+      return 1;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictBatchClassificationValues !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return 1;
+   }
+   if(countTargetClasses <= 1) {
+      // with only 1 target class there are no logits (GetBestModelFeatureCombination returns nullptr), and every instance is 100% that class
+      LOG_0(TraceLevelInfo, "INFO PredictBatchClassificationValues target with 0/1 classes");
+      return 0;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const IntegerDataType ret = PredictBatchCore(runtimeLearningTypeOrCountTargetClasses, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, countInstances, nullptr, cuts, values, 0 != returnProbabilities, predictorScores);
+   LOG_N(TraceLevelInfo, "Exited PredictBatchClassificationValues %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+// A model file starts with a ModelFileHeader that is followed by these sections in order:
+//   EbmCoreFeature[m_cFeatures]
+//   EbmCoreFeatureCombination[m_cFeatureCombinations]
+//   IntegerDataType featureCombinationIndexes[], which holds countFeaturesInCombination indexes for each feature combination
+//   FractionalDataType cuts[], which holds countBins - 1 cuts for each feature in the format that PredictBatchRegressionValues takes them
+//   FractionalDataType intercept[cVectorLength]
+//   the tensor of each feature combination in the format that GetBestModelFeatureCombination returns
+// Every section starts on a multiple of 8 bytes and every tensor starts on a new cache line, so the small tensors of single feature terms don't straddle
+// cache lines.  The mapping starts on a page boundary, so everything stays aligned when we use it in place.  Opening a model only reads the sections in
+// front of the tensors and then points at the tensors within the mapping, so every process that maps the same file shares one page cached copy of the
+// tensors.  Like data set files, we write in the byte order of the machine that we run on and refuse to open files with a different byte order
+constexpr char k_modelFileMagic[8] = { 'E', 'B', 'M', 'M', 'O', 'D', 'E', 'L' };
+constexpr uint64_t k_modelFileVersion = 1;
+constexpr uint64_t k_modelFileByteOrderMark = uint64_t { 0x0102030405060708 };
+constexpr size_t k_cBytesModelFileAlignment = 8;
+constexpr size_t k_cBytesModelFileTensorAlignment = 64;
+
+struct ModelFileHeader final {
+   char m_magic[8];
+   uint64_t m_version;
+   uint64_t m_byteOrderMark;
+   int64_t m_runtimeLearningTypeOrCountTargetClasses;
+   uint64_t m_cFeatures;
+   uint64_t m_cFeatureCombinations;
+};
+
+static_assert(k_cBytesModelFileAlignment <= k_cBytesModelFileTensorAlignment, "our padding buffer needs to hold the padding for any section");
+
+// an open model file.  Everything except m_apTensors points into the mapping, so we never copy any part of the model
+struct EbmModel final {
+   MemoryMappedFile * m_pMemoryMappedFile;
+   ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+   size_t m_cFeatures;
+   const EbmCoreFeature * m_aFeatures;
+   size_t m_cFeatureCombinations;
+   const EbmCoreFeatureCombination * m_aFeatureCombinations;
+   const IntegerDataType * m_aFeatureCombinationIndexes;
+   const FractionalDataType * m_aCuts;
+   const FractionalDataType * m_aIntercept;
+   const FractionalDataType ** m_apTensors;
+};
+
+// classification with 0 or 1 target classes has no logits, so those models don't have an intercept or any tensors
+EBM_INLINE static size_t GetCountModelLogits(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+   return IsClassification(runtimeLearningTypeOrCountTargetClasses) && runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 } ? size_t { 0 } : GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+}
+
+EBM_INLINE static size_t GetCountBytesModelFilePadding(const size_t iByte, const size_t cBytesAlignment) {
+   return (cBytesAlignment - iByte % cBytesAlignment) % cBytesAlignment;
+}
+
+// returns a pointer to the cItems items that start at the next multiple of cBytesAlignment in the mapping, or nullptr if they run past the end of the file
+static const void * ReadModelFileSection(const MemoryMappedFile * const pMemoryMappedFile, size_t * const pcBytesConsumed, const size_t cItems, const size_t cBytesPerItem, const size_t cBytesAlignment) {
+   EBM_ASSERT(*pcBytesConsumed <= pMemoryMappedFile->GetCountBytes());
+   if(IsMultiplyError(cItems, cBytesPerItem)) {
+      LOG_0(TraceLevelWarning, "WARNING ReadModelFileSection IsMultiplyError(cItems, cBytesPerItem)");
+      return nullptr;
+   }
+   const size_t cBytes = cItems * cBytesPerItem;
+   const size_t cBytesPadding = GetCountBytesModelFilePadding(*pcBytesConsumed, cBytesAlignment);
+   const size_t cBytesRemaining = pMemoryMappedFile->GetCountBytes() - *pcBytesConsumed;
+   if(cBytesRemaining < cBytesPadding || cBytesRemaining - cBytesPadding < cBytes) {
+      LOG_0(TraceLevelWarning, "WARNING ReadModelFileSection the file is too short");
+      return nullptr;
+   }
+   const void * const pSection = static_cast<const char *>(pMemoryMappedFile->GetData()) + *pcBytesConsumed + cBytesPadding;
+   *pcBytesConsumed += cBytesPadding + cBytes;
+   return pSection;
+}
+
+static bool WriteModelFileSection(FILE * const pFile, size_t * const pcBytesWritten, const void * const pData, const size_t cBytes, const size_t cBytesAlignment) {
+   static constexpr char k_padding[k_cBytesModelFileTensorAlignment] = { 0 };
+   EBM_ASSERT(cBytesAlignment <= sizeof(k_padding));
+   const size_t cBytesPadding = GetCountBytesModelFilePadding(*pcBytesWritten, cBytesAlignment);
+   if(0 != cBytesPadding && cBytesPadding != fwrite(k_padding, 1, cBytesPadding, pFile)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteModelFileSection fwrite failed for the padding");
+      return true;
+   }
+   if(0 != cBytes && cBytes != fwrite(pData, 1, cBytes, pFile)) {
+      LOG_0(TraceLevelWarning, "WARNING WriteModelFileSection fwrite failed");
+      return true;
+   }
+   *pcBytesWritten += cBytesPadding + cBytes;
+   return false;
+}
+
+// the features and feature combinations come from our caller or from a file, so we check everything that PredictBatchCore or our sections rely on and
+// count the feature combination indexes and cuts that go with them.  Returns true if they're invalid
+static bool CountModelIndexesAndCuts(const size_t cFeatures, const EbmCoreFeature * const aFeatures, const size_t cFeatureCombinations, const EbmCoreFeatureCombination * const aFeatureCombinations, size_t * const pcFeatureCombinationIndexes, size_t * const pcCuts) {
+   size_t cCuts = 0;
+   for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+      const IntegerDataType countBins = aFeatures[iFeature].countBins;
+      if(countBins < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
+         LOG_0(TraceLevelWarning, "WARNING CountModelIndexesAndCuts bad countBins");
+         return true;
+      }
+      const size_t cCutsFeature = GetCountCuts(static_cast<size_t>(countBins));
+      if(IsAddError(cCuts, cCutsFeature)) {
+         LOG_0(TraceLevelWarning, "WARNING CountModelIndexesAndCuts IsAddError(cCuts, cCutsFeature)");
+         return true;
+      }
+      cCuts += cCutsFeature;
+   }
+   size_t cFeatureCombinationIndexes = 0;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const IntegerDataType countFeaturesInCombination = aFeatureCombinations[iFeatureCombination].countFeaturesInCombination;
+      if(countFeaturesInCombination < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
+         LOG_0(TraceLevelWarning, "WARNING CountModelIndexesAndCuts bad countFeaturesInCombination");
+         return true;
+      }
+      const size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
+      if(IsAddError(cFeatureCombinationIndexes, cFeaturesInCombination)) {
+         LOG_0(TraceLevelWarning, "WARNING CountModelIndexesAndCuts IsAddError(cFeatureCombinationIndexes, cFeaturesInCombination)");
+         return true;
+      }
+      cFeatureCombinationIndexes += cFeaturesInCombination;
+   }
+   *pcFeatureCombinationIndexes = cFeatureCombinationIndexes;
+   *pcCuts = cCuts;
+   return false;
+}
+
+// sets *pcTensorValues to the number of values in a feature combination's tensor.  Only the features with more than one bin add a dimension, just like
+// in the tensors that GetBestModelFeatureCombination returns.  Returns true if a feature index or the tensor size is invalid
+static bool GetCountModelTensorValues(const size_t cLogits, const size_t cFeatures, const EbmCoreFeature * const aFeatures, const size_t cFeaturesInCombination, const IntegerDataType * const aFeatureCombinationIndexes, size_t * const pcTensorValues) {
+   size_t cTensorValues = cLogits;
+   for(size_t iFeatureInCombination = 0; iFeatureInCombination < cFeaturesInCombination; ++iFeatureInCombination) {
+      const IntegerDataType indexFeatureInterop = aFeatureCombinationIndexes[iFeatureInCombination];
+      if(indexFeatureInterop < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop) || cFeatures <= static_cast<size_t>(indexFeatureInterop)) {
+         LOG_0(TraceLevelWarning, "WARNING GetCountModelTensorValues featureCombinationIndexes value must be a valid feature index");
+         return true;
+      }
+      // CountModelIndexesAndCuts checked that this is convertible
+      const size_t cBins = static_cast<size_t>(aFeatures[static_cast<size_t>(indexFeatureInterop)].countBins);
+      if(0 == cBins) {
+         LOG_0(TraceLevelWarning, "WARNING GetCountModelTensorValues a feature in a feature combination needs at least 1 bin");
+         return true;
+      }
+      if(IsMultiplyError(cTensorValues, cBins)) {
+         LOG_0(TraceLevelWarning, "WARNING GetCountModelTensorValues IsMultiplyError(cTensorValues, cBins)");
+         return true;
+      }
+      cTensorValues *= cBins;
+   }
+   if(IsMultiplyError(sizeof(FractionalDataType), cTensorValues)) {
+      LOG_0(TraceLevelWarning, "WARNING GetCountModelTensorValues IsMultiplyError(sizeof(FractionalDataType), cTensorValues)");
+      return true;
+   }
+   *pcTensorValues = cTensorValues;
+   return false;
+}
+
+static IntegerDataType SaveModel(
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses,
+   const IntegerDataType countFeatures,
+   const EbmCoreFeature * const features,
+   const IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * const featureCombinations,
+   const IntegerDataType * const featureCombinationIndexes,
+   const FractionalDataType * const * const modelFeatureCombinationTensors,
+   const FractionalDataType * const cuts,
+   const FractionalDataType * const intercept,
+   const char * const filePath
+) {
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatures)) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModel !IsNumberConvertable<size_t, IntegerDataType>(countFeatures)");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModel !IsNumberConvertable<size_t, IntegerDataType>(countFeatureCombinations)");
+      return 1;
+   }
+   if(nullptr == filePath) {
+      LOG_0(TraceLevelError, "ERROR SaveModel filePath cannot be nullptr");
+      return 1;
+   }
+   const size_t cFeatures = static_cast<size_t>(countFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
+   EBM_ASSERT(0 == cFeatures || nullptr != features);
+   EBM_ASSERT(0 == cFeatureCombinations || nullptr != featureCombinations);
+
+   size_t cFeatureCombinationIndexes;
+   size_t cCuts;
+   if(CountModelIndexesAndCuts(cFeatures, features, cFeatureCombinations, featureCombinations, &cFeatureCombinationIndexes, &cCuts)) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModel CountModelIndexesAndCuts");
+      return 1;
+   }
+   EBM_ASSERT(0 == cFeatureCombinationIndexes || nullptr != featureCombinationIndexes);
+   EBM_ASSERT(0 == cCuts || nullptr != cuts);
+   const size_t cLogits = GetCountModelLogits(runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(0 == cLogits || nullptr != intercept);
+   EBM_ASSERT(0 == cLogits || 0 == cFeatureCombinations || nullptr != modelFeatureCombinationTensors);
+
+   // check every tensor before we create the file so that we don't leave a partial file behind for bad inputs
+   const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+      const size_t cFeaturesInCombination = static_cast<size_t>(featureCombinations[iFeatureCombination].countFeaturesInCombination);
+      size_t cTensorValues;
+      if(GetCountModelTensorValues(cLogits, cFeatures, features, cFeaturesInCombination, pFeatureCombinationIndex, &cTensorValues)) {
+         LOG_0(TraceLevelWarning, "WARNING SaveModel GetCountModelTensorValues");
+         return 1;
+      }
+      pFeatureCombinationIndex += cFeaturesInCombination;
+   }
+
+   FILE * const pFile = fopen(filePath, "wb");
+   if(nullptr == pFile) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModel nullptr == pFile");
+      return 1;
+   }
+
+   ModelFileHeader header;
+   memcpy(header.m_magic, k_modelFileMagic, sizeof(header.m_magic));
+   header.m_version = k_modelFileVersion;
+   header.m_byteOrderMark = k_modelFileByteOrderMark;
+   header.m_runtimeLearningTypeOrCountTargetClasses = static_cast<int64_t>(runtimeLearningTypeOrCountTargetClasses);
+   header.m_cFeatures = static_cast<uint64_t>(cFeatures);
+   header.m_cFeatureCombinations = static_cast<uint64_t>(cFeatureCombinations);
+
+   // all of these sections are in our caller's memory, so their sizes can't overflow
+   size_t cBytesWritten = 0;
+   bool bError = WriteModelFileSection(pFile, &cBytesWritten, &header, sizeof(header), k_cBytesModelFileAlignment);
+   bError = bError || WriteModelFileSection(pFile, &cBytesWritten, features, sizeof(*features) * cFeatures, k_cBytesModelFileAlignment);
+   bError = bError || WriteModelFileSection(pFile, &cBytesWritten, featureCombinations, sizeof(*featureCombinations) * cFeatureCombinations, k_cBytesModelFileAlignment);
+   bError = bError || WriteModelFileSection(pFile, &cBytesWritten, featureCombinationIndexes, sizeof(*featureCombinationIndexes) * cFeatureCombinationIndexes, k_cBytesModelFileAlignment);
+   bError = bError || WriteModelFileSection(pFile, &cBytesWritten, cuts, sizeof(*cuts) * cCuts, k_cBytesModelFileAlignment);
+   if(0 != cLogits) {
+      bError = bError || WriteModelFileSection(pFile, &cBytesWritten, intercept, sizeof(*intercept) * cLogits, k_cBytesModelFileAlignment);
+      pFeatureCombinationIndex = featureCombinationIndexes;
+      for(size_t iFeatureCombination = 0; !bError && iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const size_t cFeaturesInCombination = static_cast<size_t>(featureCombinations[iFeatureCombination].countFeaturesInCombination);
+         size_t cTensorValues;
+         // we checked every tensor above
+         const bool bErrorTensor = GetCountModelTensorValues(cLogits, cFeatures, features, cFeaturesInCombination, pFeatureCombinationIndex, &cTensorValues);
+         EBM_ASSERT(!bErrorTensor);
+         UNUSED(bErrorTensor);
+         pFeatureCombinationIndex += cFeaturesInCombination;
+         EBM_ASSERT(nullptr != modelFeatureCombinationTensors[iFeatureCombination]);
+         bError = WriteModelFileSection(pFile, &cBytesWritten, modelFeatureCombinationTensors[iFeatureCombination], sizeof(FractionalDataType) * cTensorValues, k_cBytesModelFileTensorAlignment);
+      }
+   }
+
+   if(0 != fclose(pFile)) {
+      bError = true;
+   }
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModel failed to write the file");
+      return 1;
+   }
+   return 0;
+}
+
+static void FreeModelCore(EbmModel * const pEbmModel) {
+   free(pEbmModel->m_apTensors);
+   delete pEbmModel->m_pMemoryMappedFile;
+   free(pEbmModel);
+}
+
+static EbmModel * OpenModelCore(const char * const filePath) {
+   MemoryMappedFile * const pMemoryMappedFile = MemoryMappedFile::Open(filePath);
+   if(nullptr == pMemoryMappedFile) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore nullptr == pMemoryMappedFile");
+      return nullptr;
+   }
+   if(pMemoryMappedFile->GetCountBytes() < sizeof(ModelFileHeader)) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore the file is too short for the header");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const ModelFileHeader * const pHeader = static_cast<const ModelFileHeader *>(pMemoryMappedFile->GetData());
+   if(0 != memcmp(pHeader->m_magic, k_modelFileMagic, sizeof(pHeader->m_magic)) || k_modelFileVersion != pHeader->m_version || k_modelFileByteOrderMark != pHeader->m_byteOrderMark) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore this isn't a model file version that this machine can read");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const int64_t runtimeLearningTypeOrCountTargetClasses = pHeader->m_runtimeLearningTypeOrCountTargetClasses;
+   // PredictBatchCore takes our counts as IntegerDataType values
+   if(k_Regression != runtimeLearningTypeOrCountTargetClasses && runtimeLearningTypeOrCountTargetClasses < 0 || !IsNumberConvertable<ptrdiff_t, int64_t>(runtimeLearningTypeOrCountTargetClasses) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatures) || !IsNumberConvertable<IntegerDataType, uint64_t>(pHeader->m_cFeatures) || !IsNumberConvertable<size_t, uint64_t>(pHeader->m_cFeatureCombinations) || !IsNumberConvertable<IntegerDataType, uint64_t>(pHeader->m_cFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore bad header");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClassesCore = static_cast<ptrdiff_t>(runtimeLearningTypeOrCountTargetClasses);
+   const size_t cFeatures = static_cast<size_t>(pHeader->m_cFeatures);
+   const size_t cFeatureCombinations = static_cast<size_t>(pHeader->m_cFeatureCombinations);
+   const size_t cLogits = GetCountModelLogits(runtimeLearningTypeOrCountTargetClassesCore);
+
+   size_t cBytesConsumed = sizeof(*pHeader);
+   const EbmCoreFeature * const aFeatures = static_cast<const EbmCoreFeature *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cFeatures, sizeof(EbmCoreFeature), k_cBytesModelFileAlignment));
+   const EbmCoreFeatureCombination * const aFeatureCombinations = nullptr == aFeatures ? nullptr : static_cast<const EbmCoreFeatureCombination *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cFeatureCombinations, sizeof(EbmCoreFeatureCombination), k_cBytesModelFileAlignment));
+   size_t cFeatureCombinationIndexes;
+   size_t cCuts;
+   if(nullptr == aFeatureCombinations || CountModelIndexesAndCuts(cFeatures, aFeatures, cFeatureCombinations, aFeatureCombinations, &cFeatureCombinationIndexes, &cCuts)) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore bad features or feature combinations");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   const IntegerDataType * const aFeatureCombinationIndexes = static_cast<const IntegerDataType *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cFeatureCombinationIndexes, sizeof(IntegerDataType), k_cBytesModelFileAlignment));
+   const FractionalDataType * const aCuts = nullptr == aFeatureCombinationIndexes ? nullptr : static_cast<const FractionalDataType *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cCuts, sizeof(FractionalDataType), k_cBytesModelFileAlignment));
+   const FractionalDataType * const aIntercept = nullptr == aCuts ? nullptr : static_cast<const FractionalDataType *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cLogits, sizeof(FractionalDataType), k_cBytesModelFileAlignment));
+   if(nullptr == aIntercept) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore the file is too short for the features, feature combinations and intercept");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+
+   EbmModel * const pEbmModel = static_cast<EbmModel *>(malloc(sizeof(EbmModel)));
+   if(nullptr == pEbmModel) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore nullptr == pEbmModel");
+      delete pMemoryMappedFile;
+      return nullptr;
+   }
+   pEbmModel->m_pMemoryMappedFile = pMemoryMappedFile;
+   pEbmModel->m_runtimeLearningTypeOrCountTargetClasses = runtimeLearningTypeOrCountTargetClassesCore;
+   pEbmModel->m_cFeatures = cFeatures;
+   pEbmModel->m_aFeatures = aFeatures;
+   pEbmModel->m_cFeatureCombinations = cFeatureCombinations;
+   pEbmModel->m_aFeatureCombinations = aFeatureCombinations;
+   pEbmModel->m_aFeatureCombinationIndexes = aFeatureCombinationIndexes;
+   pEbmModel->m_aCuts = aCuts;
+   pEbmModel->m_aIntercept = aIntercept;
+   pEbmModel->m_apTensors = nullptr;
+
+   if(0 != cLogits && 0 != cFeatureCombinations) {
+      // the file holds an 8 byte EbmCoreFeatureCombination for each feature combination, so this can't overflow
+      EBM_ASSERT(!IsMultiplyError(sizeof(*pEbmModel->m_apTensors), cFeatureCombinations));
+      const FractionalDataType ** const apTensors = static_cast<const FractionalDataType **>(malloc(sizeof(*apTensors) * cFeatureCombinations));
+      if(nullptr == apTensors) {
+         LOG_0(TraceLevelWarning, "WARNING OpenModelCore nullptr == apTensors");
+         FreeModelCore(pEbmModel);
+         return nullptr;
+      }
+      pEbmModel->m_apTensors = apTensors;
+      const IntegerDataType * pFeatureCombinationIndex = aFeatureCombinationIndexes;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < cFeatureCombinations; ++iFeatureCombination) {
+         const size_t cFeaturesInCombination = static_cast<size_t>(aFeatureCombinations[iFeatureCombination].countFeaturesInCombination);
+         size_t cTensorValues;
+         if(GetCountModelTensorValues(cLogits, cFeatures, aFeatures, cFeaturesInCombination, pFeatureCombinationIndex, &cTensorValues)) {
+            LOG_0(TraceLevelWarning, "WARNING OpenModelCore GetCountModelTensorValues");
+            FreeModelCore(pEbmModel);
+            return nullptr;
+         }
+         pFeatureCombinationIndex += cFeaturesInCombination;
+         // we point at the tensor without touching it, so its pages aren't read until prediction needs them
+         const FractionalDataType * const aTensor = static_cast<const FractionalDataType *>(ReadModelFileSection(pMemoryMappedFile, &cBytesConsumed, cTensorValues, sizeof(FractionalDataType), k_cBytesModelFileTensorAlignment));
+         if(nullptr == aTensor) {
+            LOG_0(TraceLevelWarning, "WARNING OpenModelCore the file is too short for the tensors");
+            FreeModelCore(pEbmModel);
+            return nullptr;
+         }
+         apTensors[iFeatureCombination] = aTensor;
+      }
+   }
+   if(pMemoryMappedFile->GetCountBytes() != cBytesConsumed) {
+      LOG_0(TraceLevelWarning, "WARNING OpenModelCore the file is longer than its contents");
+      FreeModelCore(pEbmModel);
+      return nullptr;
+   }
+   return pEbmModel;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SaveModelRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   const FractionalDataType * cuts,
+   const FractionalDataType * intercept,
+   const char * filePath
+) {
+   LOG_N(TraceLevelInfo, "Entered SaveModelRegression: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, cuts=%p, intercept=%p, filePath=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), static_cast<const void *>(cuts), static_cast<const void *>(intercept), static_cast<const void *>(filePath));
+   const IntegerDataType ret = SaveModel(k_Regression, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, cuts, intercept, filePath);
+   LOG_N(TraceLevelInfo, "Exited SaveModelRegression %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SaveModelClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   const FractionalDataType * cuts,
+   const FractionalDataType * intercept,
+   const char * filePath
+) {
+   LOG_N(TraceLevelInfo, "Entered SaveModelClassification: countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, modelFeatureCombinationTensors=%p, countTargetClasses=%" IntegerDataTypePrintf ", cuts=%p, intercept=%p, filePath=%p", countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), static_cast<const void *>(modelFeatureCombinationTensors), countTargetClasses, static_cast<const void *>(cuts), static_cast<const void *>(intercept), static_cast<const void *>(filePath));
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR SaveModelClassification countTargetClasses can't be negative");
+      return 1;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING SaveModelClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return 1;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const IntegerDataType ret = SaveModel(runtimeLearningTypeOrCountTargetClasses, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, modelFeatureCombinationTensors, cuts, intercept, filePath);
+   LOG_N(TraceLevelInfo, "Exited SaveModelClassification %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmModel EBMCORE_CALLING_CONVENTION OpenModel(
+   const char * filePath
+) {
+   LOG_N(TraceLevelInfo, "Entered OpenModel: filePath=%p", static_cast<const void *>(filePath));
+   if(nullptr == filePath) {
+      LOG_0(TraceLevelError, "ERROR OpenModel filePath cannot be nullptr");
+      return nullptr;
+   }
+   const PEbmModel pEbmModel = reinterpret_cast<PEbmModel>(OpenModelCore(filePath));
+   LOG_N(TraceLevelInfo, "Exited OpenModel %p", static_cast<void *>(pEbmModel));
+   return pEbmModel;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetModelCountFeatures(
+   PEbmModel ebmModel
+) {
+   const EbmModel * const pEbmModel = reinterpret_cast<const EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+   // OpenModelCore checked that this fits
+   return static_cast<IntegerDataType>(pEbmModel->m_cFeatures);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetModelCountTargetClasses(
+   PEbmModel ebmModel
+) {
+   const EbmModel * const pEbmModel = reinterpret_cast<const EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+   return static_cast<IntegerDataType>(pEbmModel->m_runtimeLearningTypeOrCountTargetClasses);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION PredictModel(
+   PEbmModel ebmModel,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+) {
+   LOG_N(TraceLevelInfo, "Entered PredictModel: ebmModel=%p, countInstances=%" IntegerDataTypePrintf ", values=%p, returnProbabilities=%" IntegerDataTypePrintf ", predictorScores=%p", static_cast<void *>(ebmModel), countInstances, static_cast<const void *>(values), returnProbabilities, static_cast<void *>(predictorScores));
+   const EbmModel * const pEbmModel = reinterpret_cast<const EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstances)) {
+      LOG_0(TraceLevelWarning, "WARNING PredictModel !IsNumberConvertable<size_t, IntegerDataType>(countInstances)");
+      return 1;
+   }
+   const size_t cInstances = static_cast<size_t>(countInstances);
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pEbmModel->m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t cLogits = GetCountModelLogits(runtimeLearningTypeOrCountTargetClasses);
+   if(0 == cLogits) {
+      // with only 1 target class there are no logits, and every instance is 100% that class
+      LOG_0(TraceLevelInfo, "INFO PredictModel target with 0/1 classes");
+      return 0;
+   }
+   EBM_ASSERT(0 == cInstances || nullptr != predictorScores);
+
+   // the model holds the intercept, so we start every instance from it instead of asking our caller to.  predictorScores is in our caller's memory, so
+   // its size can't overflow
+   FractionalDataType * pPredictorScores = predictorScores;
+   const FractionalDataType * const aIntercept = pEbmModel->m_aIntercept;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      for(size_t iLogit = 0; iLogit < cLogits; ++iLogit) {
+         pPredictorScores[iLogit] = aIntercept[iLogit];
+      }
+      pPredictorScores += cLogits;
+   }
+
+   // OpenModelCore checked that our counts fit into IntegerDataType
+   const IntegerDataType ret = PredictBatchCore(
+      runtimeLearningTypeOrCountTargetClasses,
+      static_cast<IntegerDataType>(pEbmModel->m_cFeatures),
+      pEbmModel->m_aFeatures,
+      static_cast<IntegerDataType>(pEbmModel->m_cFeatureCombinations),
+      pEbmModel->m_aFeatureCombinations,
+      pEbmModel->m_aFeatureCombinationIndexes,
+      pEbmModel->m_apTensors,
+      countInstances,
+      nullptr,
+      pEbmModel->m_aCuts,
+      values,
+      IsClassification(runtimeLearningTypeOrCountTargetClasses) && 0 != returnProbabilities,
+      predictorScores
+   );
+   LOG_N(TraceLevelInfo, "Exited PredictModel %" IntegerDataTypePrintf, ret);
+   return ret;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeModel(
+   PEbmModel ebmModel
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeModel: ebmModel=%p", static_cast<void *>(ebmModel));
+   EbmModel * const pEbmModel = reinterpret_cast<EbmModel *>(ebmModel);
+   EBM_ASSERT(nullptr != pEbmModel);
+   FreeModelCore(pEbmModel);
+   LOG_0(TraceLevelInfo, "Exited FreeModel");
+}
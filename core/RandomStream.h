@@ -5,26 +5,121 @@
 #ifndef RANDOM_STREAM_H
 #define RANDOM_STREAM_H
 
-#include <inttypes.h> // uint32_t seed
-#include <random>
+#include <inttypes.h> // uint64_t
 #include <stddef.h> // size_t, ptrdiff_t
 
 #include "ebmcore.h" // IntegerDataType
 #include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
 
+// RandomStream is xoshiro256** (Blackman & Vigna) seeded through splitmix64, with Lemire's multiply-shift method for bounded integers.  Unlike
+// std::default_random_engine and std::uniform_int_distribution, every step here is fully specified, so we generate identical streams on every
+// compiler and operating system, and therefore identical training results on Windows, Linux and Mac.  Jump advances the stream by 2^128 values, which
+// gives each sampling set (or thread) its own non-overlapping stream that doesn't depend on the order in which the streams are consumed
 class RandomStream final {
-   std::default_random_engine m_randomGenerator;
+   uint64_t m_state0;
+   uint64_t m_state1;
+   uint64_t m_state2;
+   uint64_t m_state3;
+
+   EBM_INLINE static uint64_t RotateLeft(const uint64_t value, const int cBits) {
+      return (value << cBits) | (value >> (64 - cBits));
+   }
+
+   EBM_INLINE static uint64_t SplitMix64(uint64_t * const pState) {
+      uint64_t result = (*pState += uint64_t { 0x9E3779B97F4A7C15 });
+      result = (result ^ (result >> 30)) * uint64_t { 0xBF58476D1CE4E5B9 };
+      result = (result ^ (result >> 27)) * uint64_t { 0x94D049BB133111EB };
+      return result ^ (result >> 31);
+   }
+
+   // returns the high 64 bits and puts the low 64 bits of the 128 bit product into *pLow
+   EBM_INLINE static uint64_t MultiplyHighLow(const uint64_t a, const uint64_t b, uint64_t * const pLow) {
+#ifdef __SIZEOF_INT128__
+      const unsigned __int128 product = static_cast<unsigned __int128>(a) * static_cast<unsigned __int128>(b);
+      *pLow = static_cast<uint64_t>(product);
+      return static_cast<uint64_t>(product >> 64);
+#else // __SIZEOF_INT128__
+      // MSVC and 32 bit compilers don't have a 128 bit type, so build the product from 32 bit halves.  The result is identical
+      const uint64_t aLow = a & uint64_t { 0xFFFFFFFF };
+      const uint64_t aHigh = a >> 32;
+      const uint64_t bLow = b & uint64_t { 0xFFFFFFFF };
+      const uint64_t bHigh = b >> 32;
+      const uint64_t lowLow = aLow * bLow;
+      const uint64_t highLow = aHigh * bLow;
+      const uint64_t lowHigh = aLow * bHigh;
+      const uint64_t highHigh = aHigh * bHigh;
+      const uint64_t middle = (lowLow >> 32) + (highLow & uint64_t { 0xFFFFFFFF }) + lowHigh;
+      *pLow = (middle << 32) | (lowLow & uint64_t { 0xFFFFFFFF });
+      return highHigh + (highLow >> 32) + (middle >> 32);
+#endif // __SIZEOF_INT128__
+   }
 
 public:
-   EBM_INLINE RandomStream(const IntegerDataType seed)
-      : m_randomGenerator(static_cast<unsigned int>(seed)) /* initializing default_random_engine doesn't have official nothrow properties, but a random number generator should not have to throw */ {
-      // TODO : change this to use the AES instruction set, which would ensure compatibility between languages and it would only take 2-3 clock cycles (although we'd still probably need to div [can we multiply instead] which is expensive).
+   EBM_INLINE RandomStream(const IntegerDataType seed) {
+      uint64_t splitMixState = static_cast<uint64_t>(seed);
+      m_state0 = SplitMix64(&splitMixState);
+      m_state1 = SplitMix64(&splitMixState);
+      m_state2 = SplitMix64(&splitMixState);
+      m_state3 = SplitMix64(&splitMixState);
+      // splitmix64 maps distinct counters to distinct outputs, so at most one of these can be zero.  The all zero state is the one that xoshiro256** can't leave
+      EBM_ASSERT(0 != m_state0 || 0 != m_state1 || 0 != m_state2 || 0 != m_state3);
+   }
+
+   EBM_INLINE uint64_t NextUInt64() {
+      const uint64_t result = RotateLeft(m_state1 * 5, 7) * 9;
+      const uint64_t shifted = m_state1 << 17;
+      m_state2 ^= m_state0;
+      m_state3 ^= m_state1;
+      m_state1 ^= m_state2;
+      m_state0 ^= m_state3;
+      m_state2 ^= shifted;
+      m_state3 = RotateLeft(m_state3, 45);
+      return result;
+   }
+
+   // advances this stream by 2^128 calls to NextUInt64
+   EBM_INLINE void Jump() {
+      static constexpr uint64_t k_jump[] = { uint64_t { 0x180EC6D33CFD0ABA }, uint64_t { 0xD5A61266F0C9392C }, uint64_t { 0xA9582618E03FC9AA }, uint64_t { 0x39ABDC4529B1661C } };
+      uint64_t state0 = 0;
+      uint64_t state1 = 0;
+      uint64_t state2 = 0;
+      uint64_t state3 = 0;
+      for(size_t iJump = 0; iJump < sizeof(k_jump) / sizeof(k_jump[0]); ++iJump) {
+         for(int iBit = 0; iBit < 64; ++iBit) {
+            if(0 != (k_jump[iJump] & (uint64_t { 1 } << iBit))) {
+               state0 ^= m_state0;
+               state1 ^= m_state1;
+               state2 ^= m_state2;
+               state3 ^= m_state3;
+            }
+            NextUInt64();
+         }
+      }
+      m_state0 = state0;
+      m_state1 = state1;
+      m_state2 = state2;
+      m_state3 = state3;
    }
 
    EBM_INLINE size_t Next(const size_t minValueInclusive, const size_t maxValueInclusive) {
-      // initializing uniform_int_distribution doesn't have official nothrow properties, but a random number generator should not have to throw
-      std::uniform_int_distribution<size_t> distribution(minValueInclusive, maxValueInclusive);
-      return distribution(m_randomGenerator);
+      EBM_ASSERT(minValueInclusive <= maxValueInclusive);
+      const uint64_t cValues = static_cast<uint64_t>(maxValueInclusive - minValueInclusive) + 1;
+      if(UNLIKELY(0 == cValues)) {
+         // the range covers every 64 bit value
+         return static_cast<size_t>(NextUInt64());
+      }
+      // Lemire's nearly divisionless method.  The high half of random * cValues is uniform in [0, cValues) once we reject the few low halves that
+      // would bias it, and we only need the division to find the rejection threshold in the rare case that we might need to reject
+      uint64_t low;
+      uint64_t high = MultiplyHighLow(NextUInt64(), cValues, &low);
+      if(UNLIKELY(low < cValues)) {
+         const uint64_t threshold = (uint64_t { 0 } - cValues) % cValues;
+         while(low < threshold) {
+            high = MultiplyHighLow(NextUInt64(), cValues, &low);
+         }
+      }
+      return minValueInclusive + static_cast<size_t>(high);
    }
 
    EBM_INLINE size_t Next(const size_t maxValueInclusive) {
@@ -32,4 +127,4 @@ public:
    }
 };
 
-#endif // RANDOM_STREAM_H
\ No newline at end of file
+#endif // RANDOM_STREAM_H
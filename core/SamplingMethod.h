@@ -0,0 +1,57 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SAMPLING_METHOD_H
+#define SAMPLING_METHOD_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+class DataSetByFeatureCombination;
+
+// the binning loops are templated and need to choose their inner loop without a virtual call per instance, so each SamplingMethod records what it is
+enum class SamplingMethodType { WithReplacement = 0, WithoutReplacement = 1 };
+
+class SamplingMethod {
+public:
+   const DataSetByFeatureCombination * const m_pOriginDataSet;
+   const SamplingMethodType m_samplingMethodType;
+
+   // the totals over every occurrence in this sampling set of the true residuals, instance weights (occurrence counts if unweighted) and occurrence
+   // counts.  We only keep these when our origin dataset has sparse columns, where binning derives each dominant bin's bucket from them
+   FractionalDataType m_sumResidualErrorTotal;
+   FractionalDataType m_weightTotal;
+   size_t m_cOccurrencesTotal;
+
+   EBM_INLINE SamplingMethod(const DataSetByFeatureCombination * const pOriginDataSet, const SamplingMethodType samplingMethodType)
+      : m_pOriginDataSet(pOriginDataSet)
+      , m_samplingMethodType(samplingMethodType)
+      , m_sumResidualErrorTotal(0)
+      , m_weightTotal(0)
+      , m_cOccurrencesTotal(0) {
+      EBM_ASSERT(nullptr != pOriginDataSet);
+   }
+
+   virtual ~SamplingMethod() {
+   }
+
+   virtual size_t GetTotalCountInstanceOccurrences() const = 0;
+
+   EBM_INLINE static void FreeSamplingSets(const size_t cSamplingSets, SamplingMethod ** apSamplingSets) {
+      LOG_0(TraceLevelInfo, "Entered SamplingMethod::FreeSamplingSets");
+      if(LIKELY(nullptr != apSamplingSets)) {
+         const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
+         for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+            delete apSamplingSets[iSamplingSet];
+         }
+         delete[] apSamplingSets;
+      }
+      LOG_0(TraceLevelInfo, "Exited SamplingMethod::FreeSamplingSets");
+   }
+};
+
+#endif // SAMPLING_METHOD_H
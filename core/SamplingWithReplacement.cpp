@@ -17,6 +17,7 @@
 SamplingWithReplacement::~SamplingWithReplacement() {
    LOG_0(TraceLevelInfo, "Entered ~SamplingWithReplacement");
    free(const_cast<size_t *>(m_aCountOccurrences));
+   free(m_aWeightedCountOccurrences);
    LOG_0(TraceLevelInfo, "Exited ~SamplingWithReplacement");
 }
 
@@ -33,6 +34,35 @@ size_t SamplingWithReplacement::GetTotalCountInstanceOccurrences() const {
    return cTotalCountInstanceOccurrences;
 }
 
+bool SamplingWithReplacement::FoldWeights() {
+   LOG_0(TraceLevelInfo, "Entered SamplingWithReplacement::FoldWeights");
+
+   free(m_aWeightedCountOccurrences);
+   m_aWeightedCountOccurrences = nullptr;
+
+   const FractionalDataType * const aWeights = m_pOriginDataSet->GetWeights();
+   if(nullptr != aWeights) {
+      const size_t cInstances = m_pOriginDataSet->GetCountInstances();
+      EBM_ASSERT(0 < cInstances);
+      if(IsMultiplyError(sizeof(FractionalDataType), cInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::FoldWeights IsMultiplyError(sizeof(FractionalDataType), cInstances)");
+         return true;
+      }
+      FractionalDataType * const aWeightedCountOccurrences = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cInstances));
+      if(nullptr == aWeightedCountOccurrences) {
+         LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::FoldWeights nullptr == aWeightedCountOccurrences");
+         return true;
+      }
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         aWeightedCountOccurrences[iInstance] = static_cast<FractionalDataType>(m_aCountOccurrences[iInstance]) * aWeights[iInstance];
+      }
+      m_aWeightedCountOccurrences = aWeightedCountOccurrences;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited SamplingWithReplacement::FoldWeights");
+   return false;
+}
+
 SamplingWithReplacement * SamplingWithReplacement::GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet) {
    LOG_0(TraceLevelVerbose, "Entered SamplingWithReplacement::GenerateSingleSamplingSet");
 
@@ -55,16 +85,9 @@ SamplingWithReplacement * SamplingWithReplacement::GenerateSingleSamplingSet(Ran
 
    memset(aCountOccurrences, 0, cBytesData);
 
-   try {
-      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
-         const size_t iCountOccurrences = pRandomStream->Next(size_t { 0 }, cInstances - 1);
-         ++aCountOccurrences[iCountOccurrences];
-      }
-   } catch(...) {
-      // Next could in theory throw an exception
-      LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSingleSamplingSet exception");
-      free(aCountOccurrences);
-      return nullptr;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      const size_t iCountOccurrences = pRandomStream->Next(size_t { 0 }, cInstances - 1);
+      ++aCountOccurrences[iCountOccurrences];
    }
 
    SamplingWithReplacement * pRet = new (std::nothrow) SamplingWithReplacement(pOriginDataSet, aCountOccurrences);
@@ -107,18 +130,6 @@ SamplingWithReplacement * SamplingWithReplacement::GenerateFlatSamplingSet(const
    return pRet;
 }
 
-void SamplingWithReplacement::FreeSamplingSets(const size_t cSamplingSets, SamplingMethod ** apSamplingSets) {
-   LOG_0(TraceLevelInfo, "Entered SamplingWithReplacement::FreeSamplingSets");
-   if(LIKELY(nullptr != apSamplingSets)) {
-      const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
-      for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
-         delete apSamplingSets[iSamplingSet];
-      }
-      delete[] apSamplingSets;
-   }
-   LOG_0(TraceLevelInfo, "Exited SamplingWithReplacement::FreeSamplingSets");
-}
-
 SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets) {
    LOG_0(TraceLevelInfo, "Entered SamplingWithReplacement::GenerateSamplingSets");
 
@@ -136,14 +147,18 @@ SamplingMethod ** SamplingWithReplacement::GenerateSamplingSets(RandomStream * c
       SamplingWithReplacement * const pSingleSamplingSet = GenerateFlatSamplingSet(pOriginDataSet);
       if(UNLIKELY(nullptr == pSingleSamplingSet)) {
          LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets nullptr == pSingleSamplingSet");
-         free(apSamplingSets);
+         delete[] apSamplingSets;
          return nullptr;
       }
       apSamplingSets[0] = pSingleSamplingSet;
    } else {
       memset(apSamplingSets, 0, sizeof(*apSamplingSets) * cSamplingSets);
       for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSets; ++iSamplingSet) {
-         SamplingWithReplacement * const pSingleSamplingSet = GenerateSingleSamplingSet(pRandomStream, pOriginDataSet);
+         // each sampling set gets its own stream 2^128 values further along, so sampling set iSamplingSet is the same regardless of the order in which
+         // we generate the sampling sets, which lets us generate them on separate threads
+         RandomStream randomStreamSamplingSet = *pRandomStream;
+         pRandomStream->Jump();
+         SamplingWithReplacement * const pSingleSamplingSet = GenerateSingleSamplingSet(&randomStreamSamplingSet, pOriginDataSet);
          if(UNLIKELY(nullptr == pSingleSamplingSet)) {
             LOG_0(TraceLevelWarning, "WARNING SamplingWithReplacement::GenerateSamplingSets nullptr == pSingleSamplingSet");
             FreeSamplingSets(cSamplingSets, apSamplingSets);
@@ -7,48 +7,40 @@
 
 #include <stddef.h> // size_t, ptrdiff_t
 
+#include "ebmcore.h" // FractionalDataType
 #include "EbmInternal.h" // EBM_INLINE
 #include "Logging.h" // EBM_ASSERT & LOG
+#include "SamplingMethod.h"
 
 class RandomStream;
 class DataSetByFeatureCombination;
 
-// TODO: if/when we decide we want to keep SamplingWithReplacement, we should create a SamplingMethod.h and SamplingMethod.cpp
-class SamplingMethod {
-public:
-   const DataSetByFeatureCombination * const m_pOriginDataSet;
-
-   EBM_INLINE SamplingMethod(const DataSetByFeatureCombination * const pOriginDataSet)
-      : m_pOriginDataSet(pOriginDataSet) {
-      EBM_ASSERT(nullptr != pOriginDataSet);
-   }
-
-   virtual ~SamplingMethod() {
-   }
-
-   virtual size_t GetTotalCountInstanceOccurrences() const = 0;
-};
-
-// SamplingWithReplacement this is the more theoretically correct method of sampling, but it has the drawback that we need to keep a count of the number of times each instance is selected in the dataset.  Sampling without replacement would require 1 bit per case, so it can be faster.
+// SamplingWithReplacement this is the more theoretically correct method of sampling, but it has the drawback that we need to keep a count of the number of times each instance is selected in the dataset.  SamplingWithoutReplacement only requires 1 bit per case, so it can be faster.
 class SamplingWithReplacement final : public SamplingMethod {
 public:
    // TODO : make this a struct of FractionalType and size_t counts and use MACROS to have either size_t or FractionalType or both, and perf how this changes things.  We don't get a benefit anywhere by storing the raw data in both formats since it is never converted anyways, but this count is!
    const size_t * const m_aCountOccurrences;
+   // each instance's occurrence count multiplied by its weight, or nullptr if our origin dataset doesn't have instance weights.  Folding the weights in
+   // ahead of time means that the weighted binning loops read one value per instance just like the unweighted loops do, and we only pay for the
+   // multiplication once per sampling set instead of once per binning
+   FractionalDataType * m_aWeightedCountOccurrences;
 
    // we take owernship of the aCounts array.  We do not take ownership of the pOriginDataSet since many SamplingWithReplacement objects will refer to the original one
    EBM_INLINE SamplingWithReplacement(const DataSetByFeatureCombination * const pOriginDataSet, const size_t * const aCountOccurrences)
-      : SamplingMethod(pOriginDataSet)
-      , m_aCountOccurrences(aCountOccurrences) {
+      : SamplingMethod(pOriginDataSet, SamplingMethodType::WithReplacement)
+      , m_aCountOccurrences(aCountOccurrences)
+      , m_aWeightedCountOccurrences(nullptr) {
       EBM_ASSERT(nullptr != aCountOccurrences);
    }
 
    virtual ~SamplingWithReplacement() final override;
    virtual size_t GetTotalCountInstanceOccurrences() const final override;
+   // rebuilds m_aWeightedCountOccurrences from our origin dataset's current weights.  Returns true on allocation failure, in which case we're left unweighted
+   bool FoldWeights();
 
    static SamplingWithReplacement * GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet);
    static SamplingWithReplacement * GenerateFlatSamplingSet(const DataSetByFeatureCombination * const pOriginDataSet);
 
-   static void FreeSamplingSets(const size_t cSamplingSets, SamplingMethod ** apSamplingSets);
    static SamplingMethod ** GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets);
 };
 
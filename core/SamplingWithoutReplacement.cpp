@@ -0,0 +1,122 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <string.h> // memset
+#include <stdlib.h> // malloc, realloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "EbmInternal.h" // EBM_INLINE & UNLIKLEY
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "RandomStream.h" // our header didn't need the full definition, but we use the RandomStream in here, so we need it
+#include "DataSetByFeatureCombination.h"
+#include "SamplingWithoutReplacement.h"
+
+SamplingWithoutReplacement::~SamplingWithoutReplacement() {
+   LOG_0(TraceLevelInfo, "Entered ~SamplingWithoutReplacement");
+   free(const_cast<BitMaskWordType *>(m_aBitMask));
+   LOG_0(TraceLevelInfo, "Exited ~SamplingWithoutReplacement");
+}
+
+size_t SamplingWithoutReplacement::GetTotalCountInstanceOccurrences() const {
+#ifndef NDEBUG
+   size_t cInstancesSelectedDebug = 0;
+   for(size_t i = 0; i < m_pOriginDataSet->GetCountInstances(); ++i) {
+      cInstancesSelectedDebug += GetSelectedBit(m_aBitMask, i);
+   }
+   EBM_ASSERT(cInstancesSelectedDebug == m_cInstancesSelected);
+#endif // NDEBUG
+   return m_cInstancesSelected;
+}
+
+SamplingWithoutReplacement * SamplingWithoutReplacement::GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cInstancesSelected) {
+   LOG_0(TraceLevelVerbose, "Entered SamplingWithoutReplacement::GenerateSingleSamplingSet");
+
+   EBM_ASSERT(nullptr != pRandomStream);
+   EBM_ASSERT(nullptr != pOriginDataSet);
+
+   const size_t cInstances = pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances); // if there were no instances, we wouldn't be called
+   EBM_ASSERT(1 <= cInstancesSelected);
+   EBM_ASSERT(cInstancesSelected <= cInstances);
+
+   // this can't overflow since k_cBitsPerBitMaskWord is larger than 1 and we're dividing first
+   const size_t cBitMaskWords = (cInstances + (k_cBitsPerBitMaskWord - 1)) / k_cBitsPerBitMaskWord;
+   const size_t cBytesData = sizeof(BitMaskWordType) * cBitMaskWords;
+   BitMaskWordType * const aBitMask = static_cast<BitMaskWordType *>(malloc(cBytesData));
+   if(nullptr == aBitMask) {
+      LOG_0(TraceLevelWarning, "WARNING SamplingWithoutReplacement::GenerateSingleSamplingSet nullptr == aBitMask");
+      return nullptr;
+   }
+
+   memset(aBitMask, 0, cBytesData);
+
+   // selection sampling (Knuth's algorithm S).  Each instance is selected with probability (# still needed) / (# still available), which gives us
+   // exactly cInstancesSelected instances with every subset equally likely, and we only make one pass through the instances
+   size_t cInstancesNeeded = cInstancesSelected;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      const size_t cInstancesAvailable = cInstances - iInstance;
+      if(pRandomStream->Next(cInstancesAvailable - 1) < cInstancesNeeded) {
+         aBitMask[iInstance / k_cBitsPerBitMaskWord] |= BitMaskWordType { 1 } << (iInstance % k_cBitsPerBitMaskWord);
+         --cInstancesNeeded;
+         if(0 == cInstancesNeeded) {
+            break;
+         }
+      }
+   }
+   EBM_ASSERT(0 == cInstancesNeeded);
+
+   SamplingWithoutReplacement * pRet = new (std::nothrow) SamplingWithoutReplacement(pOriginDataSet, aBitMask, cInstancesSelected);
+   if(nullptr == pRet) {
+      LOG_0(TraceLevelWarning, "WARNING SamplingWithoutReplacement::GenerateSingleSamplingSet nullptr == pRet");
+      free(aBitMask);
+      return nullptr;
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited SamplingWithoutReplacement::GenerateSingleSamplingSet");
+   return pRet;
+}
+
+SamplingMethod ** SamplingWithoutReplacement::GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets, const FractionalDataType subsampleFraction) {
+   LOG_0(TraceLevelInfo, "Entered SamplingWithoutReplacement::GenerateSamplingSets");
+
+   EBM_ASSERT(nullptr != pRandomStream);
+   EBM_ASSERT(nullptr != pOriginDataSet);
+   EBM_ASSERT(0 < subsampleFraction && subsampleFraction <= 1);
+
+   const size_t cInstances = pOriginDataSet->GetCountInstances();
+   EBM_ASSERT(0 < cInstances); // if there were no instances, we wouldn't be called
+
+   // round to the nearest count, but always select at least one instance so that we never have an empty sampling set
+   const FractionalDataType cInstancesSelectedFloat = subsampleFraction * static_cast<FractionalDataType>(cInstances) + FractionalDataType { 0.5 };
+   size_t cInstancesSelected = cInstancesSelectedFloat < static_cast<FractionalDataType>(cInstances) ? static_cast<size_t>(cInstancesSelectedFloat) : cInstances;
+   if(cInstancesSelected < 1) {
+      cInstancesSelected = 1;
+   }
+
+   // unlike SamplingWithReplacement, we subsample even when there is no bagging, since our caller asked for a subsample
+   const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
+
+   SamplingMethod ** apSamplingSets = new (std::nothrow) SamplingMethod *[cSamplingSetsAfterZero];
+   if(UNLIKELY(nullptr == apSamplingSets)) {
+      LOG_0(TraceLevelWarning, "WARNING SamplingWithoutReplacement::GenerateSamplingSets nullptr == apSamplingSets");
+      return nullptr;
+   }
+   memset(apSamplingSets, 0, sizeof(*apSamplingSets) * cSamplingSetsAfterZero);
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      // like SamplingWithReplacement, each sampling set gets its own stream so that it doesn't depend on the order in which we generate them
+      RandomStream randomStreamSamplingSet = *pRandomStream;
+      pRandomStream->Jump();
+      SamplingWithoutReplacement * const pSingleSamplingSet = GenerateSingleSamplingSet(&randomStreamSamplingSet, pOriginDataSet, cInstancesSelected);
+      if(UNLIKELY(nullptr == pSingleSamplingSet)) {
+         LOG_0(TraceLevelWarning, "WARNING SamplingWithoutReplacement::GenerateSamplingSets nullptr == pSingleSamplingSet");
+         FreeSamplingSets(cSamplingSets, apSamplingSets);
+         return nullptr;
+      }
+      apSamplingSets[iSamplingSet] = pSingleSamplingSet;
+   }
+   LOG_0(TraceLevelInfo, "Exited SamplingWithoutReplacement::GenerateSamplingSets");
+   return apSamplingSets;
+}
@@ -0,0 +1,50 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SAMPLING_WITHOUT_REPLACEMENT_H
+#define SAMPLING_WITHOUT_REPLACEMENT_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+#include <stdint.h> // uint64_t
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "SamplingMethod.h"
+
+class RandomStream;
+class DataSetByFeatureCombination;
+
+typedef uint64_t BitMaskWordType;
+constexpr size_t k_cBitsPerBitMaskWord = sizeof(BitMaskWordType) * 8;
+
+// SamplingWithoutReplacement selects a fixed fraction of the instances, each at most once, so we only need 1 bit per instance instead of the size_t count
+// that SamplingWithReplacement keeps.  Bit (iInstance % k_cBitsPerBitMaskWord) of word (iInstance / k_cBitsPerBitMaskWord) is set if the instance is selected
+class SamplingWithoutReplacement final : public SamplingMethod {
+public:
+   const BitMaskWordType * const m_aBitMask;
+   const size_t m_cInstancesSelected;
+
+   // we take owernship of the aBitMask array.  We do not take ownership of the pOriginDataSet since many SamplingMethod objects will refer to the original one
+   EBM_INLINE SamplingWithoutReplacement(const DataSetByFeatureCombination * const pOriginDataSet, const BitMaskWordType * const aBitMask, const size_t cInstancesSelected)
+      : SamplingMethod(pOriginDataSet, SamplingMethodType::WithoutReplacement)
+      , m_aBitMask(aBitMask)
+      , m_cInstancesSelected(cInstancesSelected) {
+      EBM_ASSERT(nullptr != aBitMask);
+      EBM_ASSERT(1 <= cInstancesSelected);
+   }
+
+   EBM_INLINE static size_t GetSelectedBit(const BitMaskWordType * const aBitMask, const size_t iInstance) {
+      return static_cast<size_t>(aBitMask[iInstance / k_cBitsPerBitMaskWord] >> (iInstance % k_cBitsPerBitMaskWord)) & size_t { 1 };
+   }
+
+   virtual ~SamplingWithoutReplacement() final override;
+   virtual size_t GetTotalCountInstanceOccurrences() const final override;
+
+   static SamplingWithoutReplacement * GenerateSingleSamplingSet(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cInstancesSelected);
+   // subsampleFraction needs to be in the range (0, 1].  We always select at least one instance
+   static SamplingMethod ** GenerateSamplingSets(RandomStream * const pRandomStream, const DataSetByFeatureCombination * const pOriginDataSet, const size_t cSamplingSets, const FractionalDataType subsampleFraction);
+};
+
+#endif // SAMPLING_WITHOUT_REPLACEMENT_H
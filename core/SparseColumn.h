@@ -0,0 +1,33 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef SPARSE_COLUMN_H
+#define SPARSE_COLUMN_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "ebmcore.h" // FractionalDataType
+#include "EbmInternal.h" // EBM_INLINE
+
+// we only encode a feature sparsely if at least this fraction of the training instances fall into its dominant bin.  The exceptions are visited at
+// scattered addresses, so each one costs several times what an instance costs in the dense sequential loops
+constexpr FractionalDataType k_sparseDominantBinFractionMin = FractionalDataType { 0.9 };
+
+struct SparseException final {
+   size_t m_iInstance;
+   size_t m_iBin;
+};
+
+// SparseColumn holds the bins of a single feature whose instances nearly all fall into one bin (zeros, defaults, missing).  We keep the dominant bin
+// implicitly and list only the other instances, in instance order.  For regression the update to the residuals of all the dominant bin's instances is
+// one constant, which DataSetByFeatureCombination folds into its residual shift instead of writing it to each residual, and the dominant bin's
+// histogram bucket is the sampling set's total minus the other buckets, so both the update and binning only visit the exceptions
+struct SparseColumn final {
+   // nullptr if this feature combination is stored densely
+   SparseException * m_aExceptions;
+   size_t m_cExceptions;
+   size_t m_iDominantBin;
+};
+
+#endif // SPARSE_COLUMN_H
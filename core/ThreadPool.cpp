@@ -0,0 +1,422 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#include "PrecompiledHeader.h"
+
+#include <stdlib.h> // malloc, free
+#include <stddef.h> // size_t, ptrdiff_t
+#include <new> // std::nothrow
+#include <thread> // std::thread
+#include <mutex> // std::mutex, std::unique_lock
+#include <condition_variable> // std::condition_variable
+#include <atomic> // std::atomic
+
+#ifdef _WIN32
+// we don't want to require windows.h in our precompiled header since then it will be needed in linux builds, which doesn't make sense
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h> // pthread_setaffinity_np
+#include <sched.h> // cpu_set_t
+#endif // _WIN32
+
+#include "ebmcore.h"
+#include "EbmInternal.h" // EBM_INLINE & UNLIKLEY
+#include "Logging.h" // EBM_ASSERT & LOG
+#include "ThreadPool.h"
+
+// the logical processors that we can pin a thread to are numbered below this
+#ifdef _WIN32
+constexpr size_t k_cCpusMax = sizeof(DWORD_PTR) * 8;
+#elif defined(__linux__)
+constexpr size_t k_cCpusMax = CPU_SETSIZE;
+#else // _WIN32
+// we don't know how to pin threads on this platform
+constexpr size_t k_cCpusMax = 0;
+#endif // _WIN32
+
+// a single Run of some ThreadPool.  It lives on the stack of the thread that called Run, which waits for every worker that joined it to leave before
+// returning
+struct ThreadPoolJob final {
+   THREAD_POOL_TASK m_pTask;
+   void * m_pContext;
+   size_t m_cTasks;
+
+   std::atomic<size_t> m_iTaskNext;
+   std::atomic<bool> m_bTaskError;
+
+   // these are only modified while holding the ThreadScheduler's mutex.  Each thread that joins takes the next iThread, so no two threads share one
+   size_t m_cThreadsMax;
+   size_t m_cThreadsJoined;
+   size_t m_cThreadsWorkerBusy;
+   ThreadPoolJob * m_pNext;
+};
+
+static void ExecuteTasks(ThreadPoolJob * const pJob, const size_t iThread) {
+   // tasks are handed out one at a time since our tasks tend to be large (an entire boosting step for a single sampling set) and of varying length
+   while(true) {
+      const size_t iTask = pJob->m_iTaskNext.fetch_add(1, std::memory_order_relaxed);
+      if(pJob->m_cTasks <= iTask) {
+         break;
+      }
+      if(UNLIKELY((*pJob->m_pTask)(pJob->m_pContext, iThread, iTask))) {
+         pJob->m_bTaskError.store(true, std::memory_order_relaxed);
+      }
+   }
+}
+
+static void PinThread(std::thread & thread, const size_t iCpu) {
+   EBM_ASSERT(iCpu < k_cCpusMax);
+#ifdef _WIN32
+   if(0 == SetThreadAffinityMask(thread.native_handle(), DWORD_PTR { 1 } << iCpu)) {
+      LOG_N(TraceLevelWarning, "WARNING PinThread SetThreadAffinityMask failed for CPU %zu", iCpu);
+   }
+#elif defined(__linux__)
+   cpu_set_t cpuSet;
+   CPU_ZERO(&cpuSet);
+   CPU_SET(iCpu, &cpuSet);
+   if(0 != pthread_setaffinity_np(thread.native_handle(), sizeof(cpuSet), &cpuSet)) {
+      LOG_N(TraceLevelWarning, "WARNING PinThread pthread_setaffinity_np failed for CPU %zu", iCpu);
+   }
+#else // _WIN32
+   UNUSED(thread);
+   UNUSED(iCpu);
+#endif // _WIN32
+}
+
+// the worker threads that every ThreadPool in our process shares.  We start them the first time that a Run can use them, so processes that never
+// thread never create any
+class ThreadScheduler final {
+   std::mutex m_mutex;
+   // held for the whole of Configure.  Our workers only leave when they see m_bShutdown, so a second Configure clearing it while the first one is
+   // joining would leave the first waiting forever on workers that went back to sleep
+   std::mutex m_mutexConfigure;
+   std::condition_variable m_conditionWorkAvailable;
+   std::condition_variable m_conditionWorkFinished;
+
+   // these are only modified while holding m_mutex.  m_cThreads is our budget including the threads that call Run, or 0 until we first need it
+   size_t m_cThreads;
+   size_t m_cCpus;
+   size_t * m_aiCpus;
+   bool m_bStarted;
+   bool m_bShutdown;
+   size_t m_cThreadsWorker;
+   std::thread * m_aThreads;
+   // the Runs that workers can still join
+   ThreadPoolJob * m_pJobs;
+
+   void WorkerThread();
+   size_t GetCountThreadsLocked();
+   void StartWorkersLocked();
+
+   // a worker that runs out of tasks joins the Run with the fewest threads on it, which spreads our workers evenly across concurrent Runs and moves
+   // them over to the Runs that are left when others finish early
+   EBM_INLINE ThreadPoolJob * FindJobLocked() const {
+      ThreadPoolJob * pJobBest = nullptr;
+      for(ThreadPoolJob * pJob = m_pJobs; nullptr != pJob; pJob = pJob->m_pNext) {
+         if(pJob->m_cThreadsJoined < pJob->m_cThreadsMax && pJob->m_iTaskNext.load(std::memory_order_relaxed) < pJob->m_cTasks) {
+            if(nullptr == pJobBest || pJob->m_cThreadsWorkerBusy < pJobBest->m_cThreadsWorkerBusy) {
+               pJobBest = pJob;
+            }
+         }
+      }
+      return pJobBest;
+   }
+
+public:
+
+   EBM_INLINE ThreadScheduler()
+      : m_cThreads(0)
+      , m_cCpus(0)
+      , m_aiCpus(nullptr)
+      , m_bStarted(false)
+      , m_bShutdown(false)
+      , m_cThreadsWorker(0)
+      , m_aThreads(nullptr)
+      , m_pJobs(nullptr) {
+   }
+
+   size_t GetCountThreads();
+   bool Run(const size_t cThreadsMax, const size_t cTasks, const THREAD_POOL_TASK pTask, void * const pContext);
+   bool Configure(const size_t cThreads, const size_t cCpus, const size_t * const aiCpus);
+};
+
+void ThreadScheduler::WorkerThread() {
+   std::unique_lock<std::mutex> lock(m_mutex);
+   while(true) {
+      ThreadPoolJob * pJob = nullptr;
+      while(!m_bShutdown && nullptr == (pJob = FindJobLocked())) {
+         m_conditionWorkAvailable.wait(lock);
+      }
+      if(m_bShutdown) {
+         return;
+      }
+      const size_t iThread = pJob->m_cThreadsJoined;
+      ++pJob->m_cThreadsJoined;
+      ++pJob->m_cThreadsWorkerBusy;
+
+      lock.unlock();
+      ExecuteTasks(pJob, iThread);
+      lock.lock();
+
+      EBM_ASSERT(0 < pJob->m_cThreadsWorkerBusy);
+      --pJob->m_cThreadsWorkerBusy;
+      if(0 == pJob->m_cThreadsWorkerBusy) {
+         // several Runs can be waiting on this condition, so we need to wake all of them for the one that we finished to notice
+         m_conditionWorkFinished.notify_all();
+      }
+   }
+}
+
+size_t ThreadScheduler::GetCountThreadsLocked() {
+   if(0 == m_cThreads) {
+      // hardware_concurrency is allowed to return 0 if the value isn't computable, in which case we don't thread at all
+      const size_t cThreadsHardware = static_cast<size_t>(std::thread::hardware_concurrency());
+      m_cThreads = 0 == cThreadsHardware ? size_t { 1 } : cThreadsHardware;
+   }
+   return m_cThreads;
+}
+
+void ThreadScheduler::StartWorkersLocked() {
+   if(m_bStarted || m_bShutdown) {
+      return;
+   }
+   m_bStarted = true;
+   // the threads that call Run work too, so they count against our budget
+   const size_t cThreadsWorker = GetCountThreadsLocked() - 1;
+   if(0 == cThreadsWorker) {
+      return;
+   }
+   EBM_ASSERT(nullptr == m_aThreads);
+   m_aThreads = new (std::nothrow) std::thread[cThreadsWorker];
+   if(UNLIKELY(nullptr == m_aThreads)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadScheduler::StartWorkersLocked nullptr == m_aThreads");
+      return;
+   }
+   try {
+      while(m_cThreadsWorker < cThreadsWorker) {
+         m_aThreads[m_cThreadsWorker] = std::thread(&ThreadScheduler::WorkerThread, this);
+         if(0 != m_cCpus) {
+            PinThread(m_aThreads[m_cThreadsWorker], m_aiCpus[m_cThreadsWorker % m_cCpus]);
+         }
+         ++m_cThreadsWorker;
+      }
+   } catch(...) {
+      // std::thread throws std::system_error if the operating system won't give us another thread.  We can still operate with the threads that we did get
+      LOG_N(TraceLevelWarning, "WARNING ThreadScheduler::StartWorkersLocked only able to create %zu threads out of %zu", m_cThreadsWorker, cThreadsWorker);
+   }
+}
+
+size_t ThreadScheduler::GetCountThreads() {
+   std::lock_guard<std::mutex> lock(m_mutex);
+   return GetCountThreadsLocked();
+}
+
+bool ThreadScheduler::Run(const size_t cThreadsMax, const size_t cTasks, const THREAD_POOL_TASK pTask, void * const pContext) {
+   ThreadPoolJob job;
+   job.m_pTask = pTask;
+   job.m_pContext = pContext;
+   job.m_cTasks = cTasks;
+   job.m_iTaskNext.store(0, std::memory_order_relaxed);
+   job.m_bTaskError.store(false, std::memory_order_relaxed);
+   job.m_cThreadsMax = cThreadsMax;
+   // the calling thread is thread 0, so our workers start at 1
+   job.m_cThreadsJoined = 1;
+   job.m_cThreadsWorkerBusy = 0;
+   job.m_pNext = nullptr;
+
+   bool bWorkers;
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      StartWorkersLocked();
+      bWorkers = 0 != m_cThreadsWorker;
+      if(bWorkers) {
+         job.m_pNext = m_pJobs;
+         m_pJobs = &job;
+      }
+   }
+   if(bWorkers) {
+      m_conditionWorkAvailable.notify_all();
+   }
+
+   ExecuteTasks(&job, 0);
+
+   if(bWorkers) {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      // every task has been handed out, so no worker can usefully join us anymore
+      ThreadPoolJob ** ppJob = &m_pJobs;
+      while(&job != *ppJob) {
+         EBM_ASSERT(nullptr != *ppJob);
+         ppJob = &(*ppJob)->m_pNext;
+      }
+      *ppJob = job.m_pNext;
+      while(0 != job.m_cThreadsWorkerBusy) {
+         m_conditionWorkFinished.wait(lock);
+      }
+   }
+   // acquiring the mutex after the workers released it gives us visibility of everything they wrote, including m_bTaskError
+   return job.m_bTaskError.load(std::memory_order_relaxed);
+}
+
+bool ThreadScheduler::Configure(const size_t cThreads, const size_t cCpus, const size_t * const aiCpus) {
+   size_t * aiCpusCopy = nullptr;
+   if(0 != cCpus) {
+      if(IsMultiplyError(sizeof(size_t), cCpus)) {
+         LOG_0(TraceLevelWarning, "WARNING ThreadScheduler::Configure IsMultiplyError(sizeof(size_t), cCpus)");
+         return true;
+      }
+      aiCpusCopy = static_cast<size_t *>(malloc(sizeof(size_t) * cCpus));
+      if(UNLIKELY(nullptr == aiCpusCopy)) {
+         LOG_0(TraceLevelWarning, "WARNING ThreadScheduler::Configure nullptr == aiCpusCopy");
+         return true;
+      }
+      for(size_t iCpu = 0; iCpu < cCpus; ++iCpu) {
+         aiCpusCopy[iCpu] = aiCpus[iCpu];
+      }
+   }
+
+   std::lock_guard<std::mutex> lockConfigure(m_mutexConfigure);
+   std::unique_lock<std::mutex> lock(m_mutex);
+   // any Runs in progress keep going on their calling threads while our workers leave them, and the next Run starts workers under the new settings
+   std::thread * const aThreads = m_aThreads;
+   const size_t cThreadsWorker = m_cThreadsWorker;
+   m_aThreads = nullptr;
+   m_cThreadsWorker = 0;
+   m_bShutdown = true;
+   lock.unlock();
+   m_conditionWorkAvailable.notify_all();
+   for(size_t iThread = 0; iThread < cThreadsWorker; ++iThread) {
+      aThreads[iThread].join();
+   }
+   delete[] aThreads;
+   lock.lock();
+
+   free(m_aiCpus);
+   m_aiCpus = aiCpusCopy;
+   m_cCpus = cCpus;
+   m_cThreads = cThreads;
+   m_bStarted = false;
+   m_bShutdown = false;
+   return false;
+}
+
+// we never free our ThreadScheduler.  Joining threads while the C++ runtime destroys its statics can deadlock when we're loaded as a DLL, so our idle
+// workers just end with the process
+static ThreadScheduler * GetThreadScheduler() {
+   static ThreadScheduler * const s_pThreadScheduler = new (std::nothrow) ThreadScheduler();
+   return s_pThreadScheduler;
+}
+
+size_t ThreadPool::GetCountThreadsRecommended(const size_t cTasksMax) {
+   ThreadScheduler * const pThreadScheduler = GetThreadScheduler();
+   const size_t cThreadsBudget = nullptr == pThreadScheduler ? size_t { 1 } : pThreadScheduler->GetCountThreads();
+   size_t cThreads = cTasksMax < cThreadsBudget ? cTasksMax : cThreadsBudget;
+   if(cThreads < 1) {
+      cThreads = 1;
+   }
+   return cThreads;
+}
+
+ThreadPool * ThreadPool::Allocate(const size_t cThreadsWorker) {
+   LOG_N(TraceLevelInfo, "Entered ThreadPool::Allocate: cThreadsWorker=%zu", cThreadsWorker);
+
+   ThreadPool * const pThreadPool = new (std::nothrow) ThreadPool(cThreadsWorker + 1);
+   if(UNLIKELY(nullptr == pThreadPool)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Allocate nullptr == pThreadPool");
+      return nullptr;
+   }
+
+   LOG_N(TraceLevelInfo, "Exited ThreadPool::Allocate %p", static_cast<void *>(pThreadPool));
+   return pThreadPool;
+}
+
+bool ThreadPool::Run(ThreadPool * const pThreadPool, const size_t cTasks, const THREAD_POOL_TASK pTask, void * const pContext) {
+   EBM_ASSERT(nullptr != pTask);
+
+   ThreadScheduler * const pThreadScheduler = GetThreadScheduler();
+   if(nullptr == pThreadPool || pThreadPool->m_cThreads <= 1 || cTasks <= 1 || nullptr == pThreadScheduler) {
+      // no point in waking up our threads if there isn't enough work to share
+      bool bError = false;
+      for(size_t iTask = 0; iTask < cTasks; ++iTask) {
+         if(UNLIKELY((*pTask)(pContext, 0, iTask))) {
+            bError = true;
+         }
+      }
+      return bError;
+   }
+
+   try {
+      return pThreadScheduler->Run(pThreadPool->m_cThreads, cTasks, pTask, pContext);
+   } catch(...) {
+      // std::mutex::lock can throw std::system_error, although in practice it should never happen
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Run exception");
+      return true;
+   }
+}
+
+bool ThreadPool::Configure(const size_t cThreads, const size_t cCpus, const size_t * const aiCpus) {
+   ThreadScheduler * const pThreadScheduler = GetThreadScheduler();
+   if(UNLIKELY(nullptr == pThreadScheduler)) {
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Configure nullptr == pThreadScheduler");
+      return true;
+   }
+   try {
+      return pThreadScheduler->Configure(cThreads, cCpus, aiCpus);
+   } catch(...) {
+      // std::mutex::lock and std::thread::join can throw std::system_error, although in practice they should never happen
+      LOG_0(TraceLevelWarning, "WARNING ThreadPool::Configure exception");
+      return true;
+   }
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ConfigureThreads(
+   IntegerDataType countThreads,
+   IntegerDataType countCpus,
+   const IntegerDataType * cpuIndexes
+) {
+   LOG_N(TraceLevelInfo, "Entered ConfigureThreads: countThreads=%" IntegerDataTypePrintf ", countCpus=%" IntegerDataTypePrintf ", cpuIndexes=%p", countThreads, countCpus, static_cast<const void *>(cpuIndexes));
+
+   if(countThreads < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countThreads)) {
+      LOG_0(TraceLevelError, "ERROR ConfigureThreads countThreads must be zero or positive");
+      return 1;
+   }
+   if(countCpus < 0 || !IsNumberConvertable<size_t, IntegerDataType>(countCpus)) {
+      LOG_0(TraceLevelError, "ERROR ConfigureThreads countCpus must be zero or positive");
+      return 1;
+   }
+   const size_t cThreads = static_cast<size_t>(countThreads);
+   const size_t cCpus = static_cast<size_t>(countCpus);
+   if(0 != cCpus && 0 == k_cCpusMax) {
+      LOG_0(TraceLevelWarning, "WARNING ConfigureThreads we can't pin threads on this platform");
+      return 1;
+   }
+   EBM_ASSERT(0 == cCpus || nullptr != cpuIndexes);
+   if(IsMultiplyError(sizeof(size_t), cCpus)) {
+      LOG_0(TraceLevelWarning, "WARNING ConfigureThreads IsMultiplyError(sizeof(size_t), cCpus)");
+      return 1;
+   }
+   size_t * const aiCpus = 0 == cCpus ? nullptr : static_cast<size_t *>(malloc(sizeof(size_t) * cCpus));
+   if(0 != cCpus && UNLIKELY(nullptr == aiCpus)) {
+      LOG_0(TraceLevelWarning, "WARNING ConfigureThreads nullptr == aiCpus");
+      return 1;
+   }
+   for(size_t iCpu = 0; iCpu < cCpus; ++iCpu) {
+      const IntegerDataType indexCpu = cpuIndexes[iCpu];
+      if(indexCpu < 0 || !IsNumberConvertable<size_t, IntegerDataType>(indexCpu) || k_cCpusMax <= static_cast<size_t>(indexCpu)) {
+         LOG_0(TraceLevelError, "ERROR ConfigureThreads cpuIndexes contains a CPU that we can't pin to");
+         free(aiCpus);
+         return 1;
+      }
+      aiCpus[iCpu] = static_cast<size_t>(indexCpu);
+   }
+
+   const bool bError = ThreadPool::Configure(cThreads, cCpus, aiCpus);
+   free(aiCpus);
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING ConfigureThreads ThreadPool::Configure");
+      return 1;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited ConfigureThreads");
+   return 0;
+}
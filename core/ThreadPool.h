@@ -0,0 +1,52 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h> // size_t, ptrdiff_t
+
+#include "EbmInternal.h" // EBM_INLINE
+#include "Logging.h" // EBM_ASSERT & LOG
+
+// a task returns true on error.  iThread is in the range [0, GetCountThreads()) and identifies which thread is running the task, so that the task can use
+// scratch space that belongs exclusively to that thread.  Thread 0 is always the thread that called Run.  iTask is in the range [0, cTasks)
+typedef bool (* THREAD_POOL_TASK)(void * const pContext, const size_t iThread, const size_t iTask);
+
+// ThreadPool doesn't own any threads.  Every ThreadPool in our process hands its Runs to one set of worker threads that we share across all of our
+// PEbmTraining and PEbmInteraction handles, so that many handles working at once never use more threads than ConfigureThreads allows.  An idle worker
+// joins whichever Run has the fewest threads working on it, so the workers drift over to the handles that still have work when others finish early.
+// A ThreadPool caps how many threads work on each of its Runs at GetCountThreads(), which bounds iThread for the caller's scratch space.
+// Run is not reentrant.  Only one thread should call Run at a time on any given ThreadPool.  The thread calling Run participates in the work.  We don't
+// make any guarantees about which thread runs which task, so callers that need deterministic results need to write each task's results into a separate
+// location and then combine them in a fixed order after Run returns
+class ThreadPool final {
+   const size_t m_cThreads;
+
+   EBM_INLINE ThreadPool(const size_t cThreads)
+      : m_cThreads(cThreads) {
+   }
+
+public:
+
+   // returns the number of threads (including the calling thread) that would be useful for cTasksMax independent tasks within our thread budget
+   static size_t GetCountThreadsRecommended(const size_t cTasksMax);
+
+   // cThreadsWorker is the number of threads that can help the calling thread with each Run.  Returns nullptr on error
+   static ThreadPool * Allocate(const size_t cThreadsWorker);
+
+   // runs pTask on our shared worker threads if pThreadPool exists, or serially on the calling thread (as thread 0) if pThreadPool is nullptr.  Returns
+   // true on error
+   static bool Run(ThreadPool * const pThreadPool, const size_t cTasks, const THREAD_POOL_TASK pTask, void * const pContext);
+
+   // sets the budget of threads shared by every ThreadPool, including the threads that call Run, and pins the worker threads round robin to the logical
+   // processors in aiCpus if cCpus isn't 0.  0 == cThreads means one thread per logical processor.  Returns true on error
+   static bool Configure(const size_t cThreads, const size_t cCpus, const size_t * const aiCpus);
+
+   EBM_INLINE size_t GetCountThreads() const {
+      return m_cThreads;
+   }
+};
+
+#endif // THREAD_POOL_H
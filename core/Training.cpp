@@ -28,6 +28,8 @@
 #include "DataSetByFeatureCombination.h"
 // samples is somewhat independent from datasets, but relies on an indirect coupling with them
 #include "SamplingWithReplacement.h"
+#include "SamplingWithoutReplacement.h"
+#include "ThreadPool.h"
 // TreeNode depends on almost everything
 #include "DimensionSingle.h"
 #include "DimensionMultiple.h"
@@ -50,6 +52,143 @@ void EbmTrainingState::DeleteSegmentedTensors(const size_t cFeatureCombinations,
    LOG_0(TraceLevelInfo, "Exited DeleteSegmentedTensors");
 }
 
+void EbmTrainingWorkspace::FreeSmallChangeToModelOverwriteSingleSamplingSets(const size_t cSamplingSets, SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSmallChangeToModelOverwriteSingleSamplingSet) {
+   LOG_0(TraceLevelInfo, "Entered FreeSmallChangeToModelOverwriteSingleSamplingSets");
+   if(LIKELY(nullptr != apSmallChangeToModelOverwriteSingleSamplingSet)) {
+      const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
+      for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+         SegmentedTensor<ActiveDataType, FractionalDataType>::Free(apSmallChangeToModelOverwriteSingleSamplingSet[iSamplingSet]);
+      }
+      delete[] apSmallChangeToModelOverwriteSingleSamplingSet;
+   }
+   LOG_0(TraceLevelInfo, "Exited FreeSmallChangeToModelOverwriteSingleSamplingSets");
+}
+
+SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingWorkspace::AllocateSmallChangeToModelOverwriteSingleSamplingSets(const size_t cSamplingSets, const size_t cVectorLength) {
+   LOG_0(TraceLevelInfo, "Entered AllocateSmallChangeToModelOverwriteSingleSamplingSets");
+
+   const size_t cSamplingSetsAfterZero = 0 == cSamplingSets ? 1 : cSamplingSets;
+   SegmentedTensor<ActiveDataType, FractionalDataType> ** const apSmallChangeToModelOverwriteSingleSamplingSet = new (std::nothrow) SegmentedTensor<ActiveDataType, FractionalDataType> *[cSamplingSetsAfterZero];
+   if(UNLIKELY(nullptr == apSmallChangeToModelOverwriteSingleSamplingSet)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateSmallChangeToModelOverwriteSingleSamplingSets nullptr == apSmallChangeToModelOverwriteSingleSamplingSet");
+      return nullptr;
+   }
+   memset(apSmallChangeToModelOverwriteSingleSamplingSet, 0, sizeof(*apSmallChangeToModelOverwriteSingleSamplingSet) * cSamplingSetsAfterZero); // this needs to be done immediately after allocation otherwise we might attempt to free random garbage on an error
+
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet = SegmentedTensor<ActiveDataType, FractionalDataType>::Allocate(k_cDimensionsMax, cVectorLength);
+      if(UNLIKELY(nullptr == pSmallChangeToModelOverwriteSingleSamplingSet)) {
+         LOG_0(TraceLevelWarning, "WARNING AllocateSmallChangeToModelOverwriteSingleSamplingSets nullptr == pSmallChangeToModelOverwriteSingleSamplingSet");
+         FreeSmallChangeToModelOverwriteSingleSamplingSets(cSamplingSets, apSmallChangeToModelOverwriteSingleSamplingSet);
+         return nullptr;
+      }
+      apSmallChangeToModelOverwriteSingleSamplingSet[iSamplingSet] = pSmallChangeToModelOverwriteSingleSamplingSet;
+   }
+
+   LOG_0(TraceLevelInfo, "Exited AllocateSmallChangeToModelOverwriteSingleSamplingSets");
+   return apSmallChangeToModelOverwriteSingleSamplingSet;
+}
+
+bool EbmTrainingWorkspace::Initialize(const bool bUseThreadPool) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingWorkspace::Initialize");
+   try {
+      const size_t cSamplingSetsAfterZero = 0 == m_cSamplingSets ? 1 : m_cSamplingSets;
+
+      // the caller's thread is always thread 0, so we need one less worker than the number of threads that we want to run on.  If we have fewer sampling
+      // sets than cores, we still want the threads since a single sampling set can split its binning across them
+      const size_t cTasksMax = cSamplingSetsAfterZero < k_cBinningChunksMax ? k_cBinningChunksMax : cSamplingSetsAfterZero;
+      const size_t cThreadsRecommended = bUseThreadPool ? ThreadPool::GetCountThreadsRecommended(cTasksMax) : size_t { 1 };
+      EBM_ASSERT(nullptr == m_pThreadPool);
+      if(1 < cThreadsRecommended) {
+         m_pThreadPool = ThreadPool::Allocate(cThreadsRecommended - 1);
+         if(UNLIKELY(nullptr == m_pThreadPool)) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_pThreadPool");
+            return true;
+         }
+      }
+      const size_t cThreads = nullptr == m_pThreadPool ? 1 : m_pThreadPool->GetCountThreads();
+
+      EBM_ASSERT(nullptr == m_aCachedThreadResourcesUnion);
+      EBM_ASSERT(!IsMultiplyError(sizeof(CachedThreadResourcesUnion), cThreads)); // cThreads is limited by the hardware thread count
+      m_aCachedThreadResourcesUnion = static_cast<CachedThreadResourcesUnion *>(malloc(sizeof(CachedThreadResourcesUnion) * cThreads));
+      if(UNLIKELY(nullptr == m_aCachedThreadResourcesUnion)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_aCachedThreadResourcesUnion");
+         return true;
+      }
+      EBM_ASSERT(0 == m_cCachedThreadResources);
+      do {
+         // this is an in-place new, so there is no new memory allocated.  We increment our count afterwards so that our destructor only destroys the items that were constructed
+         CachedThreadResourcesUnion * const pCachedThreadResourcesUnion = new (&m_aCachedThreadResourcesUnion[m_cCachedThreadResources]) CachedThreadResourcesUnion(m_runtimeLearningTypeOrCountTargetClasses);
+         ++m_cCachedThreadResources;
+         if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
+            if(pCachedThreadResourcesUnion->regression.IsError()) {
+               LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize pCachedThreadResourcesUnion->regression.IsError()");
+               return true;
+            }
+         } else {
+            EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
+            if(pCachedThreadResourcesUnion->classification.IsError()) {
+               LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize pCachedThreadResourcesUnion->classification.IsError()");
+               return true;
+            }
+         }
+      } while(m_cCachedThreadResources < cThreads);
+
+      EBM_ASSERT(nullptr == m_apSmallChangeToModelOverwriteSingleSamplingSet);
+      m_apSmallChangeToModelOverwriteSingleSamplingSet = AllocateSmallChangeToModelOverwriteSingleSamplingSets(m_cSamplingSets, GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses));
+      if(UNLIKELY(nullptr == m_apSmallChangeToModelOverwriteSingleSamplingSet)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_apSmallChangeToModelOverwriteSingleSamplingSet");
+         return true;
+      }
+
+      EBM_ASSERT(nullptr == m_aSamplingSetGains);
+      if(IsMultiplyError(sizeof(FractionalDataType), cSamplingSetsAfterZero)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize IsMultiplyError(sizeof(FractionalDataType), cSamplingSetsAfterZero)");
+         return true;
+      }
+      m_aSamplingSetGains = static_cast<FractionalDataType *>(malloc(sizeof(FractionalDataType) * cSamplingSetsAfterZero));
+      if(UNLIKELY(nullptr == m_aSamplingSetGains)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_aSamplingSetGains");
+         return true;
+      }
+
+      if(UNLIKELY(nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets");
+         return true;
+      }
+
+      EBM_ASSERT(nullptr == m_aHistogramCaches);
+      m_aHistogramCaches = new (std::nothrow) HistogramCache[cSamplingSetsAfterZero];
+      if(UNLIKELY(nullptr == m_aHistogramCaches)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize nullptr == m_aHistogramCaches");
+         return true;
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingWorkspace::Initialize");
+      return false;
+   } catch(...) {
+      // this is here to catch exceptions from the CachedThreadResourcesUnion constructors, and ThreadPool::GetCountThreadsRecommended
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Initialize exception");
+      return true;
+   }
+}
+
+EbmTrainingWorkspace * EbmTrainingWorkspace::Allocate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const size_t cSamplingSets, const bool bUseThreadPool) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingWorkspace::Allocate");
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = new (std::nothrow) EbmTrainingWorkspace(runtimeLearningTypeOrCountTargetClasses, cSamplingSets);
+   if(UNLIKELY(nullptr == pEbmTrainingWorkspace)) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Allocate nullptr == pEbmTrainingWorkspace");
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingWorkspace->Initialize(bUseThreadPool))) {
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingWorkspace::Allocate pEbmTrainingWorkspace->Initialize");
+      delete pEbmTrainingWorkspace;
+      return nullptr;
+   }
+   LOG_N(TraceLevelInfo, "Exited EbmTrainingWorkspace::Allocate %p", static_cast<void *>(pEbmTrainingWorkspace));
+   return pEbmTrainingWorkspace;
+}
+
 SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::InitializeSegmentedTensors(const size_t cFeatureCombinations, const FeatureCombinationCore * const * const apFeatureCombinations, const size_t cVectorLength) {
    LOG_0(TraceLevelInfo, "Entered InitializeSegmentedTensors");
 
@@ -106,21 +245,93 @@ SegmentedTensor<ActiveDataType, FractionalDataType> ** EbmTrainingState::Initial
    return apSegmentedTensors;
 }
 
-bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores) {
-   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::Initialize");
-   try {
-      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
-         if(m_cachedThreadResourcesUnion.regression.IsError()) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.regression.IsError()");
-            return true;
+bool EbmTrainingState::InitializeSamplingSetsAndModels(const IntegerDataType randomSeed, const size_t cTrainingInstances, const void * const aTrainingTargets, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const FractionalDataType * const aValidationPredictorScores) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::InitializeSamplingSetsAndModels");
+
+   const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+
+   RandomStream randomStream(randomSeed);
+
+   EBM_ASSERT(nullptr == m_apSamplingSets);
+   if(0 != cTrainingInstances) {
+      m_apSamplingSets = SamplingWithReplacement::GenerateSamplingSets(&randomStream, m_pTrainingSet, m_cSamplingSets);
+      if(UNLIKELY(nullptr == m_apSamplingSets)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels nullptr == m_apSamplingSets");
+         return true;
+      }
+   }
+
+   EBM_ASSERT(nullptr == m_apCurrentModel);
+   EBM_ASSERT(nullptr == m_apBestModel);
+   if(0 != m_cFeatureCombinations && (IsRegression(m_runtimeLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses)) {
+      m_apCurrentModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
+      if(nullptr == m_apCurrentModel) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels nullptr == m_apCurrentModel");
+         return true;
+      }
+      m_apBestModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
+      if(nullptr == m_apBestModel) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels nullptr == m_apBestModel");
+         return true;
+      }
+      // both models start at zero, so none of our best models are stale
+      EBM_ASSERT(nullptr == m_abBestModelStale);
+      m_abBestModelStale = static_cast<bool *>(calloc(m_cFeatureCombinations, sizeof(bool)));
+      if(nullptr == m_abBestModelStale) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels nullptr == m_abBestModelStale");
+         return true;
+      }
+      // m_apCurrentModel allocated an array of m_cFeatureCombinations pointers, so this multiplication can't overflow
+      EBM_ASSERT(!IsMultiplyError(sizeof(size_t), m_cFeatureCombinations));
+      EBM_ASSERT(nullptr == m_aiBestModelStale);
+      m_aiBestModelStale = static_cast<size_t *>(malloc(sizeof(size_t) * m_cFeatureCombinations));
+      if(nullptr == m_aiBestModelStale) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels nullptr == m_aiBestModelStale");
+         return true;
+      }
+   }
+
+   if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
+      if(0 != cTrainingInstances) {
+         InitializeResiduals<k_Regression>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), k_Regression);
+      }
+      if(0 != cValidationInstances) {
+         InitializeResiduals<k_Regression>(cValidationInstances, aValidationTargets, aValidationPredictorScores, m_pValidationSet->GetResidualPointer(), k_Regression);
+      }
+   } else {
+      EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
+      if(size_t { 2 } == static_cast<size_t>(m_runtimeLearningTypeOrCountTargetClasses)) {
+         if(0 != cTrainingInstances) {
+            InitializeResiduals<2>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), ptrdiff_t { 2 });
          }
       } else {
-         EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
-         if(m_cachedThreadResourcesUnion.classification.IsError()) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize m_cachedThreadResourcesUnion.classification.IsError()");
+         if(0 != cTrainingInstances) {
+            InitializeResiduals<k_DynamicClassification>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), m_runtimeLearningTypeOrCountTargetClasses);
+         }
+      }
+      // log loss needs exp and log for each instance, so we keep each instance's loss to skip recomputing it for the instances that an update doesn't
+      // move.  Squared error is cheaper to recompute than to look up, so regression doesn't keep them
+      if(0 != cValidationInstances && ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses) {
+         if(m_pValidationSet->AllocateInstanceLosses()) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeSamplingSetsAndModels m_pValidationSet->AllocateInstanceLosses()");
             return true;
          }
       }
+   }
+
+   LOG_0(TraceLevelInfo, "Exited EbmTrainingState::InitializeSamplingSetsAndModels");
+   return false;
+}
+
+bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCoreFeature * const aFeatures, const EbmCoreFeatureCombination * const aFeatureCombinations, const IntegerDataType * featureCombinationIndexes, const size_t cTrainingInstances, const void * const aTrainingTargets, const IntegerDataType * const aTrainingBinnedData, const FractionalDataType * const aTrainingPredictorScores, const size_t cValidationInstances, const void * const aValidationTargets, const IntegerDataType * const aValidationBinnedData, const FractionalDataType * const aValidationPredictorScores, const bool bBorrowBuffers) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::Initialize");
+   try {
+      EBM_ASSERT(nullptr == m_pEbmTrainingWorkspace);
+      m_pEbmTrainingWorkspace = EbmTrainingWorkspace::Allocate(m_runtimeLearningTypeOrCountTargetClasses, m_cSamplingSets, true);
+      if(UNLIKELY(nullptr == m_pEbmTrainingWorkspace)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pEbmTrainingWorkspace");
+         return true;
+      }
 
       if(0 != m_cFeatures && nullptr == m_aFeatures) {
          LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize 0 != m_cFeatures && nullptr == m_aFeatures");
@@ -132,156 +343,21 @@ bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCor
          return true;
       }
 
-      if(UNLIKELY(nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet)) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelOverwriteSingleSamplingSet");
+      if(EbmTrainingDataSet::InitializeFeatures(m_cFeatures, m_aFeatures, aFeatures, cTrainingInstances, cValidationInstances)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize InitializeFeatures");
          return true;
       }
-
-      if(UNLIKELY(nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets)) {
-         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pSmallChangeToModelAccumulatedFromSamplingSets");
+      if(EbmTrainingDataSet::InitializeFeatureCombinations(m_cFeatures, m_aFeatures, m_cFeatureCombinations, m_apFeatureCombinations, aFeatureCombinations, featureCombinationIndexes)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize InitializeFeatureCombinations");
          return true;
       }
 
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature processing");
-      if(0 != m_cFeatures) {
-         EBM_ASSERT(!IsMultiplyError(m_cFeatures, sizeof(*aFeatures))); // if this overflows then our caller should not have been able to allocate the array
-         const EbmCoreFeature * pFeatureInitialize = aFeatures;
-         const EbmCoreFeature * const pFeatureEnd = &aFeatures[m_cFeatures];
-         EBM_ASSERT(pFeatureInitialize < pFeatureEnd);
-         size_t iFeatureInitialize = 0;
-         do {
-            static_assert(FeatureTypeCore::OrdinalCore == static_cast<FeatureTypeCore>(FeatureTypeOrdinal), "FeatureTypeCore::OrdinalCore must have the same value as FeatureTypeOrdinal");
-            static_assert(FeatureTypeCore::NominalCore == static_cast<FeatureTypeCore>(FeatureTypeNominal), "FeatureTypeCore::NominalCore must have the same value as FeatureTypeNominal");
-            EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType || FeatureTypeNominal == pFeatureInitialize->featureType);
-            FeatureTypeCore featureTypeCore = static_cast<FeatureTypeCore>(pFeatureInitialize->featureType);
-
-            IntegerDataType countBins = pFeatureInitialize->countBins;
-            EBM_ASSERT(0 <= countBins); // we can handle 1 == cBins or 0 == cBins even though that's a degenerate case that shouldn't be trained on (dimensions with 1 bin don't contribute anything since they always have the same value).  0 cases could only occur if there were zero training and zero validation cases since the features would require a value, even if it was 0
-            if(!IsNumberConvertable<size_t, IntegerDataType>(countBins)) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countBins)");
-               return true;
-            }
-            size_t cBins = static_cast<size_t>(countBins);
-            if(cBins <= 1) {
-               EBM_ASSERT(0 != cBins || 0 == cTrainingInstances && 0 == cValidationInstances);
-               LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature with 0/1 values");
-            }
-
-            EBM_ASSERT(0 == pFeatureInitialize->hasMissing || 1 == pFeatureInitialize->hasMissing);
-            bool bMissing = 0 != pFeatureInitialize->hasMissing;
-
-            // this is an in-place new, so there is no new memory allocated, and we already knew where it was going, so we don't need the resulting pointer returned
-            new (&m_aFeatures[iFeatureInitialize]) FeatureCore(cBins, iFeatureInitialize, featureTypeCore, bMissing);
-            // we don't allocate memory and our constructor doesn't have errors, so we shouldn't have an error here
-
-            EBM_ASSERT(0 == pFeatureInitialize->hasMissing); // TODO : implement this, then remove this assert
-            EBM_ASSERT(FeatureTypeOrdinal == pFeatureInitialize->featureType); // TODO : implement this, then remove this assert
-
-            ++iFeatureInitialize;
-            ++pFeatureInitialize;
-         } while(pFeatureEnd != pFeatureInitialize);
-      }
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize done feature processing");
-
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize starting feature combination processing");
-      if(0 != m_cFeatureCombinations) {
-         const IntegerDataType * pFeatureCombinationIndex = featureCombinationIndexes;
-         size_t iFeatureCombination = 0;
-         do {
-            const EbmCoreFeatureCombination * const pFeatureCombinationInterop = &aFeatureCombinations[iFeatureCombination];
-
-            IntegerDataType countFeaturesInCombination = pFeatureCombinationInterop->countFeaturesInCombination;
-            EBM_ASSERT(0 <= countFeaturesInCombination);
-            if(!IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(countFeaturesInCombination)");
-               return true;
-            }
-            size_t cFeaturesInCombination = static_cast<size_t>(countFeaturesInCombination);
-            size_t cSignificantFeaturesInCombination = 0;
-            const IntegerDataType * const pFeatureCombinationIndexEnd = pFeatureCombinationIndex + cFeaturesInCombination;
-            if(UNLIKELY(0 == cFeaturesInCombination)) {
-               LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize empty feature combination");
-            } else {
-               EBM_ASSERT(nullptr != featureCombinationIndexes);
-               const IntegerDataType * pFeatureCombinationIndexTemp = pFeatureCombinationIndex;
-               do {
-                  const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndexTemp;
-                  EBM_ASSERT(0 <= indexFeatureInterop);
-                  if(!IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)) {
-                     LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop)");
-                     return true;
-                  }
-                  const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
-                  EBM_ASSERT(iFeatureForCombination < m_cFeatures);
-                  FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
-                  if(LIKELY(1 < pInputFeature->m_cBins)) {
-                     // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
-                     ++cSignificantFeaturesInCombination;
-                  } else {
-                     LOG_0(TraceLevelInfo, "INFO EbmTrainingState::Initialize feature combination with no useful features");
-                  }
-                  ++pFeatureCombinationIndexTemp;
-               } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndexTemp);
-
-               if(k_cDimensionsMax < cSignificantFeaturesInCombination) {
-                  // if we try to run with more than k_cDimensionsMax we'll exceed our memory capacity, so let's exit here instead
-                  LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize k_cDimensionsMax < cSignificantFeaturesInCombination");
-                  return true;
-               }
-            }
-
-            FeatureCombinationCore * pFeatureCombination = FeatureCombinationCore::Allocate(cSignificantFeaturesInCombination, iFeatureCombination);
-            if(nullptr == pFeatureCombination) {
-               LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == pFeatureCombination");
-               return true;
-            }
-            // assign our pointer directly to our array right now so that we can't loose the memory if we decide to exit due to an error below
-            m_apFeatureCombinations[iFeatureCombination] = pFeatureCombination;
-
-            if(LIKELY(0 == cSignificantFeaturesInCombination)) {
-               // move our index forward to the next feature.  
-               // We won't be executing the loop below that would otherwise increment it by the number of features in this feature combination
-               pFeatureCombinationIndex = pFeatureCombinationIndexEnd;
-            } else {
-               EBM_ASSERT(nullptr != featureCombinationIndexes);
-               size_t cTensorBins = 1;
-               FeatureCombinationCore::FeatureCombinationEntry * pFeatureCombinationEntry = ARRAY_TO_POINTER(pFeatureCombination->m_FeatureCombinationEntry);
-               do {
-                  const IntegerDataType indexFeatureInterop = *pFeatureCombinationIndex;
-                  EBM_ASSERT(0 <= indexFeatureInterop);
-                  EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureInterop))); // this was checked above
-                  const size_t iFeatureForCombination = static_cast<size_t>(indexFeatureInterop);
-                  EBM_ASSERT(iFeatureForCombination < m_cFeatures);
-                  const FeatureCore * const pInputFeature = &m_aFeatures[iFeatureForCombination];
-                  const size_t cBins = pInputFeature->m_cBins;
-                  if(LIKELY(1 < cBins)) {
-                     // if we have only 1 bin, then we can eliminate the feature from consideration since the resulting tensor loses one dimension but is otherwise indistinquishable from the original data
-                     pFeatureCombinationEntry->m_pFeature = pInputFeature;
-                     ++pFeatureCombinationEntry;
-                     if(IsMultiplyError(cTensorBins, cBins)) {
-                        // if this overflows, we definetly won't be able to allocate it
-                        LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize IsMultiplyError(cTensorStates, cBins)");
-                        return true;
-                     }
-                     cTensorBins *= cBins;
-                  }
-                  ++pFeatureCombinationIndex;
-               } while(pFeatureCombinationIndexEnd != pFeatureCombinationIndex);
-               // if cSignificantFeaturesInCombination is zero, don't both initializing pFeatureCombination->m_cItemsPerBitPackDataUnit
-               const size_t cBitsRequiredMin = CountBitsRequiredCore(cTensorBins - 1);
-               pFeatureCombination->m_cItemsPerBitPackDataUnit = GetCountItemsBitPacked(cBitsRequiredMin);
-            }
-            ++iFeatureCombination;
-         } while(iFeatureCombination < m_cFeatureCombinations);
-      }
-      LOG_0(TraceLevelInfo, "EbmTrainingState::Initialize finished feature combination processing");
-
       const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
       const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
 
       LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination for m_pTrainingSet");
       if(0 != cTrainingInstances) {
-         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(true, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, aTrainingBinnedData, aTrainingTargets, aTrainingPredictorScores, cVectorLength);
+         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(true, !bRegression, !bRegression, bBorrowBuffers, m_cFeatureCombinations, m_apFeatureCombinations, cTrainingInstances, aTrainingBinnedData, aTrainingTargets, aTrainingPredictorScores, cVectorLength);
          if(nullptr == m_pTrainingSet || m_pTrainingSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
             return true;
@@ -291,7 +367,7 @@ bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCor
 
       LOG_0(TraceLevelInfo, "Entered DataSetByFeatureCombination for m_pValidationSet");
       if(0 != cValidationInstances) {
-         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(bRegression, !bRegression, !bRegression, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, aValidationBinnedData, aValidationTargets, aValidationPredictorScores, cVectorLength);
+         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(bRegression, !bRegression, !bRegression, bBorrowBuffers, m_cFeatureCombinations, m_apFeatureCombinations, cValidationInstances, aValidationBinnedData, aValidationTargets, aValidationPredictorScores, cVectorLength);
          if(nullptr == m_pValidationSet || m_pValidationSet->IsError()) {
             LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_pValidationSet || m_pValidationSet->IsError()");
             return true;
@@ -299,57 +375,60 @@ bool EbmTrainingState::Initialize(const IntegerDataType randomSeed, const EbmCor
       }
       LOG_N(TraceLevelInfo, "Exited DataSetByFeatureCombination for m_pValidationSet %p", static_cast<void *>(m_pValidationSet));
 
-      RandomStream randomStream(randomSeed);
+      if(InitializeSamplingSetsAndModels(randomSeed, cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, cValidationInstances, aValidationTargets, aValidationPredictorScores)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize InitializeSamplingSetsAndModels");
+         return true;
+      }
+
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingState::Initialize");
+      return false;
+   } catch(...) {
+      // this is here to catch exceptions from any C++ types that we put in here later
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize exception");
+      return true;
+   }
+}
 
-      EBM_ASSERT(nullptr == m_apSamplingSets);
-      if(0 != cTrainingInstances) {
-         m_apSamplingSets = SamplingWithReplacement::GenerateSamplingSets(&randomStream, m_pTrainingSet, m_cSamplingSets);
-         if(UNLIKELY(nullptr == m_apSamplingSets)) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apSamplingSets");
-            return true;
-         }
+bool EbmTrainingState::InitializeFromDataSet(const IntegerDataType randomSeed, const FractionalDataType * const aTrainingPredictorScores, const FractionalDataType * const aValidationPredictorScores, const bool bBorrowBuffers) {
+   LOG_0(TraceLevelInfo, "Entered EbmTrainingState::InitializeFromDataSet");
+   try {
+      EBM_ASSERT(nullptr != m_pTrainingDataSet);
+      EBM_ASSERT(nullptr == m_pEbmTrainingWorkspace);
+      m_pEbmTrainingWorkspace = EbmTrainingWorkspace::Allocate(m_runtimeLearningTypeOrCountTargetClasses, m_cSamplingSets, true);
+      if(UNLIKELY(nullptr == m_pEbmTrainingWorkspace)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeFromDataSet nullptr == m_pEbmTrainingWorkspace");
+         return true;
       }
 
-      EBM_ASSERT(nullptr == m_apCurrentModel);
-      EBM_ASSERT(nullptr == m_apBestModel);
-      if(0 != m_cFeatureCombinations && (IsRegression(m_runtimeLearningTypeOrCountTargetClasses) || ptrdiff_t { 2 } <= m_runtimeLearningTypeOrCountTargetClasses)) {
-         m_apCurrentModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
-         if(nullptr == m_apCurrentModel) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apCurrentModel");
+      const size_t cVectorLength = GetVectorLengthFlatCore(m_runtimeLearningTypeOrCountTargetClasses);
+      const bool bRegression = IsRegression(m_runtimeLearningTypeOrCountTargetClasses);
+
+      // our datasets are views of the shared ones, so they allocate only the residuals and predictor scores that belong to this EbmTrainingState
+      if(nullptr != m_pTrainingDataSet->m_pTrainingSet) {
+         m_pTrainingSet = new (std::nothrow) DataSetByFeatureCombination(m_pTrainingDataSet->m_pTrainingSet, true, !bRegression, bBorrowBuffers, aTrainingPredictorScores, cVectorLength);
+         if(nullptr == m_pTrainingSet || m_pTrainingSet->IsError()) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeFromDataSet nullptr == m_pTrainingSet || m_pTrainingSet->IsError()");
             return true;
          }
-         m_apBestModel = InitializeSegmentedTensors(m_cFeatureCombinations, m_apFeatureCombinations, cVectorLength);
-         if(nullptr == m_apBestModel) {
-            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize nullptr == m_apBestModel");
+      }
+      if(nullptr != m_pTrainingDataSet->m_pValidationSet) {
+         m_pValidationSet = new (std::nothrow) DataSetByFeatureCombination(m_pTrainingDataSet->m_pValidationSet, bRegression, !bRegression, bBorrowBuffers, aValidationPredictorScores, cVectorLength);
+         if(nullptr == m_pValidationSet || m_pValidationSet->IsError()) {
+            LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeFromDataSet nullptr == m_pValidationSet || m_pValidationSet->IsError()");
             return true;
          }
       }
 
-      if(IsRegression(m_runtimeLearningTypeOrCountTargetClasses)) {
-         if(0 != cTrainingInstances) {
-            InitializeResiduals<k_Regression>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), k_Regression);
-         }
-         if(0 != cValidationInstances) {
-            InitializeResiduals<k_Regression>(cValidationInstances, aValidationTargets, aValidationPredictorScores, m_pValidationSet->GetResidualPointer(), k_Regression);
-         }
-      } else {
-         EBM_ASSERT(IsClassification(m_runtimeLearningTypeOrCountTargetClasses));
-         if(size_t { 2 } == static_cast<size_t>(m_runtimeLearningTypeOrCountTargetClasses)) {
-            if(0 != cTrainingInstances) {
-               InitializeResiduals<2>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), ptrdiff_t { 2 });
-            }
-         } else {
-            if(0 != cTrainingInstances) {
-               InitializeResiduals<k_DynamicClassification>(cTrainingInstances, aTrainingTargets, aTrainingPredictorScores, m_pTrainingSet->GetResidualPointer(), m_runtimeLearningTypeOrCountTargetClasses);
-            }
-         }
+      if(InitializeSamplingSetsAndModels(randomSeed, m_pTrainingDataSet->GetCountTrainingInstances(), m_pTrainingDataSet->m_aTrainingTargets, aTrainingPredictorScores, m_pTrainingDataSet->GetCountValidationInstances(), m_pTrainingDataSet->m_aValidationTargets, aValidationPredictorScores)) {
+         LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeFromDataSet InitializeSamplingSetsAndModels");
+         return true;
       }
 
-      LOG_0(TraceLevelInfo, "Exited EbmTrainingState::Initialize");
+      LOG_0(TraceLevelInfo, "Exited EbmTrainingState::InitializeFromDataSet");
       return false;
    } catch(...) {
-      // this is here to catch exceptions from RandomStream randomStream(randomSeed), but it could also catch errors if we put any other C++ types in here later
-      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::Initialize exception");
+      // this is here to catch exceptions from any C++ types that we put in here later
+      LOG_0(TraceLevelWarning, "WARNING EbmTrainingState::InitializeFromDataSet exception");
       return true;
    }
 }
@@ -397,28 +476,19 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
             const FractionalDataType * pValues = aModelFeatureCombinationUpdateTensor;
             do {
                StorageDataTypeCore targetData = *pTargetData;
-               FractionalDataType sumExp = 0;
-               size_t iVector1 = 0;
-               do {
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
                   // TODO : because there is only one bin for a zero feature feature combination, we could move these values to the stack where the copmiler could reason about their visibility and optimize small arrays into registers
-                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector1];
+                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
                   // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector1] + smallChangeToPredictorScores;
-                  pTrainingPredictorScores[iVector1] = trainingPredictorScores;
-                  sumExp += std::exp(trainingPredictorScores);
-                  ++iVector1;
-               } while(iVector1 < cVectorLength);
-
-               EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(cVectorLength)));
-               const StorageDataTypeCore cVectorLengthStorage = static_cast<StorageDataTypeCore>(cVectorLength);
-               StorageDataTypeCore iVector2 = 0;
-               do {
-                  // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
-                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, pTrainingPredictorScores[iVector2], targetData, iVector2);
-                  *pResidualError = residualError;
-                  ++pResidualError;
-                  ++iVector2;
-               } while(iVector2 < cVectorLengthStorage);
+                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector] + smallChangeToPredictorScores;
+                  pTrainingPredictorScores[iVector] = trainingPredictorScores;
+                  // we park the score and then its exp(..) in the residual slot that this class will overwrite below.  Keeping each step in its own
+                  // loop over the classes lets the compiler vectorize them
+                  pResidualError[iVector] = trainingPredictorScores;
+               }
+               const FractionalDataType sumExp = EbmStatistics::ExpAndSumMulticlass(cVectorLength, pResidualError);
+               EbmStatistics::ComputeClassificationResidualErrorsMulticlassFromExps(cVectorLength, sumExp, targetData, pResidualError);
+               pResidualError += cVectorLength;
                // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
                // 
                // this works out in the math as making the first model vector parameter equal to zero, which in turn removes one degree of freedom
@@ -535,27 +605,18 @@ static void TrainingSetTargetFeatureLoop(const FeatureCombinationCore * const pF
                *pResidualError = residualError;
                ++pResidualError;
             } else {
-               FractionalDataType sumExp = 0;
-               size_t iVector1 = 0;
-               do {
-                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector1];
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+                  const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
                   // this will apply a small fix to our existing TrainingPredictorScores, either positive or negative, whichever is needed
-                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector1] + smallChangeToPredictorScores;
-                  pTrainingPredictorScores[iVector1] = trainingPredictorScores;
-                  sumExp += std::exp(trainingPredictorScores);
-                  ++iVector1;
-               } while(iVector1 < cVectorLength);
-
-               EBM_ASSERT((IsNumberConvertable<StorageDataTypeCore, size_t>(cVectorLength)));
-               const StorageDataTypeCore cVectorLengthStorage = static_cast<StorageDataTypeCore>(cVectorLength);
-               StorageDataTypeCore iVector2 = 0;
-               do {
-                  // TODO : we're calculating exp(predictionScore) above, and then again in ComputeClassificationResidualErrorMulticlass.  exp(..) is expensive so we should just do it once instead and store the result in a small memory array here
-                  const FractionalDataType residualError = EbmStatistics::ComputeClassificationResidualErrorMulticlass(sumExp, pTrainingPredictorScores[iVector2], targetData, iVector2);
-                  *pResidualError = residualError;
-                  ++pResidualError;
-                  ++iVector2;
-               } while(iVector2 < cVectorLengthStorage);
+                  const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector] + smallChangeToPredictorScores;
+                  pTrainingPredictorScores[iVector] = trainingPredictorScores;
+                  // we park the score and then its exp(..) in the residual slot that this class will overwrite below.  Keeping each step in its own
+                  // loop over the classes lets the compiler vectorize them
+                  pResidualError[iVector] = trainingPredictorScores;
+               }
+               const FractionalDataType sumExp = EbmStatistics::ExpAndSumMulticlass(cVectorLength, pResidualError);
+               EbmStatistics::ComputeClassificationResidualErrorsMulticlassFromExps(cVectorLength, sumExp, targetData, pResidualError);
+               pResidualError += cVectorLength;
                // TODO: this works as a way to remove one parameter, but it obviously insn't as efficient as omitting the parameter
                // 
                // this works out in the math as making the first model vector parameter equal to zero, which in turn removes one degree of freedom
@@ -625,13 +686,31 @@ static void TrainingSetInputFeatureLoop(const FeatureCombinationCore * const pFe
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
-template<unsigned int cInputBits, unsigned int cTargetBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+// if bMetric is false we only apply the update and return 0.  Otherwise we return our validation metric and set *pcInstancesScored to the number of
+// instances whose loss we computed rather than reused from pValidationSet->GetInstanceLosses()
+template<unsigned int cInputBits, unsigned int cTargetBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted, bool bMetric>
+static FractionalDataType ValidationSetTargetFeatureLoopInternal(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, size_t * const pcInstancesScored) {
    LOG_0(TraceLevelVerbose, "Entering ValidationSetTargetFeatureLoop");
 
    const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
    const size_t cInstances = pValidationSet->GetCountInstances();
    EBM_ASSERT(0 < cInstances);
+   const FractionalDataType * pWeight = pValidationSet->GetWeights();
+   EBM_ASSERT(!bWeighted || nullptr != pWeight);
+   // when we're unweighted every weight is 1, so our weight total is our count of instances
+   const FractionalDataType weightTotal = bWeighted ? pValidationSet->GetWeightTotal() : static_cast<FractionalDataType>(cInstances);
+   EBM_ASSERT(!bMetric || nullptr != pcInstancesScored);
+
+   // classification keeps each instance's loss.  An instance whose update is zero keeps its score, so if our losses are current it keeps its loss too
+   FractionalDataType * pInstanceLoss = nullptr;
+   bool bInstanceLossesCurrent = false;
+   size_t cInstancesScored = cInstances;
+   if(bMetric && IsClassification(compilerLearningTypeOrCountTargetClasses)) {
+      pInstanceLoss = pValidationSet->GetInstanceLosses();
+      EBM_ASSERT(nullptr != pInstanceLoss);
+      bInstanceLossesCurrent = pValidationSet->AreInstanceLossesCurrent();
+      cInstancesScored = 0;
+   }
 
    if(0 == pFeatureCombination->m_cFeatures) {
       if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
@@ -644,13 +723,24 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          do {
             // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
             const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            rootMeanSquareError += residualError * residualError;
+            if(bMetric) {
+               FractionalDataType instanceLoss = residualError * residualError;
+               if(bWeighted) {
+                  instanceLoss *= *pWeight;
+                  ++pWeight;
+               }
+               rootMeanSquareError += instanceLoss;
+            }
             *pResidualError = residualError;
             ++pResidualError;
          } while(pResidualErrorEnd != pResidualError);
 
-         rootMeanSquareError /= pValidationSet->GetCountInstances();
          LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop - Zero dimensions");
+         if(!bMetric) {
+            return 0;
+         }
+         *pcInstancesScored = cInstancesScored;
+         rootMeanSquareError /= weightTotal;
          return sqrt(rootMeanSquareError);
       } else {
          EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
@@ -662,40 +752,76 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          FractionalDataType sumLogLoss = 0;
          if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
             const FractionalDataType smallChangeToPredictorScores = aModelFeatureCombinationUpdateTensor[0];
+            // the intercept moves every instance or none of them
+            const bool bReuseLosses = bInstanceLossesCurrent && FractionalDataType { 0 } == smallChangeToPredictorScores;
             do {
                StorageDataTypeCore targetData = *pTargetData;
                // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
                const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
                *pValidationPredictorScores = validationPredictorScores;
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
+               if(bMetric) {
+                  FractionalDataType instanceLoss;
+                  if(bReuseLosses) {
+                     instanceLoss = *pInstanceLoss;
+                  } else {
+                     instanceLoss = EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
+                     *pInstanceLoss = instanceLoss;
+                     ++cInstancesScored;
+                  }
+                  ++pInstanceLoss;
+                  if(bWeighted) {
+                     instanceLoss *= *pWeight;
+                     ++pWeight;
+                  }
+                  sumLogLoss += instanceLoss;
+               }
                ++pValidationPredictorScores;
                ++pTargetData;
             } while(pValidationPredictionEnd != pValidationPredictorScores);
          } else {
             const FractionalDataType * pValues = aModelFeatureCombinationUpdateTensor;
+            bool bMoved = false;
+            for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+               bMoved |= FractionalDataType { 0 } != pValues[iVector];
+            }
+            const bool bReuseLosses = bInstanceLossesCurrent && !bMoved;
             do {
                StorageDataTypeCore targetData = *pTargetData;
-               FractionalDataType sumExp = 0;
-               size_t iVector = 0;
-               do {
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
                   const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
                   // this will apply a small fix to our existing validationPredictorScores, either positive or negative, whichever is needed
-
-                  const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
-                  *pValidationPredictorScores = validationPredictorScores;
-                  sumExp += std::exp(validationPredictorScores);
-                  ++pValidationPredictorScores;
-
-                  // TODO : consider replacing iVector with pValidationPredictorScoresInnerEnd
-                  ++iVector;
-               } while(iVector < cVectorLength);
-               // TODO: store the result of std::exp above for the index that we care about above since exp(..) is going to be expensive and probably even more expensive than an unconditional branch
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, pValidationPredictorScores - cVectorLength, targetData);
+                  pValidationPredictorScores[iVector] += smallChangeToPredictorScores;
+               }
+               if(bMetric) {
+                  FractionalDataType instanceLoss;
+                  if(bReuseLosses) {
+                     instanceLoss = *pInstanceLoss;
+                  } else {
+                     // we sum the exps separately from updating the scores so that both loops over the classes can vectorize
+                     const FractionalDataType sumExp = EbmStatistics::SumExpMulticlass(cVectorLength, pValidationPredictorScores);
+                     EBM_ASSERT(static_cast<size_t>(targetData) < cVectorLength);
+                     const FractionalDataType targetExp = EbmStatistics::ExpForMulticlass(cVectorLength, pValidationPredictorScores[static_cast<size_t>(targetData)]);
+                     instanceLoss = EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, targetExp);
+                     *pInstanceLoss = instanceLoss;
+                     ++cInstancesScored;
+                  }
+                  ++pInstanceLoss;
+                  if(bWeighted) {
+                     instanceLoss *= *pWeight;
+                     ++pWeight;
+                  }
+                  sumLogLoss += instanceLoss;
+               }
+               pValidationPredictorScores += cVectorLength;
                ++pTargetData;
             } while(pValidationPredictionEnd != pValidationPredictorScores);
          }
          LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop - Zero dimensions");
-         return sumLogLoss /= pValidationSet->GetCountInstances();
+         if(!bMetric) {
+            return 0;
+         }
+         *pcInstancesScored = cInstancesScored;
+         return sumLogLoss / weightTotal;
       }
       EBM_ASSERT(false);
    }
@@ -737,7 +863,14 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
             const FractionalDataType smallChangeToPrediction = aModelFeatureCombinationUpdateTensor[iTensorBin * cVectorLength];
             // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
             const FractionalDataType residualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - smallChangeToPrediction);
-            rootMeanSquareError += residualError * residualError;
+            if(bMetric) {
+               FractionalDataType instanceLoss = residualError * residualError;
+               if(bWeighted) {
+                  instanceLoss *= *pWeight;
+                  ++pWeight;
+               }
+               rootMeanSquareError += instanceLoss;
+            }
             *pResidualError = residualError;
             ++pResidualError;
 
@@ -759,8 +892,12 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
          goto one_last_loop_regression;
       }
 
-      rootMeanSquareError /= pValidationSet->GetCountInstances();
       LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop");
+      if(!bMetric) {
+         return 0;
+      }
+      *pcInstancesScored = cInstancesScored;
+      rootMeanSquareError /= weightTotal;
       return sqrt(rootMeanSquareError);
    } else {
       EBM_ASSERT(IsClassification(compilerLearningTypeOrCountTargetClasses));
@@ -799,25 +936,52 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
                // this will apply a small fix to our existing ValidationPredictorScores, either positive or negative, whichever is needed
                const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
                *pValidationPredictorScores = validationPredictorScores;
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
+               if(bMetric) {
+                  FractionalDataType instanceLoss;
+                  if(bInstanceLossesCurrent && FractionalDataType { 0 } == smallChangeToPredictorScores) {
+                     instanceLoss = *pInstanceLoss;
+                  } else {
+                     instanceLoss = EbmStatistics::ComputeClassificationSingleInstanceLogLossBinaryclass(validationPredictorScores, targetData);
+                     *pInstanceLoss = instanceLoss;
+                     ++cInstancesScored;
+                  }
+                  ++pInstanceLoss;
+                  if(bWeighted) {
+                     instanceLoss *= *pWeight;
+                     ++pWeight;
+                  }
+                  sumLogLoss += instanceLoss;
+               }
                ++pValidationPredictorScores;
             } else {
-               FractionalDataType sumExp = 0;
-               size_t iVector = 0;
-               do {
+               bool bMoved = false;
+               for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
                   const FractionalDataType smallChangeToPredictorScores = pValues[iVector];
+                  bMoved |= FractionalDataType { 0 } != smallChangeToPredictorScores;
                   // this will apply a small fix to our existing validationPredictorScores, either positive or negative, whichever is needed
-
-                  const FractionalDataType validationPredictorScores = *pValidationPredictorScores + smallChangeToPredictorScores;
-                  *pValidationPredictorScores = validationPredictorScores;
-                  sumExp += std::exp(validationPredictorScores);
-                  ++pValidationPredictorScores;
-
-                  // TODO : consider replacing iVector with pValidationPredictorScoresInnerEnd
-                  ++iVector;
-               } while(iVector < cVectorLength);
-               // TODO: store the result of std::exp above for the index that we care about above since exp(..) is going to be expensive and probably even more expensive than an unconditional branch
-               sumLogLoss += EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, pValidationPredictorScores - cVectorLength, targetData);
+                  pValidationPredictorScores[iVector] += smallChangeToPredictorScores;
+               }
+               if(bMetric) {
+                  FractionalDataType instanceLoss;
+                  if(bInstanceLossesCurrent && !bMoved) {
+                     instanceLoss = *pInstanceLoss;
+                  } else {
+                     // we sum the exps separately from updating the scores so that both loops over the classes can vectorize
+                     const FractionalDataType sumExp = EbmStatistics::SumExpMulticlass(cVectorLength, pValidationPredictorScores);
+                     EBM_ASSERT(static_cast<size_t>(targetData) < cVectorLength);
+                     const FractionalDataType targetExp = EbmStatistics::ExpForMulticlass(cVectorLength, pValidationPredictorScores[static_cast<size_t>(targetData)]);
+                     instanceLoss = EbmStatistics::ComputeClassificationSingleInstanceLogLossMulticlass(sumExp, targetExp);
+                     *pInstanceLoss = instanceLoss;
+                     ++cInstancesScored;
+                  }
+                  ++pInstanceLoss;
+                  if(bWeighted) {
+                     instanceLoss *= *pWeight;
+                     ++pWeight;
+                  }
+                  sumLogLoss += instanceLoss;
+               }
+               pValidationPredictorScores += cVectorLength;
             }
             ++pTargetData;
 
@@ -840,36 +1004,53 @@ static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinatio
       }
 
       LOG_0(TraceLevelVerbose, "Exited ValidationSetTargetFeatureLoop");
-      return sumLogLoss /= pValidationSet->GetCountInstances();
+      if(!bMetric) {
+         return 0;
+      }
+      *pcInstancesScored = cInstancesScored;
+      return sumLogLoss / weightTotal;
    }
 }
 
+// pcInstancesScored is nullptr if we only need to apply the update without computing our metric
+template<unsigned int cInputBits, unsigned int cTargetBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static FractionalDataType ValidationSetTargetFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, size_t * const pcInstancesScored) {
+   // without a metric our weights don't matter, so the first row applies the update alone
+   static FractionalDataType (* const s_aValidationSetTargetFeatureLoop[3])(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, size_t * const pcInstancesScored) = {
+      &ValidationSetTargetFeatureLoopInternal<cInputBits, cTargetBits, compilerLearningTypeOrCountTargetClasses, false, false>,
+      &ValidationSetTargetFeatureLoopInternal<cInputBits, cTargetBits, compilerLearningTypeOrCountTargetClasses, false, true>,
+      &ValidationSetTargetFeatureLoopInternal<cInputBits, cTargetBits, compilerLearningTypeOrCountTargetClasses, true, true>
+   };
+   const size_t iMode = nullptr == pcInstancesScored ? size_t { 0 } : nullptr == pValidationSet->GetWeights() ? size_t { 1 } : size_t { 2 };
+   return (*s_aValidationSetTargetFeatureLoop[iMode])(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
+}
+
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<unsigned int cInputBits, ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static FractionalDataType ValidationSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses) {
+static FractionalDataType ValidationSetInputFeatureLoop(const FeatureCombinationCore * const pFeatureCombination, DataSetByFeatureCombination * const pValidationSet, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, size_t * const pcInstancesScored) {
    if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 1) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 2) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 2, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 4) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 4, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 8) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 8, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else if(static_cast<size_t>(runtimeLearningTypeOrCountTargetClasses) <= 1 << 16) {
-      return ValidationSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 16, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else if(static_cast<uint64_t>(runtimeLearningTypeOrCountTargetClasses) <= uint64_t { 1 } << 32) {
       // if this is a 32 bit system, then m_cBins can't be 0x100000000 or above, because we would have checked that when converting the 64 bit numbers into size_t, and m_cBins will be promoted to a 64 bit number for the above comparison
       // if this is a 64 bit system, then this comparison is fine
 
       // TODO : perhaps we should change m_cBins into m_iBinMax so that we don't need to do the above promotion to 64 bits.. we can make it <= 0xFFFFFFFF.  Write a function to fill the lowest bits with ones for any number of bits
 
-      return ValidationSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 32, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    } else {
       // our interface doesn't allow more than 64 bits, so even if size_t was bigger then we don't need to examine higher
       static_assert(63 == CountBitsRequiredPositiveMax<IntegerDataType>(), "");
-      return ValidationSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses);
+      return ValidationSetTargetFeatureLoop<cInputBits, 64, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, runtimeLearningTypeOrCountTargetClasses, pcInstancesScored);
    }
 }
 
@@ -901,10 +1082,104 @@ void CheckTargets(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const
 }
 #endif // NDEBUG
 
+// with sparse columns, binning derives each dominant bin's bucket from our sampling sets' totals.  Sparse and intercept updates keep those totals
+// current as they go, but after anything else we recompute them, and since that visits every residual anyways it's also where we fold the residual
+// shift back into the stored residuals, which keeps the shift from growing large enough to cost the residuals precision
+static void SyncSparseResidualTotals(EbmTrainingState * const pEbmTrainingState) {
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   EBM_ASSERT(nullptr != pTrainingSet);
+   EBM_ASSERT(pTrainingSet->HasSparseColumns());
+   EBM_ASSERT(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses));
+
+   const size_t cInstances = pTrainingSet->GetCountInstances();
+   FractionalDataType * const aResidualErrors = pTrainingSet->GetResidualPointer();
+   const FractionalDataType residualShift = pTrainingSet->GetResidualShift();
+   if(0 != residualShift) {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         aResidualErrors[iInstance] -= residualShift;
+      }
+      pTrainingSet->SetResidualShift(0);
+   }
+
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      SamplingMethod * const pSamplingSet = pEbmTrainingState->m_apSamplingSets[iSamplingSet];
+      size_t cOccurrencesTotal = 0;
+      FractionalDataType weightTotal = 0;
+      FractionalDataType sumResidualErrorTotal = 0;
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         FractionalDataType weightedOccurrences;
+         cOccurrencesTotal += GetInstanceOccurrences(pSamplingSet, iInstance, &weightedOccurrences);
+         weightTotal += weightedOccurrences;
+         sumResidualErrorTotal += weightedOccurrences * aResidualErrors[iInstance];
+      }
+      pSamplingSet->m_cOccurrencesTotal = cOccurrencesTotal;
+      pSamplingSet->m_weightTotal = weightTotal;
+      pSamplingSet->m_sumResidualErrorTotal = sumResidualErrorTotal;
+   }
+}
+
+// the sparse version of TrainingSetInputFeatureLoop for regression.  pSparseColumn is nullptr for the intercept.  Every instance in the dominant bin (or
+// every instance, for the intercept) moves by the same amount, which we add to the residual shift, so we only write the residuals of the exceptions
+static void TrainingSetSparseUpdateRegression(EbmTrainingState * const pEbmTrainingState, const SparseColumn * const pSparseColumn, const FractionalDataType * const aModelFeatureCombinationUpdateTensor) {
+   LOG_0(TraceLevelVerbose, "Entered TrainingSetSparseUpdateRegression");
+
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   EBM_ASSERT(nullptr != pTrainingSet);
+   EBM_ASSERT(pTrainingSet->HasSparseColumns());
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   SamplingMethod * const * const apSamplingSets = pEbmTrainingState->m_apSamplingSets;
+
+   const FractionalDataType dominantUpdate = nullptr == pSparseColumn ? aModelFeatureCombinationUpdateTensor[0] : aModelFeatureCombinationUpdateTensor[pSparseColumn->m_iDominantBin];
+   pTrainingSet->SetResidualShift(pTrainingSet->GetResidualShift() + dominantUpdate);
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      apSamplingSets[iSamplingSet]->m_sumResidualErrorTotal -= dominantUpdate * apSamplingSets[iSamplingSet]->m_weightTotal;
+   }
+
+   if(nullptr != pSparseColumn) {
+      // the shift moved the exceptions by the dominant bin's update too, so they only need the difference
+      FractionalDataType * const aResidualErrors = pTrainingSet->GetResidualPointer();
+      const SparseException * pException = pSparseColumn->m_aExceptions;
+      const SparseException * const pExceptionEnd = pException + pSparseColumn->m_cExceptions;
+      for(; pExceptionEnd != pException; ++pException) {
+         const size_t iInstance = pException->m_iInstance;
+         const FractionalDataType update = aModelFeatureCombinationUpdateTensor[pException->m_iBin] - dominantUpdate;
+         aResidualErrors[iInstance] = EbmStatistics::ComputeRegressionResidualError(aResidualErrors[iInstance] - update);
+         for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+            FractionalDataType weightedOccurrences;
+            GetInstanceOccurrences(apSamplingSets[iSamplingSet], iInstance, &weightedOccurrences);
+            apSamplingSets[iSamplingSet]->m_sumResidualErrorTotal -= weightedOccurrences * update;
+         }
+      }
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited TrainingSetSparseUpdateRegression");
+}
+
+// builds the sparse columns for TrainingOptionsSparseDominantBins.  Returns true on error
+static bool InitializeSparseColumns(EbmTrainingState * const pEbmTrainingState) {
+   if(!IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+      LOG_0(TraceLevelInfo, "InitializeSparseColumns TrainingOptionsSparseDominantBins only applies to regression, so classification stays dense");
+      return false;
+   }
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   if(nullptr == pTrainingSet) {
+      return false;
+   }
+   if(pTrainingSet->BuildSparseColumns(pEbmTrainingState->m_cFeatureCombinations, pEbmTrainingState->m_apFeatureCombinations)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeSparseColumns pTrainingSet->BuildSparseColumns");
+      return true;
+   }
+   if(pTrainingSet->HasSparseColumns()) {
+      SyncSparseResidualTotals(pEbmTrainingState);
+   }
+   return false;
+}
+
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
-EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const void * const trainingTargets, const IntegerDataType * const trainingBinnedData, const FractionalDataType * const trainingPredictorScores, const IntegerDataType countValidationInstances, const void * const validationTargets, const IntegerDataType * const validationBinnedData, const FractionalDataType * const validationPredictorScores, const IntegerDataType countInnerBags) {
+EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const IntegerDataType countFeatures, const EbmCoreFeature * const features, const IntegerDataType countFeatureCombinations, const EbmCoreFeatureCombination * const featureCombinations, const IntegerDataType * const featureCombinationIndexes, const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const IntegerDataType countTrainingInstances, const void * const trainingTargets, const IntegerDataType * const trainingBinnedData, const FractionalDataType * const trainingPredictorScores, const IntegerDataType countValidationInstances, const void * const validationTargets, const IntegerDataType * const validationBinnedData, const FractionalDataType * const validationPredictorScores, const IntegerDataType countInnerBags, const IntegerDataType trainingOptions) {
    // TODO: turn these EBM_ASSERTS into log errors!!  Small checks like this of our wrapper's inputs hardly cost anything, and catch issues faster
 
    // randomSeed can be any value
@@ -945,6 +1220,13 @@ EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const
       return nullptr;
    }
 
+   if(0 != (trainingOptions & ~(TrainingOptionsBorrowBuffers | TrainingOptionsSparseDominantBins))) {
+      LOG_0(TraceLevelError, "ERROR AllocateCore trainingOptions contains unknown options");
+      return nullptr;
+   }
+   const bool bBorrowBuffers = 0 != (trainingOptions & TrainingOptionsBorrowBuffers);
+   const bool bSparseDominantBins = 0 != (trainingOptions & TrainingOptionsSparseDominantBins);
+
    size_t cFeatures = static_cast<size_t>(countFeatures);
    size_t cFeatureCombinations = static_cast<size_t>(countFeatureCombinations);
    size_t cTrainingInstances = static_cast<size_t>(countTrainingInstances);
@@ -974,15 +1256,20 @@ EbmTrainingState * AllocateCoreTraining(const IntegerDataType randomSeed, const
       LOG_0(TraceLevelWarning, "WARNING AllocateCore nullptr == pEbmTrainingState");
       return nullptr;
    }
-   if(UNLIKELY(pEbmTrainingState->Initialize(randomSeed, features, featureCombinations, featureCombinationIndexes, cTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, cValidationInstances, validationTargets, validationBinnedData, validationPredictorScores))) {
+   if(UNLIKELY(pEbmTrainingState->Initialize(randomSeed, features, featureCombinations, featureCombinationIndexes, cTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, cValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, bBorrowBuffers))) {
       LOG_0(TraceLevelWarning, "WARNING AllocateCore pEbmTrainingState->Initialize");
       delete pEbmTrainingState;
       return nullptr;
    }
+   if(bSparseDominantBins && InitializeSparseColumns(pEbmTrainingState)) {
+      LOG_0(TraceLevelWarning, "WARNING AllocateCore InitializeSparseColumns");
+      delete pEbmTrainingState;
+      return nullptr;
+   }
    return pEbmTrainingState;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegression(
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegressionWithOptions(
    IntegerDataType randomSeed,
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
@@ -997,70 +1284,373 @@ EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTra
    const FractionalDataType * validationTargets,
    const IntegerDataType * validationBinnedData,
    const FractionalDataType * validationPredictorScores,
-   IntegerDataType countInnerBags
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeTrainingRegression: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
-   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
-   LOG_N(TraceLevelInfo, "Exited InitializeTrainingRegression %p", static_cast<void *>(pEbmTraining));
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingRegressionWithOptions: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf ", trainingOptions=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags, trainingOptions);
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, k_Regression, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags, trainingOptions));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingRegressionWithOptions %p", static_cast<void *>(pEbmTraining));
    return pEbmTraining;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassification(
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegression(
    IntegerDataType randomSeed,
    IntegerDataType countFeatures,
    const EbmCoreFeature * features,
    IntegerDataType countFeatureCombinations,
    const EbmCoreFeatureCombination * featureCombinations,
    const IntegerDataType * featureCombinationIndexes,
-   IntegerDataType countTargetClasses,
    IntegerDataType countTrainingInstances,
-   const IntegerDataType * trainingTargets,
+   const FractionalDataType * trainingTargets,
    const IntegerDataType * trainingBinnedData,
    const FractionalDataType * trainingPredictorScores,
    IntegerDataType countValidationInstances,
-   const IntegerDataType * validationTargets,
+   const FractionalDataType * validationTargets,
    const IntegerDataType * validationBinnedData,
    const FractionalDataType * validationPredictorScores,
    IntegerDataType countInnerBags
 ) {
-   LOG_N(TraceLevelInfo, "Entered InitializeTrainingClassification: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags);
-   if(countTargetClasses < 0) {
-      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassification countTargetClasses can't be negative");
-      return nullptr;
-   }
-   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
-      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassification countTargetClasses can't be zero unless there are no training and no validation cases");
-      return nullptr;
-   }
-   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
-      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingClassification !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
-      return nullptr;
-   }
-   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
-   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags));
-   LOG_N(TraceLevelInfo, "Exited InitializeTrainingClassification %p", static_cast<void *>(pEbmTraining));
-   return pEbmTraining;
+   LOG_0(TraceLevelInfo, "Entered InitializeTrainingRegression");
+   return InitializeTrainingRegressionWithOptions(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags, TrainingOptionsNone);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassificationWithOptions(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingTargets,
+   const IntegerDataType * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationTargets,
+   const IntegerDataType * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingClassificationWithOptions: randomSeed=%" IntegerDataTypePrintf ", countFeatures=%" IntegerDataTypePrintf ", features=%p, countFeatureCombinations=%" IntegerDataTypePrintf ", featureCombinations=%p, featureCombinationIndexes=%p, countTargetClasses=%" IntegerDataTypePrintf ", countTrainingInstances=%" IntegerDataTypePrintf ", trainingTargets=%p, trainingBinnedData=%p, trainingPredictorScores=%p, countValidationInstances=%" IntegerDataTypePrintf ", validationTargets=%p, validationBinnedData=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf ", trainingOptions=%" IntegerDataTypePrintf, randomSeed, countFeatures, static_cast<const void *>(features), countFeatureCombinations, static_cast<const void *>(featureCombinations), static_cast<const void *>(featureCombinationIndexes), countTargetClasses, countTrainingInstances, static_cast<const void *>(trainingTargets), static_cast<const void *>(trainingBinnedData), static_cast<const void *>(trainingPredictorScores), countValidationInstances, static_cast<const void *>(validationTargets), static_cast<const void *>(validationBinnedData), static_cast<const void *>(validationPredictorScores), countInnerBags, trainingOptions);
+   if(countTargetClasses < 0) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassificationWithOptions countTargetClasses can't be negative");
+      return nullptr;
+   }
+   if(0 == countTargetClasses && (0 != countTrainingInstances || 0 != countValidationInstances)) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingClassificationWithOptions countTargetClasses can't be zero unless there are no training and no validation cases");
+      return nullptr;
+   }
+   if(!IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingClassificationWithOptions !IsNumberConvertable<ptrdiff_t, IntegerDataType>(countTargetClasses)");
+      return nullptr;
+   }
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = static_cast<ptrdiff_t>(countTargetClasses);
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(AllocateCoreTraining(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, runtimeLearningTypeOrCountTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags, trainingOptions));
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingClassificationWithOptions %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassification(
+   IntegerDataType randomSeed,
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countTrainingInstances,
+   const IntegerDataType * trainingTargets,
+   const IntegerDataType * trainingBinnedData,
+   const FractionalDataType * trainingPredictorScores,
+   IntegerDataType countValidationInstances,
+   const IntegerDataType * validationTargets,
+   const IntegerDataType * validationBinnedData,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags
+) {
+   LOG_0(TraceLevelInfo, "Entered InitializeTrainingClassification");
+   return InitializeTrainingClassificationWithOptions(randomSeed, countFeatures, features, countFeatureCombinations, featureCombinations, featureCombinationIndexes, countTargetClasses, countTrainingInstances, trainingTargets, trainingBinnedData, trainingPredictorScores, countValidationInstances, validationTargets, validationBinnedData, validationPredictorScores, countInnerBags, TrainingOptionsNone);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingFromDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet,
+   IntegerDataType randomSeed,
+   const FractionalDataType * trainingPredictorScores,
+   const FractionalDataType * validationPredictorScores,
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
+) {
+   LOG_N(TraceLevelInfo, "Entered InitializeTrainingFromDataSet: ebmTrainingDataSet=%p, randomSeed=%" IntegerDataTypePrintf ", trainingPredictorScores=%p, validationPredictorScores=%p, countInnerBags=%" IntegerDataTypePrintf ", trainingOptions=%" IntegerDataTypePrintf, static_cast<void *>(ebmTrainingDataSet), randomSeed, static_cast<const void *>(trainingPredictorScores), static_cast<const void *>(validationPredictorScores), countInnerBags, trainingOptions);
+
+   EbmTrainingDataSet * const pEbmTrainingDataSet = reinterpret_cast<EbmTrainingDataSet *>(ebmTrainingDataSet);
+   EBM_ASSERT(nullptr != pEbmTrainingDataSet);
+   EBM_ASSERT(0 <= countInnerBags); // 0 means use the full set (good value).  1 means make a single bag (this is useless but allowed for comparison purposes).  2+ are good numbers of bag
+
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet !IsNumberConvertable<size_t, IntegerDataType>(countInnerBags)");
+      return nullptr;
+   }
+   if(0 != (trainingOptions & ~(TrainingOptionsBorrowBuffers | TrainingOptionsSparseDominantBins))) {
+      LOG_0(TraceLevelError, "ERROR InitializeTrainingFromDataSet trainingOptions contains unknown options");
+      return nullptr;
+   }
+   const bool bBorrowBuffers = 0 != (trainingOptions & TrainingOptionsBorrowBuffers);
+   const bool bSparseDominantBins = 0 != (trainingOptions & TrainingOptionsSparseDominantBins);
+   const size_t cInnerBags = static_cast<size_t>(countInnerBags);
+
+   pEbmTrainingDataSet->AddReference();
+   // from here on the EbmTrainingState owns the reference that we just added, and releases it when it is deleted
+   EbmTrainingState * const pEbmTrainingState = new (std::nothrow) EbmTrainingState(pEbmTrainingDataSet, cInnerBags);
+   if(UNLIKELY(nullptr == pEbmTrainingState)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet nullptr == pEbmTrainingState");
+      EbmTrainingDataSet::Release(pEbmTrainingDataSet);
+      return nullptr;
+   }
+   if(UNLIKELY(pEbmTrainingState->InitializeFromDataSet(randomSeed, trainingPredictorScores, validationPredictorScores, bBorrowBuffers))) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet pEbmTrainingState->InitializeFromDataSet");
+      delete pEbmTrainingState;
+      return nullptr;
+   }
+   if(bSparseDominantBins && InitializeSparseColumns(pEbmTrainingState)) {
+      LOG_0(TraceLevelWarning, "WARNING InitializeTrainingFromDataSet InitializeSparseColumns");
+      delete pEbmTrainingState;
+      return nullptr;
+   }
+   const PEbmTraining pEbmTraining = reinterpret_cast<PEbmTraining>(pEbmTrainingState);
+   LOG_N(TraceLevelInfo, "Exited InitializeTrainingFromDataSet %p", static_cast<void *>(pEbmTraining));
+   return pEbmTraining;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SampleTrainingWithoutReplacement(
+   PEbmTraining ebmTraining,
+   IntegerDataType randomSeed,
+   FractionalDataType subsampleFraction
+) {
+   LOG_N(TraceLevelInfo, "Entered SampleTrainingWithoutReplacement: ebmTraining=%p, randomSeed=%" IntegerDataTypePrintf ", subsampleFraction=%" FractionalDataTypePrintf, static_cast<void *>(ebmTraining), randomSeed, subsampleFraction);
+
+   EbmTrainingState * const pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   // written this way so that NaN fails the check
+   if(!(0 < subsampleFraction && subsampleFraction <= 1)) {
+      LOG_0(TraceLevelError, "ERROR SampleTrainingWithoutReplacement subsampleFraction must be in the range (0, 1]");
+      return 1;
+   }
+
+   if(nullptr == pEbmTrainingState->m_pTrainingSet) {
+      // there are no training instances to sample, so there's nothing to replace
+      LOG_0(TraceLevelInfo, "Exited SampleTrainingWithoutReplacement with no training instances");
+      return 0;
+   }
+
+   RandomStream randomStream(randomSeed);
+   SamplingMethod ** const apSamplingSets = SamplingWithoutReplacement::GenerateSamplingSets(&randomStream, pEbmTrainingState->m_pTrainingSet, pEbmTrainingState->m_cSamplingSets, subsampleFraction);
+   if(UNLIKELY(nullptr == apSamplingSets)) {
+      LOG_0(TraceLevelWarning, "WARNING SampleTrainingWithoutReplacement nullptr == apSamplingSets");
+      return 1;
+   }
+   SamplingMethod::FreeSamplingSets(pEbmTrainingState->m_cSamplingSets, pEbmTrainingState->m_apSamplingSets);
+   pEbmTrainingState->m_apSamplingSets = apSamplingSets;
+   if(pEbmTrainingState->m_pTrainingSet->HasSparseColumns()) {
+      SyncSparseResidualTotals(pEbmTrainingState);
+   }
+   // any histograms cached for the old sampling sets are no longer valid
+   ++pEbmTrainingState->m_iResidualGeneration;
+
+   LOG_0(TraceLevelInfo, "Exited SampleTrainingWithoutReplacement");
+   return 0;
+}
+
+static bool IsInstanceWeightsError(const size_t cInstances, const FractionalDataType * const aWeights) {
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      const FractionalDataType weight = aWeights[iInstance];
+      // written this way so that NaN fails the check
+      if(!(0 < weight) || std::isinf(weight)) {
+         return true;
+      }
+   }
+   return false;
+}
+
+// our bootstrap sampling sets fold the training weights into their occurrence counts.  SamplingWithoutReplacement sets read the weights from the
+// training set directly, so they don't need anything from us
+static bool FoldTrainingWeights(EbmTrainingState * const pEbmTrainingState) {
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      SamplingMethod * const pSamplingSet = pEbmTrainingState->m_apSamplingSets[iSamplingSet];
+      if(SamplingMethodType::WithReplacement == pSamplingSet->m_samplingMethodType) {
+         if(static_cast<SamplingWithReplacement *>(pSamplingSet)->FoldWeights()) {
+            return true;
+         }
+      }
+   }
+   return false;
+}
+
+// puts both of our datasets back to unweighted after SetInstanceWeights fails partway.  Going back to unweighted doesn't allocate, so this can't fail,
+// and it leaves our sampling sets and sparse residual totals consistent with the training set
+static void ClearInstanceWeights(EbmTrainingState * const pEbmTrainingState) {
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   if(nullptr != pTrainingSet) {
+      pTrainingSet->SetWeights(nullptr);
+      FoldTrainingWeights(pEbmTrainingState);
+      if(pTrainingSet->HasSparseColumns()) {
+         SyncSparseResidualTotals(pEbmTrainingState);
+      }
+   }
+   DataSetByFeatureCombination * const pValidationSet = pEbmTrainingState->m_pValidationSet;
+   if(nullptr != pValidationSet) {
+      pValidationSet->SetWeights(nullptr);
+   }
+   // any histograms cached with the weights that we just removed are no longer valid
+   ++pEbmTrainingState->m_iResidualGeneration;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetInstanceWeights(
+   PEbmTraining ebmTraining,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights
+) {
+   LOG_N(TraceLevelInfo, "Entered SetInstanceWeights: ebmTraining=%p, trainingWeights=%p, validationWeights=%p", static_cast<void *>(ebmTraining), static_cast<const void *>(trainingWeights), static_cast<const void *>(validationWeights));
+
+   EbmTrainingState * const pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   // our best model was chosen by comparing metrics, so changing how the validation metric is weighted partway through would compare apples to oranges
+   if(pEbmTrainingState->m_bUpdatesApplied) {
+      LOG_0(TraceLevelError, "ERROR SetInstanceWeights needs to be called before the first ApplyModelFeatureCombinationUpdate");
+      return 1;
+   }
+
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   DataSetByFeatureCombination * const pValidationSet = pEbmTrainingState->m_pValidationSet;
+   // if a set has no instances it will be nullptr, and any weights for it are ignored
+   if(nullptr != trainingWeights && nullptr != pTrainingSet && IsInstanceWeightsError(pTrainingSet->GetCountInstances(), trainingWeights)) {
+      LOG_0(TraceLevelError, "ERROR SetInstanceWeights trainingWeights must be positive and finite");
+      return 1;
+   }
+   if(nullptr != validationWeights && nullptr != pValidationSet && IsInstanceWeightsError(pValidationSet->GetCountInstances(), validationWeights)) {
+      LOG_0(TraceLevelError, "ERROR SetInstanceWeights validationWeights must be positive and finite");
+      return 1;
+   }
+
+   // the validation weights don't touch our residuals, so we set them first and only fold the training weights once nothing else can fail
+   if(nullptr != pValidationSet) {
+      if(pValidationSet->SetWeights(validationWeights)) {
+         LOG_0(TraceLevelWarning, "WARNING SetInstanceWeights failed to set the validation weights");
+         ClearInstanceWeights(pEbmTrainingState);
+         return 1;
+      }
+   }
+   if(nullptr != pTrainingSet) {
+      if(pTrainingSet->SetWeights(trainingWeights) || FoldTrainingWeights(pEbmTrainingState)) {
+         LOG_0(TraceLevelWarning, "WARNING SetInstanceWeights failed to set the training weights");
+         ClearInstanceWeights(pEbmTrainingState);
+         return 1;
+      }
+      if(pTrainingSet->HasSparseColumns()) {
+         SyncSparseResidualTotals(pEbmTrainingState);
+      }
+   }
+   // any histograms cached with the old weights are no longer valid
+   ++pEbmTrainingState->m_iResidualGeneration;
+
+   LOG_0(TraceLevelInfo, "Exited SetInstanceWeights");
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION SetValidationMetricInterval(
+   PEbmTraining ebmTraining,
+   IntegerDataType countUpdatesPerValidationMetric
+) {
+   LOG_N(TraceLevelInfo, "Entered SetValidationMetricInterval: ebmTraining=%p, countUpdatesPerValidationMetric=%" IntegerDataTypePrintf, static_cast<void *>(ebmTraining), countUpdatesPerValidationMetric);
+
+   EbmTrainingState * const pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   if(countUpdatesPerValidationMetric < IntegerDataType { 0 }) {
+      LOG_0(TraceLevelError, "ERROR SetValidationMetricInterval countUpdatesPerValidationMetric < 0");
+      return 1;
+   }
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countUpdatesPerValidationMetric)) {
+      LOG_0(TraceLevelWarning, "WARNING SetValidationMetricInterval !IsNumberConvertable<size_t, IntegerDataType>(countUpdatesPerValidationMetric)");
+      return 1;
+   }
+   pEbmTrainingState->m_cUpdatesPerValidationMetric = static_cast<size_t>(countUpdatesPerValidationMetric);
+   // start counting from here so that the next metric comes countUpdatesPerValidationMetric updates from now
+   pEbmTrainingState->m_cUpdatesSinceValidationMetric = 0;
+
+   LOG_0(TraceLevelInfo, "Exited SetValidationMetricInterval");
+   return 0;
 }
 
 template<bool bClassification>
-EBM_INLINE CachedTrainingThreadResources<bClassification> * GetCachedThreadResources(EbmTrainingState * pEbmTrainingState);
+EBM_INLINE CachedTrainingThreadResources<bClassification> * GetCachedThreadResources(EbmTrainingWorkspace * pEbmTrainingWorkspace, const size_t iThread);
 template<>
-EBM_INLINE CachedTrainingThreadResources<true> * GetCachedThreadResources<true>(EbmTrainingState * pEbmTrainingState) {
-   return &pEbmTrainingState->m_cachedThreadResourcesUnion.classification;
+EBM_INLINE CachedTrainingThreadResources<true> * GetCachedThreadResources<true>(EbmTrainingWorkspace * pEbmTrainingWorkspace, const size_t iThread) {
+   EBM_ASSERT(iThread < pEbmTrainingWorkspace->m_cCachedThreadResources);
+   return &pEbmTrainingWorkspace->m_aCachedThreadResourcesUnion[iThread].classification;
 }
 template<>
-EBM_INLINE CachedTrainingThreadResources<false> * GetCachedThreadResources<false>(EbmTrainingState * pEbmTrainingState) {
-   return &pEbmTrainingState->m_cachedThreadResourcesUnion.regression;
+EBM_INLINE CachedTrainingThreadResources<false> * GetCachedThreadResources<false>(EbmTrainingWorkspace * pEbmTrainingWorkspace, const size_t iThread) {
+   EBM_ASSERT(iThread < pEbmTrainingWorkspace->m_cCachedThreadResources);
+   return &pEbmTrainingWorkspace->m_aCachedThreadResourcesUnion[iThread].regression;
+}
+
+struct TrainSamplingSetContext {
+   const EbmTrainingState * m_pEbmTrainingState;
+   EbmTrainingWorkspace * m_pEbmTrainingWorkspace;
+   const FeatureCombinationCore * m_pFeatureCombination;
+   size_t m_iFeatureCombination;
+   // nullptr if the ThreadPool is busy training sampling sets, in which case each sampling set bins its data on the thread it was given
+   ThreadPool * m_pThreadPoolBinning;
+   size_t m_cTreeSplitsMax;
+   size_t m_cInstancesRequiredForParentSplitMin;
+};
+
+// this is a THREAD_POOL_TASK.  Each sampling set writes only to its own tensor and gain slot, and each thread has its own CachedTrainingThreadResources,
+// so the only thing shared between simultaneous calls is read-only data in our EbmTrainingState
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static bool TrainSamplingSet(void * const pContext, const size_t iThread, const size_t iSamplingSet) {
+   const TrainSamplingSetContext * const pTrainSamplingSetContext = static_cast<const TrainSamplingSetContext *>(pContext);
+   const EbmTrainingState * const pEbmTrainingState = pTrainSamplingSetContext->m_pEbmTrainingState;
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pTrainSamplingSetContext->m_pEbmTrainingWorkspace;
+   const FeatureCombinationCore * const pFeatureCombination = pTrainSamplingSetContext->m_pFeatureCombination;
+
+   CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingWorkspace, iThread);
+   // our thread resources belong to the workspace, which doesn't know its EbmTrainingState, so we point them at our statistics here
+   pCachedThreadResources->m_pStatistics = &pEbmTrainingState->m_statistics;
+   const SamplingMethod * const pSamplingSet = pEbmTrainingState->m_apSamplingSets[iSamplingSet];
+   SegmentedTensor<ActiveDataType, FractionalDataType> * const pSmallChangeToModelOverwriteSingleSamplingSet = pEbmTrainingWorkspace->m_apSmallChangeToModelOverwriteSingleSamplingSet[iSamplingSet];
+   pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDimensions(pFeatureCombination->m_cFeatures);
+   HistogramCache * const pHistogramCache = &pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet];
+   pHistogramCache->SetKey(pTrainSamplingSetContext->m_iFeatureCombination, pEbmTrainingState->m_iResidualGeneration);
+
+   FractionalDataType gain = 0;
+   if(0 == pFeatureCombination->m_cFeatures) {
+      if(TrainZeroDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pHistogramCache, pSamplingSet, pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+         return true;
+      }
+   } else if(1 == pFeatureCombination->m_cFeatures) {
+      if(TrainSingleDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pTrainSamplingSetContext->m_pThreadPoolBinning, pHistogramCache, pSamplingSet, pFeatureCombination, pTrainSamplingSetContext->m_cTreeSplitsMax, pTrainSamplingSetContext->m_cInstancesRequiredForParentSplitMin, pSmallChangeToModelOverwriteSingleSamplingSet, &gain, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+         return true;
+      }
+   } else {
+      if(RecursiveTrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 2>::Recursive(pFeatureCombination->m_cFeatures, pCachedThreadResources, pTrainSamplingSetContext->m_pThreadPoolBinning, pHistogramCache, pSamplingSet, pFeatureCombination, pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+         return true;
+      }
+   }
+   pEbmTrainingWorkspace->m_aSamplingSetGains[iSamplingSet] = gain;
+   return false;
 }
 
 // a*PredictorScores = logOdds for binary classification
 // a*PredictorScores = logWeights for multiclass classification
 // a*PredictorScores = predictedValue for regression
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasses(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, const FractionalDataType * const aTrainingWeights, const FractionalDataType * const aValidationWeights, FractionalDataType * const pGainReturn) {
-   // TODO remove this after we use aTrainingWeights and aValidationWeights into the GenerateModelFeatureCombinationUpdatePerTargetClasses function
-   UNUSED(aTrainingWeights);
-   UNUSED(aValidationWeights);
+static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasses(const EbmTrainingState * const pEbmTrainingState, EbmTrainingWorkspace * const pEbmTrainingWorkspace, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, FractionalDataType * const pGainReturn) {
 
    LOG_0(TraceLevelVerbose, "Entered GenerateModelFeatureCombinationUpdatePerTargetClasses");
 
@@ -1069,38 +1659,35 @@ static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasse
    }
 
    const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
-   CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingState);
    const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
    const size_t cDimensions = pFeatureCombination->m_cFeatures;
 
-   pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->SetCountDimensions(cDimensions);
-   pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Reset();
+   pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->SetCountDimensions(cDimensions);
+   pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Reset();
 
    // if pEbmTrainingState->m_apSamplingSets is nullptr, then we should have zero training instances
    // we can't be partially constructed here since then we wouldn't have returned our state pointer to our caller
    EBM_ASSERT(!pEbmTrainingState->m_apSamplingSets == !pEbmTrainingState->m_pTrainingSet); // m_pTrainingSet and m_apSamplingSets should be the same null-ness in that they should either both be null or both be non-null (although different non-null values)
    FractionalDataType totalGain = 0;
    if(nullptr != pEbmTrainingState->m_apSamplingSets) {
-      pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet->SetCountDimensions(cDimensions);
+      TrainSamplingSetContext trainSamplingSetContext;
+      trainSamplingSetContext.m_pEbmTrainingState = pEbmTrainingState;
+      trainSamplingSetContext.m_pEbmTrainingWorkspace = pEbmTrainingWorkspace;
+      trainSamplingSetContext.m_pFeatureCombination = pFeatureCombination;
+      trainSamplingSetContext.m_iFeatureCombination = iFeatureCombination;
+      // ThreadPool::Run isn't reentrant, so the threads either train separate sampling sets or they share the binning of our only sampling set
+      trainSamplingSetContext.m_pThreadPoolBinning = 1 == cSamplingSetsAfterZero ? pEbmTrainingWorkspace->m_pThreadPool : nullptr;
+      trainSamplingSetContext.m_cTreeSplitsMax = cTreeSplitsMax;
+      trainSamplingSetContext.m_cInstancesRequiredForParentSplitMin = cInstancesRequiredForParentSplitMin;
+
+      if(ThreadPool::Run(pEbmTrainingWorkspace->m_pThreadPool, cSamplingSetsAfterZero, &TrainSamplingSet<compilerLearningTypeOrCountTargetClasses>, &trainSamplingSetContext)) {
+         return nullptr;
+      }
 
+      // combine the sampling sets in order on this thread so that floating point rounding is identical regardless of how many threads we ran on
       for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
-         FractionalDataType gain = 0;
-         if(0 == pFeatureCombination->m_cFeatures) {
-            if(TrainZeroDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
-            }
-         } else if(1 == pFeatureCombination->m_cFeatures) {
-            if(TrainSingleDimensional<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pFeatureCombination, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, &gain, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
-            }
-         } else {
-            if(TrainMultiDimensional<compilerLearningTypeOrCountTargetClasses, 0>(pCachedThreadResources, pEbmTrainingState->m_apSamplingSets[iSamplingSet], pFeatureCombination, pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-               return nullptr;
-            }
-         }
-         totalGain += gain;
-         // TODO : when we thread this code, let's have each thread take a lock and update the combined line segment.  They'll each do it while the others are working, so there should be no blocking and our final result won't require adding by the main thread
-         if(pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Add(*pEbmTrainingState->m_pSmallChangeToModelOverwriteSingleSamplingSet)) {
+         totalGain += pEbmTrainingWorkspace->m_aSamplingSetGains[iSamplingSet];
+         if(pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Add(*pEbmTrainingWorkspace->m_apSmallChangeToModelOverwriteSingleSamplingSet[iSamplingSet])) {
             return nullptr;
          }
       }
@@ -1120,163 +1707,883 @@ static FractionalDataType * GenerateModelFeatureCombinationUpdatePerTargetClasse
          //if(0 <= k_iZeroResidual || ptrdiff_t { 2 } == pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses && bExpandBinaryLogits) {
          //   EBM_ASSERT(ptrdiff_t { 2 } <= pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
          //   // TODO : for classification with residual zeroing, is our learning rate essentially being inflated as pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses goes up?  If so, maybe we should divide by pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses here to keep learning rates as equivalent as possible..  Actually, I think the real solution here is that 
-         //   pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero * (pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses - 1) / pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+         //   pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero * (pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses - 1) / pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
          //} else {
          //   // TODO : for classification, is our learning rate essentially being inflated as pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses goes up?  If so, maybe we should divide by pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses here to keep learning rates equivalent as possible
-         //   pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
+         //   pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
          //}
 
          constexpr bool bDividing = bExpandBinaryLogits && ptrdiff_t { 2 } == compilerLearningTypeOrCountTargetClasses;
          if(bDividing) {
-            pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero / 2);
+            pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero / 2);
          } else {
-            pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
+            pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
          }
       } else {
-         pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
+         pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Multiply(learningRate / cSamplingSetsAfterZero);
       }
    }
 
    if(0 != cDimensions) {
-      // pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets was reset above, so it isn't expanded.  We want to expand it before calling ValidationSetInputFeatureLoop so that we can more efficiently lookup the results by index rather than do a binary search
+      // pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets was reset above, so it isn't expanded.  We want to expand it before calling ValidationSetInputFeatureLoop so that we can more efficiently lookup the results by index rather than do a binary search
       size_t acDivisionIntegersEnd[k_cDimensionsMax];
       size_t iDimension = 0;
       do {
          acDivisionIntegersEnd[iDimension] = ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature->m_cBins;
          ++iDimension;
       } while(iDimension < cDimensions);
-      if(pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->Expand(acDivisionIntegersEnd)) {
+      if(pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->Expand(acDivisionIntegersEnd)) {
+         return nullptr;
+      }
+   }
+
+   if(nullptr != pGainReturn) {
+      *pGainReturn = totalGain;
+   }
+
+   LOG_0(TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdatePerTargetClasses");
+   return pEbmTrainingWorkspace->m_pSmallChangeToModelAccumulatedFromSamplingSets->m_aValues;
+}
+
+template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
+EBM_INLINE FractionalDataType * CompilerRecursiveGenerateModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const EbmTrainingState * const pEbmTrainingState, EbmTrainingWorkspace * const pEbmTrainingWorkspace, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, FractionalDataType * const pGainReturn) {
+   static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   if(possibleCompilerLearningTypeOrCountTargetClasses == runtimeLearningTypeOrCountTargetClasses) {
+      EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
+      return GenerateModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, pEbmTrainingWorkspace, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pGainReturn);
+   } else {
+      return CompilerRecursiveGenerateModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, pEbmTrainingWorkspace, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pGainReturn);
+   }
+}
+
+template<>
+EBM_INLINE FractionalDataType * CompilerRecursiveGenerateModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, const EbmTrainingState * const pEbmTrainingState, EbmTrainingWorkspace * const pEbmTrainingWorkspace, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, FractionalDataType * const pGainReturn) {
+   UNUSED(runtimeLearningTypeOrCountTargetClasses);
+   // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
+   static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
+   return GenerateModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, pEbmTrainingWorkspace, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, pGainReturn);
+}
+
+// GenerateModelFeatureCombinationUpdateInternal only writes to pEbmTrainingWorkspace, so it can be called simultaneously from multiple threads on the same
+// pEbmTrainingState as long as each thread has its own workspace and nobody changes the residuals (ApplyModelFeatureCombinationUpdate) at the same time
+static FractionalDataType * GenerateModelFeatureCombinationUpdateInternal(
+   const EbmTrainingState * const pEbmTrainingState,
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace,
+   const IntegerDataType indexFeatureCombination,
+   const FractionalDataType learningRate,
+   const IntegerDataType countTreeSplitsMax,
+   const IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * const trainingWeights,
+   const FractionalDataType * const validationWeights,
+   FractionalDataType * const gainReturn
+) {
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+   EBM_ASSERT(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses == pEbmTrainingWorkspace->m_runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(pEbmTrainingState->m_cSamplingSets == pEbmTrainingWorkspace->m_cSamplingSets);
+
+   EBM_ASSERT(0 <= indexFeatureCombination);
+   EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination))); // we wouldn't have allowed the creation of an feature set larger than size_t
+   size_t iFeatureCombination = static_cast<size_t>(indexFeatureCombination);
+   EBM_ASSERT(iFeatureCombination < pEbmTrainingState->m_cFeatureCombinations);
+   EBM_ASSERT(nullptr != pEbmTrainingState->m_apFeatureCombinations); // this is true because 0 < pEbmTrainingState->m_cFeatureCombinations since our caller needs to pass in a valid indexFeatureCombination to this function
+
+   LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogEnterGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GenerateModelFeatureCombinationUpdate");
+
+   EBM_ASSERT(!std::isnan(learningRate));
+   EBM_ASSERT(!std::isinf(learningRate));
+
+   EBM_ASSERT(0 <= countTreeSplitsMax);
+   size_t cTreeSplitsMax = static_cast<size_t>(countTreeSplitsMax);
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countTreeSplitsMax)) {
+      // we can never exceed a size_t number of splits, so let's just set it to the maximum if we were going to overflow because it will generate the same results as if we used the true number
+      cTreeSplitsMax = std::numeric_limits<size_t>::max();
+   }
+
+   EBM_ASSERT(0 <= countInstancesRequiredForParentSplitMin); // if there is 1 instance, then it can't be split, but we accept this input from our user
+   size_t cInstancesRequiredForParentSplitMin = static_cast<size_t>(countInstancesRequiredForParentSplitMin);
+   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstancesRequiredForParentSplitMin)) {
+      // we can never exceed a size_t number of instances, so let's just set it to the maximum if we were going to overflow because it will generate the same results as if we used the true number
+      cInstancesRequiredForParentSplitMin = std::numeric_limits<size_t>::max();
+   }
+
+   // instance weights are set once through SetInstanceWeights, which stores them with our datasets
+   if(nullptr != trainingWeights || nullptr != validationWeights) {
+      LOG_0(TraceLevelError, "ERROR GenerateModelFeatureCombinationUpdate trainingWeights and validationWeights must be nullptr.  Use SetInstanceWeights instead");
+      return nullptr;
+   }
+   // validationMetricReturn can be nullptr
+
+   FractionalDataType * aModelFeatureCombinationUpdateTensor;
+   if(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+      aModelFeatureCombinationUpdateTensor = GenerateModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, pEbmTrainingWorkspace, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, gainReturn);
+   } else {
+      EBM_ASSERT(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses));
+      if(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
+         // if there is only 1 target class for classification, then we can predict the output with 100% accuracy.  The model is a tensor with zero length array logits, which means for our representation that we have zero items in the array total.
+         // since we can predit the output with 100% accuracy, our gain will be 0.
+         if(nullptr != gainReturn) {
+            *gainReturn = 0;
+         }
+         LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdate pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }");
          return nullptr;
       }
+      aModelFeatureCombinationUpdateTensor = CompilerRecursiveGenerateModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, pEbmTrainingWorkspace, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, gainReturn);
    }
 
-   if(nullptr != pGainReturn) {
-      *pGainReturn = totalGain;
+   if(nullptr != gainReturn) {
+      EBM_ASSERT(*gainReturn <= 0.000000001);
+      LOG_COUNTED_N(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdate %" FractionalDataTypePrintf, *gainReturn);
+   } else {
+      LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdate no gain");
+   }
+   if(nullptr == aModelFeatureCombinationUpdateTensor) {
+      LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdate returned nullptr");
+   }
+   return aModelFeatureCombinationUpdateTensor;
+}
+
+// we made this a global because if we had put this variable inside the EbmTrainingState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmTrainingState object is sent into us
+// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
+static unsigned int g_cLogGenerateModelFeatureCombinationUpdateParametersMessages = 10;
+
+EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdate(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights,
+   FractionalDataType * gainReturn
+) {
+   LOG_COUNTED_N(&g_cLogGenerateModelFeatureCombinationUpdateParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GenerateModelFeatureCombinationUpdate parameters: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", trainingWeights=%p, validationWeights=%p, gainReturn=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, static_cast<const void *>(trainingWeights), static_cast<const void *>(validationWeights), static_cast<void *>(gainReturn));
+
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   // this version uses the workspace inside pEbmTrainingState and returns a pointer into it, so only one call can be in flight per EbmTrainingState
+   return GenerateModelFeatureCombinationUpdateInternal(pEbmTrainingState, pEbmTrainingState->m_pEbmTrainingWorkspace, indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, gainReturn);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY PEbmTrainingWorkspace EBMCORE_CALLING_CONVENTION AllocateTrainingWorkspace(
+   PEbmTraining ebmTraining
+) {
+   LOG_N(TraceLevelInfo, "Entered AllocateTrainingWorkspace: ebmTraining=%p", static_cast<void *>(ebmTraining));
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   // our caller is doing the threading when they use a separate workspace, so we run all the sampling sets on the caller's thread instead of
+   // having each workspace launch its own set of threads, which would oversubscribe the machine
+   const PEbmTrainingWorkspace ebmTrainingWorkspace = reinterpret_cast<PEbmTrainingWorkspace>(EbmTrainingWorkspace::Allocate(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState->m_cSamplingSets, false));
+
+   LOG_N(TraceLevelInfo, "Exited AllocateTrainingWorkspace %p", static_cast<void *>(ebmTrainingWorkspace));
+   return ebmTrainingWorkspace;
+}
+
+static unsigned int g_cLogGenerateModelFeatureCombinationUpdateWithWorkspaceParametersMessages = 10;
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdateWithWorkspace(
+   PEbmTraining ebmTraining,
+   PEbmTrainingWorkspace ebmTrainingWorkspace,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights,
+   FractionalDataType * modelFeatureCombinationUpdateTensorOut,
+   FractionalDataType * gainReturn
+) {
+   LOG_COUNTED_N(&g_cLogGenerateModelFeatureCombinationUpdateWithWorkspaceParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GenerateModelFeatureCombinationUpdateWithWorkspace parameters: ebmTraining=%p, ebmTrainingWorkspace=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", trainingWeights=%p, validationWeights=%p, modelFeatureCombinationUpdateTensorOut=%p, gainReturn=%p", static_cast<void *>(ebmTraining), static_cast<void *>(ebmTrainingWorkspace), indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, static_cast<const void *>(trainingWeights), static_cast<const void *>(validationWeights), static_cast<void *>(modelFeatureCombinationUpdateTensorOut), static_cast<void *>(gainReturn));
+
+   const EbmTrainingState * pEbmTrainingState = reinterpret_cast<const EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+   EbmTrainingWorkspace * pEbmTrainingWorkspace = reinterpret_cast<EbmTrainingWorkspace *>(ebmTrainingWorkspace);
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+
+   if(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses) && pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
+      // if there is only 1 target class for classification, then the model tensor has zero items in it, so there is nothing for us to write
+      if(nullptr != gainReturn) {
+         *gainReturn = 0;
+      }
+      LOG_0(TraceLevelInfo, "INFO GenerateModelFeatureCombinationUpdateWithWorkspace pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }");
+      return 0;
+   }
+
+   EBM_ASSERT(nullptr != modelFeatureCombinationUpdateTensorOut);
+
+   const FractionalDataType * const aModelFeatureCombinationUpdateTensor = GenerateModelFeatureCombinationUpdateInternal(pEbmTrainingState, pEbmTrainingWorkspace, indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, gainReturn);
+   if(nullptr == aModelFeatureCombinationUpdateTensor) {
+      return 1;
+   }
+
+   // GenerateModelFeatureCombinationUpdateInternal expanded the tensor, so it has a value for every bin in every dimension
+   const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[static_cast<size_t>(indexFeatureCombination)];
+   size_t cValues = GetVectorLengthFlatCore(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   for(size_t iDimension = 0; iDimension < pFeatureCombination->m_cFeatures; ++iDimension) {
+      // we already allocated our current model with this many items, so this can't overflow
+      cValues *= ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature->m_cBins;
+   }
+   memcpy(modelFeatureCombinationUpdateTensorOut, aModelFeatureCombinationUpdateTensor, sizeof(*aModelFeatureCombinationUpdateTensor) * cValues);
+   return 0;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeTrainingWorkspace(
+   PEbmTrainingWorkspace ebmTrainingWorkspace
+) {
+   LOG_N(TraceLevelInfo, "Entered FreeTrainingWorkspace: ebmTrainingWorkspace=%p", static_cast<void *>(ebmTrainingWorkspace));
+   EbmTrainingWorkspace * pEbmTrainingWorkspace = reinterpret_cast<EbmTrainingWorkspace *>(ebmTrainingWorkspace);
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+   delete pEbmTrainingWorkspace;
+   LOG_0(TraceLevelInfo, "Exited FreeTrainingWorkspace");
+}
+
+// the number of FractionalDataType values that BuildModelFeatureCombinationHistograms writes for each sampling set: one exported bucket per cell of
+// the feature combination's tensor.  Returns true on overflow
+static bool GetHistogramExportLength(const EbmTrainingState * const pEbmTrainingState, const FeatureCombinationCore * const pFeatureCombination, size_t * const pcHistogramBuckets, size_t * const pcValuesPerHistogram) {
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t cVectorLength = GetVectorLengthFlatCore(runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(nullptr != pEbmTrainingState->m_pTrainingSet);
+   const bool bWeighted = nullptr != pEbmTrainingState->m_pTrainingSet->GetWeights();
+   const bool bOverflow = IsClassification(runtimeLearningTypeOrCountTargetClasses) ? GetHistogramBucketSizeOverflow<true>(cVectorLength, bWeighted) : GetHistogramBucketSizeOverflow<false>(cVectorLength, bWeighted);
+   if(bOverflow) {
+      LOG_0(TraceLevelWarning, "WARNING GetHistogramExportLength GetHistogramBucketSizeOverflow");
+      return true;
+   }
+   const size_t cValuesPerBucket = IsClassification(runtimeLearningTypeOrCountTargetClasses) ? GetHistogramBucketExportLength<true>(cVectorLength, bWeighted) : GetHistogramBucketExportLength<false>(cVectorLength, bWeighted);
+   size_t cHistogramBuckets = 1;
+   for(size_t iDimension = 0; iDimension < pFeatureCombination->m_cFeatures; ++iDimension) {
+      // we check for simple multiplication overflow from m_cBins in EbmTrainingState->Initialize when we unpack featureCombinationIndexes
+      cHistogramBuckets *= ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iDimension].m_pFeature->m_cBins;
+   }
+   if(IsMultiplyError(cValuesPerBucket, cHistogramBuckets)) {
+      LOG_0(TraceLevelWarning, "WARNING GetHistogramExportLength IsMultiplyError(cValuesPerBucket, cHistogramBuckets)");
+      return true;
+   }
+   *pcHistogramBuckets = cHistogramBuckets;
+   *pcValuesPerHistogram = cValuesPerBucket * cHistogramBuckets;
+   return false;
+}
+
+struct BuildHistogramsContext {
+   const EbmTrainingState * m_pEbmTrainingState;
+   const FeatureCombinationCore * m_pFeatureCombination;
+   size_t m_iFeatureCombination;
+   // nullptr if the ThreadPool is busy binning sampling sets, in which case each sampling set bins its data on the thread it was given
+   ThreadPool * m_pThreadPoolBinning;
+   size_t m_cHistogramBuckets;
+   size_t m_cValuesPerHistogram;
+   FractionalDataType * m_aHistogramsOut;
+};
+
+// this is a THREAD_POOL_TASK.  We bin exactly like TrainSamplingSet does, including going through our HistogramCache, so our exported histogram is the
+// one that GenerateModelFeatureCombinationUpdate would have grown its tree on
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static bool BuildSamplingSetHistogram(void * const pContext, const size_t iThread, const size_t iSamplingSet) {
+   const BuildHistogramsContext * const pBuildHistogramsContext = static_cast<const BuildHistogramsContext *>(pContext);
+   const EbmTrainingState * const pEbmTrainingState = pBuildHistogramsContext->m_pEbmTrainingState;
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pEbmTrainingState->m_pEbmTrainingWorkspace;
+   const FeatureCombinationCore * const pFeatureCombination = pBuildHistogramsContext->m_pFeatureCombination;
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses;
+
+   CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingWorkspace, iThread);
+   pCachedThreadResources->m_pStatistics = &pEbmTrainingState->m_statistics;
+   const SamplingMethod * const pSamplingSet = pEbmTrainingState->m_apSamplingSets[iSamplingSet];
+   HistogramCache * const pHistogramCache = &pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet];
+   pHistogramCache->SetKey(pBuildHistogramsContext->m_iFeatureCombination, pEbmTrainingState->m_iResidualGeneration);
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   const bool bWeighted = nullptr != pSamplingSet->m_pOriginDataSet->GetWeights();
+   // GetHistogramExportLength checked GetHistogramBucketSizeOverflow and the number of buckets
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+   const size_t cHistogramBuckets = pBuildHistogramsContext->m_cHistogramBuckets;
+   if(IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)) {
+      LOG_0(TraceLevelWarning, "WARNING BuildSamplingSetHistogram IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)");
+      return true;
+   }
+   const size_t cBytesBuffer = cHistogramBuckets * cBytesPerHistogramBucket;
+   HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets = static_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pCachedThreadResources->GetThreadByteBuffer1(cBytesBuffer));
+   if(UNLIKELY(nullptr == aHistogramBuckets)) {
+      LOG_0(TraceLevelWarning, "WARNING BuildSamplingSetHistogram nullptr == aHistogramBuckets");
+      return true;
+   }
+   memset(aHistogramBuckets, 0, cBytesBuffer);
+
+#ifndef NDEBUG
+   const unsigned char * const aHistogramBucketsEndDebug = reinterpret_cast<unsigned char *>(aHistogramBuckets) + cBytesBuffer;
+#endif // NDEBUG
+
+   if(0 == pFeatureCombination->m_cFeatures) {
+      BinZeroDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pHistogramCache, pSamplingSet, aHistogramBuckets, cBytesBuffer, runtimeLearningTypeOrCountTargetClasses);
+   } else if(1 == pFeatureCombination->m_cFeatures) {
+      if(BinSingleDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pBuildHistogramsContext->m_pThreadPoolBinning, pHistogramCache, pSamplingSet, pFeatureCombination, aHistogramBuckets, cHistogramBuckets, cBytesBuffer, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      )) {
+         return true;
+      }
+   } else {
+      if(BinMultiDimensionalHistogram<compilerLearningTypeOrCountTargetClasses>(pCachedThreadResources, pBuildHistogramsContext->m_pThreadPoolBinning, pHistogramCache, pSamplingSet, pFeatureCombination, aHistogramBuckets, cHistogramBuckets, cBytesBuffer, runtimeLearningTypeOrCountTargetClasses
+#ifndef NDEBUG
+         , aHistogramBucketsEndDebug
+#endif // NDEBUG
+      )) {
+         return true;
+      }
+   }
+
+   // GetHistogramExportLength checked that cValuesPerHistogram doesn't overflow, and our caller checked it times the number of sampling sets
+   ExportHistogramBuckets<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted, cHistogramBuckets, aHistogramBuckets, pBuildHistogramsContext->m_aHistogramsOut + iSamplingSet * pBuildHistogramsContext->m_cValuesPerHistogram);
+   return false;
+}
+
+template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
+EBM_INLINE bool CompilerRecursiveBuildHistograms(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, ThreadPool * const pThreadPool, const size_t cSamplingSets, BuildHistogramsContext * const pBuildHistogramsContext) {
+   static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   if(possibleCompilerLearningTypeOrCountTargetClasses == runtimeLearningTypeOrCountTargetClasses) {
+      EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
+      return ThreadPool::Run(pThreadPool, cSamplingSets, &BuildSamplingSetHistogram<possibleCompilerLearningTypeOrCountTargetClasses>, pBuildHistogramsContext);
+   } else {
+      return CompilerRecursiveBuildHistograms<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pThreadPool, cSamplingSets, pBuildHistogramsContext);
+   }
+}
+
+template<>
+EBM_INLINE bool CompilerRecursiveBuildHistograms<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, ThreadPool * const pThreadPool, const size_t cSamplingSets, BuildHistogramsContext * const pBuildHistogramsContext) {
+   UNUSED(runtimeLearningTypeOrCountTargetClasses);
+   static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
+   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
+   EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
+   return ThreadPool::Run(pThreadPool, cSamplingSets, &BuildSamplingSetHistogram<k_DynamicClassification>, pBuildHistogramsContext);
+}
+
+// the histograms are only meaningful if we have sampling sets to bin, and with fewer than 2 target classes there is nothing to train
+static bool IsHistogramExportError(const EbmTrainingState * const pEbmTrainingState, const char * const sFunction) {
+   if(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses) && pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
+      LOG_N(TraceLevelError, "ERROR %s needs at least 2 target classes", sFunction);
+      return true;
+   }
+   if(nullptr == pEbmTrainingState->m_apSamplingSets) {
+      LOG_N(TraceLevelError, "ERROR %s needs at least 1 training instance", sFunction);
+      return true;
+   }
+   return false;
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetModelFeatureCombinationHistogramsLength(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   IntegerDataType * countHistogramValuesReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered GetModelFeatureCombinationHistogramsLength: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", countHistogramValuesReturn=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, static_cast<void *>(countHistogramValuesReturn));
+
+   const EbmTrainingState * const pEbmTrainingState = reinterpret_cast<const EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+   EBM_ASSERT(nullptr != countHistogramValuesReturn);
+   EBM_ASSERT(0 <= indexFeatureCombination);
+   EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination))); // we wouldn't have allowed the creation of an feature set larger than size_t
+   EBM_ASSERT(static_cast<size_t>(indexFeatureCombination) < pEbmTrainingState->m_cFeatureCombinations);
+
+   *countHistogramValuesReturn = 0;
+   if(IsHistogramExportError(pEbmTrainingState, "GetModelFeatureCombinationHistogramsLength")) {
+      return 1;
+   }
+   size_t cHistogramBuckets;
+   size_t cValuesPerHistogram;
+   if(GetHistogramExportLength(pEbmTrainingState, pEbmTrainingState->m_apFeatureCombinations[static_cast<size_t>(indexFeatureCombination)], &cHistogramBuckets, &cValuesPerHistogram)) {
+      return 1;
+   }
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   if(IsMultiplyError(cValuesPerHistogram, cSamplingSetsAfterZero) || !IsNumberConvertable<IntegerDataType, size_t>(cValuesPerHistogram * cSamplingSetsAfterZero)) {
+      LOG_0(TraceLevelWarning, "WARNING GetModelFeatureCombinationHistogramsLength our histograms have too many values");
+      return 1;
    }
+   *countHistogramValuesReturn = static_cast<IntegerDataType>(cValuesPerHistogram * cSamplingSetsAfterZero);
 
-   LOG_0(TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdatePerTargetClasses");
-   return pEbmTrainingState->m_pSmallChangeToModelAccumulatedFromSamplingSets->m_aValues;
+   LOG_N(TraceLevelInfo, "Exited GetModelFeatureCombinationHistogramsLength %" IntegerDataTypePrintf, *countHistogramValuesReturn);
+   return 0;
 }
 
-template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
-EBM_INLINE FractionalDataType * CompilerRecursiveGenerateModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, const FractionalDataType * const aTrainingWeights, const FractionalDataType * const aValidationWeights, FractionalDataType * const pGainReturn) {
-   static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
-   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
-   if(possibleCompilerLearningTypeOrCountTargetClasses == runtimeLearningTypeOrCountTargetClasses) {
-      EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
-      return GenerateModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, aTrainingWeights, aValidationWeights, pGainReturn);
+static unsigned int g_cLogBuildModelFeatureCombinationHistogramsParametersMessages = 10;
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION BuildModelFeatureCombinationHistograms(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType * histogramsOut
+) {
+   LOG_COUNTED_N(&g_cLogBuildModelFeatureCombinationHistogramsParametersMessages, TraceLevelInfo, TraceLevelVerbose, "BuildModelFeatureCombinationHistograms parameters: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", histogramsOut=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, static_cast<void *>(histogramsOut));
+
+   const EbmTrainingState * const pEbmTrainingState = reinterpret_cast<const EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+   EBM_ASSERT(nullptr != histogramsOut);
+   EBM_ASSERT(0 <= indexFeatureCombination);
+   EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination))); // we wouldn't have allowed the creation of an feature set larger than size_t
+   const size_t iFeatureCombination = static_cast<size_t>(indexFeatureCombination);
+   EBM_ASSERT(iFeatureCombination < pEbmTrainingState->m_cFeatureCombinations);
+
+   if(IsHistogramExportError(pEbmTrainingState, "BuildModelFeatureCombinationHistograms")) {
+      return 1;
+   }
+   const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
+   BuildHistogramsContext buildHistogramsContext;
+   if(GetHistogramExportLength(pEbmTrainingState, pFeatureCombination, &buildHistogramsContext.m_cHistogramBuckets, &buildHistogramsContext.m_cValuesPerHistogram)) {
+      return 1;
+   }
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   if(IsMultiplyError(buildHistogramsContext.m_cValuesPerHistogram, cSamplingSetsAfterZero)) {
+      LOG_0(TraceLevelWarning, "WARNING BuildModelFeatureCombinationHistograms IsMultiplyError(buildHistogramsContext.m_cValuesPerHistogram, cSamplingSetsAfterZero)");
+      return 1;
+   }
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pEbmTrainingState->m_pEbmTrainingWorkspace;
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+   buildHistogramsContext.m_pEbmTrainingState = pEbmTrainingState;
+   buildHistogramsContext.m_pFeatureCombination = pFeatureCombination;
+   buildHistogramsContext.m_iFeatureCombination = iFeatureCombination;
+   // ThreadPool::Run isn't reentrant, so the threads either bin separate sampling sets or they share the binning of our only sampling set
+   buildHistogramsContext.m_pThreadPoolBinning = 1 == cSamplingSetsAfterZero ? pEbmTrainingWorkspace->m_pThreadPool : nullptr;
+   buildHistogramsContext.m_aHistogramsOut = histogramsOut;
+
+   bool bError;
+   if(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
+      bError = ThreadPool::Run(pEbmTrainingWorkspace->m_pThreadPool, cSamplingSetsAfterZero, &BuildSamplingSetHistogram<k_Regression>, &buildHistogramsContext);
    } else {
-      return CompilerRecursiveGenerateModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, aTrainingWeights, aValidationWeights, pGainReturn);
+      bError = CompilerRecursiveBuildHistograms<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingWorkspace->m_pThreadPool, cSamplingSetsAfterZero, &buildHistogramsContext);
+   }
+   if(bError) {
+      LOG_0(TraceLevelWarning, "WARNING BuildModelFeatureCombinationHistograms binning failed");
+      return 1;
    }
+
+   LOG_0(TraceLevelVerbose, "Exited BuildModelFeatureCombinationHistograms");
+   return 0;
 }
 
-template<>
-EBM_INLINE FractionalDataType * CompilerRecursiveGenerateModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType learningRate, const size_t cTreeSplitsMax, const size_t cInstancesRequiredForParentSplitMin, const FractionalDataType * const aTrainingWeights, const FractionalDataType * const aValidationWeights, FractionalDataType * const pGainReturn) {
-   UNUSED(runtimeLearningTypeOrCountTargetClasses);
-   // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
-   static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
-   EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
-   EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
-   return GenerateModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, aTrainingWeights, aValidationWeights, pGainReturn);
+// puts each sampling set's merged histogram into the HistogramCache that training loads its histograms from, under the key that TrainSamplingSet is
+// about to look for, which makes GenerateModelFeatureCombinationUpdateInternal grow its trees on the merged histograms instead of binning our instances
+template<bool bClassification>
+static bool StoreMergedHistograms(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const size_t cHistogramBuckets, const size_t cValuesPerHistogram, const FractionalDataType * const aHistograms) {
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pEbmTrainingState->m_pEbmTrainingWorkspace;
+   const size_t cVectorLength = GetVectorLengthFlatCore(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   const bool bWeighted = nullptr != pEbmTrainingState->m_pTrainingSet->GetWeights();
+   // GetHistogramExportLength checked GetHistogramBucketSizeOverflow
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<bClassification>(cVectorLength, bWeighted);
+   if(IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)) {
+      LOG_0(TraceLevelWarning, "WARNING StoreMergedHistograms IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)");
+      return true;
+   }
+   const size_t cBytesBuffer = cHistogramBuckets * cBytesPerHistogramBucket;
+   // we run on our caller's thread before any of our threads start, so the buffer of the first thread's resources is free for us to use
+   HistogramBucket<bClassification> * const aHistogramBuckets = static_cast<HistogramBucket<bClassification> *>(GetCachedThreadResources<bClassification>(pEbmTrainingWorkspace, 0)->GetThreadByteBuffer1(cBytesBuffer));
+   if(UNLIKELY(nullptr == aHistogramBuckets)) {
+      LOG_0(TraceLevelWarning, "WARNING StoreMergedHistograms nullptr == aHistogramBuckets");
+      return true;
+   }
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      if(ImportHistogramBuckets<bClassification>(cVectorLength, bWeighted, cHistogramBuckets, aHistograms + iSamplingSet * cValuesPerHistogram, aHistogramBuckets)) {
+         return true;
+      }
+      HistogramCache * const pHistogramCache = &pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet];
+      pHistogramCache->SetKey(iFeatureCombination, pEbmTrainingState->m_iResidualGeneration);
+      pHistogramCache->Store(aHistogramBuckets, cBytesBuffer);
+      // caching is normally optional, but if it fails here training would silently bin our local instances instead
+      if(nullptr == pHistogramCache->GetHistogram(iFeatureCombination, pEbmTrainingState->m_iResidualGeneration)) {
+         LOG_0(TraceLevelWarning, "WARNING StoreMergedHistograms HistogramCache::Store failed");
+         return true;
+      }
+   }
+   return false;
 }
 
-// we made this a global because if we had put this variable inside the EbmTrainingState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmTrainingState object is sent into us
-// we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
-static unsigned int g_cLogGenerateModelFeatureCombinationUpdateParametersMessages = 10;
+static unsigned int g_cLogGenerateModelFeatureCombinationUpdateFromHistogramsParametersMessages = 10;
 
-// TODO : we can make GenerateModelFeatureCombinationUpdate callable by multiple threads so that this step could be parallelized before making a decision and applying one of the updates.  Right now we're accessing scratch space in the pEbmTrainingState object, but we can move that to a thread resident object.  Do do this, we would need to have our caller allocate our tensor, but that is a manageable operation
-EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdate(
+EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdateFromHistograms(
    PEbmTraining ebmTraining,
    IntegerDataType indexFeatureCombination,
    FractionalDataType learningRate,
    IntegerDataType countTreeSplitsMax,
    IntegerDataType countInstancesRequiredForParentSplitMin,
-   const FractionalDataType * trainingWeights,
-   const FractionalDataType * validationWeights,
+   const FractionalDataType * histograms,
    FractionalDataType * gainReturn
 ) {
-   LOG_COUNTED_N(&g_cLogGenerateModelFeatureCombinationUpdateParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GenerateModelFeatureCombinationUpdate parameters: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", trainingWeights=%p, validationWeights=%p, gainReturn=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, static_cast<const void *>(trainingWeights), static_cast<const void *>(validationWeights), static_cast<void *>(gainReturn));
+   LOG_COUNTED_N(&g_cLogGenerateModelFeatureCombinationUpdateFromHistogramsParametersMessages, TraceLevelInfo, TraceLevelVerbose, "GenerateModelFeatureCombinationUpdateFromHistograms parameters: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", histograms=%p, gainReturn=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, static_cast<const void *>(histograms), static_cast<void *>(gainReturn));
 
-   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EbmTrainingState * const pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
    EBM_ASSERT(nullptr != pEbmTrainingState);
-
+   EBM_ASSERT(nullptr != histograms);
    EBM_ASSERT(0 <= indexFeatureCombination);
    EBM_ASSERT((IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination))); // we wouldn't have allowed the creation of an feature set larger than size_t
-   size_t iFeatureCombination = static_cast<size_t>(indexFeatureCombination);
+   const size_t iFeatureCombination = static_cast<size_t>(indexFeatureCombination);
    EBM_ASSERT(iFeatureCombination < pEbmTrainingState->m_cFeatureCombinations);
-   EBM_ASSERT(nullptr != pEbmTrainingState->m_apFeatureCombinations); // this is true because 0 < pEbmTrainingState->m_cFeatureCombinations since our caller needs to pass in a valid indexFeatureCombination to this function
 
-   LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogEnterGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Entered GenerateModelFeatureCombinationUpdate");
+   if(nullptr != gainReturn) {
+      *gainReturn = 0;
+   }
+   if(IsHistogramExportError(pEbmTrainingState, "GenerateModelFeatureCombinationUpdateFromHistograms")) {
+      return nullptr;
+   }
+   size_t cHistogramBuckets;
+   size_t cValuesPerHistogram;
+   if(GetHistogramExportLength(pEbmTrainingState, pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination], &cHistogramBuckets, &cValuesPerHistogram)) {
+      return nullptr;
+   }
 
-   EBM_ASSERT(!std::isnan(learningRate));
-   EBM_ASSERT(!std::isinf(learningRate));
+   const bool bError = IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses) ?
+      StoreMergedHistograms<true>(pEbmTrainingState, iFeatureCombination, cHistogramBuckets, cValuesPerHistogram, histograms) :
+      StoreMergedHistograms<false>(pEbmTrainingState, iFeatureCombination, cHistogramBuckets, cValuesPerHistogram, histograms);
 
-   EBM_ASSERT(0 <= countTreeSplitsMax);
-   size_t cTreeSplitsMax = static_cast<size_t>(countTreeSplitsMax);
-   if(!IsNumberConvertable<size_t, IntegerDataType>(countTreeSplitsMax)) {
-      // we can never exceed a size_t number of splits, so let's just set it to the maximum if we were going to overflow because it will generate the same results as if we used the true number
-      cTreeSplitsMax = std::numeric_limits<size_t>::max();
+   FractionalDataType * aModelFeatureCombinationUpdateTensor = nullptr;
+   if(!bError) {
+      aModelFeatureCombinationUpdateTensor = GenerateModelFeatureCombinationUpdateInternal(pEbmTrainingState, pEbmTrainingState->m_pEbmTrainingWorkspace, indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, nullptr, nullptr, gainReturn);
    }
 
-   EBM_ASSERT(0 <= countInstancesRequiredForParentSplitMin); // if there is 1 instance, then it can't be split, but we accept this input from our user
-   size_t cInstancesRequiredForParentSplitMin = static_cast<size_t>(countInstancesRequiredForParentSplitMin);
-   if(!IsNumberConvertable<size_t, IntegerDataType>(countInstancesRequiredForParentSplitMin)) {
-      // we can never exceed a size_t number of instances, so let's just set it to the maximum if we were going to overflow because it will generate the same results as if we used the true number
-      cInstancesRequiredForParentSplitMin = std::numeric_limits<size_t>::max();
+   // our caches need to hold only the histograms of our own instances, or a later BuildModelFeatureCombinationHistograms or
+   // GenerateModelFeatureCombinationUpdate would load the merged histograms.  This also keeps ApplyModelFeatureCombinationUpdate from updating them
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      pEbmTrainingState->m_pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet].Clear();
    }
+   return aModelFeatureCombinationUpdateTensor;
+}
 
-   EBM_ASSERT(nullptr == trainingWeights); // TODO : implement this later
-   EBM_ASSERT(nullptr == validationWeights); // TODO : implement this later
-   // validationMetricReturn can be nullptr
+// a*PredictorScores = logOdds for binary classification
+// a*PredictorScores = logWeights for multiclass classification
+// a*PredictorScores = predictedValue for regression
+// for regression each instance's residual shifts by exactly the update in the tensor cell that the instance falls into, so any histogram that we cached
+// for this feature combination can be brought up to date without visiting the instances again.  Classification residuals are not linear in the update, so
+// those histograms are left to go stale along with the cached histograms of all other feature combinations
+template<bool bWeighted>
+static void UpdateHistogramCachesRegression(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const size_t iResidualGenerationPrev, const FractionalDataType * const aModelFeatureCombinationUpdateTensor) {
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pEbmTrainingState->m_pEbmTrainingWorkspace;
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+   const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
 
-   FractionalDataType * aModelFeatureCombinationUpdateTensor;
-   if(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-      aModelFeatureCombinationUpdateTensor = GenerateModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, gainReturn);
-   } else {
-      EBM_ASSERT(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses));
-      if(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
-         // if there is only 1 target class for classification, then we can predict the output with 100% accuracy.  The model is a tensor with zero length array logits, which means for our representation that we have zero items in the array total.
-         // since we can predit the output with 100% accuracy, our gain will be 0.
-         if(nullptr != gainReturn) {
-            *gainReturn = 0;
+   size_t cTensorBins = 1;
+   for(size_t iFeature = 0; iFeature < pFeatureCombination->m_cFeatures; ++iFeature) {
+      // we check for simple multiplication overflow from m_cBins in EbmTrainingState->Initialize when we unpack featureCombinationIndexes
+      cTensorBins *= ARRAY_TO_POINTER_CONST(pFeatureCombination->m_FeatureCombinationEntry)[iFeature].m_pFeature->m_cBins;
+   }
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<false>(1, bWeighted)); // we checked this when we binned the histograms that we're updating
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<false>(1, bWeighted);
+
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      HistogramCache * const pHistogramCache = &pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet];
+      HistogramBucket<false> * const aHistogramBuckets = static_cast<HistogramBucket<false> *>(pHistogramCache->GetHistogram(iFeatureCombination, iResidualGenerationPrev));
+      if(nullptr != aHistogramBuckets) {
+         for(size_t iTensorBin = 0; iTensorBin < cTensorBins; ++iTensorBin) {
+            HistogramBucket<false> * const pHistogramBucket = GetHistogramBucketByIndex<false>(cBytesPerHistogramBucket, aHistogramBuckets, iTensorBin);
+            ARRAY_TO_POINTER(pHistogramBucket->m_aHistogramBucketVectorEntry)[0].m_sumResidualError -= pHistogramBucket->GetWeight(1, bWeighted) * aModelFeatureCombinationUpdateTensor[iTensorBin];
          }
-         LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdate pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }");
-         return nullptr;
+         pHistogramCache->SetResidualGeneration(pEbmTrainingState->m_iResidualGeneration);
       }
-      aModelFeatureCombinationUpdateTensor = CompilerRecursiveGenerateModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, learningRate, cTreeSplitsMax, cInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, gainReturn);
    }
+}
 
-   if(nullptr != gainReturn) {
-      EBM_ASSERT(*gainReturn <= 0.000000001);
-      LOG_COUNTED_N(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdate %" FractionalDataTypePrintf, *gainReturn);
-   } else {
-      LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitGenerateModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited GenerateModelFeatureCombinationUpdate no gain");
+// TrainingRounds passes this as the next feature combination when it won't boost another one after the update that it's applying
+constexpr size_t k_iFeatureCombinationNextNone = std::numeric_limits<size_t>::max();
+
+// TrainingRounds knows which feature combination it boosts after the one whose update it's applying, so instead of streaming every instance through
+// memory once to apply the update and again when GenerateModelFeatureCombinationUpdate bins the next feature combination, we bin each residual into the
+// next feature combination's histograms as soon as we write it.  We bin in the same chunks as BinDataSetTrainingChunks and add the chunks together in the
+// same order, so the histograms that we leave in our HistogramCaches are the ones that GenerateModelFeatureCombinationUpdate would have binned itself
+struct ApplyAndBinContext final {
+   DataSetByFeatureCombination * m_pTrainingSet;
+   const FeatureCombinationCore * m_pFeatureCombination;
+   const FeatureCombinationCore * m_pFeatureCombinationNext;
+   const FractionalDataType * m_aModelFeatureCombinationUpdateTensor;
+   const SamplingMethod * const * m_apSamplingSets;
+   size_t m_cSamplingSets;
+   // each chunk has one histogram per sampling set, and the histograms of a chunk are together
+   unsigned char * m_aChunkHistogramBuckets;
+   size_t m_cHistogramBuckets;
+   size_t m_cBytesHistogramBuckets;
+   size_t m_cInstances;
+   size_t m_cInstancesPerChunk;
+   ptrdiff_t m_runtimeLearningTypeOrCountTargetClasses;
+};
+
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+static void ApplyAndBin(const ApplyAndBinContext * const pApplyAndBinContext, const size_t iInstanceStart, const size_t cInstances, unsigned char * const aHistogramBucketsChunk) {
+   const ptrdiff_t runtimeLearningTypeOrCountTargetClasses = pApplyAndBinContext->m_runtimeLearningTypeOrCountTargetClasses;
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, runtimeLearningTypeOrCountTargetClasses);
+   EBM_ASSERT(!GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)); // we're accessing allocated memory
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+   const size_t cBytesHistogramBuckets = pApplyAndBinContext->m_cBytesHistogramBuckets;
+   const SamplingMethod * const * const apSamplingSets = pApplyAndBinContext->m_apSamplingSets;
+   const size_t cSamplingSets = pApplyAndBinContext->m_cSamplingSets;
+   const FractionalDataType * const aModelFeatureCombinationUpdateTensor = pApplyAndBinContext->m_aModelFeatureCombinationUpdateTensor;
+   DataSetByFeatureCombination * const pTrainingSet = pApplyAndBinContext->m_pTrainingSet;
+   const FractionalDataType * const aWeights = pTrainingSet->GetWeights();
+   EBM_ASSERT(bWeighted == (nullptr != aWeights));
+
+   // the two feature combinations pack different numbers of items into each data unit, so we unpack them separately.  Our chunks start on a data unit
+   // boundary of the feature combination that we bin, but they can start partway through a data unit of the one that we apply
+   const size_t cItemsPerBitPackDataUnitApply = pApplyAndBinContext->m_pFeatureCombination->m_cItemsPerBitPackDataUnit;
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnitApply);
+   EBM_ASSERT(cItemsPerBitPackDataUnitApply <= k_cBitsForStorageType);
+   const size_t cBitsPerItemMaxApply = GetCountBits(cItemsPerBitPackDataUnitApply);
+   const size_t maskBitsApply = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMaxApply);
+   const StorageDataTypeCore * pInputDataApply = pTrainingSet->GetInputDataPointer(pApplyAndBinContext->m_pFeatureCombination) + iInstanceStart / cItemsPerBitPackDataUnitApply;
+   const size_t iItemStartApply = iInstanceStart % cItemsPerBitPackDataUnitApply;
+   size_t iTensorBinCombinedApply = static_cast<size_t>(*pInputDataApply) >> (cBitsPerItemMaxApply * iItemStartApply);
+   ++pInputDataApply;
+   size_t cItemsRemainingApply = cItemsPerBitPackDataUnitApply - iItemStartApply;
+
+   const size_t cItemsPerBitPackDataUnitBin = pApplyAndBinContext->m_pFeatureCombinationNext->m_cItemsPerBitPackDataUnit;
+   EBM_ASSERT(1 <= cItemsPerBitPackDataUnitBin);
+   EBM_ASSERT(cItemsPerBitPackDataUnitBin <= k_cBitsForStorageType);
+   EBM_ASSERT(0 == iInstanceStart % cItemsPerBitPackDataUnitBin);
+   const size_t cBitsPerItemMaxBin = GetCountBits(cItemsPerBitPackDataUnitBin);
+   const size_t maskBitsBin = std::numeric_limits<size_t>::max() >> (k_cBitsForStorageType - cBitsPerItemMaxBin);
+   const StorageDataTypeCore * pInputDataBin = pTrainingSet->GetInputDataPointer(pApplyAndBinContext->m_pFeatureCombinationNext) + iInstanceStart / cItemsPerBitPackDataUnitBin;
+   size_t iTensorBinCombinedBin = static_cast<size_t>(*pInputDataBin);
+   ++pInputDataBin;
+   size_t cItemsRemainingBin = cItemsPerBitPackDataUnitBin;
+
+   // none of these can overflow since we're pointing into existing memory
+   FractionalDataType * pResidualError = pTrainingSet->GetResidualPointer() + iInstanceStart * cVectorLength;
+   FractionalDataType * pTrainingPredictorScores = IsClassification(compilerLearningTypeOrCountTargetClasses) ? pTrainingSet->GetPredictorScores() + iInstanceStart * cVectorLength : nullptr;
+   const StorageDataTypeCore * pTargetData = IsClassification(compilerLearningTypeOrCountTargetClasses) ? pTrainingSet->GetTargetDataPointer() + iInstanceStart : nullptr;
+
+   const size_t iInstanceEnd = iInstanceStart + cInstances;
+   for(size_t iInstance = iInstanceStart; iInstance < iInstanceEnd; ++iInstance) {
+      // we only load the next data unit once we need an item from it, so we never read past the end of our data
+      if(0 == cItemsRemainingApply) {
+         iTensorBinCombinedApply = static_cast<size_t>(*pInputDataApply);
+         ++pInputDataApply;
+         cItemsRemainingApply = cItemsPerBitPackDataUnitApply;
+      }
+      const size_t iTensorBinApply = maskBitsApply & iTensorBinCombinedApply;
+      iTensorBinCombinedApply >>= cBitsPerItemMaxApply;
+      --cItemsRemainingApply;
+
+      if(0 == cItemsRemainingBin) {
+         iTensorBinCombinedBin = static_cast<size_t>(*pInputDataBin);
+         ++pInputDataBin;
+         cItemsRemainingBin = cItemsPerBitPackDataUnitBin;
+      }
+      const size_t iTensorBinBin = maskBitsBin & iTensorBinCombinedBin;
+      EBM_ASSERT(iTensorBinBin < pApplyAndBinContext->m_cHistogramBuckets);
+      iTensorBinCombinedBin >>= cBitsPerItemMaxBin;
+      --cItemsRemainingBin;
+
+      // these are the same residual calculations as TrainingSetTargetFeatureLoop
+      const FractionalDataType * const pValues = &aModelFeatureCombinationUpdateTensor[iTensorBinApply * cVectorLength];
+      if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
+         *pResidualError = EbmStatistics::ComputeRegressionResidualError(*pResidualError - pValues[0]);
+      } else {
+         const StorageDataTypeCore targetData = *pTargetData;
+         ++pTargetData;
+         if(IsBinaryClassification(compilerLearningTypeOrCountTargetClasses)) {
+            const FractionalDataType trainingPredictorScore = *pTrainingPredictorScores + pValues[0];
+            *pTrainingPredictorScores = trainingPredictorScore;
+            *pResidualError = EbmStatistics::ComputeClassificationResidualErrorBinaryclass(trainingPredictorScore, targetData);
+         } else {
+            for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+               const FractionalDataType trainingPredictorScores = pTrainingPredictorScores[iVector] + pValues[iVector];
+               pTrainingPredictorScores[iVector] = trainingPredictorScores;
+               pResidualError[iVector] = trainingPredictorScores;
+            }
+            const FractionalDataType sumExp = EbmStatistics::ExpAndSumMulticlass(cVectorLength, pResidualError);
+            EbmStatistics::ComputeClassificationResidualErrorsMulticlassFromExps(cVectorLength, sumExp, targetData, pResidualError);
+            constexpr bool bZeroingResiduals = 0 <= k_iZeroResidual;
+            if(bZeroingResiduals) {
+               pResidualError[k_iZeroResidual] = 0;
+            }
+         }
+         pTrainingPredictorScores += cVectorLength;
+      }
+
+      unsigned char * pHistogramBucketsSamplingSet = aHistogramBucketsChunk;
+      for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSets; ++iSamplingSet) {
+         HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pHistogramBucketEntry = GetHistogramBucketByIndex(cBytesPerHistogramBucket, reinterpret_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(pHistogramBucketsSamplingSet), iTensorBinBin);
+         const SamplingMethod * const pSamplingSet = apSamplingSets[iSamplingSet];
+         // all of our sampling sets are the same type, so this branch is predictable
+         if(SamplingMethodType::WithReplacement == pSamplingSet->m_samplingMethodType) {
+            const SamplingWithReplacement * const pSamplingWithReplacement = static_cast<const SamplingWithReplacement *>(pSamplingSet);
+            const size_t cOccurrences = pSamplingWithReplacement->m_aCountOccurrences[iInstance];
+            const FractionalDataType weightedOccurrences = bWeighted ? pSamplingWithReplacement->m_aWeightedCountOccurrences[iInstance] : static_cast<FractionalDataType>(cOccurrences);
+            AddInstanceToHistogramBucketOccurrences<compilerLearningTypeOrCountTargetClasses, bWeighted>(pHistogramBucketEntry, cOccurrences, weightedOccurrences, pResidualError, cVectorLength);
+         } else {
+            EBM_ASSERT(SamplingMethodType::WithoutReplacement == pSamplingSet->m_samplingMethodType);
+            const SamplingWithoutReplacement * const pSamplingWithoutReplacement = static_cast<const SamplingWithoutReplacement *>(pSamplingSet);
+            AddInstanceToHistogramBucketSelected<compilerLearningTypeOrCountTargetClasses, bWeighted>(pHistogramBucketEntry, SamplingWithoutReplacement::GetSelectedBit(pSamplingWithoutReplacement->m_aBitMask, iInstance), bWeighted ? &aWeights[iInstance] : nullptr, pResidualError, cVectorLength);
+         }
+         pHistogramBucketsSamplingSet += cBytesHistogramBuckets;
+      }
+      pResidualError += cVectorLength;
    }
-   if(nullptr == aModelFeatureCombinationUpdateTensor) {
-      LOG_0(TraceLevelWarning, "WARNING GenerateModelFeatureCombinationUpdate returned nullptr");
+}
+
+// this is a THREAD_POOL_TASK.  Each chunk updates only its own instances and writes only to its own histograms
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses, bool bWeighted>
+static bool ApplyAndBinChunk(void * const pContext, const size_t iThread, const size_t iChunk) {
+   UNUSED(iThread);
+   const ApplyAndBinContext * const pApplyAndBinContext = static_cast<const ApplyAndBinContext *>(pContext);
+
+   const size_t iInstanceStart = iChunk * pApplyAndBinContext->m_cInstancesPerChunk;
+   EBM_ASSERT(iInstanceStart < pApplyAndBinContext->m_cInstances);
+   const size_t cInstancesRemaining = pApplyAndBinContext->m_cInstances - iInstanceStart;
+   const size_t cInstances = cInstancesRemaining < pApplyAndBinContext->m_cInstancesPerChunk ? cInstancesRemaining : pApplyAndBinContext->m_cInstancesPerChunk;
+
+   // our caller checked that all the chunk histograms together don't overflow
+   const size_t cBytesChunk = pApplyAndBinContext->m_cSamplingSets * pApplyAndBinContext->m_cBytesHistogramBuckets;
+   unsigned char * const aHistogramBucketsChunk = pApplyAndBinContext->m_aChunkHistogramBuckets + iChunk * cBytesChunk;
+   memset(aHistogramBucketsChunk, 0, cBytesChunk);
+
+   ApplyAndBin<compilerLearningTypeOrCountTargetClasses, bWeighted>(pApplyAndBinContext, iInstanceStart, cInstances, aHistogramBucketsChunk);
+   return false;
+}
+
+// applies our update to the training residuals and leaves the histograms of iFeatureCombinationNext for the residuals that we produce in our
+// HistogramCaches.  Returns false without changing anything if we can't fuse the two, in which case our caller applies the update by itself
+template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
+static bool ApplyAndBinFused(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const size_t iFeatureCombinationNext, const FractionalDataType * const aModelFeatureCombinationUpdateTensor) {
+   // when we boost the same feature combination again we keep the histogram that we already have cached for it, which regression updates in place
+   if(k_iFeatureCombinationNextNone == iFeatureCombinationNext || iFeatureCombination == iFeatureCombinationNext) {
+      return false;
    }
-   return aModelFeatureCombinationUpdateTensor;
+   EBM_ASSERT(iFeatureCombinationNext < pEbmTrainingState->m_cFeatureCombinations);
+   const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
+   const FeatureCombinationCore * const pFeatureCombinationNext = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombinationNext];
+   // binning zero dimensions doesn't need the instance loop of the other feature combination, and applying zero dimensions doesn't have bit packed data
+   if(0 == pFeatureCombination->m_cFeatures || 0 == pFeatureCombinationNext->m_cFeatures) {
+      return false;
+   }
+   DataSetByFeatureCombination * const pTrainingSet = pEbmTrainingState->m_pTrainingSet;
+   EBM_ASSERT(nullptr != pTrainingSet);
+   // with sparse columns, regression residuals are shifted and our caller has its own update
+   EBM_ASSERT(!IsRegression(compilerLearningTypeOrCountTargetClasses) || !pTrainingSet->HasSparseColumns());
+
+   const size_t cVectorLength = GET_VECTOR_LENGTH(compilerLearningTypeOrCountTargetClasses, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+   const bool bWeighted = nullptr != pTrainingSet->GetWeights();
+   if(GetHistogramBucketSizeOverflow<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted)) {
+      return false;
+   }
+   const size_t cBytesPerHistogramBucket = GetHistogramBucketSize<IsClassification(compilerLearningTypeOrCountTargetClasses)>(cVectorLength, bWeighted);
+   size_t cHistogramBuckets = 1;
+   for(size_t iFeature = 0; iFeature < pFeatureCombinationNext->m_cFeatures; ++iFeature) {
+      // we check for simple multiplication overflow from m_cBins in EbmTrainingState->Initialize when we unpack featureCombinationIndexes
+      cHistogramBuckets *= ARRAY_TO_POINTER_CONST(pFeatureCombinationNext->m_FeatureCombinationEntry)[iFeature].m_pFeature->m_cBins;
+   }
+   if(IsMultiplyError(cHistogramBuckets, cBytesPerHistogramBucket)) {
+      return false;
+   }
+   const size_t cBytesHistogramBuckets = cHistogramBuckets * cBytesPerHistogramBucket;
+
+   const size_t cInstances = pTrainingSet->GetCountInstances();
+   size_t cInstancesPerChunk;
+   const size_t cChunks = GetCountBinningChunks(cInstances, pFeatureCombinationNext->m_cItemsPerBitPackDataUnit, cBytesHistogramBuckets, &cInstancesPerChunk);
+   const size_t cSamplingSetsAfterZero = (0 == pEbmTrainingState->m_cSamplingSets) ? 1 : pEbmTrainingState->m_cSamplingSets;
+   // we hold the histograms of every sampling set in every chunk at once, so we leave big tensors and many sampling sets to separate binning, which only
+   // holds the chunks of one sampling set at a time
+   if(IsMultiplyError(cChunks, cSamplingSetsAfterZero) || IsMultiplyError(cChunks * cSamplingSetsAfterZero, cBytesHistogramBuckets) || k_cBytesBinningChunksMax < cChunks * cSamplingSetsAfterZero * cBytesHistogramBuckets) {
+      return false;
+   }
+
+   EbmTrainingWorkspace * const pEbmTrainingWorkspace = pEbmTrainingState->m_pEbmTrainingWorkspace;
+   EBM_ASSERT(nullptr != pEbmTrainingWorkspace);
+   CachedTrainingThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const pCachedThreadResources = GetCachedThreadResources<IsClassification(compilerLearningTypeOrCountTargetClasses)>(pEbmTrainingWorkspace, 0);
+   pCachedThreadResources->m_pStatistics = &pEbmTrainingState->m_statistics;
+   // we don't need to free this!  It's tracked and reused by pCachedThreadResources, and nothing else uses it until we return
+   unsigned char * const aChunkHistogramBuckets = static_cast<unsigned char *>(pCachedThreadResources->GetThreadByteBuffer3(cChunks * cSamplingSetsAfterZero * cBytesHistogramBuckets));
+   if(UNLIKELY(nullptr == aChunkHistogramBuckets)) {
+      LOG_0(TraceLevelWarning, "WARNING ApplyAndBinFused nullptr == aChunkHistogramBuckets");
+      return false;
+   }
+
+   ApplyAndBinContext applyAndBinContext;
+   applyAndBinContext.m_pTrainingSet = pTrainingSet;
+   applyAndBinContext.m_pFeatureCombination = pFeatureCombination;
+   applyAndBinContext.m_pFeatureCombinationNext = pFeatureCombinationNext;
+   applyAndBinContext.m_aModelFeatureCombinationUpdateTensor = aModelFeatureCombinationUpdateTensor;
+   applyAndBinContext.m_apSamplingSets = pEbmTrainingState->m_apSamplingSets;
+   applyAndBinContext.m_cSamplingSets = cSamplingSetsAfterZero;
+   applyAndBinContext.m_aChunkHistogramBuckets = aChunkHistogramBuckets;
+   applyAndBinContext.m_cHistogramBuckets = cHistogramBuckets;
+   applyAndBinContext.m_cBytesHistogramBuckets = cBytesHistogramBuckets;
+   applyAndBinContext.m_cInstances = cInstances;
+   applyAndBinContext.m_cInstancesPerChunk = cInstancesPerChunk;
+   applyAndBinContext.m_runtimeLearningTypeOrCountTargetClasses = pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses;
+
+   // our tasks can't fail
+   const bool bError = ThreadPool::Run(pEbmTrainingWorkspace->m_pThreadPool, cChunks, bWeighted ? &ApplyAndBinChunk<compilerLearningTypeOrCountTargetClasses, true> : &ApplyAndBinChunk<compilerLearningTypeOrCountTargetClasses, false>, &applyAndBinContext);
+   EBM_ASSERT(!bError);
+   UNUSED(bError);
+
+   // our caller moves to the next residual generation once we return
+   const size_t iResidualGenerationNext = pEbmTrainingState->m_iResidualGeneration + 1;
+   for(size_t iSamplingSet = 0; iSamplingSet < cSamplingSetsAfterZero; ++iSamplingSet) {
+      HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aHistogramBuckets = reinterpret_cast<HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aChunkHistogramBuckets + iSamplingSet * cBytesHistogramBuckets);
+      for(size_t iChunk = 1; iChunk < cChunks; ++iChunk) {
+         const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> * const aChunkHistogramBucketsOne = reinterpret_cast<const HistogramBucket<IsClassification(compilerLearningTypeOrCountTargetClasses)> *>(aChunkHistogramBuckets + (iChunk * cSamplingSetsAfterZero + iSamplingSet) * cBytesHistogramBuckets);
+         for(size_t iBucket = 0; iBucket < cHistogramBuckets; ++iBucket) {
+            GetHistogramBucketByIndex(cBytesPerHistogramBucket, aHistogramBuckets, iBucket)->Add(*GetHistogramBucketByIndex(cBytesPerHistogramBucket, aChunkHistogramBucketsOne, iBucket), cVectorLength, bWeighted);
+         }
+      }
+      HistogramCache * const pHistogramCache = &pEbmTrainingWorkspace->m_aHistogramCaches[iSamplingSet];
+      pHistogramCache->SetKey(iFeatureCombinationNext, iResidualGenerationNext);
+      pHistogramCache->Store(aHistogramBuckets, cBytesHistogramBuckets);
+   }
+   pEbmTrainingState->m_statistics.Add(StatisticInstancesScanned, cSamplingSetsAfterZero * cInstances);
+   pEbmTrainingState->m_statistics.Add(StatisticBinsTouched, cSamplingSetsAfterZero * cHistogramBuckets);
+   return true;
 }
 
-// a*PredictorScores = logOdds for binary classification
-// a*PredictorScores = logWeights for multiclass classification
-// a*PredictorScores = predictedValue for regression
 template<ptrdiff_t compilerLearningTypeOrCountTargetClasses>
-static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const bool bForceValidationMetric, const size_t iFeatureCombinationNext, FractionalDataType * const pValidationMetricReturn) {
    LOG_0(TraceLevelVerbose, "Entered ApplyModelFeatureCombinationUpdatePerTargetClasses");
 
    EBM_ASSERT(nullptr != pEbmTrainingState->m_apCurrentModel); // m_apCurrentModel can be null if there are no featureCombinations (but we have an feature combination index), or if the target has 1 or 0 classes (which we check before calling this function), so it shouldn't be possible to be null
    EBM_ASSERT(nullptr != pEbmTrainingState->m_apBestModel); // m_apCurrentModel can be null if there are no featureCombinations (but we have an feature combination index), or if the target has 1 or 0 classes (which we check before calling this function), so it shouldn't be possible to be null
    EBM_ASSERT(nullptr != aModelFeatureCombinationUpdateTensor); // aModelFeatureCombinationUpdateTensor is checked for nullptr before calling this function   
 
+   pEbmTrainingState->m_bUpdatesApplied = true;
    pEbmTrainingState->m_apCurrentModel[iFeatureCombination]->AddExpanded(aModelFeatureCombinationUpdateTensor);
+   if(!pEbmTrainingState->m_abBestModelStale[iFeatureCombination]) {
+      pEbmTrainingState->m_abBestModelStale[iFeatureCombination] = true;
+      EBM_ASSERT(pEbmTrainingState->m_cBestModelStale < pEbmTrainingState->m_cFeatureCombinations);
+      pEbmTrainingState->m_aiBestModelStale[pEbmTrainingState->m_cBestModelStale] = iFeatureCombination;
+      ++pEbmTrainingState->m_cBestModelStale;
+   }
 
    const FeatureCombinationCore * const pFeatureCombination = pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination];
 
    // if the count of training instances is zero, then pEbmTrainingState->m_pTrainingSet will be nullptr
    if(nullptr != pEbmTrainingState->m_pTrainingSet) {
-      // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
-      TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pTrainingSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      PhaseTimer phaseTimer(&pEbmTrainingState->m_statistics, StatisticTrainingUpdateNanoseconds);
+
+      if(IsRegression(compilerLearningTypeOrCountTargetClasses) && pEbmTrainingState->m_pTrainingSet->HasSparseColumns()) {
+         const SparseColumn * const pSparseColumn = 0 == pFeatureCombination->m_cFeatures ? nullptr : pEbmTrainingState->m_pTrainingSet->GetSparseColumn(pFeatureCombination);
+         if(0 == pFeatureCombination->m_cFeatures || nullptr != pSparseColumn) {
+            TrainingSetSparseUpdateRegression(pEbmTrainingState, pSparseColumn, aModelFeatureCombinationUpdateTensor);
+         } else {
+            TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pTrainingSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+            SyncSparseResidualTotals(pEbmTrainingState);
+         }
+      } else if(!ApplyAndBinFused<compilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, iFeatureCombinationNext, aModelFeatureCombinationUpdateTensor)) {
+         // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
+         TrainingSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pTrainingSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      }
+
+      const size_t iResidualGenerationPrev = pEbmTrainingState->m_iResidualGeneration;
+      ++pEbmTrainingState->m_iResidualGeneration;
+      if(IsRegression(compilerLearningTypeOrCountTargetClasses)) {
+         if(nullptr != pEbmTrainingState->m_pTrainingSet->GetWeights()) {
+            UpdateHistogramCachesRegression<true>(pEbmTrainingState, iFeatureCombination, iResidualGenerationPrev, aModelFeatureCombinationUpdateTensor);
+         } else {
+            UpdateHistogramCachesRegression<false>(pEbmTrainingState, iFeatureCombination, iResidualGenerationPrev, aModelFeatureCombinationUpdateTensor);
+         }
+      }
    }
 
    FractionalDataType modelMetric = 0;
@@ -1293,17 +2600,45 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
 
       // TODO : move the target bits branch inside TrainingSetInputFeatureLoop to here outside instead of the feature combination.  The target # of bits is extremely predictable and so we get to only process one sub branch of code below that.  If we do feature combinations here then we have to keep in instruction cache a whole bunch of options
 
-      modelMetric = ValidationSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pEbmTrainingState->m_pValidationSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses);
+      DataSetByFeatureCombination * const pValidationSet = pEbmTrainingState->m_pValidationSet;
+      ++pEbmTrainingState->m_cUpdatesSinceValidationMetric;
+      const size_t cUpdatesPerValidationMetric = pEbmTrainingState->m_cUpdatesPerValidationMetric;
+      if(!bForceValidationMetric && (0 == cUpdatesPerValidationMetric || pEbmTrainingState->m_cUpdatesSinceValidationMetric < cUpdatesPerValidationMetric)) {
+         // we still need to move our validation scores, but we skip the loss and leave the best model alone until our next metric
+         {
+            PhaseTimer phaseTimer(&pEbmTrainingState->m_statistics, StatisticValidationNanoseconds);
+            ValidationSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, nullptr);
+         }
+         pValidationSet->SetInstanceLossesCurrent(false);
+         modelMetric = pEbmTrainingState->m_validationMetricLast;
+      } else {
+         pEbmTrainingState->m_cUpdatesSinceValidationMetric = 0;
+         size_t cInstancesScored = 0;
+         {
+            PhaseTimer phaseTimer(&pEbmTrainingState->m_statistics, StatisticValidationNanoseconds);
+            modelMetric = ValidationSetInputFeatureLoop<1, compilerLearningTypeOrCountTargetClasses>(pFeatureCombination, pValidationSet, aModelFeatureCombinationUpdateTensor, pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, &cInstancesScored);
+         }
+         if(nullptr != pValidationSet->GetInstanceLosses()) {
+            pValidationSet->SetInstanceLossesCurrent(true);
+         }
+         pEbmTrainingState->m_validationMetricLast = modelMetric;
+         pEbmTrainingState->m_statistics.Add(StatisticValidationMetrics, 1);
+         pEbmTrainingState->m_statistics.Add(StatisticValidationInstancesScored, cInstancesScored);
+      }
 
-      // modelMetric is either logloss (classification) or rmse (regression).  In either case we want to minimize it.
+      // modelMetric is either logloss (classification) or rmse (regression).  In either case we want to minimize it.  Metrics that we carried over from an
+      // earlier update can't beat the best, since the best was updated when we computed them
       if(LIKELY(modelMetric < pEbmTrainingState->m_bestModelMetric)) {
          // we keep on improving, so this is more likely than not, and we'll exit if it becomes negative a lot
          pEbmTrainingState->m_bestModelMetric = modelMetric;
 
-         // TODO : in the future don't copy over all SegmentedTensors.  We only need to copy the ones that changed, which we can detect if we use a linked list and array lookup for the same data structure
-         size_t iModel = 0;
-         size_t iModelEnd = pEbmTrainingState->m_cFeatureCombinations;
-         do {
+         PhaseTimer phaseTimer(&pEbmTrainingState->m_statistics, StatisticBestModelCopyNanoseconds);
+         // only the models that changed since our last improvement differ from our best models.  We pop each one off the stale list after
+         // copying it, so if a copy fails the ones that we haven't copied yet stay listed
+         while(0 != pEbmTrainingState->m_cBestModelStale) {
+            const size_t iModel = pEbmTrainingState->m_aiBestModelStale[pEbmTrainingState->m_cBestModelStale - 1];
+            EBM_ASSERT(iModel < pEbmTrainingState->m_cFeatureCombinations);
+            EBM_ASSERT(pEbmTrainingState->m_abBestModelStale[iModel]);
             if(pEbmTrainingState->m_apBestModel[iModel]->Copy(*pEbmTrainingState->m_apCurrentModel[iModel])) {
                if(nullptr != pValidationMetricReturn) {
                   *pValidationMetricReturn = 0; // on error set it to something instead of random bits
@@ -1311,8 +2646,9 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
                LOG_0(TraceLevelVerbose, "Exited ApplyModelFeatureCombinationUpdatePerTargetClasses with memory allocation error in copy");
                return 1;
             }
-            ++iModel;
-         } while(iModel != iModelEnd);
+            pEbmTrainingState->m_abBestModelStale[iModel] = false;
+            --pEbmTrainingState->m_cBestModelStale;
+         }
       }
    }
    if(nullptr != pValidationMetricReturn) {
@@ -1324,35 +2660,39 @@ static IntegerDataType ApplyModelFeatureCombinationUpdatePerTargetClasses(EbmTra
 }
 
 template<ptrdiff_t possibleCompilerLearningTypeOrCountTargetClasses>
-EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const bool bForceValidationMetric, const size_t iFeatureCombinationNext, FractionalDataType * const pValidationMetricReturn) {
    static_assert(IsClassification(possibleCompilerLearningTypeOrCountTargetClasses), "possibleCompilerLearningTypeOrCountTargetClasses needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    if(possibleCompilerLearningTypeOrCountTargetClasses == runtimeLearningTypeOrCountTargetClasses) {
       EBM_ASSERT(runtimeLearningTypeOrCountTargetClasses <= k_cCompilerOptimizedTargetClassesMax);
-      return ApplyModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+      return ApplyModelFeatureCombinationUpdatePerTargetClasses<possibleCompilerLearningTypeOrCountTargetClasses>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, pValidationMetricReturn);
    } else {
-      return CompilerRecursiveApplyModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+      return CompilerRecursiveApplyModelFeatureCombinationUpdate<possibleCompilerLearningTypeOrCountTargetClasses + 1>(runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, pValidationMetricReturn);
    }
 }
 
 template<>
-EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, FractionalDataType * const pValidationMetricReturn) {
+EBM_INLINE IntegerDataType CompilerRecursiveApplyModelFeatureCombinationUpdate<k_cCompilerOptimizedTargetClassesMax + 1>(const ptrdiff_t runtimeLearningTypeOrCountTargetClasses, EbmTrainingState * const pEbmTrainingState, const size_t iFeatureCombination, const FractionalDataType * const aModelFeatureCombinationUpdateTensor, const bool bForceValidationMetric, const size_t iFeatureCombinationNext, FractionalDataType * const pValidationMetricReturn) {
    UNUSED(runtimeLearningTypeOrCountTargetClasses);
    // it is logically possible, but uninteresting to have a classification with 1 target class, so let our runtime system handle those unlikley and uninteresting cases
    static_assert(IsClassification(k_cCompilerOptimizedTargetClassesMax), "k_cCompilerOptimizedTargetClassesMax needs to be a classification");
    EBM_ASSERT(IsClassification(runtimeLearningTypeOrCountTargetClasses));
    EBM_ASSERT(k_cCompilerOptimizedTargetClassesMax < runtimeLearningTypeOrCountTargetClasses);
-   return ApplyModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, pValidationMetricReturn);
+   return ApplyModelFeatureCombinationUpdatePerTargetClasses<k_DynamicClassification>(pEbmTrainingState, iFeatureCombination, aModelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, pValidationMetricReturn);
 }
 
 // we made this a global because if we had put this variable inside the EbmTrainingState object, then we would need to dereference that before getting the count.  By making this global we can send a log message incase a bad EbmTrainingState object is sent into us
 // we only decrease the count if the count is non-zero, so at worst if there is a race condition then we'll output this log message more times than desired, but we can live with that
 static unsigned int g_cLogApplyModelFeatureCombinationUpdateParametersMessages = 10;
 
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModelFeatureCombinationUpdate(
+// bForceValidationMetric computes our validation metric even if SetValidationMetricInterval would have us skip it for this update.  If
+// iFeatureCombinationNext isn't k_iFeatureCombinationNextNone, we bin it while we apply our update.  See ApplyAndBinFused
+static IntegerDataType ApplyModelFeatureCombinationUpdateInternal(
    PEbmTraining ebmTraining,
    IntegerDataType indexFeatureCombination,
    const FractionalDataType * modelFeatureCombinationUpdateTensor,
+   const bool bForceValidationMetric,
+   const size_t iFeatureCombinationNext,
    FractionalDataType * validationMetricReturn
 ) {
    LOG_COUNTED_N(&g_cLogApplyModelFeatureCombinationUpdateParametersMessages, TraceLevelInfo, TraceLevelVerbose, "ApplyModelFeatureCombinationUpdate parameters: ebmTraining=%p, indexFeatureCombination=%" IntegerDataTypePrintf ", modelFeatureCombinationUpdateTensor=%p, validationMetricReturn=%p", static_cast<void *>(ebmTraining), indexFeatureCombination, static_cast<const void *>(modelFeatureCombinationUpdateTensor), static_cast<void *>(validationMetricReturn));
@@ -1381,7 +2721,7 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
 
    IntegerDataType ret;
    if(IsRegression(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses)) {
-      ret = ApplyModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, validationMetricReturn);
+      ret = ApplyModelFeatureCombinationUpdatePerTargetClasses<k_Regression>(pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, validationMetricReturn);
    } else {
       EBM_ASSERT(IsClassification(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses));
       if(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses <= ptrdiff_t { 1 }) {
@@ -1393,7 +2733,7 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
          LOG_COUNTED_0(&pEbmTrainingState->m_apFeatureCombinations[iFeatureCombination]->m_cLogExitApplyModelFeatureCombinationUpdateMessages, TraceLevelInfo, TraceLevelVerbose, "Exited ApplyModelFeatureCombinationUpdate from runtimeLearningTypeOrCountTargetClasses <= 1");
          return 0;
       }
-      ret = CompilerRecursiveApplyModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, validationMetricReturn);
+      ret = CompilerRecursiveApplyModelFeatureCombinationUpdate<2>(pEbmTrainingState->m_runtimeLearningTypeOrCountTargetClasses, pEbmTrainingState, iFeatureCombination, modelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, validationMetricReturn);
    }
    if(0 != ret) {
       LOG_N(TraceLevelWarning, "WARNING ApplyModelFeatureCombinationUpdate returned %" IntegerDataTypePrintf, ret);
@@ -1407,7 +2747,16 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModel
    return ret;
 }
 
-EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingStep(
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModelFeatureCombinationUpdate(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   const FractionalDataType * modelFeatureCombinationUpdateTensor,
+   FractionalDataType * validationMetricReturn
+) {
+   return ApplyModelFeatureCombinationUpdateInternal(ebmTraining, indexFeatureCombination, modelFeatureCombinationUpdateTensor, false, k_iFeatureCombinationNextNone, validationMetricReturn);
+}
+
+static IntegerDataType TrainingStepInternal(
    PEbmTraining ebmTraining,
    IntegerDataType indexFeatureCombination,
    FractionalDataType learningRate,
@@ -1415,6 +2764,8 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingSt
    IntegerDataType countInstancesRequiredForParentSplitMin,
    const FractionalDataType * trainingWeights,
    const FractionalDataType * validationWeights,
+   const bool bForceValidationMetric,
+   const size_t iFeatureCombinationNext,
    FractionalDataType * validationMetricReturn
 ) {
    EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
@@ -1439,7 +2790,129 @@ EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingSt
       EBM_ASSERT(nullptr == validationMetricReturn || 0 == *validationMetricReturn); // rely on GenerateModelUpdate to set the validationMetricReturn to zero on error
       return 1;
    }
-   return ApplyModelFeatureCombinationUpdate(ebmTraining, indexFeatureCombination, pModelFeatureCombinationUpdateTensor, validationMetricReturn);
+   return ApplyModelFeatureCombinationUpdateInternal(ebmTraining, indexFeatureCombination, pModelFeatureCombinationUpdateTensor, bForceValidationMetric, iFeatureCombinationNext, validationMetricReturn);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingStep(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights,
+   FractionalDataType * validationMetricReturn
+) {
+   return TrainingStepInternal(ebmTraining, indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, trainingWeights, validationWeights, false, k_iFeatureCombinationNextNone, validationMetricReturn);
+}
+
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION TrainingRounds(
+   PEbmTraining ebmTraining,
+   IntegerDataType countFeatureCombinationIndexes,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countRoundsMax,
+   IntegerDataType countTrainingStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricReturn,
+   FractionalDataType * validationMetricBestReturn,
+   IntegerDataType * countRoundsReturn
+) {
+   LOG_N(TraceLevelInfo, "Entered TrainingRounds: ebmTraining=%p, countFeatureCombinationIndexes=%" IntegerDataTypePrintf ", featureCombinationIndexes=%p, countRoundsMax=%" IntegerDataTypePrintf ", countTrainingStepsPerFeatureCombination=%" IntegerDataTypePrintf ", learningRate=%" FractionalDataTypePrintf ", countTreeSplitsMax=%" IntegerDataTypePrintf ", countInstancesRequiredForParentSplitMin=%" IntegerDataTypePrintf ", earlyStoppingRunLength=%" IntegerDataTypePrintf ", earlyStoppingTolerance=%" FractionalDataTypePrintf ", validationMetricReturn=%p, validationMetricBestReturn=%p, countRoundsReturn=%p", static_cast<void *>(ebmTraining), countFeatureCombinationIndexes, static_cast<const void *>(featureCombinationIndexes), countRoundsMax, countTrainingStepsPerFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, earlyStoppingRunLength, earlyStoppingTolerance, static_cast<void *>(validationMetricReturn), static_cast<void *>(validationMetricBestReturn), static_cast<void *>(countRoundsReturn));
+
+   EbmTrainingState * pEbmTrainingState = reinterpret_cast<EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   // the metrics start at infinity so that the very first round counts as an improvement.  If the caller gives us no rounds to run, this is what they get back
+   FractionalDataType validationMetricCurrent = std::numeric_limits<FractionalDataType>::infinity();
+   FractionalDataType validationMetricBest = std::numeric_limits<FractionalDataType>::infinity();
+   size_t cRounds = 0;
+
+   IntegerDataType ret = 0;
+   if(countFeatureCombinationIndexes < IntegerDataType { 0 }) {
+      LOG_0(TraceLevelWarning, "WARNING TrainingRounds countFeatureCombinationIndexes < IntegerDataType { 0 }");
+      ret = 1;
+   } else if(IntegerDataType { 0 } != countFeatureCombinationIndexes && nullptr == featureCombinationIndexes) {
+      LOG_0(TraceLevelWarning, "WARNING TrainingRounds IntegerDataType { 0 } != countFeatureCombinationIndexes && nullptr == featureCombinationIndexes");
+      ret = 1;
+   } else {
+      const size_t cFeatureCombinationIndexes = static_cast<size_t>(countFeatureCombinationIndexes);
+      for(size_t iFeatureCombinationIndex = 0; iFeatureCombinationIndex < cFeatureCombinationIndexes; ++iFeatureCombinationIndex) {
+         const IntegerDataType indexFeatureCombination = featureCombinationIndexes[iFeatureCombinationIndex];
+         if(indexFeatureCombination < IntegerDataType { 0 } || !IsNumberConvertable<size_t, IntegerDataType>(indexFeatureCombination) || pEbmTrainingState->m_cFeatureCombinations <= static_cast<size_t>(indexFeatureCombination)) {
+            LOG_0(TraceLevelWarning, "WARNING TrainingRounds featureCombinationIndexes contains an invalid index");
+            ret = 1;
+            break;
+         }
+      }
+   }
+
+   if(0 == ret) {
+      // this is the same early stopping rule that the python wrapper used when it called TrainingStep in a loop.  A round only resets the patience counter if
+      // it beats, by at least earlyStoppingTolerance, the best metric that we had seen when the current run of non-improving rounds started
+      const size_t cFeatureCombinationIndexes = static_cast<size_t>(countFeatureCombinationIndexes);
+      FractionalDataType validationMetricBaseline = std::numeric_limits<FractionalDataType>::infinity();
+      IntegerDataType countRoundsNoImprovement = 0;
+      for(IntegerDataType iRound = 0; iRound < countRoundsMax; ++iRound) {
+         for(size_t iFeatureCombinationIndex = 0; iFeatureCombinationIndex < cFeatureCombinationIndexes; ++iFeatureCombinationIndex) {
+            const IntegerDataType indexFeatureCombination = featureCombinationIndexes[iFeatureCombinationIndex];
+            for(IntegerDataType iStep = 0; iStep < countTrainingStepsPerFeatureCombination; ++iStep) {
+               // we check for early stopping after the last step of each round, so that one always needs a fresh metric
+               const bool bLastStepOfRound = cFeatureCombinationIndexes - 1 == iFeatureCombinationIndex && countTrainingStepsPerFeatureCombination - 1 == iStep;
+               // we bin the feature combination of our next step while we apply this step's update.  If early stopping ends our rounds after this step,
+               // the histograms that we binned for the next round just go unused
+               size_t iFeatureCombinationNext = k_iFeatureCombinationNextNone;
+               if(countTrainingStepsPerFeatureCombination - 1 != iStep) {
+                  iFeatureCombinationNext = static_cast<size_t>(indexFeatureCombination);
+               } else if(iFeatureCombinationIndex + 1 < cFeatureCombinationIndexes) {
+                  iFeatureCombinationNext = static_cast<size_t>(featureCombinationIndexes[iFeatureCombinationIndex + 1]);
+               } else if(iRound + 1 < countRoundsMax) {
+                  iFeatureCombinationNext = static_cast<size_t>(featureCombinationIndexes[0]);
+               }
+               if(0 != TrainingStepInternal(ebmTraining, indexFeatureCombination, learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, nullptr, nullptr, bLastStepOfRound, iFeatureCombinationNext, &validationMetricCurrent)) {
+                  LOG_0(TraceLevelWarning, "WARNING TrainingRounds TrainingStep failed");
+                  ret = 1;
+                  goto exit_rounds;
+               }
+            }
+         }
+         ++cRounds;
+
+         // we only check the metric at the end of each round since the metric only reflects all the features after all of them have been boosted
+         if(validationMetricCurrent < validationMetricBest) {
+            validationMetricBest = validationMetricCurrent;
+         }
+         if(IntegerDataType { 0 } == countRoundsNoImprovement) {
+            validationMetricBaseline = validationMetricBest;
+         }
+         if(validationMetricCurrent + earlyStoppingTolerance < validationMetricBaseline) {
+            countRoundsNoImprovement = 0;
+         } else {
+            ++countRoundsNoImprovement;
+         }
+         if(IntegerDataType { 0 } <= earlyStoppingRunLength && earlyStoppingRunLength <= countRoundsNoImprovement) {
+            LOG_N(TraceLevelInfo, "INFO TrainingRounds early stopping after %zu rounds", cRounds);
+            break;
+         }
+      }
+   }
+
+exit_rounds:;
+   if(nullptr != validationMetricReturn) {
+      *validationMetricReturn = validationMetricCurrent;
+   }
+   if(nullptr != validationMetricBestReturn) {
+      *validationMetricBestReturn = validationMetricBest;
+   }
+   if(nullptr != countRoundsReturn) {
+      // cRounds can't exceed countRoundsMax, so it fits
+      *countRoundsReturn = static_cast<IntegerDataType>(cRounds);
+   }
+   LOG_N(TraceLevelInfo, "Exited TrainingRounds %" IntegerDataTypePrintf, ret);
+   return ret;
 }
 
 EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GetCurrentModelFeatureCombination(
@@ -1508,6 +2981,31 @@ EBMCORE_IMPORT_EXPORT_BODY FractionalDataType * EBMCORE_CALLING_CONVENTION GetBe
    return pRet;
 }
 
+EBMCORE_IMPORT_EXPORT_BODY IntegerDataType EBMCORE_CALLING_CONVENTION GetTrainingStatistics(
+   PEbmTraining ebmTraining,
+   IntegerDataType countStatistics,
+   IntegerDataType * statisticsOut
+) {
+   LOG_N(TraceLevelInfo, "Entered GetTrainingStatistics: ebmTraining=%p, countStatistics=%" IntegerDataTypePrintf ", statisticsOut=%p", static_cast<void *>(ebmTraining), countStatistics, static_cast<void *>(statisticsOut));
+
+   const EbmTrainingState * const pEbmTrainingState = reinterpret_cast<const EbmTrainingState *>(ebmTraining);
+   EBM_ASSERT(nullptr != pEbmTrainingState);
+
+   if(countStatistics < 0 || StatisticsCount < countStatistics) {
+      LOG_0(TraceLevelError, "ERROR GetTrainingStatistics countStatistics must be in the range [0, StatisticsCount]");
+      return 1;
+   }
+   const size_t cStatistics = static_cast<size_t>(countStatistics);
+   if(0 != cStatistics && nullptr == statisticsOut) {
+      LOG_0(TraceLevelError, "ERROR GetTrainingStatistics 0 != countStatistics && nullptr == statisticsOut");
+      return 1;
+   }
+   pEbmTrainingState->m_statistics.Get(cStatistics, statisticsOut);
+
+   LOG_0(TraceLevelInfo, "Exited GetTrainingStatistics");
+   return 0;
+}
+
 EBMCORE_IMPORT_EXPORT_BODY void EBMCORE_CALLING_CONVENTION FreeTraining(
    PEbmTraining ebmTraining
 ) {
@@ -51,6 +51,7 @@ public:
       const HistogramBucket<true> * m_pHistogramBucketEntryFirst;
       const HistogramBucket<true> * m_pHistogramBucketEntryLast;
       size_t m_cInstances;
+      FractionalDataType m_weight;
    };
 
    struct AfterExaminationForPossibleSplitting {
@@ -79,6 +80,12 @@ public:
    EBM_INLINE void SetInstances(size_t cInstances) {
       m_UNION.m_beforeExaminationForPossibleSplitting.m_cInstances = cInstances;
    }
+   EBM_INLINE FractionalDataType GetWeight() const {
+      return m_UNION.m_beforeExaminationForPossibleSplitting.m_weight;
+   }
+   EBM_INLINE void SetWeight(FractionalDataType weight) {
+      m_UNION.m_beforeExaminationForPossibleSplitting.m_weight = weight;
+   }
 };
 
 template<>
@@ -109,6 +116,8 @@ public:
    TreeNodeDataUnion m_UNION;
 
    size_t m_cInstances;
+   // Flatten divides by the weight to get the regression update, so unlike for classification it needs to outlive the examination for splitting
+   FractionalDataType m_weight;
    // use the "struct hack" since Flexible array member method is not available in C++
    // aHistogramBucketVectorEntry must be the last item in this struct
    HistogramBucketVectorEntry<false> m_aHistogramBucketVectorEntry[1];
@@ -119,6 +128,12 @@ public:
    EBM_INLINE void SetInstances(size_t cInstances) {
       m_cInstances = cInstances;
    }
+   EBM_INLINE FractionalDataType GetWeight() const {
+      return m_weight;
+   }
+   EBM_INLINE void SetWeight(FractionalDataType weight) {
+      m_weight = weight;
+   }
 };
 
 template<bool bClassification>
@@ -174,7 +189,7 @@ public:
             if(bClassification) {
                smallChangeToModel = EbmStatistics::ComputeSmallChangeInClassificationLogOddPredictionForOneSegment(pHistogramBucketVectorEntry->m_sumResidualError, pHistogramBucketVectorEntry->GetSumDenominator());
             } else {
-               smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(pHistogramBucketVectorEntry->m_sumResidualError, this->GetInstances());
+               smallChangeToModel = EbmStatistics::ComputeSmallChangeInRegressionPredictionForOneSegment(pHistogramBucketVectorEntry->m_sumResidualError, this->GetWeight());
             }
             *pValuesCur = smallChangeToModel;
 
@@ -70,6 +70,22 @@ typedef struct _EbmInteraction {
    // this struct is to enforce that our caller doesn't mix EbmTraining and EbmInteraction pointers.  In C/C++ languages the caller will get an error if they try to mix these pointer types.
    char unused;
 } *PEbmInteraction;
+typedef struct _EbmTrainingWorkspace {
+   // a PEbmTrainingWorkspace holds the scratch memory for one in-flight call to GenerateModelFeatureCombinationUpdateWithWorkspace.  Each thread that generates updates simultaneously needs its own
+   char unused;
+} *PEbmTrainingWorkspace;
+typedef struct _EbmTrainingDataSet {
+   // a PEbmTrainingDataSet holds bit packed training and validation data that any number of PEbmTraining objects can share
+   char unused;
+} *PEbmTrainingDataSet;
+typedef struct _EbmTrainingDataSetBuilder {
+   // a PEbmTrainingDataSetBuilder bit packs chunks of instances into a PEbmTrainingDataSet as they are appended
+   char unused;
+} *PEbmTrainingDataSetBuilder;
+typedef struct _EbmModel {
+   // a PEbmModel is a model file that OpenModel memory mapped.  Any number of threads can predict with it simultaneously
+   char unused;
+} *PEbmModel;
 
 #ifndef PRId64
 // this should really be defined, but some compilers aren't compliant
@@ -95,6 +111,40 @@ typedef struct _EbmCoreFeatureCombination {
    IntegerDataType countFeaturesInCombination;
 } EbmCoreFeatureCombination;
 
+// options for InitializeTrainingRegressionWithOptions and InitializeTrainingClassificationWithOptions, which can be combined with bitwise or
+const IntegerDataType TrainingOptionsNone = 0;
+// instead of copying them, keep pointers to the caller's trainingPredictorScores, validationPredictorScores and, where IntegerDataType is the signed version
+// of our internal storage type, the classification targets.  The caller must not free or modify these buffers until FreeTraining, and we update the
+// classification predictor scores in place as we train, so they hold the current model's logits.  binnedData is always repacked, so it can be freed after
+// initialization.  Regression copies nothing that could be borrowed, so this option doesn't change anything for regression
+const IntegerDataType TrainingOptionsBorrowBuffers = 1;
+// store the single feature combinations whose training instances nearly all fall into one bin as that dominant bin plus a list of the other instances.
+// Residual updates and binning for those combinations then only visit the other instances, and updates to the intercept visit none.  This trades a
+// small amount of work on every dense update for the savings on the sparse ones, so it pays off on wide data with many mostly default features.
+// Classification residuals aren't linear in the update, so this option only changes how regression is trained.  The models can differ from dense
+// training in the last few bits since the sums are taken in a different order
+const IntegerDataType TrainingOptionsSparseDominantBins = 2;
+
+// options for InitializeInteractionRegressionWithOptions and InitializeInteractionClassificationWithOptions, which can be combined with bitwise or
+const IntegerDataType InteractionOptionsNone = 0;
+// store the residuals as float instead of FractionalDataType, which halves their memory and bandwidth.  The histogram sums are still accumulated in FractionalDataType
+const IntegerDataType InteractionOptionsFloatResiduals = 1;
+
+// indexes into the statisticsOut arrays of GetTrainingStatistics and GetInteractionStatistics.  New statistics are only ever added at the end
+const IntegerDataType StatisticBinningNanoseconds = 0; // building histograms from the instances.  Cached histograms and TrainingRounds' binning during updates don't count
+const IntegerDataType StatisticTreeGrowingNanoseconds = 1; // growing single feature trees
+const IntegerDataType StatisticTensorSweepNanoseconds = 2; // building the fast totals and sweeping them for the best cuts of pairs and interactions
+const IntegerDataType StatisticTrainingUpdateNanoseconds = 3; // applying model updates to the training residuals
+const IntegerDataType StatisticValidationNanoseconds = 4; // applying model updates to the validation set and computing its metric
+const IntegerDataType StatisticBestModelCopyNanoseconds = 5; // copying the current model into the best model when the validation metric improves
+const IntegerDataType StatisticInstancesScanned = 6; // instances visited while binning
+const IntegerDataType StatisticBinsTouched = 7; // histogram buckets produced by binning
+const IntegerDataType StatisticNodesSplit = 8; // tree nodes split while growing single feature trees
+const IntegerDataType StatisticBytesAllocated = 9; // bytes of scratch memory allocated while training or scoring interactions
+const IntegerDataType StatisticValidationMetrics = 10; // times that we computed the validation metric.  See SetValidationMetricInterval
+const IntegerDataType StatisticValidationInstancesScored = 11; // validation instances whose loss we computed rather than reused from the last metric
+const IntegerDataType StatisticsCount = 12;
+
 const signed char TraceLevelOff = 0; // no messages will be output.  SetLogMessageFunction doesn't need to be called if the level is left at this value
 const signed char TraceLevelError = 1;
 const signed char TraceLevelWarning = 2;
@@ -106,6 +156,26 @@ typedef void (EBMCORE_CALLING_CONVENTION * LOG_MESSAGE_FUNCTION)(signed char tra
 
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION SetLogMessageFunction(LOG_MESSAGE_FUNCTION logMessageFunction);
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION SetTraceLevel(signed char traceLevel);
+// SetLogMessageBuffer makes our threads copy their log messages into a lock free ring of countMessages entries instead of calling logMessageFunction
+// directly.  The messages are delivered to logMessageFunction in order, on the caller's thread, whenever the caller calls FlushLogMessages.  This keeps
+// logMessageFunction off our training threads, which matters when it's expensive or takes a lock like the Python GIL.  If the ring is full, new messages
+// are dropped and counted instead of waiting.  Messages longer than 511 characters are clipped.  A countMessages of 0 flushes any remaining messages and
+// goes back to calling logMessageFunction directly.  Call SetLogMessageFunction first, and don't call this while any other thread is inside our library.
+// Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetLogMessageBuffer(IntegerDataType countMessages);
+// FlushLogMessages delivers every buffered log message to logMessageFunction and returns the number of messages that were dropped since the last flush,
+// after reporting them with a warning message.  It can be called from any thread at any time, and does nothing if SetLogMessageBuffer wasn't called
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION FlushLogMessages();
+// ConfigureThreads sets how many threads all of our PEbmTraining and PEbmInteraction handles share in total, including the threads that call into us.
+// countThreads of 0 means one thread per logical processor, which is the default, and countThreads of 1 runs everything serially on the calling thread.
+// If countCpus isn't 0, our worker threads are pinned round robin to the logical processors in cpuIndexes, which is how a caller keeps our work on
+// a single NUMA node.  Handles that already exist keep the per call thread limits that they were created with.  Don't call this while any other thread
+// is inside our library.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION ConfigureThreads(
+   IntegerDataType countThreads,
+   IntegerDataType countCpus,
+   const IntegerDataType * cpuIndexes
+);
 
 // BINARY VS MULTICLASS AND LOGIT REDUCTION
 // - I initially considered storing our model files as negated logits [storing them as (0 - mathematical_logit)], but that's a bad choice because:
@@ -217,6 +287,191 @@ EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION Initialize
    const FractionalDataType * validationPredictorScores, 
    IntegerDataType countInnerBags
 );
+// the WithOptions versions take a bitwise or of TrainingOptions* values
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingRegressionWithOptions(
+   IntegerDataType randomSeed, 
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTrainingInstances, 
+   const FractionalDataType * trainingTargets, 
+   const IntegerDataType * trainingBinnedData, 
+   const FractionalDataType * trainingPredictorScores, 
+   IntegerDataType countValidationInstances, 
+   const FractionalDataType * validationTargets, 
+   const IntegerDataType * validationBinnedData, 
+   const FractionalDataType * validationPredictorScores, 
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingClassificationWithOptions(
+   IntegerDataType randomSeed, 
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTargetClasses, 
+   IntegerDataType countTrainingInstances, 
+   const IntegerDataType * trainingTargets, 
+   const IntegerDataType * trainingBinnedData, 
+   const FractionalDataType * trainingPredictorScores, 
+   IntegerDataType countValidationInstances, 
+   const IntegerDataType * validationTargets, 
+   const IntegerDataType * validationBinnedData, 
+   const FractionalDataType * validationPredictorScores, 
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
+);
+// InitializeTrainingDataSetRegression and InitializeTrainingDataSetClassification bit pack the training and validation data once, and then
+// InitializeTrainingFromDataSet creates PEbmTraining objects that train on it while allocating only their own residuals, predictor scores, samples and models.
+// This is how to train several outer bags with the same training/validation split without keeping a copy of the data for each bag.  The binned data and
+// targets can be freed once the PEbmTrainingDataSet is created.  Each PEbmTraining keeps the data set alive, so FreeTrainingDataSet can be called any time
+// after the last InitializeTrainingFromDataSet, and the PEbmTraining objects can be used from different threads at the same time
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION InitializeTrainingDataSetRegression(
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTrainingInstances, 
+   const FractionalDataType * trainingTargets, 
+   const IntegerDataType * trainingBinnedData, 
+   IntegerDataType countValidationInstances, 
+   const FractionalDataType * validationTargets, 
+   const IntegerDataType * validationBinnedData
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION InitializeTrainingDataSetClassification(
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTargetClasses, 
+   IntegerDataType countTrainingInstances, 
+   const IntegerDataType * trainingTargets, 
+   const IntegerDataType * trainingBinnedData, 
+   IntegerDataType countValidationInstances, 
+   const IntegerDataType * validationTargets, 
+   const IntegerDataType * validationBinnedData
+);
+// trainingOptions is a bitwise or of TrainingOptions* values.  TrainingOptionsBorrowBuffers applies to the predictor scores only since the data set owns the targets
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTraining EBMCORE_CALLING_CONVENTION InitializeTrainingFromDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet,
+   IntegerDataType randomSeed, 
+   const FractionalDataType * trainingPredictorScores, 
+   const FractionalDataType * validationPredictorScores, 
+   IntegerDataType countInnerBags,
+   IntegerDataType trainingOptions
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeTrainingDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet
+);
+// SaveTrainingDataSet writes the bit packed data set to filePath, and OpenTrainingDataSet memory maps such a file back into a PEbmTrainingDataSet without
+// reading it into memory, so data sets larger than physical memory can be trained on with InitializeTrainingFromDataSet.  The file is in the byte order of
+// the machine that wrote it.  OpenTrainingDataSet checks the file's structure and targets but trusts its bit packed data, so only open files that
+// SaveTrainingDataSet wrote, and don't modify them while they're open.  SaveTrainingDataSet returns 0 on success.  OpenTrainingDataSet returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SaveTrainingDataSet(
+   PEbmTrainingDataSet ebmTrainingDataSet,
+   const char * filePath
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION OpenTrainingDataSet(
+   const char * filePath
+);
+// CreateTrainingDataSetBuilderRegression and CreateTrainingDataSetBuilderClassification start a PEbmTrainingDataSet with a known number of training and
+// validation instances that are then appended in chunks of any size, so the caller never needs to hold the complete binned matrix.  Each chunk's binnedData
+// is feature major like trainingBinnedData, but holds only that chunk's countInstances.  Instances are stored in the order they are appended, and isValidation
+// selects whether a chunk goes to the validation set.  The targets and binned data can be freed as soon as each Append returns.  The Append functions return
+// 0 on success.  FinishTrainingDataSetBuilder returns the finished PEbmTrainingDataSet, or nullptr if any instance is missing, and frees the builder either way.
+// FreeTrainingDataSetBuilder is only needed to abandon a builder without finishing it
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSetBuilder EBMCORE_CALLING_CONVENTION CreateTrainingDataSetBuilderRegression(
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTrainingInstances, 
+   IntegerDataType countValidationInstances
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSetBuilder EBMCORE_CALLING_CONVENTION CreateTrainingDataSetBuilderClassification(
+   IntegerDataType countFeatures, 
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations, 
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes, 
+   IntegerDataType countTargetClasses, 
+   IntegerDataType countTrainingInstances, 
+   IntegerDataType countValidationInstances
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderRegression(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderClassification(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData
+);
+// AppendTrainingDataSetBuilderRegressionValues and AppendTrainingDataSetBuilderClassificationValues take raw feature values instead of binned data and bin
+// them with the same cuts and rules as BinFeatureValues.  values is feature major like binnedData.  We bin one small block of instances at a time and bit pack
+// it straight into the data set, so no binned copy of the chunk is ever made
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderRegressionValues(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION AppendTrainingDataSetBuilderClassificationValues(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder,
+   IntegerDataType isValidation,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingDataSet EBMCORE_CALLING_CONVENTION FinishTrainingDataSetBuilder(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeTrainingDataSetBuilder(
+   PEbmTrainingDataSetBuilder ebmTrainingDataSetBuilder
+);
+// SampleTrainingWithoutReplacement replaces the countInnerBags bootstrap samples (or the whole training set if countInnerBags was 0) with samples that
+// each select subsampleFraction of the training instances without replacement.  subsampleFraction needs to be in the range (0, 1].  These samples use
+// 1 bit per instance instead of a count per instance.  Call this after initialization and before training.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SampleTrainingWithoutReplacement(
+   PEbmTraining ebmTraining,
+   IntegerDataType randomSeed,
+   FractionalDataType subsampleFraction
+);
+// SetInstanceWeights weights each training and validation instance.  trainingWeights has countTrainingInstances items and validationWeights has
+// countValidationInstances items, and every weight needs to be positive and finite.  Either can be nullptr, which leaves that set unweighted.  Weighted
+// instances count their weight in our tree splits and updates, and our validation metric becomes a weighted mean.  The weights are copied, so the caller
+// can free them after we return.  Call this after initialization (and after SampleTrainingWithoutReplacement if it's used) and before the first
+// ApplyModelFeatureCombinationUpdate.  Returns 0 on success.  If it runs out of memory, both sets are left unweighted
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetInstanceWeights(
+   PEbmTraining ebmTraining,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights
+);
+// SetValidationMetricInterval makes ApplyModelFeatureCombinationUpdate and TrainingStep compute our validation metric on every
+// countUpdatesPerValidationMetric-th update instead of on each one.  Zero computes it only when TrainingRounds finishes a round, which TrainingRounds
+// always does whatever the interval since that's when it checks for early stopping.  The updates in between still apply to the validation set, but they
+// return the last metric that we computed (infinity before the first) and can't become our best model.  The default is 1.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SetValidationMetricInterval(
+   PEbmTraining ebmTraining,
+   IntegerDataType countUpdatesPerValidationMetric
+);
+// the trainingWeights and validationWeights parameters of GenerateModelFeatureCombinationUpdate, GenerateModelFeatureCombinationUpdateWithWorkspace, and
+// TrainingStep need to be nullptr.  Use SetInstanceWeights to weight instances
 EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdate(
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination, 
@@ -227,6 +482,57 @@ EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION Ge
    const FractionalDataType * validationWeights, 
    FractionalDataType * gainReturn
 );
+// GenerateModelFeatureCombinationUpdateWithWorkspace can be called from multiple threads at once on the same ebmTraining if each thread uses its own ebmTrainingWorkspace,
+// and if no thread calls ApplyModelFeatureCombinationUpdate, TrainingStep, or GenerateModelFeatureCombinationUpdate at the same time.  modelFeatureCombinationUpdateTensorOut
+// needs to have room for the product of the countBins of the features in the combination multiplied by the number of logits (1 for regression).  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmTrainingWorkspace EBMCORE_CALLING_CONVENTION AllocateTrainingWorkspace(
+   PEbmTraining ebmTraining
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdateWithWorkspace(
+   PEbmTraining ebmTraining,
+   PEbmTrainingWorkspace ebmTrainingWorkspace,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * trainingWeights,
+   const FractionalDataType * validationWeights,
+   FractionalDataType * modelFeatureCombinationUpdateTensorOut,
+   FractionalDataType * gainReturn
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeTrainingWorkspace(
+   PEbmTrainingWorkspace ebmTrainingWorkspace
+);
+// these split GenerateModelFeatureCombinationUpdate into phases so that processes that each hold some of the training instances can train one model
+// together.  Every process initializes with the same features, feature combinations, target classes and number of sampling sets (each process samples
+// its own instances) and at least 1 training instance.  For each update, every process calls BuildModelFeatureCombinationHistograms, the processes sum
+// their histograms elementwise (an allreduce), every process calls GenerateModelFeatureCombinationUpdateFromHistograms with the sum, which returns the
+// same update tensor on every process, and then every process applies it with ApplyModelFeatureCombinationUpdate.  The validation metric that
+// ApplyModelFeatureCombinationUpdate returns is the mean over the process's own validation instances, so combine them weighted by each process's
+// number (or total weight) of validation instances.  GetModelFeatureCombinationHistogramsLength returns the number of values in the histograms of a
+// feature combination, which is the same on every process.  The histograms hold one histogram per sampling set, each with one bucket per cell of the
+// feature combination's tensor, and the values in each bucket are its instance count, its weight if SetInstanceWeights was called, and then per logit
+// the sum of residuals and, for classification, the sum of denominators.  All return 0 on success except GenerateModelFeatureCombinationUpdateFromHistograms,
+// which returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetModelFeatureCombinationHistogramsLength(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   IntegerDataType * countHistogramValuesReturn
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION BuildModelFeatureCombinationHistograms(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType * histogramsOut
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION GenerateModelFeatureCombinationUpdateFromHistograms(
+   PEbmTraining ebmTraining,
+   IntegerDataType indexFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   const FractionalDataType * histograms,
+   FractionalDataType * gainReturn
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION ApplyModelFeatureCombinationUpdate(
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination, 
@@ -243,6 +549,28 @@ EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION Trainin
    const FractionalDataType * validationWeights,
    FractionalDataType * validationMetricReturn
 );
+// TrainingRounds runs up to countRoundsMax rounds of TrainingStep natively.  Each round boosts every feature combination listed in featureCombinationIndexes,
+// in order, countTrainingStepsPerFeatureCombination times each.  After each round, if the last validation metric hasn't improved on the best metric by
+// more than earlyStoppingTolerance for earlyStoppingRunLength rounds in a row, we stop early.  A negative earlyStoppingRunLength disables early stopping.
+// Returns 0 on success.  validationMetricReturn gets the metric from the last round, validationMetricBestReturn gets the best round metric, and
+// countRoundsReturn gets the number of rounds that ran.  Like TrainingStep, this is not thread safe.  Unlike a loop of TrainingStep calls, we bin the
+// histograms of each step's feature combination during the pass over the training instances that applies the previous step's update, so each step
+// streams the training instances through memory once instead of twice
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION TrainingRounds(
+   PEbmTraining ebmTraining,
+   IntegerDataType countFeatureCombinationIndexes,
+   const IntegerDataType * featureCombinationIndexes,
+   IntegerDataType countRoundsMax,
+   IntegerDataType countTrainingStepsPerFeatureCombination,
+   FractionalDataType learningRate,
+   IntegerDataType countTreeSplitsMax,
+   IntegerDataType countInstancesRequiredForParentSplitMin,
+   IntegerDataType earlyStoppingRunLength,
+   FractionalDataType earlyStoppingTolerance,
+   FractionalDataType * validationMetricReturn,
+   FractionalDataType * validationMetricBestReturn,
+   IntegerDataType * countRoundsReturn
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION GetCurrentModelFeatureCombination(
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination
@@ -251,10 +579,144 @@ EBMCORE_IMPORT_EXPORT_INCLUDE FractionalDataType * EBMCORE_CALLING_CONVENTION Ge
    PEbmTraining ebmTraining, 
    IntegerDataType indexFeatureCombination
 );
+// GetTrainingStatistics copies the first countStatistics of the Statistic* counters that ebmTraining has accumulated since it was initialized into
+// statisticsOut.  countStatistics can be less than StatisticsCount if the caller was built against an older header, but not more.  The *Nanoseconds
+// times are wall clock nanoseconds summed across our threads.  If the core was compiled with EBM_NO_STATISTICS every statistic is zero.  Returns 0 on
+// success.  This can be called at any time, including while other threads are training
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetTrainingStatistics(
+   PEbmTraining ebmTraining,
+   IntegerDataType countStatistics,
+   IntegerDataType * statisticsOut
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeTraining(
    PEbmTraining ebmTraining
 );
 
+// PredictBatchRegression and PredictBatchClassification add the model's logits (or predicted values for regression) to predictorScores for every instance
+// in binnedData, which has the same layout as trainingBinnedData.  modelFeatureCombinationTensors holds one tensor per feature combination in the format that
+// GetBestModelFeatureCombination returns.  predictorScores has room for countInstances times the number of logits, and our caller initializes it (usually to
+// the intercept).  If returnProbabilities is non-zero, we convert the summed logits into the probability of the 1 class for binary classification, or into
+// the probabilities of every class for multiclass.  These don't require a PEbmTraining and are thread safe.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countInstances,
+   const IntegerDataType * binnedData,
+   FractionalDataType * predictorScores
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * binnedData,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+);
+// PredictBatchRegressionValues and PredictBatchClassificationValues take raw feature values instead of binnedData and bin them with the same cuts and
+// rules as BinFeatureValues.  We bin each block of instances just before we score it and only for the features that the feature combinations use, so
+// scoring doesn't need a binned copy of the data
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchRegressionValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countInstances,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values,
+   FractionalDataType * predictorScores
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION PredictBatchClassificationValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const FractionalDataType * cuts,
+   const FractionalDataType * values,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+);
+
+// BinFeatureValues converts raw feature values into binnedData.  values and binnedData are feature major like trainingBinnedData.  cuts holds the sorted
+// cut points of every feature concatenated in feature order, and each feature has countBins - 1 of them.  A value's bin is the number of its feature's
+// cuts that are less than or equal to it, and NaN goes in the last bin, which matches np.digitize on the bin edges after the first one.  Features with up
+// to 15 cuts compare against every cut and the others use a branchless binary search.  Large inputs are binned on several threads.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION BinFeatureValues(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   const FractionalDataType * cuts,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   IntegerDataType * binnedData
+);
+
+// SaveModelRegression and SaveModelClassification write a model to filePath in a flat binary format that OpenModel memory maps, so starting a scoring
+// process doesn't parse or copy the model, and every process that opens the same file shares one copy of it in the page cache.  The file holds the features
+// with their cuts in the format that BinFeatureValues takes them, the feature combinations, the tensors in the format that GetBestModelFeatureCombination
+// returns, and the intercept, which has one value per logit.  The file is in the byte order of the machine that wrote it.  OpenModel checks the file's
+// structure but trusts the cuts and tensor values, so only open files that SaveModel wrote, and don't modify them while they're open.  The Save functions
+// return 0 on success.  OpenModel returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SaveModelRegression(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   const FractionalDataType * cuts,
+   const FractionalDataType * intercept,
+   const char * filePath
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION SaveModelClassification(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureCombinationIndexes,
+   const FractionalDataType * const * modelFeatureCombinationTensors,
+   IntegerDataType countTargetClasses,
+   const FractionalDataType * cuts,
+   const FractionalDataType * intercept,
+   const char * filePath
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmModel EBMCORE_CALLING_CONVENTION OpenModel(
+   const char * filePath
+);
+// GetModelCountFeatures and GetModelCountTargetClasses let a scoring process size values and predictorScores for a model that it only has the file of.
+// GetModelCountTargetClasses returns -1 for regression models
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetModelCountFeatures(
+   PEbmModel ebmModel
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetModelCountTargetClasses(
+   PEbmModel ebmModel
+);
+// PredictModel scores raw feature values like PredictBatchRegressionValues and PredictBatchClassificationValues, but it sets predictorScores to the
+// model's intercept first, so our caller doesn't need to initialize it.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION PredictModel(
+   PEbmModel ebmModel,
+   IntegerDataType countInstances,
+   const FractionalDataType * values,
+   IntegerDataType returnProbabilities,
+   FractionalDataType * predictorScores
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeModel(
+   PEbmModel ebmModel
+);
+
 
 EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegression(
    IntegerDataType countFeatures, 
@@ -273,12 +735,63 @@ EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION Initial
    const IntegerDataType * binnedData, 
    const FractionalDataType * predictorScores
 );
+// the WithOptions versions take a bitwise or of InteractionOptions* values.  The bin columns are always stored at the narrowest width that holds every
+// feature's bins, so the options only control what needs to trade precision for memory
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionRegressionWithOptions(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countInstances,
+   const FractionalDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   IntegerDataType interactionOptions
+);
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionClassificationWithOptions(
+   IntegerDataType countFeatures,
+   const EbmCoreFeature * features,
+   IntegerDataType countTargetClasses,
+   IntegerDataType countInstances,
+   const IntegerDataType * targets,
+   const IntegerDataType * binnedData,
+   const FractionalDataType * predictorScores,
+   IntegerDataType interactionOptions
+);
+// InitializeInteractionFromTraining scores interactions on ebmTraining's training set without copying it.  The ebmInteraction shares ebmTraining's
+// features and bit packed data, and its residuals are ebmTraining's training residuals, so scores reflect ebmTraining's current model as of each
+// GetInteractionScore call, and there are no binned data, targets or predictor scores to pass in.  Every feature with more than one bin needs a feature
+// combination of its own in ebmTraining.  Like InitializeInteraction*, this ignores instance weights and sampling.  Don't train ebmTraining while
+// scoring interactions, and free the ebmInteraction before ebmTraining.  Returns nullptr on error
+EBMCORE_IMPORT_EXPORT_INCLUDE PEbmInteraction EBMCORE_CALLING_CONVENTION InitializeInteractionFromTraining(
+   PEbmTraining ebmTraining
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScore(
    PEbmInteraction ebmInteraction, 
    IntegerDataType countFeaturesInCombination, 
    const IntegerDataType * featureIndexes, 
    FractionalDataType * interactionScoreReturn
 );
+// GetInteractionScores scores countFeatureCombinations feature combinations in one call, spreading them across a pool of threads that the ebmInteraction
+// keeps between calls.  featureIndexes holds the feature indexes of every combination back to back, the same way that InitializeTraining* takes
+// featureCombinationIndexes.  If countTopScores is negative, interactionScoresReturn gets every score in the order of featureCombinations, and
+// featureCombinationIndexesReturn can be nullptr.  Otherwise, only the min(countTopScores, countFeatureCombinations) highest scores are returned, best first,
+// with their positions in featureCombinations in featureCombinationIndexesReturn.  Equal scores are ordered by position, and NaN scores come after all
+// others.  Only one thread should call this at a time on any given ebmInteraction.  Returns 0 on success
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionScores(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countFeatureCombinations,
+   const EbmCoreFeatureCombination * featureCombinations,
+   const IntegerDataType * featureIndexes,
+   IntegerDataType countTopScores,
+   IntegerDataType * featureCombinationIndexesReturn,
+   FractionalDataType * interactionScoresReturn
+);
+// GetInteractionStatistics is the GetTrainingStatistics of interaction detection.  Only binning, the tensor sweep, instances scanned, bins touched, and
+// bytes allocated apply to interactions, so the other statistics are always zero
+EBMCORE_IMPORT_EXPORT_INCLUDE IntegerDataType EBMCORE_CALLING_CONVENTION GetInteractionStatistics(
+   PEbmInteraction ebmInteraction,
+   IntegerDataType countStatistics,
+   IntegerDataType * statisticsOut
+);
 EBMCORE_IMPORT_EXPORT_INCLUDE void EBMCORE_CALLING_CONVENTION FreeInteraction(
    PEbmInteraction ebmInteraction
 );
@@ -270,6 +270,50 @@ class EBMPreprocessor(BaseEstimator, TransformerMixin):
 
         return X_new.astype(np.int64)
 
+    def transform_values(self, X):
+        """ Prepares instances for the native code to bin, which skips
+            building the binned matrix that transform returns.
+
+        Args:
+            X: Numpy array for instances.
+
+        Returns:
+            A tuple of a float64 Fortran ordered array with the continuous
+            columns as they are and the ordinal/categorical columns mapped to
+            their bins, and a list with one sorted float64 array of cut points
+            per column. A value's bin is the number of cuts less than or equal
+            to it, and NaN goes in the last bin, which is what transform does.
+        """
+        check_is_fitted(self, "has_fitted_")
+
+        schema = self.schema
+        X_new = np.empty(X.shape, dtype=np.float64, order="F")
+        col_cuts = []
+        for col_idx in range(X.shape[1]):
+            col_info = schema[list(schema.keys())[col_idx]]
+            assert col_info["column_number"] == col_idx
+            col_data = X[:, col_idx]
+            if col_info["type"] == "continuous":
+                X_new[:, col_idx] = col_data.astype(float)
+                # transform merges the values below the first edge into the
+                # first bin, so the first edge never separates two bins
+                col_cuts.append(
+                    np.array(self.col_bin_edges_[col_idx][1:], dtype=np.float64)
+                )
+            else:
+                mapping = self.col_mapping_[col_idx]
+                mapping[np.nan] = self.missing_constant
+                vec_map = np.vectorize(
+                    lambda x: mapping[x] if x in mapping else self.unknown_constant
+                )
+                X_new[:, col_idx] = vec_map(col_data)
+                # a cut halfway between each pair of bins keeps every bin as is
+                col_cuts.append(
+                    np.arange(self.col_n_bins_[col_idx] - 1, dtype=np.float64) + 0.5
+                )
+
+        return X_new, col_cuts
+
     def get_hist_counts(self, attribute_index):
         col_type = self.col_types_[attribute_index]
         if col_type == "continuous":
@@ -449,19 +493,12 @@ class BaseCoreEBM(BaseEstimator):
     def _build_interactions(self, native_ebm):
         if isinstance(self.interactions, int) and self.interactions != 0:
             log.info("Estimating with FAST")
-            interaction_scores = []
             interaction_indices = [
                 x for x in combinations(range(len(self.col_types)), 2)
             ]
-            for pair in interaction_indices:
-                score = native_ebm.fast_interaction_score(pair)
-                interaction_scores.append((pair, score))
-
-            ranked_scores = list(
-                sorted(interaction_scores, key=lambda x: x[1], reverse=True)
+            final_ranked_scores = native_ebm.fast_interaction_scores(
+                interaction_indices, top_k=self.interactions
             )
-            n_interactions = min(len(ranked_scores), self.interactions)
-            final_ranked_scores = ranked_scores[0:n_interactions]
 
             final_indices = [x[0] for x in final_ranked_scores]
             final_scores = [x[1] for x in final_ranked_scores]
@@ -566,49 +603,25 @@ class BaseCoreEBM(BaseEstimator):
 
     def _cyclic_gradient_boost(self, native_ebm, attribute_sets, name=None):
 
-        no_change_run_length = 0
-        curr_metric = np.inf
-        min_metric = np.inf
-        bp_metric = np.inf
         log.info("Start boosting {0}".format(name))
-        curr_episode_index = 0
-        for data_episode_index in range(self.data_n_episodes):
-            curr_episode_index = data_episode_index
-
-            if data_episode_index % 10 == 0:
-                log.debug("Sweep Index for {0}: {1}".format(name, data_episode_index))
-                log.debug("Metric: {0}".format(curr_metric))
-
-            if len(attribute_sets) == 0:
-                log.debug("No sets to boost for {0}".format(name))
-
-            for index, attribute_set in enumerate(attribute_sets):
-                curr_metric = native_ebm.training_step(
-                    index,
-                    training_step_episodes=self.training_step_episodes,
-                    learning_rate=self.learning_rate,
-                    max_tree_splits=self.max_tree_splits,
-                    min_cases_for_split=self.min_cases_for_splits,
-                    training_weights=0,
-                    validation_weights=0,
-                )
-
-            # NOTE: Out of per-feature boosting on purpose.
-            min_metric = min(curr_metric, min_metric)
-
-            if no_change_run_length == 0:
-                bp_metric = min_metric
-            if curr_metric + self.early_stopping_tolerance < bp_metric:
-                no_change_run_length = 0
-            else:
-                no_change_run_length += 1
-
-            if (
-                self.early_stopping_run_length >= 0
-                and no_change_run_length >= self.early_stopping_run_length
-            ):
-                log.info("Early break {0}: {1}".format(name, data_episode_index))
-                break
+        if len(attribute_sets) == 0:
+            log.debug("No sets to boost for {0}".format(name))
+
+        # The whole boosting loop, including early stopping, runs natively.
+        curr_metric, _, n_rounds = native_ebm.training_rounds(
+            list(range(len(attribute_sets))),
+            self.data_n_episodes,
+            training_step_episodes=self.training_step_episodes,
+            learning_rate=self.learning_rate,
+            max_tree_splits=self.max_tree_splits,
+            min_cases_for_split=self.min_cases_for_splits,
+            early_stopping_run_length=self.early_stopping_run_length,
+            early_stopping_tolerance=self.early_stopping_tolerance,
+        )
+        curr_episode_index = max(n_rounds - 1, 0)
+        if n_rounds < self.data_n_episodes:
+            log.info("Early break {0}: {1}".format(name, curr_episode_index))
+        log.debug("Metric: {0}".format(curr_metric))
         log.info("End boosting {0}".format(name))
 
         return curr_metric, curr_episode_index
@@ -44,6 +44,34 @@ class Native:
 
     LogFuncType = ct.CFUNCTYPE(None, ct.c_char, ct.c_char_p)
 
+    # const IntegerDataType TrainingOptionsNone = 0;
+    TrainingOptionsNone = 0
+    # const IntegerDataType TrainingOptionsBorrowBuffers = 1;
+    TrainingOptionsBorrowBuffers = 1
+    # const IntegerDataType TrainingOptionsSparseDominantBins = 2;
+    TrainingOptionsSparseDominantBins = 2
+
+    # const IntegerDataType InteractionOptionsNone = 0;
+    InteractionOptionsNone = 0
+    # const IntegerDataType InteractionOptionsFloatResiduals = 1;
+    InteractionOptionsFloatResiduals = 1
+
+    # indexes into the statistics returned by GetTrainingStatistics and GetInteractionStatistics
+    StatisticNames = [
+        "binning_nanoseconds",
+        "tree_growing_nanoseconds",
+        "tensor_sweep_nanoseconds",
+        "training_update_nanoseconds",
+        "validation_nanoseconds",
+        "best_model_copy_nanoseconds",
+        "instances_scanned",
+        "bins_touched",
+        "nodes_split",
+        "bytes_allocated",
+        "validation_metrics",
+        "validation_instances_scored",
+    ]
+
     # const signed char TraceLevelOff = 0;
     TraceLevelOff = 0
     # const signed char TraceLevelError = 1;
@@ -55,6 +83,10 @@ class Native:
     # const signed char TraceLevelVerbose = 4;
     TraceLevelVerbose = 4
 
+    # Native log messages are buffered and delivered by flush_logging so that
+    # native worker threads never wait on the GIL to log
+    LogMessageBufferCount = 4096
+
     def __init__(self, is_debug=False, log_level=None):
         self.is_debug = is_debug
         self.log_level = log_level
@@ -73,6 +105,22 @@ class Native:
             # signed char traceLevel
             ct.c_char
         ]
+        self.lib.SetLogMessageBuffer.argtypes = [
+            # int64_t countMessages
+            ct.c_longlong
+        ]
+        self.lib.SetLogMessageBuffer.restype = ct.c_longlong
+        self.lib.FlushLogMessages.argtypes = []
+        self.lib.FlushLogMessages.restype = ct.c_longlong
+        self.lib.ConfigureThreads.argtypes = [
+            # int64_t countThreads
+            ct.c_longlong,
+            # int64_t countCpus
+            ct.c_longlong,
+            # int64_t * cpuIndexes
+            ct.POINTER(ct.c_longlong),
+        ]
+        self.lib.ConfigureThreads.restype = ct.c_longlong
         self.lib.InitializeTrainingRegression.argtypes = [
             # int64_t randomSeed
             ct.c_longlong,
@@ -86,30 +134,569 @@ class Native:
             ct.POINTER(self.EbmCoreFeatureCombination),
             # int64_t * featureCombinationIndexes
             ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t countTrainingInstances
-            ct.c_longlong,
-            # double * trainingTargets
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t * trainingBinnedData
-            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
-            # double * trainingPredictorScores
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t countValidationInstances
-            ct.c_longlong,
-            # double * validationTargets
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t * validationBinnedData
-            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
-            # double * validationPredictorScores
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t countInnerBags
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # double * trainingTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # double * validationTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingRegression.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingRegressionWithOptions.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # double * trainingTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # double * validationTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+            # int64_t trainingOptions
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingRegressionWithOptions.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingClassification.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t * trainingTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # int64_t * validationTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingClassification.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingClassificationWithOptions.argtypes = [
+            # int64_t randomSeed
+            ct.c_longlong,
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t * trainingTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # int64_t * validationTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+            # int64_t trainingOptions
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingClassificationWithOptions.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingDataSetRegression.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # double * trainingTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # double * validationTargets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.InitializeTrainingDataSetRegression.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingDataSetClassification.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t * trainingTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * trainingBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t countValidationInstances
+            ct.c_longlong,
+            # int64_t * validationTargets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * validationBinnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.InitializeTrainingDataSetClassification.restype = ct.c_void_p
+
+        self.lib.InitializeTrainingFromDataSet.argtypes = [
+            # void * ebmTrainingDataSet
+            ct.c_void_p,
+            # int64_t randomSeed
+            ct.c_longlong,
+            # double * trainingPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # double * validationPredictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countInnerBags
+            ct.c_longlong,
+            # int64_t trainingOptions
+            ct.c_longlong,
+        ]
+        self.lib.InitializeTrainingFromDataSet.restype = ct.c_void_p
+
+        self.lib.FreeTrainingDataSet.argtypes = [
+            # void * ebmTrainingDataSet
+            ct.c_void_p
+        ]
+
+        self.lib.SaveTrainingDataSet.argtypes = [
+            # void * ebmTrainingDataSet
+            ct.c_void_p,
+            # char * filePath
+            ct.c_char_p,
+        ]
+        self.lib.SaveTrainingDataSet.restype = ct.c_longlong
+
+        self.lib.OpenTrainingDataSet.argtypes = [
+            # char * filePath
+            ct.c_char_p
+        ]
+        self.lib.OpenTrainingDataSet.restype = ct.c_void_p
+
+        self.lib.CreateTrainingDataSetBuilderRegression.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t countValidationInstances
+            ct.c_longlong,
+        ]
+        self.lib.CreateTrainingDataSetBuilderRegression.restype = ct.c_void_p
+
+        self.lib.CreateTrainingDataSetBuilderClassification.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countTrainingInstances
+            ct.c_longlong,
+            # int64_t countValidationInstances
+            ct.c_longlong,
+        ]
+        self.lib.CreateTrainingDataSetBuilderClassification.restype = ct.c_void_p
+
+        self.lib.AppendTrainingDataSetBuilderRegression.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p,
+            # int64_t isValidation
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.AppendTrainingDataSetBuilderRegression.restype = ct.c_longlong
+
+        self.lib.AppendTrainingDataSetBuilderClassification.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p,
+            # int64_t isValidation
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.AppendTrainingDataSetBuilderClassification.restype = ct.c_longlong
+
+        self.lib.AppendTrainingDataSetBuilderRegressionValues.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p,
+            # int64_t isValidation
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.AppendTrainingDataSetBuilderRegressionValues.restype = ct.c_longlong
+
+        self.lib.AppendTrainingDataSetBuilderClassificationValues.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p,
+            # int64_t isValidation
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+        ]
+        self.lib.AppendTrainingDataSetBuilderClassificationValues.restype = ct.c_longlong
+
+        self.lib.FinishTrainingDataSetBuilder.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p
+        ]
+        self.lib.FinishTrainingDataSetBuilder.restype = ct.c_void_p
+
+        self.lib.FreeTrainingDataSetBuilder.argtypes = [
+            # void * ebmTrainingDataSetBuilder
+            ct.c_void_p
+        ]
+
+        self.lib.SampleTrainingWithoutReplacement.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t randomSeed
+            ct.c_longlong,
+            # double subsampleFraction
+            ct.c_double,
+        ]
+        self.lib.SampleTrainingWithoutReplacement.restype = ct.c_longlong
+
+        self.lib.SetInstanceWeights.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # double * trainingWeights (nullptr for unweighted)
+            ct.c_void_p,
+            # double * validationWeights (nullptr for unweighted)
+            ct.c_void_p,
+        ]
+        self.lib.SetInstanceWeights.restype = ct.c_longlong
+
+        self.lib.SetValidationMetricInterval.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t countUpdatesPerValidationMetric
+            ct.c_longlong,
+        ]
+        self.lib.SetValidationMetricInterval.restype = ct.c_longlong
+
+        self.lib.GenerateModelFeatureCombinationUpdate.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # double learningRate
+            ct.c_double,
+            # int64_t countTreeSplitsMax
+            ct.c_longlong,
+            # int64_t countInstancesRequiredForParentSplitMin
+            ct.c_longlong,
+            # double * trainingWeights
+            # ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            ct.c_void_p,
+            # double * validationWeights
+            # ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            ct.c_void_p,
+            # double * gainReturn
+            ct.POINTER(ct.c_double),
+        ]
+        self.lib.GenerateModelFeatureCombinationUpdate.restype = ct.c_void_p
+
+        self.lib.GetModelFeatureCombinationHistogramsLength.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # int64_t * countHistogramValuesReturn
+            ct.POINTER(ct.c_longlong),
+        ]
+        self.lib.GetModelFeatureCombinationHistogramsLength.restype = ct.c_longlong
+
+        self.lib.BuildModelFeatureCombinationHistograms.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # double * histogramsOut
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.BuildModelFeatureCombinationHistograms.restype = ct.c_longlong
+
+        self.lib.GenerateModelFeatureCombinationUpdateFromHistograms.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # double learningRate
+            ct.c_double,
+            # int64_t countTreeSplitsMax
+            ct.c_longlong,
+            # int64_t countInstancesRequiredForParentSplitMin
+            ct.c_longlong,
+            # double * histograms
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * gainReturn
+            ct.POINTER(ct.c_double),
+        ]
+        self.lib.GenerateModelFeatureCombinationUpdateFromHistograms.restype = ct.c_void_p
+
+        self.lib.ApplyModelFeatureCombinationUpdate.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+            # double * modelFeatureCombinationUpdateTensor
+            ct.c_void_p,
+            # double * validationMetricReturn
+            ct.POINTER(ct.c_double),
+        ]
+        self.lib.ApplyModelFeatureCombinationUpdate.restype = ct.c_longlong
+
+        self.lib.TrainingRounds.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t countFeatureCombinationIndexes
+            ct.c_longlong,
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countRoundsMax
+            ct.c_longlong,
+            # int64_t countTrainingStepsPerFeatureCombination
+            ct.c_longlong,
+            # double learningRate
+            ct.c_double,
+            # int64_t countTreeSplitsMax
+            ct.c_longlong,
+            # int64_t countInstancesRequiredForParentSplitMin
+            ct.c_longlong,
+            # int64_t earlyStoppingRunLength
+            ct.c_longlong,
+            # double earlyStoppingTolerance
+            ct.c_double,
+            # double * validationMetricReturn
+            ct.POINTER(ct.c_double),
+            # double * validationMetricBestReturn
+            ct.POINTER(ct.c_double),
+            # int64_t * countRoundsReturn
+            ct.POINTER(ct.c_longlong),
+        ]
+        self.lib.TrainingRounds.restype = ct.c_longlong
+
+        self.lib.GetCurrentModelFeatureCombination.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+        ]
+        self.lib.GetCurrentModelFeatureCombination.restype = ct.POINTER(ct.c_double)
+
+        self.lib.GetBestModelFeatureCombination.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t indexFeatureCombination
+            ct.c_longlong,
+        ]
+        self.lib.GetBestModelFeatureCombination.restype = ct.POINTER(ct.c_double)
+
+        self.lib.GetTrainingStatistics.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p,
+            # int64_t countStatistics
+            ct.c_longlong,
+            # int64_t * statisticsOut
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.GetTrainingStatistics.restype = ct.c_longlong
+
+        self.lib.FreeTraining.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p
+        ]
+
+        self.lib.PredictBatchRegression.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.PredictBatchRegression.restype = ct.c_longlong
+
+        self.lib.PredictBatchClassification.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t returnProbabilities
+            ct.c_longlong,
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.PredictBatchClassification.restype = ct.c_longlong
+
+        self.lib.PredictBatchRegressionValues.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
+            # int64_t countInstances
             ct.c_longlong,
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
         ]
-        self.lib.InitializeTrainingRegression.restype = ct.c_void_p
+        self.lib.PredictBatchRegressionValues.restype = ct.c_longlong
 
-        self.lib.InitializeTrainingClassification.argtypes = [
-            # int64_t randomSeed
-            ct.c_longlong,
+        self.lib.PredictBatchClassificationValues.argtypes = [
             # int64_t countFeatures
             ct.c_longlong,
             # EbmCoreFeature * features
@@ -120,81 +707,119 @@ class Native:
             ct.POINTER(self.EbmCoreFeatureCombination),
             # int64_t * featureCombinationIndexes
             ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
             # int64_t countTargetClasses
             ct.c_longlong,
-            # int64_t countTrainingInstances
+            # int64_t countInstances
             ct.c_longlong,
-            # int64_t * trainingTargets
-            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t * trainingBinnedData
-            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
-            # double * trainingPredictorScores
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t countValidationInstances
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t returnProbabilities
             ct.c_longlong,
-            # int64_t * validationTargets
-            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t * validationBinnedData
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
+        ]
+        self.lib.PredictBatchClassificationValues.restype = ct.c_longlong
+
+        self.lib.BinFeatureValues.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t * binnedData
             ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
-            # double * validationPredictorScores
-            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            # int64_t countInnerBags
+        ]
+        self.lib.BinFeatureValues.restype = ct.c_longlong
+
+        self.lib.SaveModelRegression.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
             ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * intercept
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # char * filePath
+            ct.c_char_p,
         ]
-        self.lib.InitializeTrainingClassification.restype = ct.c_void_p
+        self.lib.SaveModelRegression.restype = ct.c_longlong
 
-        self.lib.GenerateModelFeatureCombinationUpdate.argtypes = [
-            # void * ebmTraining
-            ct.c_void_p,
-            # int64_t indexFeatureCombination
+        self.lib.SaveModelClassification.argtypes = [
+            # int64_t countFeatures
             ct.c_longlong,
-            # double learningRate
-            ct.c_double,
-            # int64_t countTreeSplitsMax
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countFeatureCombinations
             ct.c_longlong,
-            # int64_t countInstancesRequiredForParentSplitMin
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureCombinationIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double ** modelFeatureCombinationTensors
+            ct.POINTER(ct.c_void_p),
+            # int64_t countTargetClasses
             ct.c_longlong,
-            # double * trainingWeights
-            # ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            ct.c_void_p,
-            # double * validationWeights
-            # ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
-            ct.c_void_p,
-            # double * gainReturn
-            ct.POINTER(ct.c_double),
+            # double * cuts
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # double * intercept
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS", ndim=1),
+            # char * filePath
+            ct.c_char_p,
         ]
-        self.lib.GenerateModelFeatureCombinationUpdate.restype = ct.c_void_p
+        self.lib.SaveModelClassification.restype = ct.c_longlong
 
-        self.lib.ApplyModelFeatureCombinationUpdate.argtypes = [
-            # void * ebmTraining
-            ct.c_void_p,
-            # int64_t indexFeatureCombination
-            ct.c_longlong,
-            # double * modelFeatureCombinationUpdateTensor
-            ct.c_void_p,
-            # double * validationMetricReturn
-            ct.POINTER(ct.c_double),
+        self.lib.OpenModel.argtypes = [
+            # char * filePath
+            ct.c_char_p
         ]
-        self.lib.ApplyModelFeatureCombinationUpdate.restype = ct.c_longlong
+        self.lib.OpenModel.restype = ct.c_void_p
 
-        self.lib.GetCurrentModelFeatureCombination.argtypes = [
-            # void * ebmTraining
-            ct.c_void_p,
-            # int64_t indexFeatureCombination
-            ct.c_longlong,
+        self.lib.GetModelCountFeatures.argtypes = [
+            # void * ebmModel
+            ct.c_void_p
         ]
-        self.lib.GetCurrentModelFeatureCombination.restype = ct.POINTER(ct.c_double)
+        self.lib.GetModelCountFeatures.restype = ct.c_longlong
 
-        self.lib.GetBestModelFeatureCombination.argtypes = [
-            # void * ebmTraining
+        self.lib.GetModelCountTargetClasses.argtypes = [
+            # void * ebmModel
+            ct.c_void_p
+        ]
+        self.lib.GetModelCountTargetClasses.restype = ct.c_longlong
+
+        self.lib.PredictModel.argtypes = [
+            # void * ebmModel
             ct.c_void_p,
-            # int64_t indexFeatureCombination
+            # int64_t countInstances
             ct.c_longlong,
+            # double * values
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=2),
+            # int64_t returnProbabilities
+            ct.c_longlong,
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="C_CONTIGUOUS"),
         ]
-        self.lib.GetBestModelFeatureCombination.restype = ct.POINTER(ct.c_double)
+        self.lib.PredictModel.restype = ct.c_longlong
 
-        self.lib.FreeTraining.argtypes = [
-            # void * ebmTraining
+        self.lib.FreeModel.argtypes = [
+            # void * ebmModel
             ct.c_void_p
         ]
 
@@ -232,6 +857,50 @@ class Native:
         ]
         self.lib.InitializeInteractionRegression.restype = ct.c_void_p
 
+        self.lib.InitializeInteractionClassificationWithOptions.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countTargetClasses
+            ct.c_longlong,
+            # int64_t countInstances
+            ct.c_longlong,
+            # int64_t * targets
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t interactionOptions
+            ct.c_longlong,
+        ]
+        self.lib.InitializeInteractionClassificationWithOptions.restype = ct.c_void_p
+
+        self.lib.InitializeInteractionRegressionWithOptions.argtypes = [
+            # int64_t countFeatures
+            ct.c_longlong,
+            # EbmCoreFeature * features
+            ct.POINTER(self.EbmCoreFeature),
+            # int64_t countInstances
+            ct.c_longlong,
+            # double * targets
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t * binnedData
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=2),
+            # double * predictorScores
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t interactionOptions
+            ct.c_longlong,
+        ]
+        self.lib.InitializeInteractionRegressionWithOptions.restype = ct.c_void_p
+
+        self.lib.InitializeInteractionFromTraining.argtypes = [
+            # void * ebmTraining
+            ct.c_void_p
+        ]
+        self.lib.InitializeInteractionFromTraining.restype = ct.c_void_p
+
         self.lib.GetInteractionScore.argtypes = [
             # void * ebmInteraction
             ct.c_void_p,
@@ -244,6 +913,34 @@ class Native:
         ]
         self.lib.GetInteractionScore.restype = ct.c_longlong
 
+        self.lib.GetInteractionScores.argtypes = [
+            # void * ebmInteraction
+            ct.c_void_p,
+            # int64_t countFeatureCombinations
+            ct.c_longlong,
+            # EbmCoreFeatureCombination * featureCombinations
+            ct.POINTER(self.EbmCoreFeatureCombination),
+            # int64_t * featureIndexes
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # int64_t countTopScores
+            ct.c_longlong,
+            # int64_t * featureCombinationIndexesReturn
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+            # double * interactionScoresReturn
+            ndpointer(dtype=ct.c_double, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.GetInteractionScores.restype = ct.c_longlong
+
+        self.lib.GetInteractionStatistics.argtypes = [
+            # void * ebmInteraction
+            ct.c_void_p,
+            # int64_t countStatistics
+            ct.c_longlong,
+            # int64_t * statisticsOut
+            ndpointer(dtype=ct.c_longlong, flags="F_CONTIGUOUS", ndim=1),
+        ]
+        self.lib.GetInteractionStatistics.restype = ct.c_longlong
+
         self.lib.FreeInteraction.argtypes = [
             # void * ebmInteraction
             ct.c_void_p
@@ -285,6 +982,13 @@ class Native:
         self.typed_log_func = self.LogFuncType(native_log)
         self.lib.SetLogMessageFunction(self.typed_log_func)
         self.lib.SetTraceLevel(ct.c_char(level_dict[level]))
+        if level_dict[level] != self.TraceLevelOff:
+            if self.lib.SetLogMessageBuffer(self.LogMessageBufferCount) != 0:
+                log.warning("Native log message buffer unavailable, logging directly")
+
+    def flush_logging(self):
+        """ Delivers buffered native log messages to Python logging. """
+        self.lib.FlushLogMessages()
 
     def get_ebm_lib_path(self, debug=False):
         """ Returns filepath of core EBM library.
@@ -320,6 +1024,176 @@ class Native:
             raise Exception(msg)
 
 
+def add_predictor_scores(
+    X, attribute_sets, attribute_set_models, score_vector, col_cuts=None
+):
+    """ Adds the log odds (or regression predictions) of every attribute set
+        to score_vector in a single native pass.
+
+    Args:
+        X: Binned design matrix as 2-D ndarray, or raw values if col_cuts
+            is given.
+        attribute_sets: List of attribute sets represented as
+            a dictionary of keys ('n_attributes', 'attributes')
+        attribute_set_models: Tensors as returned by get_best_model,
+            in the same order as attribute_sets.
+        score_vector: Float64 ndarray of shape (n_instances,) or
+            (n_instances, n_classes) for multiclass. Updated in place.
+        col_cuts: Optional list with one sorted float64 array of cut points
+            per attribute. If given, the native code bins X while it scores,
+            where a value's bin is the number of cuts less than or equal to
+            it and NaN goes in the last bin.
+
+    Returns:
+        score_vector.
+    """
+    if this.native is None:
+        log.info("EBM lib loading.")
+        this.native = Native()
+
+    n_attributes = X.shape[1]
+    if col_cuts is None:
+        # Attributes that no set uses can have any bin count since they
+        # won't be read
+        n_bins = [1] * n_attributes
+    else:
+        # The native code finds each attribute's cuts from its bin count
+        n_bins = [len(cuts) + 1 for cuts in col_cuts]
+    # Tensors are indexed by the attributes in reversed order
+    attribute_sets_ar = (Native.EbmCoreFeatureCombination * len(attribute_sets))()
+    attribute_set_indexes = []
+    tensors = []
+    for set_idx, attribute_set in enumerate(attribute_sets):
+        attr_idxs = attribute_set["attributes"]
+        attribute_sets_ar[set_idx].countFeaturesInCombination = len(attr_idxs)
+        tensor = np.ascontiguousarray(attribute_set_models[set_idx], dtype=np.float64)
+        for dim_idx, attr_idx in enumerate(attr_idxs):
+            if col_cuts is None:
+                n_bins[attr_idx] = tensor.shape[len(attr_idxs) - 1 - dim_idx]
+            attribute_set_indexes.append(attr_idx)
+        tensors.append(tensor)
+
+    attribute_ar = (Native.EbmCoreFeature * n_attributes)()
+    for attr_idx in range(n_attributes):
+        attribute_ar[attr_idx].featureType = Native.FeatureTypeOrdinal
+        attribute_ar[attr_idx].hasMissing = 0
+        attribute_ar[attr_idx].countBins = n_bins[attr_idx]
+
+    attribute_set_indexes = np.array(attribute_set_indexes, dtype="int64")
+    tensor_pointers = (ct.c_void_p * len(tensors))(
+        *[tensor.ctypes.data for tensor in tensors]
+    )
+
+    if col_cuts is None:
+        X_f = np.asfortranarray(X, dtype="int64")
+        if score_vector.ndim == 2:
+            return_code = this.native.lib.PredictBatchClassification(
+                n_attributes,
+                attribute_ar,
+                len(attribute_sets),
+                attribute_sets_ar,
+                attribute_set_indexes,
+                tensor_pointers,
+                score_vector.shape[1],
+                X_f.shape[0],
+                X_f,
+                0,
+                score_vector,
+            )
+        else:
+            # Binary classification has a single logit per instance, so summing
+            # its logits is the same operation as summing regression predictions
+            return_code = this.native.lib.PredictBatchRegression(
+                n_attributes,
+                attribute_ar,
+                len(attribute_sets),
+                attribute_sets_ar,
+                attribute_set_indexes,
+                tensor_pointers,
+                X_f.shape[0],
+                X_f,
+                score_vector,
+            )
+    else:
+        X_f = np.asfortranarray(X, dtype=np.float64)
+        cuts = np.concatenate(
+            [np.empty(0, dtype=np.float64)]
+            + [np.asarray(col, dtype=np.float64) for col in col_cuts]
+        )
+        if score_vector.ndim == 2:
+            return_code = this.native.lib.PredictBatchClassificationValues(
+                n_attributes,
+                attribute_ar,
+                len(attribute_sets),
+                attribute_sets_ar,
+                attribute_set_indexes,
+                tensor_pointers,
+                score_vector.shape[1],
+                X_f.shape[0],
+                cuts,
+                X_f,
+                0,
+                score_vector,
+            )
+        else:
+            return_code = this.native.lib.PredictBatchRegressionValues(
+                n_attributes,
+                attribute_ar,
+                len(attribute_sets),
+                attribute_sets_ar,
+                attribute_set_indexes,
+                tensor_pointers,
+                X_f.shape[0],
+                cuts,
+                X_f,
+                score_vector,
+            )
+    this.native.flush_logging()
+    if return_code != 0:  # pragma: no cover
+        raise Exception("Prediction failed in native code")
+
+    return score_vector
+
+
+def bin_values(X, col_cuts):
+    """ Bins raw values in native code with the same rules that
+        add_predictor_scores uses when it's given col_cuts.
+
+    Args:
+        X: Raw values as 2-D ndarray.
+        col_cuts: List with one sorted float64 array of cut points per
+            attribute, as returned by EBMPreprocessor.transform_values.
+
+    Returns:
+        Int64 ndarray of bins with the same shape as X.
+    """
+    if this.native is None:
+        log.info("EBM lib loading.")
+        this.native = Native()
+
+    n_attributes = X.shape[1]
+    attribute_ar = (Native.EbmCoreFeature * n_attributes)()
+    for attr_idx in range(n_attributes):
+        attribute_ar[attr_idx].featureType = Native.FeatureTypeOrdinal
+        attribute_ar[attr_idx].hasMissing = 0
+        attribute_ar[attr_idx].countBins = len(col_cuts[attr_idx]) + 1
+
+    X_f = np.asfortranarray(X, dtype=np.float64)
+    cuts = np.concatenate(
+        [np.empty(0, dtype=np.float64)]
+        + [np.asarray(col, dtype=np.float64) for col in col_cuts]
+    )
+    binned = np.empty(X_f.shape, dtype=np.int64, order="F")
+    return_code = this.native.lib.BinFeatureValues(
+        n_attributes, attribute_ar, cuts, X_f.shape[0], X_f, binned
+    )
+    this.native.flush_logging()
+    if return_code != 0:  # pragma: no cover
+        raise Exception("Binning failed in native code")
+
+    return binned
+
+
 class NativeEBM:
     """Lightweight wrapper for EBM C code.
     """
@@ -338,6 +1212,7 @@ class NativeEBM:
         training_scores=None,
         validation_scores=None,
         random_state=1337,
+        interaction_float_residuals=False,
     ):
 
         # TODO: Update documentation for training/val scores args.
@@ -359,6 +1234,8 @@ class NativeEBM:
             training_scores: Undocumented.
             validation_scores: Undocumented.
             random_state: Random seed as integer.
+            interaction_float_residuals: Store the interaction detection
+                residuals as float32 to halve their memory.
         """
         log.debug("Check if EBM lib is loaded")
         if this.native is None:
@@ -407,6 +1284,7 @@ class NativeEBM:
             else:
                 self.validation_scores = np.zeros(X_train.shape[0])
         self.random_state = random_state
+        self.interaction_float_residuals = interaction_float_residuals
 
         # Convert n-dim arrays ready for C.
         self.X_train_f = np.asfortranarray(self.X_train)
@@ -418,17 +1296,23 @@ class NativeEBM:
 
         # Allocate external resources
         if self.model_type == "regression":
-            self.y_train = self.y_train.astype("float64")
-            self.y_val = self.y_val.astype("float64")
+            self.y_train = self.y_train.astype("float64", copy=False)
+            self.y_val = self.y_val.astype("float64", copy=False)
             self._initialize_training_regression()
             self._initialize_interaction_regression()
         elif self.model_type == "classification":
-            self.y_train = self.y_train.astype("int64")
-            self.y_val = self.y_val.astype("int64")
+            self.y_train = self.y_train.astype("int64", copy=False)
+            self.y_val = self.y_val.astype("int64", copy=False)
 
             self._initialize_training_classification()
             self._initialize_interaction_classification()
 
+        # The core repacks the binned data during initialization, so we don't
+        # need to hold onto our Fortran ordered copies.
+        self.X_train_f = None
+        self.X_val_f = None
+        this.native.flush_logging()
+
         log.info("Allocation end")
 
     def _convert_attribute_info_to_c(self, attributes, attribute_sets):
@@ -459,17 +1343,18 @@ class NativeEBM:
         return attribute_ar, attribute_sets_ar, attribute_set_indexes
 
     def _initialize_interaction_regression(self):
-        self.interaction_pointer = this.native.lib.InitializeInteractionRegression(
+        self.interaction_pointer = this.native.lib.InitializeInteractionRegressionWithOptions(
             len(self.attribute_array),
             self.attribute_array,
             self.X_train.shape[0],
             self.y_train,
             self.X_train_f,
             self.training_scores,
+            self._interaction_options(),
         )
 
     def _initialize_interaction_classification(self):
-        self.interaction_pointer = this.native.lib.InitializeInteractionClassification(
+        self.interaction_pointer = this.native.lib.InitializeInteractionClassificationWithOptions(
             len(self.attribute_array),
             self.attribute_array,
             self.num_classification_states,
@@ -477,10 +1362,16 @@ class NativeEBM:
             self.y_train,
             self.X_train_f,
             self.training_scores,
+            self._interaction_options(),
         )
 
+    def _interaction_options(self):
+        if self.interaction_float_residuals:
+            return this.native.InteractionOptionsFloatResiduals
+        return this.native.InteractionOptionsNone
+
     def _initialize_training_regression(self):
-        self.model_pointer = this.native.lib.InitializeTrainingRegression(
+        self.model_pointer = this.native.lib.InitializeTrainingRegressionWithOptions(
             self.random_state,
             len(self.attribute_array),
             self.attribute_array,
@@ -496,10 +1387,13 @@ class NativeEBM:
             self.X_val_f,
             self.validation_scores,
             self.num_inner_bags,
+            # the core keeps pointers to our targets and scores instead of
+            # copying them, and updates the scores in place as it trains
+            this.native.TrainingOptionsBorrowBuffers,
         )
 
     def _initialize_training_classification(self):
-        self.model_pointer = this.native.lib.InitializeTrainingClassification(
+        self.model_pointer = this.native.lib.InitializeTrainingClassificationWithOptions(
             self.random_state,
             len(self.attribute_array),
             self.attribute_array,
@@ -516,6 +1410,9 @@ class NativeEBM:
             self.X_val_f,
             self.validation_scores,
             self.num_inner_bags,
+            # the core keeps pointers to our targets and scores instead of
+            # copying them, and updates the scores in place as it trains
+            this.native.TrainingOptionsBorrowBuffers,
         )
 
     def close(self):
@@ -523,6 +1420,7 @@ class NativeEBM:
         log.info("Deallocation start")
         this.native.lib.FreeTraining(self.model_pointer)
         this.native.lib.FreeInteraction(self.interaction_pointer)
+        this.native.flush_logging()
         log.info("Deallocation end")
 
     def fast_interaction_score(self, attribute_index_tuple):
@@ -535,9 +1433,114 @@ class NativeEBM:
             np.array(attribute_index_tuple, dtype=np.int64),
             ct.byref(score),
         )
+        this.native.flush_logging()
         log.info("Fast interaction score end")
         return score.value
 
+    def fast_interaction_scores(self, attribute_index_tuples, top_k=None):
+        """ Scores many attribute interactions in one native call.
+
+        Args:
+            attribute_index_tuples: List of attribute index tuples.
+            top_k: If given, only the top_k highest scoring tuples are
+                returned, best first. Ties keep their original order.
+
+        Returns:
+            List of (attribute_index_tuple, score) pairs, in the order of
+            attribute_index_tuples if top_k is None.
+        """
+        log.info("Fast interaction scores start")
+        n_sets = len(attribute_index_tuples)
+        attribute_sets_ar = (this.native.EbmCoreFeatureCombination * n_sets)()
+        attribute_indexes = []
+        for idx, attribute_index_tuple in enumerate(attribute_index_tuples):
+            attribute_sets_ar[idx].countFeaturesInCombination = len(
+                attribute_index_tuple
+            )
+            attribute_indexes.extend(attribute_index_tuple)
+        attribute_indexes = np.array(attribute_indexes, dtype=np.int64)
+
+        n_scores = n_sets if top_k is None else max(min(top_k, n_sets), 0)
+        set_indexes = np.zeros(n_scores, dtype=np.int64)
+        scores = np.zeros(n_scores, dtype=np.float64)
+        return_code = this.native.lib.GetInteractionScores(
+            self.interaction_pointer,
+            n_sets,
+            attribute_sets_ar,
+            attribute_indexes,
+            -1 if top_k is None else n_scores,
+            set_indexes,
+            scores,
+        )
+        this.native.flush_logging()
+        if return_code != 0:  # pragma: no cover
+            raise Exception("GetInteractionScores Exception")
+        log.info("Fast interaction scores end")
+
+        if top_k is None:
+            return list(zip(attribute_index_tuples, scores.tolist()))
+        return [
+            (attribute_index_tuples[set_idx], score)
+            for set_idx, score in zip(set_indexes.tolist(), scores.tolist())
+        ]
+
+    def sample_without_replacement(self, random_state, subsample_fraction):
+        """ Replaces the inner bags with samples drawn without replacement.
+
+        Args:
+            random_state: Random seed as integer.
+            subsample_fraction: Fraction of the training instances
+                that each inner bag selects, in the range (0, 1].
+        """
+        return_code = this.native.lib.SampleTrainingWithoutReplacement(
+            self.model_pointer, random_state, subsample_fraction
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("SampleTrainingWithoutReplacement Exception")
+
+    def set_instance_weights(self, training_weights, validation_weights):
+        """ Weights the training and validation instances.
+
+        Args:
+            training_weights: Positive weight per training instance,
+                or None for unweighted.
+            validation_weights: Positive weight per validation instance,
+                or None for unweighted.
+        """
+        # the native side copies the weights, so these only need to live through the call
+        training_weights = (
+            None
+            if training_weights is None
+            else np.ascontiguousarray(training_weights, dtype=np.float64)
+        )
+        validation_weights = (
+            None
+            if validation_weights is None
+            else np.ascontiguousarray(validation_weights, dtype=np.float64)
+        )
+        return_code = this.native.lib.SetInstanceWeights(
+            self.model_pointer,
+            None if training_weights is None else training_weights.ctypes.data,
+            None if validation_weights is None else validation_weights.ctypes.data,
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("SetInstanceWeights Exception")
+
+    def set_validation_metric_interval(self, updates_per_metric):
+        """ Sets how often training computes the validation metric.
+
+        Args:
+            updates_per_metric: Compute the metric on every
+                updates_per_metric-th update. Zero only computes it at
+                the end of each training_rounds round. Skipped updates
+                return the last metric and can't become the best model.
+        """
+        return_code = this.native.lib.SetValidationMetricInterval(
+            self.model_pointer, updates_per_metric
+        )
+        if return_code != 0:  # pragma: no cover
+            raise Exception("SetValidationMetricInterval Exception")
+
     def training_step(
         self,
         attribute_set_index,
@@ -592,9 +1595,74 @@ class NativeEBM:
             if return_code != 0:  # pragma: no cover
                 raise Exception("ApplyModelFeatureCombinationUpdate Exception")
 
+        this.native.flush_logging()
         # log.debug("Training step end")
         return metric_output.value
 
+    def training_rounds(
+        self,
+        attribute_set_indexes,
+        max_rounds,
+        training_step_episodes=1,
+        learning_rate=0.01,
+        max_tree_splits=2,
+        min_cases_for_split=2,
+        early_stopping_run_length=-1,
+        early_stopping_tolerance=0.0,
+    ):
+
+        """ Runs whole boosting rounds natively, where each round
+            conducts training steps on every attribute set in order.
+
+        Args:
+            attribute_set_indexes: The indexes for the attribute sets
+                to train on in each round.
+            max_rounds: Maximum number of rounds to run.
+            training_step_episodes: Number of episodes to train feature step.
+            learning_rate: Learning rate as a float.
+            max_tree_splits: Max tree splits on feature step.
+            min_cases_for_split: Min observations required to split.
+            early_stopping_run_length: Number of rounds without improvement
+                before stopping. Negative disables early stopping.
+            early_stopping_tolerance: Improvement required to reset the
+                early stopping run length.
+
+        Returns:
+            Tuple of validation loss for the last round, best validation
+            loss, and number of rounds run.
+        """
+        indexes = np.ascontiguousarray(attribute_set_indexes, dtype=np.int64)
+        if indexes.size == 0:
+            # ndpointer rejects None, so hand over a dummy that is never read
+            indexes = np.zeros(1, dtype=np.int64)
+            count_indexes = 0
+        else:
+            count_indexes = indexes.size
+
+        metric_output = ct.c_double(0.0)
+        metric_best_output = ct.c_double(0.0)
+        rounds_output = ct.c_longlong(0)
+        return_code = this.native.lib.TrainingRounds(
+            self.model_pointer,
+            count_indexes,
+            indexes,
+            max_rounds,
+            training_step_episodes,
+            learning_rate,
+            max_tree_splits,
+            min_cases_for_split,
+            early_stopping_run_length,
+            early_stopping_tolerance,
+            ct.byref(metric_output),
+            ct.byref(metric_best_output),
+            ct.byref(rounds_output),
+        )
+        this.native.flush_logging()
+        if return_code != 0:  # pragma: no cover
+            raise Exception("TrainingRounds Exception")
+
+        return metric_output.value, metric_best_output.value, rounds_output.value
+
     def _get_attribute_set_shape(self, attribute_set_index):
         # Retrieve dimensions of log odds tensor
         dimensions = []
@@ -635,6 +1703,31 @@ class NativeEBM:
         )
         return array.copy()
 
+    def get_statistics(self):
+        """ Returns the time spent in each native phase and counts of the
+            work done, for training and for interaction detection.
+
+        Returns:
+            Dictionary with "training" and "interaction" keys, each mapping
+            statistic names to integer totals. Times are in nanoseconds.
+        """
+        statistics = {}
+        for key, function, pointer in [
+            ("training", this.native.lib.GetTrainingStatistics, self.model_pointer),
+            (
+                "interaction",
+                this.native.lib.GetInteractionStatistics,
+                self.interaction_pointer,
+            ),
+        ]:
+            values = np.zeros(len(Native.StatisticNames), dtype=np.int64, order="F")
+            if pointer is not None:
+                return_code = function(pointer, len(values), values)
+                if return_code != 0:  # pragma: no cover
+                    raise Exception("Get{}Statistics Exception".format(key.title()))
+            statistics[key] = dict(zip(Native.StatisticNames, values.tolist()))
+        return statistics
+
     def get_current_model(self, attribute_set_index):
         """ Returns current model/function according to validation set
             for a given attribute set.
@@ -8,7 +8,12 @@ from ....test.utils import (
     iris_classification,
 )
 from ....test.utils import synthetic_regression
-from ..ebm import ExplainableBoostingRegressor, ExplainableBoostingClassifier
+from ..ebm import (
+    ExplainableBoostingRegressor,
+    ExplainableBoostingClassifier,
+    EBMPreprocessor,
+)
+from ..internal import bin_values
 
 import numpy as np
 import pandas as pd
@@ -99,6 +104,43 @@ def test_prefit_ebm():
         assert not has_non_zero
 
 
+def test_native_binning_matches_transform():
+    schema = {
+        "c0": {"column_number": 0, "type": "continuous"},
+        "c1": {"column_number": 1, "type": "categorical"},
+        "c2": {"column_number": 2, "type": "continuous"},
+    }
+    # few unique values make c0's edges the values themselves, and more
+    # values than max_n_bins make c2's edges uniform
+    X_fit = np.array(
+        [[float(i % 5), "abcd"[i % 4], np.sin(i) * 100.0] for i in range(300)],
+        dtype=object,
+    )
+    preprocessor = EBMPreprocessor(schema=schema, max_n_bins=20)
+    preprocessor.fit(X_fit)
+
+    # values below, between, on and above the edges, NaN, and a category
+    # that wasn't seen during fit
+    X = np.array(
+        [
+            [-1.0, "a", -1000.0],
+            [0.0, "b", -100.0],
+            [2.5, "c", 0.0],
+            [4.0, "d", 99.0],
+            [9.0, "e", 1000.0],
+            [np.nan, "a", np.nan],
+        ]
+        + [[float(i % 7) - 1.0, "abcde"[i % 5], i * 7.3 - 120.0] for i in range(40)],
+        dtype=object,
+    )
+    # a value on an edge goes in the bin above it, so bin every edge of c2 too
+    for edge in preprocessor.col_bin_edges_[2]:
+        X = np.vstack([X, np.array([[0.0, "a", edge]], dtype=object)])
+
+    values, col_cuts = preprocessor.transform_values(X)
+    assert np.array_equal(bin_values(values, col_cuts), preprocessor.transform(X))
+
+
 @pytest.mark.slow
 def test_ebm_synthetic_regression():
     data = synthetic_regression()
@@ -8,6 +8,7 @@ from sklearn.utils.extmath import softmax
 import numbers
 import numpy as np
 
+from .internal import add_predictor_scores
 
 import logging
 
@@ -63,7 +64,12 @@ class EBMUtils:
 
     @staticmethod
     def decision_function(
-        X, attribute_sets, attribute_set_models, intercept, skip_attr_set_idxs=[]
+        X,
+        attribute_sets,
+        attribute_set_models,
+        intercept,
+        skip_attr_set_idxs=[],
+        col_cuts=None,
     ):
 
         if X.ndim == 1:
@@ -77,11 +83,18 @@ class EBMUtils:
 
         score_vector += intercept
 
-        scores_gen = EBMUtils.scores_by_attrib_set(
-            X, attribute_sets, attribute_set_models, skip_attr_set_idxs
+        kept_set_idxs = [
+            set_idx
+            for set_idx in range(len(attribute_sets))
+            if set_idx not in skip_attr_set_idxs
+        ]
+        add_predictor_scores(
+            X,
+            [attribute_sets[set_idx] for set_idx in kept_set_idxs],
+            [attribute_set_models[set_idx] for set_idx in kept_set_idxs],
+            score_vector,
+            col_cuts,
         )
-        for _, _, scores in scores_gen:
-            score_vector += scores
 
         if not np.all(np.isfinite(score_vector)):  # pragma: no cover
             msg = "Non-finite values present in log odds vector."
@@ -117,13 +130,14 @@ class EBMUtils:
     #     return score_vector
 
     @staticmethod
-    def classifier_predict_proba(X, estimator, skip_attr_set_idxs=[]):
+    def classifier_predict_proba(X, estimator, skip_attr_set_idxs=[], col_cuts=None):
         log_odds_vector = EBMUtils.decision_function(
             X,
             estimator.attribute_sets_,
             estimator.attribute_set_models_,
             estimator.intercept_,
             skip_attr_set_idxs,
+            col_cuts,
         )
 
         # Handle binary classification case -- softmax only works with 0s appended
@@ -150,18 +164,21 @@ class EBMUtils:
     #     return scores
 
     @staticmethod
-    def classifier_predict(X, estimator, skip_attr_set_idxs=[]):
-        scores = EBMUtils.classifier_predict_proba(X, estimator, skip_attr_set_idxs)
+    def classifier_predict(X, estimator, skip_attr_set_idxs=[], col_cuts=None):
+        scores = EBMUtils.classifier_predict_proba(
+            X, estimator, skip_attr_set_idxs, col_cuts
+        )
         return estimator.classes_[np.argmax(scores, axis=1)]
 
     @staticmethod
-    def regressor_predict(X, estimator, skip_attr_set_idxs=[]):
+    def regressor_predict(X, estimator, skip_attr_set_idxs=[], col_cuts=None):
         scores = EBMUtils.decision_function(
             X,
             estimator.attribute_sets_,
             estimator.attribute_set_models_,
             estimator.intercept_,
             skip_attr_set_idxs,
+            col_cuts,
         )
         return scores
 
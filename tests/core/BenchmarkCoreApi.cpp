@@ -0,0 +1,415 @@
+// Copyright (c) 2018 Microsoft Corporation
+// Licensed under the MIT license.
+// Author: Paul Koch <code@koch.ninja>
+
+// throughput benchmarks for the hot paths of the C API.  TestCoreApi checks correctness on tiny data sets, so this is where we track speed across commits.
+// Each benchmark runs on synthetic data and prints one JSON object per line to stdout so that scripts can collect and compare runs.  Anything that isn't
+// a result goes to stderr.  We only time calls through the public API, so this measures what our callers see, including any threading or instruction
+// set dispatch that the core does internally
+//
+// usage: benchmark_core_api [-instances N] [-seconds S] [-filter TEXT]
+//   -instances N   training instances per data set (default 100000).  Validation gets another 25% and interaction detection uses the training instances
+//   -seconds S     minimum seconds to spend timing each benchmark (default 0.25).  Each benchmark runs at least twice, including one warm up call
+//   -filter TEXT   only run benchmarks whose name contains TEXT
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "ebmcore.h"
+
+constexpr IntegerDataType k_learningTypeRegression = IntegerDataType { -1 };
+constexpr IntegerDataType k_randomSeed = 42;
+constexpr FractionalDataType k_learningRate = 0.01;
+constexpr IntegerDataType k_countTreeSplitsMax = 4;
+constexpr IntegerDataType k_countInstancesRequiredForParentSplitMin = 2;
+constexpr size_t k_cFeatures = 8;
+// we skip triples whose tensors would need more than this many histogram buckets, which keeps the 256 bin configurations from needing gigabytes
+constexpr size_t k_cTripleBucketsMax = size_t { 1 } << 18;
+
+struct BenchmarkOptions {
+   size_t m_cInstances;
+   double m_secondsMin;
+   const char * m_filter;
+};
+
+static size_t GetVectorLength(const IntegerDataType learningTypeOrCountTargetClasses) {
+   // binary classification has 1 logit, just like regression
+   return learningTypeOrCountTargetClasses <= 2 ? size_t { 1 } : static_cast<size_t>(learningTypeOrCountTargetClasses);
+}
+
+static const char * GetLearningTypeName(const IntegerDataType learningTypeOrCountTargetClasses) {
+   return k_learningTypeRegression == learningTypeOrCountTargetClasses ? "regression" : 2 == learningTypeOrCountTargetClasses ? "binary" : "multiclass";
+}
+
+// splitmix64 is plenty for synthetic data and keeps the data identical on every platform and compiler, which std::uniform_int_distribution doesn't
+class SyntheticRandom final {
+   uint64_t m_state;
+
+public:
+
+   SyntheticRandom(const uint64_t seed) : m_state(seed) {
+   }
+
+   uint64_t Next() {
+      m_state += uint64_t { 0x9E3779B97F4A7C15 };
+      uint64_t z = m_state;
+      z = (z ^ (z >> 30)) * uint64_t { 0xBF58476D1CE4E5B9 };
+      z = (z ^ (z >> 27)) * uint64_t { 0x94D049BB133111EB };
+      return z ^ (z >> 31);
+   }
+
+   size_t NextIndex(const size_t cItems) {
+      return static_cast<size_t>(Next() % static_cast<uint64_t>(cItems));
+   }
+
+   double NextUnit() {
+      return static_cast<double>(Next() >> 11) * (1.0 / 9007199254740992.0);
+   }
+};
+
+// a synthetic data set with k_cFeatures features of cBins bins each.  Bins are skewed towards the low end like real quantile binned data with ties, and
+// the target depends on the first few features and on one pair so that the trees have something to find.  The feature combinations are every main
+// followed by the pairs (0, 1), (2, 3), ...
+class SyntheticData final {
+public:
+
+   std::vector<EbmCoreFeature> m_features;
+   std::vector<EbmCoreFeatureCombination> m_featureCombinations;
+   std::vector<IntegerDataType> m_featureCombinationIndexes;
+   size_t m_iFeatureCombinationPairFirst;
+
+   std::vector<IntegerDataType> m_trainingBinnedData;
+   std::vector<FractionalDataType> m_trainingTargetsRegression;
+   std::vector<IntegerDataType> m_trainingTargetsClassification;
+
+   std::vector<IntegerDataType> m_validationBinnedData;
+   std::vector<FractionalDataType> m_validationTargetsRegression;
+   std::vector<IntegerDataType> m_validationTargetsClassification;
+
+   SyntheticData(const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cTrainingInstances, const size_t cValidationInstances) {
+      for(size_t iFeature = 0; iFeature < k_cFeatures; ++iFeature) {
+         EbmCoreFeature feature;
+         feature.featureType = FeatureTypeOrdinal;
+         feature.hasMissing = 0;
+         feature.countBins = static_cast<IntegerDataType>(cBins);
+         m_features.push_back(feature);
+      }
+      for(size_t iFeature = 0; iFeature < k_cFeatures; ++iFeature) {
+         EbmCoreFeatureCombination featureCombination;
+         featureCombination.countFeaturesInCombination = 1;
+         m_featureCombinations.push_back(featureCombination);
+         m_featureCombinationIndexes.push_back(static_cast<IntegerDataType>(iFeature));
+      }
+      m_iFeatureCombinationPairFirst = m_featureCombinations.size();
+      for(size_t iFeature = 0; iFeature + 1 < k_cFeatures; iFeature += 2) {
+         EbmCoreFeatureCombination featureCombination;
+         featureCombination.countFeaturesInCombination = 2;
+         m_featureCombinations.push_back(featureCombination);
+         m_featureCombinationIndexes.push_back(static_cast<IntegerDataType>(iFeature));
+         m_featureCombinationIndexes.push_back(static_cast<IntegerDataType>(iFeature + 1));
+      }
+
+      SyntheticRandom random(static_cast<uint64_t>(k_randomSeed));
+      Generate(random, learningTypeOrCountTargetClasses, cBins, cTrainingInstances, m_trainingBinnedData, m_trainingTargetsRegression, m_trainingTargetsClassification);
+      Generate(random, learningTypeOrCountTargetClasses, cBins, cValidationInstances, m_validationBinnedData, m_validationTargetsRegression, m_validationTargetsClassification);
+   }
+
+private:
+
+   static void Generate(SyntheticRandom & random, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cInstances, std::vector<IntegerDataType> & binnedData, std::vector<FractionalDataType> & targetsRegression, std::vector<IntegerDataType> & targetsClassification) {
+      // binnedData is feature major, which is the layout that InitializeTraining* and InitializeInteraction* take
+      binnedData.resize(k_cFeatures * cInstances);
+      for(size_t iFeature = 0; iFeature < k_cFeatures; ++iFeature) {
+         for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+            // the smaller of two uniform draws skews towards bin 0
+            const size_t iBin0 = random.NextIndex(cBins);
+            const size_t iBin1 = random.NextIndex(cBins);
+            binnedData[iFeature * cInstances + iInstance] = static_cast<IntegerDataType>(iBin0 < iBin1 ? iBin0 : iBin1);
+         }
+      }
+      const double cBinsDouble = static_cast<double>(cBins);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         const double x0 = static_cast<double>(binnedData[0 * cInstances + iInstance]) / cBinsDouble;
+         const double x1 = static_cast<double>(binnedData[1 * cInstances + iInstance]) / cBinsDouble;
+         const double x2 = static_cast<double>(binnedData[2 * cInstances + iInstance]) / cBinsDouble;
+         const double signal = 2.0 * x0 - x1 + (x2 < 0.5 ? 0.5 : -0.5) + 3.0 * x0 * x1;
+         if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+            targetsRegression.push_back(signal + random.NextUnit() - 0.5);
+         } else {
+            // noise spreads the instances over every class, with the signal shifting which classes are likely
+            // signal is within [-1.5, 5.5), so this lands in [0, 1) before we scale it to a class
+            const double unit = (signal + 1.5) / 7.0 * 0.7 + random.NextUnit() * 0.3;
+            const IntegerDataType target = static_cast<IntegerDataType>(unit * static_cast<double>(learningTypeOrCountTargetClasses));
+            targetsClassification.push_back(learningTypeOrCountTargetClasses <= target ? learningTypeOrCountTargetClasses - 1 : target);
+         }
+      }
+   }
+};
+
+static bool IsBenchmarkSelected(const BenchmarkOptions & options, const char * const benchmarkName) {
+   return nullptr == options.m_filter || nullptr != strstr(benchmarkName, options.m_filter);
+}
+
+static void ReportBenchmark(const char * const benchmarkName, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cDimensions, const size_t cRowsPerCall, const size_t cCalls, const double seconds) {
+   const double cRows = static_cast<double>(cRowsPerCall) * static_cast<double>(cCalls);
+   printf(
+      "{\"benchmark\":\"%s\",\"learning_type\":\"%s\",\"classes\":%lld,\"bins\":%zu,\"dimensions\":%zu,\"rows_per_call\":%zu,\"calls\":%zu,\"seconds\":%.6f,\"rows_per_second\":%.1f,\"ns_per_row\":%.4f}\n",
+      benchmarkName,
+      GetLearningTypeName(learningTypeOrCountTargetClasses),
+      static_cast<long long>(k_learningTypeRegression == learningTypeOrCountTargetClasses ? 0 : learningTypeOrCountTargetClasses),
+      cBins,
+      cDimensions,
+      cRowsPerCall,
+      cCalls,
+      seconds,
+      cRows / seconds,
+      seconds * 1e9 / cRows
+   );
+   fflush(stdout);
+}
+
+// calls benchmarkCall once to warm up caches and let the core grow its buffers, and then times calls until at least secondsMin have passed
+template<typename TBenchmarkCall>
+static void RunBenchmark(const BenchmarkOptions & options, const char * const benchmarkName, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cDimensions, const size_t cRowsPerCall, TBenchmarkCall benchmarkCall) {
+   if(!IsBenchmarkSelected(options, benchmarkName)) {
+      return;
+   }
+   benchmarkCall();
+   size_t cCalls = 0;
+   const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+   double seconds;
+   do {
+      benchmarkCall();
+      ++cCalls;
+      seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+   } while(seconds < options.m_secondsMin);
+   ReportBenchmark(benchmarkName, learningTypeOrCountTargetClasses, cBins, cDimensions, cRowsPerCall, cCalls, seconds);
+}
+
+static void Fail(const char * const message) {
+   fprintf(stderr, "benchmark_core_api FAILED: %s\n", message);
+   exit(1);
+}
+
+static PEbmTraining InitializeTraining(const SyntheticData & data, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cTrainingInstances, const size_t cValidationInstances) {
+   PEbmTraining pEbmTraining;
+   if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+      pEbmTraining = InitializeTrainingRegression(k_randomSeed, data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], cTrainingInstances, &data.m_trainingTargetsRegression[0], &data.m_trainingBinnedData[0], nullptr, cValidationInstances, &data.m_validationTargetsRegression[0], &data.m_validationBinnedData[0], nullptr, 0);
+   } else {
+      pEbmTraining = InitializeTrainingClassification(k_randomSeed, data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], learningTypeOrCountTargetClasses, cTrainingInstances, &data.m_trainingTargetsClassification[0], &data.m_trainingBinnedData[0], nullptr, cValidationInstances, &data.m_validationTargetsClassification[0], &data.m_validationBinnedData[0], nullptr, 0);
+   }
+   if(nullptr == pEbmTraining) {
+      Fail("InitializeTraining");
+   }
+   return pEbmTraining;
+}
+
+static PEbmInteraction InitializeInteraction(const SyntheticData & data, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cInstances) {
+   PEbmInteraction pEbmInteraction;
+   if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+      pEbmInteraction = InitializeInteractionRegression(data.m_features.size(), &data.m_features[0], cInstances, &data.m_trainingTargetsRegression[0], &data.m_trainingBinnedData[0], nullptr);
+   } else {
+      pEbmInteraction = InitializeInteractionClassification(data.m_features.size(), &data.m_features[0], learningTypeOrCountTargetClasses, cInstances, &data.m_trainingTargetsClassification[0], &data.m_trainingBinnedData[0], nullptr);
+   }
+   if(nullptr == pEbmInteraction) {
+      Fail("InitializeInteraction");
+   }
+   return pEbmInteraction;
+}
+
+static void BenchmarkTraining(const BenchmarkOptions & options, const SyntheticData & data, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cTrainingInstances, const size_t cValidationInstances) {
+   RunBenchmark(options, "InitializeTraining", learningTypeOrCountTargetClasses, cBins, 0, cTrainingInstances + cValidationInstances, [&]() {
+      FreeTraining(InitializeTraining(data, learningTypeOrCountTargetClasses, cTrainingInstances, cValidationInstances));
+   });
+
+   PEbmTraining pEbmTraining = InitializeTraining(data, learningTypeOrCountTargetClasses, cTrainingInstances, cValidationInstances);
+   const size_t cVectorLength = GetVectorLength(learningTypeOrCountTargetClasses);
+
+   const IntegerDataType aFeatureCombinationIndexes[] = { 0, static_cast<IntegerDataType>(data.m_iFeatureCombinationPairFirst) };
+   for(const IntegerDataType indexFeatureCombination : aFeatureCombinationIndexes) {
+      const size_t cDimensions = static_cast<size_t>(data.m_featureCombinations[static_cast<size_t>(indexFeatureCombination)].countFeaturesInCombination);
+
+      // GenerateModelFeatureCombinationUpdate bins the training set through the sampling sets, so its rows are the training instances.  We cycle through
+      // every combination with cDimensions features like boosting does, since asking for the same combination again would just reload its cached histogram
+      size_t iFeatureCombinationNext = 0;
+      RunBenchmark(options, "GenerateModelFeatureCombinationUpdate", learningTypeOrCountTargetClasses, cBins, cDimensions, cTrainingInstances, [&]() {
+         do {
+            iFeatureCombinationNext = data.m_featureCombinations.size() <= iFeatureCombinationNext + 1 ? 0 : iFeatureCombinationNext + 1;
+         } while(static_cast<IntegerDataType>(cDimensions) != data.m_featureCombinations[iFeatureCombinationNext].countFeaturesInCombination);
+         FractionalDataType gain;
+         if(nullptr == GenerateModelFeatureCombinationUpdate(pEbmTraining, static_cast<IntegerDataType>(iFeatureCombinationNext), k_learningRate, k_countTreeSplitsMax, k_countInstancesRequiredForParentSplitMin, nullptr, nullptr, &gain)) {
+            Fail("GenerateModelFeatureCombinationUpdate");
+         }
+      });
+
+      // the update that GenerateModelFeatureCombinationUpdate returns is only valid until the next call, so keep a copy to apply over and over.  Applying
+      // the same small update repeatedly just keeps walking the model in one direction, which costs the same as applying fresh updates
+      FractionalDataType gain;
+      const FractionalDataType * const aUpdate = GenerateModelFeatureCombinationUpdate(pEbmTraining, indexFeatureCombination, k_learningRate, k_countTreeSplitsMax, k_countInstancesRequiredForParentSplitMin, nullptr, nullptr, &gain);
+      if(nullptr == aUpdate) {
+         Fail("GenerateModelFeatureCombinationUpdate");
+      }
+      size_t cUpdate = cVectorLength;
+      for(size_t iDimension = 0; iDimension < cDimensions; ++iDimension) {
+         cUpdate *= cBins;
+      }
+      const std::vector<FractionalDataType> update(aUpdate, aUpdate + cUpdate);
+
+      RunBenchmark(options, "ApplyModelFeatureCombinationUpdate", learningTypeOrCountTargetClasses, cBins, cDimensions, cTrainingInstances + cValidationInstances, [&]() {
+         FractionalDataType validationMetric;
+         if(0 != ApplyModelFeatureCombinationUpdate(pEbmTraining, indexFeatureCombination, &update[0], &validationMetric)) {
+            Fail("ApplyModelFeatureCombinationUpdate");
+         }
+      });
+
+      // the updates that SetValidationMetricInterval skips still move the validation scores, but don't compute the metric
+      if(0 != SetValidationMetricInterval(pEbmTraining, 0)) {
+         Fail("SetValidationMetricInterval");
+      }
+      RunBenchmark(options, "ApplyModelFeatureCombinationUpdateNoMetric", learningTypeOrCountTargetClasses, cBins, cDimensions, cTrainingInstances + cValidationInstances, [&]() {
+         FractionalDataType validationMetric;
+         if(0 != ApplyModelFeatureCombinationUpdate(pEbmTraining, indexFeatureCombination, &update[0], &validationMetric)) {
+            Fail("ApplyModelFeatureCombinationUpdate");
+         }
+      });
+      if(0 != SetValidationMetricInterval(pEbmTraining, 1)) {
+         Fail("SetValidationMetricInterval");
+      }
+   }
+
+   // one pass over every feature combination so that every model tensor has something in it before we predict with it
+   for(size_t iFeatureCombination = 0; iFeatureCombination < data.m_featureCombinations.size(); ++iFeatureCombination) {
+      FractionalDataType validationMetric;
+      if(0 != TrainingStep(pEbmTraining, static_cast<IntegerDataType>(iFeatureCombination), k_learningRate, k_countTreeSplitsMax, k_countInstancesRequiredForParentSplitMin, nullptr, nullptr, &validationMetric)) {
+         Fail("TrainingStep");
+      }
+   }
+
+   std::vector<const FractionalDataType *> modelFeatureCombinationTensors;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < data.m_featureCombinations.size(); ++iFeatureCombination) {
+      modelFeatureCombinationTensors.push_back(GetCurrentModelFeatureCombination(pEbmTraining, static_cast<IntegerDataType>(iFeatureCombination)));
+   }
+   std::vector<FractionalDataType> predictorScores(cTrainingInstances * cVectorLength);
+   RunBenchmark(options, "PredictBatch", learningTypeOrCountTargetClasses, cBins, 0, cTrainingInstances, [&]() {
+      std::fill(predictorScores.begin(), predictorScores.end(), FractionalDataType { 0 });
+      IntegerDataType ret;
+      if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+         ret = PredictBatchRegression(data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], &modelFeatureCombinationTensors[0], cTrainingInstances, &data.m_trainingBinnedData[0], &predictorScores[0]);
+      } else {
+         ret = PredictBatchClassification(data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], &modelFeatureCombinationTensors[0], learningTypeOrCountTargetClasses, cTrainingInstances, &data.m_trainingBinnedData[0], 1, &predictorScores[0]);
+      }
+      if(0 != ret) {
+         Fail("PredictBatch");
+      }
+   });
+
+   // the same prediction from raw values, plus binning them on their own.  A cut halfway between each pair of bins gives back our binned data
+   std::vector<FractionalDataType> cuts;
+   for(const EbmCoreFeature & feature : data.m_features) {
+      for(IntegerDataType iCut = 0; iCut < feature.countBins - 1; ++iCut) {
+         cuts.push_back(static_cast<FractionalDataType>(iCut) + FractionalDataType { 0.5 });
+      }
+   }
+   std::vector<FractionalDataType> values;
+   for(size_t iValue = 0; iValue < data.m_features.size() * cTrainingInstances; ++iValue) {
+      values.push_back(static_cast<FractionalDataType>(data.m_trainingBinnedData[iValue]));
+   }
+   RunBenchmark(options, "PredictBatchValues", learningTypeOrCountTargetClasses, cBins, 0, cTrainingInstances, [&]() {
+      std::fill(predictorScores.begin(), predictorScores.end(), FractionalDataType { 0 });
+      IntegerDataType ret;
+      if(k_learningTypeRegression == learningTypeOrCountTargetClasses) {
+         ret = PredictBatchRegressionValues(data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], &modelFeatureCombinationTensors[0], cTrainingInstances, &cuts[0], &values[0], &predictorScores[0]);
+      } else {
+         ret = PredictBatchClassificationValues(data.m_features.size(), &data.m_features[0], data.m_featureCombinations.size(), &data.m_featureCombinations[0], &data.m_featureCombinationIndexes[0], &modelFeatureCombinationTensors[0], learningTypeOrCountTargetClasses, cTrainingInstances, &cuts[0], &values[0], 1, &predictorScores[0]);
+      }
+      if(0 != ret) {
+         Fail("PredictBatchValues");
+      }
+   });
+   std::vector<IntegerDataType> binnedData(values.size());
+   RunBenchmark(options, "BinFeatureValues", learningTypeOrCountTargetClasses, cBins, 0, cTrainingInstances, [&]() {
+      if(0 != BinFeatureValues(data.m_features.size(), &data.m_features[0], &cuts[0], cTrainingInstances, &values[0], &binnedData[0])) {
+         Fail("BinFeatureValues");
+      }
+   });
+
+   FreeTraining(pEbmTraining);
+}
+
+static void BenchmarkInteraction(const BenchmarkOptions & options, const SyntheticData & data, const IntegerDataType learningTypeOrCountTargetClasses, const size_t cBins, const size_t cInstances) {
+   RunBenchmark(options, "InitializeInteraction", learningTypeOrCountTargetClasses, cBins, 0, cInstances, [&]() {
+      FreeInteraction(InitializeInteraction(data, learningTypeOrCountTargetClasses, cInstances));
+   });
+
+   PEbmInteraction pEbmInteraction = InitializeInteraction(data, learningTypeOrCountTargetClasses, cInstances);
+
+   const std::vector<IntegerDataType> pair = { 0, 1 };
+   RunBenchmark(options, "GetInteractionScore", learningTypeOrCountTargetClasses, cBins, pair.size(), cInstances, [&]() {
+      FractionalDataType interactionScore;
+      if(0 != GetInteractionScore(pEbmInteraction, pair.size(), &pair[0], &interactionScore)) {
+         Fail("GetInteractionScore");
+      }
+   });
+
+   // the core only sweeps pairs, so for triples this times the triple binning kernel and the totals that come before the sweep
+   if(cBins * cBins * cBins <= k_cTripleBucketsMax) {
+      const std::vector<IntegerDataType> triple = { 0, 1, 2 };
+      RunBenchmark(options, "GetInteractionScore", learningTypeOrCountTargetClasses, cBins, triple.size(), cInstances, [&]() {
+         FractionalDataType interactionScore;
+         if(0 != GetInteractionScore(pEbmInteraction, triple.size(), &triple[0], &interactionScore)) {
+            Fail("GetInteractionScore");
+         }
+      });
+   }
+
+   FreeInteraction(pEbmInteraction);
+}
+
+int main(int argc, char ** argv) {
+   BenchmarkOptions options;
+   options.m_cInstances = 100000;
+   options.m_secondsMin = 0.25;
+   options.m_filter = nullptr;
+
+   for(int iArg = 1; iArg < argc; ++iArg) {
+      if(0 == strcmp(argv[iArg], "-instances") && iArg + 1 < argc) {
+         ++iArg;
+         options.m_cInstances = static_cast<size_t>(strtoull(argv[iArg], nullptr, 10));
+      } else if(0 == strcmp(argv[iArg], "-seconds") && iArg + 1 < argc) {
+         ++iArg;
+         options.m_secondsMin = strtod(argv[iArg], nullptr);
+      } else if(0 == strcmp(argv[iArg], "-filter") && iArg + 1 < argc) {
+         ++iArg;
+         options.m_filter = argv[iArg];
+      } else {
+         fprintf(stderr, "usage: %s [-instances N] [-seconds S] [-filter TEXT]\n", argv[0]);
+         return 1;
+      }
+   }
+   if(options.m_cInstances < 4) {
+      fprintf(stderr, "-instances needs to be at least 4\n");
+      return 1;
+   }
+
+   const size_t cTrainingInstances = options.m_cInstances;
+   const size_t cValidationInstances = cTrainingInstances / 4;
+
+   // 16 classes is past k_cCompilerOptimizedTargetClassesMax, so it measures the runtime vector length code
+   const IntegerDataType aLearningTypeOrCountTargetClasses[] = { k_learningTypeRegression, 2, 3, 16 };
+   const size_t aBins[] = { 16, 256 };
+   for(const IntegerDataType learningTypeOrCountTargetClasses : aLearningTypeOrCountTargetClasses) {
+      for(const size_t cBins : aBins) {
+         fprintf(stderr, "generating %s data with %lld classes and %zu bins\n", GetLearningTypeName(learningTypeOrCountTargetClasses), static_cast<long long>(learningTypeOrCountTargetClasses), cBins);
+         const SyntheticData data(learningTypeOrCountTargetClasses, cBins, cTrainingInstances, cValidationInstances);
+         BenchmarkTraining(options, data, learningTypeOrCountTargetClasses, cBins, cTrainingInstances, cValidationInstances);
+         BenchmarkInteraction(options, data, learningTypeOrCountTargetClasses, cBins, cTrainingInstances);
+      }
+   }
+   return 0;
+}
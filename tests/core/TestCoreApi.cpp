@@ -22,10 +22,12 @@
 #include <algorithm>
 #include <cmath>
 #include <cstddef>
+#include <limits>
 #include <assert.h>
 #include <string.h>
 
 #include "ebmcore.h"
+#include "MulticlassExp.h"
 
 #define UNUSED(x) (void)(x)
 
@@ -92,9 +94,7 @@ inline bool IsApproxEqual(const double value, const double expected, const doubl
 // EBM/interpret specific stuff below here!!
 
 constexpr ptrdiff_t k_learningTypeRegression = ptrdiff_t { -1 };
-constexpr bool IsClassification(const ptrdiff_t learningTypeOrCountTargetClasses) {
-   return 0 <= learningTypeOrCountTargetClasses;
-}
+// IsClassification comes from EbmInternal.h, which we get through MulticlassExp.h
 
 constexpr size_t GetVectorLength(const ptrdiff_t learningTypeOrCountTargetClasses) {
 #ifdef EXPAND_BINARY_LOGITS
@@ -709,7 +709,7 @@ public:
       m_stage = Stage::ValidationAdded;
    }
 
-   void InitializeTraining(const IntegerDataType countInnerBags = k_countInnerBagsDefault) {
+   void InitializeTraining(const IntegerDataType countInnerBags = k_countInnerBagsDefault, const IntegerDataType trainingOptions = TrainingOptionsNone) {
       if(Stage::ValidationAdded != m_stage) {
          exit(1);
       }
@@ -718,12 +718,128 @@ public:
       }
 
       if(IsClassification(m_learningTypeOrCountTargetClasses)) {
-         m_pEbmTraining = InitializeTrainingClassification(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, m_trainingClassificationTargets.size(), 0 == m_trainingClassificationTargets.size() ? nullptr : &m_trainingClassificationTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationClassificationTargets.size(), 0 == m_validationClassificationTargets.size() ? nullptr : &m_validationClassificationTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
+         m_pEbmTraining = InitializeTrainingClassificationWithOptions(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, m_trainingClassificationTargets.size(), 0 == m_trainingClassificationTargets.size() ? nullptr : &m_trainingClassificationTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationClassificationTargets.size(), 0 == m_validationClassificationTargets.size() ? nullptr : &m_validationClassificationTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags, trainingOptions);
+      } else if(k_learningTypeRegression == m_learningTypeOrCountTargetClasses) {
+         m_pEbmTraining = InitializeTrainingRegressionWithOptions(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_trainingRegressionTargets.size(), 0 == m_trainingRegressionTargets.size() ? nullptr : &m_trainingRegressionTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationRegressionTargets.size(), 0 == m_validationRegressionTargets.size() ? nullptr : &m_validationRegressionTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags, trainingOptions);
+      } else {
+         exit(1);
+      }
+
+      if(nullptr == m_pEbmTraining) {
+         exit(1);
+      }
+      m_stage = Stage::InitializedTraining;
+   }
+
+   PEbmTrainingDataSet InitializeTrainingDataSet() const {
+      if(Stage::ValidationAdded != m_stage) {
+         exit(1);
+      }
+
+      PEbmTrainingDataSet pEbmTrainingDataSet;
+      if(IsClassification(m_learningTypeOrCountTargetClasses)) {
+         pEbmTrainingDataSet = InitializeTrainingDataSetClassification(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, m_trainingClassificationTargets.size(), 0 == m_trainingClassificationTargets.size() ? nullptr : &m_trainingClassificationTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_validationClassificationTargets.size(), 0 == m_validationClassificationTargets.size() ? nullptr : &m_validationClassificationTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0]);
+      } else if(k_learningTypeRegression == m_learningTypeOrCountTargetClasses) {
+         pEbmTrainingDataSet = InitializeTrainingDataSetRegression(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_trainingRegressionTargets.size(), 0 == m_trainingRegressionTargets.size() ? nullptr : &m_trainingRegressionTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_validationRegressionTargets.size(), 0 == m_validationRegressionTargets.size() ? nullptr : &m_validationRegressionTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0]);
+      } else {
+         exit(1);
+      }
+
+      if(nullptr == pEbmTrainingDataSet) {
+         exit(1);
+      }
+      return pEbmTrainingDataSet;
+   }
+
+   // with bRawValues we append raw values that BinFeatureValues cuts into the same bins.  Every other instance sits exactly on its bin's lower cut
+   PEbmTrainingDataSet InitializeTrainingDataSetInChunks(const size_t cInstancesPerChunk, const bool bRawValues = false) const {
+      if(Stage::ValidationAdded != m_stage) {
+         exit(1);
+      }
+      if(0 == cInstancesPerChunk) {
+         exit(1);
+      }
+
+      const bool bClassification = IsClassification(m_learningTypeOrCountTargetClasses);
+      const size_t cTrainingInstances = bClassification ? m_trainingClassificationTargets.size() : m_trainingRegressionTargets.size();
+      const size_t cValidationInstances = bClassification ? m_validationClassificationTargets.size() : m_validationRegressionTargets.size();
+
+      PEbmTrainingDataSetBuilder pEbmTrainingDataSetBuilder;
+      if(bClassification) {
+         pEbmTrainingDataSetBuilder = CreateTrainingDataSetBuilderClassification(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_learningTypeOrCountTargetClasses, cTrainingInstances, cValidationInstances);
       } else if(k_learningTypeRegression == m_learningTypeOrCountTargetClasses) {
-         m_pEbmTraining = InitializeTrainingRegression(randomSeed, m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], m_trainingRegressionTargets.size(), 0 == m_trainingRegressionTargets.size() ? nullptr : &m_trainingRegressionTargets[0], 0 == m_trainingBinnedData.size() ? nullptr : &m_trainingBinnedData[0], m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_validationRegressionTargets.size(), 0 == m_validationRegressionTargets.size() ? nullptr : &m_validationRegressionTargets[0], 0 == m_validationBinnedData.size() ? nullptr : &m_validationBinnedData[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags);
+         pEbmTrainingDataSetBuilder = CreateTrainingDataSetBuilderRegression(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], cTrainingInstances, cValidationInstances);
       } else {
          exit(1);
       }
+      if(nullptr == pEbmTrainingDataSetBuilder) {
+         exit(1);
+      }
+
+      // alternate between training and validation chunks to check that each set keeps its own position
+      const size_t cFeatures = m_features.size();
+      const std::vector<FractionalDataType> cuts = GetCutsBetweenBins();
+      size_t iTraining = 0;
+      size_t iValidation = 0;
+      while(iTraining < cTrainingInstances || iValidation < cValidationInstances) {
+         for(int iSet = 0; iSet < 2; ++iSet) {
+            const bool bValidation = 0 != iSet;
+            const size_t cInstances = bValidation ? cValidationInstances : cTrainingInstances;
+            size_t & iInstanceStart = bValidation ? iValidation : iTraining;
+            const size_t cChunk = std::min(cInstancesPerChunk, cInstances - iInstanceStart);
+            if(0 == cChunk) {
+               continue;
+            }
+            const std::vector<IntegerDataType> & binnedData = bValidation ? m_validationBinnedData : m_trainingBinnedData;
+            std::vector<IntegerDataType> chunkBinnedData;
+            for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+               for(size_t iInstance = iInstanceStart; iInstance < iInstanceStart + cChunk; ++iInstance) {
+                  chunkBinnedData.push_back(binnedData[iFeature * cInstances + iInstance]);
+               }
+            }
+            std::vector<FractionalDataType> chunkValues;
+            for(size_t iValue = 0; iValue < chunkBinnedData.size(); ++iValue) {
+               chunkValues.push_back(static_cast<FractionalDataType>(chunkBinnedData[iValue]) - (0 == iValue % 2 ? FractionalDataType { 0.5 } : FractionalDataType { -0.25 }));
+            }
+            IntegerDataType ret;
+            if(bClassification) {
+               const std::vector<IntegerDataType> & targets = bValidation ? m_validationClassificationTargets : m_trainingClassificationTargets;
+               if(bRawValues) {
+                  ret = AppendTrainingDataSetBuilderClassificationValues(pEbmTrainingDataSetBuilder, bValidation ? 1 : 0, cChunk, &targets[iInstanceStart], 0 == cuts.size() ? nullptr : &cuts[0], 0 == chunkValues.size() ? nullptr : &chunkValues[0]);
+               } else {
+                  ret = AppendTrainingDataSetBuilderClassification(pEbmTrainingDataSetBuilder, bValidation ? 1 : 0, cChunk, &targets[iInstanceStart], 0 == chunkBinnedData.size() ? nullptr : &chunkBinnedData[0]);
+               }
+            } else {
+               const std::vector<FractionalDataType> & targets = bValidation ? m_validationRegressionTargets : m_trainingRegressionTargets;
+               if(bRawValues) {
+                  ret = AppendTrainingDataSetBuilderRegressionValues(pEbmTrainingDataSetBuilder, bValidation ? 1 : 0, cChunk, &targets[iInstanceStart], 0 == cuts.size() ? nullptr : &cuts[0], 0 == chunkValues.size() ? nullptr : &chunkValues[0]);
+               } else {
+                  ret = AppendTrainingDataSetBuilderRegression(pEbmTrainingDataSetBuilder, bValidation ? 1 : 0, cChunk, &targets[iInstanceStart], 0 == chunkBinnedData.size() ? nullptr : &chunkBinnedData[0]);
+               }
+            }
+            if(0 != ret) {
+               exit(1);
+            }
+            iInstanceStart += cChunk;
+         }
+      }
+
+      const PEbmTrainingDataSet pEbmTrainingDataSet = FinishTrainingDataSetBuilder(pEbmTrainingDataSetBuilder);
+      if(nullptr == pEbmTrainingDataSet) {
+         exit(1);
+      }
+      return pEbmTrainingDataSet;
+   }
+
+   void InitializeTrainingFromDataSet(const PEbmTrainingDataSet ebmTrainingDataSet, const IntegerDataType countInnerBags = k_countInnerBagsDefault, const IntegerDataType trainingOptions = TrainingOptionsNone) {
+      if(Stage::ValidationAdded != m_stage) {
+         exit(1);
+      }
+      if(countInnerBags < IntegerDataType { 0 }) {
+         exit(1);
+      }
+
+      m_pEbmTraining = ::InitializeTrainingFromDataSet(ebmTrainingDataSet, randomSeed, m_bNullTrainingPredictionScores ? nullptr : &m_trainingPredictionScores[0], m_bNullValidationPredictionScores ? nullptr : &m_validationPredictionScores[0], countInnerBags, trainingOptions);
 
       if(nullptr == m_pEbmTraining) {
          exit(1);
@@ -731,6 +847,10 @@ public:
       m_stage = Stage::InitializedTraining;
    }
 
+   const std::vector<FractionalDataType> & GetTrainingPredictionScores() const {
+      return m_trainingPredictionScores;
+   }
+
    FractionalDataType Train(const IntegerDataType indexFeatureCombination, const std::vector<FractionalDataType> trainingWeights = {}, const std::vector<FractionalDataType> validationWeights = {}, const FractionalDataType learningRate = k_learningRateDefault, const IntegerDataType countTreeSplitsMax = k_countTreeSplitsMaxDefault, const IntegerDataType countInstancesRequiredForParentSplitMin = k_countInstancesRequiredForParentSplitMinDefault) {
       if(Stage::InitializedTraining != m_stage) {
          exit(1);
@@ -762,6 +882,147 @@ public:
       return validationMetricReturn;
    }
 
+   IntegerDataType SampleWithoutReplacement(const FractionalDataType subsampleFraction) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      return SampleTrainingWithoutReplacement(m_pEbmTraining, randomSeed, subsampleFraction);
+   }
+
+   IntegerDataType SetWeights(const std::vector<FractionalDataType> trainingWeights, const std::vector<FractionalDataType> validationWeights) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      return SetInstanceWeights(m_pEbmTraining, 0 == trainingWeights.size() ? nullptr : &trainingWeights[0], 0 == validationWeights.size() ? nullptr : &validationWeights[0]);
+   }
+
+   IntegerDataType SetMetricInterval(const IntegerDataType countUpdatesPerValidationMetric) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      return SetValidationMetricInterval(m_pEbmTraining, countUpdatesPerValidationMetric);
+   }
+
+   FractionalDataType ApplyUpdate(const IntegerDataType indexFeatureCombination, const std::vector<FractionalDataType> modelUpdate) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(indexFeatureCombination < IntegerDataType { 0 } || m_featureCombinations.size() <= static_cast<size_t>(indexFeatureCombination)) {
+         exit(1);
+      }
+      if(0 == modelUpdate.size()) {
+         exit(1);
+      }
+      FractionalDataType validationMetricReturn = FractionalDataType { 0 };
+      const IntegerDataType ret = ApplyModelFeatureCombinationUpdate(m_pEbmTraining, indexFeatureCombination, &modelUpdate[0], &validationMetricReturn);
+      if(0 != ret) {
+         exit(1);
+      }
+      return validationMetricReturn;
+   }
+
+   FractionalDataType TrainRounds(const std::vector<IntegerDataType> featureCombinationIndexes, const IntegerDataType countRoundsMax, const IntegerDataType earlyStoppingRunLength, const FractionalDataType earlyStoppingTolerance, IntegerDataType * const pCountRoundsReturn, FractionalDataType * const pValidationMetricBestReturn = nullptr) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      for(const IntegerDataType indexFeatureCombination : featureCombinationIndexes) {
+         if(indexFeatureCombination < IntegerDataType { 0 } || m_featureCombinations.size() <= static_cast<size_t>(indexFeatureCombination)) {
+            exit(1);
+         }
+      }
+      FractionalDataType validationMetricReturn = FractionalDataType { 0 };
+      const IntegerDataType ret = TrainingRounds(m_pEbmTraining, static_cast<IntegerDataType>(featureCombinationIndexes.size()), 0 == featureCombinationIndexes.size() ? nullptr : &featureCombinationIndexes[0], countRoundsMax, 1, k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, earlyStoppingRunLength, earlyStoppingTolerance, &validationMetricReturn, pValidationMetricBestReturn, pCountRoundsReturn);
+      if(0 != ret) {
+         exit(1);
+      }
+      return validationMetricReturn;
+   }
+
+   FractionalDataType GenerateUpdateWithWorkspace(const size_t iFeatureCombination, std::vector<FractionalDataType> & modelUpdateOut, const FractionalDataType learningRate = k_learningRateDefault, const IntegerDataType countTreeSplitsMax = k_countTreeSplitsMaxDefault, const IntegerDataType countInstancesRequiredForParentSplitMin = k_countInstancesRequiredForParentSplitMinDefault) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(m_countBinsByFeatureCombination.size() <= iFeatureCombination) {
+         exit(1);
+      }
+      size_t cValues = GetVectorLength(m_learningTypeOrCountTargetClasses);
+      for(const size_t countBins : m_countBinsByFeatureCombination[iFeatureCombination]) {
+         cValues *= countBins;
+      }
+      modelUpdateOut.resize(cValues);
+
+      const PEbmTrainingWorkspace ebmTrainingWorkspace = AllocateTrainingWorkspace(m_pEbmTraining);
+      if(nullptr == ebmTrainingWorkspace) {
+         exit(1);
+      }
+      FractionalDataType gain = FractionalDataType { 0 };
+      const IntegerDataType ret = GenerateModelFeatureCombinationUpdateWithWorkspace(m_pEbmTraining, ebmTrainingWorkspace, static_cast<IntegerDataType>(iFeatureCombination), learningRate, countTreeSplitsMax, countInstancesRequiredForParentSplitMin, nullptr, nullptr, 0 == cValues ? nullptr : &modelUpdateOut[0], &gain);
+      FreeTrainingWorkspace(ebmTrainingWorkspace);
+      if(0 != ret) {
+         exit(1);
+      }
+      return gain;
+   }
+
+   std::vector<FractionalDataType> BuildHistograms(const size_t iFeatureCombination) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(m_featureCombinations.size() <= iFeatureCombination) {
+         exit(1);
+      }
+      IntegerDataType countHistogramValues = 0;
+      if(0 != GetModelFeatureCombinationHistogramsLength(m_pEbmTraining, static_cast<IntegerDataType>(iFeatureCombination), &countHistogramValues)) {
+         exit(1);
+      }
+      std::vector<FractionalDataType> histograms(static_cast<size_t>(countHistogramValues));
+      if(0 != BuildModelFeatureCombinationHistograms(m_pEbmTraining, static_cast<IntegerDataType>(iFeatureCombination), &histograms[0])) {
+         exit(1);
+      }
+      return histograms;
+   }
+
+   std::vector<FractionalDataType> GenerateUpdateFromHistograms(const size_t iFeatureCombination, const std::vector<FractionalDataType> & histograms) {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(m_countBinsByFeatureCombination.size() <= iFeatureCombination) {
+         exit(1);
+      }
+      size_t cValues = GetVectorLength(m_learningTypeOrCountTargetClasses);
+      for(const size_t countBins : m_countBinsByFeatureCombination[iFeatureCombination]) {
+         cValues *= countBins;
+      }
+      const FractionalDataType * const aModelUpdate = GenerateModelFeatureCombinationUpdateFromHistograms(m_pEbmTraining, static_cast<IntegerDataType>(iFeatureCombination), k_learningRateDefault, k_countTreeSplitsMaxDefault, k_countInstancesRequiredForParentSplitMinDefault, &histograms[0], nullptr);
+      if(nullptr == aModelUpdate) {
+         exit(1);
+      }
+      return std::vector<FractionalDataType>(aModelUpdate, aModelUpdate + cValues);
+   }
+
+   IntegerDataType GetStatisticsTraining(const IntegerDataType countStatistics, IntegerDataType * const statisticsOut) const {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      return GetTrainingStatistics(m_pEbmTraining, countStatistics, statisticsOut);
+   }
+
+   // the caller owns the returned interaction and needs to free it before we free our training state
+   PEbmInteraction InitializeInteractionFromTraining() const {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      return ::InitializeInteractionFromTraining(m_pEbmTraining);
+   }
+
+   std::vector<IntegerDataType> GetStatisticsTraining() const {
+      std::vector<IntegerDataType> statistics(static_cast<size_t>(StatisticsCount));
+      if(0 != GetStatisticsTraining(StatisticsCount, &statistics[0])) {
+         exit(1);
+      }
+      return statistics;
+   }
+
    FractionalDataType GetCurrentModelPredictorScore(const size_t iFeatureCombination, const std::vector<size_t> perDimensionIndexArrayForBinnedFeatures, const size_t iTargetClassOrZero) const {
       if(Stage::InitializedTraining != m_stage) {
          exit(1);
@@ -808,6 +1069,100 @@ public:
       return pModel;
    }
 
+   // the cuts of every feature concatenated, with one cut halfway between each pair of neighbouring bins so that a value of iBin falls into bin iBin
+   std::vector<FractionalDataType> GetCutsBetweenBins() const {
+      std::vector<FractionalDataType> cuts;
+      for(const EbmCoreFeature & feature : m_features) {
+         for(IntegerDataType iCut = 0; iCut < feature.countBins - 1; ++iCut) {
+            cuts.push_back(static_cast<FractionalDataType>(iCut) + FractionalDataType { 0.5 });
+         }
+      }
+      return cuts;
+   }
+
+   // valuesPerInstance holds raw values that GetCutsBetweenBins cuts into bins
+   IntegerDataType PredictBatchCurrentModelValues(const std::vector<std::vector<FractionalDataType>> valuesPerInstance, const bool bProbabilities, std::vector<FractionalDataType> & predictorScores) const {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      const size_t cFeatures = m_features.size();
+      const size_t cInstances = valuesPerInstance.size();
+      std::vector<FractionalDataType> values(cFeatures * cInstances);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         if(cFeatures != valuesPerInstance[iInstance].size()) {
+            exit(1);
+         }
+         for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+            values[iFeature * cInstances + iInstance] = valuesPerInstance[iInstance][iFeature];
+         }
+      }
+      const std::vector<FractionalDataType> cuts = GetCutsBetweenBins();
+      std::vector<const FractionalDataType *> modelFeatureCombinationTensors;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < m_featureCombinations.size(); ++iFeatureCombination) {
+         modelFeatureCombinationTensors.push_back(GetCurrentModelFeatureCombination(m_pEbmTraining, iFeatureCombination));
+      }
+      predictorScores.assign(cInstances * GetVectorLength(m_learningTypeOrCountTargetClasses), FractionalDataType { 0 });
+      if(IsClassification(m_learningTypeOrCountTargetClasses)) {
+         return PredictBatchClassificationValues(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], m_learningTypeOrCountTargetClasses, cInstances, 0 == cuts.size() ? nullptr : &cuts[0], 0 == values.size() ? nullptr : &values[0], bProbabilities ? 1 : 0, 0 == predictorScores.size() ? nullptr : &predictorScores[0]);
+      } else {
+         if(bProbabilities) {
+            exit(1);
+         }
+         return PredictBatchRegressionValues(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], cInstances, 0 == cuts.size() ? nullptr : &cuts[0], 0 == values.size() ? nullptr : &values[0], 0 == predictorScores.size() ? nullptr : &predictorScores[0]);
+      }
+   }
+
+   // the model file has the cuts from GetCutsBetweenBins, so PredictModel takes the same raw values as PredictBatchCurrentModelValues
+   IntegerDataType SaveCurrentModel(const char * const filePath, const std::vector<FractionalDataType> & intercept) const {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      if(GetVectorLength(m_learningTypeOrCountTargetClasses) != intercept.size()) {
+         exit(1);
+      }
+      const size_t cFeatures = m_features.size();
+      const std::vector<FractionalDataType> cuts = GetCutsBetweenBins();
+      std::vector<const FractionalDataType *> modelFeatureCombinationTensors;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < m_featureCombinations.size(); ++iFeatureCombination) {
+         modelFeatureCombinationTensors.push_back(GetCurrentModelFeatureCombination(m_pEbmTraining, iFeatureCombination));
+      }
+      if(IsClassification(m_learningTypeOrCountTargetClasses)) {
+         return SaveModelClassification(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], m_learningTypeOrCountTargetClasses, 0 == cuts.size() ? nullptr : &cuts[0], &intercept[0], filePath);
+      } else {
+         return SaveModelRegression(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], 0 == cuts.size() ? nullptr : &cuts[0], &intercept[0], filePath);
+      }
+   }
+
+   IntegerDataType PredictBatchCurrentModel(const std::vector<std::vector<IntegerDataType>> binnedDataPerInstance, const bool bProbabilities, std::vector<FractionalDataType> & predictorScores) const {
+      if(Stage::InitializedTraining != m_stage) {
+         exit(1);
+      }
+      const size_t cFeatures = m_features.size();
+      const size_t cInstances = binnedDataPerInstance.size();
+      std::vector<IntegerDataType> binnedData(cFeatures * cInstances);
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         if(cFeatures != binnedDataPerInstance[iInstance].size()) {
+            exit(1);
+         }
+         for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+            binnedData[iFeature * cInstances + iInstance] = binnedDataPerInstance[iInstance][iFeature];
+         }
+      }
+      std::vector<const FractionalDataType *> modelFeatureCombinationTensors;
+      for(size_t iFeatureCombination = 0; iFeatureCombination < m_featureCombinations.size(); ++iFeatureCombination) {
+         modelFeatureCombinationTensors.push_back(GetCurrentModelFeatureCombination(m_pEbmTraining, iFeatureCombination));
+      }
+      predictorScores.assign(cInstances * GetVectorLength(m_learningTypeOrCountTargetClasses), FractionalDataType { 0 });
+      if(IsClassification(m_learningTypeOrCountTargetClasses)) {
+         return PredictBatchClassification(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], m_learningTypeOrCountTargetClasses, cInstances, 0 == binnedData.size() ? nullptr : &binnedData[0], bProbabilities ? 1 : 0, 0 == predictorScores.size() ? nullptr : &predictorScores[0]);
+      } else {
+         if(bProbabilities) {
+            exit(1);
+         }
+         return PredictBatchRegression(cFeatures, 0 == cFeatures ? nullptr : &m_features[0], m_featureCombinations.size(), 0 == m_featureCombinations.size() ? nullptr : &m_featureCombinations[0], 0 == m_featureCombinationIndexes.size() ? nullptr : &m_featureCombinationIndexes[0], 0 == modelFeatureCombinationTensors.size() ? nullptr : &modelFeatureCombinationTensors[0], cInstances, 0 == binnedData.size() ? nullptr : &binnedData[0], 0 == predictorScores.size() ? nullptr : &predictorScores[0]);
+      }
+   }
+
    void AddInteractionInstances(const std::vector<RegressionInstance> instances) {
       if(Stage::FeaturesAdded != m_stage) {
          exit(1);
@@ -964,15 +1319,15 @@ public:
       m_stage = Stage::InteractionAdded;
    }
 
-   void InitializeInteraction() {
+   void InitializeInteraction(const IntegerDataType interactionOptions = InteractionOptionsNone) {
       if(Stage::InteractionAdded != m_stage) {
          exit(1);
       }
 
       if(IsClassification(m_learningTypeOrCountTargetClasses)) {
-         m_pEbmInteraction = InitializeInteractionClassification(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_learningTypeOrCountTargetClasses, m_interactionClassificationTargets.size(), 0 == m_interactionClassificationTargets.size() ? nullptr : &m_interactionClassificationTargets[0], 0 == m_interactionBinnedData.size() ? nullptr : &m_interactionBinnedData[0], m_bNullInteractionPredictionScores ? nullptr : &m_interactionPredictionScores[0]);
+         m_pEbmInteraction = InitializeInteractionClassificationWithOptions(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_learningTypeOrCountTargetClasses, m_interactionClassificationTargets.size(), 0 == m_interactionClassificationTargets.size() ? nullptr : &m_interactionClassificationTargets[0], 0 == m_interactionBinnedData.size() ? nullptr : &m_interactionBinnedData[0], m_bNullInteractionPredictionScores ? nullptr : &m_interactionPredictionScores[0], interactionOptions);
       } else if(k_learningTypeRegression == m_learningTypeOrCountTargetClasses) {
-         m_pEbmInteraction = InitializeInteractionRegression(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_interactionRegressionTargets.size(), 0 == m_interactionRegressionTargets.size() ? nullptr : &m_interactionRegressionTargets[0], 0 == m_interactionBinnedData.size() ? nullptr : &m_interactionBinnedData[0], m_bNullInteractionPredictionScores ? nullptr : &m_interactionPredictionScores[0]);
+         m_pEbmInteraction = InitializeInteractionRegressionWithOptions(m_features.size(), 0 == m_features.size() ? nullptr : &m_features[0], m_interactionRegressionTargets.size(), 0 == m_interactionRegressionTargets.size() ? nullptr : &m_interactionRegressionTargets[0], 0 == m_interactionBinnedData.size() ? nullptr : &m_interactionBinnedData[0], m_bNullInteractionPredictionScores ? nullptr : &m_interactionPredictionScores[0], interactionOptions);
       } else {
          exit(1);
       }
@@ -983,6 +1338,17 @@ public:
       m_stage = Stage::InitializedInteraction;
    }
 
+   std::vector<IntegerDataType> GetStatisticsInteraction() const {
+      if(Stage::InitializedInteraction != m_stage) {
+         exit(1);
+      }
+      std::vector<IntegerDataType> statistics(static_cast<size_t>(StatisticsCount));
+      if(0 != GetInteractionStatistics(m_pEbmInteraction, StatisticsCount, &statistics[0])) {
+         exit(1);
+      }
+      return statistics;
+   }
+
    FractionalDataType InteractionScore(const std::vector<IntegerDataType> featuresInCombination) const {
       if(Stage::InitializedInteraction != m_stage) {
          exit(1);
@@ -1003,8 +1369,52 @@ public:
       }
       return interactionScoreReturn;
    }
+
+   IntegerDataType InteractionScores(const std::vector<std::vector<IntegerDataType>> featureCombinations, const IntegerDataType countTopScores, std::vector<IntegerDataType> & featureCombinationIndexes, std::vector<FractionalDataType> & interactionScores) const {
+      if(Stage::InitializedInteraction != m_stage) {
+         exit(1);
+      }
+      std::vector<EbmCoreFeatureCombination> featureCombinationsInterop;
+      std::vector<IntegerDataType> featureIndexes;
+      for(const std::vector<IntegerDataType> & featureCombination : featureCombinations) {
+         EbmCoreFeatureCombination featureCombinationInterop;
+         featureCombinationInterop.countFeaturesInCombination = featureCombination.size();
+         featureCombinationsInterop.push_back(featureCombinationInterop);
+         for(const IntegerDataType oneFeatureIndex : featureCombination) {
+            if(oneFeatureIndex < IntegerDataType { 0 } || m_features.size() <= static_cast<size_t>(oneFeatureIndex)) {
+               exit(1);
+            }
+            featureIndexes.push_back(oneFeatureIndex);
+         }
+      }
+      const size_t cScores = countTopScores < IntegerDataType { 0 } ? featureCombinations.size() : std::min(static_cast<size_t>(countTopScores), featureCombinations.size());
+      featureCombinationIndexes.assign(cScores, IntegerDataType { -1 });
+      interactionScores.assign(cScores, FractionalDataType { -1 });
+      return GetInteractionScores(m_pEbmInteraction, featureCombinationsInterop.size(), 0 == featureCombinationsInterop.size() ? nullptr : &featureCombinationsInterop[0], 0 == featureIndexes.size() ? nullptr : &featureIndexes[0], countTopScores, 0 == featureCombinationIndexes.size() ? nullptr : &featureCombinationIndexes[0], 0 == interactionScores.size() ? nullptr : &interactionScores[0]);
+   }
 };
 
+// the 3 class instances that many of our multiclass tests train on.  The targets cycle differently than the bins of the first two features, which have
+// 4 and 3 bins, so every bin sees a mix of classes.  pExtraBins returns the bins of any more features, and priorScores, if given, are every instance's
+// prior scores
+static std::vector<ClassificationInstance> GenerateThreeClassInstances(const size_t cInstances, std::vector<IntegerDataType> (* const pExtraBins)(size_t) = nullptr, const std::vector<FractionalDataType> & priorScores = {}) {
+   std::vector<ClassificationInstance> instances;
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      std::vector<IntegerDataType> bins { static_cast<IntegerDataType>(iInstance % 4), static_cast<IntegerDataType>(iInstance / 5 % 3) };
+      if(nullptr != pExtraBins) {
+         const std::vector<IntegerDataType> extraBins = (*pExtraBins)(iInstance);
+         bins.insert(bins.end(), extraBins.begin(), extraBins.end());
+      }
+      const IntegerDataType target = static_cast<IntegerDataType>((iInstance % 3 + iInstance / 7) % 3);
+      if(priorScores.empty()) {
+         instances.push_back(ClassificationInstance(target, bins));
+      } else {
+         instances.push_back(ClassificationInstance(target, bins, priorScores));
+      }
+   }
+   return instances;
+}
+
 TEST_CASE("null validationMetricReturn, training, regression") {
    EbmCoreFeatureCombination combinations[1];
    combinations->countFeaturesInCombination = 0;
@@ -1295,6 +1705,1864 @@ TEST_CASE("zero countTreeSplitsMax, training, regression") {
 }
 
 
+TEST_CASE("many inner bags are deterministic, training, multiclass") {
+   // inner bags can be trained on separate threads, but the combined model update needs to be identical no matter how the work was scheduled
+   std::vector<FractionalDataType> validationMetrics[2];
+   std::vector<FractionalDataType> modelValues[2];
+   for(size_t iRun = 0; iRun < 2; ++iRun) {
+      TestApi test = TestApi(3);
+      test.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      test.AddFeatureCombinations({ { 0 }, { 0, 1 } });
+      test.AddTrainingInstances({
+         ClassificationInstance(0, { 0, 0 }),
+         ClassificationInstance(1, { 1, 2 }),
+         ClassificationInstance(2, { 2, 1 }),
+         ClassificationInstance(0, { 3, 0 }),
+         ClassificationInstance(1, { 0, 1 }),
+         ClassificationInstance(2, { 1, 0 }),
+         ClassificationInstance(2, { 3, 2 }),
+         ClassificationInstance(1, { 2, 2 }),
+         });
+      test.AddValidationInstances({ ClassificationInstance(1, { 1, 2 }), ClassificationInstance(2, { 3, 1 }) });
+      test.InitializeTraining(16);
+
+      for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+         for(size_t iFeatureCombination = 0; iFeatureCombination < test.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+            validationMetrics[iRun].push_back(test.Train(iFeatureCombination));
+         }
+      }
+      for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+         for(size_t iClass = 0; iClass < 3; ++iClass) {
+            modelValues[iRun].push_back(test.GetCurrentModelPredictorScore(0, { iBin0 }, iClass));
+            for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+               modelValues[iRun].push_back(test.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass));
+            }
+         }
+      }
+   }
+   CHECK(validationMetrics[0] == validationMetrics[1]);
+   CHECK(modelValues[0] == modelValues[1]);
+}
+
+TEST_CASE("thread budgets don't change results, training, multiclass") {
+   // every handle shares one set of worker threads, so the same model needs to come out whether we run serially, on a few threads, or on one thread
+   // per logical processor, and whether or not another handle is working at the same time
+   std::vector<ClassificationInstance> instances;
+   for(IntegerDataType iInstance = 0; iInstance < 200; ++iInstance) {
+      instances.push_back(ClassificationInstance((iInstance % 4 + iInstance / 4 % 3 + (0 == iInstance % 7 ? 1 : 0)) % 3, { iInstance % 4, iInstance / 4 % 3 }));
+   }
+   const IntegerDataType aCountThreads[] = { 1, 4, 0 };
+   std::vector<FractionalDataType> validationMetrics[3];
+   std::vector<FractionalDataType> interactionScores[3];
+   for(size_t iRun = 0; iRun < 3; ++iRun) {
+      CHECK(0 == ConfigureThreads(aCountThreads[iRun], 0, nullptr));
+      TestApi test0 = TestApi(3);
+      TestApi test1 = TestApi(3);
+      for(TestApi * pTest : { &test0, &test1 }) {
+         pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+         pTest->AddFeatureCombinations({ { 0 }, { 0, 1 } });
+         pTest->AddTrainingInstances(instances);
+         pTest->AddValidationInstances({ ClassificationInstance(1, { 1, 2 }), ClassificationInstance(2, { 3, 1 }) });
+         pTest->InitializeTraining(8);
+      }
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         for(size_t iFeatureCombination = 0; iFeatureCombination < test0.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+            validationMetrics[iRun].push_back(test0.Train(iFeatureCombination));
+            CHECK(validationMetrics[iRun].back() == test1.Train(iFeatureCombination));
+         }
+      }
+
+      TestApi testInteraction = TestApi(3);
+      testInteraction.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      testInteraction.AddInteractionInstances(instances);
+      testInteraction.InitializeInteraction();
+      std::vector<IntegerDataType> featureCombinationIndexes;
+      CHECK(0 == testInteraction.InteractionScores({ { 0, 1 }, { 1, 0 }, {} }, -1, featureCombinationIndexes, interactionScores[iRun]));
+   }
+   CHECK(0 == ConfigureThreads(0, 0, nullptr));
+   for(size_t iRun = 1; iRun < 3; ++iRun) {
+      CHECK(validationMetrics[0] == validationMetrics[iRun]);
+      CHECK(interactionScores[0] == interactionScores[iRun]);
+   }
+}
+
+TEST_CASE("ConfigureThreads rejects bad arguments, training") {
+   const IntegerDataType cpuIndexBad = -1;
+   CHECK(0 != ConfigureThreads(-1, 0, nullptr));
+   CHECK(0 != ConfigureThreads(2, -1, nullptr));
+   CHECK(0 != ConfigureThreads(2, 1, &cpuIndexBad));
+   CHECK(0 == ConfigureThreads(0, 0, nullptr));
+}
+
+#if defined(_WIN32) || defined(__linux__)
+TEST_CASE("pinned worker threads give the same results, training, regression") {
+   const IntegerDataType cpuIndex0 = 0;
+   FractionalDataType validationMetrics[2];
+   for(size_t iRun = 0; iRun < 2; ++iRun) {
+      CHECK(0 == ConfigureThreads(0 == iRun ? 0 : 3, 0 == iRun ? 0 : 1, 0 == iRun ? nullptr : &cpuIndex0));
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(2) });
+      test.AddFeatureCombinations({ { 0 } });
+      test.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }), RegressionInstance(15, { 1 }) });
+      test.AddValidationInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+      test.InitializeTraining(4);
+      validationMetrics[iRun] = test.Train(0);
+   }
+   CHECK(0 == ConfigureThreads(0, 0, nullptr));
+   CHECK(validationMetrics[0] == validationMetrics[1]);
+}
+#endif // defined(_WIN32) || defined(__linux__)
+
+TEST_CASE("workspace update matches TrainingStep, training, multiclass") {
+   TestApi test = TestApi(3);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   test.AddFeatureCombinations({ { 0 }, { 0, 1 } });
+   test.AddTrainingInstances({
+      ClassificationInstance(0, { 0, 0 }),
+      ClassificationInstance(1, { 1, 2 }),
+      ClassificationInstance(2, { 2, 1 }),
+      ClassificationInstance(0, { 3, 0 }),
+      ClassificationInstance(1, { 0, 1 }),
+      ClassificationInstance(2, { 1, 0 }),
+      });
+   test.AddValidationInstances({ ClassificationInstance(1, { 1, 2 }), ClassificationInstance(2, { 3, 1 }) });
+   test.InitializeTraining(4);
+
+   for(size_t iFeatureCombination = 0; iFeatureCombination < test.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+      // generating an update with a separate workspace must not modify the model, so the same update can be generated repeatedly
+      std::vector<FractionalDataType> modelUpdate0;
+      std::vector<FractionalDataType> modelUpdate1;
+      test.GenerateUpdateWithWorkspace(iFeatureCombination, modelUpdate0);
+      test.GenerateUpdateWithWorkspace(iFeatureCombination, modelUpdate1);
+      CHECK(modelUpdate0 == modelUpdate1);
+
+      // the model starts at zero, so after one TrainingStep it should contain exactly the update that we generated
+      test.Train(iFeatureCombination);
+      const FractionalDataType * const pModel = test.GetCurrentModelFeatureCombinationRaw(iFeatureCombination);
+      for(size_t iValue = 0; iValue < modelUpdate0.size(); ++iValue) {
+         CHECK(modelUpdate0[iValue] == pModel[iValue]);
+      }
+   }
+}
+
+TEST_CASE("updates from merged histograms of split training sets match training on all the instances, training, multiclass") {
+   // testAll trains on every instance, while test0 and test1 each hold half of them and train together by summing their histograms
+   TestApi testAll = TestApi(3);
+   TestApi test0 = TestApi(3);
+   TestApi test1 = TestApi(3);
+   const std::vector<ClassificationInstance> instances0 = {
+      ClassificationInstance(0, { 0, 0 }),
+      ClassificationInstance(1, { 1, 2 }),
+      ClassificationInstance(2, { 2, 1 }),
+      ClassificationInstance(0, { 3, 0 }),
+   };
+   const std::vector<ClassificationInstance> instances1 = {
+      ClassificationInstance(1, { 0, 1 }),
+      ClassificationInstance(2, { 1, 0 }),
+      ClassificationInstance(2, { 3, 2 }),
+   };
+   std::vector<ClassificationInstance> instancesAll = instances0;
+   for(const ClassificationInstance & instance : instances1) {
+      instancesAll.push_back(instance);
+   }
+   for(TestApi * pTest : { &testAll, &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 }, { 0, 1 } });
+   }
+   testAll.AddTrainingInstances(instancesAll);
+   test0.AddTrainingInstances(instances0);
+   test1.AddTrainingInstances(instances1);
+   for(TestApi * pTest : { &testAll, &test0, &test1 }) {
+      pTest->AddValidationInstances({ ClassificationInstance(1, { 1, 2 }), ClassificationInstance(2, { 3, 1 }) });
+      // without inner bags every process bins all of its instances, so the summed histograms are exactly the histograms of all the instances
+      pTest->InitializeTraining(0);
+   }
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(size_t iFeatureCombination = 0; iFeatureCombination < testAll.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+         std::vector<FractionalDataType> histograms = test0.BuildHistograms(iFeatureCombination);
+         const std::vector<FractionalDataType> histograms1 = test1.BuildHistograms(iFeatureCombination);
+         CHECK(histograms.size() == histograms1.size());
+         for(size_t iValue = 0; iValue < histograms.size(); ++iValue) {
+            histograms[iValue] += histograms1[iValue];
+         }
+         const std::vector<FractionalDataType> modelUpdate0 = test0.GenerateUpdateFromHistograms(iFeatureCombination, histograms);
+         const std::vector<FractionalDataType> modelUpdate1 = test1.GenerateUpdateFromHistograms(iFeatureCombination, histograms);
+         CHECK(modelUpdate0 == modelUpdate1);
+         test0.ApplyUpdate(static_cast<IntegerDataType>(iFeatureCombination), modelUpdate0);
+         test1.ApplyUpdate(static_cast<IntegerDataType>(iFeatureCombination), modelUpdate1);
+         testAll.Train(static_cast<IntegerDataType>(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         CHECK_APPROX(test0.GetCurrentModelPredictorScore(0, { iBin0 }, iClass), testAll.GetCurrentModelPredictorScore(0, { iBin0 }, iClass));
+         for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+            CHECK_APPROX(test0.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass), testAll.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("updates from merged histograms of split training sets match training on all the instances, training, regression") {
+   // boosting the same feature combination repeatedly checks that the merged histograms don't stay in the caches that hold each process's own
+   // histograms, since regression updates cached histograms in place when the update is applied
+   TestApi testAll = TestApi(k_learningTypeRegression);
+   TestApi test0 = TestApi(k_learningTypeRegression);
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &testAll, &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 } });
+   }
+   testAll.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(11, { 1 }), RegressionInstance(14, { 2 }), RegressionInstance(9, { 2 }), RegressionInstance(12, { 1 }) });
+   test0.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(11, { 1 }) });
+   test1.AddTrainingInstances({ RegressionInstance(14, { 2 }), RegressionInstance(9, { 2 }), RegressionInstance(12, { 1 }) });
+   for(TestApi * pTest : { &testAll, &test0, &test1 }) {
+      pTest->AddValidationInstances({ RegressionInstance(12, { 1 }) });
+      pTest->InitializeTraining(0);
+   }
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      std::vector<FractionalDataType> histograms = test0.BuildHistograms(0);
+      const std::vector<FractionalDataType> histograms1 = test1.BuildHistograms(0);
+      for(size_t iValue = 0; iValue < histograms.size(); ++iValue) {
+         histograms[iValue] += histograms1[iValue];
+      }
+      test0.ApplyUpdate(0, test0.GenerateUpdateFromHistograms(0, histograms));
+      test1.ApplyUpdate(0, test1.GenerateUpdateFromHistograms(0, histograms));
+      testAll.Train(0);
+   }
+   for(size_t iBin = 0; iBin < 3; ++iBin) {
+      CHECK_APPROX(test0.GetCurrentModelPredictorScore(0, { iBin }, 0), testAll.GetCurrentModelPredictorScore(0, { iBin }, 0));
+      CHECK_APPROX(test1.GetCurrentModelPredictorScore(0, { iBin }, 0), testAll.GetCurrentModelPredictorScore(0, { iBin }, 0));
+   }
+}
+
+TEST_CASE("cached histograms match rebinning, training, regression") {
+   // feature combinations 1 and 3 duplicate 0 and 2.  test0 trains each one twice in a row so the second step uses the histogram that was updated in
+   // place after the first, while test1 alternates between the duplicates so that every step bins the instances again
+   TestApi test0 = TestApi(k_learningTypeRegression);
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3), FeatureTest(2) });
+      pTest->AddFeatureCombinations({ { 0 }, { 0 }, { 0, 1 }, { 0, 1 } });
+      pTest->AddTrainingInstances({ RegressionInstance(10, { 0, 0 }), RegressionInstance(11, { 1, 1 }), RegressionInstance(14, { 2, 0 }), RegressionInstance(9, { 2, 1 }), RegressionInstance(12, { 1, 0 }) });
+      pTest->AddValidationInstances({ RegressionInstance(12, { 1, 0 }), RegressionInstance(10, { 2, 1 }) });
+      pTest->InitializeTraining(3);
+   }
+
+   FractionalDataType validationMetric0 = FractionalDataType { 0 };
+   FractionalDataType validationMetric1 = FractionalDataType { 0 };
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 2 }) {
+         validationMetric0 = test0.Train(iFeatureCombination);
+         validationMetric0 = test0.Train(iFeatureCombination);
+         validationMetric1 = test1.Train(iFeatureCombination);
+         validationMetric1 = test1.Train(iFeatureCombination + 1);
+      }
+   }
+   CHECK_APPROX(validationMetric0, validationMetric1);
+   for(size_t iBin0 = 0; iBin0 < 3; ++iBin0) {
+      CHECK_APPROX(test0.GetCurrentModelPredictorScore(0, { iBin0 }, 0), test1.GetCurrentModelPredictorScore(0, { iBin0 }, 0) + test1.GetCurrentModelPredictorScore(1, { iBin0 }, 0));
+      for(size_t iBin1 = 0; iBin1 < 2; ++iBin1) {
+         CHECK_APPROX(test0.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0), test1.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0) + test1.GetCurrentModelPredictorScore(3, { iBin0, iBin1 }, 0));
+      }
+   }
+}
+
+TEST_CASE("sampling without replacement of everything matches no bagging, training, multiclass") {
+   // a subsample of the whole training set selects every instance once, which is exactly what we train on without bagging
+   TestApi test0 = TestApi(3);
+   TestApi test1 = TestApi(3);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      pTest->AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+      const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(150);
+      pTest->AddTrainingInstances(trainingInstances);
+      pTest->AddValidationInstances({ ClassificationInstance(1, { 1, 2 }), ClassificationInstance(2, { 3, 1 }) });
+      pTest->InitializeTraining();
+   }
+   CHECK(0 == test1.SampleWithoutReplacement(1));
+
+   FractionalDataType validationMetric0 = FractionalDataType { 0 };
+   FractionalDataType validationMetric1 = FractionalDataType { 0 };
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 1, 2 }) {
+         validationMetric0 = test0.Train(iFeatureCombination);
+         validationMetric1 = test1.Train(iFeatureCombination);
+      }
+   }
+   CHECK(validationMetric0 == validationMetric1);
+   for(size_t iClass = 0; iClass < 3; ++iClass) {
+      for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+         CHECK(test0.GetCurrentModelPredictorScore(1, { iBin0 }, iClass) == test1.GetCurrentModelPredictorScore(1, { iBin0 }, iClass));
+         for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+            CHECK(test0.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass) == test1.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("sampling without replacement, training, regression") {
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(2) });
+   test.AddFeatureCombinations({ { 0 } });
+   std::vector<RegressionInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 200; ++iInstance) {
+      trainingInstances.push_back(RegressionInstance(0 == iInstance % 2 ? 10 : 20, { static_cast<IntegerDataType>(iInstance % 2) }));
+   }
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+   test.InitializeTraining(3);
+
+   CHECK(0 != test.SampleWithoutReplacement(0));
+   CHECK(0 != test.SampleWithoutReplacement(FractionalDataType { 1.5 }));
+   CHECK(0 != test.SampleWithoutReplacement(std::numeric_limits<FractionalDataType>::quiet_NaN()));
+   CHECK(0 == test.SampleWithoutReplacement(FractionalDataType { 0.3 }));
+
+   FractionalDataType validationMetric = FractionalDataType { 0 };
+   for(int iEpoch = 0; iEpoch < 1000; ++iEpoch) {
+      validationMetric = test.Train(0);
+   }
+   // every subsample has the same target in each bin, so we should converge on the targets
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 0 }, 0), 10);
+   CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { 1 }, 0), 20);
+   CHECK(validationMetric < 0.001);
+}
+
+TEST_CASE("instance weights of 2 match duplicated instances, training, regression") {
+   TestApi test0 = TestApi(k_learningTypeRegression);
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   std::vector<RegressionInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 60; ++iInstance) {
+      trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(iInstance % 7), { static_cast<IntegerDataType>(iInstance % 3), static_cast<IntegerDataType>(iInstance / 4 % 2) }));
+   }
+   const std::vector<RegressionInstance> validationInstances = { RegressionInstance(1, { 0, 1 }), RegressionInstance(5, { 2, 0 }), RegressionInstance(3, { 1, 1 }) };
+   std::vector<FractionalDataType> trainingWeights;
+   for(size_t iInstance = 0; iInstance < trainingInstances.size(); ++iInstance) {
+      trainingWeights.push_back(0 == iInstance % 2 ? FractionalDataType { 2 } : FractionalDataType { 1 });
+   }
+   std::vector<RegressionInstance> trainingInstancesDuplicated = trainingInstances;
+   for(size_t iInstance = 0; iInstance < trainingInstances.size(); iInstance += 2) {
+      trainingInstancesDuplicated.push_back(trainingInstances[iInstance]);
+   }
+   std::vector<RegressionInstance> validationInstancesDuplicated = validationInstances;
+   validationInstancesDuplicated.push_back(validationInstances[1]);
+
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3), FeatureTest(2) });
+      pTest->AddFeatureCombinations({ {}, { 0 }, { 0, 1 } });
+   }
+   test0.AddTrainingInstances(trainingInstancesDuplicated);
+   test0.AddValidationInstances(validationInstancesDuplicated);
+   test0.InitializeTraining();
+   test1.AddTrainingInstances(trainingInstances);
+   test1.AddValidationInstances(validationInstances);
+   test1.InitializeTraining();
+
+   CHECK(0 != test1.SetWeights({}, { 1, -1, 1 }));
+   CHECK(0 != test1.SetWeights({}, { 1, std::numeric_limits<FractionalDataType>::quiet_NaN(), 1 }));
+   CHECK(0 == test1.SetWeights(trainingWeights, { 1, 2, 1 }));
+
+   FractionalDataType validationMetric0 = FractionalDataType { 0 };
+   FractionalDataType validationMetric1 = FractionalDataType { 0 };
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 1, 2 }) {
+         validationMetric0 = test0.Train(iFeatureCombination);
+         validationMetric1 = test1.Train(iFeatureCombination);
+      }
+   }
+   CHECK_APPROX(validationMetric0, validationMetric1);
+   for(size_t iBin0 = 0; iBin0 < 3; ++iBin0) {
+      CHECK_APPROX(test0.GetCurrentModelPredictorScore(1, { iBin0 }, 0), test1.GetCurrentModelPredictorScore(1, { iBin0 }, 0));
+      for(size_t iBin1 = 0; iBin1 < 2; ++iBin1) {
+         CHECK_APPROX(test0.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0), test1.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0));
+      }
+   }
+
+   // the best model was picked with the weights we had, so we can't change them now
+   CHECK(0 != test1.SetWeights({}, {}));
+}
+
+TEST_CASE("pair updates match hand computed cell means, training, regression") {
+   // pairs always go through our pair kernels, and debug builds rebuild every pair's totals with the runtime dimension code and assert that they're
+   // bit for bit identical.  With 2 bins in each dimension every cell gets a region of its own, so we can also check the update that those totals give us
+   for(const bool bWeighted : { false, true }) {
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(2), FeatureTest(2) });
+      test.AddFeatureCombinations({ { 0, 1 } });
+      std::vector<RegressionInstance> trainingInstances;
+      std::vector<FractionalDataType> trainingWeights;
+      for(size_t iInstance = 0; iInstance < 40; ++iInstance) {
+         trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(iInstance % 7) + FractionalDataType { 0.5 } * static_cast<FractionalDataType>(iInstance % 3), { static_cast<IntegerDataType>(iInstance % 2), static_cast<IntegerDataType>(iInstance / 2 % 2) }));
+         trainingWeights.push_back(bWeighted ? static_cast<FractionalDataType>(iInstance % 3 + 1) : FractionalDataType { 1 });
+      }
+      test.AddTrainingInstances(trainingInstances);
+      test.AddValidationInstances({ RegressionInstance(3, { 1, 0 }) });
+      test.InitializeTraining();
+      CHECK(0 == test.SetWeights(trainingWeights, { 1 }));
+      test.Train(0);
+
+      for(size_t iBin0 = 0; iBin0 < 2; ++iBin0) {
+         for(size_t iBin1 = 0; iBin1 < 2; ++iBin1) {
+            FractionalDataType sumTargets = 0;
+            FractionalDataType sumWeights = 0;
+            for(size_t iInstance = 0; iInstance < trainingInstances.size(); ++iInstance) {
+               if(iBin0 == iInstance % 2 && iBin1 == iInstance / 2 % 2) {
+                  sumTargets += trainingWeights[iInstance] * trainingInstances[iInstance].m_target;
+                  sumWeights += trainingWeights[iInstance];
+               }
+            }
+            CHECK_APPROX(test.GetCurrentModelPredictorScore(0, { iBin0, iBin1 }, 0), k_learningRateDefault * sumTargets / sumWeights);
+         }
+      }
+   }
+}
+
+TEST_CASE("uneven pairs train the same update in both feature orders, training, classification") {
+   // with more bins in one dimension than the other, the pair kernels and the runtime dimension code that debug builds check them against walk
+   // the tensor differently, so we run both orders of an uneven pair through every classification bucket layout.  Swapping the features transposes
+   // the tensor, and our splits are searched along both dimensions, so each order should find the same regions and give each cell the same update
+   for(const ptrdiff_t cTargetClasses : { ptrdiff_t { 2 }, ptrdiff_t { 3 } }) {
+      for(const bool bWeighted : { false, true }) {
+         TestApi test01 = TestApi(cTargetClasses);
+         TestApi test10 = TestApi(cTargetClasses);
+         std::vector<ClassificationInstance> trainingInstances;
+         std::vector<FractionalDataType> trainingWeights;
+         for(size_t iInstance = 0; iInstance < 70; ++iInstance) {
+            trainingInstances.push_back(ClassificationInstance(static_cast<IntegerDataType>((iInstance % 3 + iInstance / 7) % static_cast<size_t>(cTargetClasses)), { static_cast<IntegerDataType>(iInstance % 3), static_cast<IntegerDataType>(iInstance / 2 % 5) }));
+            trainingWeights.push_back(bWeighted ? static_cast<FractionalDataType>(iInstance % 4 + 1) : FractionalDataType { 1 });
+         }
+         for(TestApi * pTest : { &test01, &test10 }) {
+            pTest->AddFeatures({ FeatureTest(3), FeatureTest(5) });
+         }
+         test01.AddFeatureCombinations({ { 0, 1 } });
+         test10.AddFeatureCombinations({ { 1, 0 } });
+         for(TestApi * pTest : { &test01, &test10 }) {
+            pTest->AddTrainingInstances(trainingInstances);
+            pTest->AddValidationInstances({ ClassificationInstance(1, { 2, 4 }) });
+            pTest->InitializeTraining();
+            CHECK(0 == pTest->SetWeights(trainingWeights, { 1 }));
+            pTest->Train(0);
+         }
+
+         for(size_t iBin0 = 0; iBin0 < 3; ++iBin0) {
+            for(size_t iBin1 = 0; iBin1 < 5; ++iBin1) {
+               for(size_t iTargetClass = 0; iTargetClass < static_cast<size_t>(cTargetClasses); ++iTargetClass) {
+                  CHECK_APPROX(test01.GetCurrentModelPredictorScore(0, { iBin0, iBin1 }, iTargetClass), test10.GetCurrentModelPredictorScore(0, { iBin1, iBin0 }, iTargetClass));
+               }
+            }
+         }
+      }
+   }
+}
+
+TEST_CASE("best model holds every feature combination from the best validation step, training, regression") {
+   // our negative learning rate steps make the validation metric worse, so the best model falls behind the current model for a while and then
+   // needs to pick up the feature combinations that changed during that time once the metric improves again
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(2) });
+   test.AddFeatureCombinations({ {}, { 0 }, {} });
+   test.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(12, { 1 }) });
+   test.AddValidationInstances({ RegressionInstance(11, { 0 }), RegressionInstance(13, { 1 }) });
+   test.InitializeTraining();
+
+   FractionalDataType bestValidationMetric = std::numeric_limits<FractionalDataType>::infinity();
+   FractionalDataType bestModel[3][2] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+   size_t cImprovements = 0;
+   for(size_t iStep = 0; iStep < 60; ++iStep) {
+      const size_t iFeatureCombination = iStep % 3;
+      const FractionalDataType learningRate = 1 == iStep % 4 ? -3 * k_learningRateDefault : k_learningRateDefault;
+      const FractionalDataType validationMetric = test.Train(iFeatureCombination, {}, {}, learningRate);
+      if(validationMetric < bestValidationMetric) {
+         bestValidationMetric = validationMetric;
+         ++cImprovements;
+         for(size_t iModel = 0; iModel < 3; ++iModel) {
+            for(size_t iBin = 0; iBin < 2; ++iBin) {
+               bestModel[iModel][iBin] = 1 == iModel ? test.GetCurrentModelPredictorScore(iModel, { iBin }, 0) : test.GetCurrentModelPredictorScore(iModel, {}, 0);
+            }
+         }
+      }
+      for(size_t iModel = 0; iModel < 3; ++iModel) {
+         for(size_t iBin = 0; iBin < 2; ++iBin) {
+            CHECK(bestModel[iModel][iBin] == (1 == iModel ? test.GetBestModelPredictorScore(iModel, { iBin }, 0) : test.GetBestModelPredictorScore(iModel, {}, 0)));
+         }
+      }
+   }
+   CHECK(0 != cImprovements);
+   CHECK(cImprovements < 60);
+}
+
+TEST_CASE("inner bags are reproducible for the same seed, training, binary") {
+   TestApi test0 = TestApi(2);
+   TestApi test1 = TestApi(2);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(5) });
+      pTest->AddFeatureCombinations({ { 0 } });
+      std::vector<ClassificationInstance> trainingInstances;
+      for(size_t iInstance = 0; iInstance < 300; ++iInstance) {
+         trainingInstances.push_back(ClassificationInstance((iInstance / 3 + iInstance % 5) % 2, { static_cast<IntegerDataType>(iInstance % 5) }));
+      }
+      pTest->AddTrainingInstances(trainingInstances);
+      pTest->AddValidationInstances({ ClassificationInstance(0, { 1 }), ClassificationInstance(1, { 3 }) });
+      pTest->InitializeTraining(5);
+   }
+   CHECK(0 == test0.SampleWithoutReplacement(FractionalDataType { 0.5 }));
+   CHECK(0 == test1.SampleWithoutReplacement(FractionalDataType { 0.5 }));
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      CHECK(test0.Train(0) == test1.Train(0));
+   }
+   for(size_t iBin = 0; iBin < 5; ++iBin) {
+      CHECK(test0.GetCurrentModelPredictorScore(0, { iBin }, 1) == test1.GetCurrentModelPredictorScore(0, { iBin }, 1));
+   }
+}
+
+TEST_CASE("GetInteractionScores matches GetInteractionScore, interaction, multiclass") {
+   TestApi test = TestApi(3);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1), FeatureTest(5) });
+   const std::vector<ClassificationInstance> instances = GenerateThreeClassInstances(150, [](const size_t iInstance) { return std::vector<IntegerDataType> { 0, static_cast<IntegerDataType>(iInstance * 7 % 5) }; });
+   test.AddInteractionInstances(instances);
+   test.InitializeInteraction();
+
+   // more combinations than fit into one task, including the degenerate ones that score zero
+   std::vector<std::vector<IntegerDataType>> featureCombinations;
+   for(int iRepeat = 0; iRepeat < 5; ++iRepeat) {
+      for(IntegerDataType iFeature0 = 0; iFeature0 < 4; ++iFeature0) {
+         for(IntegerDataType iFeature1 = iFeature0 + 1; iFeature1 < 4; ++iFeature1) {
+            featureCombinations.push_back({ iFeature0, iFeature1 });
+         }
+      }
+   }
+   featureCombinations.push_back({});
+
+   std::vector<IntegerDataType> featureCombinationIndexes;
+   std::vector<FractionalDataType> interactionScores;
+   CHECK(0 == test.InteractionScores(featureCombinations, -1, featureCombinationIndexes, interactionScores));
+   for(size_t iFeatureCombination = 0; iFeatureCombination < featureCombinations.size(); ++iFeatureCombination) {
+      CHECK(test.InteractionScore(featureCombinations[iFeatureCombination]) == interactionScores[iFeatureCombination]);
+   }
+
+   std::vector<IntegerDataType> topFeatureCombinationIndexes;
+   std::vector<FractionalDataType> topInteractionScores;
+   CHECK(0 == test.InteractionScores(featureCombinations, 7, topFeatureCombinationIndexes, topInteractionScores));
+   std::vector<size_t> aiFeatureCombinationsSorted;
+   for(size_t iFeatureCombination = 0; iFeatureCombination < featureCombinations.size(); ++iFeatureCombination) {
+      aiFeatureCombinationsSorted.push_back(iFeatureCombination);
+   }
+   std::stable_sort(aiFeatureCombinationsSorted.begin(), aiFeatureCombinationsSorted.end(), [&interactionScores](const size_t iLeft, const size_t iRight) {
+      return interactionScores[iRight] < interactionScores[iLeft];
+   });
+   CHECK(7 == topFeatureCombinationIndexes.size());
+   for(size_t iTopScore = 0; iTopScore < topFeatureCombinationIndexes.size(); ++iTopScore) {
+      CHECK(static_cast<IntegerDataType>(aiFeatureCombinationsSorted[iTopScore]) == topFeatureCombinationIndexes[iTopScore]);
+      CHECK(interactionScores[aiFeatureCombinationsSorted[iTopScore]] == topInteractionScores[iTopScore]);
+   }
+
+   // asking for more than we have returns everything sorted
+   CHECK(0 == test.InteractionScores(featureCombinations, 1000, topFeatureCombinationIndexes, topInteractionScores));
+   CHECK(featureCombinations.size() == topFeatureCombinationIndexes.size());
+   CHECK(static_cast<IntegerDataType>(featureCombinations.size() - 1) == topFeatureCombinationIndexes.back());
+}
+
+TEST_CASE("GetInteractionScores puts NaN scores last, interaction, regression") {
+   // the residual sums in bin (0, 0) overflow to infinity, and subtracting infinities while getting the tensor totals makes the pair's score NaN
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(3), FeatureTest(3) });
+   test.AddInteractionInstances({
+      RegressionInstance(FractionalDataType { 1e308 }, { 0, 0 }),
+      RegressionInstance(FractionalDataType { 1e308 }, { 0, 0 }),
+      RegressionInstance(1, { 1, 2 }),
+      RegressionInstance(2, { 2, 1 }),
+      });
+   test.InitializeInteraction();
+   CHECK(std::isnan(test.InteractionScore({ 0, 1 })));
+
+   // the empty combinations score zero, which ranks them above the NaN pairs no matter where the NaNs are in featureCombinations
+   const std::vector<std::vector<IntegerDataType>> featureCombinations = { { 0, 1 }, {}, { 0, 1 }, {}, { 1, 0 } };
+   std::vector<IntegerDataType> featureCombinationIndexes;
+   std::vector<FractionalDataType> interactionScores;
+   CHECK(0 == test.InteractionScores(featureCombinations, 4, featureCombinationIndexes, interactionScores));
+   CHECK((std::vector<IntegerDataType> { 1, 3, 0, 2 }) == featureCombinationIndexes);
+   CHECK(0 == interactionScores[0]);
+   CHECK(0 == interactionScores[1]);
+   CHECK(std::isnan(interactionScores[2]));
+   CHECK(std::isnan(interactionScores[3]));
+}
+
+TEST_CASE("interaction scores don't depend on the compact bin column width, interaction, regression") {
+   // an unused feature with more bins than fit into a byte forces every bin column into a wider type
+   const IntegerDataType aBinsExtra[] = { 2, 300, 70000 };
+   std::vector<FractionalDataType> scores;
+   for(const IntegerDataType cBinsExtra : aBinsExtra) {
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(5), FeatureTest(cBinsExtra) });
+      std::vector<RegressionInstance> instances;
+      for(size_t iInstance = 0; iInstance < 100; ++iInstance) {
+         instances.push_back(RegressionInstance(static_cast<FractionalDataType>((iInstance * 13) % 11) - 5, { static_cast<IntegerDataType>(iInstance % 4), static_cast<IntegerDataType>(iInstance / 3 % 3), static_cast<IntegerDataType>(iInstance * 7 % 5), cBinsExtra - 1 }));
+      }
+      test.AddInteractionInstances(instances);
+      test.InitializeInteraction();
+      scores.push_back(test.InteractionScore({ 0, 1 }));
+      scores.push_back(test.InteractionScore({ 2, 0 }));
+   }
+   CHECK(0 < scores[0]);
+   CHECK(0 < scores[1]);
+   for(size_t iScore = 2; iScore < scores.size(); ++iScore) {
+      CHECK(scores[iScore % 2] == scores[iScore]);
+   }
+}
+
+TEST_CASE("float residuals give nearly the same interaction scores, interaction, regression") {
+   // enough instances to need more than one chunk when converting the residuals to float
+   std::vector<RegressionInstance> instances;
+   for(size_t iInstance = 0; iInstance < 70000; ++iInstance) {
+      instances.push_back(RegressionInstance(static_cast<FractionalDataType>((iInstance * 13) % 11) * 0.1 - 0.5, { static_cast<IntegerDataType>(iInstance % 4), static_cast<IntegerDataType>(iInstance / 3 % 3) }));
+   }
+   TestApi testDouble = TestApi(k_learningTypeRegression);
+   testDouble.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testDouble.AddInteractionInstances(instances);
+   testDouble.InitializeInteraction();
+   TestApi testFloat = TestApi(k_learningTypeRegression);
+   testFloat.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testFloat.AddInteractionInstances(instances);
+   testFloat.InitializeInteraction(InteractionOptionsFloatResiduals);
+
+   const FractionalDataType scoreDouble = testDouble.InteractionScore({ 0, 1 });
+   const FractionalDataType scoreFloat = testFloat.InteractionScore({ 0, 1 });
+   CHECK(0 < scoreDouble);
+   CHECK(std::abs(scoreDouble - scoreFloat) <= 1e-5 * scoreDouble);
+}
+
+TEST_CASE("float residuals give nearly the same interaction scores, interaction, multiclass") {
+   const std::vector<ClassificationInstance> instances = GenerateThreeClassInstances(150);
+   TestApi testDouble = TestApi(3);
+   testDouble.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testDouble.AddInteractionInstances(instances);
+   testDouble.InitializeInteraction();
+   TestApi testFloat = TestApi(3);
+   testFloat.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testFloat.AddInteractionInstances(instances);
+   testFloat.InitializeInteraction(InteractionOptionsFloatResiduals);
+
+   const FractionalDataType scoreDouble = testDouble.InteractionScore({ 0, 1 });
+   const FractionalDataType scoreFloat = testFloat.InteractionScore({ 0, 1 });
+   CHECK(0 < scoreDouble);
+   CHECK(std::abs(scoreDouble - scoreFloat) <= 1e-5 * scoreDouble);
+}
+
+TEST_CASE("interactions on a training state's residuals match interactions on a copy, interaction, regression") {
+   // feature 0 is stored sparsely, so the residuals that we view are offset by the training set's residual shift
+   std::vector<RegressionInstance> trainingInstances;
+   for(IntegerDataType iInstance = 0; iInstance < 400; ++iInstance) {
+      const IntegerDataType bin0 = 0 == iInstance % 20 ? 1 + iInstance / 20 % 5 : 0;
+      const IntegerDataType bin1 = iInstance % 4;
+      const IntegerDataType bin2 = iInstance / 3 % 3;
+      trainingInstances.push_back(RegressionInstance(FractionalDataType { 3 } * bin0 * bin2 - FractionalDataType { 1.5 } * bin1 * bin2 + FractionalDataType { 0.25 } * (iInstance % 7) + 10, { bin0, bin1, bin2 }));
+   }
+   TestApi testTraining = TestApi(k_learningTypeRegression);
+   testTraining.AddFeatures({ FeatureTest(6), FeatureTest(4), FeatureTest(3) });
+   testTraining.AddFeatureCombinations({ {}, { 1 }, { 2 }, { 0 } });
+   testTraining.AddTrainingInstances(trainingInstances);
+   testTraining.AddValidationInstances({ RegressionInstance(12, { 0, 1, 2 }) });
+   testTraining.InitializeTraining(k_countInnerBagsDefault, TrainingOptionsSparseDominantBins);
+
+   const PEbmInteraction pEbmInteraction = testTraining.InitializeInteractionFromTraining();
+   CHECK(nullptr != pEbmInteraction);
+   const std::vector<std::vector<IntegerDataType>> featureCombinations { { 0, 1 }, { 1, 2 }, { 2, 0 } };
+   for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      // the last update of each epoch is to the sparse feature, which leaves a residual shift behind
+      for(size_t iFeatureCombination = 0; iFeatureCombination < testTraining.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+         testTraining.Train(iFeatureCombination);
+      }
+
+      std::vector<RegressionInstance> interactionInstances;
+      for(const RegressionInstance & instance : trainingInstances) {
+         const std::vector<IntegerDataType> & bins = instance.m_binnedDataPerFeatureArray;
+         const FractionalDataType prediction = testTraining.GetCurrentModelPredictorScore(0, {}, 0) + testTraining.GetCurrentModelPredictorScore(1, { static_cast<size_t>(bins[1]) }, 0) + testTraining.GetCurrentModelPredictorScore(2, { static_cast<size_t>(bins[2]) }, 0) + testTraining.GetCurrentModelPredictorScore(3, { static_cast<size_t>(bins[0]) }, 0);
+         interactionInstances.push_back(RegressionInstance(instance.m_target, bins, prediction));
+      }
+      TestApi testCopy = TestApi(k_learningTypeRegression);
+      testCopy.AddFeatures({ FeatureTest(6), FeatureTest(4), FeatureTest(3) });
+      testCopy.AddInteractionInstances(interactionInstances);
+      testCopy.InitializeInteraction();
+
+      // the same handle sees each epoch's residuals
+      for(const std::vector<IntegerDataType> & featureCombination : featureCombinations) {
+         FractionalDataType score = 0;
+         CHECK(0 == GetInteractionScore(pEbmInteraction, featureCombination.size(), &featureCombination[0], &score));
+         CHECK_APPROX(score, testCopy.InteractionScore(featureCombination));
+      }
+   }
+   FreeInteraction(pEbmInteraction);
+}
+
+TEST_CASE("interactions on a training state's residuals match interactions on a copy, interaction, multiclass") {
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(150);
+   TestApi testTraining = TestApi(3);
+   testTraining.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testTraining.AddFeatureCombinations({ { 0 }, { 1 } });
+   testTraining.AddTrainingInstances(trainingInstances);
+   testTraining.AddValidationInstances({ ClassificationInstance(0, { 1, 2 }) });
+   testTraining.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+      testTraining.Train(0);
+      testTraining.Train(1);
+   }
+
+   std::vector<ClassificationInstance> interactionInstances;
+   for(const ClassificationInstance & instance : trainingInstances) {
+      const std::vector<IntegerDataType> & bins = instance.m_binnedDataPerFeatureArray;
+      std::vector<FractionalDataType> logits;
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         logits.push_back(testTraining.GetCurrentModelPredictorScore(0, { static_cast<size_t>(bins[0]) }, iClass) + testTraining.GetCurrentModelPredictorScore(1, { static_cast<size_t>(bins[1]) }, iClass));
+      }
+      interactionInstances.push_back(ClassificationInstance(instance.m_target, bins, logits));
+   }
+   TestApi testCopy = TestApi(3);
+   testCopy.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testCopy.AddInteractionInstances(interactionInstances);
+   testCopy.InitializeInteraction();
+
+   const PEbmInteraction pEbmInteraction = testTraining.InitializeInteractionFromTraining();
+   CHECK(nullptr != pEbmInteraction);
+   const IntegerDataType featureIndexes[] { 0, 1 };
+   FractionalDataType score = 0;
+   CHECK(0 == GetInteractionScore(pEbmInteraction, 2, featureIndexes, &score));
+   CHECK(0 < score);
+   CHECK_APPROX(score, testCopy.InteractionScore({ 0, 1 }));
+   FreeInteraction(pEbmInteraction);
+}
+
+TEST_CASE("interactions on a training state need each feature in a feature combination of its own, interaction") {
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   // the feature with one bin doesn't need a feature combination
+   test.AddFeatureCombinations({ { 0 }, { 0, 1 } });
+   test.AddTrainingInstances({ RegressionInstance(10, { 1, 2, 0 }), RegressionInstance(11, { 3, 0, 0 }) });
+   test.AddValidationInstances({ RegressionInstance(12, { 1, 2, 0 }) });
+   test.InitializeTraining();
+   CHECK(nullptr == test.InitializeInteractionFromTraining());
+}
+
+TEST_CASE("unknown interaction options, interaction") {
+   PEbmInteraction pEbmInteraction = InitializeInteractionRegressionWithOptions(0, nullptr, 0, nullptr, nullptr, nullptr, 2);
+   CHECK(nullptr == pEbmInteraction);
+}
+
+TEST_CASE("borrowed buffers train the same model and update the caller's scores, training, binary") {
+   std::vector<ClassificationInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 40; ++iInstance) {
+      trainingInstances.push_back(ClassificationInstance((iInstance % 3 + iInstance / 5) % 2, { static_cast<IntegerDataType>(iInstance % 4) }, { 0, 0.25 }));
+   }
+   const std::vector<ClassificationInstance> validationInstances { ClassificationInstance(0, { 1 }, { 0, 0.25 }), ClassificationInstance(1, { 3 }, { 0, 0.25 }) };
+
+   TestApi testCopy = TestApi(2);
+   testCopy.AddFeatures({ FeatureTest(4) });
+   testCopy.AddFeatureCombinations({ { 0 } });
+   testCopy.AddTrainingInstances(trainingInstances);
+   testCopy.AddValidationInstances(validationInstances);
+   testCopy.InitializeTraining();
+
+   TestApi testBorrow = TestApi(2);
+   testBorrow.AddFeatures({ FeatureTest(4) });
+   testBorrow.AddFeatureCombinations({ { 0 } });
+   testBorrow.AddTrainingInstances(trainingInstances);
+   testBorrow.AddValidationInstances(validationInstances);
+   testBorrow.InitializeTraining(k_countInnerBagsDefault, TrainingOptionsBorrowBuffers);
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      CHECK(testCopy.Train(0) == testBorrow.Train(0));
+   }
+   for(IntegerDataType iBin = 0; iBin < 4; ++iBin) {
+      CHECK(testCopy.GetCurrentModelPredictorScore(0, { static_cast<size_t>(iBin) }, 1) == testBorrow.GetCurrentModelPredictorScore(0, { static_cast<size_t>(iBin) }, 1));
+   }
+
+   // we only own a copy in the first case, so only the borrowed scores move away from their initial values
+   const std::vector<FractionalDataType> & trainingPredictionScoresCopy = testCopy.GetTrainingPredictionScores();
+   const std::vector<FractionalDataType> & trainingPredictionScoresBorrow = testBorrow.GetTrainingPredictionScores();
+   for(size_t iInstance = 0; iInstance < trainingInstances.size(); ++iInstance) {
+      CHECK(0.25 == trainingPredictionScoresCopy[iInstance]);
+      const FractionalDataType expected = 0.25 + testBorrow.GetCurrentModelPredictorScore(0, { iInstance % 4 }, 1);
+      CHECK_APPROX(expected, trainingPredictionScoresBorrow[iInstance]);
+   }
+}
+
+TEST_CASE("unknown training options, training") {
+   PEbmTraining pEbmTraining = InitializeTrainingRegressionWithOptions(randomSeed, 0, nullptr, 0, nullptr, nullptr, 0, nullptr, nullptr, nullptr, 0, nullptr, nullptr, nullptr, 0, 4);
+   CHECK(nullptr == pEbmTraining);
+}
+
+TEST_CASE("sparse dominant bins train nearly the same models as dense columns, training, regression") {
+   // feature 0 is in bin 0 for 95% of the instances, so it's stored sparsely.  Feature 1 is spread out, so it stays dense and its updates and the
+   // intercept's updates have to interleave correctly with the residual shift
+   std::vector<RegressionInstance> trainingInstances;
+   std::vector<FractionalDataType> trainingWeights;
+   for(IntegerDataType iInstance = 0; iInstance < 400; ++iInstance) {
+      const IntegerDataType bin0 = 0 == iInstance % 20 ? 1 + iInstance / 20 % 5 : 0;
+      const IntegerDataType bin1 = iInstance % 4;
+      trainingInstances.push_back(RegressionInstance(FractionalDataType { 3 } * bin0 - FractionalDataType { 1.5 } * bin1 + FractionalDataType { 0.25 } * (iInstance % 7) + 10, { bin0, bin1 }));
+      trainingWeights.push_back(FractionalDataType { 0.5 } + (iInstance % 3));
+   }
+   const std::vector<RegressionInstance> validationInstances { RegressionInstance(12, { 0, 1 }), RegressionInstance(20, { 3, 0 }), RegressionInstance(8, { 0, 3 }) };
+
+   for(int iVariant = 0; iVariant < 3; ++iVariant) {
+      TestApi testDense = TestApi(k_learningTypeRegression);
+      TestApi testSparse = TestApi(k_learningTypeRegression);
+      for(TestApi * pTest : { &testDense, &testSparse }) {
+         pTest->AddFeatures({ FeatureTest(6), FeatureTest(4) });
+         pTest->AddFeatureCombinations({ {}, { 0 }, { 1 }, { 0, 1 } });
+         pTest->AddTrainingInstances(trainingInstances);
+         pTest->AddValidationInstances(validationInstances);
+         pTest->InitializeTraining(0 == iVariant ? k_countInnerBagsDefault : IntegerDataType { 3 }, &testSparse == pTest ? TrainingOptionsSparseDominantBins : TrainingOptionsNone);
+         if(1 == iVariant) {
+            CHECK(0 == pTest->SetWeights(trainingWeights, {}));
+         } else if(2 == iVariant) {
+            CHECK(0 == pTest->SampleWithoutReplacement(0.5));
+         }
+      }
+      for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+         for(size_t iFeatureCombination = 0; iFeatureCombination < testDense.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+            CHECK_APPROX(testSparse.Train(iFeatureCombination), testDense.Train(iFeatureCombination));
+         }
+      }
+      CHECK_APPROX(testSparse.GetCurrentModelPredictorScore(0, {}, 0), testDense.GetCurrentModelPredictorScore(0, {}, 0));
+      for(size_t iBin0 = 0; iBin0 < 6; ++iBin0) {
+         CHECK_APPROX(testSparse.GetCurrentModelPredictorScore(1, { iBin0 }, 0), testDense.GetCurrentModelPredictorScore(1, { iBin0 }, 0));
+         for(size_t iBin1 = 0; iBin1 < 4; ++iBin1) {
+            // cells without any instances get the value of whichever of several equally good splits the rounding favours, so we only check the others
+            if(0 == iBin0 || 0 == iBin1) {
+               CHECK_APPROX(testSparse.GetCurrentModelPredictorScore(3, { iBin0, iBin1 }, 0), testDense.GetCurrentModelPredictorScore(3, { iBin0, iBin1 }, 0));
+            }
+         }
+      }
+   }
+}
+
+TEST_CASE("training states that share a data set train the same models as ones with their own data, training, multiclass") {
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(60, nullptr, { 0, 0.25, -0.5 });
+   const std::vector<ClassificationInstance> validationInstances { ClassificationInstance(0, { 1, 2 }, { 0, 0.25, -0.5 }), ClassificationInstance(2, { 3, 0 }, { 0, 0.25, -0.5 }), ClassificationInstance(1, { 0, 1 }, { 0, 0.25, -0.5 }) };
+
+   TestApi testOwn = TestApi(3);
+   testOwn.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testOwn.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testOwn.AddTrainingInstances(trainingInstances);
+   testOwn.AddValidationInstances(validationInstances);
+   testOwn.InitializeTraining(2);
+
+   TestApi testShared1 = TestApi(3);
+   testShared1.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testShared1.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testShared1.AddTrainingInstances(trainingInstances);
+   testShared1.AddValidationInstances(validationInstances);
+
+   TestApi testShared2 = TestApi(3);
+   testShared2.AddFeatures({ FeatureTest(4), FeatureTest(3) });
+   testShared2.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   testShared2.AddTrainingInstances(trainingInstances);
+   testShared2.AddValidationInstances(validationInstances);
+
+   const PEbmTrainingDataSet pEbmTrainingDataSet = testShared1.InitializeTrainingDataSet();
+   testShared1.InitializeTrainingFromDataSet(pEbmTrainingDataSet, 2);
+   testShared2.InitializeTrainingFromDataSet(pEbmTrainingDataSet, 2, TrainingOptionsBorrowBuffers);
+   // the training states hold their own references, so the data set outlives our handle
+   FreeTrainingDataSet(pEbmTrainingDataSet);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         const FractionalDataType validationMetricOwn = testOwn.Train(iFeatureCombination);
+         // interleave the shared states so that each one trains on top of the other's residual updates if they weren't kept separate
+         CHECK(validationMetricOwn == testShared1.Train(iFeatureCombination));
+         CHECK(validationMetricOwn == testShared2.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+         for(size_t iClass = 0; iClass < 3; ++iClass) {
+            const FractionalDataType predictorScoreOwn = testOwn.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass);
+            CHECK(predictorScoreOwn == testShared1.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass));
+            CHECK(predictorScoreOwn == testShared2.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("training states that share a data set train the same models as ones with their own data, training, regression") {
+   std::vector<RegressionInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 50; ++iInstance) {
+      trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(iInstance % 7) - 2.5, { static_cast<IntegerDataType>(iInstance % 5) }));
+   }
+   const std::vector<RegressionInstance> validationInstances { RegressionInstance(1.5, { 2 }), RegressionInstance(-0.5, { 4 }) };
+
+   TestApi testOwn = TestApi(k_learningTypeRegression);
+   testOwn.AddFeatures({ FeatureTest(5) });
+   testOwn.AddFeatureCombinations({ { 0 } });
+   testOwn.AddTrainingInstances(trainingInstances);
+   testOwn.AddValidationInstances(validationInstances);
+   testOwn.InitializeTraining();
+
+   TestApi testShared = TestApi(k_learningTypeRegression);
+   testShared.AddFeatures({ FeatureTest(5) });
+   testShared.AddFeatureCombinations({ { 0 } });
+   testShared.AddTrainingInstances(trainingInstances);
+   testShared.AddValidationInstances(validationInstances);
+   const PEbmTrainingDataSet pEbmTrainingDataSet = testShared.InitializeTrainingDataSet();
+   testShared.InitializeTrainingFromDataSet(pEbmTrainingDataSet);
+   FreeTrainingDataSet(pEbmTrainingDataSet);
+
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      CHECK(testOwn.Train(0) == testShared.Train(0));
+   }
+   for(size_t iBin = 0; iBin < 5; ++iBin) {
+      CHECK(testOwn.GetCurrentModelPredictorScore(0, { iBin }, 0) == testShared.GetCurrentModelPredictorScore(0, { iBin }, 0));
+   }
+}
+
+TEST_CASE("training states on a data set reopened from a file train the same models as ones on the original data set, training, multiclass") {
+   static const char k_filePath[] = "TestCoreApi_training_data_set.bin";
+
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(60, [](size_t) { return std::vector<IntegerDataType> { 0 }; });
+   const std::vector<ClassificationInstance> validationInstances { ClassificationInstance(0, { 1, 2, 0 }), ClassificationInstance(2, { 3, 0, 0 }), ClassificationInstance(1, { 0, 1, 0 }) };
+
+   TestApi testOriginal = TestApi(3);
+   testOriginal.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   // the last feature combination has no significant features, so the file has no bit packed data for it
+   testOriginal.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 }, { 2 } });
+   testOriginal.AddTrainingInstances(trainingInstances);
+   testOriginal.AddValidationInstances(validationInstances);
+
+   TestApi testFile = TestApi(3);
+   testFile.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   testFile.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 }, { 2 } });
+   testFile.AddTrainingInstances(trainingInstances);
+   testFile.AddValidationInstances(validationInstances);
+
+   const PEbmTrainingDataSet pEbmTrainingDataSetOriginal = testOriginal.InitializeTrainingDataSet();
+   CHECK(0 == SaveTrainingDataSet(pEbmTrainingDataSetOriginal, k_filePath));
+   const PEbmTrainingDataSet pEbmTrainingDataSetFile = OpenTrainingDataSet(k_filePath);
+   CHECK(nullptr != pEbmTrainingDataSetFile);
+   testOriginal.InitializeTrainingFromDataSet(pEbmTrainingDataSetOriginal, 2);
+   testFile.InitializeTrainingFromDataSet(pEbmTrainingDataSetFile, 2);
+   FreeTrainingDataSet(pEbmTrainingDataSetOriginal);
+   FreeTrainingDataSet(pEbmTrainingDataSetFile);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 4; ++iFeatureCombination) {
+         CHECK(testOriginal.Train(iFeatureCombination) == testFile.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+         for(size_t iClass = 0; iClass < 3; ++iClass) {
+            CHECK(testOriginal.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass) == testFile.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+   remove(k_filePath);
+}
+
+TEST_CASE("opening a data set file that is missing or isn't a data set file fails, training") {
+   static const char k_filePath[] = "TestCoreApi_not_a_data_set.bin";
+
+   CHECK(nullptr == OpenTrainingDataSet(k_filePath));
+
+   FILE * const pFile = fopen(k_filePath, "wb");
+   CHECK(nullptr != pFile);
+   char garbage[200];
+   for(size_t iByte = 0; iByte < sizeof(garbage); ++iByte) {
+      garbage[iByte] = static_cast<char>(iByte * 37);
+   }
+   fwrite(garbage, 1, sizeof(garbage), pFile);
+   fclose(pFile);
+   CHECK(nullptr == OpenTrainingDataSet(k_filePath));
+   remove(k_filePath);
+}
+
+TEST_CASE("training states on a data set built in chunks train the same models as ones on a data set built at once, training, multiclass") {
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(61, [](size_t) { return std::vector<IntegerDataType> { 0 }; });
+   const std::vector<ClassificationInstance> validationInstances { ClassificationInstance(0, { 1, 2, 0 }), ClassificationInstance(2, { 3, 0, 0 }), ClassificationInstance(1, { 0, 1, 0 }) };
+
+   TestApi testOnce = TestApi(3);
+   testOnce.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   testOnce.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 }, { 2 } });
+   testOnce.AddTrainingInstances(trainingInstances);
+   testOnce.AddValidationInstances(validationInstances);
+
+   TestApi testChunks = TestApi(3);
+   testChunks.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   testChunks.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 }, { 2 } });
+   testChunks.AddTrainingInstances(trainingInstances);
+   testChunks.AddValidationInstances(validationInstances);
+
+   const PEbmTrainingDataSet pEbmTrainingDataSetOnce = testOnce.InitializeTrainingDataSet();
+   // 7 instances per chunk doesn't line up with any of the bit pack sizes, so most chunks start in the middle of a data unit
+   const PEbmTrainingDataSet pEbmTrainingDataSetChunks = testChunks.InitializeTrainingDataSetInChunks(7);
+   testOnce.InitializeTrainingFromDataSet(pEbmTrainingDataSetOnce, 2);
+   testChunks.InitializeTrainingFromDataSet(pEbmTrainingDataSetChunks, 2);
+   FreeTrainingDataSet(pEbmTrainingDataSetOnce);
+   FreeTrainingDataSet(pEbmTrainingDataSetChunks);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 4; ++iFeatureCombination) {
+         CHECK(testOnce.Train(iFeatureCombination) == testChunks.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+         for(size_t iClass = 0; iClass < 3; ++iClass) {
+            CHECK(testOnce.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass) == testChunks.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("training data set builder rejects extra instances and unfinished data sets, training, regression") {
+   const EbmCoreFeature feature { FeatureTypeOrdinal, 0, 2 };
+   const EbmCoreFeatureCombination featureCombination { 1 };
+   const IntegerDataType featureCombinationIndexes[] { 0 };
+   const FractionalDataType targets[] { 1.5, 2.5, 3.5 };
+   const IntegerDataType binnedData[] { 0, 1, 1 };
+
+   const PEbmTrainingDataSetBuilder pEbmTrainingDataSetBuilderExtra = CreateTrainingDataSetBuilderRegression(1, &feature, 1, &featureCombination, featureCombinationIndexes, 2, 0);
+   CHECK(nullptr != pEbmTrainingDataSetBuilderExtra);
+   CHECK(0 != AppendTrainingDataSetBuilderRegression(pEbmTrainingDataSetBuilderExtra, 0, 3, targets, binnedData));
+   CHECK(0 != AppendTrainingDataSetBuilderRegression(pEbmTrainingDataSetBuilderExtra, 1, 1, targets, binnedData));
+   CHECK(0 == AppendTrainingDataSetBuilderRegression(pEbmTrainingDataSetBuilderExtra, 0, 2, targets, binnedData));
+   FreeTrainingDataSetBuilder(pEbmTrainingDataSetBuilderExtra);
+
+   const PEbmTrainingDataSetBuilder pEbmTrainingDataSetBuilderMissing = CreateTrainingDataSetBuilderRegression(1, &feature, 1, &featureCombination, featureCombinationIndexes, 3, 0);
+   CHECK(nullptr != pEbmTrainingDataSetBuilderMissing);
+   CHECK(0 == AppendTrainingDataSetBuilderRegression(pEbmTrainingDataSetBuilderMissing, 0, 2, targets, binnedData));
+   CHECK(nullptr == FinishTrainingDataSetBuilder(pEbmTrainingDataSetBuilderMissing));
+}
+
+TEST_CASE("PredictBatch matches summed model scores, training, multiclass") {
+   TestApi test = TestApi(3);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1) });
+   test.AddFeatureCombinations({ {}, { 0 }, { 0, 1 }, { 1, 2 } });
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(60, [](size_t) { return std::vector<IntegerDataType> { 0 }; });
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ ClassificationInstance(1, { 1, 2, 0 }), ClassificationInstance(2, { 3, 1, 0 }) });
+   test.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 1, 2, 3 }) {
+         test.Train(iFeatureCombination);
+      }
+   }
+
+   std::vector<std::vector<IntegerDataType>> binnedDataPerInstance;
+   for(IntegerDataType iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(IntegerDataType iBin1 = 0; iBin1 < 3; ++iBin1) {
+         binnedDataPerInstance.push_back({ iBin0, iBin1, 0 });
+      }
+   }
+   std::vector<FractionalDataType> logits;
+   std::vector<FractionalDataType> probabilities;
+   CHECK(0 == test.PredictBatchCurrentModel(binnedDataPerInstance, false, logits));
+   CHECK(0 == test.PredictBatchCurrentModel(binnedDataPerInstance, true, probabilities));
+   for(size_t iInstance = 0; iInstance < binnedDataPerInstance.size(); ++iInstance) {
+      const size_t iBin0 = static_cast<size_t>(binnedDataPerInstance[iInstance][0]);
+      const size_t iBin1 = static_cast<size_t>(binnedDataPerInstance[iInstance][1]);
+      FractionalDataType sumExp = 0;
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         const FractionalDataType logit = test.GetCurrentModelPredictorScore(0, {}, iClass) + test.GetCurrentModelPredictorScore(1, { iBin0 }, iClass) + test.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, iClass) + test.GetCurrentModelPredictorScore(3, { iBin1, 0 }, iClass);
+         CHECK_APPROX(logits[iInstance * 3 + iClass], logit);
+         sumExp += std::exp(logits[iInstance * 3 + iClass]);
+      }
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         CHECK_APPROX(probabilities[iInstance * 3 + iClass], std::exp(logits[iInstance * 3 + iClass]) / sumExp);
+      }
+   }
+}
+
+TEST_CASE("PredictBatch across prediction blocks, training, binary") {
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(5) });
+   test.AddFeatureCombinations({ { 0 } });
+   std::vector<ClassificationInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 100; ++iInstance) {
+      trainingInstances.push_back(ClassificationInstance((iInstance / 3 + iInstance % 5) % 2, { static_cast<IntegerDataType>(iInstance % 5) }));
+   }
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ ClassificationInstance(0, { 1 }), ClassificationInstance(1, { 3 }) });
+   test.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 20; ++iEpoch) {
+      test.Train(0);
+   }
+
+   // more instances than fit into one prediction block, and not a multiple of the block size
+   std::vector<std::vector<IntegerDataType>> binnedDataPerInstance;
+   for(IntegerDataType iInstance = 0; iInstance < 1299; ++iInstance) {
+      binnedDataPerInstance.push_back({ iInstance * 3 % 5 });
+   }
+   std::vector<FractionalDataType> probabilities;
+   CHECK(0 == test.PredictBatchCurrentModel(binnedDataPerInstance, true, probabilities));
+   CHECK(binnedDataPerInstance.size() == probabilities.size());
+   for(size_t iInstance = 0; iInstance < binnedDataPerInstance.size(); ++iInstance) {
+      const FractionalDataType logit = test.GetCurrentModelPredictorScore(0, { static_cast<size_t>(binnedDataPerInstance[iInstance][0]) }, 1);
+      CHECK_APPROX(probabilities[iInstance], 1 / (1 + std::exp(-logit)));
+   }
+}
+
+TEST_CASE("BinFeatureValues matches np.digitize on the edges after the first") {
+   // no cuts, a few cuts that we compare linearly (with a repeated cut), and enough cuts for the binary search
+   std::vector<EbmCoreFeature> features { { FeatureTypeOrdinal, 0, 1 }, { FeatureTypeOrdinal, 0, 4 }, { FeatureTypeOrdinal, 0, 41 } };
+   std::vector<FractionalDataType> cuts { -1.0, 2.0, 2.0 };
+   for(int iCut = 0; iCut < 40; ++iCut) {
+      cuts.push_back(static_cast<FractionalDataType>(iCut * iCut) / 4);
+   }
+   // enough values to be binned on several threads
+   const size_t cInstances = 400000;
+   std::vector<FractionalDataType> values;
+   for(size_t iFeature = 0; iFeature < features.size(); ++iFeature) {
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         if(0 == iInstance % 101) {
+            values.push_back(std::numeric_limits<FractionalDataType>::quiet_NaN());
+         } else if(0 == iInstance % 7) {
+            // exactly on a cut
+            values.push_back(1 == iFeature ? 2.0 : static_cast<FractionalDataType>(iInstance % 40 * (iInstance % 40)) / 4);
+         } else {
+            values.push_back(static_cast<FractionalDataType>(iInstance % 1000) * FractionalDataType { 0.45 } - 10);
+         }
+      }
+   }
+   std::vector<IntegerDataType> binnedData(values.size(), IntegerDataType { -1 });
+   CHECK(0 == BinFeatureValues(features.size(), &features[0], &cuts[0], cInstances, &values[0], &binnedData[0]));
+
+   size_t iCutsStart = 0;
+   for(size_t iFeature = 0; iFeature < features.size(); ++iFeature) {
+      const size_t cCuts = static_cast<size_t>(features[iFeature].countBins) - 1;
+      for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+         const FractionalDataType value = values[iFeature * cInstances + iInstance];
+         IntegerDataType iBinExpected = 0;
+         for(size_t iCut = 0; iCut < cCuts; ++iCut) {
+            iBinExpected += cuts[iCutsStart + iCut] <= value ? 1 : 0;
+         }
+         if(std::isnan(value)) {
+            iBinExpected = static_cast<IntegerDataType>(cCuts);
+         }
+         if(iBinExpected != binnedData[iFeature * cInstances + iInstance]) {
+            CHECK(iBinExpected == binnedData[iFeature * cInstances + iInstance]);
+            break;
+         }
+      }
+      iCutsStart += cCuts;
+   }
+}
+
+TEST_CASE("PredictBatch on raw values matches PredictBatch on their bins, training, multiclass") {
+   TestApi test = TestApi(3);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1), FeatureTest(2) });
+   // feature 3 isn't in any feature combination, and feature 0 is in several
+   test.AddFeatureCombinations({ {}, { 0 }, { 0, 1 }, { 1, 2 } });
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(60, [](const size_t iInstance) { return std::vector<IntegerDataType> { 0, static_cast<IntegerDataType>(iInstance % 2) }; });
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ ClassificationInstance(1, { 1, 2, 0, 0 }), ClassificationInstance(2, { 3, 1, 0, 1 }) });
+   test.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 1, 2, 3 }) {
+         test.Train(iFeatureCombination);
+      }
+   }
+
+   // more instances than fit into one prediction block, with values below, on and above the cuts
+   std::vector<std::vector<IntegerDataType>> binnedDataPerInstance;
+   std::vector<std::vector<FractionalDataType>> valuesPerInstance;
+   for(IntegerDataType iInstance = 0; iInstance < 1299; ++iInstance) {
+      const IntegerDataType iBin0 = iInstance % 4;
+      const IntegerDataType iBin1 = iInstance / 4 % 3;
+      binnedDataPerInstance.push_back({ iBin0, iBin1, 0, 0 });
+      const FractionalDataType offset = 0 == iInstance % 3 ? FractionalDataType { -0.5 } : 1 == iInstance % 3 ? FractionalDataType { 0 } : FractionalDataType { 0.4 };
+      valuesPerInstance.push_back({ static_cast<FractionalDataType>(iBin0) + offset, static_cast<FractionalDataType>(iBin1) + offset, 123.0, 0.0 });
+   }
+   // NaN goes into the last bin
+   binnedDataPerInstance.push_back({ 3, 2, 0, 0 });
+   valuesPerInstance.push_back({ std::numeric_limits<FractionalDataType>::quiet_NaN(), std::numeric_limits<FractionalDataType>::quiet_NaN(), std::numeric_limits<FractionalDataType>::quiet_NaN(), 0.0 });
+
+   for(const bool bProbabilities : { false, true }) {
+      std::vector<FractionalDataType> scoresBinned;
+      std::vector<FractionalDataType> scoresValues;
+      CHECK(0 == test.PredictBatchCurrentModel(binnedDataPerInstance, bProbabilities, scoresBinned));
+      CHECK(0 == test.PredictBatchCurrentModelValues(valuesPerInstance, bProbabilities, scoresValues));
+      CHECK(scoresBinned == scoresValues);
+   }
+}
+
+// PredictModel takes feature major values like PredictBatchCurrentModelValues builds from valuesPerInstance
+static std::vector<FractionalDataType> GetValuesFeatureMajor(const std::vector<std::vector<FractionalDataType>> & valuesPerInstance) {
+   const size_t cInstances = valuesPerInstance.size();
+   const size_t cFeatures = 0 == cInstances ? size_t { 0 } : valuesPerInstance[0].size();
+   std::vector<FractionalDataType> values(cFeatures * cInstances);
+   for(size_t iInstance = 0; iInstance < cInstances; ++iInstance) {
+      for(size_t iFeature = 0; iFeature < cFeatures; ++iFeature) {
+         values[iFeature * cInstances + iInstance] = valuesPerInstance[iInstance][iFeature];
+      }
+   }
+   return values;
+}
+
+TEST_CASE("PredictModel on a saved model file matches PredictBatch on raw values, training, multiclass") {
+   static const char k_filePath[] = "TestCoreApi_model_multiclass.bin";
+
+   TestApi test = TestApi(3);
+   test.AddFeatures({ FeatureTest(4), FeatureTest(3), FeatureTest(1), FeatureTest(2) });
+   test.AddFeatureCombinations({ {}, { 0 }, { 0, 1 }, { 1, 2 } });
+   const std::vector<ClassificationInstance> trainingInstances = GenerateThreeClassInstances(60, [](const size_t iInstance) { return std::vector<IntegerDataType> { 0, static_cast<IntegerDataType>(iInstance % 2) }; });
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ ClassificationInstance(1, { 1, 2, 0, 0 }), ClassificationInstance(2, { 3, 1, 0, 1 }) });
+   test.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 0, 1, 2, 3 }) {
+         test.Train(iFeatureCombination);
+      }
+   }
+
+   std::vector<std::vector<FractionalDataType>> valuesPerInstance;
+   for(IntegerDataType iInstance = 0; iInstance < 1299; ++iInstance) {
+      const FractionalDataType offset = 0 == iInstance % 3 ? FractionalDataType { -0.5 } : 1 == iInstance % 3 ? FractionalDataType { 0 } : FractionalDataType { 0.4 };
+      valuesPerInstance.push_back({ static_cast<FractionalDataType>(iInstance % 4) + offset, static_cast<FractionalDataType>(iInstance / 4 % 3) + offset, 123.0, static_cast<FractionalDataType>(iInstance % 2) });
+   }
+   valuesPerInstance.push_back({ std::numeric_limits<FractionalDataType>::quiet_NaN(), std::numeric_limits<FractionalDataType>::quiet_NaN(), std::numeric_limits<FractionalDataType>::quiet_NaN(), 0.0 });
+   const std::vector<FractionalDataType> values = GetValuesFeatureMajor(valuesPerInstance);
+   const IntegerDataType countInstances = static_cast<IntegerDataType>(valuesPerInstance.size());
+
+   // with a zero intercept the model file gives exactly the scores of the tensors that we saved
+   CHECK(0 == test.SaveCurrentModel(k_filePath, { 0, 0, 0 }));
+   PEbmModel pEbmModel = OpenModel(k_filePath);
+   CHECK(nullptr != pEbmModel);
+   CHECK(4 == GetModelCountFeatures(pEbmModel));
+   CHECK(3 == GetModelCountTargetClasses(pEbmModel));
+   for(const bool bProbabilities : { false, true }) {
+      std::vector<FractionalDataType> scoresBatch;
+      CHECK(0 == test.PredictBatchCurrentModelValues(valuesPerInstance, bProbabilities, scoresBatch));
+      std::vector<FractionalDataType> scoresModel(scoresBatch.size(), FractionalDataType { 999 });
+      CHECK(0 == PredictModel(pEbmModel, countInstances, &values[0], bProbabilities ? 1 : 0, &scoresModel[0]));
+      CHECK(scoresBatch == scoresModel);
+   }
+   FreeModel(pEbmModel);
+
+   const std::vector<FractionalDataType> intercept { 0.25, -1.5, 3.0 };
+   CHECK(0 == test.SaveCurrentModel(k_filePath, intercept));
+   pEbmModel = OpenModel(k_filePath);
+   CHECK(nullptr != pEbmModel);
+   std::vector<FractionalDataType> scoresBatch;
+   CHECK(0 == test.PredictBatchCurrentModelValues(valuesPerInstance, false, scoresBatch));
+   std::vector<FractionalDataType> scoresModel(scoresBatch.size());
+   CHECK(0 == PredictModel(pEbmModel, countInstances, &values[0], 0, &scoresModel[0]));
+   for(size_t iScore = 0; iScore < scoresBatch.size(); ++iScore) {
+      CHECK_APPROX(scoresModel[iScore], scoresBatch[iScore] + intercept[iScore % 3]);
+   }
+   FreeModel(pEbmModel);
+   remove(k_filePath);
+}
+
+TEST_CASE("PredictModel on a saved model file matches PredictBatch on raw values, training, regression") {
+   static const char k_filePath[] = "TestCoreApi_model_regression.bin";
+
+   TestApi test = TestApi(k_learningTypeRegression);
+   // 20 bins is enough cuts for binning to use the binary search
+   test.AddFeatures({ FeatureTest(20), FeatureTest(3) });
+   test.AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+   std::vector<RegressionInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 200; ++iInstance) {
+      trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(iInstance % 13) - static_cast<FractionalDataType>(iInstance % 5), { static_cast<IntegerDataType>(iInstance % 20), static_cast<IntegerDataType>(iInstance % 3) }));
+   }
+   test.AddTrainingInstances(trainingInstances);
+   test.AddValidationInstances({ RegressionInstance(1, { 1, 2 }), RegressionInstance(-2, { 14, 0 }) });
+   test.InitializeTraining();
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         test.Train(iFeatureCombination);
+      }
+   }
+
+   std::vector<std::vector<FractionalDataType>> valuesPerInstance;
+   for(IntegerDataType iInstance = 0; iInstance < 100; ++iInstance) {
+      valuesPerInstance.push_back({ static_cast<FractionalDataType>(iInstance % 23) - FractionalDataType { 1.25 }, static_cast<FractionalDataType>(iInstance % 3) });
+   }
+   const std::vector<FractionalDataType> values = GetValuesFeatureMajor(valuesPerInstance);
+
+   CHECK(0 == test.SaveCurrentModel(k_filePath, { 10.0 }));
+   const PEbmModel pEbmModel = OpenModel(k_filePath);
+   CHECK(nullptr != pEbmModel);
+   CHECK(2 == GetModelCountFeatures(pEbmModel));
+   CHECK(-1 == GetModelCountTargetClasses(pEbmModel));
+   std::vector<FractionalDataType> scoresBatch;
+   CHECK(0 == test.PredictBatchCurrentModelValues(valuesPerInstance, false, scoresBatch));
+   std::vector<FractionalDataType> scoresModel(scoresBatch.size());
+   CHECK(0 == PredictModel(pEbmModel, static_cast<IntegerDataType>(valuesPerInstance.size()), &values[0], 0, &scoresModel[0]));
+   for(size_t iScore = 0; iScore < scoresBatch.size(); ++iScore) {
+      CHECK_APPROX(scoresModel[iScore], scoresBatch[iScore] + 10.0);
+   }
+   FreeModel(pEbmModel);
+   remove(k_filePath);
+}
+
+TEST_CASE("opening a model file that is missing, truncated or isn't a model file fails, training") {
+   static const char k_filePath[] = "TestCoreApi_not_a_model.bin";
+   static const char k_filePathTruncated[] = "TestCoreApi_truncated_model.bin";
+
+   CHECK(nullptr == OpenModel(k_filePath));
+
+   FILE * pFile = fopen(k_filePath, "wb");
+   CHECK(nullptr != pFile);
+   char garbage[200];
+   for(size_t iByte = 0; iByte < sizeof(garbage); ++iByte) {
+      garbage[iByte] = static_cast<char>(iByte * 37);
+   }
+   fwrite(garbage, 1, sizeof(garbage), pFile);
+   fclose(pFile);
+   CHECK(nullptr == OpenModel(k_filePath));
+
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(3) });
+   test.AddFeatureCombinations({ { 0 } });
+   test.AddTrainingInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 2 }) });
+   test.AddValidationInstances({ ClassificationInstance(1, { 1 }) });
+   test.InitializeTraining();
+   test.Train(0);
+   CHECK(0 == test.SaveCurrentModel(k_filePath, { 0.5 }));
+   const PEbmModel pEbmModel = OpenModel(k_filePath);
+   CHECK(nullptr != pEbmModel);
+   FreeModel(pEbmModel);
+
+   pFile = fopen(k_filePath, "rb");
+   CHECK(nullptr != pFile);
+   std::vector<char> bytes(4096);
+   bytes.resize(fread(&bytes[0], 1, bytes.size(), pFile));
+   fclose(pFile);
+   // dropping the last tensor value or adding a byte past the end both fail
+   for(const size_t cBytes : { bytes.size() - sizeof(FractionalDataType), bytes.size() + 1 }) {
+      bytes.resize(cBytes, 0);
+      pFile = fopen(k_filePathTruncated, "wb");
+      CHECK(nullptr != pFile);
+      fwrite(&bytes[0], 1, cBytes, pFile);
+      fclose(pFile);
+      CHECK(nullptr == OpenModel(k_filePathTruncated));
+   }
+   remove(k_filePathTruncated);
+   remove(k_filePath);
+}
+
+TEST_CASE("training states on a data set built from raw values train the same models as ones on binned data, training, regression") {
+   std::vector<RegressionInstance> trainingInstances;
+   for(size_t iInstance = 0; iInstance < 1100; ++iInstance) {
+      trainingInstances.push_back(RegressionInstance(static_cast<FractionalDataType>(iInstance % 13) - static_cast<FractionalDataType>(iInstance % 5), { static_cast<IntegerDataType>(iInstance % 5), static_cast<IntegerDataType>(iInstance % 3) }));
+   }
+   const std::vector<RegressionInstance> validationInstances { RegressionInstance(1, { 1, 2 }), RegressionInstance(-2, { 4, 0 }), RegressionInstance(7, { 0, 1 }) };
+
+   TestApi testBinned = TestApi(k_learningTypeRegression);
+   TestApi testValues = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &testBinned, &testValues }) {
+      pTest->AddFeatures({ FeatureTest(5), FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      pTest->AddTrainingInstances(trainingInstances);
+      pTest->AddValidationInstances(validationInstances);
+   }
+
+   const PEbmTrainingDataSet pEbmTrainingDataSetBinned = testBinned.InitializeTrainingDataSet();
+   // 600 instances per chunk splits each chunk into a full binning block and a partial one
+   const PEbmTrainingDataSet pEbmTrainingDataSetValues = testValues.InitializeTrainingDataSetInChunks(600, true);
+   testBinned.InitializeTrainingFromDataSet(pEbmTrainingDataSetBinned, 2);
+   testValues.InitializeTrainingFromDataSet(pEbmTrainingDataSetValues, 2);
+   FreeTrainingDataSet(pEbmTrainingDataSetBinned);
+   FreeTrainingDataSet(pEbmTrainingDataSetValues);
+
+   for(int iEpoch = 0; iEpoch < 10; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination = 0; iFeatureCombination < 3; ++iFeatureCombination) {
+         CHECK(testBinned.Train(iFeatureCombination) == testValues.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 5; ++iBin0) {
+      for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+         CHECK(testBinned.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0) == testValues.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0));
+      }
+   }
+}
+
+TEST_CASE("TrainingRounds matches TrainingStep loop, training, regression") {
+   TestApi test0 = TestApi(k_learningTypeRegression);
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3), FeatureTest(2) });
+      pTest->AddFeatureCombinations({ { 0 }, { 1 }, { 0, 1 } });
+      pTest->AddTrainingInstances({ RegressionInstance(10, { 0, 0 }), RegressionInstance(11, { 1, 1 }), RegressionInstance(14, { 2, 0 }), RegressionInstance(9, { 2, 1 }) });
+      pTest->AddValidationInstances({ RegressionInstance(12, { 1, 0 }), RegressionInstance(10, { 2, 1 }) });
+      pTest->InitializeTraining();
+   }
+
+   FractionalDataType validationMetricLoop = FractionalDataType { 0 };
+   for(int iEpoch = 0; iEpoch < 50; ++iEpoch) {
+      for(IntegerDataType iFeatureCombination : { 2, 0, 1 }) {
+         validationMetricLoop = test0.Train(iFeatureCombination);
+      }
+   }
+
+   // a negative run length disables early stopping, so all rounds should run
+   IntegerDataType countRounds = 0;
+   FractionalDataType validationMetricBest = FractionalDataType { 0 };
+   const FractionalDataType validationMetricRounds = test1.TrainRounds({ 2, 0, 1 }, 50, -1, 0, &countRounds, &validationMetricBest);
+   CHECK(50 == countRounds);
+   CHECK(validationMetricLoop == validationMetricRounds);
+   CHECK(validationMetricBest <= validationMetricRounds);
+   for(size_t iBin0 = 0; iBin0 < 3; ++iBin0) {
+      CHECK(test0.GetCurrentModelPredictorScore(0, { iBin0 }, 0) == test1.GetCurrentModelPredictorScore(0, { iBin0 }, 0));
+      for(size_t iBin1 = 0; iBin1 < 2; ++iBin1) {
+         CHECK(test0.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0) == test1.GetCurrentModelPredictorScore(2, { iBin0, iBin1 }, 0));
+      }
+   }
+}
+
+TEST_CASE("TrainingRounds binning each feature combination while applying the previous update matches TrainingStep loop, training, multiclass") {
+   // enough instances that binning splits them into chunks, and those chunks start partway through the bit pack data units of the pair
+   std::vector<ClassificationInstance> instances;
+   std::vector<FractionalDataType> trainingWeights;
+   for(IntegerDataType iInstance = 0; iInstance < 200000; ++iInstance) {
+      instances.push_back(ClassificationInstance((iInstance % 4 + iInstance / 4 % 3 + (0 == iInstance % 7 ? 1 : 0)) % 3, { iInstance % 4, iInstance / 4 % 3 }));
+      trainingWeights.push_back(static_cast<FractionalDataType>(1 + iInstance % 3));
+   }
+
+   // weighted inner bags sampled with replacement, and then inner bags sampled without replacement
+   for(int iSampling = 0; iSampling < 2; ++iSampling) {
+      TestApi testLoop = TestApi(3);
+      TestApi testRounds = TestApi(3);
+      for(TestApi * pTest : { &testLoop, &testRounds }) {
+         pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+         pTest->AddFeatureCombinations({ { 0 }, { 0, 1 }, { 1 } });
+         pTest->AddTrainingInstances(instances);
+         pTest->AddValidationInstances({ ClassificationInstance(1, { 1, 0 }), ClassificationInstance(2, { 2, 2 }) });
+         pTest->InitializeTraining(3);
+         if(0 == iSampling) {
+            CHECK(0 == pTest->SetWeights(trainingWeights, {}));
+         } else {
+            CHECK(0 == pTest->SampleWithoutReplacement(0.5));
+         }
+      }
+
+      FractionalDataType validationMetricLoop = FractionalDataType { 0 };
+      for(int iRound = 0; iRound < 3; ++iRound) {
+         for(IntegerDataType iFeatureCombination : { 1, 0, 2 }) {
+            validationMetricLoop = testLoop.Train(iFeatureCombination);
+         }
+      }
+      IntegerDataType countRounds = 0;
+      const FractionalDataType validationMetricRounds = testRounds.TrainRounds({ 1, 0, 2 }, 3, -1, 0, &countRounds);
+      CHECK(3 == countRounds);
+      CHECK_APPROX(validationMetricLoop, validationMetricRounds);
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+            CHECK_APPROX(testLoop.GetCurrentModelPredictorScore(0, { iBin0 }, iClass), testRounds.GetCurrentModelPredictorScore(0, { iBin0 }, iClass));
+            for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+               CHECK_APPROX(testLoop.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass), testRounds.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass));
+            }
+         }
+         for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+            CHECK_APPROX(testLoop.GetCurrentModelPredictorScore(2, { iBin1 }, iClass), testRounds.GetCurrentModelPredictorScore(2, { iBin1 }, iClass));
+         }
+      }
+   }
+}
+
+TEST_CASE("TrainingRounds early stopping, training, regression") {
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(2) });
+   test.AddFeatureCombinations({ { 0 } });
+   test.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+   test.AddValidationInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+   test.InitializeTraining();
+
+   // a huge tolerance means no round ever counts as an improvement, so we stop as soon as the run length is reached
+   IntegerDataType countRounds = 0;
+   test.TrainRounds({ 0 }, 1000, 5, 1000000, &countRounds);
+   CHECK(5 == countRounds);
+
+   // zero rounds of patience stops after the first round
+   test.TrainRounds({ 0 }, 1000, 0, 0, &countRounds);
+   CHECK(1 == countRounds);
+
+   // no combinations and no rounds are legal and leave the model alone
+   const FractionalDataType validationMetric = test.TrainRounds({}, 0, -1, 0, &countRounds);
+   CHECK(0 == countRounds);
+   CHECK(std::numeric_limits<FractionalDataType>::infinity() == validationMetric);
+}
+
+TEST_CASE("statistics count the work done, training, regression") {
+   TestApi test = TestApi(k_learningTypeRegression);
+   test.AddFeatures({ FeatureTest(3), FeatureTest(2) });
+   test.AddFeatureCombinations({ { 0 }, { 0, 1 } });
+   test.AddTrainingInstances({ RegressionInstance(10, { 0, 0 }), RegressionInstance(11, { 1, 1 }), RegressionInstance(14, { 2, 0 }), RegressionInstance(9, { 2, 1 }) });
+   test.AddValidationInstances({ RegressionInstance(12, { 1, 0 }), RegressionInstance(10, { 2, 1 }) });
+   test.InitializeTraining();
+
+   std::vector<IntegerDataType> statistics = test.GetStatisticsTraining();
+   for(const IntegerDataType statistic : statistics) {
+      CHECK(0 == statistic);
+   }
+
+   test.Train(0);
+   test.Train(1);
+   statistics = test.GetStatisticsTraining();
+#ifndef EBM_NO_STATISTICS
+   // each feature combination bins all 4 training instances once, into 3 buckets for the main and 6 for the pair
+   CHECK(8 == statistics[StatisticInstancesScanned]);
+   CHECK(9 == statistics[StatisticBinsTouched]);
+   CHECK(1 <= statistics[StatisticNodesSplit]);
+   CHECK(1 <= statistics[StatisticBytesAllocated]);
+#endif // EBM_NO_STATISTICS
+   for(const IntegerDataType statistic : statistics) {
+      CHECK(0 <= statistic);
+   }
+
+   // asking for fewer statistics is how callers built against older headers read them
+   IntegerDataType statisticFirst = -1;
+   CHECK(0 == test.GetStatisticsTraining(1, &statisticFirst));
+   CHECK(statistics[0] <= statisticFirst);
+   CHECK(0 != test.GetStatisticsTraining(StatisticsCount + 1, &statistics[0]));
+   CHECK(0 != test.GetStatisticsTraining(1, nullptr));
+}
+
+TEST_CASE("statistics count the work done, interaction, binary") {
+   TestApi test = TestApi(2);
+   test.AddFeatures({ FeatureTest(2), FeatureTest(3) });
+   test.AddInteractionInstances({ ClassificationInstance(0, { 0, 0 }), ClassificationInstance(1, { 1, 2 }), ClassificationInstance(1, { 0, 1 }) });
+   test.InitializeInteraction();
+
+   test.InteractionScore({ 0, 1 });
+   const std::vector<IntegerDataType> statistics = test.GetStatisticsInteraction();
+#ifndef EBM_NO_STATISTICS
+   CHECK(3 == statistics[StatisticInstancesScanned]);
+   CHECK(6 == statistics[StatisticBinsTouched]);
+#endif // EBM_NO_STATISTICS
+   CHECK(0 == statistics[StatisticTreeGrowingNanoseconds]);
+   CHECK(0 == statistics[StatisticNodesSplit]);
+}
+
+TEST_CASE("validation metric interval skips the metric between intervals, training, binary") {
+   TestApi test0 = TestApi(2);
+   TestApi test1 = TestApi(2);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 } });
+      pTest->AddTrainingInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 1 }), ClassificationInstance(1, { 2 }), ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 2 }), ClassificationInstance(0, { 1 }) });
+      pTest->AddValidationInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 1 }), ClassificationInstance(1, { 2 }), ClassificationInstance(0, { 2 }) });
+      pTest->InitializeTraining();
+   }
+   CHECK(0 != test1.SetMetricInterval(-1));
+   CHECK(0 == test1.SetMetricInterval(3));
+
+   FractionalDataType validationMetricLast = std::numeric_limits<FractionalDataType>::infinity();
+   for(int iStep = 0; iStep < 9; ++iStep) {
+      const FractionalDataType validationMetric0 = test0.Train(0);
+      const FractionalDataType validationMetric1 = test1.Train(0);
+      if(2 == iStep % 3) {
+         // skipping the metric still moves the validation scores, so the metrics agree whenever we compute them
+         CHECK_APPROX(validationMetric0, validationMetric1);
+         validationMetricLast = validationMetric1;
+      } else {
+         CHECK(validationMetricLast == validationMetric1);
+      }
+   }
+   for(size_t iBin = 0; iBin < 3; ++iBin) {
+      CHECK_APPROX(test0.GetCurrentModelPredictorScore(0, { iBin }, 0), test1.GetCurrentModelPredictorScore(0, { iBin }, 0));
+   }
+#ifndef EBM_NO_STATISTICS
+   CHECK(9 == test0.GetStatisticsTraining()[StatisticValidationMetrics]);
+   CHECK(3 == test1.GetStatisticsTraining()[StatisticValidationMetrics]);
+#endif // EBM_NO_STATISTICS
+}
+
+TEST_CASE("validation metric interval of zero only computes the metric at the end of rounds, training, regression") {
+   TestApi test0 = TestApi(k_learningTypeRegression);
+   TestApi test1 = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &test0, &test1 }) {
+      pTest->AddFeatures({ FeatureTest(3), FeatureTest(2) });
+      pTest->AddFeatureCombinations({ { 0 }, { 1 } });
+      pTest->AddTrainingInstances({ RegressionInstance(10, { 0, 0 }), RegressionInstance(11, { 1, 1 }), RegressionInstance(14, { 2, 0 }), RegressionInstance(9, { 2, 1 }) });
+      pTest->AddValidationInstances({ RegressionInstance(12, { 1, 0 }), RegressionInstance(10, { 2, 1 }), RegressionInstance(13, { 0, 1 }) });
+      pTest->InitializeTraining();
+   }
+   CHECK(0 == test1.SetMetricInterval(0));
+
+   IntegerDataType countRounds0 = -1;
+   IntegerDataType countRounds1 = -1;
+   const FractionalDataType validationMetric0 = test0.TrainRounds({ 0, 1 }, 5, -1, 0, &countRounds0);
+   const FractionalDataType validationMetric1 = test1.TrainRounds({ 0, 1 }, 5, -1, 0, &countRounds1);
+   CHECK(5 == countRounds0);
+   CHECK(5 == countRounds1);
+   CHECK_APPROX(validationMetric0, validationMetric1);
+
+   // outside of TrainingRounds nothing asks for the metric, so we keep returning the one from the end of the last round
+   CHECK(validationMetric1 == test1.Train(0));
+#ifndef EBM_NO_STATISTICS
+   CHECK(10 == test0.GetStatisticsTraining()[StatisticValidationMetrics]);
+   CHECK(5 == test1.GetStatisticsTraining()[StatisticValidationMetrics]);
+#endif // EBM_NO_STATISTICS
+}
+
+TEST_CASE("instance weights are rejected after the first update whatever the validation metric interval, training, regression") {
+   for(const IntegerDataType countUpdatesPerValidationMetric : { IntegerDataType { 0 }, IntegerDataType { 2 } }) {
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(2) });
+      test.AddFeatureCombinations({ { 0 } });
+      test.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(12, { 1 }) });
+      test.AddValidationInstances({ RegressionInstance(11, { 0 }), RegressionInstance(13, { 1 }) });
+      test.InitializeTraining();
+      CHECK(0 == test.SetMetricInterval(countUpdatesPerValidationMetric));
+
+      // this update doesn't compute a metric, so our best model metric is still infinity
+      CHECK(std::numeric_limits<FractionalDataType>::infinity() == test.ApplyUpdate(0, { 1, 1 }));
+      CHECK(0 != test.SetWeights({ 1, 2 }, { 1, 2 }));
+   }
+}
+
+TEST_CASE("validation instances that an update doesn't move reuse their losses, training, classification") {
+   for(const IntegerDataType countTargetClasses : { IntegerDataType { 2 }, IntegerDataType { 3 } }) {
+      const size_t cVectorLength = GetVectorLength(countTargetClasses);
+      // the first update only moves bin 0 and the second only moves bin 1
+      std::vector<FractionalDataType> update0(3 * cVectorLength, FractionalDataType { 0 });
+      std::vector<FractionalDataType> update1(3 * cVectorLength, FractionalDataType { 0 });
+      for(size_t iVector = 0; iVector < cVectorLength; ++iVector) {
+         update0[iVector] = FractionalDataType { 0.25 } * static_cast<FractionalDataType>(iVector + 1);
+         update1[cVectorLength + iVector] = FractionalDataType { -0.5 } * static_cast<FractionalDataType>(iVector + 1);
+      }
+
+      TestApi test0 = TestApi(countTargetClasses);
+      TestApi test1 = TestApi(countTargetClasses);
+      for(TestApi * pTest : { &test0, &test1 }) {
+         pTest->AddFeatures({ FeatureTest(3) });
+         pTest->AddFeatureCombinations({ { 0 } });
+         pTest->AddTrainingInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 1 }), ClassificationInstance(1, { 2 }) });
+         pTest->AddValidationInstances({ ClassificationInstance(0, { 0 }), ClassificationInstance(1, { 0 }), ClassificationInstance(countTargetClasses - 1, { 1 }), ClassificationInstance(0, { 2 }) });
+         pTest->InitializeTraining();
+      }
+      // test1 skips the metric on its first update, so its losses aren't current and it scores every instance on its second
+      CHECK(0 == test1.SetMetricInterval(2));
+
+      test0.ApplyUpdate(0, update0);
+      CHECK(std::numeric_limits<FractionalDataType>::infinity() == test1.ApplyUpdate(0, update0));
+      const FractionalDataType validationMetric0 = test0.ApplyUpdate(0, update1);
+      const FractionalDataType validationMetric1 = test1.ApplyUpdate(0, update1);
+      CHECK_APPROX(validationMetric0, validationMetric1);
+#ifndef EBM_NO_STATISTICS
+      // test0 scores all 4 instances the first time, and then only the instance in bin 1
+      CHECK(5 == test0.GetStatisticsTraining()[StatisticValidationInstancesScored]);
+      CHECK(4 == test1.GetStatisticsTraining()[StatisticValidationInstancesScored]);
+#endif // EBM_NO_STATISTICS
+   }
+}
+
+// counts the messages that reach LogMessage, so that we can see when buffered messages get delivered
+static size_t g_cLogMessagesDelivered = 0;
+
+// the number of representable doubles between two non-negative results, which is how many ulps apart they are
+static uint64_t CountUlpsBetween(const double value1, const double value2) {
+   uint64_t bits1;
+   memcpy(&bits1, &value1, sizeof(bits1));
+   uint64_t bits2;
+   memcpy(&bits2, &value2, sizeof(bits2));
+   return bits1 < bits2 ? bits2 - bits1 : bits1 - bits2;
+}
+
+TEST_CASE("ExpForMulticlassClamped is within 2 ulps of std::exp") {
+   // sweep the whole clamp range, which includes the results that round into subnormals near -746 and the ones that overflow to +inf near 710
+   constexpr size_t k_cSteps = 2000000;
+   uint64_t cUlpsMax = 0;
+   for(size_t iStep = 0; iStep <= k_cSteps; ++iStep) {
+      const double value = -746.0 + 1456.0 * static_cast<double>(iStep) / static_cast<double>(k_cSteps);
+      const double expected = std::exp(value);
+      const double actual = MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(value));
+      const uint64_t cUlps = CountUlpsBetween(actual, expected);
+      cUlpsMax = cUlpsMax < cUlps ? cUlps : cUlpsMax;
+   }
+   CHECK(cUlpsMax <= 2);
+
+   // beyond the clamp range std::exp has already rounded to 0 or overflowed to +inf
+   for(const double value : { -746.5, -800.0, -1e308, 710.5, 800.0, 1e308 }) {
+      CHECK(std::exp(value) == MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(value)));
+   }
+   CHECK(0 == MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(-std::numeric_limits<double>::infinity())));
+   CHECK(std::numeric_limits<double>::infinity() == MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(std::numeric_limits<double>::infinity())));
+   CHECK(std::isnan(MulticlassExp::ExpForMulticlassClamped(MulticlassExp::ClampForMulticlassExp(std::numeric_limits<double>::quiet_NaN()))));
+}
+
+TEST_CASE("many classes train the same model as std::exp would, training, multiclass") {
+   // from 8 classes up the softmax uses our polynomial exp instead of std::exp.  We train the intercept with every class's score moved by a prior, and
+   // follow the same boosting steps here with std::exp.  7 classes takes the std::exp path, which checks our reference itself
+   for(const ptrdiff_t cTargetClasses : { ptrdiff_t { 7 }, ptrdiff_t { 10 }, ptrdiff_t { 17 } }) {
+      const size_t cClasses = static_cast<size_t>(cTargetClasses);
+      std::vector<ClassificationInstance> trainingInstances;
+      std::vector<std::vector<FractionalDataType>> trainingScores;
+      for(size_t iInstance = 0; iInstance < 50; ++iInstance) {
+         std::vector<FractionalDataType> priorScores;
+         for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+            priorScores.push_back(static_cast<FractionalDataType>((iInstance * 7 + iClass * 3) % 11) - FractionalDataType { 5.5 } + FractionalDataType { 0.125 } * static_cast<FractionalDataType>(iClass));
+         }
+         trainingInstances.push_back(ClassificationInstance(static_cast<IntegerDataType>((iInstance % 3 + iInstance / 7) % cClasses), {}, priorScores));
+         trainingScores.push_back(priorScores);
+      }
+      std::vector<ClassificationInstance> validationInstances;
+      std::vector<std::vector<FractionalDataType>> validationScores;
+      for(size_t iInstance = 0; iInstance < 20; ++iInstance) {
+         std::vector<FractionalDataType> priorScores;
+         for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+            priorScores.push_back(static_cast<FractionalDataType>((iInstance * 5 + iClass) % 9) - FractionalDataType { 4 });
+         }
+         validationInstances.push_back(ClassificationInstance(static_cast<IntegerDataType>(iInstance * 3 % cClasses), {}, priorScores));
+         validationScores.push_back(priorScores);
+      }
+
+      TestApi test = TestApi(cTargetClasses);
+      test.AddFeatures({});
+      test.AddFeatureCombinations({ {} });
+      test.AddTrainingInstances(trainingInstances);
+      test.AddValidationInstances(validationInstances);
+      test.InitializeTraining();
+
+      std::vector<FractionalDataType> model(cClasses, FractionalDataType { 0 });
+      for(int iEpoch = 0; iEpoch < 5; ++iEpoch) {
+         const FractionalDataType validationMetric = test.Train(0);
+
+         std::vector<FractionalDataType> sumResiduals(cClasses, FractionalDataType { 0 });
+         std::vector<FractionalDataType> sumDenominators(cClasses, FractionalDataType { 0 });
+         for(size_t iInstance = 0; iInstance < trainingInstances.size(); ++iInstance) {
+            FractionalDataType sumExp = 0;
+            for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+               sumExp += std::exp(trainingScores[iInstance][iClass]);
+            }
+            for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+               const FractionalDataType target = static_cast<size_t>(trainingInstances[iInstance].m_target) == iClass ? FractionalDataType { 1 } : FractionalDataType { 0 };
+               const FractionalDataType residual = target - std::exp(trainingScores[iInstance][iClass]) / sumExp;
+               sumResiduals[iClass] += residual;
+               sumDenominators[iClass] += std::abs(residual) * (1 - std::abs(residual));
+            }
+         }
+         for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+            const FractionalDataType update = k_learningRateDefault * sumResiduals[iClass] / sumDenominators[iClass];
+            model[iClass] += update;
+            for(std::vector<FractionalDataType> & scores : trainingScores) {
+               scores[iClass] += update;
+            }
+            for(std::vector<FractionalDataType> & scores : validationScores) {
+               scores[iClass] += update;
+            }
+         }
+
+         FractionalDataType sumLogLoss = 0;
+         for(size_t iInstance = 0; iInstance < validationInstances.size(); ++iInstance) {
+            FractionalDataType sumExp = 0;
+            for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+               sumExp += std::exp(validationScores[iInstance][iClass]);
+            }
+            sumLogLoss += -std::log(std::exp(validationScores[iInstance][static_cast<size_t>(validationInstances[iInstance].m_target)]) / sumExp);
+         }
+         const FractionalDataType expectedMetric = sumLogLoss / static_cast<FractionalDataType>(validationInstances.size());
+         CHECK(std::abs(validationMetric - expectedMetric) <= 1e-9 * std::abs(expectedMetric));
+      }
+      for(size_t iClass = 0; iClass < cClasses; ++iClass) {
+         const FractionalDataType modelValue = test.GetCurrentModelPredictorScore(0, {}, iClass);
+         CHECK(std::abs(modelValue - model[iClass]) <= 1e-9 * (1 + std::abs(model[iClass])));
+      }
+   }
+}
+
+TEST_CASE("buffered log messages are only delivered on flush and overflow is counted, training, regression") {
+   // a ring of 2 messages overflows on the first training step since we log at TraceLevelVerbose
+   CHECK(0 == SetLogMessageBuffer(2));
+   {
+      TestApi test = TestApi(k_learningTypeRegression);
+      test.AddFeatures({ FeatureTest(2) });
+      test.AddFeatureCombinations({ { 0 } });
+      test.AddTrainingInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+      test.AddValidationInstances({ RegressionInstance(10, { 0 }), RegressionInstance(20, { 1 }) });
+      const size_t cLogMessagesBefore = g_cLogMessagesDelivered;
+      test.InitializeTraining();
+      test.Train(0);
+      CHECK(cLogMessagesBefore == g_cLogMessagesDelivered);
+
+      CHECK(0 < FlushLogMessages());
+      // the 2 messages that fit, then the warning about the ones that didn't
+      CHECK(cLogMessagesBefore + 3 == g_cLogMessagesDelivered);
+      CHECK(0 == FlushLogMessages());
+      CHECK(cLogMessagesBefore + 3 == g_cLogMessagesDelivered);
+
+      CHECK(0 == SetLogMessageBuffer(0));
+   }
+   CHECK(0 != SetLogMessageBuffer(-1));
+}
+
+TEST_CASE("chunked binning of large data sets, training, regression") {
+   // the large data set is the small one repeated, so it has identical per bin averages, but it's big enough to be binned in separate chunks
+   std::vector<RegressionInstance> instancesSmall;
+   std::vector<RegressionInstance> instancesLarge;
+   for(IntegerDataType iInstance = 0; iInstance < 1000; ++iInstance) {
+      instancesSmall.push_back(RegressionInstance(FractionalDataType { 1.5 } * (iInstance % 4) - 2 * (iInstance / 4 % 3) + FractionalDataType { 0.1 } * (iInstance % 7), { iInstance % 4, iInstance / 4 % 3 }));
+   }
+   for(int iRepeat = 0; iRepeat < 200; ++iRepeat) {
+      for(const RegressionInstance & instance : instancesSmall) {
+         instancesLarge.push_back(instance);
+      }
+   }
+
+   TestApi testSmall = TestApi(k_learningTypeRegression);
+   TestApi testLarge = TestApi(k_learningTypeRegression);
+   for(TestApi * pTest : { &testSmall, &testLarge }) {
+      pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 }, { 0, 1 } });
+      pTest->AddTrainingInstances(&testSmall == pTest ? instancesSmall : instancesLarge);
+      pTest->AddValidationInstances({ RegressionInstance(1, { 1, 0 }), RegressionInstance(-2, { 2, 2 }) });
+      pTest->InitializeTraining();
+   }
+
+   for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      for(size_t iFeatureCombination = 0; iFeatureCombination < testSmall.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+         CHECK_APPROX(testSmall.Train(iFeatureCombination), testLarge.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      CHECK_APPROX(testSmall.GetCurrentModelPredictorScore(0, { iBin0 }, 0), testLarge.GetCurrentModelPredictorScore(0, { iBin0 }, 0));
+      for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+         CHECK_APPROX(testSmall.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, 0), testLarge.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, 0));
+      }
+   }
+}
+
+TEST_CASE("chunked binning of large data sets, training, multiclass") {
+   std::vector<ClassificationInstance> instancesSmall;
+   std::vector<ClassificationInstance> instancesLarge;
+   for(IntegerDataType iInstance = 0; iInstance < 1000; ++iInstance) {
+      instancesSmall.push_back(ClassificationInstance((iInstance % 4 + iInstance / 4 % 3 + (0 == iInstance % 7 ? 1 : 0)) % 3, { iInstance % 4, iInstance / 4 % 3 }));
+   }
+   for(int iRepeat = 0; iRepeat < 200; ++iRepeat) {
+      for(const ClassificationInstance & instance : instancesSmall) {
+         instancesLarge.push_back(instance);
+      }
+   }
+
+   TestApi testSmall = TestApi(3);
+   TestApi testLarge = TestApi(3);
+   for(TestApi * pTest : { &testSmall, &testLarge }) {
+      pTest->AddFeatures({ FeatureTest(4), FeatureTest(3) });
+      pTest->AddFeatureCombinations({ { 0 }, { 0, 1 } });
+      pTest->AddTrainingInstances(&testSmall == pTest ? instancesSmall : instancesLarge);
+      pTest->AddValidationInstances({ ClassificationInstance(1, { 1, 0 }), ClassificationInstance(2, { 2, 2 }) });
+      pTest->InitializeTraining();
+   }
+
+   for(int iEpoch = 0; iEpoch < 3; ++iEpoch) {
+      for(size_t iFeatureCombination = 0; iFeatureCombination < testSmall.GetFeatureCombinationsCount(); ++iFeatureCombination) {
+         CHECK_APPROX(testSmall.Train(iFeatureCombination), testLarge.Train(iFeatureCombination));
+      }
+   }
+   for(size_t iBin0 = 0; iBin0 < 4; ++iBin0) {
+      for(size_t iClass = 0; iClass < 3; ++iClass) {
+         CHECK_APPROX(testSmall.GetCurrentModelPredictorScore(0, { iBin0 }, iClass), testLarge.GetCurrentModelPredictorScore(0, { iBin0 }, iClass));
+         for(size_t iBin1 = 0; iBin1 < 3; ++iBin1) {
+            CHECK_APPROX(testSmall.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass), testLarge.GetCurrentModelPredictorScore(1, { iBin0, iBin1 }, iClass));
+         }
+      }
+   }
+}
+
 // TODO: decide what to do with this test
 //TEST_CASE("infinite target training set, training, regression") {
 //   TestApi test = TestApi(k_learningTypeRegression);
@@ -2312,6 +4580,7 @@ void EBMCORE_CALLING_CONVENTION LogMessage(signed char traceLevel, const char *
    UNUSED(traceLevel);
    // don't display the message, but we want to test all our messages, so have them call us here
    strlen(message); // test that the string memory is accessible
+   ++g_cLogMessagesDelivered;
 //   printf("%d - %s\n", traceLevel, message);
 }
 
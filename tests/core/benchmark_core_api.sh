@@ -0,0 +1,102 @@
+#!/bin/sh
+
+# benchmarks only mean something in release builds, so unlike test_core_api.sh we build and run release|x64 only
+# any arguments other than -nobuildcore are passed to benchmark_core_api, eg: -instances 1000000 -seconds 1 -filter Interaction
+
+clang_pp_bin=clang++
+g_pp_bin=g++
+os_type=`uname`
+script_path=`dirname "$0"`
+root_path="$script_path/../.."
+
+build_core=1
+benchmark_args=""
+for arg in "$@"; do
+   if [ "$arg" = "-nobuildcore" ]; then
+      build_core=0
+   else
+      benchmark_args="$benchmark_args $arg"
+   fi
+done
+
+if [ $build_core -eq 1 ]; then
+   echo "Building Core library..." 1>&2
+   /bin/sh "$root_path/build.sh" 1>&2
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+else
+   echo "Core library NOT being built" 1>&2
+fi
+
+compile_all="\"$root_path/tests/core/BenchmarkCoreApi.cpp\" -I\"$root_path/core/inc\" -std=c++11 -O3 -march=core2"
+
+if [ "$os_type" = "Darwin" ]; then
+   compile_mac="$compile_all -L\"$root_path/staging\" -Wl,-rpath,@loader_path"
+
+   echo "Compiling BenchmarkCoreApi with $clang_pp_bin for macOS release|x64" 1>&2
+   [ -d "$root_path/tmp/clang/intermediate/release/mac/x64/BenchmarkCoreApi" ] || mkdir -p "$root_path/tmp/clang/intermediate/release/mac/x64/BenchmarkCoreApi"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   [ -d "$root_path/tmp/clang/bin/release/mac/x64/BenchmarkCoreApi" ] || mkdir -p "$root_path/tmp/clang/bin/release/mac/x64/BenchmarkCoreApi"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   compile_command="$clang_pp_bin $compile_mac -m64 -DNDEBUG -l_ebmcore_mac_x64 -o \"$root_path/tmp/clang/bin/release/mac/x64/BenchmarkCoreApi/benchmark_core_api\" 2>&1"
+   compile_out=`eval $compile_command`
+   ret_code=$?
+   echo -n "$compile_out" 1>&2
+   echo -n "$compile_out" > "$root_path/tmp/clang/intermediate/release/mac/x64/BenchmarkCoreApi/BenchmarkCoreApi_release_mac_x64_build_log.txt"
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   cp "$root_path/staging/lib_ebmcore_mac_x64.dylib" "$root_path/tmp/clang/bin/release/mac/x64/BenchmarkCoreApi/"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   eval "\"$root_path/tmp/clang/bin/release/mac/x64/BenchmarkCoreApi/benchmark_core_api\" $benchmark_args"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+elif [ "$os_type" = "Linux" ]; then
+   compile_linux="$compile_all -L\"$root_path/staging\" -Wl,-rpath-link,\"$root_path/staging\" -Wl,-rpath,'\$ORIGIN/'"
+
+   echo "Compiling BenchmarkCoreApi with $g_pp_bin for Linux release|x64" 1>&2
+   [ -d "$root_path/tmp/gcc/intermediate/release/linux/x64/BenchmarkCoreApi" ] || mkdir -p "$root_path/tmp/gcc/intermediate/release/linux/x64/BenchmarkCoreApi"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   [ -d "$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkCoreApi" ] || mkdir -p "$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkCoreApi"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   compile_command="$g_pp_bin $compile_linux -m64 -DNDEBUG -l_ebmcore_linux_x64 -o \"$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkCoreApi/benchmark_core_api\" 2>&1"
+   compile_out=`eval $compile_command`
+   ret_code=$?
+   echo -n "$compile_out" 1>&2
+   echo -n "$compile_out" > "$root_path/tmp/gcc/intermediate/release/linux/x64/BenchmarkCoreApi/BenchmarkCoreApi_release_linux_x64_build_log.txt"
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   cp "$root_path/staging/lib_ebmcore_linux_x64.so" "$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkCoreApi/"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+   eval "\"$root_path/tmp/gcc/bin/release/linux/x64/BenchmarkCoreApi/benchmark_core_api\" $benchmark_args"
+   ret_code=$?
+   if [ $ret_code -ne 0 ]; then
+      exit $ret_code
+   fi
+else
+   echo "OS $os_type not recognized.  We support $clang_pp_bin on macOS and $g_pp_bin on Linux" 1>&2
+   exit 1
+fi
@@ -20,7 +20,7 @@ else
    echo "Core library NOT being built"
 fi
 
-compile_all="\"$root_path/tests/core/TestCoreApi.cpp\" -I\"$root_path/tests/core\" -I\"$root_path/core/inc\" -std=c++11 -fpermissive -O3 -march=core2"
+compile_all="\"$root_path/tests/core/TestCoreApi.cpp\" -I\"$root_path/tests/core\" -I\"$root_path/core/inc\" -I\"$root_path/core\" -std=c++11 -fpermissive -O3 -march=core2"
 
 if [ "$os_type" = "Darwin" ]; then
    # reference on rpath & install_name: https://www.mikeash.com/pyblog/friday-qa-2009-11-06-linking-and-install-names.html